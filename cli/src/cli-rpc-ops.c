@@ -862,6 +862,8 @@ gf_cli3_1_defrag_volume_cbk (struct rpc_req *req, struct iovec *iov,
         uint64_t                 files   = 0;
         uint64_t                 size    = 0;
         uint64_t                 lookup  = 0;
+        uint64_t                 elapsed = 0;
+        uint64_t                 eta     = 0;
 
         if (-1 == req->rpc_status) {
                 goto out;
@@ -927,6 +929,16 @@ gf_cli3_1_defrag_volume_cbk (struct rpc_req *req, struct iovec *iov,
                 gf_log (THIS->name, GF_LOG_TRACE,
                         "failed to get lookedup file count");
 
+        ret = dict_get_uint64 (dict, "elapsed", &elapsed);
+        if (ret)
+                gf_log (THIS->name, GF_LOG_TRACE,
+                        "failed to get elapsed time");
+
+        ret = dict_get_uint64 (dict, "eta", &eta);
+        if (ret)
+                gf_log (THIS->name, GF_LOG_TRACE,
+                        "failed to get estimated time left");
+
         if (cmd == GF_DEFRAG_CMD_STOP) {
                 if (rsp.op_ret == -1) {
                         if (strcmp (rsp.op_errstr, ""))
@@ -995,6 +1007,14 @@ gf_cli3_1_defrag_volume_cbk (struct rpc_req *req, struct iovec *iov,
                                  " files of size %"PRId64" (total files"
                                  " scanned %"PRId64")", status,
                                  files, size, lookup);
+                        if (elapsed)
+                                cli_out ("in %"PRIu64" seconds: %"PRIu64
+                                         " bytes/sec, %.2f files/sec",
+                                         elapsed, size / elapsed,
+                                         (double) files / elapsed);
+                        if (eta)
+                                cli_out ("estimated time left: %"PRIu64
+                                         " seconds", eta);
                         goto done;
                 }
 
@@ -0,0 +1,102 @@
+#!/bin/sh
+
+# Compares the io-engines of storage/posix over a loopback graph (fuse on
+# top of io-threads on top of posix, in one process, no network): mounts a
+# brick directory once per engine and runs the same random read and write
+# jobs against it.
+#
+# With fio installed the jobs are fio's randread and randwrite with libaio
+# at the given iodepth; without it, one dd per job reads then writes its
+# file in direct 4k blocks. Needs root for mounting and dropping the page
+# cache.
+#
+# usage: aio-bm.sh <brick directory> [jobs] [size in MB] [iodepth]
+
+brick=$1
+jobs=${2:-4}
+size=${3:-256}
+iodepth=${4:-64}
+
+mount_point="/mnt/aio-bm"
+volfile="/tmp/aio-bm.vol"
+
+if [ -z "$brick" ]; then
+    echo "usage: $0 <brick directory> [jobs] [size in MB] [iodepth]"
+    exit 1
+fi
+
+write_volfile ()
+{
+    cat > $volfile <<EOF
+volume posix
+    type storage/posix
+    option directory $brick
+    option io-engine $1
+    option io-depth $iodepth
+end-volume
+
+volume iot
+    type performance/io-threads
+    subvolumes posix
+end-volume
+EOF
+}
+
+# runs <jobs> dd doing 4k direct <read|write> over a file each, prints
+# the IOPS
+dd_jobs ()
+{
+    start=$(date +%s.%N)
+    for j in $(seq 1 $jobs); do
+        if [ $1 = read ]; then
+            dd if=$mount_point/aio-bm.$j of=/dev/null bs=4k \
+                iflag=direct 2>/dev/null &
+        else
+            dd if=/dev/zero of=$mount_point/aio-bm.$j bs=4k \
+                count=$(($size * 256)) oflag=direct conv=notrunc \
+                2>/dev/null &
+        fi
+    done
+    wait
+    end=$(date +%s.%N)
+    echo "$jobs $size $start $end" | \
+        awk '{ printf "%.0f IOPS\n", $1 * $2 * 256 / ($4 - $3) }'
+}
+
+run_jobs ()
+{
+    if which fio > /dev/null 2>&1; then
+        fio --name=aio-bm --directory=$mount_point --rw=rand$1 --bs=4k \
+            --size=${size}m --numjobs=$jobs --ioengine=libaio --direct=1 \
+            --iodepth=$iodepth --runtime=30 --time_based --group_reporting \
+            | grep -i "iops"
+    else
+        dd_jobs $1
+    fi
+}
+
+mkdir -p $mount_point
+
+for engine in sync io_uring linux-aio; do
+    write_volfile $engine
+    glusterfs -f $volfile $mount_point || exit 1
+    sleep 1
+
+    # the files of dd, laid out once; fio lays out its own
+    for j in $(seq 1 $jobs); do
+        [ -f $brick/aio-bm.$j ] && continue
+        dd if=/dev/zero of=$mount_point/aio-bm.$j bs=1M count=$size \
+            2>/dev/null
+    done
+
+    sync
+    echo 3 > /proc/sys/vm/drop_caches
+
+    echo "$engine: read  $(run_jobs read)"
+    echo "$engine: write $(run_jobs write)"
+
+    umount $mount_point
+    sleep 1
+done
+
+rm -f $volfile
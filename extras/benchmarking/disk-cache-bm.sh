@@ -0,0 +1,68 @@
+#!/bin/sh
+
+# Measures what performance/disk-cache buys after a client restart: reads a
+# data set cold, remounts the volume, and reads it again with the cache
+# populated by the first run.
+#
+# usage: disk-cache-bm.sh <volfile> [files] [size in MB]
+#
+# The volfile must load performance/disk-cache, eg. "gluster volume set
+# <volname> performance.disk-cache on" and use the fuse volfile glusterd
+# generated.
+
+volfile=$1
+files=${2:-16}
+size=${3:-64}
+
+mount_point="/mnt/disk-cache-bm"
+blocksize=128k
+
+if [ -z "$volfile" ]; then
+    echo "usage: $0 <volfile> [files] [size in MB]"
+    exit 1
+fi
+
+mount_volume ()
+{
+    glusterfs -f $volfile $mount_point || exit 1
+    sleep 1
+}
+
+umount_volume ()
+{
+    umount $mount_point
+    sleep 1
+}
+
+# prints the MB/s of reading all the files
+read_all ()
+{
+    sync
+    echo 3 > /proc/sys/vm/drop_caches
+    start=$(date +%s.%N)
+    for i in $(seq 1 $files); do
+        dd if=$mount_point/dc-bm/file.$i of=/dev/null bs=$blocksize 2>/dev/null
+    done
+    end=$(date +%s.%N)
+    echo "$files $size $start $end" | awk '{ printf "%.2f\n", $1 * $2 / ($4 - $3) }'
+}
+
+mkdir -p $mount_point
+mount_volume
+
+mkdir -p $mount_point/dc-bm
+for i in $(seq 1 $files); do
+    dd if=/dev/urandom of=$mount_point/dc-bm/file.$i bs=1M count=$size 2>/dev/null
+done
+
+# the writes invalidated whatever was cached for these files
+umount_volume
+mount_volume
+echo "cold read: $(read_all) MB/s"
+
+umount_volume
+mount_volume
+echo "warm read: $(read_all) MB/s"
+
+rm -rf $mount_point/dc-bm
+umount_volume
@@ -0,0 +1,51 @@
+#!/bin/sh
+
+# Compares writes of many processes to distinct files with writes of as
+# many processes to distinct regions of a single file, to show what the
+# inode-affinity option of io-threads changes. Run it once with
+#
+#   gluster volume set <volname> performance.io-thread-inode-affinity off
+#
+# and once with it on.
+#
+# usage: iot-affinity-bm.sh <mount point> [writers] [size in MB per writer]
+
+mount_point=$1
+writers=${2:-16}
+size=${3:-64}
+
+blocksize=128k
+blocks=$((size * 8))
+
+if [ -z "$mount_point" ]; then
+    echo "usage: $0 <mount point> [writers] [size in MB per writer]"
+    exit 1
+fi
+
+dir=$mount_point/iot-affinity-bm
+
+# runs the writers, $1 is "distinct" or "shared". prints MB/s.
+run ()
+{
+    start=$(date +%s.%N)
+    for i in $(seq 0 $((writers - 1))); do
+        if [ "$1" = "distinct" ]; then
+            dd if=/dev/zero of=$dir/file.$i bs=$blocksize count=$blocks \
+                conv=fsync 2>/dev/null &
+        else
+            dd if=/dev/zero of=$dir/shared bs=$blocksize count=$blocks \
+                seek=$((i * blocks)) conv=notrunc,fsync 2>/dev/null &
+        fi
+    done
+    wait
+    end=$(date +%s.%N)
+    echo "$writers $size $start $end" | awk '{ printf "%.2f\n", $1 * $2 / ($4 - $3) }'
+}
+
+mkdir -p $dir
+touch $dir/shared
+
+echo "distinct files: $(run distinct) MB/s"
+echo "shared file:    $(run shared) MB/s"
+
+rm -rf $dir
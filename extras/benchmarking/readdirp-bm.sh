@@ -0,0 +1,41 @@
+#!/bin/sh
+
+# Times 'ls -l' on a directory of many entries, which the client serves
+# with readdirp. Run it with the readdirp-threads option of storage/posix
+# at 0, then at a few threads, to compare:
+#
+#   gluster volume set <volname> storage.readdirp-threads 4
+#
+# The directory is created once and kept between runs; remove
+# <mount point>/readdirp-bm when done. Dropping the page cache of the
+# servers before a run measures a cold directory.
+#
+# usage: readdirp-bm.sh <mount point> [entries] [runs]
+
+mount_point=$1
+entries=${2:-1000000}
+runs=${3:-3}
+
+if [ -z "$mount_point" ]; then
+    echo "usage: $0 <mount point> [entries] [runs]"
+    exit 1
+fi
+
+dir=$mount_point/readdirp-bm
+
+if [ ! -f $dir/.done-$entries ]; then
+    rm -rf $dir
+    mkdir -p $dir
+    # 16 creators, 1000 names per touch
+    seq 1 $entries | sed 's/^/f/' | (cd $dir && xargs -n 1000 -P 16 touch)
+    touch $dir/.done-$entries
+fi
+
+for run in $(seq 1 $runs); do
+    start=$(date +%s.%N)
+    listed=$(ls -l $dir | wc -l)
+    end=$(date +%s.%N)
+    echo "$listed $start $end" | \
+        awk '{ printf "ls -l: %d entries in %.2f s, %.0f entries/s\n",
+               $1 - 1, $3 - $2, ($1 - 1) / ($3 - $2) }'
+done
@@ -0,0 +1,386 @@
+/*
+  Copyright (c) 2011 Gluster, Inc. <http://www.gluster.com>
+  This file is part of GlusterFS.
+
+  GlusterFS is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published
+  by the Free Software Foundation; either version 3 of the License,
+  or (at your option) any later version.
+
+  GlusterFS is distributed in the hope that it will be useful, but
+  WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see
+  <http://www.gnu.org/licenses/>.
+*/
+
+/*
+ * xdr-bm: checks that the hand written codecs of glusterfs3-xdr-fast.c
+ * produce and accept exactly the bytes of the rpcgen ones, and compares
+ * their throughput.
+ *
+ * For every message the encoded bytes of both codecs must match, and the
+ * output of each one decoded by the other must encode back to the same
+ * bytes. Then both codecs encode and decode the message in a loop.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/time.h>
+
+#include "glusterfs3-xdr.h"
+#include "glusterfs3-xdr-fast.h"
+
+#define XDR_BM_BUFSIZE   (128 * 1024)
+#define XDR_BM_DIRENTS   64
+
+struct xdr_bm_msg {
+        const char   *name;
+        void         *obj;
+        size_t        objsize;
+        xdrproc_t     slow;
+        xdrproc_t     fast;
+};
+
+static char dict_buf[] = "\x00\x00\x00\x01trusted.glusterfs.test\0value";
+
+
+static void
+fill_iatt (gf_iatt *iatt, int seed)
+{
+        int i = 0;
+
+        for (i = 0; i < 16; i++)
+                iatt->ia_gfid[i] = (char)(seed + i);
+
+        iatt->ia_ino        = 0x0102030405060708ULL + seed;
+        iatt->ia_dev        = 0x1112131415161718ULL;
+        iatt->mode          = 0100644;
+        iatt->ia_nlink      = 1;
+        iatt->ia_uid        = 500 + seed;
+        iatt->ia_gid        = 500;
+        iatt->ia_rdev       = 0;
+        iatt->ia_size       = 0x7fffffff00ULL + seed;
+        iatt->ia_blksize    = 4096;
+        iatt->ia_blocks     = 1234567;
+        iatt->ia_atime      = 1300000000 + seed;
+        iatt->ia_atime_nsec = 999999999;
+        iatt->ia_mtime      = 1300000001;
+        iatt->ia_mtime_nsec = 1;
+        iatt->ia_ctime      = 0xffffffff;
+        iatt->ia_ctime_nsec = 0;
+}
+
+
+static char *
+dirent_name (int i)
+{
+        char *name = NULL;
+        int   len  = 1 + (i % 40);
+
+        name = malloc (len + 1);
+        memset (name, 'a' + (i % 26), len);
+        name[len] = '\0';
+
+        return name;
+}
+
+
+static gfs3_dirlist *
+build_dirlist (int count)
+{
+        gfs3_dirlist *head  = NULL;
+        gfs3_dirlist *entry = NULL;
+        int           i     = 0;
+
+        for (i = count - 1; i >= 0; i--) {
+                entry = calloc (1, sizeof (*entry));
+                entry->d_ino  = 1000 + i;
+                entry->d_off  = 0x8000000000000000ULL | i;
+                entry->d_len  = 1 + (i % 40);
+                entry->d_type = 8;
+                entry->name   = dirent_name (i);
+                entry->nextentry = head;
+                head = entry;
+        }
+
+        return head;
+}
+
+
+static gfs3_dirplist *
+build_dirplist (int count)
+{
+        gfs3_dirplist *head  = NULL;
+        gfs3_dirplist *entry = NULL;
+        int            i     = 0;
+
+        for (i = count - 1; i >= 0; i--) {
+                entry = calloc (1, sizeof (*entry));
+                entry->d_ino  = 1000 + i;
+                entry->d_off  = 0x8000000000000000ULL | i;
+                entry->d_len  = 1 + (i % 40);
+                entry->d_type = 4;
+                entry->name   = dirent_name (i);
+                fill_iatt (&entry->stat, i);
+                entry->nextentry = head;
+                head = entry;
+        }
+
+        return head;
+}
+
+
+static u_int
+encode (xdrproc_t proc, void *obj, char *buf)
+{
+        XDR   xdr;
+        u_int len = 0;
+
+        xdrmem_create (&xdr, buf, XDR_BM_BUFSIZE, XDR_ENCODE);
+        if (!proc (&xdr, obj))
+                return 0;
+
+        len = xdr_getpos (&xdr);
+        xdr_destroy (&xdr);
+
+        return len;
+}
+
+
+static int
+decode (xdrproc_t proc, void *obj, char *buf, u_int len)
+{
+        XDR xdr;
+        int ret = 0;
+
+        xdrmem_create (&xdr, buf, len, XDR_DECODE);
+        ret = proc (&xdr, obj) && (xdr_getpos (&xdr) == len);
+        xdr_destroy (&xdr);
+
+        return ret;
+}
+
+
+/* decode @buf with @dec, encode the result with @enc, compare with @buf */
+static int
+cross_check (struct xdr_bm_msg *msg, xdrproc_t dec, xdrproc_t enc,
+             char *buf, u_int len, char *scratch)
+{
+        void *obj = NULL;
+        int   ret = -1;
+
+        obj = calloc (1, msg->objsize);
+
+        if (!decode (dec, obj, buf, len))
+                goto out;
+
+        if (encode (enc, obj, scratch) != len)
+                goto out;
+
+        if (memcmp (buf, scratch, len))
+                goto out;
+
+        ret = 0;
+out:
+        xdr_free (msg->slow, obj);
+        free (obj);
+
+        return ret;
+}
+
+
+static int
+conformance (struct xdr_bm_msg *msg)
+{
+        static char slow_buf[XDR_BM_BUFSIZE];
+        static char fast_buf[XDR_BM_BUFSIZE];
+        static char scratch[XDR_BM_BUFSIZE];
+        u_int       slow_len = 0;
+        u_int       fast_len = 0;
+
+        slow_len = encode (msg->slow, msg->obj, slow_buf);
+        fast_len = encode (msg->fast, msg->obj, fast_buf);
+
+        if (!slow_len || (slow_len != fast_len)
+            || memcmp (slow_buf, fast_buf, slow_len)) {
+                fprintf (stderr, "%s: encoded bytes differ\n", msg->name);
+                return -1;
+        }
+
+        if (xdr_sizeof (msg->slow, msg->obj)
+            != xdr_sizeof (msg->fast, msg->obj)) {
+                fprintf (stderr, "%s: encoded sizes differ\n", msg->name);
+                return -1;
+        }
+
+        if (cross_check (msg, msg->fast, msg->slow, slow_buf, slow_len,
+                         scratch)) {
+                fprintf (stderr, "%s: fast decoder rejects or alters "
+                         "rpcgen output\n", msg->name);
+                return -1;
+        }
+
+        if (cross_check (msg, msg->slow, msg->fast, fast_buf, fast_len,
+                         scratch)) {
+                fprintf (stderr, "%s: rpcgen decoder rejects or alters "
+                         "fast output\n", msg->name);
+                return -1;
+        }
+
+        return 0;
+}
+
+
+static double
+time_codec (struct xdr_bm_msg *msg, xdrproc_t proc, long iters)
+{
+        static char     buf[XDR_BM_BUFSIZE];
+        struct timeval  start = {0, };
+        struct timeval  end   = {0, };
+        void           *obj   = NULL;
+        u_int           len   = 0;
+        long            i     = 0;
+
+        obj = calloc (1, msg->objsize);
+
+        gettimeofday (&start, NULL);
+        for (i = 0; i < iters; i++) {
+                len = encode (proc, msg->obj, buf);
+                decode (proc, obj, buf, len);
+                xdr_free (msg->slow, obj);
+                memset (obj, 0, msg->objsize);
+        }
+        gettimeofday (&end, NULL);
+
+        free (obj);
+
+        return (end.tv_sec - start.tv_sec)
+                + ((end.tv_usec - start.tv_usec) / 1000000.0);
+}
+
+
+int
+main (int argc, char *argv[])
+{
+        gfs3_stat_rsp      stat_rsp     = {0, };
+        gfs3_lookup_req    lookup_req   = {{0}, };
+        gfs3_lookup_rsp    lookup_rsp   = {0, };
+        gfs3_read_req      read_req     = {{0}, };
+        gfs3_read_rsp      read_rsp     = {0, };
+        gfs3_write_req     write_req    = {{0}, };
+        gfs3_write_rsp     write_rsp    = {0, };
+        gfs3_readdir_rsp   readdir_rsp  = {0, };
+        gfs3_readdirp_rsp  readdirp_rsp = {0, };
+        long               iters        = 100000;
+        double             slow         = 0;
+        double             fast         = 0;
+        int                failed       = 0;
+        int                i            = 0;
+
+        struct xdr_bm_msg msgs[] = {
+                { "stat_rsp", &stat_rsp, sizeof (stat_rsp),
+                  (xdrproc_t)xdr_gfs3_stat_rsp,
+                  (xdrproc_t)xdr_fast_gfs3_stat_rsp },
+                { "lookup_req", &lookup_req, sizeof (lookup_req),
+                  (xdrproc_t)xdr_gfs3_lookup_req,
+                  (xdrproc_t)xdr_fast_gfs3_lookup_req },
+                { "lookup_rsp", &lookup_rsp, sizeof (lookup_rsp),
+                  (xdrproc_t)xdr_gfs3_lookup_rsp,
+                  (xdrproc_t)xdr_fast_gfs3_lookup_rsp },
+                { "read_req", &read_req, sizeof (read_req),
+                  (xdrproc_t)xdr_gfs3_read_req,
+                  (xdrproc_t)xdr_fast_gfs3_read_req },
+                { "read_rsp", &read_rsp, sizeof (read_rsp),
+                  (xdrproc_t)xdr_gfs3_read_rsp,
+                  (xdrproc_t)xdr_fast_gfs3_read_rsp },
+                { "write_req", &write_req, sizeof (write_req),
+                  (xdrproc_t)xdr_gfs3_write_req,
+                  (xdrproc_t)xdr_fast_gfs3_write_req },
+                { "write_rsp", &write_rsp, sizeof (write_rsp),
+                  (xdrproc_t)xdr_gfs3_write_rsp,
+                  (xdrproc_t)xdr_fast_gfs3_write_rsp },
+                { "readdir_rsp", &readdir_rsp, sizeof (readdir_rsp),
+                  (xdrproc_t)xdr_gfs3_readdir_rsp,
+                  (xdrproc_t)xdr_fast_gfs3_readdir_rsp },
+                { "readdirp_rsp", &readdirp_rsp, sizeof (readdirp_rsp),
+                  (xdrproc_t)xdr_gfs3_readdirp_rsp,
+                  (xdrproc_t)xdr_fast_gfs3_readdirp_rsp },
+        };
+
+        if (argc > 1)
+                iters = atol (argv[1]);
+
+        stat_rsp.op_ret = 0;
+        fill_iatt (&stat_rsp.stat, 1);
+
+        memset (lookup_req.gfid, 0x11, 16);
+        memset (lookup_req.pargfid, 0x22, 16);
+        lookup_req.flags      = 0;
+        lookup_req.path       = "/dir1/dir2/file.txt";
+        lookup_req.bname      = "file.txt";
+        lookup_req.dict.dict_val = dict_buf;
+        lookup_req.dict.dict_len = sizeof (dict_buf) - 1;
+
+        lookup_rsp.op_ret     = -1;
+        lookup_rsp.op_errno   = 2;
+        fill_iatt (&lookup_rsp.stat, 2);
+        fill_iatt (&lookup_rsp.postparent, 3);
+        lookup_rsp.dict.dict_val = dict_buf;
+        lookup_rsp.dict.dict_len = sizeof (dict_buf) - 1;
+
+        memset (read_req.gfid, 0x33, 16);
+        read_req.fd           = -2;
+        read_req.offset       = 0x123456789ULL;
+        read_req.size         = 131072;
+
+        read_rsp.op_ret       = 131072;
+        fill_iatt (&read_rsp.stat, 4);
+        read_rsp.size         = 131072;
+
+        memset (write_req.gfid, 0x44, 16);
+        write_req.fd          = 7;
+        write_req.offset      = 0xfffffffffULL;
+        write_req.size        = 4096;
+
+        write_rsp.op_ret      = 4096;
+        fill_iatt (&write_rsp.prestat, 5);
+        fill_iatt (&write_rsp.poststat, 6);
+
+        readdir_rsp.op_ret    = XDR_BM_DIRENTS;
+        readdir_rsp.reply     = build_dirlist (XDR_BM_DIRENTS);
+
+        readdirp_rsp.op_ret   = XDR_BM_DIRENTS;
+        readdirp_rsp.reply    = build_dirplist (XDR_BM_DIRENTS);
+
+        for (i = 0; i < sizeof (msgs) / sizeof (msgs[0]); i++) {
+                if (conformance (&msgs[i])) {
+                        failed++;
+                        continue;
+                }
+                printf ("%-14s conforms\n", msgs[i].name);
+        }
+
+        if (failed) {
+                fprintf (stderr, "%d message(s) failed conformance\n", failed);
+                return 1;
+        }
+
+        if (!iters)
+                return 0;
+
+        printf ("\n%-14s %14s %14s %8s\n", "message", "rpcgen ops/s",
+                "fast ops/s", "speedup");
+        for (i = 0; i < sizeof (msgs) / sizeof (msgs[0]); i++) {
+                slow = time_codec (&msgs[i], msgs[i].slow, iters);
+                fast = time_codec (&msgs[i], msgs[i].fast, iters);
+                printf ("%-14s %14.0f %14.0f %7.2fx\n", msgs[i].name,
+                        iters / slow, iters / fast, slow / fast);
+        }
+
+        return 0;
+}
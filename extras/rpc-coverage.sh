@@ -1,7 +1,7 @@
 #!/bin/bash
 
-# This script can be used to provoke 35 fops (if afr is used),
-# 28 fops (if afr is not used) (-fstat,-readdirp, and lk,xattrop calls)
+# This script can be used to provoke 38 fops (if afr is used),
+# 31 fops (if afr is not used) (-fstat,-readdirp, and lk,xattrop calls)
 # Pending are 7 procedures.
 # getspec, fsyncdir, access, fentrylk, fsetxattr, fgetxattr, rchecksum
 # TODO: add commands which can generate fops for missing fops
@@ -15,6 +15,8 @@
 # FSTAT
 # FSYNC
 # FTRUNCATE
+# FALLOCATE
+# DISCARD
 # FXATTROP
 # GETXATTR
 # INODELK
@@ -43,6 +45,7 @@
 # UNLINK
 # WRITE
 # XATTROP
+# ZEROFILL
 
 #set -e;
 set -o pipefail;
@@ -109,6 +112,23 @@ function test_truncate()
 }
 
 
+function test_fallocate()
+{
+    fallocate -l 1M $PFX/dir/file;
+    test $(stat -c '%s' $PFX/dir/file) == 1048576 || fail "fallocate"
+
+    dd if=/dev/urandom of=$PFX/dir/file bs=64k count=16 conv=notrunc \
+        2>/dev/null;
+    fallocate -p -o 64k -l 128k $PFX/dir/file;
+    cmp -s -n 131072 -i 65536:0 $PFX/dir/file /dev/zero || fail "discard"
+
+    fallocate -z -o 512k -l 128k $PFX/dir/file;
+    cmp -s -n 131072 -i 524288:0 $PFX/dir/file /dev/zero || fail "zerofill"
+
+    truncate -s 0 $PFX/dir/file;
+}
+
+
 function test_fstat()
 {
     local msg;
@@ -424,6 +444,7 @@ function run_tests()
     test_write;
     test_read;
     test_truncate;
+    test_fallocate;
     test_fstat;
     test_mknod;
     test_hardlink;
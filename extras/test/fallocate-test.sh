@@ -0,0 +1,246 @@
+#!/bin/bash
+
+#   Copyright (c) 2006-2011 Gluster, Inc. <http://www.gluster.com>
+#   This file is part of GlusterFS.
+
+#   GlusterFS is free software; you can redistribute it and/or modify
+#   it under the terms of the GNU General Public License as published
+#   by the Free Software Foundation; either version 3 of the License,
+#   or (at your option) any later version.
+
+#   GlusterFS is distributed in the hope that it will be useful, but
+#   WITHOUT ANY WARRANTY; without even the implied warranty of
+#   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+#   General Public License for more details.
+
+#   You should have received a copy of the GNU General Public License
+#   along with this program.  If not, see
+#   <http://www.gnu.org/licenses/>.
+
+# Regression test of the fallocate, discard and zerofill fops through every
+# translator handling them. Each translator is loaded over local bricks
+# from a volfile of its own and mounted; fallocate(1) then reserves, punches
+# and zeroes ranges of a file, which is compared with a local copy having
+# gone through the same operations. Needs root, fuse and fallocate(1).
+
+M=/mnt/fallocate-test;
+P=/tmp/fallocate-test;
+R=/tmp/fallocate-test.pids;
+T=600;
+
+FAILED=0;
+
+
+function fail()
+{
+    echo "$*: failed.";
+    FAILED=1;
+}
+
+
+function cleanup()
+{
+    local pidfile;
+
+    umount -l $M 2>&1 || true;
+
+    # only the clients of this test, not every glusterfs of the host
+    for pidfile in $R/*; do
+        [ -f $pidfile ] && kill -15 $(cat $pidfile) 2>/dev/null;
+    done
+    rm -rf $P $R;
+}
+
+
+# posix bricks named brick1..brick$1, with locks for the cluster translators
+function volfile_bricks()
+{
+    local i;
+
+    for i in $(seq 1 $1); do
+        mkdir -p $P/export$i;
+        cat <<EOF
+volume posix$i
+    type storage/posix
+    option directory $P/export$i
+end-volume
+
+volume brick$i
+    type features/locks
+    subvolumes posix$i
+end-volume
+
+EOF
+    done
+}
+
+
+# $1: translator type, $2: number of bricks below it, $3: its options
+function volfile()
+{
+    local subvols;
+
+    volfile_bricks $2;
+
+    subvols=$(seq -f "brick%g" -s " " 1 $2);
+    cat <<EOF
+volume top
+    type $1
+$3
+    subvolumes $subvols
+end-volume
+EOF
+}
+
+
+# $1: the test, naming the pid file kept in $R for cleanup()
+function mount_volfile()
+{
+    mkdir -p $M $R;
+    glusterfs -f $P/volfile -l $P/log -p $R/$1 $M || return 1;
+    sleep 1;
+
+    # glusterfs has daemonized before building the graph
+    grep -q " $M fuse" /proc/mounts;
+}
+
+
+function compare()
+{
+    cmp -s $M/file $P/ref || fail "$1: content";
+    test $(stat -c '%s' $M/file) == $(stat -c '%s' $P/ref) || \
+        fail "$1: size";
+}
+
+
+# the fops are expected to work: the file must match the local copy after
+# each of them
+function test_fops()
+{
+    local name=$1;
+
+    dd if=/dev/urandom of=$P/ref bs=128k count=8 2>/dev/null;
+    cp $P/ref $M/file || { fail "$name: create"; return; }
+
+    fallocate -l 2M $M/file || fail "$name: fallocate";
+    truncate -s 2M $P/ref;
+    compare "$name: fallocate";
+
+    fallocate -n -o 3M -l 1M $M/file || fail "$name: fallocate keep size";
+    compare "$name: fallocate keep size";
+
+    fallocate -p -o 200k -l 700k $M/file || fail "$name: discard";
+    dd if=/dev/zero of=$P/ref bs=1k seek=200 count=700 conv=notrunc \
+        2>/dev/null;
+    compare "$name: discard";
+
+    fallocate -z -o 1500k -l 300k $M/file || fail "$name: zerofill";
+    dd if=/dev/zero of=$P/ref bs=1k seek=1500 count=300 conv=notrunc \
+        2>/dev/null;
+    compare "$name: zerofill";
+
+    rm -f $M/file;
+}
+
+
+# $2..: the fops expected to fail, among fallocate, discard and zerofill
+function test_fops_fail()
+{
+    local name=$1;
+    local fop;
+
+    shift;
+
+    touch $M/file 2>/dev/null;
+    for fop in "$@"; do
+        case $fop in
+            fallocate) fallocate -l 1M $M/file 2>/dev/null;;
+            discard)   fallocate -p -o 0 -l 1M $M/file 2>/dev/null;;
+            zerofill)  fallocate -z -o 0 -l 1M $M/file 2>/dev/null;;
+        esac && fail "$name: $fop not refused";
+    done
+    rm -f $M/file 2>/dev/null;
+}
+
+
+# $1: name, $2: expected failures or "", then the volfile() arguments
+function run_test()
+{
+    local name=$1;
+    local refused=$2;
+
+    shift 2;
+
+    echo "Testing $name";
+    rm -rf $P;
+    mkdir -p $P;
+    volfile "$@" > $P/volfile;
+
+    mount_volfile $name || { fail "$name: mount"; return; }
+
+    if [ "x$refused" == "x" ] ; then
+        test_fops $name;
+    else
+        test_fops_fail $name $refused;
+    fi
+
+    umount $M || fail "$name: umount";
+}
+
+
+function run_tests()
+{
+    run_test posix "" features/locks 1 "";
+    run_test distribute "" cluster/distribute 2 "";
+    run_test replicate "" cluster/replicate 2 "";
+    run_test stripe "" cluster/stripe 3 "    option block-size 128KB";
+    run_test write-behind "" performance/write-behind 1 "";
+    run_test io-cache "" performance/io-cache 1 "";
+    run_test quick-read "" performance/quick-read 1 "";
+    run_test read-ahead "" performance/read-ahead 1 "";
+    run_test io-threads "" performance/io-threads 1 "";
+    run_test read-only "fallocate discard zerofill" features/read-only 1 "";
+    run_test quota "fallocate zerofill" features/quota 1 "";
+}
+
+
+function watchdog ()
+{
+    # insurance against hangs during the test
+
+    sleep $1;
+
+    echo "Kicking in watchdog after $1 secs";
+
+    cleanup;
+}
+
+
+function finish ()
+{
+    cleanup;
+    pkill -P $WATCHDOG;
+    kill $WATCHDOG;
+}
+
+
+function main ()
+{
+    cleanup;
+
+    watchdog $T &
+    WATCHDOG=$!;
+
+    trap finish EXIT;
+
+    run_tests;
+
+    if [ $FAILED -ne 0 ]; then
+        echo "fallocate test failed";
+        exit 1;
+    fi
+
+    echo "fallocate test passed";
+}
+
+main "$@";
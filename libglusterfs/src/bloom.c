@@ -0,0 +1,150 @@
+/*
+  Copyright (c) 2011 Gluster, Inc. <http://www.gluster.com>
+  This file is part of GlusterFS.
+
+  GlusterFS is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published
+  by the Free Software Foundation; either version 3 of the License,
+  or (at your option) any later version.
+
+  GlusterFS is distributed in the hope that it will be useful, but
+  WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see
+  <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef _CONFIG_H
+#define _CONFIG_H
+#include "config.h"
+#endif
+
+#include <arpa/inet.h>
+
+#include "bloom.h"
+#include "hashfn.h"
+#include "mem-pool.h"
+
+
+/* the bits of a name are picked by double hashing, from two of its hashes */
+static void
+gf_bloom_hash (const char *name, uint32_t *h1, uint32_t *h2)
+{
+        int len = 0;
+
+        len = strlen (name);
+
+        *h1 = gf_dm_hashfn (name, len);
+        *h2 = SuperFastHash (name, len) | 1;
+}
+
+
+/* an empty filter sized for @names names */
+gf_bloom_t *
+gf_bloom_new (uint32_t names)
+{
+        gf_bloom_t *bloom = NULL;
+        uint64_t    want  = 0;
+        uint32_t    bits  = GF_BLOOM_MIN_BITS;
+
+        want = (uint64_t) names * GF_BLOOM_BITS_PER_NAME;
+        while ((bits < want) && (bits < GF_BLOOM_MAX_BITS))
+                bits <<= 1;
+
+        bloom = GF_CALLOC (1, sizeof (*bloom) + bits / 8,
+                           gf_common_mt_bloom_t);
+        if (!bloom)
+                return NULL;
+
+        bloom->magic  = htonl (GF_BLOOM_MAGIC);
+        bloom->bits   = htonl (bits);
+        bloom->hashes = htonl (GF_BLOOM_HASHES);
+
+        return bloom;
+}
+
+
+void
+gf_bloom_add (gf_bloom_t *bloom, const char *name)
+{
+        uint32_t h1     = 0;
+        uint32_t h2     = 0;
+        uint32_t mask   = 0;
+        uint32_t bit    = 0;
+        uint32_t hashes = 0;
+        uint32_t i      = 0;
+
+        gf_bloom_hash (name, &h1, &h2);
+
+        mask   = ntohl (bloom->bits) - 1;
+        hashes = ntohl (bloom->hashes);
+        for (i = 0; i < hashes; i++) {
+                bit = (h1 + i * h2) & mask;
+                bloom->map[bit / 8] |= 1 << (bit % 8);
+        }
+
+        bloom->count = htonl (ntohl (bloom->count) + 1);
+}
+
+
+/* _gf_false only if @name was never added */
+gf_boolean_t
+gf_bloom_maybe (gf_bloom_t *bloom, const char *name)
+{
+        uint32_t h1     = 0;
+        uint32_t h2     = 0;
+        uint32_t mask   = 0;
+        uint32_t bit    = 0;
+        uint32_t hashes = 0;
+        uint32_t i      = 0;
+
+        gf_bloom_hash (name, &h1, &h2);
+
+        mask   = ntohl (bloom->bits) - 1;
+        hashes = ntohl (bloom->hashes);
+        for (i = 0; i < hashes; i++) {
+                bit = (h1 + i * h2) & mask;
+                if (!(bloom->map[bit / 8] & (1 << (bit % 8))))
+                        return _gf_false;
+        }
+
+        return _gf_true;
+}
+
+
+size_t
+gf_bloom_size (gf_bloom_t *bloom)
+{
+        return sizeof (*bloom) + ntohl (bloom->bits) / 8;
+}
+
+
+/* a copy of the filter in @buf, NULL if it is not a valid one */
+gf_bloom_t *
+gf_bloom_dup (const void *buf, size_t len)
+{
+        const gf_bloom_t *bloom = buf;
+        gf_bloom_t       *dup   = NULL;
+        uint32_t          bits  = 0;
+
+        if (!buf || (len < sizeof (*bloom)))
+                return NULL;
+
+        bits = ntohl (bloom->bits);
+        if ((ntohl (bloom->magic) != GF_BLOOM_MAGIC) ||
+            (bits < GF_BLOOM_MIN_BITS) || (bits > GF_BLOOM_MAX_BITS) ||
+            (bits & (bits - 1)) || !ntohl (bloom->hashes) ||
+            (len != sizeof (*bloom) + bits / 8))
+                return NULL;
+
+        dup = GF_CALLOC (1, len, gf_common_mt_bloom_t);
+        if (!dup)
+                return NULL;
+
+        memcpy (dup, buf, len);
+
+        return dup;
+}
@@ -0,0 +1,74 @@
+/*
+  Copyright (c) 2011 Gluster, Inc. <http://www.gluster.com>
+  This file is part of GlusterFS.
+
+  GlusterFS is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published
+  by the Free Software Foundation; either version 3 of the License,
+  or (at your option) any later version.
+
+  GlusterFS is distributed in the hope that it will be useful, but
+  WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see
+  <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef _BLOOM_H
+#define _BLOOM_H
+
+#ifndef _CONFIG_H
+#define _CONFIG_H
+#include "config.h"
+#endif
+
+#include <stdint.h>
+#include <sys/types.h>
+
+#include "common-utils.h"
+
+/*
+ * A bloom filter of names: it tells for sure that a name is not in the
+ * set it was built from, and only that it may be otherwise. Bricks return
+ * one per directory, for distribute to skip the subvolumes a name is not
+ * on when it has to look for it everywhere.
+ *
+ * The header is kept in network byte order, so a filter is sent, stored
+ * and used as the same bytes.
+ */
+
+#define GF_BLOOM_XATTR_KEY      "glusterfs.dht.bloom"
+
+#define GF_BLOOM_MAGIC          0x474c424d
+#define GF_BLOOM_BITS_PER_NAME  10
+#define GF_BLOOM_HASHES         7
+#define GF_BLOOM_MIN_BITS       64
+#define GF_BLOOM_MAX_BITS       (512 * 1024)  /* fits a reply */
+
+typedef struct {
+        uint32_t      magic;
+        uint32_t      bits;    /* a power of two */
+        uint32_t      hashes;
+        uint32_t      count;   /* of names added */
+        unsigned char map[0];
+} gf_bloom_t;
+
+gf_bloom_t *
+gf_bloom_new (uint32_t names);
+
+void
+gf_bloom_add (gf_bloom_t *bloom, const char *name);
+
+gf_boolean_t
+gf_bloom_maybe (gf_bloom_t *bloom, const char *name);
+
+size_t
+gf_bloom_size (gf_bloom_t *bloom);
+
+gf_bloom_t *
+gf_bloom_dup (const void *buf, size_t len);
+
+#endif /* _BLOOM_H */
@@ -0,0 +1,277 @@
+/*
+  Copyright (c) 2011 Gluster, Inc. <http://www.gluster.com>
+  This file is part of GlusterFS.
+
+  GlusterFS is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published
+  by the Free Software Foundation; either version 3 of the License,
+  or (at your option) any later version.
+
+  GlusterFS is distributed in the hope that it will be useful, but
+  WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see
+  <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef _CONFIG_H
+#define _CONFIG_H
+#include "config.h"
+#endif
+
+#include "bulkstat.h"
+
+
+typedef struct {
+        xlator_t     *subvol;
+        loc_t        *locs;
+        int32_t      *index;     /* position of each loc in the request */
+        int32_t       count;
+} bulkstat_split_t;
+
+typedef struct {
+        gf_lock_t          lock;
+        int32_t            call_cnt;
+        int32_t            count;
+        struct iatt       *bufs;
+        int32_t           *op_errnos;
+        int32_t            split_cnt;
+        bulkstat_split_t  *splits;
+} bulkstat_split_local_t;
+
+
+static void
+bulkstat_split_local_free (bulkstat_split_local_t *local)
+{
+        int32_t i = 0;
+
+        if (!local)
+                return;
+
+        for (i = 0; i < local->split_cnt; i++) {
+                bulkstat_locs_wipe (local->splits[i].locs,
+                                    local->splits[i].count);
+                GF_FREE (local->splits[i].index);
+        }
+
+        GF_FREE (local->splits);
+        GF_FREE (local->bufs);
+        GF_FREE (local->op_errnos);
+        LOCK_DESTROY (&local->lock);
+        GF_FREE (local);
+}
+
+
+static int32_t
+bulkstat_split_cbk (call_frame_t *frame, void *cookie, xlator_t *this,
+                    int32_t op_ret, int32_t op_errno, struct iatt *bufs,
+                    int32_t *op_errnos)
+{
+        bulkstat_split_local_t *local     = NULL;
+        bulkstat_split_t       *split     = NULL;
+        int32_t                 i         = 0;
+        int32_t                 j         = 0;
+        int32_t                 call_cnt  = 0;
+
+        local = frame->local;
+        split = cookie;
+
+        LOCK (&local->lock);
+        {
+                for (i = 0; i < split->count; i++) {
+                        j = split->index[i];
+
+                        if (op_ret < 0) {
+                                local->op_errnos[j] = op_errno;
+                                continue;
+                        }
+
+                        local->op_errnos[j] = op_errnos[i];
+                        if (op_errnos[i] == 0)
+                                local->bufs[j] = bufs[i];
+                }
+
+                call_cnt = --local->call_cnt;
+        }
+        UNLOCK (&local->lock);
+
+        if (call_cnt)
+                goto out;
+
+        frame->local = NULL;
+
+        STACK_UNWIND_STRICT (bulkstat, frame, local->count, 0, local->bufs,
+                             local->op_errnos);
+
+        bulkstat_split_local_free (local);
+out:
+        return 0;
+}
+
+
+/*
+ * bulkstat_wind_split - wind a bulkstat to the subvolumes given by
+ *                       @subvol_fn for each entry, and unwind once all of
+ *                       them have replied. entries without a subvolume
+ *                       fail with ESTALE.
+ *
+ * frame->local is used until the unwind and must not be set by the caller.
+ */
+int32_t
+bulkstat_wind_split (call_frame_t *frame, xlator_t *this, loc_t *locs,
+                     int32_t count, bulkstat_subvol_fn_t subvol_fn)
+{
+        bulkstat_split_local_t *local    = NULL;
+        bulkstat_split_t       *split    = NULL;
+        xlator_t               *subvol   = NULL;
+        int32_t                 op_errno = ENOMEM;
+        int32_t                 i        = 0;
+        int32_t                 j        = 0;
+        int32_t                 call_cnt = 0;
+
+        local = GF_CALLOC (1, sizeof (*local), gf_common_mt_bulkstat_t);
+        if (!local)
+                goto err;
+
+        LOCK_INIT (&local->lock);
+        local->count = count;
+
+        local->bufs = GF_CALLOC (count, sizeof (*local->bufs),
+                                 gf_common_mt_bulkstat_t);
+        local->op_errnos = GF_CALLOC (count, sizeof (*local->op_errnos),
+                                      gf_common_mt_bulkstat_t);
+        local->splits = GF_CALLOC (count, sizeof (*local->splits),
+                                   gf_common_mt_bulkstat_t);
+        if (!local->bufs || !local->op_errnos || !local->splits)
+                goto err;
+
+        for (i = 0; i < count; i++) {
+                subvol = subvol_fn (this, &locs[i]);
+                if (!subvol) {
+                        local->op_errnos[i] = ESTALE;
+                        continue;
+                }
+
+                for (j = 0; j < local->split_cnt; j++) {
+                        if (local->splits[j].subvol == subvol)
+                                break;
+                }
+
+                split = &local->splits[j];
+                if (j == local->split_cnt) {
+                        split->subvol = subvol;
+                        split->locs = GF_CALLOC (count, sizeof (loc_t),
+                                                 gf_common_mt_bulkstat_t);
+                        split->index = GF_CALLOC (count, sizeof (int32_t),
+                                                  gf_common_mt_bulkstat_t);
+                        local->split_cnt++;
+                        if (!split->locs || !split->index)
+                                goto err;
+                }
+
+                if (loc_copy (&split->locs[split->count], &locs[i]) != 0)
+                        goto err;
+
+                split->index[split->count++] = i;
+        }
+
+        if (local->split_cnt == 0) {
+                STACK_UNWIND_STRICT (bulkstat, frame, count, 0, local->bufs,
+                                     local->op_errnos);
+                bulkstat_split_local_free (local);
+                return 0;
+        }
+
+        frame->local = local;
+        local->call_cnt = call_cnt = local->split_cnt;
+
+        for (j = 0; j < call_cnt; j++) {
+                split = &local->splits[j];
+                STACK_WIND_COOKIE (frame, bulkstat_split_cbk, split,
+                                   split->subvol, split->subvol->fops->bulkstat,
+                                   split->locs, split->count);
+        }
+
+        return 0;
+
+err:
+        STACK_UNWIND_STRICT (bulkstat, frame, -1, op_errno, NULL, NULL);
+        bulkstat_split_local_free (local);
+        return 0;
+}
+
+
+/*
+ * bulkstat_loc_fill - build the loc of a bulkstat entry for an inode.
+ *                     loc_wipe() releases it.
+ */
+int
+bulkstat_loc_fill (loc_t *loc, inode_t *inode)
+{
+        char *path = NULL;
+        int   ret  = -1;
+
+        GF_VALIDATE_OR_GOTO ("bulkstat", loc, out);
+        GF_VALIDATE_OR_GOTO ("bulkstat", inode, out);
+
+        ret = inode_path (inode, NULL, &path);
+        if (ret < 0)
+                goto out;
+
+        loc->path = path;
+        loc->name = strrchr (path, '/');
+        if (loc->name)
+                loc->name++;
+
+        loc->inode = inode_ref (inode);
+        uuid_copy (loc->gfid, inode->gfid);
+
+        ret = 0;
+out:
+        return ret;
+}
+
+
+void
+bulkstat_locs_wipe (loc_t *locs, int32_t count)
+{
+        int32_t i = 0;
+
+        if (!locs)
+                return;
+
+        for (i = 0; i < count; i++)
+                loc_wipe (&locs[i]);
+
+        GF_FREE (locs);
+}
+
+
+/*
+ * bulkstat_path_is_safe - true if @path is absolute and has no ".."
+ *                         component, so that it can not lead out of the
+ *                         directory it is appended to.
+ */
+gf_boolean_t
+bulkstat_path_is_safe (const char *path)
+{
+        const char *component = NULL;
+        size_t      len       = 0;
+
+        if (!path || (path[0] != '/'))
+                return _gf_false;
+
+        for (component = path; *component; component += len) {
+                while (*component == '/')
+                        component++;
+
+                len = strcspn (component, "/");
+                if ((len == 2) && !strncmp (component, "..", 2))
+                        return _gf_false;
+        }
+
+        return _gf_true;
+}
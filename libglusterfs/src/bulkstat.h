@@ -0,0 +1,62 @@
+/*
+  Copyright (c) 2011 Gluster, Inc. <http://www.gluster.com>
+  This file is part of GlusterFS.
+
+  GlusterFS is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published
+  by the Free Software Foundation; either version 3 of the License,
+  or (at your option) any later version.
+
+  GlusterFS is distributed in the hope that it will be useful, but
+  WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see
+  <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef _BULKSTAT_H
+#define _BULKSTAT_H
+
+#ifndef _CONFIG_H
+#define _CONFIG_H
+#include "config.h"
+#endif
+
+#include "xlator.h"
+
+/*
+ * The bulkstat fop returns the attributes of many inodes in one call, for
+ * caching translators to revalidate what they hold without one stat round
+ * trip per inode. Each loc carries the gfid and path of an inode; an entry
+ * fails with ESTALE if the inode found at the path is not the one with the
+ * gfid. Servers take the path of the inode from their own table when they
+ * know the gfid, and refuse client paths which could lead out of the
+ * export (see bulkstat_path_is_safe()).
+ *
+ * Translators spreading inodes over several subvolumes split a bulkstat
+ * with bulkstat_wind_split(), which sends one bulkstat to every subvolume
+ * concerned and merges the replies.
+ */
+
+#define GF_BULKSTAT_MAX_COUNT  128
+
+/* the subvolume holding the attributes of @loc, NULL if unknown */
+typedef xlator_t *(*bulkstat_subvol_fn_t) (xlator_t *this, loc_t *loc);
+
+int32_t
+bulkstat_wind_split (call_frame_t *frame, xlator_t *this, loc_t *locs,
+                     int32_t count, bulkstat_subvol_fn_t subvol_fn);
+
+int
+bulkstat_loc_fill (loc_t *loc, inode_t *inode);
+
+void
+bulkstat_locs_wipe (loc_t *locs, int32_t count);
+
+gf_boolean_t
+bulkstat_path_is_safe (const char *path);
+
+#endif /* _BULKSTAT_H */
@@ -300,6 +300,212 @@ out:
 }
 
 
+call_stub_t *
+fop_fallocate_stub (call_frame_t *frame,
+                    fop_fallocate_t fn,
+                    fd_t *fd,
+                    int32_t mode,
+                    off_t offset,
+                    size_t len)
+{
+        call_stub_t *stub = NULL;
+
+        GF_VALIDATE_OR_GOTO ("call-stub", frame, out);
+
+        stub = stub_new (frame, 1, GF_FOP_FALLOCATE);
+        GF_VALIDATE_OR_GOTO ("call-stub", stub, out);
+
+        stub->args.fallocate.fn = fn;
+        if (fd)
+                stub->args.fallocate.fd = fd_ref (fd);
+
+        stub->args.fallocate.mode = mode;
+        stub->args.fallocate.offset = offset;
+        stub->args.fallocate.len = len;
+out:
+        return stub;
+}
+
+
+call_stub_t *
+fop_fallocate_cbk_stub (call_frame_t *frame,
+                        fop_fallocate_cbk_t fn,
+                        int32_t op_ret,
+                        int32_t op_errno,
+                        struct iatt *prebuf,
+                        struct iatt *postbuf)
+{
+        call_stub_t *stub = NULL;
+
+        GF_VALIDATE_OR_GOTO ("call-stub", frame, out);
+
+        stub = stub_new (frame, 0, GF_FOP_FALLOCATE);
+        GF_VALIDATE_OR_GOTO ("call-stub", stub, out);
+
+        stub->args.fallocate_cbk.fn = fn;
+        stub->args.fallocate_cbk.op_ret = op_ret;
+        stub->args.fallocate_cbk.op_errno = op_errno;
+        if (prebuf)
+                stub->args.fallocate_cbk.prebuf = *prebuf;
+        if (postbuf)
+                stub->args.fallocate_cbk.postbuf = *postbuf;
+out:
+        return stub;
+}
+
+
+call_stub_t *
+fop_discard_stub (call_frame_t *frame,
+                  fop_discard_t fn,
+                  fd_t *fd,
+                  off_t offset,
+                  size_t len)
+{
+        call_stub_t *stub = NULL;
+
+        GF_VALIDATE_OR_GOTO ("call-stub", frame, out);
+
+        stub = stub_new (frame, 1, GF_FOP_DISCARD);
+        GF_VALIDATE_OR_GOTO ("call-stub", stub, out);
+
+        stub->args.discard.fn = fn;
+        if (fd)
+                stub->args.discard.fd = fd_ref (fd);
+
+        stub->args.discard.offset = offset;
+        stub->args.discard.len = len;
+out:
+        return stub;
+}
+
+
+call_stub_t *
+fop_discard_cbk_stub (call_frame_t *frame,
+                      fop_discard_cbk_t fn,
+                      int32_t op_ret,
+                      int32_t op_errno,
+                      struct iatt *prebuf,
+                      struct iatt *postbuf)
+{
+        call_stub_t *stub = NULL;
+
+        GF_VALIDATE_OR_GOTO ("call-stub", frame, out);
+
+        stub = stub_new (frame, 0, GF_FOP_DISCARD);
+        GF_VALIDATE_OR_GOTO ("call-stub", stub, out);
+
+        stub->args.discard_cbk.fn = fn;
+        stub->args.discard_cbk.op_ret = op_ret;
+        stub->args.discard_cbk.op_errno = op_errno;
+        if (prebuf)
+                stub->args.discard_cbk.prebuf = *prebuf;
+        if (postbuf)
+                stub->args.discard_cbk.postbuf = *postbuf;
+out:
+        return stub;
+}
+
+
+call_stub_t *
+fop_zerofill_stub (call_frame_t *frame,
+                   fop_zerofill_t fn,
+                   fd_t *fd,
+                   off_t offset,
+                   size_t len)
+{
+        call_stub_t *stub = NULL;
+
+        GF_VALIDATE_OR_GOTO ("call-stub", frame, out);
+
+        stub = stub_new (frame, 1, GF_FOP_ZEROFILL);
+        GF_VALIDATE_OR_GOTO ("call-stub", stub, out);
+
+        stub->args.zerofill.fn = fn;
+        if (fd)
+                stub->args.zerofill.fd = fd_ref (fd);
+
+        stub->args.zerofill.offset = offset;
+        stub->args.zerofill.len = len;
+out:
+        return stub;
+}
+
+
+call_stub_t *
+fop_zerofill_cbk_stub (call_frame_t *frame,
+                       fop_zerofill_cbk_t fn,
+                       int32_t op_ret,
+                       int32_t op_errno,
+                       struct iatt *prebuf,
+                       struct iatt *postbuf)
+{
+        call_stub_t *stub = NULL;
+
+        GF_VALIDATE_OR_GOTO ("call-stub", frame, out);
+
+        stub = stub_new (frame, 0, GF_FOP_ZEROFILL);
+        GF_VALIDATE_OR_GOTO ("call-stub", stub, out);
+
+        stub->args.zerofill_cbk.fn = fn;
+        stub->args.zerofill_cbk.op_ret = op_ret;
+        stub->args.zerofill_cbk.op_errno = op_errno;
+        if (prebuf)
+                stub->args.zerofill_cbk.prebuf = *prebuf;
+        if (postbuf)
+                stub->args.zerofill_cbk.postbuf = *postbuf;
+out:
+        return stub;
+}
+
+
+call_stub_t *
+fop_seek_stub (call_frame_t *frame,
+               fop_seek_t fn,
+               fd_t *fd,
+               off_t offset,
+               gf_seek_what_t what)
+{
+        call_stub_t *stub = NULL;
+
+        GF_VALIDATE_OR_GOTO ("call-stub", frame, out);
+
+        stub = stub_new (frame, 1, GF_FOP_SEEK);
+        GF_VALIDATE_OR_GOTO ("call-stub", stub, out);
+
+        stub->args.seek.fn = fn;
+        if (fd)
+                stub->args.seek.fd = fd_ref (fd);
+
+        stub->args.seek.offset = offset;
+        stub->args.seek.what = what;
+out:
+        return stub;
+}
+
+
+call_stub_t *
+fop_seek_cbk_stub (call_frame_t *frame,
+                   fop_seek_cbk_t fn,
+                   int32_t op_ret,
+                   int32_t op_errno,
+                   off_t offset)
+{
+        call_stub_t *stub = NULL;
+
+        GF_VALIDATE_OR_GOTO ("call-stub", frame, out);
+
+        stub = stub_new (frame, 0, GF_FOP_SEEK);
+        GF_VALIDATE_OR_GOTO ("call-stub", stub, out);
+
+        stub->args.seek_cbk.fn = fn;
+        stub->args.seek_cbk.op_ret = op_ret;
+        stub->args.seek_cbk.op_errno = op_errno;
+        stub->args.seek_cbk.offset = offset;
+out:
+        return stub;
+}
+
+
 call_stub_t *
 fop_access_stub (call_frame_t *frame,
                  fop_access_t fn,
@@ -1881,6 +2087,38 @@ out:
 }
 
 
+call_stub_t *
+fop_bulkstat_stub (call_frame_t *frame,
+                   fop_bulkstat_t fn,
+                   loc_t *locs,
+                   int32_t count)
+{
+        call_stub_t *stub = NULL;
+        int32_t      i    = 0;
+
+        GF_VALIDATE_OR_GOTO ("call-stub", frame, out);
+        GF_VALIDATE_OR_GOTO ("call-stub", locs, out);
+
+        stub = stub_new (frame, 1, GF_FOP_BULKSTAT);
+        GF_VALIDATE_OR_GOTO ("call-stub", stub, out);
+
+        stub->args.bulkstat.fn = fn;
+        stub->args.bulkstat.locs = GF_CALLOC (count, sizeof (loc_t),
+                                              gf_common_mt_bulkstat_t);
+        if (!stub->args.bulkstat.locs) {
+                call_stub_destroy (stub);
+                stub = NULL;
+                goto out;
+        }
+
+        for (i = 0; i < count; i++)
+                loc_copy (&stub->args.bulkstat.locs[i], &locs[i]);
+        stub->args.bulkstat.count = count;
+out:
+        return stub;
+}
+
+
 call_stub_t *
 fop_xattrop_cbk_stub (call_frame_t *frame,
                       fop_xattrop_cbk_t fn,
@@ -2337,6 +2575,47 @@ call_resume_wind (call_stub_t *stub)
                 break;
         }
 
+        case GF_FOP_FALLOCATE:
+        {
+                stub->args.fallocate.fn (stub->frame,
+                                         stub->frame->this,
+                                         stub->args.fallocate.fd,
+                                         stub->args.fallocate.mode,
+                                         stub->args.fallocate.offset,
+                                         stub->args.fallocate.len);
+                break;
+        }
+
+        case GF_FOP_DISCARD:
+        {
+                stub->args.discard.fn (stub->frame,
+                                       stub->frame->this,
+                                       stub->args.discard.fd,
+                                       stub->args.discard.offset,
+                                       stub->args.discard.len);
+                break;
+        }
+
+        case GF_FOP_ZEROFILL:
+        {
+                stub->args.zerofill.fn (stub->frame,
+                                        stub->frame->this,
+                                        stub->args.zerofill.fd,
+                                        stub->args.zerofill.offset,
+                                        stub->args.zerofill.len);
+                break;
+        }
+
+        case GF_FOP_SEEK:
+        {
+                stub->args.seek.fn (stub->frame,
+                                    stub->frame->this,
+                                    stub->args.seek.fd,
+                                    stub->args.seek.offset,
+                                    stub->args.seek.what);
+                break;
+        }
+
         case GF_FOP_FSTAT:
         {
                 stub->args.fstat.fn (stub->frame,
@@ -2422,6 +2701,15 @@ call_resume_wind (call_stub_t *stub)
                 break;
         }
 
+        case GF_FOP_BULKSTAT:
+        {
+                stub->args.bulkstat.fn (stub->frame,
+                                        stub->frame->this,
+                                        stub->args.bulkstat.locs,
+                                        stub->args.bulkstat.count);
+                break;
+        }
+
         case GF_FOP_READDIR:
         {
                 stub->args.readdir.fn (stub->frame,
@@ -3003,6 +3291,80 @@ call_resume_unwind (call_stub_t *stub)
                 break;
         }
 
+        case GF_FOP_FALLOCATE:
+        {
+                if (!stub->args.fallocate_cbk.fn)
+                        STACK_UNWIND (stub->frame,
+                                      stub->args.fallocate_cbk.op_ret,
+                                      stub->args.fallocate_cbk.op_errno,
+                                      &stub->args.fallocate_cbk.prebuf,
+                                      &stub->args.fallocate_cbk.postbuf);
+                else
+                        stub->args.fallocate_cbk.fn (stub->frame,
+                                                     stub->frame->cookie,
+                                                     stub->frame->this,
+                                                     stub->args.fallocate_cbk.op_ret,
+                                                     stub->args.fallocate_cbk.op_errno,
+                                                     &stub->args.fallocate_cbk.prebuf,
+                                                     &stub->args.fallocate_cbk.postbuf);
+                break;
+        }
+
+        case GF_FOP_DISCARD:
+        {
+                if (!stub->args.discard_cbk.fn)
+                        STACK_UNWIND (stub->frame,
+                                      stub->args.discard_cbk.op_ret,
+                                      stub->args.discard_cbk.op_errno,
+                                      &stub->args.discard_cbk.prebuf,
+                                      &stub->args.discard_cbk.postbuf);
+                else
+                        stub->args.discard_cbk.fn (stub->frame,
+                                                   stub->frame->cookie,
+                                                   stub->frame->this,
+                                                   stub->args.discard_cbk.op_ret,
+                                                   stub->args.discard_cbk.op_errno,
+                                                   &stub->args.discard_cbk.prebuf,
+                                                   &stub->args.discard_cbk.postbuf);
+                break;
+        }
+
+        case GF_FOP_ZEROFILL:
+        {
+                if (!stub->args.zerofill_cbk.fn)
+                        STACK_UNWIND (stub->frame,
+                                      stub->args.zerofill_cbk.op_ret,
+                                      stub->args.zerofill_cbk.op_errno,
+                                      &stub->args.zerofill_cbk.prebuf,
+                                      &stub->args.zerofill_cbk.postbuf);
+                else
+                        stub->args.zerofill_cbk.fn (stub->frame,
+                                                    stub->frame->cookie,
+                                                    stub->frame->this,
+                                                    stub->args.zerofill_cbk.op_ret,
+                                                    stub->args.zerofill_cbk.op_errno,
+                                                    &stub->args.zerofill_cbk.prebuf,
+                                                    &stub->args.zerofill_cbk.postbuf);
+                break;
+        }
+
+        case GF_FOP_SEEK:
+        {
+                if (!stub->args.seek_cbk.fn)
+                        STACK_UNWIND (stub->frame,
+                                      stub->args.seek_cbk.op_ret,
+                                      stub->args.seek_cbk.op_errno,
+                                      stub->args.seek_cbk.offset);
+                else
+                        stub->args.seek_cbk.fn (stub->frame,
+                                                stub->frame->cookie,
+                                                stub->frame->this,
+                                                stub->args.seek_cbk.op_ret,
+                                                stub->args.seek_cbk.op_errno,
+                                                stub->args.seek_cbk.offset);
+                break;
+        }
+
         case GF_FOP_FSTAT:
         {
                 if (!stub->args.fstat_cbk.fn)
@@ -3479,6 +3841,34 @@ call_stub_destroy_wind (call_stub_t *stub)
                 break;
         }
 
+        case GF_FOP_FALLOCATE:
+        {
+                if (stub->args.fallocate.fd)
+                        fd_unref (stub->args.fallocate.fd);
+                break;
+        }
+
+        case GF_FOP_DISCARD:
+        {
+                if (stub->args.discard.fd)
+                        fd_unref (stub->args.discard.fd);
+                break;
+        }
+
+        case GF_FOP_ZEROFILL:
+        {
+                if (stub->args.zerofill.fd)
+                        fd_unref (stub->args.zerofill.fd);
+                break;
+        }
+
+        case GF_FOP_SEEK:
+        {
+                if (stub->args.seek.fd)
+                        fd_unref (stub->args.seek.fd);
+                break;
+        }
+
         case GF_FOP_FSTAT:
         {
                 if (stub->args.fstat.fd)
@@ -3548,6 +3938,18 @@ call_stub_destroy_wind (call_stub_t *stub)
                 break;
         }
 
+        case GF_FOP_BULKSTAT:
+        {
+                int32_t i = 0;
+
+                if (stub->args.bulkstat.locs) {
+                        for (i = 0; i < stub->args.bulkstat.count; i++)
+                                loc_wipe (&stub->args.bulkstat.locs[i]);
+                        GF_FREE (stub->args.bulkstat.locs);
+                }
+                break;
+        }
+
         case GF_FOP_READDIR:
         {
                 if (stub->args.readdir.fd)
@@ -3732,6 +4134,18 @@ call_stub_destroy_unwind (call_stub_t *stub)
         case GF_FOP_FTRUNCATE:
                 break;
 
+        case GF_FOP_FALLOCATE:
+                break;
+
+        case GF_FOP_DISCARD:
+                break;
+
+        case GF_FOP_ZEROFILL:
+                break;
+
+        case GF_FOP_SEEK:
+                break;
+
         case GF_FOP_FSTAT:
                 break;
 
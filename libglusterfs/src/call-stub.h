@@ -35,6 +35,8 @@ typedef struct {
 	call_frame_t *frame;
 	glusterfs_fop_t fop;
        struct mem_pool *stub_mem_pool;    /* pointer to stub mempool in glusterfs ctx */
+        struct timeval queued;             /* set by the translators queueing
+                                              the stub, eg. io-threads */
 
 	union {
 		/* lookup */
@@ -100,6 +102,62 @@ typedef struct {
                         struct iatt postbuf;
 		} ftruncate_cbk;
 
+		/* fallocate */
+		struct {
+			fop_fallocate_t fn;
+			fd_t *fd;
+			int32_t mode;
+			off_t offset;
+			size_t len;
+		} fallocate;
+		struct {
+			fop_fallocate_cbk_t fn;
+			int32_t op_ret, op_errno;
+			struct iatt prebuf;
+                        struct iatt postbuf;
+		} fallocate_cbk;
+
+		/* discard */
+		struct {
+			fop_discard_t fn;
+			fd_t *fd;
+			off_t offset;
+			size_t len;
+		} discard;
+		struct {
+			fop_discard_cbk_t fn;
+			int32_t op_ret, op_errno;
+			struct iatt prebuf;
+                        struct iatt postbuf;
+		} discard_cbk;
+
+		/* zerofill */
+		struct {
+			fop_zerofill_t fn;
+			fd_t *fd;
+			off_t offset;
+			size_t len;
+		} zerofill;
+		struct {
+			fop_zerofill_cbk_t fn;
+			int32_t op_ret, op_errno;
+			struct iatt prebuf;
+                        struct iatt postbuf;
+		} zerofill_cbk;
+
+		/* seek */
+		struct {
+			fop_seek_t fn;
+			fd_t *fd;
+			off_t offset;
+			gf_seek_what_t what;
+		} seek;
+		struct {
+			fop_seek_cbk_t fn;
+			int32_t op_ret, op_errno;
+			off_t offset;
+		} seek_cbk;
+
 		/* access */
 		struct {
 			fop_access_t fn;
@@ -523,6 +581,13 @@ typedef struct {
 			uint8_t *strong_checksum;
 		} rchecksum_cbk;
 
+		/* bulkstat */
+		struct {
+			fop_bulkstat_t fn;
+			loc_t *locs;
+			int32_t count;
+		} bulkstat;
+
 		/* xattrop */
 		struct {
 			fop_xattrop_t fn;
@@ -648,6 +713,66 @@ fop_ftruncate_cbk_stub (call_frame_t *frame,
 			struct iatt *prebuf,
                         struct iatt *postbuf);
 
+call_stub_t *
+fop_fallocate_stub (call_frame_t *frame,
+                    fop_fallocate_t fn,
+                    fd_t *fd,
+                    int32_t mode,
+                    off_t offset,
+                    size_t len);
+
+call_stub_t *
+fop_fallocate_cbk_stub (call_frame_t *frame,
+                        fop_fallocate_cbk_t fn,
+                        int32_t op_ret,
+                        int32_t op_errno,
+                        struct iatt *prebuf,
+                        struct iatt *postbuf);
+
+call_stub_t *
+fop_discard_stub (call_frame_t *frame,
+                  fop_discard_t fn,
+                  fd_t *fd,
+                  off_t offset,
+                  size_t len);
+
+call_stub_t *
+fop_discard_cbk_stub (call_frame_t *frame,
+                      fop_discard_cbk_t fn,
+                      int32_t op_ret,
+                      int32_t op_errno,
+                      struct iatt *prebuf,
+                      struct iatt *postbuf);
+
+call_stub_t *
+fop_zerofill_stub (call_frame_t *frame,
+                   fop_zerofill_t fn,
+                   fd_t *fd,
+                   off_t offset,
+                   size_t len);
+
+call_stub_t *
+fop_zerofill_cbk_stub (call_frame_t *frame,
+                       fop_zerofill_cbk_t fn,
+                       int32_t op_ret,
+                       int32_t op_errno,
+                       struct iatt *prebuf,
+                       struct iatt *postbuf);
+
+call_stub_t *
+fop_seek_stub (call_frame_t *frame,
+               fop_seek_t fn,
+               fd_t *fd,
+               off_t offset,
+               gf_seek_what_t what);
+
+call_stub_t *
+fop_seek_cbk_stub (call_frame_t *frame,
+                   fop_seek_cbk_t fn,
+                   int32_t op_ret,
+                   int32_t op_errno,
+                   off_t offset);
+
 call_stub_t *
 fop_access_stub (call_frame_t *frame,
 		 fop_access_t fn,
@@ -1055,6 +1180,12 @@ fop_rchecksum_cbk_stub (call_frame_t *frame,
                         uint32_t weak_checksum,
                         uint8_t *strong_checksum);
 
+call_stub_t *
+fop_bulkstat_stub (call_frame_t *frame,
+                   fop_bulkstat_t fn,
+                   loc_t *locs,
+                   int32_t count);
+
 call_stub_t *
 fop_xattrop_stub (call_frame_t *frame,
 		  fop_xattrop_t fn,
@@ -0,0 +1,532 @@
+/*
+  Copyright (c) 2011 Gluster, Inc. <http://www.gluster.com>
+  This file is part of GlusterFS.
+
+  GlusterFS is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published
+  by the Free Software Foundation; either version 3 of the License,
+  or (at your option) any later version.
+
+  GlusterFS is distributed in the hope that it will be useful, but
+  WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see
+  <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef _CONFIG_H
+#define _CONFIG_H
+#include "config.h"
+#endif
+
+#include "compound.h"
+
+
+compound_args_t *
+compound_args_new (void)
+{
+        compound_args_t *args = NULL;
+
+        args = GF_CALLOC (1, sizeof (*args), gf_common_mt_compound_args_t);
+
+        return args;
+}
+
+
+void
+compound_rsp_wipe (compound_rsp_t *rsp)
+{
+        if (rsp->inode)
+                inode_unref (rsp->inode);
+        if (rsp->xattr)
+                dict_unref (rsp->xattr);
+        if (rsp->vector)
+                GF_FREE (rsp->vector);
+        if (rsp->iobref)
+                iobref_unref (rsp->iobref);
+
+        memset (rsp, 0, sizeof (*rsp));
+}
+
+
+void
+compound_args_destroy (compound_args_t *args)
+{
+        compound_req_t *req = NULL;
+        int             i   = 0;
+
+        if (!args)
+                return;
+
+        for (i = 0; i < args->count; i++) {
+                req = &args->req[i];
+
+                loc_wipe (&req->loc);
+                if (req->fd)
+                        fd_unref (req->fd);
+                if (req->xattr)
+                        dict_unref (req->xattr);
+                if (req->vector)
+                        GF_FREE (req->vector);
+                if (req->iobref)
+                        iobref_unref (req->iobref);
+
+                compound_rsp_wipe (&args->rsp[i]);
+        }
+
+        GF_FREE (args);
+}
+
+
+/* forget the results of an execution, so that the compound can be wound
+   again */
+void
+compound_args_reset (compound_args_t *args)
+{
+        int i = 0;
+
+        for (i = 0; i < args->count; i++)
+                compound_rsp_wipe (&args->rsp[i]);
+
+        args->done = 0;
+}
+
+
+static compound_req_t *
+compound_req_add (compound_args_t *args, glusterfs_fop_t fop)
+{
+        compound_req_t *req = NULL;
+
+        if (!args || (args->count >= GF_COMPOUND_MAX_FOPS))
+                goto out;
+
+        req = &args->req[args->count];
+        req->fop = fop;
+out:
+        return req;
+}
+
+
+int
+compound_lookup (compound_args_t *args, loc_t *loc, dict_t *xattr_req)
+{
+        compound_req_t *req = NULL;
+
+        req = compound_req_add (args, GF_FOP_LOOKUP);
+        if (!req || loc_copy (&req->loc, loc))
+                return -1;
+
+        if (xattr_req)
+                req->xattr = dict_ref (xattr_req);
+
+        return args->count++;
+}
+
+
+int
+compound_open (compound_args_t *args, loc_t *loc, int32_t flags, fd_t *fd,
+               int32_t wbflags)
+{
+        compound_req_t *req = NULL;
+
+        req = compound_req_add (args, GF_FOP_OPEN);
+        if (!req || !fd || loc_copy (&req->loc, loc))
+                return -1;
+
+        req->fd      = fd_ref (fd);
+        req->flags   = flags;
+        req->wbflags = wbflags;
+
+        return args->count++;
+}
+
+
+int
+compound_create (compound_args_t *args, loc_t *loc, int32_t flags,
+                 mode_t mode, fd_t *fd, dict_t *params)
+{
+        compound_req_t *req = NULL;
+
+        req = compound_req_add (args, GF_FOP_CREATE);
+        if (!req || !fd || loc_copy (&req->loc, loc))
+                return -1;
+
+        req->fd    = fd_ref (fd);
+        req->flags = flags;
+        req->mode  = mode;
+        if (params)
+                req->xattr = dict_ref (params);
+
+        return args->count++;
+}
+
+
+int
+compound_readv (compound_args_t *args, fd_t *fd, size_t size, off_t offset)
+{
+        compound_req_t *req = NULL;
+
+        req = compound_req_add (args, GF_FOP_READ);
+        if (!req || !fd)
+                return -1;
+
+        req->fd     = fd_ref (fd);
+        req->size   = size;
+        req->offset = offset;
+
+        return args->count++;
+}
+
+
+int
+compound_writev (compound_args_t *args, fd_t *fd, struct iovec *vector,
+                 int32_t count, off_t offset, struct iobref *iobref)
+{
+        compound_req_t *req = NULL;
+
+        req = compound_req_add (args, GF_FOP_WRITE);
+        if (!req || !fd)
+                return -1;
+
+        req->vector = iov_dup (vector, count);
+        if (!req->vector)
+                return -1;
+
+        req->fd     = fd_ref (fd);
+        req->count  = count;
+        req->size   = iov_length (vector, count);
+        req->offset = offset;
+        if (iobref)
+                req->iobref = iobref_ref (iobref);
+
+        return args->count++;
+}
+
+
+int
+compound_flush (compound_args_t *args, fd_t *fd)
+{
+        compound_req_t *req = NULL;
+
+        req = compound_req_add (args, GF_FOP_FLUSH);
+        if (!req || !fd)
+                return -1;
+
+        req->fd = fd_ref (fd);
+
+        return args->count++;
+}
+
+
+/* index of the OPEN/CREATE which yields the fd of sub-fop @index,
+   -1 if the fd is expected to be open already */
+int
+compound_linked_fd (compound_args_t *args, int index)
+{
+        compound_req_t *req = NULL;
+        int             i   = 0;
+
+        req = &args->req[index];
+
+        switch (req->fop) {
+        case GF_FOP_READ:
+        case GF_FOP_WRITE:
+        case GF_FOP_FLUSH:
+                break;
+        default:
+                return -1;
+        }
+
+        for (i = index - 1; i >= 0; i--) {
+                if (((args->req[i].fop == GF_FOP_OPEN)
+                     || (args->req[i].fop == GF_FOP_CREATE))
+                    && (args->req[i].fd == req->fd))
+                        return i;
+        }
+
+        return -1;
+}
+
+
+/* index of the LOOKUP/CREATE which yields the inode of sub-fop @index,
+   -1 if the loc of @index is complete by itself */
+int
+compound_linked_inode (compound_args_t *args, int index)
+{
+        compound_req_t *req = NULL;
+        int             i   = 0;
+
+        req = &args->req[index];
+
+        if (req->fop != GF_FOP_OPEN)
+                return -1;
+
+        if (!uuid_is_null (req->loc.gfid)
+            || (req->loc.inode && !uuid_is_null (req->loc.inode->gfid)))
+                return -1;
+
+        for (i = index - 1; i >= 0; i--) {
+                if ((args->req[i].fop == GF_FOP_LOOKUP)
+                    || (args->req[i].fop == GF_FOP_CREATE))
+                        return i;
+        }
+
+        return -1;
+}
+
+
+int
+compound_rsp_set (compound_args_t *args, int index, int32_t op_ret,
+                  int32_t op_errno, inode_t *inode, struct iatt *stat,
+                  struct iatt *prestat, struct iatt *postparent,
+                  dict_t *xattr, struct iovec *vector, int32_t count,
+                  struct iobref *iobref)
+{
+        compound_rsp_t *rsp = NULL;
+
+        if (!args || (index >= args->count))
+                return -1;
+
+        rsp = &args->rsp[index];
+
+        rsp->op_ret   = op_ret;
+        rsp->op_errno = op_errno;
+
+        if (op_ret < 0)
+                return 0;
+
+        if (inode)
+                rsp->inode = inode_ref (inode);
+        if (stat)
+                rsp->stat = *stat;
+        if (prestat)
+                rsp->prestat = *prestat;
+        if (postparent)
+                rsp->postparent = *postparent;
+        if (xattr)
+                rsp->xattr = dict_ref (xattr);
+        if (vector && count) {
+                rsp->vector = iov_dup (vector, count);
+                if (!rsp->vector) {
+                        rsp->op_ret   = -1;
+                        rsp->op_errno = ENOMEM;
+                        return 0;
+                }
+                rsp->count = count;
+        }
+        if (iobref)
+                rsp->iobref = iobref_ref (iobref);
+
+        return 0;
+}
+
+
+void
+compound_args_fail (compound_args_t *args, int from, int32_t op_errno)
+{
+        int i = 0;
+
+        for (i = from; i < args->count; i++) {
+                args->rsp[i].op_ret   = -1;
+                args->rsp[i].op_errno = op_errno;
+        }
+}
+
+
+/* Serial execution, used by translators which do not handle compound fops
+   themselves: every sub-fop is wound to @this as an individual fop. */
+
+static int
+compound_serial_wind (call_frame_t *frame, xlator_t *this,
+                      compound_args_t *args);
+
+static int
+compound_serial_resume (call_frame_t *frame, xlator_t *this,
+                        compound_args_t *args)
+{
+        compound_rsp_t *rsp = NULL;
+
+        rsp = &args->rsp[args->done];
+        args->done++;
+
+        if (rsp->op_ret < 0) {
+                compound_args_fail (args, args->done, rsp->op_errno);
+                STACK_UNWIND_STRICT (compound, frame, -1, rsp->op_errno, args);
+                return 0;
+        }
+
+        if (args->done == args->count) {
+                STACK_UNWIND_STRICT (compound, frame, 0, 0, args);
+                return 0;
+        }
+
+        compound_serial_wind (frame, this, args);
+
+        return 0;
+}
+
+
+static int
+compound_serial_lookup_cbk (call_frame_t *frame, void *cookie,
+                            xlator_t *this, int32_t op_ret, int32_t op_errno,
+                            inode_t *inode, struct iatt *buf, dict_t *xattr,
+                            struct iatt *postparent)
+{
+        compound_args_t *args = cookie;
+
+        compound_rsp_set (args, args->done, op_ret, op_errno, inode, buf,
+                          NULL, postparent, xattr, NULL, 0, NULL);
+
+        return compound_serial_resume (frame, this, args);
+}
+
+
+static int
+compound_serial_open_cbk (call_frame_t *frame, void *cookie, xlator_t *this,
+                          int32_t op_ret, int32_t op_errno, fd_t *fd)
+{
+        compound_args_t *args = cookie;
+
+        compound_rsp_set (args, args->done, op_ret, op_errno, NULL, NULL,
+                          NULL, NULL, NULL, NULL, 0, NULL);
+
+        return compound_serial_resume (frame, this, args);
+}
+
+
+static int
+compound_serial_create_cbk (call_frame_t *frame, void *cookie,
+                            xlator_t *this, int32_t op_ret, int32_t op_errno,
+                            fd_t *fd, inode_t *inode, struct iatt *buf,
+                            struct iatt *preparent, struct iatt *postparent)
+{
+        compound_args_t *args = cookie;
+
+        compound_rsp_set (args, args->done, op_ret, op_errno, inode, buf,
+                          preparent, postparent, NULL, NULL, 0, NULL);
+
+        return compound_serial_resume (frame, this, args);
+}
+
+
+static int
+compound_serial_readv_cbk (call_frame_t *frame, void *cookie, xlator_t *this,
+                           int32_t op_ret, int32_t op_errno,
+                           struct iovec *vector, int32_t count,
+                           struct iatt *stbuf, struct iobref *iobref)
+{
+        compound_args_t *args = cookie;
+
+        compound_rsp_set (args, args->done, op_ret, op_errno, NULL, stbuf,
+                          NULL, NULL, NULL, vector, count, iobref);
+
+        return compound_serial_resume (frame, this, args);
+}
+
+
+static int
+compound_serial_writev_cbk (call_frame_t *frame, void *cookie, xlator_t *this,
+                            int32_t op_ret, int32_t op_errno,
+                            struct iatt *prebuf, struct iatt *postbuf)
+{
+        compound_args_t *args = cookie;
+
+        compound_rsp_set (args, args->done, op_ret, op_errno, NULL, postbuf,
+                          prebuf, NULL, NULL, NULL, 0, NULL);
+
+        return compound_serial_resume (frame, this, args);
+}
+
+
+static int
+compound_serial_flush_cbk (call_frame_t *frame, void *cookie, xlator_t *this,
+                           int32_t op_ret, int32_t op_errno)
+{
+        compound_args_t *args = cookie;
+
+        compound_rsp_set (args, args->done, op_ret, op_errno, NULL, NULL,
+                          NULL, NULL, NULL, NULL, 0, NULL);
+
+        return compound_serial_resume (frame, this, args);
+}
+
+
+static int
+compound_serial_wind (call_frame_t *frame, xlator_t *this,
+                      compound_args_t *args)
+{
+        compound_req_t *req    = NULL;
+        int             linked = -1;
+
+        req = &args->req[args->done];
+
+        linked = compound_linked_inode (args, args->done);
+        if (linked >= 0) {
+                if (!req->loc.inode && args->rsp[linked].inode)
+                        req->loc.inode = inode_ref (args->rsp[linked].inode);
+                uuid_copy (req->loc.gfid, args->rsp[linked].stat.ia_gfid);
+        }
+
+        switch (req->fop) {
+        case GF_FOP_LOOKUP:
+                STACK_WIND_COOKIE (frame, compound_serial_lookup_cbk, args,
+                                   this, this->fops->lookup,
+                                   &req->loc, req->xattr);
+                break;
+        case GF_FOP_OPEN:
+                STACK_WIND_COOKIE (frame, compound_serial_open_cbk, args,
+                                   this, this->fops->open,
+                                   &req->loc, req->flags, req->fd,
+                                   req->wbflags);
+                break;
+        case GF_FOP_CREATE:
+                STACK_WIND_COOKIE (frame, compound_serial_create_cbk, args,
+                                   this, this->fops->create,
+                                   &req->loc, req->flags, req->mode, req->fd,
+                                   req->xattr);
+                break;
+        case GF_FOP_READ:
+                STACK_WIND_COOKIE (frame, compound_serial_readv_cbk, args,
+                                   this, this->fops->readv,
+                                   req->fd, req->size, req->offset);
+                break;
+        case GF_FOP_WRITE:
+                STACK_WIND_COOKIE (frame, compound_serial_writev_cbk, args,
+                                   this, this->fops->writev,
+                                   req->fd, req->vector, req->count,
+                                   req->offset, req->iobref);
+                break;
+        case GF_FOP_FLUSH:
+                STACK_WIND_COOKIE (frame, compound_serial_flush_cbk, args,
+                                   this, this->fops->flush, req->fd);
+                break;
+        default:
+                gf_log (this->name, GF_LOG_WARNING,
+                        "%s is not supported in a compound fop",
+                        gf_fop_list[req->fop]);
+                compound_rsp_set (args, args->done, -1, ENOTSUP, NULL, NULL,
+                                  NULL, NULL, NULL, NULL, 0, NULL);
+                compound_serial_resume (frame, this, args);
+                break;
+        }
+
+        return 0;
+}
+
+
+int
+compound_fop_serial (call_frame_t *frame, xlator_t *this,
+                     compound_args_t *args)
+{
+        if (!args || !args->count) {
+                STACK_UNWIND_STRICT (compound, frame, -1, EINVAL, args);
+                return 0;
+        }
+
+        args->done = 0;
+
+        return compound_serial_wind (frame, this, args);
+}
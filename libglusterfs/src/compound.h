@@ -0,0 +1,146 @@
+/*
+  Copyright (c) 2011 Gluster, Inc. <http://www.gluster.com>
+  This file is part of GlusterFS.
+
+  GlusterFS is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published
+  by the Free Software Foundation; either version 3 of the License,
+  or (at your option) any later version.
+
+  GlusterFS is distributed in the hope that it will be useful, but
+  WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see
+  <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef _COMPOUND_H
+#define _COMPOUND_H
+
+#ifndef _CONFIG_H
+#define _CONFIG_H
+#include "config.h"
+#endif
+
+#include "xlator.h"
+
+/*
+ * A compound fop is an ordered list of sub-fops which are executed one
+ * after the other, stopping at the first failure. A later sub-fop can
+ * consume the result of an earlier one:
+ *
+ *  - an OPEN whose loc carries no gfid operates on the inode returned by
+ *    the LOOKUP or CREATE preceding it
+ *  - READ, WRITE and FLUSH on the fd_t given to an earlier OPEN or CREATE
+ *    of the same compound operate on that fd, even though it is not yet
+ *    open when the compound is wound
+ *
+ * protocol/client sends the whole list to the brick in a single round
+ * trip. Translators which do not implement the compound fop get
+ * default_compound(): it passes the compound down whole when the
+ * translator has a single child and implements none of the sub-fops,
+ * and otherwise breaks it down into the individual fops on the same
+ * translator, so a compound is always safe to wind. distribute sends it
+ * whole to the subvolume holding the file; replicate breaks it down, its
+ * fops need transactions and self-heal checks across the children.
+ * A compound made only of lookups by name, of files which distribute
+ * finds on different subvolumes, is split into one compound for each of
+ * them: the lookups are then independent, each one reports its own
+ * result and all of them are executed.
+ */
+
+#define GF_COMPOUND_MAX_FOPS  8
+
+typedef struct _compound_req {
+        glusterfs_fop_t   fop;
+        loc_t             loc;
+        fd_t             *fd;
+        dict_t           *xattr;      /* lookup xattr_req, create params */
+        int32_t           flags;
+        int32_t           wbflags;
+        mode_t            mode;
+        size_t            size;
+        off_t             offset;
+        struct iovec     *vector;
+        int32_t           count;
+        struct iobref    *iobref;
+} compound_req_t;
+
+typedef struct _compound_rsp {
+        int32_t           op_ret;
+        int32_t           op_errno;
+        inode_t          *inode;
+        struct iatt       stat;       /* lookup, create, readv buf and
+                                         writev postbuf */
+        struct iatt       prestat;    /* writev prebuf, create preparent */
+        struct iatt       postparent;
+        dict_t           *xattr;
+        struct iovec     *vector;
+        int32_t           count;
+        struct iobref    *iobref;
+} compound_rsp_t;
+
+struct _compound_args {
+        int32_t           count;      /* number of sub-fops */
+        int32_t           done;       /* number of sub-fops executed */
+        compound_req_t    req[GF_COMPOUND_MAX_FOPS];
+        compound_rsp_t    rsp[GF_COMPOUND_MAX_FOPS];
+};
+
+compound_args_t *
+compound_args_new (void);
+
+void
+compound_args_destroy (compound_args_t *args);
+
+void
+compound_args_reset (compound_args_t *args);
+
+void
+compound_rsp_wipe (compound_rsp_t *rsp);
+
+int
+compound_lookup (compound_args_t *args, loc_t *loc, dict_t *xattr_req);
+
+int
+compound_open (compound_args_t *args, loc_t *loc, int32_t flags, fd_t *fd,
+               int32_t wbflags);
+
+int
+compound_create (compound_args_t *args, loc_t *loc, int32_t flags,
+                 mode_t mode, fd_t *fd, dict_t *params);
+
+int
+compound_readv (compound_args_t *args, fd_t *fd, size_t size, off_t offset);
+
+int
+compound_writev (compound_args_t *args, fd_t *fd, struct iovec *vector,
+                 int32_t count, off_t offset, struct iobref *iobref);
+
+int
+compound_flush (compound_args_t *args, fd_t *fd);
+
+int
+compound_linked_fd (compound_args_t *args, int index);
+
+int
+compound_linked_inode (compound_args_t *args, int index);
+
+int
+compound_rsp_set (compound_args_t *args, int index, int32_t op_ret,
+                  int32_t op_errno, inode_t *inode, struct iatt *stat,
+                  struct iatt *prestat, struct iatt *postparent,
+                  dict_t *xattr, struct iovec *vector, int32_t count,
+                  struct iobref *iobref);
+
+void
+compound_args_fail (compound_args_t *args, int from, int32_t op_errno);
+
+int
+compound_fop_serial (call_frame_t *frame, xlator_t *this,
+                     compound_args_t *args);
+
+#endif /* _COMPOUND_H */
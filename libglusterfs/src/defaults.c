@@ -35,6 +35,7 @@
 #endif
 
 #include "xlator.h"
+#include "compound.h"
 
 /* _CBK function section */
 
@@ -77,6 +78,44 @@ default_ftruncate_cbk (call_frame_t *frame, void *cookie, xlator_t *this,
         return 0;
 }
 
+int32_t
+default_fallocate_cbk (call_frame_t *frame, void *cookie, xlator_t *this,
+                       int32_t op_ret, int32_t op_errno, struct iatt *prebuf,
+                       struct iatt *postbuf)
+{
+        STACK_UNWIND_STRICT (fallocate, frame, op_ret, op_errno, prebuf,
+                             postbuf);
+        return 0;
+}
+
+int32_t
+default_discard_cbk (call_frame_t *frame, void *cookie, xlator_t *this,
+                     int32_t op_ret, int32_t op_errno, struct iatt *prebuf,
+                     struct iatt *postbuf)
+{
+        STACK_UNWIND_STRICT (discard, frame, op_ret, op_errno, prebuf,
+                             postbuf);
+        return 0;
+}
+
+int32_t
+default_zerofill_cbk (call_frame_t *frame, void *cookie, xlator_t *this,
+                      int32_t op_ret, int32_t op_errno, struct iatt *prebuf,
+                      struct iatt *postbuf)
+{
+        STACK_UNWIND_STRICT (zerofill, frame, op_ret, op_errno, prebuf,
+                             postbuf);
+        return 0;
+}
+
+int32_t
+default_seek_cbk (call_frame_t *frame, void *cookie, xlator_t *this,
+                  int32_t op_ret, int32_t op_errno, off_t offset)
+{
+        STACK_UNWIND_STRICT (seek, frame, op_ret, op_errno, offset);
+        return 0;
+}
+
 int32_t
 default_access_cbk (call_frame_t *frame, void *cookie, xlator_t *this,
                     int32_t op_ret, int32_t op_errno)
@@ -425,6 +464,24 @@ default_getspec_cbk (call_frame_t *frame, void *cookie, xlator_t *this,
         return 0;
 }
 
+int32_t
+default_compound_cbk (call_frame_t *frame, void *cookie, xlator_t *this,
+                      int32_t op_ret, int32_t op_errno, compound_args_t *args)
+{
+        STACK_UNWIND_STRICT (compound, frame, op_ret, op_errno, args);
+        return 0;
+}
+
+int32_t
+default_bulkstat_cbk (call_frame_t *frame, void *cookie, xlator_t *this,
+                      int32_t op_ret, int32_t op_errno, struct iatt *bufs,
+                      int32_t *op_errnos)
+{
+        STACK_UNWIND_STRICT (bulkstat, frame, op_ret, op_errno, bufs,
+                             op_errnos);
+        return 0;
+}
+
 /* RESUME */
 
 int32_t
@@ -637,6 +694,42 @@ default_ftruncate_resume (call_frame_t *frame, xlator_t *this, fd_t *fd,
         return 0;
 }
 
+int32_t
+default_fallocate_resume (call_frame_t *frame, xlator_t *this, fd_t *fd,
+                          int32_t mode, off_t offset, size_t len)
+{
+        STACK_WIND (frame, default_fallocate_cbk, FIRST_CHILD(this),
+                    FIRST_CHILD(this)->fops->fallocate, fd, mode, offset, len);
+        return 0;
+}
+
+int32_t
+default_discard_resume (call_frame_t *frame, xlator_t *this, fd_t *fd,
+                        off_t offset, size_t len)
+{
+        STACK_WIND (frame, default_discard_cbk, FIRST_CHILD(this),
+                    FIRST_CHILD(this)->fops->discard, fd, offset, len);
+        return 0;
+}
+
+int32_t
+default_zerofill_resume (call_frame_t *frame, xlator_t *this, fd_t *fd,
+                         off_t offset, size_t len)
+{
+        STACK_WIND (frame, default_zerofill_cbk, FIRST_CHILD(this),
+                    FIRST_CHILD(this)->fops->zerofill, fd, offset, len);
+        return 0;
+}
+
+int32_t
+default_seek_resume (call_frame_t *frame, xlator_t *this, fd_t *fd,
+                     off_t offset, gf_seek_what_t what)
+{
+        STACK_WIND (frame, default_seek_cbk, FIRST_CHILD(this),
+                    FIRST_CHILD(this)->fops->seek, fd, offset, what);
+        return 0;
+}
+
 int32_t
 default_getxattr_resume (call_frame_t *frame, xlator_t *this, loc_t *loc,
                          const char *name)
@@ -1005,6 +1098,42 @@ default_ftruncate (call_frame_t *frame, xlator_t *this, fd_t *fd, off_t offset)
         return 0;
 }
 
+int32_t
+default_fallocate (call_frame_t *frame, xlator_t *this, fd_t *fd, int32_t mode,
+                   off_t offset, size_t len)
+{
+        STACK_WIND (frame, default_fallocate_cbk, FIRST_CHILD(this),
+                    FIRST_CHILD(this)->fops->fallocate, fd, mode, offset, len);
+        return 0;
+}
+
+int32_t
+default_discard (call_frame_t *frame, xlator_t *this, fd_t *fd,
+                 off_t offset, size_t len)
+{
+        STACK_WIND (frame, default_discard_cbk, FIRST_CHILD(this),
+                    FIRST_CHILD(this)->fops->discard, fd, offset, len);
+        return 0;
+}
+
+int32_t
+default_zerofill (call_frame_t *frame, xlator_t *this, fd_t *fd,
+                  off_t offset, size_t len)
+{
+        STACK_WIND (frame, default_zerofill_cbk, FIRST_CHILD(this),
+                    FIRST_CHILD(this)->fops->zerofill, fd, offset, len);
+        return 0;
+}
+
+int32_t
+default_seek (call_frame_t *frame, xlator_t *this, fd_t *fd,
+              off_t offset, gf_seek_what_t what)
+{
+        STACK_WIND (frame, default_seek_cbk, FIRST_CHILD(this),
+                    FIRST_CHILD(this)->fops->seek, fd, offset, what);
+        return 0;
+}
+
 int32_t
 default_getxattr (call_frame_t *frame, xlator_t *this, loc_t *loc,
                   const char *name)
@@ -1201,6 +1330,70 @@ default_getspec (call_frame_t *frame, xlator_t *this, const char *key,
         return 0;
 }
 
+/* whether @this implements any of the fops a compound is made of */
+static gf_boolean_t
+default_compound_handled (xlator_t *this, compound_args_t *args)
+{
+        int i = 0;
+
+        for (i = 0; i < args->count; i++) {
+                switch (args->req[i].fop) {
+                case GF_FOP_LOOKUP:
+                        if (this->fops->lookup != default_lookup)
+                                return _gf_true;
+                        break;
+                case GF_FOP_OPEN:
+                        if (this->fops->open != default_open)
+                                return _gf_true;
+                        break;
+                case GF_FOP_CREATE:
+                        if (this->fops->create != default_create)
+                                return _gf_true;
+                        break;
+                case GF_FOP_READ:
+                        if (this->fops->readv != default_readv)
+                                return _gf_true;
+                        break;
+                case GF_FOP_WRITE:
+                        if (this->fops->writev != default_writev)
+                                return _gf_true;
+                        break;
+                case GF_FOP_FLUSH:
+                        if (this->fops->flush != default_flush)
+                                return _gf_true;
+                        break;
+                default:
+                        return _gf_true;
+                }
+        }
+
+        return _gf_false;
+}
+
+/* A translator which does not know about compound fops has nothing to do
+   with them if it passes all of their sub-fops through to its child.
+   Otherwise it sees them as the individual fops they are made of. */
+int32_t
+default_compound (call_frame_t *frame, xlator_t *this, compound_args_t *args)
+{
+        if (!this->children || this->children->next
+            || default_compound_handled (this, args))
+                return compound_fop_serial (frame, this, args);
+
+        STACK_WIND (frame, default_compound_cbk, FIRST_CHILD(this),
+                    FIRST_CHILD(this)->fops->compound, args);
+        return 0;
+}
+
+int32_t
+default_bulkstat (call_frame_t *frame, xlator_t *this, loc_t *locs,
+                  int32_t count)
+{
+        STACK_WIND (frame, default_bulkstat_cbk, FIRST_CHILD(this),
+                    FIRST_CHILD(this)->fops->bulkstat, locs, count);
+        return 0;
+}
+
 /* notify */
 int
 default_notify (xlator_t *this, int32_t event, void *data, ...)
@@ -43,6 +43,15 @@ int32_t default_rchecksum (call_frame_t *frame,
                            fd_t *fd, off_t offset,
                            int32_t len);
 
+int32_t default_compound (call_frame_t *frame,
+                          xlator_t *this,
+                          compound_args_t *args);
+
+int32_t default_bulkstat (call_frame_t *frame,
+                          xlator_t *this,
+                          loc_t *locs,
+                          int32_t count);
+
 /* FileSystem operations */
 int32_t default_lookup (call_frame_t *frame,
                         xlator_t *this,
@@ -67,6 +76,31 @@ int32_t default_ftruncate (call_frame_t *frame,
                            fd_t *fd,
                            off_t offset);
 
+int32_t default_fallocate (call_frame_t *frame,
+                           xlator_t *this,
+                           fd_t *fd,
+                           int32_t mode,
+                           off_t offset,
+                           size_t len);
+
+int32_t default_discard (call_frame_t *frame,
+                         xlator_t *this,
+                         fd_t *fd,
+                         off_t offset,
+                         size_t len);
+
+int32_t default_zerofill (call_frame_t *frame,
+                          xlator_t *this,
+                          fd_t *fd,
+                          off_t offset,
+                          size_t len);
+
+int32_t default_seek (call_frame_t *frame,
+                      xlator_t *this,
+                      fd_t *fd,
+                      off_t offset,
+                      gf_seek_what_t what);
+
 int32_t default_access (call_frame_t *frame,
                         xlator_t *this,
                         loc_t *loc,
@@ -281,6 +315,31 @@ int32_t default_ftruncate_resume (call_frame_t *frame,
                            fd_t *fd,
                            off_t offset);
 
+int32_t default_fallocate_resume (call_frame_t *frame,
+                                  xlator_t *this,
+                                  fd_t *fd,
+                                  int32_t mode,
+                                  off_t offset,
+                                  size_t len);
+
+int32_t default_discard_resume (call_frame_t *frame,
+                                xlator_t *this,
+                                fd_t *fd,
+                                off_t offset,
+                                size_t len);
+
+int32_t default_zerofill_resume (call_frame_t *frame,
+                                 xlator_t *this,
+                                 fd_t *fd,
+                                 off_t offset,
+                                 size_t len);
+
+int32_t default_seek_resume (call_frame_t *frame,
+                             xlator_t *this,
+                             fd_t *fd,
+                             off_t offset,
+                             gf_seek_what_t what);
+
 int32_t default_access_resume (call_frame_t *frame,
                         xlator_t *this,
                         loc_t *loc,
@@ -486,6 +545,25 @@ default_ftruncate_cbk (call_frame_t *frame, void *cookie, xlator_t *this,
                        int32_t op_ret, int32_t op_errno, struct iatt *prebuf,
                        struct iatt *postbuf);
 
+int32_t
+default_fallocate_cbk (call_frame_t *frame, void *cookie, xlator_t *this,
+                       int32_t op_ret, int32_t op_errno, struct iatt *prebuf,
+                       struct iatt *postbuf);
+
+int32_t
+default_discard_cbk (call_frame_t *frame, void *cookie, xlator_t *this,
+                     int32_t op_ret, int32_t op_errno, struct iatt *prebuf,
+                     struct iatt *postbuf);
+
+int32_t
+default_zerofill_cbk (call_frame_t *frame, void *cookie, xlator_t *this,
+                      int32_t op_ret, int32_t op_errno, struct iatt *prebuf,
+                      struct iatt *postbuf);
+
+int32_t
+default_seek_cbk (call_frame_t *frame, void *cookie, xlator_t *this,
+                  int32_t op_ret, int32_t op_errno, off_t offset);
+
 int32_t
 default_access_cbk (call_frame_t *frame, void *cookie, xlator_t *this,
                     int32_t op_ret, int32_t op_errno);
@@ -674,6 +752,15 @@ int32_t
 default_getspec_cbk (call_frame_t *frame, void *cookie, xlator_t *this,
                      int32_t op_ret, int32_t op_errno, char *spec_data);
 
+int32_t
+default_compound_cbk (call_frame_t *frame, void *cookie, xlator_t *this,
+                      int32_t op_ret, int32_t op_errno, compound_args_t *args);
+
+int32_t
+default_bulkstat_cbk (call_frame_t *frame, void *cookie, xlator_t *this,
+                      int32_t op_ret, int32_t op_errno, struct iatt *bufs,
+                      int32_t *op_errnos);
+
 int32_t
 default_mem_acct_init (xlator_t *this);
 
@@ -154,6 +154,12 @@ typedef enum {
         GF_FOP_RELEASE,
         GF_FOP_RELEASEDIR,
         GF_FOP_GETSPEC,
+        GF_FOP_COMPOUND,
+        GF_FOP_BULKSTAT,
+        GF_FOP_FALLOCATE,
+        GF_FOP_DISCARD,
+        GF_FOP_ZEROFILL,
+        GF_FOP_SEEK,
         GF_FOP_MAXVALUE,
 } glusterfs_fop_t;
 
@@ -230,6 +236,13 @@ typedef enum {
 } gf_xattrop_flags_t;
 
 
+/* what the seek fop looks for, lseek's SEEK_DATA and SEEK_HOLE */
+typedef enum {
+        GF_SEEK_DATA,
+        GF_SEEK_HOLE,
+} gf_seek_what_t;
+
+
 #define GF_SET_IF_NOT_PRESENT 0x1 /* default behaviour */
 #define GF_SET_OVERWRITE      0x2 /* Overwrite with the buf given */
 #define GF_SET_DIR_ONLY       0x4
@@ -994,11 +994,15 @@ inode_parent (inode_t *inode, uuid_t pargfid, const char *name)
 }
 
 
+/* fails with -ENOENT, instead of returning a path cut short, when the
+   dentries of the inode do not lead up to root: the server links inodes
+   it resolved by gfid without a dentry */
 int
 __inode_path (inode_t *inode, const char *name, char **bufp)
 {
         inode_table_t *table = NULL;
         dentry_t      *trav  = NULL;
+        dentry_t      *last  = NULL;
         size_t         i     = 0, size = 0;
         int64_t        ret   = 0;
         int            len   = 0;
@@ -1022,6 +1026,16 @@ __inode_path (inode_t *inode, const char *name, char **bufp)
                         ret = -ENOENT;
                         goto out;
                 }
+                last = trav;
+        }
+
+        if (last && !__is_root_gfid (last->parent->gfid)) {
+                /* an ancestor was linked by gfid, without a dentry */
+                gf_log (table->name, GF_LOG_DEBUG,
+                        "dentries of %s do not lead to root",
+                        uuid_utoa (inode->gfid));
+                ret = -ENOENT;
+                goto out;
         }
 
         if (!__is_root_gfid (inode->gfid) &&
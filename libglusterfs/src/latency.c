@@ -117,6 +117,18 @@ gf_set_fop_from_fn_pointer (call_frame_t *frame, struct xlator_fops *fops, void
                 fop = GF_FOP_READDIRP;
         else if (fops->getspec == fn)
                 fop = GF_FOP_GETSPEC;
+        else if (fops->compound == fn)
+                fop = GF_FOP_COMPOUND;
+        else if (fops->bulkstat == fn)
+                fop = GF_FOP_BULKSTAT;
+        else if (fops->fallocate == fn)
+                fop = GF_FOP_FALLOCATE;
+        else if (fops->discard == fn)
+                fop = GF_FOP_DISCARD;
+        else if (fops->zerofill == fn)
+                fop = GF_FOP_ZEROFILL;
+        else if (fops->seek == fn)
+                fop = GF_FOP_SEEK;
         else
                 fop = -1;
 
@@ -106,6 +106,10 @@ enum gf_common_mem_types_ {
         gf_common_mt_trie_end             = 81,
         gf_common_mt_run_argv             = 82,
         gf_common_mt_run_logbuf           = 83,
-        gf_common_mt_end                  = 84
+        gf_common_mt_compound_args_t      = 84,
+        gf_common_mt_rpcsvc_fq_client_t   = 85,
+        gf_common_mt_bulkstat_t           = 86,
+        gf_common_mt_bloom_t              = 87,
+        gf_common_mt_end                  = 88
 };
 #endif
@@ -83,6 +83,7 @@ struct syncargs {
         int                 count;
         struct iobref      *iobref;
         char               *buffer;
+        off_t               offset;
 
         /* do not touch */
         pthread_mutex_t     mutex;
@@ -202,6 +203,9 @@ int syncop_readv (xlator_t *subvol, fd_t *fd, size_t size, off_t off,
 int syncop_ftruncate (xlator_t *subvol, fd_t *fd, off_t offset);
 int syncop_truncate (xlator_t *subvol, loc_t *loc, off_t offset);
 
+int syncop_seek (xlator_t *subvol, fd_t *fd, off_t offset,
+                 gf_seek_what_t what, off_t *off);
+
 int syncop_unlink (xlator_t *subvol, loc_t *loc);
 
 int syncop_fsync (xlator_t *subvol, fd_t *fd);
@@ -89,6 +89,12 @@ fill_defaults (xlator_t *xl)
         SET_DEFAULT_FOP (fsetattr);
 
         SET_DEFAULT_FOP (getspec);
+        SET_DEFAULT_FOP (compound);
+        SET_DEFAULT_FOP (bulkstat);
+        SET_DEFAULT_FOP (fallocate);
+        SET_DEFAULT_FOP (discard);
+        SET_DEFAULT_FOP (zerofill);
+        SET_DEFAULT_FOP (seek);
 
         SET_DEFAULT_CBK (release);
         SET_DEFAULT_CBK (releasedir);
@@ -61,6 +61,8 @@ struct _gf_dirent_t;
 typedef struct _gf_dirent_t gf_dirent_t;
 struct _loc;
 typedef struct _loc loc_t;
+struct _compound_args;
+typedef struct _compound_args compound_args_t;
 
 
 typedef int32_t (*event_notify_fn_t) (xlator_t *this, int32_t event, void *data,
@@ -109,6 +111,24 @@ typedef int32_t (*fop_rchecksum_cbk_t) (call_frame_t *frame,
                                         uint8_t *strong_checksum);
 
 
+typedef int32_t (*fop_compound_cbk_t) (call_frame_t *frame,
+                                       void *cookie,
+                                       xlator_t *this,
+                                       int32_t op_ret,
+                                       int32_t op_errno,
+                                       compound_args_t *args);
+
+/* on success op_ret is the number of entries, and bufs[i] is valid for
+   every i with op_errnos[i] == 0 */
+typedef int32_t (*fop_bulkstat_cbk_t) (call_frame_t *frame,
+                                       void *cookie,
+                                       xlator_t *this,
+                                       int32_t op_ret,
+                                       int32_t op_errno,
+                                       struct iatt *bufs,
+                                       int32_t *op_errnos);
+
+
 typedef int32_t (*fop_getspec_t) (call_frame_t *frame,
                                   xlator_t *this,
                                   const char *key,
@@ -119,6 +139,15 @@ typedef int32_t (*fop_rchecksum_t) (call_frame_t *frame,
                                     fd_t *fd, off_t offset,
                                     int32_t len);
 
+typedef int32_t (*fop_compound_t) (call_frame_t *frame,
+                                   xlator_t *this,
+                                   compound_args_t *args);
+
+typedef int32_t (*fop_bulkstat_t) (call_frame_t *frame,
+                                   xlator_t *this,
+                                   loc_t *locs,
+                                   int32_t count);
+
 
 typedef int32_t (*fop_lookup_cbk_t) (call_frame_t *frame,
                                      void *cookie,
@@ -160,6 +189,37 @@ typedef int32_t (*fop_ftruncate_cbk_t) (call_frame_t *frame,
                                         struct iatt *prebuf,
                                         struct iatt *postbuf);
 
+typedef int32_t (*fop_fallocate_cbk_t) (call_frame_t *frame,
+                                        void *cookie,
+                                        xlator_t *this,
+                                        int32_t op_ret,
+                                        int32_t op_errno,
+                                        struct iatt *prebuf,
+                                        struct iatt *postbuf);
+
+typedef int32_t (*fop_discard_cbk_t) (call_frame_t *frame,
+                                      void *cookie,
+                                      xlator_t *this,
+                                      int32_t op_ret,
+                                      int32_t op_errno,
+                                      struct iatt *prebuf,
+                                      struct iatt *postbuf);
+
+typedef int32_t (*fop_zerofill_cbk_t) (call_frame_t *frame,
+                                       void *cookie,
+                                       xlator_t *this,
+                                       int32_t op_ret,
+                                       int32_t op_errno,
+                                       struct iatt *prebuf,
+                                       struct iatt *postbuf);
+
+typedef int32_t (*fop_seek_cbk_t) (call_frame_t *frame,
+                                   void *cookie,
+                                   xlator_t *this,
+                                   int32_t op_ret,
+                                   int32_t op_errno,
+                                   off_t offset);
+
 typedef int32_t (*fop_access_cbk_t) (call_frame_t *frame,
                                      void *cookie,
                                      xlator_t *this,
@@ -442,6 +502,36 @@ typedef int32_t (*fop_ftruncate_t) (call_frame_t *frame,
                                     fd_t *fd,
                                     off_t offset);
 
+/* fallocate reserves the blocks of [offset, offset + len), growing the
+   file unless mode has FALLOC_FL_KEEP_SIZE; discard deallocates them
+   without changing the size, and zerofill makes them read back as zeroes */
+typedef int32_t (*fop_fallocate_t) (call_frame_t *frame,
+                                    xlator_t *this,
+                                    fd_t *fd,
+                                    int32_t mode,
+                                    off_t offset,
+                                    size_t len);
+
+typedef int32_t (*fop_discard_t) (call_frame_t *frame,
+                                  xlator_t *this,
+                                  fd_t *fd,
+                                  off_t offset,
+                                  size_t len);
+
+typedef int32_t (*fop_zerofill_t) (call_frame_t *frame,
+                                   xlator_t *this,
+                                   fd_t *fd,
+                                   off_t offset,
+                                   size_t len);
+
+/* seek unwinds with the start of the first data (GF_SEEK_DATA) or hole
+   (GF_SEEK_HOLE) at or after offset, ENXIO when there is none */
+typedef int32_t (*fop_seek_t) (call_frame_t *frame,
+                               xlator_t *this,
+                               fd_t *fd,
+                               off_t offset,
+                               gf_seek_what_t what);
+
 typedef int32_t (*fop_access_t) (call_frame_t *frame,
                                  xlator_t *this,
                                  loc_t *loc,
@@ -675,6 +765,12 @@ struct xlator_fops {
         fop_setattr_t        setattr;
         fop_fsetattr_t       fsetattr;
         fop_getspec_t        getspec;
+        fop_compound_t       compound;
+        fop_bulkstat_t       bulkstat;
+        fop_fallocate_t      fallocate;
+        fop_discard_t        discard;
+        fop_zerofill_t       zerofill;
+        fop_seek_t           seek;
 
         /* these entries are used for a typechecking hack in STACK_WIND _only_ */
         fop_lookup_cbk_t         lookup_cbk;
@@ -718,6 +814,12 @@ struct xlator_fops {
         fop_setattr_cbk_t        setattr_cbk;
         fop_fsetattr_cbk_t       fsetattr_cbk;
         fop_getspec_cbk_t        getspec_cbk;
+        fop_compound_cbk_t       compound_cbk;
+        fop_bulkstat_cbk_t       bulkstat_cbk;
+        fop_fallocate_cbk_t      fallocate_cbk;
+        fop_discard_cbk_t        discard_cbk;
+        fop_zerofill_cbk_t       zerofill_cbk;
+        fop_seek_cbk_t           seek_cbk;
 };
 
 typedef int32_t (*cbk_forget_t) (xlator_t *this,
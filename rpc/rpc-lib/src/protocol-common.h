@@ -64,6 +64,12 @@ enum gf_fop_procnum {
         GFS3_OP_READDIRP,
         GFS3_OP_RELEASE,
         GFS3_OP_RELEASEDIR,
+        GFS3_OP_COMPOUND,
+        GFS3_OP_BULKSTAT,
+        GFS3_OP_FALLOCATE,
+        GFS3_OP_DISCARD,
+        GFS3_OP_ZEROFILL,
+        GFS3_OP_SEEK,
         GFS3_OP_MAXVALUE,
 } ;
 
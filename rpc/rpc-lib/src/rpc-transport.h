@@ -191,6 +191,7 @@ struct rpc_transport {
 
         void                      *private;
         void                      *xl_private;
+        void                      *svc_private; /* rpcsvc fair queuing */
         void                      *xl;       /* Used for THIS */
         void                      *mydata;
         pthread_mutex_t            lock;
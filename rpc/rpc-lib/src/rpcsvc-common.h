@@ -25,6 +25,7 @@
 #include "compat.h"
 #include "glusterfs.h"
 #include "dict.h"
+#include "timer.h"
 
 typedef enum {
         RPCSVC_EVENT_ACCEPT,
@@ -36,6 +37,32 @@ typedef enum {
 
 struct rpcsvc_state;
 
+/* Per-client fair queuing of incoming requests (see rpcsvc-fairq.c).
+ * While enabled, at most @inflight_limit requests are handed to the
+ * actors at a time, the rest wait in per connection queues which are
+ * served in deficit round robin order.
+ */
+typedef struct rpcsvc_fairq {
+        pthread_mutex_t          lock;
+        gf_boolean_t             enable;
+        int                      inflight_limit;
+        uint64_t                 quantum;
+
+        /* "<addr-pattern>:<value>[,...]" rules, matched against the
+         * address of the peer.
+         */
+        char                    *weights;
+        char                    *iops_limits;
+        char                    *bw_limits;
+
+        struct list_head         clients;
+        struct list_head         active;  /* clients with queued requests */
+        int                      inflight;
+        int                      queued;
+        gf_boolean_t             pumping;
+        gf_timer_t              *timer;
+} rpcsvc_fairq_t;
+
 typedef int (*rpcsvc_notify_t) (struct rpcsvc_state *, void *mydata,
                                 rpcsvc_event_t, void *data);
 
@@ -76,6 +103,8 @@ typedef struct rpcsvc_state {
         void                    *mydata; /* This is xlator */
         rpcsvc_notify_t          notifyfn;
         struct mem_pool         *rxpool;
+
+        rpcsvc_fairq_t           fairq;
 } rpcsvc_t;
 
 
@@ -0,0 +1,692 @@
+/*
+  Copyright (c) 2011 Gluster, Inc. <http://www.gluster.com>
+  This file is part of GlusterFS.
+
+  GlusterFS is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published
+  by the Free Software Foundation; either version 3 of the License,
+  or (at your option) any later version.
+
+  GlusterFS is distributed in the hope that it will be useful, but
+  WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see
+  <http://www.gnu.org/licenses/>.
+*/
+
+/* Fair queuing of requests across the clients of a rpc service.
+ *
+ * Without it requests are handed to the program actors in the order they
+ * are read off the sockets, so a single client keeping a deep queue of
+ * requests (rm -rf, untar ...) delays everybody else behind it.
+ *
+ * With "rpc.fair-queue" on, every request is first queued on its
+ * connection, and at most "rpc.fair-queue-inflight" requests are handed
+ * to the actors at any point in time. Whenever a slot frees up (a reply
+ * is submitted), the next request is picked from the connections in
+ * deficit round robin order: each connection gets
+ * "rpc.fair-queue-quantum" * weight bytes of credit per round, and every
+ * request costs its payload plus RPCSVC_FAIRQ_REQUEST_COST. Blocking
+ * actors (locks) are dispatched in the same order but hold no slot, or
+ * waiters could take them all and keep the unlock of the holder queued.
+ *
+ * Per client weights, IOPS and bandwidth limits are given as lists of
+ * "<address-pattern>:<value>" pairs, eg.
+ *
+ *   option rpc.client-weight 192.168.1.*:4,10.1.1.10:2
+ *   option rpc.client-bw-limit 10.1.1.*:20MB
+ *
+ * A client over its IOPS or bandwidth limit keeps its requests queued
+ * until its token bucket refills, even when there are free slots.
+ */
+
+#include <fnmatch.h>
+
+#include "rpcsvc.h"
+#include "logging.h"
+#include "dict.h"
+#include "common-utils.h"
+#include "statedump.h"
+
+
+static void
+rpcsvc_fairq_pump (rpcsvc_t *svc);
+
+
+static int
+rpcsvc_fairq_rule_get (char *rules, char *addr, gf_boolean_t bytes,
+                       uint64_t *value)
+{
+        char    *dup     = NULL;
+        char    *tok     = NULL;
+        char    *saveptr = NULL;
+        char    *sep     = NULL;
+        int      ret     = -1;
+
+        if (!rules || !addr)
+                goto out;
+
+        dup = gf_strdup (rules);
+        if (!dup)
+                goto out;
+
+        for (tok = strtok_r (dup, ", ", &saveptr); tok;
+             tok = strtok_r (NULL, ", ", &saveptr)) {
+                /* the value never has a ':', addresses (IPv6) may */
+                sep = strrchr (tok, ':');
+                if (!sep)
+                        continue;
+                *sep++ = '\0';
+
+                if (fnmatch (tok, addr, 0) != 0)
+                        continue;
+
+                if (bytes)
+                        ret = gf_string2bytesize (sep, value);
+                else
+                        ret = gf_string2uint64 (sep, value);
+
+                if (ret)
+                        gf_log (GF_RPCSVC, GF_LOG_WARNING,
+                                "invalid value '%s' for %s", sep, tok);
+                break;
+        }
+
+        GF_FREE (dup);
+out:
+        return ret;
+}
+
+
+/* Look up the weight and limits of @client from the configured rules. */
+static void
+__rpcsvc_fairq_client_setup (rpcsvc_t *svc, rpcsvc_fq_client_t *client)
+{
+        char            addr[RPCSVC_PEER_STRLEN] = {0,};
+        char           *sep                      = NULL;
+        uint64_t        value                    = 0;
+        rpcsvc_fairq_t *fq                       = NULL;
+
+        fq = &svc->fairq;
+
+        /* identifier is "<address>:<port>" */
+        strncpy (addr, client->trans->peerinfo.identifier,
+                 sizeof (addr) - 1);
+        sep = strrchr (addr, ':');
+        if (sep)
+                *sep = '\0';
+
+        client->weight = 1;
+        if (!rpcsvc_fairq_rule_get (fq->weights, addr, _gf_false, &value)
+            && value)
+                client->weight = value;
+
+        value = 0;
+        (void) rpcsvc_fairq_rule_get (fq->iops_limits, addr, _gf_false,
+                                      &value);
+        if (value != client->iops_limit) {
+                client->iops_limit  = value;
+                client->iops_tokens = value;
+        }
+
+        value = 0;
+        (void) rpcsvc_fairq_rule_get (fq->bw_limits, addr, _gf_true, &value);
+        if (value != client->bw_limit) {
+                client->bw_limit  = value;
+                client->bw_tokens = value;
+        }
+}
+
+
+static rpcsvc_fq_client_t *
+__rpcsvc_fairq_client_get (rpcsvc_t *svc, rpc_transport_t *trans)
+{
+        rpcsvc_fq_client_t *client = NULL;
+
+        client = trans->svc_private;
+        if (client)
+                goto out;
+
+        client = GF_CALLOC (1, sizeof (*client),
+                            gf_common_mt_rpcsvc_fq_client_t);
+        if (!client)
+                goto out;
+
+        INIT_LIST_HEAD (&client->list);
+        INIT_LIST_HEAD (&client->active);
+        INIT_LIST_HEAD (&client->queue);
+        client->trans = trans;
+        gettimeofday (&client->refill, NULL);
+
+        __rpcsvc_fairq_client_setup (svc, client);
+
+        list_add_tail (&client->list, &svc->fairq.clients);
+        trans->svc_private = client;
+out:
+        return client;
+}
+
+
+static void
+__rpcsvc_fairq_refill (rpcsvc_fq_client_t *client, struct timeval *now)
+{
+        double  elapsed = 0;
+
+        elapsed = (now->tv_sec - client->refill.tv_sec)
+                + (now->tv_usec - client->refill.tv_usec) / 1000000.0;
+        if (elapsed <= 0)
+                return;
+
+        client->refill = *now;
+
+        if (client->iops_limit) {
+                client->iops_tokens += elapsed * client->iops_limit;
+                if (client->iops_tokens > client->iops_limit)
+                        client->iops_tokens = client->iops_limit;
+        }
+
+        if (client->bw_limit) {
+                client->bw_tokens += elapsed * client->bw_limit;
+                if (client->bw_tokens > client->bw_limit)
+                        client->bw_tokens = client->bw_limit;
+        }
+}
+
+
+/* usecs till @client is back within its limits, 0 if it is already */
+static uint64_t
+__rpcsvc_fairq_throttle_delay (rpcsvc_fq_client_t *client)
+{
+        uint64_t delay = 0;
+        uint64_t bw    = 0;
+
+        /* at least a usec, tokens may be just short of the mark */
+        if (client->iops_limit && (client->iops_tokens < 1))
+                delay = max (1, (1 - client->iops_tokens) * 1000000
+                             / client->iops_limit);
+
+        if (client->bw_limit && (client->bw_tokens < 0)) {
+                bw = max (1, -client->bw_tokens * 1000000
+                          / client->bw_limit);
+                if (bw > delay)
+                        delay = bw;
+        }
+
+        return delay;
+}
+
+
+static void
+rpcsvc_fairq_timeout (void *data)
+{
+        rpcsvc_t *svc = NULL;
+
+        svc = data;
+
+        pthread_mutex_lock (&svc->fairq.lock);
+        {
+                svc->fairq.timer = NULL;
+        }
+        pthread_mutex_unlock (&svc->fairq.lock);
+
+        rpcsvc_fairq_pump (svc);
+}
+
+
+/* Pick the next request to dispatch, NULL if all the slots are taken or
+ * every client with queued requests is being throttled.
+ */
+static rpcsvc_request_t *
+__rpcsvc_fairq_next (rpcsvc_t *svc)
+{
+        rpcsvc_fairq_t     *fq      = NULL;
+        rpcsvc_fq_client_t *client  = NULL;
+        rpcsvc_request_t   *req     = NULL;
+        struct timeval      now     = {0,};
+        struct timeval      delta   = {0,};
+        uint64_t            delay   = 0;
+        uint64_t            wait    = 0;
+        uint64_t            waited  = 0;
+        size_t              payload = 0;
+        int                 nactive = 0;
+        int                 skipped = 0;
+
+        fq = &svc->fairq;
+
+        if (list_empty (&fq->active))
+                goto out;
+
+        if (fq->enable && (fq->inflight >= fq->inflight_limit))
+                goto out;
+
+        gettimeofday (&now, NULL);
+
+        list_for_each_entry (client, &fq->active, active)
+                nactive++;
+
+        while (!list_empty (&fq->active)) {
+                client = list_entry (fq->active.next, rpcsvc_fq_client_t,
+                                     active);
+
+                if (fq->enable && (client->iops_limit || client->bw_limit)) {
+                        __rpcsvc_fairq_refill (client, &now);
+
+                        delay = __rpcsvc_fairq_throttle_delay (client);
+                        if (delay) {
+                                client->throttled++;
+                                client->in_turn = _gf_false;
+                                list_move_tail (&client->active, &fq->active);
+
+                                if (!wait || (delay < wait))
+                                        wait = delay;
+
+                                if (++skipped >= nactive)
+                                        break;
+                                continue;
+                        }
+                }
+
+                req = list_entry (client->queue.next, rpcsvc_request_t,
+                                  fq_list);
+
+                if (!client->in_turn) {
+                        client->deficit += fq->quantum * client->weight;
+                        client->in_turn = _gf_true;
+                }
+
+                if (fq->enable && (client->deficit < (int64_t)req->fq_cost)) {
+                        /* end of its turn, keep the credit for the next */
+                        client->in_turn = _gf_false;
+                        list_move_tail (&client->active, &fq->active);
+                        skipped = 0;
+                        req = NULL;
+                        continue;
+                }
+
+                list_del_init (&req->fq_list);
+                client->deficit -= req->fq_cost;
+                client->queued--;
+                fq->queued--;
+
+                if (list_empty (&client->queue)) {
+                        client->deficit = 0;
+                        client->in_turn = _gf_false;
+                        list_del_init (&client->active);
+                }
+
+                payload = req->fq_cost - RPCSVC_FAIRQ_REQUEST_COST;
+                if (client->iops_limit)
+                        client->iops_tokens -= 1;
+                if (client->bw_limit)
+                        client->bw_tokens -= payload;
+
+                client->bytes += payload;
+                client->dispatched++;
+
+                waited = (now.tv_sec - req->fq_queued.tv_sec) * 1000000
+                        + (now.tv_usec - req->fq_queued.tv_usec);
+                client->wait_total += waited;
+                if (waited > client->wait_max)
+                        client->wait_max = waited;
+
+                /* a blocking lock holding a slot could keep the unlock
+                   of its holder queued behind it for ever */
+                if (!req->fq_actor->blocking) {
+                        client->inflight++;
+                        fq->inflight++;
+                        req->fq_client = client;
+                }
+                goto out;
+        }
+
+        req = NULL;
+
+        if (wait && !fq->timer) {
+                delta.tv_sec  = wait / 1000000;
+                delta.tv_usec = wait % 1000000;
+                fq->timer = gf_timer_call_after (svc->ctx, delta,
+                                                 rpcsvc_fairq_timeout, svc);
+        }
+out:
+        return req;
+}
+
+
+/* Dispatch requests as long as there are free slots. Only one thread
+ * pumps at a time, so that an actor replying inline does not recurse
+ * back in here.
+ */
+static void
+rpcsvc_fairq_pump (rpcsvc_t *svc)
+{
+        rpcsvc_request_t *req      = NULL;
+        xlator_t         *old_THIS = NULL;
+        int               ret      = 0;
+
+        pthread_mutex_lock (&svc->fairq.lock);
+        {
+                if (svc->fairq.pumping) {
+                        pthread_mutex_unlock (&svc->fairq.lock);
+                        return;
+                }
+                svc->fairq.pumping = _gf_true;
+        }
+        pthread_mutex_unlock (&svc->fairq.lock);
+
+        old_THIS = THIS;
+
+        for (;;) {
+                pthread_mutex_lock (&svc->fairq.lock);
+                {
+                        req = __rpcsvc_fairq_next (svc);
+                        if (!req)
+                                svc->fairq.pumping = _gf_false;
+                }
+                pthread_mutex_unlock (&svc->fairq.lock);
+
+                if (!req)
+                        break;
+
+                ret = rpcsvc_request_call (req, req->fq_actor);
+                if (ret == RPCSVC_ACTOR_ERROR) {
+                        ret = rpcsvc_error_reply (req);
+                        if (ret)
+                                gf_log (GF_RPCSVC, GF_LOG_WARNING,
+                                        "failed to queue error reply");
+                }
+        }
+
+        THIS = old_THIS;
+}
+
+
+int
+rpcsvc_fairq_submit (rpcsvc_request_t *req, rpcsvc_actor_t *actor)
+{
+        rpcsvc_t           *svc    = NULL;
+        rpcsvc_fq_client_t *client = NULL;
+        size_t              cost   = RPCSVC_FAIRQ_REQUEST_COST;
+        int                 i      = 0;
+
+        svc = req->svc;
+
+        for (i = 0; i < req->count; i++)
+                cost += req->msg[i].iov_len;
+
+        pthread_mutex_lock (&svc->fairq.lock);
+        {
+                client = __rpcsvc_fairq_client_get (svc, req->trans);
+                if (!client || client->disconnected) {
+                        client = NULL;
+                        goto unlock;
+                }
+
+                req->fq_actor = actor;
+                req->fq_cost  = cost;
+                gettimeofday (&req->fq_queued, NULL);
+
+                list_add_tail (&req->fq_list, &client->queue);
+                svc->fairq.queued++;
+                if (++client->queued > client->max_queued)
+                        client->max_queued = client->queued;
+
+                if (list_empty (&client->active))
+                        list_add_tail (&client->active, &svc->fairq.active);
+        }
+unlock:
+        pthread_mutex_unlock (&svc->fairq.lock);
+
+        if (!client) {
+                /* no state for this connection, do not hold it back */
+                return rpcsvc_request_call (req, actor);
+        }
+
+        rpcsvc_fairq_pump (svc);
+
+        return 0;
+}
+
+
+/* Called with the reply to a dispatched request, frees up its slot. */
+void
+rpcsvc_fairq_done (rpcsvc_request_t *req, size_t replylen)
+{
+        rpcsvc_t           *svc    = NULL;
+        rpcsvc_fq_client_t *client = NULL;
+
+        svc = req->svc;
+        client = req->fq_client;
+        req->fq_client = NULL;
+
+        pthread_mutex_lock (&svc->fairq.lock);
+        {
+                client->inflight--;
+                svc->fairq.inflight--;
+
+                /* replies (reads) are charged once they are known */
+                client->bytes += replylen;
+                if (client->bw_limit)
+                        client->bw_tokens -= replylen;
+        }
+        pthread_mutex_unlock (&svc->fairq.lock);
+
+        rpcsvc_fairq_pump (svc);
+}
+
+
+/* Drop the requests still queued on a connection going away, there is
+ * nobody to reply to.
+ */
+void
+rpcsvc_fairq_disconnect (rpcsvc_t *svc, rpc_transport_t *trans)
+{
+        rpcsvc_fq_client_t *client = NULL;
+        rpcsvc_request_t   *req    = NULL;
+        rpcsvc_request_t   *tmp    = NULL;
+        struct list_head    purged;
+
+        INIT_LIST_HEAD (&purged);
+
+        pthread_mutex_lock (&svc->fairq.lock);
+        {
+                client = trans->svc_private;
+                if (!client)
+                        goto unlock;
+
+                client->disconnected = _gf_true;
+                list_splice_init (&client->queue, &purged);
+                svc->fairq.queued -= client->queued;
+                client->queued = 0;
+                client->deficit = 0;
+                client->in_turn = _gf_false;
+                list_del_init (&client->active);
+        }
+unlock:
+        pthread_mutex_unlock (&svc->fairq.lock);
+
+        list_for_each_entry_safe (req, tmp, &purged, fq_list) {
+                list_del_init (&req->fq_list);
+                rpcsvc_request_destroy (req);
+        }
+}
+
+
+void
+rpcsvc_fairq_cleanup (rpcsvc_t *svc, rpc_transport_t *trans)
+{
+        rpcsvc_fq_client_t *client = NULL;
+
+        pthread_mutex_lock (&svc->fairq.lock);
+        {
+                client = trans->svc_private;
+                if (client) {
+                        list_del_init (&client->list);
+                        list_del_init (&client->active);
+                        trans->svc_private = NULL;
+                }
+        }
+        pthread_mutex_unlock (&svc->fairq.lock);
+
+        if (client)
+                GF_FREE (client);
+}
+
+
+static char *
+rpcsvc_fairq_rules_get (dict_t *options, char *key)
+{
+        char *str = NULL;
+
+        if (dict_get_str (options, key, &str))
+                return NULL;
+
+        return gf_strdup (str);
+}
+
+
+int
+rpcsvc_set_fairq (rpcsvc_t *svc, dict_t *options)
+{
+        rpcsvc_fairq_t     *fq       = NULL;
+        rpcsvc_fq_client_t *client   = NULL;
+        char               *optstr   = NULL;
+        gf_boolean_t        enable   = _gf_false;
+        uint32_t            inflight = RPCSVC_FAIRQ_INFLIGHT_LIMIT;
+        uint64_t            quantum  = RPCSVC_FAIRQ_QUANTUM;
+        char               *weights  = NULL;
+        char               *iops     = NULL;
+        char               *bw       = NULL;
+
+        GF_ASSERT (svc);
+        GF_ASSERT (options);
+
+        fq = &svc->fairq;
+
+        if (!dict_get_str (options, "rpc.fair-queue", &optstr)
+            && gf_string2boolean (optstr, &enable))
+                gf_log (GF_RPCSVC, GF_LOG_WARNING,
+                        "invalid value '%s' for rpc.fair-queue", optstr);
+
+        if (!dict_get_str (options, "rpc.fair-queue-inflight", &optstr)
+            && (gf_string2uint32 (optstr, &inflight) || !inflight)) {
+                gf_log (GF_RPCSVC, GF_LOG_WARNING, "invalid value '%s' for "
+                        "rpc.fair-queue-inflight", optstr);
+                inflight = RPCSVC_FAIRQ_INFLIGHT_LIMIT;
+        }
+
+        if (!dict_get_str (options, "rpc.fair-queue-quantum", &optstr)
+            && (gf_string2bytesize (optstr, &quantum) || !quantum)) {
+                gf_log (GF_RPCSVC, GF_LOG_WARNING, "invalid value '%s' for "
+                        "rpc.fair-queue-quantum", optstr);
+                quantum = RPCSVC_FAIRQ_QUANTUM;
+        }
+
+        weights = rpcsvc_fairq_rules_get (options, "rpc.client-weight");
+        iops = rpcsvc_fairq_rules_get (options, "rpc.client-iops-limit");
+        bw = rpcsvc_fairq_rules_get (options, "rpc.client-bw-limit");
+
+        pthread_mutex_lock (&fq->lock);
+        {
+                fq->enable = enable;
+                fq->inflight_limit = inflight;
+                fq->quantum = quantum;
+
+                if (fq->weights)
+                        GF_FREE (fq->weights);
+                fq->weights = weights;
+
+                if (fq->iops_limits)
+                        GF_FREE (fq->iops_limits);
+                fq->iops_limits = iops;
+
+                if (fq->bw_limits)
+                        GF_FREE (fq->bw_limits);
+                fq->bw_limits = bw;
+
+                list_for_each_entry (client, &fq->clients, list)
+                        __rpcsvc_fairq_client_setup (svc, client);
+        }
+        pthread_mutex_unlock (&fq->lock);
+
+        if (enable)
+                gf_log (GF_RPCSVC, GF_LOG_DEBUG, "fair queuing enabled "
+                        "(inflight: %u, quantum: %"PRIu64")", inflight,
+                        quantum);
+
+        /* flush what was queued if disabled, or use the new limits */
+        rpcsvc_fairq_pump (svc);
+
+        return 0;
+}
+
+
+int
+rpcsvc_fairq_dump (rpcsvc_t *svc)
+{
+        rpcsvc_fairq_t     *fq     = NULL;
+        rpcsvc_fq_client_t *client = NULL;
+        char                key[64];
+        int                 i      = 1;
+
+        fq = &svc->fairq;
+
+        if (pthread_mutex_trylock (&fq->lock))
+                return -1;
+
+        gf_proc_dump_write ("rpcsvc.fairq.enable", "%d", fq->enable);
+        gf_proc_dump_write ("rpcsvc.fairq.inflight", "%d", fq->inflight);
+        gf_proc_dump_write ("rpcsvc.fairq.inflight-limit", "%d",
+                            fq->inflight_limit);
+        gf_proc_dump_write ("rpcsvc.fairq.queued", "%d", fq->queued);
+        gf_proc_dump_write ("rpcsvc.fairq.quantum", "%"PRIu64, fq->quantum);
+
+        list_for_each_entry (client, &fq->clients, list) {
+                snprintf (key, sizeof (key),
+                          "rpcsvc.fairq.client.%d.peer", i);
+                gf_proc_dump_write (key, "%s",
+                                    client->trans->peerinfo.identifier);
+                snprintf (key, sizeof (key),
+                          "rpcsvc.fairq.client.%d.weight", i);
+                gf_proc_dump_write (key, "%u", client->weight);
+                snprintf (key, sizeof (key),
+                          "rpcsvc.fairq.client.%d.queue-depth", i);
+                gf_proc_dump_write (key, "%d", client->queued);
+                snprintf (key, sizeof (key),
+                          "rpcsvc.fairq.client.%d.max-queue-depth", i);
+                gf_proc_dump_write (key, "%d", client->max_queued);
+                snprintf (key, sizeof (key),
+                          "rpcsvc.fairq.client.%d.inflight", i);
+                gf_proc_dump_write (key, "%d", client->inflight);
+                snprintf (key, sizeof (key),
+                          "rpcsvc.fairq.client.%d.dispatched", i);
+                gf_proc_dump_write (key, "%"PRIu64, client->dispatched);
+                snprintf (key, sizeof (key),
+                          "rpcsvc.fairq.client.%d.bytes", i);
+                gf_proc_dump_write (key, "%"PRIu64, client->bytes);
+                snprintf (key, sizeof (key),
+                          "rpcsvc.fairq.client.%d.throttled", i);
+                gf_proc_dump_write (key, "%"PRIu64, client->throttled);
+                snprintf (key, sizeof (key),
+                          "rpcsvc.fairq.client.%d.avg-wait-usec", i);
+                gf_proc_dump_write (key, "%"PRIu64, client->dispatched ?
+                                    client->wait_total / client->dispatched
+                                    : 0);
+                snprintf (key, sizeof (key),
+                          "rpcsvc.fairq.client.%d.max-wait-usec", i);
+                gf_proc_dump_write (key, "%"PRIu64, client->wait_max);
+                snprintf (key, sizeof (key),
+                          "rpcsvc.fairq.client.%d.iops-limit", i);
+                gf_proc_dump_write (key, "%"PRIu64, client->iops_limit);
+                snprintf (key, sizeof (key),
+                          "rpcsvc.fairq.client.%d.bw-limit", i);
+                gf_proc_dump_write (key, "%"PRIu64, client->bw_limit);
+                i++;
+        }
+
+        pthread_mutex_unlock (&fq->lock);
+
+        return 0;
+}
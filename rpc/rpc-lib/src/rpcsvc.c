@@ -314,6 +314,7 @@ rpcsvc_request_init (rpcsvc_t *svc, rpc_transport_t *trans,
         req->trans_private = msg->private;
 
         INIT_LIST_HEAD (&req->txlist);
+        INIT_LIST_HEAD (&req->fq_list);
         req->payloadsize = 0;
 
         /* By this time, the data bytes for the auth scheme would have already
@@ -429,6 +430,34 @@ err:
 }
 
 
+int
+rpcsvc_request_call (rpcsvc_request_t *req, rpcsvc_actor_t *actor)
+{
+        int                     ret = 0;
+
+        /* Before going to xlator code, set the THIS properly */
+        THIS = req->svc->mydata;
+
+        if (req->count == 2) {
+                if (actor->vector_actor) {
+                        ret = actor->vector_actor (req, &req->msg[1], 1,
+                                                   req->iobref);
+                } else {
+                        rpcsvc_request_seterr (req, PROC_UNAVAIL);
+                        /* LOG TODO: print more info about procnum,
+                           prognum etc, also print transport info */
+                        gf_log (GF_RPCSVC, GF_LOG_ERROR,
+                                "No vectored handler present");
+                        ret = RPCSVC_ACTOR_ERROR;
+                }
+        } else if (actor->actor) {
+                ret = actor->actor (req);
+        }
+
+        return ret;
+}
+
+
 int
 rpcsvc_handle_rpc_call (rpcsvc_t *svc, rpc_transport_t *trans,
                         rpc_transport_pollin_t *msg)
@@ -488,24 +517,17 @@ rpcsvc_handle_rpc_call (rpcsvc_t *svc, rpc_transport_t *trans,
                 goto err_reply;
 
         if (actor && (req->rpc_err == SUCCESS)) {
-                /* Before going to xlator code, set the THIS properly */
-                THIS = svc->mydata;
-
-                if (req->count == 2) {
-                        if (actor->vector_actor) {
-                                ret = actor->vector_actor (req, &req->msg[1], 1,
-                                                           req->iobref);
-                        } else {
-                                rpcsvc_request_seterr (req, PROC_UNAVAIL);
-                                /* LOG TODO: print more info about procnum,
-                                   prognum etc, also print transport info */
-                                gf_log (GF_RPCSVC, GF_LOG_ERROR,
-                                        "No vectored handler present");
-                                ret = RPCSVC_ACTOR_ERROR;
-                        }
-                } else if (actor->actor) {
-                        ret = actor->actor (req);
-                }
+                /* a queued request is decoded after the transport has
+                   destroyed msg, so it keeps the header iobuf its program
+                   message points into. trans_private is left alone: the
+                   transports set it on calls only when they keep it
+                   themselves until the reply (rdma) */
+                if (svc->fairq.enable
+                    && (!msg->hdr_iobuf
+                        || !iobref_add (req->iobref, msg->hdr_iobuf)))
+                        ret = rpcsvc_fairq_submit (req, actor);
+                else
+                        ret = rpcsvc_request_call (req, actor);
         }
 
 err_reply:
@@ -595,6 +617,7 @@ rpcsvc_notify (rpc_transport_t *trans, void *mydata,
                 break;
 
         case RPC_TRANSPORT_DISCONNECT:
+                rpcsvc_fairq_disconnect (svc, trans);
                 ret = rpcsvc_handle_disconnect (svc, trans);
                 break;
 
@@ -618,6 +641,8 @@ rpcsvc_notify (rpc_transport_t *trans, void *mydata,
                 break;
 
         case RPC_TRANSPORT_CLEANUP:
+                rpcsvc_fairq_cleanup (svc, trans);
+
                 listener = rpcsvc_get_listener (svc, -1, trans->listener);
                 if (listener == NULL) {
                         goto out;
@@ -1076,6 +1101,9 @@ disconnect_exit:
                 iobref_unref (iobref);
         }
 
+        if (req->fq_client)
+                rpcsvc_fairq_done (req, msglen);
+
         rpcsvc_request_destroy (req);
 
         return ret;
@@ -1804,6 +1832,10 @@ rpcsvc_init (xlator_t *xl, glusterfs_ctx_t *ctx, dict_t *options)
         INIT_LIST_HEAD (&svc->listeners);
         INIT_LIST_HEAD (&svc->programs);
 
+        pthread_mutex_init (&svc->fairq.lock, NULL);
+        INIT_LIST_HEAD (&svc->fairq.clients);
+        INIT_LIST_HEAD (&svc->fairq.active);
+
         ret = rpcsvc_init_options (svc, options);
         if (ret == -1) {
                 gf_log (GF_RPCSVC, GF_LOG_ERROR, "Failed to init options");
@@ -1831,6 +1863,7 @@ rpcsvc_init (xlator_t *xl, glusterfs_ctx_t *ctx, dict_t *options)
         svc->options = options;
         svc->ctx = ctx;
         svc->mydata = xl;
+        (void) rpcsvc_set_fairq (svc, options);
         gf_log (GF_RPCSVC, GF_LOG_DEBUG, "RPC service inited.");
 
         gluster_dump_prog.options = options;
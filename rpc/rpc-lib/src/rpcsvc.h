@@ -247,6 +247,17 @@ struct rpcsvc_request {
 
         /* Container for transport to store request-specific item */
         void                    *trans_private;
+
+        /* Fair queuing: the request waits in its client's queue on
+         * @fq_list until it is dispatched to @fq_actor, and is accounted
+         * to @fq_client from then on till the reply is submitted (unless
+         * the actor is blocking).
+         */
+        struct list_head          fq_list;
+        struct rpcsvc_actor_desc *fq_actor;
+        struct rpcsvc_fq_client  *fq_client;
+        size_t                    fq_cost;
+        struct timeval            fq_queued;
 };
 
 #define rpcsvc_request_program(req) ((rpcsvc_program_t *)((req)->prog))
@@ -328,6 +339,12 @@ typedef struct rpcsvc_actor_desc {
         rpcsvc_vector_actor     vector_actor;
         rpcsvc_vector_sizer     vector_sizer;
 
+        /* The actor may not reply till another request is handled (a
+         * blocking lock waits for the unlock of its holder), so fair
+         * queuing does not hold an inflight slot for it.
+         */
+        gf_boolean_t            blocking;
+
 } rpcsvc_actor_t;
 
 /* Describes a program and its version along with the function pointers
@@ -467,6 +484,68 @@ rpcsvc_transport_peer_check (dict_t *options, char *volname,
 extern int
 rpcsvc_transport_privport_check (rpcsvc_t *svc, char *volname,
                                  rpc_transport_t *trans);
+/* Per connection state of the fair queue. Lives from the first request
+ * seen on the connection till the transport is destroyed.
+ */
+typedef struct rpcsvc_fq_client {
+        struct list_head         list;
+        struct list_head         active;
+        struct list_head         queue;
+        rpc_transport_t         *trans;
+        gf_boolean_t             disconnected;
+
+        uint32_t                 weight;
+        int64_t                  deficit;
+        gf_boolean_t             in_turn;
+
+        /* token buckets, refilled every second up to the limit */
+        uint64_t                 iops_limit;
+        uint64_t                 bw_limit;
+        double                   iops_tokens;
+        double                   bw_tokens;
+        struct timeval           refill;
+
+        int                      queued;
+        int                      max_queued;
+        int                      inflight;
+        uint64_t                 dispatched;
+        uint64_t                 bytes;
+        uint64_t                 throttled;
+        uint64_t                 wait_total;     /* usecs */
+        uint64_t                 wait_max;
+} rpcsvc_fq_client_t;
+
+#define RPCSVC_FAIRQ_INFLIGHT_LIMIT     64
+#define RPCSVC_FAIRQ_QUANTUM            (128 * GF_UNIT_KB)
+/* Every request is charged this much on top of its payload so that
+ * metadata operations are not free.
+ */
+#define RPCSVC_FAIRQ_REQUEST_COST       (4 * GF_UNIT_KB)
+
+extern int
+rpcsvc_set_fairq (rpcsvc_t *svc, dict_t *options);
+
+extern int
+rpcsvc_fairq_submit (rpcsvc_request_t *req, rpcsvc_actor_t *actor);
+
+extern void
+rpcsvc_fairq_done (rpcsvc_request_t *req, size_t replylen);
+
+extern void
+rpcsvc_fairq_disconnect (rpcsvc_t *svc, rpc_transport_t *trans);
+
+extern void
+rpcsvc_fairq_cleanup (rpcsvc_t *svc, rpc_transport_t *trans);
+
+extern int
+rpcsvc_fairq_dump (rpcsvc_t *svc);
+
+extern int
+rpcsvc_request_call (rpcsvc_request_t *req, rpcsvc_actor_t *actor);
+
+extern void
+rpcsvc_request_destroy (rpcsvc_request_t *req);
+
 #define rpcsvc_request_seterr(req, err)                 (req)->rpc_err = err
 #define rpcsvc_request_set_autherr(req, err)            (req)->auth_err = err
 
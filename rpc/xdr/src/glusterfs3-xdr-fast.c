@@ -0,0 +1,539 @@
+/*
+  Copyright (c) 2011 Gluster, Inc. <http://www.gluster.com>
+  This file is part of GlusterFS.
+
+  GlusterFS is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published
+  by the Free Software Foundation; either version 3 of the License,
+  or (at your option) any later version.
+
+  GlusterFS is distributed in the hope that it will be useful, but
+  WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see
+  <http://www.gnu.org/licenses/>.
+*/
+
+#include <string.h>
+#include <arpa/inet.h>
+
+#include "xdr-common.h"
+#include "compat.h"
+
+#include "glusterfs3-xdr-fast.h"
+
+/* wire sizes of the fixed parts, in bytes */
+#define GF_XDR_IATT_SIZE        100
+#define GF_XDR_RSP_HDR_SIZE     8       /* op_ret, op_errno */
+#define GF_XDR_RW_REQ_SIZE      36      /* gfid, fd, offset, size */
+#define GF_XDR_DIRENT_HDR_SIZE  28      /* d_ino, d_off, d_len, d_type,
+                                           length of name */
+
+#define GF_XDR_RNDUP(len)                                               \
+        (((len) + BYTES_PER_XDR_UNIT - 1) & ~(BYTES_PER_XDR_UNIT - 1))
+
+typedef uint32_t gf_xdr_unit_t;
+
+
+static inline gf_xdr_unit_t *
+gf_xdr_put_u32 (gf_xdr_unit_t *buf, uint32_t val)
+{
+        *buf++ = htonl (val);
+        return buf;
+}
+
+
+static inline gf_xdr_unit_t *
+gf_xdr_get_u32 (gf_xdr_unit_t *buf, uint32_t *val)
+{
+        *val = ntohl (*buf++);
+        return buf;
+}
+
+
+static inline gf_xdr_unit_t *
+gf_xdr_put_u64 (gf_xdr_unit_t *buf, uint64_t val)
+{
+        *buf++ = htonl ((uint32_t)(val >> 32));
+        *buf++ = htonl ((uint32_t)(val & 0xffffffff));
+        return buf;
+}
+
+
+static inline gf_xdr_unit_t *
+gf_xdr_get_u64 (gf_xdr_unit_t *buf, uint64_t *val)
+{
+        uint64_t hi = 0;
+
+        hi   = ntohl (*buf++);
+        *val = (hi << 32) | ntohl (*buf++);
+        return buf;
+}
+
+
+static inline gf_xdr_unit_t *
+gf_xdr_put_gfid (gf_xdr_unit_t *buf, char *gfid)
+{
+        memcpy (buf, gfid, 16);
+        return buf + 4;
+}
+
+
+static inline gf_xdr_unit_t *
+gf_xdr_get_gfid (gf_xdr_unit_t *buf, char *gfid)
+{
+        memcpy (gfid, buf, 16);
+        return buf + 4;
+}
+
+
+static inline gf_xdr_unit_t *
+gf_xdr_put_iatt (gf_xdr_unit_t *buf, gf_iatt *iatt)
+{
+        buf = gf_xdr_put_gfid (buf, iatt->ia_gfid);
+        buf = gf_xdr_put_u64 (buf, iatt->ia_ino);
+        buf = gf_xdr_put_u64 (buf, iatt->ia_dev);
+        buf = gf_xdr_put_u32 (buf, iatt->mode);
+        buf = gf_xdr_put_u32 (buf, iatt->ia_nlink);
+        buf = gf_xdr_put_u32 (buf, iatt->ia_uid);
+        buf = gf_xdr_put_u32 (buf, iatt->ia_gid);
+        buf = gf_xdr_put_u64 (buf, iatt->ia_rdev);
+        buf = gf_xdr_put_u64 (buf, iatt->ia_size);
+        buf = gf_xdr_put_u32 (buf, iatt->ia_blksize);
+        buf = gf_xdr_put_u64 (buf, iatt->ia_blocks);
+        buf = gf_xdr_put_u32 (buf, iatt->ia_atime);
+        buf = gf_xdr_put_u32 (buf, iatt->ia_atime_nsec);
+        buf = gf_xdr_put_u32 (buf, iatt->ia_mtime);
+        buf = gf_xdr_put_u32 (buf, iatt->ia_mtime_nsec);
+        buf = gf_xdr_put_u32 (buf, iatt->ia_ctime);
+        buf = gf_xdr_put_u32 (buf, iatt->ia_ctime_nsec);
+
+        return buf;
+}
+
+
+static inline gf_xdr_unit_t *
+gf_xdr_get_iatt (gf_xdr_unit_t *buf, gf_iatt *iatt)
+{
+        uint64_t val = 0;
+
+        buf = gf_xdr_get_gfid (buf, iatt->ia_gfid);
+        buf = gf_xdr_get_u64 (buf, &val);
+        iatt->ia_ino = val;
+        buf = gf_xdr_get_u64 (buf, &val);
+        iatt->ia_dev = val;
+        buf = gf_xdr_get_u32 (buf, &iatt->mode);
+        buf = gf_xdr_get_u32 (buf, &iatt->ia_nlink);
+        buf = gf_xdr_get_u32 (buf, &iatt->ia_uid);
+        buf = gf_xdr_get_u32 (buf, &iatt->ia_gid);
+        buf = gf_xdr_get_u64 (buf, &val);
+        iatt->ia_rdev = val;
+        buf = gf_xdr_get_u64 (buf, &val);
+        iatt->ia_size = val;
+        buf = gf_xdr_get_u32 (buf, &iatt->ia_blksize);
+        buf = gf_xdr_get_u64 (buf, &val);
+        iatt->ia_blocks = val;
+        buf = gf_xdr_get_u32 (buf, &iatt->ia_atime);
+        buf = gf_xdr_get_u32 (buf, &iatt->ia_atime_nsec);
+        buf = gf_xdr_get_u32 (buf, &iatt->ia_mtime);
+        buf = gf_xdr_get_u32 (buf, &iatt->ia_mtime_nsec);
+        buf = gf_xdr_get_u32 (buf, &iatt->ia_ctime);
+        buf = gf_xdr_get_u32 (buf, &iatt->ia_ctime_nsec);
+
+        return buf;
+}
+
+
+static inline gf_xdr_unit_t *
+gf_xdr_inline (XDR *xdrs, u_int len)
+{
+        if ((xdrs->x_op != XDR_ENCODE) && (xdrs->x_op != XDR_DECODE))
+                return NULL;
+
+        return (gf_xdr_unit_t *) XDR_INLINE (xdrs, len);
+}
+
+
+/* op_ret, op_errno and @count iatts, the fixed part of most replies */
+static bool_t
+gf_xdr_rsp_iatts (XDR *xdrs, int *op_ret, int *op_errno, gf_iatt **iatts,
+                  int count)
+{
+        gf_xdr_unit_t *buf = NULL;
+        uint32_t       val = 0;
+        int            i   = 0;
+
+        buf = gf_xdr_inline (xdrs, GF_XDR_RSP_HDR_SIZE
+                             + (count * GF_XDR_IATT_SIZE));
+        if (!buf) {
+                if (!xdr_int (xdrs, op_ret))
+                        return FALSE;
+                if (!xdr_int (xdrs, op_errno))
+                        return FALSE;
+                for (i = 0; i < count; i++) {
+                        if (!xdr_gf_iatt (xdrs, iatts[i]))
+                                return FALSE;
+                }
+                return TRUE;
+        }
+
+        if (xdrs->x_op == XDR_ENCODE) {
+                buf = gf_xdr_put_u32 (buf, *op_ret);
+                buf = gf_xdr_put_u32 (buf, *op_errno);
+                for (i = 0; i < count; i++)
+                        buf = gf_xdr_put_iatt (buf, iatts[i]);
+        } else {
+                buf = gf_xdr_get_u32 (buf, &val);
+                *op_ret = (int) val;
+                buf = gf_xdr_get_u32 (buf, &val);
+                *op_errno = (int) val;
+                for (i = 0; i < count; i++)
+                        buf = gf_xdr_get_iatt (buf, iatts[i]);
+        }
+
+        return TRUE;
+}
+
+
+/* gfid, fd, offset and size: the fixed part of read and write requests */
+static bool_t
+gf_xdr_rw_req (XDR *xdrs, char *gfid, quad_t *fd, u_quad_t *offset,
+               u_int *size)
+{
+        gf_xdr_unit_t *buf = NULL;
+        uint64_t       val = 0;
+
+        buf = gf_xdr_inline (xdrs, GF_XDR_RW_REQ_SIZE);
+        if (!buf) {
+                if (!xdr_opaque (xdrs, gfid, 16))
+                        return FALSE;
+                if (!xdr_quad_t (xdrs, fd))
+                        return FALSE;
+                if (!xdr_u_quad_t (xdrs, offset))
+                        return FALSE;
+                if (!xdr_u_int (xdrs, size))
+                        return FALSE;
+                return TRUE;
+        }
+
+        if (xdrs->x_op == XDR_ENCODE) {
+                buf = gf_xdr_put_gfid (buf, gfid);
+                buf = gf_xdr_put_u64 (buf, *fd);
+                buf = gf_xdr_put_u64 (buf, *offset);
+                buf = gf_xdr_put_u32 (buf, *size);
+        } else {
+                buf = gf_xdr_get_gfid (buf, gfid);
+                buf = gf_xdr_get_u64 (buf, &val);
+                *fd = (quad_t) val;
+                buf = gf_xdr_get_u64 (buf, &val);
+                *offset = val;
+                buf = gf_xdr_get_u32 (buf, size);
+        }
+
+        return TRUE;
+}
+
+
+bool_t
+xdr_fast_gf_iatt (XDR *xdrs, gf_iatt *objp)
+{
+        gf_xdr_unit_t *buf = NULL;
+
+        buf = gf_xdr_inline (xdrs, GF_XDR_IATT_SIZE);
+        if (!buf)
+                return xdr_gf_iatt (xdrs, objp);
+
+        if (xdrs->x_op == XDR_ENCODE)
+                gf_xdr_put_iatt (buf, objp);
+        else
+                gf_xdr_get_iatt (buf, objp);
+
+        return TRUE;
+}
+
+
+bool_t
+xdr_fast_gfs3_stat_rsp (XDR *xdrs, gfs3_stat_rsp *objp)
+{
+        gf_iatt *iatts[] = { &objp->stat };
+
+        return gf_xdr_rsp_iatts (xdrs, &objp->op_ret, &objp->op_errno,
+                                 iatts, 1);
+}
+
+
+bool_t
+xdr_fast_gfs3_fstat_rsp (XDR *xdrs, gfs3_fstat_rsp *objp)
+{
+        gf_iatt *iatts[] = { &objp->stat };
+
+        return gf_xdr_rsp_iatts (xdrs, &objp->op_ret, &objp->op_errno,
+                                 iatts, 1);
+}
+
+
+bool_t
+xdr_fast_gfs3_lookup_req (XDR *xdrs, gfs3_lookup_req *objp)
+{
+        gf_xdr_unit_t *buf = NULL;
+
+        if (xdrs->x_op == XDR_FREE)
+                return xdr_gfs3_lookup_req (xdrs, objp);
+
+        buf = gf_xdr_inline (xdrs, 36);
+        if (!buf) {
+                if (!xdr_opaque (xdrs, objp->gfid, 16))
+                        return FALSE;
+                if (!xdr_opaque (xdrs, objp->pargfid, 16))
+                        return FALSE;
+                if (!xdr_u_int (xdrs, &objp->flags))
+                        return FALSE;
+        } else if (xdrs->x_op == XDR_ENCODE) {
+                buf = gf_xdr_put_gfid (buf, objp->gfid);
+                buf = gf_xdr_put_gfid (buf, objp->pargfid);
+                buf = gf_xdr_put_u32 (buf, objp->flags);
+        } else {
+                buf = gf_xdr_get_gfid (buf, objp->gfid);
+                buf = gf_xdr_get_gfid (buf, objp->pargfid);
+                buf = gf_xdr_get_u32 (buf, &objp->flags);
+        }
+
+        if (!xdr_string (xdrs, &objp->path, ~0))
+                return FALSE;
+        if (!xdr_string (xdrs, &objp->bname, ~0))
+                return FALSE;
+        if (!xdr_bytes (xdrs, (char **)&objp->dict.dict_val,
+                        (u_int *) &objp->dict.dict_len, ~0))
+                return FALSE;
+
+        return TRUE;
+}
+
+
+bool_t
+xdr_fast_gfs3_lookup_rsp (XDR *xdrs, gfs3_lookup_rsp *objp)
+{
+        gf_iatt *iatts[] = { &objp->stat, &objp->postparent };
+
+        if (xdrs->x_op == XDR_FREE)
+                return xdr_gfs3_lookup_rsp (xdrs, objp);
+
+        if (!gf_xdr_rsp_iatts (xdrs, &objp->op_ret, &objp->op_errno,
+                               iatts, 2))
+                return FALSE;
+
+        if (!xdr_bytes (xdrs, (char **)&objp->dict.dict_val,
+                        (u_int *) &objp->dict.dict_len, ~0))
+                return FALSE;
+
+        return TRUE;
+}
+
+
+bool_t
+xdr_fast_gfs3_read_req (XDR *xdrs, gfs3_read_req *objp)
+{
+        return gf_xdr_rw_req (xdrs, objp->gfid, &objp->fd, &objp->offset,
+                              &objp->size);
+}
+
+
+bool_t
+xdr_fast_gfs3_read_rsp (XDR *xdrs, gfs3_read_rsp *objp)
+{
+        gf_iatt *iatts[] = { &objp->stat };
+
+        if (!gf_xdr_rsp_iatts (xdrs, &objp->op_ret, &objp->op_errno,
+                               iatts, 1))
+                return FALSE;
+
+        return xdr_u_int (xdrs, &objp->size);
+}
+
+
+bool_t
+xdr_fast_gfs3_write_req (XDR *xdrs, gfs3_write_req *objp)
+{
+        return gf_xdr_rw_req (xdrs, objp->gfid, &objp->fd, &objp->offset,
+                              &objp->size);
+}
+
+
+bool_t
+xdr_fast_gfs3_write_rsp (XDR *xdrs, gfs3_write_rsp *objp)
+{
+        gf_iatt *iatts[] = { &objp->prestat, &objp->poststat };
+
+        return gf_xdr_rsp_iatts (xdrs, &objp->op_ret, &objp->op_errno,
+                                 iatts, 2);
+}
+
+
+/* Directory entries: the rpcgen codec recurses once per entry through
+   xdr_pointer (); here the list is walked in a loop, and each entry is
+   one inline copy. */
+
+static bool_t
+gf_xdr_dirent (XDR *xdrs, u_quad_t *d_ino, u_quad_t *d_off, u_int *d_len,
+               u_int *d_type, char **name, gf_iatt *stat)
+{
+        gf_xdr_unit_t *buf     = NULL;
+        uint64_t       val     = 0;
+        uint32_t       namelen = 0;
+        u_int          padded  = 0;
+
+        if (xdrs->x_op == XDR_ENCODE) {
+                namelen = strlen (*name);
+                padded  = GF_XDR_RNDUP (namelen);
+
+                buf = gf_xdr_inline (xdrs, GF_XDR_DIRENT_HDR_SIZE + padded
+                                     + (stat ? GF_XDR_IATT_SIZE : 0));
+                if (!buf)
+                        goto slow;
+
+                buf = gf_xdr_put_u64 (buf, *d_ino);
+                buf = gf_xdr_put_u64 (buf, *d_off);
+                buf = gf_xdr_put_u32 (buf, *d_len);
+                buf = gf_xdr_put_u32 (buf, *d_type);
+                buf = gf_xdr_put_u32 (buf, namelen);
+                if (padded) {
+                        buf[(padded / BYTES_PER_XDR_UNIT) - 1] = 0;
+                        memcpy (buf, *name, namelen);
+                        buf += padded / BYTES_PER_XDR_UNIT;
+                }
+                if (stat)
+                        gf_xdr_put_iatt (buf, stat);
+
+                return TRUE;
+        }
+
+        buf = gf_xdr_inline (xdrs, GF_XDR_DIRENT_HDR_SIZE);
+        if (!buf)
+                goto slow;
+
+        buf = gf_xdr_get_u64 (buf, &val);
+        *d_ino = val;
+        buf = gf_xdr_get_u64 (buf, &val);
+        *d_off = val;
+        buf = gf_xdr_get_u32 (buf, d_len);
+        buf = gf_xdr_get_u32 (buf, d_type);
+        buf = gf_xdr_get_u32 (buf, &namelen);
+
+        if (namelen == (uint32_t) ~0)
+                return FALSE;
+
+        if (!*name) {
+                *name = mem_alloc (namelen + 1);
+                if (!*name)
+                        return FALSE;
+        }
+        (*name)[namelen] = '\0';
+
+        padded = GF_XDR_RNDUP (namelen);
+        if (padded) {
+                buf = gf_xdr_inline (xdrs, padded);
+                if (buf)
+                        memcpy (*name, buf, namelen);
+                else if (!xdr_opaque (xdrs, *name, namelen))
+                        return FALSE;
+        }
+
+        if (stat && !xdr_fast_gf_iatt (xdrs, stat))
+                return FALSE;
+
+        return TRUE;
+slow:
+        if (!xdr_u_quad_t (xdrs, d_ino))
+                return FALSE;
+        if (!xdr_u_quad_t (xdrs, d_off))
+                return FALSE;
+        if (!xdr_u_int (xdrs, d_len))
+                return FALSE;
+        if (!xdr_u_int (xdrs, d_type))
+                return FALSE;
+        if (!xdr_string (xdrs, name, ~0))
+                return FALSE;
+        if (stat && !xdr_gf_iatt (xdrs, stat))
+                return FALSE;
+
+        return TRUE;
+}
+
+
+bool_t
+xdr_fast_gfs3_readdir_rsp (XDR *xdrs, gfs3_readdir_rsp *objp)
+{
+        gfs3_dirlist  **entry = NULL;
+        bool_t          more  = FALSE;
+
+        if (xdrs->x_op == XDR_FREE)
+                return xdr_gfs3_readdir_rsp (xdrs, objp);
+
+        if (!xdr_int (xdrs, &objp->op_ret))
+                return FALSE;
+        if (!xdr_int (xdrs, &objp->op_errno))
+                return FALSE;
+
+        for (entry = &objp->reply; ; entry = &(*entry)->nextentry) {
+                more = (*entry != NULL);
+                if (!xdr_bool (xdrs, &more))
+                        return FALSE;
+                if (!more)
+                        break;
+
+                if ((xdrs->x_op == XDR_DECODE) && !*entry) {
+                        *entry = mem_alloc (sizeof (**entry));
+                        if (!*entry)
+                                return FALSE;
+                        memset (*entry, 0, sizeof (**entry));
+                }
+
+                if (!gf_xdr_dirent (xdrs, &(*entry)->d_ino, &(*entry)->d_off,
+                                    &(*entry)->d_len, &(*entry)->d_type,
+                                    &(*entry)->name, NULL))
+                        return FALSE;
+        }
+
+        return TRUE;
+}
+
+
+bool_t
+xdr_fast_gfs3_readdirp_rsp (XDR *xdrs, gfs3_readdirp_rsp *objp)
+{
+        gfs3_dirplist **entry = NULL;
+        bool_t          more  = FALSE;
+
+        if (xdrs->x_op == XDR_FREE)
+                return xdr_gfs3_readdirp_rsp (xdrs, objp);
+
+        if (!xdr_int (xdrs, &objp->op_ret))
+                return FALSE;
+        if (!xdr_int (xdrs, &objp->op_errno))
+                return FALSE;
+
+        for (entry = &objp->reply; ; entry = &(*entry)->nextentry) {
+                more = (*entry != NULL);
+                if (!xdr_bool (xdrs, &more))
+                        return FALSE;
+                if (!more)
+                        break;
+
+                if ((xdrs->x_op == XDR_DECODE) && !*entry) {
+                        *entry = mem_alloc (sizeof (**entry));
+                        if (!*entry)
+                                return FALSE;
+                        memset (*entry, 0, sizeof (**entry));
+                }
+
+                if (!gf_xdr_dirent (xdrs, &(*entry)->d_ino, &(*entry)->d_off,
+                                    &(*entry)->d_len, &(*entry)->d_type,
+                                    &(*entry)->name, &(*entry)->stat))
+                        return FALSE;
+        }
+
+        return TRUE;
+}
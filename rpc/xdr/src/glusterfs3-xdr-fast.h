@@ -0,0 +1,52 @@
+/*
+  Copyright (c) 2011 Gluster, Inc. <http://www.gluster.com>
+  This file is part of GlusterFS.
+
+  GlusterFS is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published
+  by the Free Software Foundation; either version 3 of the License,
+  or (at your option) any later version.
+
+  GlusterFS is distributed in the hope that it will be useful, but
+  WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see
+  <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef _GLUSTERFS3_XDR_FAST_H
+#define _GLUSTERFS3_XDR_FAST_H
+
+#include "glusterfs3-xdr.h"
+
+/*
+ * Hand written codecs for the procedures on the data path. They produce
+ * exactly the same bytes as their rpcgen counterparts in glusterfs3-xdr.c,
+ * and can be used wherever those are: the fixed size parts of a message
+ * are read/written in one go from the stream buffer (XDR_INLINE) instead
+ * of field by field, and directory listings are walked iteratively instead
+ * of recursively. Whenever the stream can not give out a contiguous
+ * buffer, and for XDR_FREE, the rpcgen primitives are used.
+ */
+
+bool_t xdr_fast_gf_iatt (XDR *xdrs, gf_iatt *objp);
+
+bool_t xdr_fast_gfs3_stat_rsp (XDR *xdrs, gfs3_stat_rsp *objp);
+bool_t xdr_fast_gfs3_fstat_rsp (XDR *xdrs, gfs3_fstat_rsp *objp);
+
+bool_t xdr_fast_gfs3_lookup_req (XDR *xdrs, gfs3_lookup_req *objp);
+bool_t xdr_fast_gfs3_lookup_rsp (XDR *xdrs, gfs3_lookup_rsp *objp);
+
+bool_t xdr_fast_gfs3_read_req (XDR *xdrs, gfs3_read_req *objp);
+bool_t xdr_fast_gfs3_read_rsp (XDR *xdrs, gfs3_read_rsp *objp);
+
+bool_t xdr_fast_gfs3_write_req (XDR *xdrs, gfs3_write_req *objp);
+bool_t xdr_fast_gfs3_write_rsp (XDR *xdrs, gfs3_write_rsp *objp);
+
+bool_t xdr_fast_gfs3_readdir_rsp (XDR *xdrs, gfs3_readdir_rsp *objp);
+bool_t xdr_fast_gfs3_readdirp_rsp (XDR *xdrs, gfs3_readdirp_rsp *objp);
+
+#endif /* !_GLUSTERFS3_XDR_FAST_H */
@@ -1686,3 +1686,336 @@ xdr_gfs3_readdirp_rsp (XDR *xdrs, gfs3_readdirp_rsp *objp)
 		 return FALSE;
 	return TRUE;
 }
+
+bool_t
+xdr_gfs3_compound_fop (XDR *xdrs, gfs3_compound_fop *objp)
+{
+	register int32_t *buf;
+        buf = NULL;
+
+	 if (!xdr_enum (xdrs, (enum_t *) objp))
+		 return FALSE;
+	return TRUE;
+}
+
+bool_t
+xdr_gfs3_compound_write_req (XDR *xdrs, gfs3_compound_write_req *objp)
+{
+	register int32_t *buf;
+        buf = NULL;
+
+	 if (!xdr_gfs3_write_req (xdrs, &objp->req))
+		 return FALSE;
+	 if (!xdr_bytes (xdrs, (char **)&objp->data.data_val, (u_int *) &objp->data.data_len, ~0))
+		 return FALSE;
+	return TRUE;
+}
+
+bool_t
+xdr_gfs3_compound_req_op (XDR *xdrs, gfs3_compound_req_op *objp)
+{
+	register int32_t *buf;
+        buf = NULL;
+
+	 if (!xdr_gfs3_compound_fop (xdrs, &objp->fop))
+		 return FALSE;
+	switch (objp->fop) {
+	case GFS3_COMPOUND_LOOKUP:
+		 if (!xdr_gfs3_lookup_req (xdrs, &objp->gfs3_compound_req_op_u.lookup_req))
+			 return FALSE;
+		break;
+	case GFS3_COMPOUND_OPEN:
+		 if (!xdr_gfs3_open_req (xdrs, &objp->gfs3_compound_req_op_u.open_req))
+			 return FALSE;
+		break;
+	case GFS3_COMPOUND_READ:
+		 if (!xdr_gfs3_read_req (xdrs, &objp->gfs3_compound_req_op_u.read_req))
+			 return FALSE;
+		break;
+	case GFS3_COMPOUND_CREATE:
+		 if (!xdr_gfs3_create_req (xdrs, &objp->gfs3_compound_req_op_u.create_req))
+			 return FALSE;
+		break;
+	case GFS3_COMPOUND_WRITE:
+		 if (!xdr_gfs3_compound_write_req (xdrs, &objp->gfs3_compound_req_op_u.write_req))
+			 return FALSE;
+		break;
+	case GFS3_COMPOUND_FLUSH:
+		 if (!xdr_gfs3_flush_req (xdrs, &objp->gfs3_compound_req_op_u.flush_req))
+			 return FALSE;
+		break;
+	default:
+		return FALSE;
+	}
+	return TRUE;
+}
+
+bool_t
+xdr_gfs3_compound_req (XDR *xdrs, gfs3_compound_req *objp)
+{
+	register int32_t *buf;
+        buf = NULL;
+
+	 if (!xdr_array (xdrs, (char **)&objp->ops.ops_val, (u_int *) &objp->ops.ops_len, ~0,
+		sizeof (gfs3_compound_req_op), (xdrproc_t) xdr_gfs3_compound_req_op))
+		 return FALSE;
+	return TRUE;
+}
+
+bool_t
+xdr_gfs3_compound_read_rsp (XDR *xdrs, gfs3_compound_read_rsp *objp)
+{
+	register int32_t *buf;
+        buf = NULL;
+
+	 if (!xdr_gfs3_read_rsp (xdrs, &objp->rsp))
+		 return FALSE;
+	 if (!xdr_bytes (xdrs, (char **)&objp->data.data_val, (u_int *) &objp->data.data_len, ~0))
+		 return FALSE;
+	return TRUE;
+}
+
+bool_t
+xdr_gfs3_compound_rsp_op (XDR *xdrs, gfs3_compound_rsp_op *objp)
+{
+	register int32_t *buf;
+        buf = NULL;
+
+	 if (!xdr_gfs3_compound_fop (xdrs, &objp->fop))
+		 return FALSE;
+	switch (objp->fop) {
+	case GFS3_COMPOUND_LOOKUP:
+		 if (!xdr_gfs3_lookup_rsp (xdrs, &objp->gfs3_compound_rsp_op_u.lookup_rsp))
+			 return FALSE;
+		break;
+	case GFS3_COMPOUND_OPEN:
+		 if (!xdr_gfs3_open_rsp (xdrs, &objp->gfs3_compound_rsp_op_u.open_rsp))
+			 return FALSE;
+		break;
+	case GFS3_COMPOUND_READ:
+		 if (!xdr_gfs3_compound_read_rsp (xdrs, &objp->gfs3_compound_rsp_op_u.read_rsp))
+			 return FALSE;
+		break;
+	case GFS3_COMPOUND_CREATE:
+		 if (!xdr_gfs3_create_rsp (xdrs, &objp->gfs3_compound_rsp_op_u.create_rsp))
+			 return FALSE;
+		break;
+	case GFS3_COMPOUND_WRITE:
+		 if (!xdr_gfs3_write_rsp (xdrs, &objp->gfs3_compound_rsp_op_u.write_rsp))
+			 return FALSE;
+		break;
+	case GFS3_COMPOUND_FLUSH:
+		 if (!xdr_gf_common_rsp (xdrs, &objp->gfs3_compound_rsp_op_u.flush_rsp))
+			 return FALSE;
+		break;
+	default:
+		return FALSE;
+	}
+	return TRUE;
+}
+
+bool_t
+xdr_gfs3_compound_rsp (XDR *xdrs, gfs3_compound_rsp *objp)
+{
+	register int32_t *buf;
+        buf = NULL;
+
+	 if (!xdr_int (xdrs, &objp->op_ret))
+		 return FALSE;
+	 if (!xdr_int (xdrs, &objp->op_errno))
+		 return FALSE;
+	 if (!xdr_array (xdrs, (char **)&objp->ops.ops_val, (u_int *) &objp->ops.ops_len, ~0,
+		sizeof (gfs3_compound_rsp_op), (xdrproc_t) xdr_gfs3_compound_rsp_op))
+		 return FALSE;
+	return TRUE;
+}
+
+bool_t
+xdr_gfs3_bulkstat_entry (XDR *xdrs, gfs3_bulkstat_entry *objp)
+{
+	register int32_t *buf;
+        buf = NULL;
+
+	 if (!xdr_opaque (xdrs, objp->gfid, 16))
+		 return FALSE;
+	 if (!xdr_string (xdrs, &objp->path, ~0))
+		 return FALSE;
+	return TRUE;
+}
+
+bool_t
+xdr_gfs3_bulkstat_req (XDR *xdrs, gfs3_bulkstat_req *objp)
+{
+	register int32_t *buf;
+        buf = NULL;
+
+	 if (!xdr_array (xdrs, (char **)&objp->entries.entries_val, (u_int *) &objp->entries.entries_len, ~0,
+		sizeof (gfs3_bulkstat_entry), (xdrproc_t) xdr_gfs3_bulkstat_entry))
+		 return FALSE;
+	return TRUE;
+}
+
+bool_t
+xdr_gfs3_bulkstat_rsp_entry (XDR *xdrs, gfs3_bulkstat_rsp_entry *objp)
+{
+	register int32_t *buf;
+        buf = NULL;
+
+	 if (!xdr_int (xdrs, &objp->op_errno))
+		 return FALSE;
+	 if (!xdr_gf_iatt (xdrs, &objp->stat))
+		 return FALSE;
+	return TRUE;
+}
+
+bool_t
+xdr_gfs3_bulkstat_rsp (XDR *xdrs, gfs3_bulkstat_rsp *objp)
+{
+	register int32_t *buf;
+        buf = NULL;
+
+	 if (!xdr_int (xdrs, &objp->op_ret))
+		 return FALSE;
+	 if (!xdr_int (xdrs, &objp->op_errno))
+		 return FALSE;
+	 if (!xdr_array (xdrs, (char **)&objp->entries.entries_val, (u_int *) &objp->entries.entries_len, ~0,
+		sizeof (gfs3_bulkstat_rsp_entry), (xdrproc_t) xdr_gfs3_bulkstat_rsp_entry))
+		 return FALSE;
+	return TRUE;
+}
+
+bool_t
+xdr_gfs3_fallocate_req (XDR *xdrs, gfs3_fallocate_req *objp)
+{
+	register int32_t *buf;
+        buf = NULL;
+
+	 if (!xdr_opaque (xdrs, objp->gfid, 16))
+		 return FALSE;
+	 if (!xdr_quad_t (xdrs, &objp->fd))
+		 return FALSE;
+	 if (!xdr_u_int (xdrs, &objp->flags))
+		 return FALSE;
+	 if (!xdr_u_quad_t (xdrs, &objp->offset))
+		 return FALSE;
+	 if (!xdr_u_quad_t (xdrs, &objp->size))
+		 return FALSE;
+	return TRUE;
+}
+
+bool_t
+xdr_gfs3_fallocate_rsp (XDR *xdrs, gfs3_fallocate_rsp *objp)
+{
+	register int32_t *buf;
+        buf = NULL;
+
+	 if (!xdr_int (xdrs, &objp->op_ret))
+		 return FALSE;
+	 if (!xdr_int (xdrs, &objp->op_errno))
+		 return FALSE;
+	 if (!xdr_gf_iatt (xdrs, &objp->statpre))
+		 return FALSE;
+	 if (!xdr_gf_iatt (xdrs, &objp->statpost))
+		 return FALSE;
+	return TRUE;
+}
+
+bool_t
+xdr_gfs3_discard_req (XDR *xdrs, gfs3_discard_req *objp)
+{
+	register int32_t *buf;
+        buf = NULL;
+
+	 if (!xdr_opaque (xdrs, objp->gfid, 16))
+		 return FALSE;
+	 if (!xdr_quad_t (xdrs, &objp->fd))
+		 return FALSE;
+	 if (!xdr_u_quad_t (xdrs, &objp->offset))
+		 return FALSE;
+	 if (!xdr_u_quad_t (xdrs, &objp->size))
+		 return FALSE;
+	return TRUE;
+}
+
+bool_t
+xdr_gfs3_discard_rsp (XDR *xdrs, gfs3_discard_rsp *objp)
+{
+	register int32_t *buf;
+        buf = NULL;
+
+	 if (!xdr_int (xdrs, &objp->op_ret))
+		 return FALSE;
+	 if (!xdr_int (xdrs, &objp->op_errno))
+		 return FALSE;
+	 if (!xdr_gf_iatt (xdrs, &objp->statpre))
+		 return FALSE;
+	 if (!xdr_gf_iatt (xdrs, &objp->statpost))
+		 return FALSE;
+	return TRUE;
+}
+
+bool_t
+xdr_gfs3_zerofill_req (XDR *xdrs, gfs3_zerofill_req *objp)
+{
+	register int32_t *buf;
+        buf = NULL;
+
+	 if (!xdr_opaque (xdrs, objp->gfid, 16))
+		 return FALSE;
+	 if (!xdr_quad_t (xdrs, &objp->fd))
+		 return FALSE;
+	 if (!xdr_u_quad_t (xdrs, &objp->offset))
+		 return FALSE;
+	 if (!xdr_u_quad_t (xdrs, &objp->size))
+		 return FALSE;
+	return TRUE;
+}
+
+bool_t
+xdr_gfs3_zerofill_rsp (XDR *xdrs, gfs3_zerofill_rsp *objp)
+{
+	register int32_t *buf;
+        buf = NULL;
+
+	 if (!xdr_int (xdrs, &objp->op_ret))
+		 return FALSE;
+	 if (!xdr_int (xdrs, &objp->op_errno))
+		 return FALSE;
+	 if (!xdr_gf_iatt (xdrs, &objp->statpre))
+		 return FALSE;
+	 if (!xdr_gf_iatt (xdrs, &objp->statpost))
+		 return FALSE;
+	return TRUE;
+}
+
+bool_t
+xdr_gfs3_seek_req (XDR *xdrs, gfs3_seek_req *objp)
+{
+	register int32_t *buf;
+        buf = NULL;
+
+	 if (!xdr_opaque (xdrs, objp->gfid, 16))
+		 return FALSE;
+	 if (!xdr_quad_t (xdrs, &objp->fd))
+		 return FALSE;
+	 if (!xdr_u_quad_t (xdrs, &objp->offset))
+		 return FALSE;
+	 if (!xdr_int (xdrs, &objp->what))
+		 return FALSE;
+	return TRUE;
+}
+
+bool_t
+xdr_gfs3_seek_rsp (XDR *xdrs, gfs3_seek_rsp *objp)
+{
+	register int32_t *buf;
+        buf = NULL;
+
+	 if (!xdr_int (xdrs, &objp->op_ret))
+		 return FALSE;
+	 if (!xdr_int (xdrs, &objp->op_errno))
+		 return FALSE;
+	 if (!xdr_u_quad_t (xdrs, &objp->offset))
+		 return FALSE;
+	return TRUE;
+}
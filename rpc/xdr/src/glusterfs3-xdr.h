@@ -785,6 +785,172 @@ struct gfs3_readdirp_rsp {
 };
 typedef struct gfs3_readdirp_rsp gfs3_readdirp_rsp;
 
+enum gfs3_compound_fop {
+	GFS3_COMPOUND_LOOKUP = 1,
+	GFS3_COMPOUND_OPEN = 1 + 1,
+	GFS3_COMPOUND_READ = 1 + 2,
+	GFS3_COMPOUND_CREATE = 1 + 3,
+	GFS3_COMPOUND_WRITE = 1 + 4,
+	GFS3_COMPOUND_FLUSH = 1 + 5,
+};
+typedef enum gfs3_compound_fop gfs3_compound_fop;
+
+struct gfs3_compound_write_req {
+	struct gfs3_write_req req;
+	struct {
+		u_int data_len;
+		char *data_val;
+	} data;
+};
+typedef struct gfs3_compound_write_req gfs3_compound_write_req;
+
+struct gfs3_compound_req_op {
+	gfs3_compound_fop fop;
+	union {
+		struct gfs3_lookup_req lookup_req;
+		struct gfs3_open_req open_req;
+		struct gfs3_read_req read_req;
+		struct gfs3_create_req create_req;
+		struct gfs3_compound_write_req write_req;
+		struct gfs3_flush_req flush_req;
+	} gfs3_compound_req_op_u;
+};
+typedef struct gfs3_compound_req_op gfs3_compound_req_op;
+
+struct gfs3_compound_req {
+	struct {
+		u_int ops_len;
+		gfs3_compound_req_op *ops_val;
+	} ops;
+};
+typedef struct gfs3_compound_req gfs3_compound_req;
+
+struct gfs3_compound_read_rsp {
+	struct gfs3_read_rsp rsp;
+	struct {
+		u_int data_len;
+		char *data_val;
+	} data;
+};
+typedef struct gfs3_compound_read_rsp gfs3_compound_read_rsp;
+
+struct gfs3_compound_rsp_op {
+	gfs3_compound_fop fop;
+	union {
+		struct gfs3_lookup_rsp lookup_rsp;
+		struct gfs3_open_rsp open_rsp;
+		struct gfs3_compound_read_rsp read_rsp;
+		struct gfs3_create_rsp create_rsp;
+		struct gfs3_write_rsp write_rsp;
+		struct gf_common_rsp flush_rsp;
+	} gfs3_compound_rsp_op_u;
+};
+typedef struct gfs3_compound_rsp_op gfs3_compound_rsp_op;
+
+struct gfs3_compound_rsp {
+	int op_ret;
+	int op_errno;
+	struct {
+		u_int ops_len;
+		gfs3_compound_rsp_op *ops_val;
+	} ops;
+};
+typedef struct gfs3_compound_rsp gfs3_compound_rsp;
+
+struct gfs3_bulkstat_entry {
+	char gfid[16];
+	char *path;
+};
+typedef struct gfs3_bulkstat_entry gfs3_bulkstat_entry;
+
+struct gfs3_bulkstat_req {
+	struct {
+		u_int entries_len;
+		gfs3_bulkstat_entry *entries_val;
+	} entries;
+};
+typedef struct gfs3_bulkstat_req gfs3_bulkstat_req;
+
+struct gfs3_bulkstat_rsp_entry {
+	int op_errno;
+	struct gf_iatt stat;
+};
+typedef struct gfs3_bulkstat_rsp_entry gfs3_bulkstat_rsp_entry;
+
+struct gfs3_bulkstat_rsp {
+	int op_ret;
+	int op_errno;
+	struct {
+		u_int entries_len;
+		gfs3_bulkstat_rsp_entry *entries_val;
+	} entries;
+};
+typedef struct gfs3_bulkstat_rsp gfs3_bulkstat_rsp;
+
+struct gfs3_fallocate_req {
+	char gfid[16];
+	quad_t fd;
+	u_int flags;
+	u_quad_t offset;
+	u_quad_t size;
+};
+typedef struct gfs3_fallocate_req gfs3_fallocate_req;
+
+struct gfs3_fallocate_rsp {
+	int op_ret;
+	int op_errno;
+	struct gf_iatt statpre;
+	struct gf_iatt statpost;
+};
+typedef struct gfs3_fallocate_rsp gfs3_fallocate_rsp;
+
+struct gfs3_discard_req {
+	char gfid[16];
+	quad_t fd;
+	u_quad_t offset;
+	u_quad_t size;
+};
+typedef struct gfs3_discard_req gfs3_discard_req;
+
+struct gfs3_discard_rsp {
+	int op_ret;
+	int op_errno;
+	struct gf_iatt statpre;
+	struct gf_iatt statpost;
+};
+typedef struct gfs3_discard_rsp gfs3_discard_rsp;
+
+struct gfs3_zerofill_req {
+	char gfid[16];
+	quad_t fd;
+	u_quad_t offset;
+	u_quad_t size;
+};
+typedef struct gfs3_zerofill_req gfs3_zerofill_req;
+
+struct gfs3_zerofill_rsp {
+	int op_ret;
+	int op_errno;
+	struct gf_iatt statpre;
+	struct gf_iatt statpost;
+};
+typedef struct gfs3_zerofill_rsp gfs3_zerofill_rsp;
+
+struct gfs3_seek_req {
+	char gfid[16];
+	quad_t fd;
+	u_quad_t offset;
+	int what;
+};
+typedef struct gfs3_seek_req gfs3_seek_req;
+
+struct gfs3_seek_rsp {
+	int op_ret;
+	int op_errno;
+	u_quad_t offset;
+};
+typedef struct gfs3_seek_rsp gfs3_seek_rsp;
+
 /* the xdr functions */
 
 #if defined(__STDC__) || defined(__cplusplus)
@@ -873,6 +1039,25 @@ extern  bool_t xdr_gfs3_dirlist (XDR *, gfs3_dirlist*);
 extern  bool_t xdr_gfs3_readdir_rsp (XDR *, gfs3_readdir_rsp*);
 extern  bool_t xdr_gfs3_dirplist (XDR *, gfs3_dirplist*);
 extern  bool_t xdr_gfs3_readdirp_rsp (XDR *, gfs3_readdirp_rsp*);
+extern  bool_t xdr_gfs3_compound_fop (XDR *, gfs3_compound_fop*);
+extern  bool_t xdr_gfs3_compound_write_req (XDR *, gfs3_compound_write_req*);
+extern  bool_t xdr_gfs3_compound_req_op (XDR *, gfs3_compound_req_op*);
+extern  bool_t xdr_gfs3_compound_req (XDR *, gfs3_compound_req*);
+extern  bool_t xdr_gfs3_compound_read_rsp (XDR *, gfs3_compound_read_rsp*);
+extern  bool_t xdr_gfs3_compound_rsp_op (XDR *, gfs3_compound_rsp_op*);
+extern  bool_t xdr_gfs3_compound_rsp (XDR *, gfs3_compound_rsp*);
+extern  bool_t xdr_gfs3_bulkstat_entry (XDR *, gfs3_bulkstat_entry*);
+extern  bool_t xdr_gfs3_bulkstat_req (XDR *, gfs3_bulkstat_req*);
+extern  bool_t xdr_gfs3_bulkstat_rsp_entry (XDR *, gfs3_bulkstat_rsp_entry*);
+extern  bool_t xdr_gfs3_bulkstat_rsp (XDR *, gfs3_bulkstat_rsp*);
+extern  bool_t xdr_gfs3_fallocate_req (XDR *, gfs3_fallocate_req*);
+extern  bool_t xdr_gfs3_fallocate_rsp (XDR *, gfs3_fallocate_rsp*);
+extern  bool_t xdr_gfs3_discard_req (XDR *, gfs3_discard_req*);
+extern  bool_t xdr_gfs3_discard_rsp (XDR *, gfs3_discard_rsp*);
+extern  bool_t xdr_gfs3_zerofill_req (XDR *, gfs3_zerofill_req*);
+extern  bool_t xdr_gfs3_zerofill_rsp (XDR *, gfs3_zerofill_rsp*);
+extern  bool_t xdr_gfs3_seek_req (XDR *, gfs3_seek_req*);
+extern  bool_t xdr_gfs3_seek_rsp (XDR *, gfs3_seek_rsp*);
 
 #else /* K&R C */
 extern bool_t xdr_gf_statfs ();
@@ -960,6 +1145,25 @@ extern bool_t xdr_gfs3_dirlist ();
 extern bool_t xdr_gfs3_readdir_rsp ();
 extern bool_t xdr_gfs3_dirplist ();
 extern bool_t xdr_gfs3_readdirp_rsp ();
+extern bool_t xdr_gfs3_compound_fop ();
+extern bool_t xdr_gfs3_compound_write_req ();
+extern bool_t xdr_gfs3_compound_req_op ();
+extern bool_t xdr_gfs3_compound_req ();
+extern bool_t xdr_gfs3_compound_read_rsp ();
+extern bool_t xdr_gfs3_compound_rsp_op ();
+extern bool_t xdr_gfs3_compound_rsp ();
+extern bool_t xdr_gfs3_bulkstat_entry ();
+extern bool_t xdr_gfs3_bulkstat_req ();
+extern bool_t xdr_gfs3_bulkstat_rsp_entry ();
+extern bool_t xdr_gfs3_bulkstat_rsp ();
+extern bool_t xdr_gfs3_fallocate_req ();
+extern bool_t xdr_gfs3_fallocate_rsp ();
+extern bool_t xdr_gfs3_discard_req ();
+extern bool_t xdr_gfs3_discard_rsp ();
+extern bool_t xdr_gfs3_zerofill_req ();
+extern bool_t xdr_gfs3_zerofill_rsp ();
+extern bool_t xdr_gfs3_seek_req ();
+extern bool_t xdr_gfs3_seek_rsp ();
 
 #endif /* K&R C */
 
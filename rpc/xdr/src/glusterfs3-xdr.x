@@ -614,3 +614,139 @@ struct gfs3_readdirp_rsp {
        struct gfs3_dirplist *reply;
 };
 
+
+enum gfs3_compound_fop {
+        GFS3_COMPOUND_LOOKUP = 1,
+        GFS3_COMPOUND_OPEN,
+        GFS3_COMPOUND_READ,
+        GFS3_COMPOUND_CREATE,
+        GFS3_COMPOUND_WRITE,
+        GFS3_COMPOUND_FLUSH
+};
+
+struct gfs3_compound_write_req {
+        struct gfs3_write_req req;
+        opaque                data<>;
+};
+
+union gfs3_compound_req_op switch (gfs3_compound_fop fop) {
+case GFS3_COMPOUND_LOOKUP:
+        struct gfs3_lookup_req          lookup_req;
+case GFS3_COMPOUND_OPEN:
+        struct gfs3_open_req            open_req;
+case GFS3_COMPOUND_READ:
+        struct gfs3_read_req            read_req;
+case GFS3_COMPOUND_CREATE:
+        struct gfs3_create_req          create_req;
+case GFS3_COMPOUND_WRITE:
+        struct gfs3_compound_write_req  write_req;
+case GFS3_COMPOUND_FLUSH:
+        struct gfs3_flush_req           flush_req;
+};
+
+struct gfs3_compound_req {
+        gfs3_compound_req_op ops<>;
+};
+
+struct gfs3_compound_read_rsp {
+        struct gfs3_read_rsp rsp;
+        opaque               data<>;
+};
+
+union gfs3_compound_rsp_op switch (gfs3_compound_fop fop) {
+case GFS3_COMPOUND_LOOKUP:
+        struct gfs3_lookup_rsp          lookup_rsp;
+case GFS3_COMPOUND_OPEN:
+        struct gfs3_open_rsp            open_rsp;
+case GFS3_COMPOUND_READ:
+        struct gfs3_compound_read_rsp   read_rsp;
+case GFS3_COMPOUND_CREATE:
+        struct gfs3_create_rsp          create_rsp;
+case GFS3_COMPOUND_WRITE:
+        struct gfs3_write_rsp           write_rsp;
+case GFS3_COMPOUND_FLUSH:
+        struct gf_common_rsp            flush_rsp;
+};
+
+struct gfs3_compound_rsp {
+        int    op_ret;
+        int    op_errno;
+        gfs3_compound_rsp_op ops<>;
+};
+
+
+struct gfs3_bulkstat_entry {
+        opaque gfid[16];
+        string path<>;
+};
+
+struct gfs3_bulkstat_req {
+        gfs3_bulkstat_entry entries<>;
+};
+
+struct gfs3_bulkstat_rsp_entry {
+        int            op_errno;
+        struct gf_iatt stat;
+};
+
+struct gfs3_bulkstat_rsp {
+        int    op_ret;
+        int    op_errno;
+        gfs3_bulkstat_rsp_entry entries<>;
+};
+
+struct gfs3_fallocate_req {
+        opaque gfid[16];
+        hyper  fd;
+        unsigned int flags;
+        unsigned hyper offset;
+        unsigned hyper size;
+};
+
+struct gfs3_fallocate_rsp {
+        int    op_ret;
+        int    op_errno;
+        struct gf_iatt statpre;
+        struct gf_iatt statpost;
+};
+
+struct gfs3_discard_req {
+        opaque gfid[16];
+        hyper  fd;
+        unsigned hyper offset;
+        unsigned hyper size;
+};
+
+struct gfs3_discard_rsp {
+        int    op_ret;
+        int    op_errno;
+        struct gf_iatt statpre;
+        struct gf_iatt statpost;
+};
+
+struct gfs3_zerofill_req {
+        opaque gfid[16];
+        hyper  fd;
+        unsigned hyper offset;
+        unsigned hyper size;
+};
+
+struct gfs3_zerofill_rsp {
+        int    op_ret;
+        int    op_errno;
+        struct gf_iatt statpre;
+        struct gf_iatt statpost;
+};
+
+struct gfs3_seek_req {
+        opaque gfid[16];
+        hyper  fd;
+        unsigned hyper offset;
+        int    what;
+};
+
+struct gfs3_seek_rsp {
+        int    op_ret;
+        int    op_errno;
+        unsigned hyper offset;
+};
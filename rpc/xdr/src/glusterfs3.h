@@ -54,6 +54,10 @@
 
 #define GF_O_LARGEFILE     0100000
 
+/* fd number of a compound sub-fop which works on the fd opened by an
+   earlier OPEN/CREATE of the same compound */
+#define GF_COMPOUND_LINKED_FD   -2
+
 #define XLATE_BIT(from, to, bit)    do {                \
                 if (from & bit)                         \
                         to = to | GF_##bit;             \
@@ -43,6 +43,7 @@
 #include "common-utils.h"
 #include "compat-errno.h"
 #include "compat.h"
+#include "bulkstat.h"
 
 /**
  * Common algorithm for inode read calls:
@@ -285,6 +286,49 @@ out:
 }
 
 
+/* }}} */
+
+/* {{{ bulkstat */
+
+static xlator_t *
+afr_bulkstat_subvol (xlator_t *this, loc_t *loc)
+{
+        afr_private_t   *priv       = NULL;
+        int32_t          read_child = -1;
+
+        priv = this->private;
+
+        if (loc->inode)
+                read_child = afr_inode_get_read_ctx (this, loc->inode, NULL);
+
+        if ((read_child < 0) || (read_child >= priv->child_count)
+            || !priv->child_up[read_child])
+                read_child = afr_first_up_child (priv->child_up,
+                                                 priv->child_count);
+
+        if (read_child < 0)
+                return NULL;
+
+        return priv->children[read_child];
+}
+
+
+int32_t
+afr_bulkstat (call_frame_t *frame, xlator_t *this, loc_t *locs,
+              int32_t count)
+{
+        VALIDATE_OR_GOTO (frame, out);
+        VALIDATE_OR_GOTO (this, out);
+        VALIDATE_OR_GOTO (this->private, out);
+
+        bulkstat_wind_split (frame, this, locs, count, afr_bulkstat_subvol);
+        return 0;
+out:
+        STACK_UNWIND_STRICT (bulkstat, frame, -1, EINVAL, NULL, NULL);
+        return 0;
+}
+
+
 /* }}} */
 
 /* {{{ fstat */
@@ -415,6 +459,136 @@ out:
 
 /* }}} */
 
+/* {{{ seek */
+
+int32_t
+afr_seek_cbk (call_frame_t *frame, void *cookie, xlator_t *this,
+              int32_t op_ret, int32_t op_errno, off_t offset)
+{
+        afr_private_t   *priv           = NULL;
+        afr_local_t     *local          = NULL;
+        xlator_t        **children      = NULL;
+        int             unwind          = 1;
+        int32_t         *last_index     = NULL;
+        int32_t         next_call_child = -1;
+        int32_t         read_child      = -1;
+        int32_t         *fresh_children  = NULL;
+
+        priv     = this->private;
+        children = priv->children;
+
+        local = frame->local;
+
+        read_child = (long) cookie;
+
+        /* ENXIO is an answer, not a failure of the read child */
+        if ((op_ret == -1) && (op_errno != ENXIO)) {
+                last_index = &local->cont.seek.last_index;
+                fresh_children = local->fresh_children;
+                next_call_child = afr_next_call_child (fresh_children,
+                                                       local->child_up,
+                                                       priv->child_count,
+                                                       last_index, read_child);
+                if (next_call_child < 0)
+                        goto out;
+
+                unwind = 0;
+
+                STACK_WIND_COOKIE (frame, afr_seek_cbk,
+                                   (void *) (long) read_child,
+                                   children[next_call_child],
+                                   children[next_call_child]->fops->seek,
+                                   local->fd, local->cont.seek.offset,
+                                   local->cont.seek.what);
+        }
+
+out:
+        if (unwind) {
+                AFR_STACK_UNWIND (seek, frame, op_ret, op_errno, offset);
+        }
+
+        return 0;
+}
+
+
+int32_t
+afr_seek (call_frame_t *frame, xlator_t *this, fd_t *fd,
+          off_t offset, gf_seek_what_t what)
+{
+        afr_private_t   *priv      = NULL;
+        afr_local_t     *local     = NULL;
+        xlator_t        **children = NULL;
+        int             call_child = 0;
+        int32_t         op_ret     = -1;
+        int32_t         op_errno   = 0;
+        int32_t         read_child = 0;
+
+        VALIDATE_OR_GOTO (frame, out);
+        VALIDATE_OR_GOTO (this, out);
+        VALIDATE_OR_GOTO (fd, out);
+        VALIDATE_OR_GOTO (this->private, out);
+
+        priv     = this->private;
+        VALIDATE_OR_GOTO (priv->children, out);
+
+        children = priv->children;
+
+        VALIDATE_OR_GOTO (fd->inode, out);
+
+        ALLOC_OR_GOTO (local, afr_local_t, out);
+        frame->local = local;
+
+        op_ret = AFR_LOCAL_INIT (local, priv);
+        if (op_ret < 0) {
+                op_errno = -op_ret;
+                goto out;
+        }
+
+        local->fresh_children = afr_children_create (priv->child_count);
+        if (!local->fresh_children) {
+                op_errno = ENOMEM;
+                goto out;
+        }
+
+        read_child = afr_inode_get_read_ctx (this, fd->inode,
+                                             local->fresh_children);
+
+        op_ret = afr_get_call_child (this, local->child_up, read_child,
+                                     local->fresh_children,
+                                     &call_child,
+                                     &local->cont.seek.last_index);
+        if (op_ret < 0) {
+                op_errno = -op_ret;
+                op_ret = -1;
+                goto out;
+        }
+
+        local->fd = fd_ref (fd);
+        local->cont.seek.offset = offset;
+        local->cont.seek.what   = what;
+
+        op_ret = afr_open_fd_fix (frame, this, _gf_false);
+        if (op_ret) {
+                op_errno = -op_ret;
+                op_ret = -1;
+                goto out;
+        }
+        STACK_WIND_COOKIE (frame, afr_seek_cbk, (void *) (long) call_child,
+                           children[call_child],
+                           children[call_child]->fops->seek,
+                           fd, offset, what);
+
+        op_ret = 0;
+out:
+        if (op_ret == -1) {
+                AFR_STACK_UNWIND (seek, frame, op_ret, op_errno, 0);
+        }
+
+        return 0;
+}
+
+/* }}} */
+
 /* {{{ readlink */
 
 int32_t
@@ -28,10 +28,18 @@ int32_t
 afr_stat (call_frame_t *frame, xlator_t *this,
 	  loc_t *loc);
 
+int32_t
+afr_bulkstat (call_frame_t *frame, xlator_t *this,
+              loc_t *locs, int32_t count);
+
 int32_t
 afr_fstat (call_frame_t *frame, xlator_t *this,
 	   fd_t *fd);
 
+int32_t
+afr_seek (call_frame_t *frame, xlator_t *this, fd_t *fd,
+          off_t offset, gf_seek_what_t what);
+
 int32_t
 afr_readlink (call_frame_t *frame, xlator_t *this,
 	      loc_t *loc, size_t size);
@@ -678,6 +678,204 @@ sh_diff_checksum (call_frame_t *loop_frame, xlator_t *this)
         return 0;
 }
 
+static int
+sh_full_punch_cbk (call_frame_t *loop_frame, void *cookie, xlator_t *this,
+                   int32_t op_ret, int32_t op_errno, struct iatt *prebuf,
+                   struct iatt *postbuf)
+{
+        afr_private_t               *priv        = NULL;
+        afr_local_t                 *loop_local  = NULL;
+        afr_self_heal_t             *loop_sh     = NULL;
+        call_frame_t                *sh_frame    = NULL;
+        afr_local_t                 *sh_local    = NULL;
+        afr_self_heal_t             *sh          = NULL;
+        int                         call_count   = 0;
+        int                         child_index  = 0;
+
+        priv       = this->private;
+        loop_local = loop_frame->local;
+        loop_sh    = &loop_local->self_heal;
+        sh_frame   = loop_sh->sh_frame;
+        sh_local   = sh_frame->local;
+        sh         = &sh_local->self_heal;
+
+        child_index = (long) cookie;
+
+        if (op_ret == -1) {
+                gf_log (this->name, GF_LOG_DEBUG,
+                        "punching a hole at offset %"PRId64" of %s failed "
+                        "on subvolume %s (%s), copying the block",
+                        loop_sh->offset, loop_local->loc.path,
+                        priv->children[child_index]->name,
+                        strerror (op_errno));
+                loop_sh->punch_failed = _gf_true;
+        }
+
+        call_count = afr_frame_return (loop_frame);
+
+        if (call_count == 0) {
+                /* a hole spanning several blocks is not read back: its
+                   blocks would read as zeroes, which are not written to
+                   the sinks of a sparse file either */
+                if (loop_sh->punch_failed
+                    && (loop_sh->block_size == sh->block_size))
+                        sh_loop_read (loop_frame, this);
+                else
+                        sh_loop_return (sh_frame, this, loop_frame, 0, 0);
+        }
+
+        return 0;
+}
+
+
+/* the block is a hole on the source: deallocate it on the sinks instead of
+   reading and comparing zeroes */
+static int
+sh_full_punch_sinks (call_frame_t *loop_frame, xlator_t *this)
+{
+        afr_private_t           *priv         = NULL;
+        afr_local_t             *loop_local   = NULL;
+        afr_self_heal_t         *loop_sh      = NULL;
+        int                     call_count    = 0;
+        int                     i             = 0;
+
+        priv         = this->private;
+        loop_local   = loop_frame->local;
+        loop_sh      = &loop_local->self_heal;
+
+        call_count = sh_number_of_writes_needed (loop_sh->write_needed,
+                                                 priv->child_count);
+        GF_ASSERT (call_count > 0);
+        loop_local->call_count = call_count;
+
+        gf_log (this->name, GF_LOG_TRACE, "hole at offset %"PRId64" of %s "
+                "(%"PRId64" bytes)", loop_sh->offset, loop_local->loc.path,
+                (int64_t) loop_sh->block_size);
+
+        for (i = 0; i < priv->child_count; i++) {
+                if (!loop_sh->write_needed[i])
+                        continue;
+                STACK_WIND_COOKIE (loop_frame, sh_full_punch_cbk,
+                                   (void *) (long) i,
+                                   priv->children[i],
+                                   priv->children[i]->fops->discard,
+                                   loop_sh->healing_fd, loop_sh->offset,
+                                   loop_sh->block_size);
+
+                if (!--call_count)
+                        break;
+        }
+
+        return 0;
+}
+
+
+/* the hole goes on past the block: a loop of its own locks all of it,
+   takes over from this one and discards it on the sinks in one go */
+static int
+sh_full_punch_hole (call_frame_t *loop_frame, xlator_t *this, off_t hole_end)
+{
+        afr_private_t           *priv           = NULL;
+        afr_local_t             *loop_local     = NULL;
+        afr_self_heal_t         *loop_sh        = NULL;
+        call_frame_t            *sh_frame       = NULL;
+        afr_local_t             *sh_local       = NULL;
+        afr_self_heal_t         *sh             = NULL;
+        call_frame_t            *hole_frame     = NULL;
+        afr_local_t             *hole_local     = NULL;
+        afr_self_heal_t         *hole_sh        = NULL;
+        int                     ret             = 0;
+
+        priv       = this->private;
+        loop_local = loop_frame->local;
+        loop_sh    = &loop_local->self_heal;
+        sh_frame   = loop_sh->sh_frame;
+        sh_local   = sh_frame->local;
+        sh         = &sh_local->self_heal;
+
+        ret = sh_loop_frame_create (sh_frame, this, loop_frame, &hole_frame);
+        if (ret) {
+                sh->op_failed = 1;
+                sh_loop_finish (loop_frame, this);
+                sh_loop_return (sh_frame, this, hole_frame, -1, ENOMEM);
+                return 0;
+        }
+
+        hole_local = hole_frame->local;
+        hole_sh    = &hole_local->self_heal;
+
+        hole_sh->offset     = loop_sh->offset;
+        hole_sh->block_size = hole_end - loop_sh->offset;
+        memcpy (hole_sh->write_needed, loop_sh->write_needed,
+                priv->child_count * sizeof (*hole_sh->write_needed));
+        hole_sh->sh_data_algo_start = sh_full_punch_sinks;
+
+        afr_sh_data_lock (hole_frame, this, hole_sh->offset,
+                          hole_sh->block_size, sh_loop_lock_success,
+                          sh_loop_lock_failure);
+        return 0;
+}
+
+
+static int
+sh_full_seek_cbk (call_frame_t *loop_frame, void *cookie, xlator_t *this,
+                  int32_t op_ret, int32_t op_errno, off_t offset)
+{
+        afr_local_t             *loop_local   = NULL;
+        afr_self_heal_t         *loop_sh      = NULL;
+        call_frame_t            *sh_frame     = NULL;
+        afr_local_t             *sh_local     = NULL;
+        afr_self_heal_t         *sh           = NULL;
+        afr_sh_algo_private_t   *sh_priv      = NULL;
+        off_t                   block_end     = 0;
+        off_t                   hole_end      = 0;
+
+        loop_local   = loop_frame->local;
+        loop_sh      = &loop_local->self_heal;
+        sh_frame     = loop_sh->sh_frame;
+        sh_local     = sh_frame->local;
+        sh           = &sh_local->self_heal;
+        sh_priv      = sh->private;
+
+        block_end = loop_sh->offset + loop_sh->block_size;
+
+        /* the source has no data before the returned offset (ENXIO: before
+           the end of the file); any other failure just means reading the
+           block */
+        if (op_ret == 0) {
+                hole_end = offset - (offset % loop_sh->block_size);
+        } else if (op_errno == ENXIO) {
+                hole_end = max (sh->file_size, block_end);
+        } else {
+                sh_loop_read (loop_frame, this);
+                return 0;
+        }
+
+        if (hole_end < block_end) {
+                sh_loop_read (loop_frame, this);
+                return 0;
+        }
+
+        /* the blocks after this one are taken from the loop driver unless
+           a loop was already started for them */
+        LOCK (&sh_priv->lock);
+        {
+                if ((hole_end > block_end) && (sh_priv->offset == block_end))
+                        sh_priv->offset = hole_end;
+                else
+                        hole_end = block_end;
+        }
+        UNLOCK (&sh_priv->lock);
+
+        if (hole_end == block_end)
+                sh_full_punch_sinks (loop_frame, this);
+        else
+                sh_full_punch_hole (loop_frame, this, hole_end);
+
+        return 0;
+}
+
+
 static int
 sh_full_read_write_to_sinks (call_frame_t *loop_frame, xlator_t *this)
 {
@@ -695,6 +893,19 @@ sh_full_read_write_to_sinks (call_frame_t *loop_frame, xlator_t *this)
                         continue;
                 loop_sh->write_needed[i] = 1;
         }
+
+        /* a sparse source is asked where its data is first, so its holes
+           are neither read nor sent */
+        if (loop_sh->file_has_holes) {
+                STACK_WIND_COOKIE (loop_frame, sh_full_seek_cbk,
+                                   (void *) (long) loop_sh->source,
+                                   priv->children[loop_sh->source],
+                                   priv->children[loop_sh->source]->fops->seek,
+                                   loop_sh->healing_fd, loop_sh->offset,
+                                   GF_SEEK_DATA);
+                return 0;
+        }
+
         sh_loop_read (loop_frame, this);
         return 0;
 }
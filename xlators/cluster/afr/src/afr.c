@@ -394,7 +394,9 @@ struct xlator_fops fops = {
         /* inode read */
         .access      = afr_access,
         .stat        = afr_stat,
+        .bulkstat    = afr_bulkstat,
         .fstat       = afr_fstat,
+        .seek        = afr_seek,
         .readlink    = afr_readlink,
         .getxattr    = afr_getxattr,
         .readv       = afr_readv,
@@ -403,6 +405,9 @@ struct xlator_fops fops = {
         .writev      = afr_writev,
         .truncate    = afr_truncate,
         .ftruncate   = afr_ftruncate,
+        .fallocate   = afr_fallocate,
+        .discard     = afr_discard,
+        .zerofill    = afr_zerofill,
         .setxattr    = afr_setxattr,
         .setattr     = afr_setattr,
         .fsetattr    = afr_fsetattr,
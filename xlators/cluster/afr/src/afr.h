@@ -241,6 +241,7 @@ typedef struct {
         gf_boolean_t eof_reached;
         fd_t  *healing_fd;
         int   file_has_holes;
+        gf_boolean_t punch_failed;
         blksize_t block_size;
         off_t file_size;
         off_t offset;
@@ -468,6 +469,12 @@ typedef struct _afr_local {
                         int last_index;
                 } fstat;
 
+                struct {
+                        int last_index;
+                        off_t offset;
+                        gf_seek_what_t what;
+                } seek;
+
                 struct {
                         size_t size;
                         int last_index;
@@ -535,6 +542,28 @@ typedef struct _afr_local {
                         struct iatt postbuf;
                 } ftruncate;
 
+                struct {
+                        int32_t mode;
+                        off_t offset;
+                        size_t len;
+                        struct iatt prebuf;
+                        struct iatt postbuf;
+                } fallocate;
+
+                struct {
+                        off_t offset;
+                        size_t len;
+                        struct iatt prebuf;
+                        struct iatt postbuf;
+                } discard;
+
+                struct {
+                        off_t offset;
+                        size_t len;
+                        struct iatt prebuf;
+                        struct iatt postbuf;
+                } zerofill;
+
                 struct {
                         struct iatt in_buf;
                         int32_t valid;
@@ -0,0 +1,341 @@
+/*
+  Copyright (c) 2010-2011 Gluster, Inc. <http://www.gluster.com>
+  This file is part of GlusterFS.
+
+  GlusterFS is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published
+  by the Free Software Foundation; either version 3 of the License,
+  or (at your option) any later version.
+
+  GlusterFS is distributed in the hope that it will be useful, but
+  WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see
+  <http://www.gnu.org/licenses/>.
+*/
+
+
+#ifndef _CONFIG_H
+#define _CONFIG_H
+#include "config.h"
+#endif
+
+#include "glusterfs.h"
+#include "xlator.h"
+#include "dht-common.h"
+#include "hashfn.h"
+#include "bloom.h"
+
+/*
+ * With lookup-unhashed, a name missing on its hashed subvolume is looked
+ * up on all the others. Each brick can return a bloom filter of the names
+ * in a directory: those are fetched in the background, kept for
+ * lookup-bloom-timeout seconds, and the subvolumes whose filter does not
+ * have the name are left out of the broadcast, or the broadcast is not
+ * sent at all.
+ *
+ * A file created since a filter was fetched is on its hashed subvolume,
+ * or has a linkfile there, so is found before the filters are looked at;
+ * the timeout bounds for how long one that lost its linkfile is missed.
+ */
+
+
+static int
+dht_bloom_slot (uuid_t gfid)
+{
+        return SuperFastHash ((const char *)gfid, 16) % DHT_BLOOM_CACHE_SIZE;
+}
+
+
+static void
+__dht_bloom_slot_reset (dht_conf_t *conf, struct dht_bloom_cache *cache)
+{
+        int i = 0;
+
+        for (i = 0; i < conf->subvolume_cnt; i++) {
+                GF_FREE (cache->blooms[i]);
+                cache->blooms[i] = NULL;
+        }
+
+        uuid_clear (cache->gfid);
+        cache->fetched  = 0;
+        cache->fetching = _gf_false;
+}
+
+
+int
+dht_bloom_fetch_cbk (call_frame_t *frame, void *cookie, xlator_t *this,
+                     int op_ret, int op_errno, dict_t *dict)
+{
+        dht_conf_t             *conf          = NULL;
+        dht_local_t            *local         = NULL;
+        call_frame_t           *prev          = NULL;
+        struct dht_bloom_cache *cache         = NULL;
+        gf_bloom_t             *bloom         = NULL;
+        data_t                 *data          = NULL;
+        int                     this_call_cnt = 0;
+        int                     i             = 0;
+
+        conf  = this->private;
+        local = frame->local;
+        prev  = cookie;
+
+        if ((op_ret != -1) && dict) {
+                data = dict_get (dict, GF_BLOOM_XATTR_KEY);
+                if (data)
+                        bloom = gf_bloom_dup (data->data, data->len);
+        }
+        if (!bloom)
+                gf_log (this->name, GF_LOG_DEBUG,
+                        "no name filter of %s from %s (%s)", local->loc.path,
+                        prev->this->name, (op_ret == -1) ?
+                        strerror (op_errno) : "invalid");
+
+        cache = &conf->bloom_cache[local->bloom.slot];
+
+        LOCK (&conf->bloom_lock);
+        {
+                if (cache->gen != local->bloom.gen)
+                        goto unlock;
+
+                for (i = 0; i < conf->subvolume_cnt; i++) {
+                        if (conf->subvolumes[i] != prev->this)
+                                continue;
+                        GF_FREE (cache->blooms[i]);
+                        cache->blooms[i] = bloom;
+                        bloom = NULL;
+                        break;
+                }
+        }
+unlock:
+        UNLOCK (&conf->bloom_lock);
+
+        GF_FREE (bloom);
+
+        this_call_cnt = dht_frame_return (frame);
+        if (!is_last_call (this_call_cnt))
+                return 0;
+
+        LOCK (&conf->bloom_lock);
+        {
+                if (cache->gen == local->bloom.gen) {
+                        cache->fetched  = time (NULL);
+                        cache->fetching = _gf_false;
+                }
+        }
+        UNLOCK (&conf->bloom_lock);
+
+        DHT_STACK_DESTROY (frame);
+
+        return 0;
+}
+
+
+/* the filters of the parent of @loc, from all the subvolumes */
+static int
+dht_bloom_fetch (call_frame_t *frame, xlator_t *this, loc_t *loc, int slot,
+                 uint64_t gen)
+{
+        dht_conf_t   *conf        = NULL;
+        call_frame_t *fetch_frame = NULL;
+        dht_local_t  *fetch_local = NULL;
+        char         *path        = NULL;
+        char         *name        = NULL;
+        int           i           = 0;
+
+        conf = this->private;
+
+        fetch_frame = copy_frame (frame);
+        if (!fetch_frame)
+                goto err;
+
+        /* the bricks keep the filters they build */
+        fetch_frame->root->uid = 0;
+        fetch_frame->root->gid = 0;
+
+        fetch_local = dht_local_init (fetch_frame, NULL, NULL,
+                                      GF_FOP_GETXATTR);
+        if (!fetch_local)
+                goto err;
+
+        path = gf_strdup (loc->path);
+        if (!path)
+                goto err;
+
+        name = strrchr (path, '/');
+        if (name == path)
+                name[1] = '\0';
+        else
+                name[0] = '\0';
+
+        fetch_local->loc.path  = path;
+        fetch_local->loc.name  = strrchr (path, '/') + 1;
+        fetch_local->loc.inode = inode_ref (loc->parent);
+
+        fetch_local->bloom.slot = slot;
+        fetch_local->bloom.gen  = gen;
+        fetch_local->call_cnt   = conf->subvolume_cnt;
+
+        for (i = 0; i < conf->subvolume_cnt; i++) {
+                STACK_WIND (fetch_frame, dht_bloom_fetch_cbk,
+                            conf->subvolumes[i],
+                            conf->subvolumes[i]->fops->getxattr,
+                            &fetch_local->loc, GF_BLOOM_XATTR_KEY);
+        }
+
+        return 0;
+err:
+        if (fetch_frame)
+                DHT_STACK_DESTROY (fetch_frame);
+
+        LOCK (&conf->bloom_lock);
+        {
+                if (conf->bloom_cache[slot].gen == gen)
+                        conf->bloom_cache[slot].fetching = _gf_false;
+        }
+        UNLOCK (&conf->bloom_lock);
+
+        return -1;
+}
+
+
+/* lookup-everywhere of a name missing on its hashed subvolume, sent only
+   to the subvolumes that may have it */
+int
+dht_lookup_unhashed (call_frame_t *frame, xlator_t *this, loc_t *loc)
+{
+        dht_conf_t             *conf     = NULL;
+        dht_local_t            *local    = NULL;
+        struct dht_bloom_cache *cache    = NULL;
+        gf_boolean_t           *maybe    = NULL;
+        gf_boolean_t            fresh    = _gf_false;
+        gf_boolean_t            fetch    = _gf_false;
+        uint64_t                gen      = 0;
+        time_t                  now      = 0;
+        int                     slot     = 0;
+        int                     call_cnt = 0;
+        int                     i        = 0;
+
+        conf  = this->private;
+        local = frame->local;
+
+        if (!conf->lookup_bloom || !conf->bloom_cache || !loc->parent ||
+            !loc->name || !loc->path || uuid_is_null (loc->parent->gfid))
+                return dht_lookup_everywhere (frame, this, loc);
+
+        maybe = alloca (conf->subvolume_cnt * sizeof (*maybe));
+        slot  = dht_bloom_slot (loc->parent->gfid);
+        cache = &conf->bloom_cache[slot];
+        now   = time (NULL);
+
+        LOCK (&conf->bloom_lock);
+        {
+                if (uuid_compare (cache->gfid, loc->parent->gfid)) {
+                        __dht_bloom_slot_reset (conf, cache);
+                        uuid_copy (cache->gfid, loc->parent->gfid);
+                }
+
+                fresh = cache->fetched &&
+                        (now - cache->fetched < conf->lookup_bloom_timeout);
+                if (!fresh && !cache->fetching) {
+                        fetch = _gf_true;
+                        cache->fetching = _gf_true;
+                        cache->gen = gen = ++conf->bloom_gen;
+                        conf->bloom_fetches++;
+                }
+
+                if (!fresh)
+                        goto unlock;
+
+                for (i = 0; i < conf->subvolume_cnt; i++) {
+                        maybe[i] = !cache->blooms[i] ||
+                                gf_bloom_maybe (cache->blooms[i], loc->name);
+                        if (maybe[i])
+                                call_cnt++;
+                }
+
+                conf->bloom_subvols_skipped += conf->subvolume_cnt - call_cnt;
+                if (!call_cnt)
+                        conf->bloom_lookups_avoided++;
+        }
+unlock:
+        UNLOCK (&conf->bloom_lock);
+
+        if (fetch)
+                dht_bloom_fetch (frame, this, loc, slot, gen);
+
+        if (!fresh || (call_cnt == conf->subvolume_cnt))
+                return dht_lookup_everywhere (frame, this, loc);
+
+        gf_log (this->name, GF_LOG_TRACE, "%s: looking up on %d of %d "
+                "subvolumes", loc->path, call_cnt, conf->subvolume_cnt);
+
+        if (!call_cnt) {
+                dht_lookup_everywhere_done (frame, this);
+                return 0;
+        }
+
+        local->call_cnt = call_cnt;
+
+        if (!local->inode)
+                local->inode = inode_ref (loc->inode);
+
+        for (i = 0; i < conf->subvolume_cnt; i++) {
+                if (!maybe[i])
+                        continue;
+                STACK_WIND (frame, dht_lookup_everywhere_cbk,
+                            conf->subvolumes[i],
+                            conf->subvolumes[i]->fops->lookup,
+                            loc, local->xattr_req);
+        }
+
+        return 0;
+}
+
+
+int
+dht_bloom_init (xlator_t *this, dht_conf_t *conf)
+{
+        int i = 0;
+
+        LOCK_INIT (&conf->bloom_lock);
+
+        conf->bloom_cache = GF_CALLOC (DHT_BLOOM_CACHE_SIZE,
+                                       sizeof (*conf->bloom_cache),
+                                       gf_dht_mt_bloom_cache_t);
+        if (!conf->bloom_cache)
+                return -1;
+
+        for (i = 0; i < DHT_BLOOM_CACHE_SIZE; i++) {
+                conf->bloom_cache[i].blooms =
+                        GF_CALLOC (conf->subvolume_cnt, sizeof (gf_bloom_t *),
+                                   gf_dht_mt_bloom_cache_t);
+                if (!conf->bloom_cache[i].blooms)
+                        return -1;
+        }
+
+        return 0;
+}
+
+
+void
+dht_bloom_fini (xlator_t *this, dht_conf_t *conf)
+{
+        int i = 0;
+
+        if (!conf->bloom_cache)
+                return;
+
+        for (i = 0; i < DHT_BLOOM_CACHE_SIZE; i++) {
+                if (!conf->bloom_cache[i].blooms)
+                        continue;
+                __dht_bloom_slot_reset (conf, &conf->bloom_cache[i]);
+                GF_FREE (conf->bloom_cache[i].blooms);
+        }
+
+        GF_FREE (conf->bloom_cache);
+        conf->bloom_cache = NULL;
+}
@@ -31,6 +31,7 @@
 #include "dht-common.h"
 #include "defaults.h"
 #include "byte-order.h"
+#include "compound.h"
 
 #include <sys/time.h>
 #include <libgen.h>
@@ -945,7 +946,7 @@ dht_lookup_cbk (call_frame_t *frame, void *cookie, xlator_t *this,
                         " %s", loc->path, prev->this->name);
                 if (conf->search_unhashed == GF_DHT_LOOKUP_UNHASHED_ON) {
                         local->op_errno = ENOENT;
-                        dht_lookup_everywhere (frame, this, loc);
+                        dht_lookup_unhashed (frame, this, loc);
                         return 0;
                 }
                 if ((conf->search_unhashed == GF_DHT_LOOKUP_UNHASHED_AUTO) &&
@@ -954,7 +955,7 @@ dht_lookup_cbk (call_frame_t *frame, void *cookie, xlator_t *this,
                         parent_layout = (dht_layout_t *)(long)tmp_layout;
                         if (parent_layout->search_unhashed) {
                                 local->op_errno = ENOENT;
-                                dht_lookup_everywhere (frame, this, loc);
+                                dht_lookup_unhashed (frame, this, loc);
                                 return 0;
                         }
                 }
@@ -2379,6 +2380,370 @@ unwind:
 
 
 
+/* bytes an entry takes in a reply, as counted by the bricks */
+static inline size_t
+dht_dirent_size (gf_dirent_t *entry)
+{
+        return sizeof (gf_dirent_t) + strlen (entry->d_name) + 1;
+}
+
+
+static struct dht_dir_fd_ctx *
+dht_dir_fd_ctx_get (xlator_t *this, fd_t *fd, gf_boolean_t create)
+{
+        struct dht_dir_fd_ctx *ctx   = NULL;
+        uint64_t               value = 0;
+
+        LOCK (&fd->lock);
+        {
+                if (__fd_ctx_get (fd, this, &value) == 0) {
+                        ctx = (struct dht_dir_fd_ctx *)(long) value;
+                } else if (create) {
+                        ctx = GF_CALLOC (1, sizeof (*ctx),
+                                         gf_dht_mt_dir_fd_ctx_t);
+                        if (ctx) {
+                                LOCK_INIT (&ctx->lock);
+                                __fd_ctx_set (fd, this, (uint64_t)(long) ctx);
+                        }
+                }
+        }
+        UNLOCK (&fd->lock);
+
+        return ctx;
+}
+
+
+/* assumes ctx is locked */
+static void
+__dht_readdir_cache_clear (struct dht_dir_fd_ctx *ctx)
+{
+        int i = 0;
+
+        for (i = 0; i < ctx->count; i++)
+                gf_dirent_free (&ctx->chunks[i].entries);
+
+        ctx->count = 0;
+}
+
+
+/* serves @chunk from what an earlier readdirp on @fd read ahead of its
+   reply, if it read that subvolume from that offset; each chunk kept is
+   served once */
+static int
+dht_readdir_cache_take (xlator_t *this, fd_t *fd,
+                        struct dht_readdir_chunk *chunk)
+{
+        struct dht_dir_fd_ctx    *ctx    = NULL;
+        struct dht_readdir_chunk *cached = NULL;
+        int                       ret    = -1;
+        int                       i      = 0;
+
+        ctx = dht_dir_fd_ctx_get (this, fd, _gf_false);
+        if (!ctx)
+                return -1;
+
+        LOCK (&ctx->lock);
+        {
+                for (i = 0; i < ctx->count; i++) {
+                        cached = &ctx->chunks[i];
+                        if ((cached->subvol != chunk->subvol)
+                            || (cached->offset != chunk->offset))
+                                continue;
+
+                        chunk->op_ret   = cached->op_ret;
+                        chunk->op_errno = cached->op_errno;
+                        list_splice_init (&cached->entries.list,
+                                          &chunk->entries.list);
+                        cached->subvol = NULL;
+                        ret = 0;
+                        break;
+                }
+        }
+        UNLOCK (&ctx->lock);
+
+        return ret;
+}
+
+
+/* keeps the chunks of this round from @from on, in place of the ones kept
+   by the previous readdirp: a reader going on from where the reply ended
+   finds them, one which seeked elsewhere reads anew */
+static void
+dht_readdir_cache_put (xlator_t *this, fd_t *fd, dht_local_t *local,
+                       int from)
+{
+        struct dht_dir_fd_ctx    *ctx   = NULL;
+        struct dht_readdir_chunk *chunk = NULL;
+        struct dht_readdir_chunk *kept  = NULL;
+        int                       i     = 0;
+
+        ctx = dht_dir_fd_ctx_get (this, fd, (from < local->readdir.used));
+        if (!ctx)
+                return;
+
+        LOCK (&ctx->lock);
+        {
+                __dht_readdir_cache_clear (ctx);
+
+                if (ctx->chunk_cnt < local->readdir.chunk_cnt) {
+                        GF_FREE (ctx->chunks);
+                        ctx->chunk_cnt = 0;
+                        ctx->chunks = GF_CALLOC (local->readdir.chunk_cnt,
+                                                 sizeof (*ctx->chunks),
+                                                 gf_dht_mt_readdir_chunk_t);
+                        if (ctx->chunks)
+                                ctx->chunk_cnt = local->readdir.chunk_cnt;
+                }
+
+                for (i = from; ctx->chunks && (i < local->readdir.used);
+                     i++) {
+                        chunk = &local->readdir.chunks[i];
+                        if (chunk->op_ret < 0)
+                                continue;
+
+                        kept = &ctx->chunks[ctx->count++];
+                        *kept = *chunk;
+                        INIT_LIST_HEAD (&kept->entries.list);
+                        list_splice_init (&chunk->entries.list,
+                                          &kept->entries.list);
+                }
+        }
+        UNLOCK (&ctx->lock);
+}
+
+
+int32_t
+dht_releasedir (xlator_t *this, fd_t *fd)
+{
+        struct dht_dir_fd_ctx *ctx   = NULL;
+        uint64_t               value = 0;
+
+        if (fd_ctx_del (fd, this, &value) != 0)
+                return 0;
+
+        ctx = (struct dht_dir_fd_ctx *)(long) value;
+        if (!ctx)
+                return 0;
+
+        __dht_readdir_cache_clear (ctx);
+        GF_FREE (ctx->chunks);
+        LOCK_DESTROY (&ctx->lock);
+        GF_FREE (ctx);
+
+        return 0;
+}
+
+
+/* appends the entries of the chunks, in the order of the subvolumes, up to
+   the first subvolume not read to its end; then reads on from there if the
+   reply is not full enough yet. what is left of the chunks is kept in the
+   fd for the next round or readdirp */
+int
+dht_readdirp_merge (call_frame_t *frame, xlator_t *this)
+{
+        dht_local_t              *local      = NULL;
+        dht_conf_t               *conf       = NULL;
+        struct dht_readdir_chunk *chunk      = NULL;
+        gf_dirent_t              *entry      = NULL;
+        gf_dirent_t              *tmp        = NULL;
+        dht_layout_t             *layout     = NULL;
+        xlator_t                 *first_up   = NULL;
+        xlator_t                 *subvol     = NULL;
+        xlator_t                 *next_subvol = NULL;
+        off_t                     next_offset = 0;
+        size_t                    target     = 0;
+        gf_boolean_t              full       = _gf_false;
+        int                       i          = 0;
+
+        local = frame->local;
+        conf  = this->private;
+
+        if (!local->layout)
+                local->layout = dht_layout_get (this, local->fd->inode);
+        layout = local->layout;
+
+        first_up = dht_first_up_subvol (this);
+
+        for (i = 0; i < local->readdir.used; i++) {
+                chunk = &local->readdir.chunks[i];
+
+                next_subvol = chunk->subvol;
+                next_offset = chunk->offset;
+
+                list_for_each_entry_safe (entry, tmp, &chunk->entries.list,
+                                          list) {
+                        if (local->readdir.count &&
+                            (local->readdir.filled + dht_dirent_size (entry)
+                             > local->size)) {
+                                full = _gf_true;
+                                break;
+                        }
+
+                        list_del_init (&entry->list);
+                        next_offset = entry->d_off;
+
+                        if (check_is_linkfile_wo_dict (NULL, (&entry->d_stat))
+                            || (check_is_dir (NULL, (&entry->d_stat), NULL)
+                                && (chunk->subvol != first_up))) {
+                                GF_FREE (entry);
+                                continue;
+                        }
+
+                        if (layout && (conf->search_unhashed ==
+                                       GF_DHT_LOOKUP_UNHASHED_AUTO)) {
+                                subvol = dht_layout_search (this, layout,
+                                                            entry->d_name);
+                                if (!subvol || (subvol != chunk->subvol))
+                                        layout->search_unhashed++;
+                        }
+
+                        dht_itransform (this, chunk->subvol, entry->d_off,
+                                        &entry->d_off);
+
+                        list_add_tail (&entry->list,
+                                       &local->readdir.entries.list);
+                        local->readdir.filled += dht_dirent_size (entry);
+                        local->readdir.count++;
+                }
+
+                /* an error is the end of that subvolume, as when read one
+                   after the other; bricks not telling of the end with
+                   ENOENT end on an empty reply */
+                if (full || ((chunk->op_ret > 0) &&
+                             (chunk->op_errno != ENOENT)))
+                        break;
+
+                next_subvol = dht_subvol_next (this, chunk->subvol);
+                next_offset = 0;
+                if (!next_subvol)
+                        break;
+        }
+
+        /* the chunk the reply filled up in goes on from its last entry
+           taken, the ones after it from where they were read */
+        if (full) {
+                local->readdir.chunks[i].offset = next_offset;
+                dht_readdir_cache_put (this, local->fd, local, i);
+        } else {
+                dht_readdir_cache_put (this, local->fd, local, i + 1);
+        }
+
+        for (i = 0; i < local->readdir.used; i++)
+                gf_dirent_free (&local->readdir.chunks[i].entries);
+
+        target = conf->readdir_size;
+        if (target > local->size)
+                target = local->size;
+
+        if (next_subvol && !full && (!local->readdir.count ||
+                                     (local->readdir.filled < target))) {
+                dht_readdirp_fanout (frame, this, next_subvol, next_offset);
+                return 0;
+        }
+
+        DHT_STACK_UNWIND (readdirp, frame, local->readdir.count,
+                          next_subvol ? 0 : ENOENT, &local->readdir.entries);
+
+        return 0;
+}
+
+
+int
+dht_readdirp_fanout_cbk (call_frame_t *frame, void *cookie, xlator_t *this,
+                         int op_ret, int op_errno, gf_dirent_t *orig_entries)
+{
+        dht_local_t              *local = NULL;
+        struct dht_readdir_chunk *chunk = NULL;
+        int                       this_call_cnt = 0;
+
+        local = frame->local;
+        chunk = &local->readdir.chunks[(long) cookie];
+
+        chunk->op_ret   = op_ret;
+        chunk->op_errno = op_errno;
+        if ((op_ret > 0) && orig_entries)
+                list_splice_init (&orig_entries->list, &chunk->entries.list);
+
+        this_call_cnt = dht_frame_return (frame);
+        if (is_last_call (this_call_cnt))
+                dht_readdirp_merge (frame, this);
+
+        return 0;
+}
+
+
+/* reads @subvol from @offset and, at once, the subvolumes after it from
+   their start, except for what an earlier round kept in the fd */
+int
+dht_readdirp_fanout (call_frame_t *frame, xlator_t *this, xlator_t *subvol,
+                     off_t offset)
+{
+        dht_local_t              *local  = NULL;
+        dht_conf_t               *conf   = NULL;
+        struct dht_readdir_chunk *chunk  = NULL;
+        int                       width  = 0;
+        int                       call_cnt = 0;
+        int                       i      = 0;
+
+        local = frame->local;
+        conf  = this->private;
+
+        if (!local->readdir.chunks) {
+                width = conf->readdirp_parallel;
+                if (width < 1)
+                        width = 1;
+
+                local->readdir.chunks =
+                        GF_CALLOC (width, sizeof (*local->readdir.chunks),
+                                   gf_dht_mt_readdir_chunk_t);
+                if (!local->readdir.chunks) {
+                        DHT_STACK_UNWIND (readdirp, frame, -1, ENOMEM, NULL);
+                        return 0;
+                }
+
+                local->readdir.chunk_cnt = width;
+                for (i = 0; i < width; i++)
+                        INIT_LIST_HEAD (&local->readdir.chunks[i].entries.list);
+                INIT_LIST_HEAD (&local->readdir.entries.list);
+        }
+
+        /* all of them counted before any can return */
+        for (i = 0; subvol && (i < local->readdir.chunk_cnt); i++) {
+                chunk = &local->readdir.chunks[i];
+                chunk->subvol   = subvol;
+                chunk->offset   = i ? 0 : offset;
+                chunk->op_ret   = 0;
+                chunk->op_errno = 0;
+                chunk->cached   = (dht_readdir_cache_take (this, local->fd,
+                                                           chunk) == 0);
+                if (!chunk->cached)
+                        call_cnt++;
+
+                subvol = dht_subvol_next (this, subvol);
+        }
+        local->readdir.used = i;
+        local->call_cnt     = call_cnt;
+
+        if (!call_cnt) {
+                dht_readdirp_merge (frame, this);
+                return 0;
+        }
+
+        for (i = 0; i < local->readdir.used; i++) {
+                chunk = &local->readdir.chunks[i];
+                if (chunk->cached)
+                        continue;
+
+                STACK_WIND_COOKIE (frame, dht_readdirp_fanout_cbk,
+                                   (void *)(long) i, chunk->subvol,
+                                   chunk->subvol->fops->readdirp, local->fd,
+                                   local->size, chunk->offset);
+        }
+
+        return 0;
+}
+
+
 int
 dht_readdir_cbk (call_frame_t *frame, void *cookie, xlator_t *this,
                  int op_ret, int op_errno, gf_dirent_t *orig_entries)
@@ -2479,6 +2844,7 @@ dht_do_readdir (call_frame_t *frame, xlator_t *this, fd_t *fd, size_t size,
                 off_t yoff, int whichop)
 {
         dht_local_t  *local  = NULL;
+        dht_conf_t   *conf = NULL;
         int           op_errno = -1;
         xlator_t     *xvol = NULL;
         off_t         xoff = 0;
@@ -2488,6 +2854,8 @@ dht_do_readdir (call_frame_t *frame, xlator_t *this, fd_t *fd, size_t size,
         VALIDATE_OR_GOTO (this, err);
         VALIDATE_OR_GOTO (fd, err);
 
+        conf = this->private;
+
         local = dht_local_init (frame, NULL, NULL, whichop);
         if (!local) {
                 op_errno = ENOMEM;
@@ -2503,6 +2871,8 @@ dht_do_readdir (call_frame_t *frame, xlator_t *this, fd_t *fd, size_t size,
         if (whichop == GF_FOP_READDIR)
                 STACK_WIND (frame, dht_readdir_cbk, xvol, xvol->fops->readdir,
                             fd, size, xoff);
+        else if ((conf->readdirp_parallel > 1) || conf->readdir_size)
+                dht_readdirp_fanout (frame, this, xvol, xoff);
         else
                 STACK_WIND (frame, dht_readdirp_cbk, xvol, xvol->fops->readdirp,
                             fd, size, xoff);
@@ -3169,6 +3539,433 @@ err:
 }
 
 
+/* The subvolume a compound can be sent to whole: one holding the file
+   all of its sub-fops are about, the cached one for a known inode and the
+   hashed one for a file looked up or created by name. NULL if the compound
+   has to go through the individual fops. */
+static xlator_t *
+dht_compound_subvol (call_frame_t *frame, xlator_t *this,
+                     compound_args_t *args)
+{
+        compound_req_t *req    = NULL;
+        inode_t        *inode  = NULL;
+        xlator_t       *subvol = NULL;
+        int             i      = 0;
+
+        req   = &args->req[0];
+        if (req->loc.inode)
+                inode = req->loc.inode;
+        else if (req->fd)
+                inode = req->fd->inode;
+        if (!inode || (inode->ia_type == IA_IFDIR))
+                goto out;
+
+        for (i = 0; i < args->count; i++) {
+                req = &args->req[i];
+
+                if ((req->loc.inode && (req->loc.inode != inode))
+                    || (req->fd && (req->fd->inode != inode)))
+                        goto out;
+
+                /* only a create can come first, and a write to a file
+                   which is not new may have to reach both copies of a
+                   migration */
+                if ((req->fop == GF_FOP_CREATE) && i)
+                        goto out;
+                if ((req->fop == GF_FOP_WRITE)
+                    && (args->req[0].fop != GF_FOP_CREATE))
+                        goto out;
+        }
+
+        req    = &args->req[0];
+        subvol = dht_subvol_get_cached (this, inode);
+
+        switch (req->fop) {
+        case GF_FOP_CREATE:
+                dht_get_du_info (frame, this, &req->loc);
+                /* fall through */
+        case GF_FOP_LOOKUP:
+                if (subvol)
+                        break;
+
+                /* names carrying a subvolume key are left to dht_create */
+                if (!req->loc.name || strchr (req->loc.name, '@'))
+                        goto out;
+
+                subvol = dht_subvol_get_hashed (this, &req->loc);
+                if (subvol && (req->fop == GF_FOP_CREATE)
+                    && dht_is_subvol_filled (this, subvol))
+                        subvol = NULL;
+                break;
+        default:
+                break;
+        }
+
+out:
+        return subvol;
+}
+
+
+/* whether the compound found a link file, or the source of a completed
+   migration, instead of the data file */
+static gf_boolean_t
+dht_compound_missed (compound_args_t *args)
+{
+        compound_req_t *req = NULL;
+        compound_rsp_t *rsp = NULL;
+        int             i   = 0;
+
+        for (i = 0; i < args->done; i++) {
+                req = &args->req[i];
+                rsp = &args->rsp[i];
+
+                if (rsp->op_ret == -1) {
+                        if (rsp->op_errno == ENOENT)
+                                return _gf_true;
+                        continue;
+                }
+
+                if ((req->fop == GF_FOP_LOOKUP)
+                    && !IA_ISREG (rsp->stat.ia_type))
+                        return _gf_true;
+
+                if (IS_DHT_MIGRATION_PHASE2 (&rsp->stat))
+                        return _gf_true;
+        }
+
+        return _gf_false;
+}
+
+
+int
+dht_compound_cbk (call_frame_t *frame, void *cookie, xlator_t *this,
+                  int op_ret, int op_errno, compound_args_t *args)
+{
+        xlator_t       *subvol = NULL;
+        compound_req_t *req    = NULL;
+        compound_rsp_t *rsp    = NULL;
+        int             i      = 0;
+
+        subvol = cookie;
+
+        /* let the individual fops find the data file. A compound starting
+           with a create is never executed twice. */
+        if ((args->req[0].fop != GF_FOP_CREATE)
+            && dht_compound_missed (args)) {
+                gf_log (this->name, GF_LOG_DEBUG,
+                        "%s: compound on %s executed again as separate fops",
+                        args->req[0].loc.path ? args->req[0].loc.path : "--",
+                        subvol->name);
+                compound_args_reset (args);
+                return compound_fop_serial (frame, this, args);
+        }
+
+        for (i = 0; i < args->done; i++) {
+                req = &args->req[i];
+                rsp = &args->rsp[i];
+
+                if (rsp->op_ret == -1)
+                        continue;
+
+                if ((req->fop == GF_FOP_LOOKUP)
+                    || (req->fop == GF_FOP_CREATE)) {
+                        if (dht_layout_preset (this, subvol, rsp->inode)) {
+                                rsp->op_ret   = -1;
+                                rsp->op_errno = EINVAL;
+                                op_ret   = -1;
+                                op_errno = EINVAL;
+                        }
+                        if (req->loc.parent) {
+                                WIPE (&rsp->prestat);
+                                WIPE (&rsp->postparent);
+                        }
+                }
+
+                DHT_STRIP_PHASE1_FLAGS (&rsp->stat);
+        }
+
+        STACK_UNWIND_STRICT (compound, frame, op_ret, op_errno, args);
+
+        return 0;
+}
+
+
+/* the subvolume each lookup of a compound made only of lookups by name is
+   to go to, -1 if the compound has other sub-fops */
+static int
+dht_compound_lookup_subvols (xlator_t *this, compound_args_t *args,
+                             xlator_t **subvols)
+{
+        compound_req_t *req    = NULL;
+        xlator_t       *subvol = NULL;
+        int             i      = 0;
+
+        for (i = 0; i < args->count; i++) {
+                req = &args->req[i];
+
+                if ((req->fop != GF_FOP_LOOKUP) || !req->loc.inode
+                    || !req->loc.parent || !req->loc.name
+                    || strchr (req->loc.name, '@'))
+                        return -1;
+
+                subvol = dht_subvol_get_cached (this, req->loc.inode);
+                if (!subvol)
+                        subvol = dht_subvol_get_hashed (this, &req->loc);
+                if (!subvol)
+                        return -1;
+
+                subvols[i] = subvol;
+        }
+
+        return 0;
+}
+
+
+static int
+dht_compound_lookups_unwind (call_frame_t *frame, xlator_t *this)
+{
+        dht_local_t     *local    = NULL;
+        compound_args_t *args     = NULL;
+        int              op_ret   = 0;
+        int              op_errno = 0;
+        int              i        = 0;
+
+        local = frame->local;
+        args  = local->compound;
+
+        for (i = 0; i < args->count; i++) {
+                if (args->rsp[i].op_ret == -1) {
+                        op_ret   = -1;
+                        op_errno = args->rsp[i].op_errno;
+                        break;
+                }
+        }
+
+        args->done = args->count;
+
+        DHT_STACK_UNWIND (compound, frame, op_ret, op_errno, args);
+
+        return 0;
+}
+
+
+int
+dht_compound_redo_cbk (call_frame_t *frame, void *cookie, xlator_t *this,
+                       int op_ret, int op_errno, inode_t *inode,
+                       struct iatt *stbuf, dict_t *xattr,
+                       struct iatt *postparent)
+{
+        dht_local_t     *local = NULL;
+        compound_args_t *args  = NULL;
+        int              i     = 0;
+        int              this_call_cnt = 0;
+
+        local = frame->local;
+        args  = local->compound;
+        i     = (long) cookie;
+
+        compound_rsp_wipe (&args->rsp[i]);
+        compound_rsp_set (args, i, op_ret, op_errno, inode, stbuf, NULL,
+                          postparent, xattr, NULL, 0, NULL);
+
+        this_call_cnt = dht_frame_return (frame);
+        if (is_last_call (this_call_cnt))
+                dht_compound_lookups_unwind (frame, this);
+
+        return 0;
+}
+
+
+/* all the subvolumes replied: the lookups which found the data file are
+   done, the others are done again by dht_lookup () */
+static int
+dht_compound_lookups_done (call_frame_t *frame, xlator_t *this)
+{
+        dht_local_t     *local  = NULL;
+        compound_args_t *args   = NULL;
+        compound_rsp_t  *rsp    = NULL;
+        gf_boolean_t     redo[GF_COMPOUND_MAX_FOPS] = {0, };
+        int              count  = 0;
+        int              i      = 0;
+
+        local = frame->local;
+        args  = local->compound;
+
+        for (i = 0; i < args->count; i++) {
+                rsp = &args->rsp[i];
+
+                if ((rsp->op_ret == -1) || !IA_ISREG (rsp->stat.ia_type)
+                    || IS_DHT_MIGRATION_PHASE2 (&rsp->stat)
+                    || dht_layout_preset (this, local->compound_subvols[i],
+                                          rsp->inode)) {
+                        redo[i] = _gf_true;
+                        count++;
+                        continue;
+                }
+
+                WIPE (&rsp->postparent);
+                DHT_STRIP_PHASE1_FLAGS (&rsp->stat);
+        }
+
+        if (!count)
+                return dht_compound_lookups_unwind (frame, this);
+
+        local->call_cnt = count;
+
+        for (i = 0; i < args->count; i++) {
+                if (!redo[i])
+                        continue;
+
+                gf_log (this->name, GF_LOG_DEBUG,
+                        "%s: lookup of a compound on %s done again",
+                        args->req[i].loc.path,
+                        local->compound_subvols[i]->name);
+
+                STACK_WIND_COOKIE (frame, dht_compound_redo_cbk,
+                                   (void *)(long) i, this, this->fops->lookup,
+                                   &args->req[i].loc, args->req[i].xattr);
+        }
+
+        return 0;
+}
+
+
+int
+dht_compound_lookups_cbk (call_frame_t *frame, void *cookie, xlator_t *this,
+                          int op_ret, int op_errno, compound_args_t *sub)
+{
+        dht_local_t     *local  = NULL;
+        compound_args_t *args   = NULL;
+        xlator_t        *subvol = NULL;
+        int              i      = 0;
+        int              j      = 0;
+        int              this_call_cnt = 0;
+
+        local  = frame->local;
+        args   = local->compound;
+        subvol = cookie;
+
+        /* the lookups after a failure were not executed, dht_lookup ()
+           will do them */
+        for (i = 0; i < args->count; i++) {
+                if (local->compound_subvols[i] != subvol)
+                        continue;
+
+                if (j < sub->done) {
+                        args->rsp[i] = sub->rsp[j];
+                        memset (&sub->rsp[j], 0, sizeof (sub->rsp[j]));
+                } else {
+                        args->rsp[i].op_ret   = -1;
+                        args->rsp[i].op_errno = EAGAIN;
+                }
+                j++;
+        }
+
+        compound_args_destroy (sub);
+
+        this_call_cnt = dht_frame_return (frame);
+        if (is_last_call (this_call_cnt))
+                dht_compound_lookups_done (frame, this);
+
+        return 0;
+}
+
+
+/* wind the lookups of @args as one compound for every subvolume they are
+   on, -1 if the compound is not made of lookups */
+static int
+dht_compound_lookups (call_frame_t *frame, xlator_t *this,
+                      compound_args_t *args)
+{
+        dht_local_t     *local   = NULL;
+        xlator_t        *subvols[GF_COMPOUND_MAX_FOPS] = {0, };
+        compound_args_t *subs[GF_COMPOUND_MAX_FOPS]    = {0, };
+        compound_req_t  *req     = NULL;
+        int              count   = 0;
+        int              i       = 0;
+        int              j       = 0;
+        int              ret     = -1;
+
+        local = dht_local_init (frame, NULL, NULL, GF_FOP_COMPOUND);
+        if (!local)
+                goto out;
+
+        local->compound = args;
+
+        ret = dht_compound_lookup_subvols (this, args,
+                                           local->compound_subvols);
+        if (ret)
+                goto out;
+
+        /* build all of them before winding any, the first reply may come
+           back before the next one is wound */
+        for (i = 0; i < args->count; i++) {
+                req = &args->req[i];
+
+                for (j = 0; j < count; j++)
+                        if (subvols[j] == local->compound_subvols[i])
+                                break;
+
+                if (j == count) {
+                        subs[j] = compound_args_new ();
+                        if (!subs[j]) {
+                                ret = -1;
+                                goto out;
+                        }
+                        subvols[j] = local->compound_subvols[i];
+                        count++;
+                }
+
+                ret = compound_lookup (subs[j], &req->loc, req->xattr);
+                if (ret < 0)
+                        goto out;
+        }
+
+        local->call_cnt = count;
+
+        for (j = 0; j < count; j++) {
+                STACK_WIND_COOKIE (frame, dht_compound_lookups_cbk,
+                                   subvols[j], subvols[j],
+                                   subvols[j]->fops->compound, subs[j]);
+        }
+
+        return 0;
+
+out:
+        for (j = 0; j < count; j++)
+                compound_args_destroy (subs[j]);
+
+        if (local) {
+                frame->local = NULL;
+                dht_local_wipe (this, local);
+        }
+
+        return -1;
+}
+
+
+int
+dht_compound (call_frame_t *frame, xlator_t *this, compound_args_t *args)
+{
+        xlator_t *subvol = NULL;
+
+        if (args && args->count)
+                subvol = dht_compound_subvol (frame, this, args);
+
+        if (!subvol && args && (args->count > 1)
+            && (dht_compound_lookups (frame, this, args) == 0))
+                return 0;
+
+        if (!subvol)
+                return compound_fop_serial (frame, this, args);
+
+        STACK_WIND_COOKIE (frame, dht_compound_cbk, subvol, subvol,
+                           subvol->fops->compound, args);
+
+        return 0;
+}
+
+
 int
 dht_mkdir_selfheal_cbk (call_frame_t *frame, void *cookie,
                         xlator_t *this,
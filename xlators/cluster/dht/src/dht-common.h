@@ -25,6 +25,8 @@
 #include "dht-mem-types.h"
 #include "libxlator.h"
 #include "syncop.h"
+#include "bloom.h"
+#include "compound.h"
 
 #ifndef _DHT_H
 #define _DHT_H
@@ -70,6 +72,25 @@ typedef enum {
         DHT_HASH_TYPE_DM,
 } dht_hashfn_type_t;
 
+/* what one subvolume returned to a readdirp sent to several at once */
+struct dht_readdir_chunk {
+        xlator_t            *subvol;
+        off_t                offset;
+        int                  op_ret;
+        int                  op_errno;
+        char                 cached;    /* served from the fd ctx */
+        gf_dirent_t          entries;
+};
+
+/* the chunks a readdirp read ahead of what its reply could take, kept in
+   the directory fd for the next readdirp to go on from */
+struct dht_dir_fd_ctx {
+        gf_lock_t                 lock;
+        struct dht_readdir_chunk *chunks;
+        int                       chunk_cnt;
+        int                       count;
+};
+
 /* rebalance related */
 struct dht_rebalance_ {
         xlator_t            *from_subvol;
@@ -163,6 +184,26 @@ struct dht_local {
         glusterfs_fop_t      fop;
 
         struct dht_rebalance_ rebalance;
+
+        /* readdirp sent to several subvolumes at once */
+        struct {
+                struct dht_readdir_chunk *chunks;
+                int                       chunk_cnt;
+                int                       used;    /* in this round */
+                gf_dirent_t               entries; /* merged so far */
+                int                       count;
+                size_t                    filled;
+        } readdir;
+
+        /* lookups of a compound split by subvolume */
+        compound_args_t         *compound;
+        xlator_t                *compound_subvols[GF_COMPOUND_MAX_FOPS];
+
+        /* name filters being fetched into a slot of the cache */
+        struct {
+                int                       slot;
+                uint64_t                  gen;
+        } bloom;
 };
 typedef struct dht_local dht_local_t;
 
@@ -175,6 +216,15 @@ struct dht_du {
 };
 typedef struct dht_du dht_du_t;
 
+/* name filters of a directory, one per subvolume */
+struct dht_bloom_cache {
+        uuid_t        gfid;
+        uint64_t      gen;      /* of the fetch filling it */
+        time_t        fetched;
+        gf_boolean_t  fetching;
+        gf_bloom_t  **blooms;   /* NULL: the subvolume may have any name */
+};
+
 struct dht_conf {
         gf_lock_t      subvolume_lock;
         int            subvolume_cnt;
@@ -196,6 +246,8 @@ struct dht_conf {
         void          *private;     /* Can be used by wrapper xlators over
                                        dht */
         gf_boolean_t   use_readdirp;
+        int32_t        readdirp_parallel; /* subvolumes read at once */
+        uint64_t       readdir_size;      /* bytes to gather per reply */
         char           vol_uuid[UUID_SIZE + 1];
         gf_boolean_t   assert_no_child_down;
         time_t        *subvol_up_time;
@@ -206,6 +258,25 @@ struct dht_conf {
 
 	struct syncenv *env; /* The env pointer to the rebalance synctask */
 
+        /* data migration: blocks in flight per file, and its throttles */
+        int32_t        rebalance_depth;
+        uint64_t       rebalance_bw_limit;    /* bytes per second, 0: none */
+        uint32_t       rebalance_latency_max; /* msec per block, 0: none */
+        gf_lock_t      rebalance_lock;
+        struct timeval rebalance_bw_start;
+        uint64_t       rebalance_bw_bytes;
+
+        /* name filters of the bricks, to skip subvolumes in lookups of
+           names missing on their hashed subvolume */
+        gf_boolean_t   lookup_bloom;
+        uint32_t       lookup_bloom_timeout;
+        gf_lock_t      bloom_lock;
+        struct dht_bloom_cache *bloom_cache;
+        uint64_t       bloom_gen;
+        uint64_t       bloom_fetches;
+        uint64_t       bloom_lookups_avoided;
+        uint64_t       bloom_subvols_skipped;
+
         /* to keep track of nodes which are decomissioned */
         xlator_t     **decommissioned_bricks;
 };
@@ -231,6 +302,13 @@ typedef struct dht_disk_layout dht_disk_layout_t;
 
 #define is_last_call(cnt) (cnt == 0)
 
+#define DHT_REBALANCE_DEPTH_DEFAULT 4
+#define DHT_REBALANCE_DEPTH_MAX     64
+
+#define DHT_READDIRP_PARALLEL_MAX   64
+
+#define DHT_BLOOM_CACHE_SIZE        512
+
 #define DHT_MIGRATION_IN_PROGRESS 1
 #define DHT_MIGRATION_COMPLETED   2
 
@@ -340,6 +418,12 @@ int dht_linkfile_create (call_frame_t    *frame, fop_mknod_cbk_t linkfile_cbk,
                          xlator_t        *tovol, xlator_t *fromvol, loc_t *loc);
 int                                       dht_lookup_directory (call_frame_t *frame, xlator_t *this, loc_t *loc);
 int                                       dht_lookup_everywhere (call_frame_t *frame, xlator_t *this, loc_t *loc);
+int dht_lookup_everywhere_cbk (call_frame_t *frame, void *cookie,
+                               xlator_t *this, int32_t op_ret,
+                               int32_t op_errno, inode_t *inode,
+                               struct iatt *buf, dict_t *xattr,
+                               struct iatt *postparent);
+int dht_lookup_everywhere_done (call_frame_t *frame, xlator_t *this);
 int
 dht_selfheal_directory (call_frame_t     *frame, dht_selfheal_dir_cbk_t cbk,
                         loc_t            *loc, dht_layout_t *layout);
@@ -361,6 +445,10 @@ gf_boolean_t dht_is_subvol_filled (xlator_t *this, xlator_t *subvol);
 xlator_t *dht_free_disk_available_subvol (xlator_t *this, xlator_t *subvol);
 int       dht_get_du_info_for_subvol (xlator_t *this, int subvol_idx);
 
+int dht_lookup_unhashed (call_frame_t *frame, xlator_t *this, loc_t *loc);
+int dht_bloom_init (xlator_t *this, dht_conf_t *conf);
+void dht_bloom_fini (xlator_t *this, dht_conf_t *conf);
+
 int dht_layout_preset (xlator_t *this, xlator_t *subvol, inode_t *inode);
 int           dht_layout_set (xlator_t *this, inode_t *inode, dht_layout_t *layout);
 void          dht_layout_unref (xlator_t *this, dht_layout_t *layout);
@@ -402,6 +490,15 @@ int32_t dht_stat (call_frame_t *frame,
                   xlator_t *this,
                   loc_t    *loc);
 
+int32_t dht_bulkstat (call_frame_t *frame,
+                      xlator_t *this,
+                      loc_t    *locs,
+                      int32_t   count);
+
+int32_t dht_compound (call_frame_t *frame,
+                      xlator_t *this,
+                      compound_args_t *args);
+
 int32_t dht_fstat (call_frame_t *frame,
                    xlator_t *this,
                    fd_t     *fd);
@@ -416,6 +513,31 @@ int32_t dht_ftruncate (call_frame_t *frame,
                        fd_t     *fd,
                        off_t     offset);
 
+int32_t dht_seek (call_frame_t *frame,
+                  xlator_t *this,
+                  fd_t     *fd,
+                  off_t     offset,
+                  gf_seek_what_t what);
+
+int32_t dht_fallocate (call_frame_t *frame,
+                       xlator_t *this,
+                       fd_t     *fd,
+                       int32_t   mode,
+                       off_t     offset,
+                       size_t    len);
+
+int32_t dht_discard (call_frame_t *frame,
+                     xlator_t *this,
+                     fd_t     *fd,
+                     off_t     offset,
+                     size_t    len);
+
+int32_t dht_zerofill (call_frame_t *frame,
+                      xlator_t *this,
+                      fd_t     *fd,
+                      off_t     offset,
+                      size_t    len);
+
 int32_t dht_access (call_frame_t *frame,
                     xlator_t *this,
                     loc_t    *loc,
@@ -557,6 +679,9 @@ int32_t dht_readdirp (call_frame_t *frame,
                       fd_t     *fd,
                       size_t    size, off_t off);
 
+int dht_readdirp_fanout (call_frame_t *frame, xlator_t *this,
+                         xlator_t *subvol, off_t offset);
+
 int32_t dht_xattrop (call_frame_t           *frame,
                      xlator_t           *this,
                      loc_t              *loc,
@@ -570,6 +695,7 @@ int32_t dht_fxattrop (call_frame_t *frame,
                       dict_t             *dict);
 
 int32_t dht_forget (xlator_t *this, inode_t *inode);
+int32_t dht_releasedir (xlator_t *this, fd_t *fd);
 int32_t dht_setattr (call_frame_t  *frame, xlator_t *this, loc_t *loc,
                      struct iatt   *stbuf, int32_t valid);
 int32_t dht_fsetattr (call_frame_t *frame, xlator_t *this, fd_t *fd,
@@ -172,6 +172,8 @@ out:
 void
 dht_local_wipe (xlator_t *this, dht_local_t *local)
 {
+        int i = 0;
+
         if (!local)
                 return;
 
@@ -229,6 +231,13 @@ dht_local_wipe (xlator_t *this, dht_local_t *local)
         if (local->rebalance.iobref)
                 iobref_unref (local->rebalance.iobref);
 
+        if (local->readdir.chunks) {
+                for (i = 0; i < local->readdir.chunk_cnt; i++)
+                        gf_dirent_free (&local->readdir.chunks[i].entries);
+                GF_FREE (local->readdir.chunks);
+                gf_dirent_free (&local->readdir.entries);
+        }
+
         GF_FREE (local);
 }
 
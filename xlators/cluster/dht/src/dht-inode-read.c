@@ -23,6 +23,7 @@
 #endif
 
 #include "dht-common.h"
+#include "bulkstat.h"
 
 int dht_access2 (xlator_t *this, call_frame_t *frame, int ret);
 int dht_readv2 (xlator_t *this, call_frame_t *frame, int ret);
@@ -31,6 +32,7 @@ int dht_open2 (xlator_t *this, call_frame_t *frame, int ret);
 int dht_flush2 (xlator_t *this, call_frame_t *frame, int ret);
 int dht_lk2 (xlator_t *this, call_frame_t *frame, int ret);
 int dht_fsync2 (xlator_t *this, call_frame_t *frame, int ret);
+int dht_seek2 (xlator_t *this, call_frame_t *frame, int ret);
 
 int
 dht_open_cbk (call_frame_t *frame, void *cookie, xlator_t *this,
@@ -325,6 +327,33 @@ err:
 }
 
 
+/* only files have all their attributes on one subvolume */
+static xlator_t *
+dht_bulkstat_subvol (xlator_t *this, loc_t *loc)
+{
+        if (!loc->inode || !IA_ISREG (loc->inode->ia_type))
+                return NULL;
+
+        return dht_subvol_get_cached (this, loc->inode);
+}
+
+
+int
+dht_bulkstat (call_frame_t *frame, xlator_t *this, loc_t *locs,
+              int32_t count)
+{
+        VALIDATE_OR_GOTO (frame, err);
+        VALIDATE_OR_GOTO (this, err);
+        VALIDATE_OR_GOTO (locs, err);
+
+        bulkstat_wind_split (frame, this, locs, count, dht_bulkstat_subvol);
+        return 0;
+err:
+        STACK_UNWIND_STRICT (bulkstat, frame, -1, EINVAL, NULL, NULL);
+        return 0;
+}
+
+
 int
 dht_fstat (call_frame_t *frame, xlator_t *this, fd_t *fd)
 {
@@ -500,6 +529,116 @@ err:
         return 0;
 }
 
+int
+dht_seek_cbk (call_frame_t *frame, void *cookie, xlator_t *this,
+              int op_ret, int op_errno, off_t offset)
+{
+        dht_local_t *local      = NULL;
+        int          ret        = 0;
+
+        local = frame->local;
+        if (!local) {
+                op_ret = -1;
+                op_errno = EINVAL;
+                goto out;
+        }
+
+        /* This is already second try, no need for re-check */
+        if (local->call_cnt != 1)
+                goto out;
+
+        /* seek returns no iatt to carry the migration flags, only a source
+           already gone says the file moved */
+        if ((op_ret == -1) && (op_errno == ENOENT)) {
+                ret = fd_ctx_get (local->fd, this, NULL);
+                if (ret) {
+                        local->rebalance.target_op_fn = dht_seek2;
+                        ret = dht_rebalance_complete_check (this, frame);
+                } else {
+                        dht_seek2 (this, frame, 0);
+                }
+                if (!ret)
+                        return 0;
+        }
+
+out:
+        DHT_STACK_UNWIND (seek, frame, op_ret, op_errno, offset);
+
+        return 0;
+}
+
+int
+dht_seek2 (xlator_t *this, call_frame_t *frame, int op_ret)
+{
+        dht_local_t *local  = NULL;
+        xlator_t    *subvol = NULL;
+        int          op_errno = EINVAL;
+
+        local = frame->local;
+        if (!local)
+                goto out;
+
+        op_errno = local->op_errno;
+        if (op_ret == -1)
+                goto out;
+
+        local->call_cnt = 2;
+        subvol = local->cached_subvol;
+
+        STACK_WIND (frame, dht_seek_cbk, subvol, subvol->fops->seek,
+                    local->fd, local->rebalance.offset,
+                    local->rebalance.flags);
+
+        return 0;
+
+out:
+        DHT_STACK_UNWIND (seek, frame, -1, op_errno, 0);
+        return 0;
+}
+
+int
+dht_seek (call_frame_t *frame, xlator_t *this, fd_t *fd, off_t off,
+          gf_seek_what_t what)
+{
+        xlator_t     *subvol = NULL;
+        int           op_errno = -1;
+        dht_local_t  *local = NULL;
+
+        VALIDATE_OR_GOTO (frame, err);
+        VALIDATE_OR_GOTO (this, err);
+        VALIDATE_OR_GOTO (fd, err);
+
+        local = dht_local_init (frame, NULL, fd, GF_FOP_SEEK);
+        if (!local) {
+                op_errno = ENOMEM;
+                goto err;
+        }
+
+        subvol = local->cached_subvol;
+        if (!subvol) {
+                gf_log (this->name, GF_LOG_DEBUG,
+                        "no cached subvolume for fd=%p", fd);
+                op_errno = EINVAL;
+                goto err;
+        }
+
+        local->rebalance.offset = off;
+        local->rebalance.flags  = what;
+        local->call_cnt = 1;
+
+        STACK_WIND (frame, dht_seek_cbk,
+                    subvol, subvol->fops->seek,
+                    fd, off, what);
+
+        return 0;
+
+err:
+        op_errno = (op_errno == -1) ? errno : op_errno;
+        DHT_STACK_UNWIND (seek, frame, -1, op_errno, 0);
+
+        return 0;
+}
+
 int
 dht_access_cbk (call_frame_t *frame, void *cookie, xlator_t *this,
                 int op_ret, int op_errno)
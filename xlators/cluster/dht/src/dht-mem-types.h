@@ -37,6 +37,10 @@ enum gf_dht_mem_types_ {
         gf_switch_mt_switch_struct,
         gf_dht_mt_subvol_time,
         gf_dht_mt_loc_t,
+        gf_dht_mt_copy_block_t,
+        gf_dht_mt_readdir_chunk_t,
+        gf_dht_mt_dir_fd_ctx_t,
+        gf_dht_mt_bloom_cache_t,
         gf_dht_mt_end
 };
 #endif
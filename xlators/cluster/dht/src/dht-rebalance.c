@@ -24,10 +24,12 @@
 #endif
 
 #include "dht-common.h"
+#include "timer.h"
 
 #define GF_DISK_SECTOR_SIZE             512
 #define DHT_REBALANCE_PID               4242 /* Change it if required */
 #define DHT_REBALANCE_BLKSIZE           (128 * 1024)
+#define DHT_REBALANCE_SLEEP_MIN         (1000 * 1000) /* a timer tick */
 #define DHT_MIGRATE_EVEN_IF_LINK_EXISTS 1
 
 static int
@@ -247,21 +249,20 @@ out:
 }
 
 static inline int
-__dht_rebalance_migrate_data (xlator_t *from, xlator_t *to, fd_t *src, fd_t *dst,
-                             uint64_t ia_size, int hole_exists)
+__dht_rebalance_copy_range (xlator_t *from, xlator_t *to, fd_t *src,
+                            fd_t *dst, off_t offset, uint64_t end,
+                            int hole_exists)
 {
         int            ret    = 0;
         int            count  = 0;
-        off_t          offset = 0;
         struct iovec  *vector = NULL;
         struct iobref *iobref = NULL;
-        uint64_t       total  = 0;
         size_t         read_size = 0;
 
-        /* if file size is '0', no need to enter this loop */
-        while (total < ia_size) {
-                read_size = (((ia_size - total) > DHT_REBALANCE_BLKSIZE) ?
-                             DHT_REBALANCE_BLKSIZE : (ia_size - total));
+        /* if the range is empty, no need to enter this loop */
+        while (offset < end) {
+                read_size = (((end - offset) > DHT_REBALANCE_BLKSIZE) ?
+                             DHT_REBALANCE_BLKSIZE : (end - offset));
                 ret = syncop_readv (from, src, read_size,
                                     offset, &vector, &count, &iobref);
                 if (!ret || (ret < 0)) {
@@ -278,7 +279,6 @@ __dht_rebalance_migrate_data (xlator_t *from, xlator_t *to, fd_t *src, fd_t *dst
                         break;
                 }
                 offset += ret;
-                total += ret;
 
                 if (vector)
                         GF_FREE (vector);
@@ -298,6 +298,421 @@ __dht_rebalance_migrate_data (xlator_t *from, xlator_t *to, fd_t *src, fd_t *dst
         return ret;
 }
 
+/* a range of a file copied with up to 'depth' blocks read or written at
+   once, from callbacks; the synctask migrating the file only issues the
+   reads and sleeps in between */
+struct dht_copy_pipe {
+        xlator_t          *from;
+        xlator_t          *to;
+        fd_t              *src;
+        fd_t              *dst;
+        off_t              next;       /* offset of the next block to read */
+        off_t              end;
+        int                depth;
+        int                inflight;
+        int                op_errno;   /* of the first failed block */
+        uint64_t           pause_usec; /* before the next block, if slow */
+        gf_boolean_t       waiting;
+        struct synctask   *task;
+        gf_lock_t          lock;
+};
+
+struct dht_copy_block {
+        struct dht_copy_pipe *pipe;
+        off_t                 offset;
+        size_t                size;
+        struct timeval        start;
+};
+
+
+/* a sleep of the migrating synctask; the timer event is freed by its own
+   callback, whichever of the callback and the sleeper gets it first */
+struct dht_rebalance_alarm {
+        struct synctask   *task;
+        gf_timer_t        *timer;
+        gf_boolean_t       fired;
+        gf_lock_t          lock;
+};
+
+
+static void
+dht_rebalance_wake (void *data)
+{
+        struct dht_rebalance_alarm *alarm = NULL;
+        struct synctask            *task  = NULL;
+        gf_timer_t                 *timer = NULL;
+
+        alarm = data;
+
+        LOCK (&alarm->lock);
+        {
+                alarm->fired = _gf_true;
+                timer = alarm->timer;
+                task  = alarm->task;
+        }
+        UNLOCK (&alarm->lock);
+
+        /* once woken, the task may return and alarm be gone */
+        if (timer)
+                gf_timer_call_cancel (THIS->ctx, timer);
+        synctask_wake (task);
+}
+
+
+/* sleeps the migrating synctask, leaving the sync environment to the
+   other files */
+static void
+dht_rebalance_sleep (xlator_t *this, uint64_t usec)
+{
+        struct dht_rebalance_alarm alarm = {0,};
+        struct timeval             delta = {0,};
+        gf_timer_t                *timer = NULL;
+
+        alarm.task = synctask_get ();
+        LOCK_INIT (&alarm.lock);
+
+        delta.tv_sec  = usec / 1000000;
+        delta.tv_usec = usec % 1000000;
+
+        synctask_yawn (alarm.task);
+        timer = gf_timer_call_after (this->ctx, delta, dht_rebalance_wake,
+                                     &alarm);
+        if (!timer) {
+                synctask_wake (alarm.task);
+        } else {
+                LOCK (&alarm.lock);
+                {
+                        if (!alarm.fired)
+                                alarm.timer = timer;
+                }
+                UNLOCK (&alarm.lock);
+
+                /* fired already, without the event to free */
+                if (!alarm.timer)
+                        gf_timer_call_cancel (this->ctx, timer);
+        }
+        synctask_yield (alarm.task);
+
+        LOCK_DESTROY (&alarm.lock);
+}
+
+
+/* usec to wait before copying @size more bytes, to stay under the
+   bandwidth limit of all the migrations of this process. What was copied
+   is counted from the start of the window, so waits shorter than a tick of
+   the timer can be left for later blocks to make up. */
+static uint64_t
+dht_rebalance_throttle (dht_conf_t *conf, size_t size)
+{
+        struct timeval now     = {0,};
+        double         elapsed = 0;
+        double         allowed = 0;
+        uint64_t       wait    = 0;
+
+        if (!conf->rebalance_bw_limit)
+                return 0;
+
+        gettimeofday (&now, NULL);
+
+        LOCK (&conf->rebalance_lock);
+        {
+                elapsed = (now.tv_sec - conf->rebalance_bw_start.tv_sec)
+                        + (now.tv_usec - conf->rebalance_bw_start.tv_usec)
+                        / 1000000.0;
+                allowed = conf->rebalance_bw_limit * elapsed;
+
+                /* more than a second unused: idle, not to be made up
+                   with a burst */
+                if (conf->rebalance_bw_bytes + conf->rebalance_bw_limit
+                    < allowed) {
+                        conf->rebalance_bw_start = now;
+                        conf->rebalance_bw_bytes = 0;
+                        allowed = 0;
+                }
+
+                conf->rebalance_bw_bytes += size;
+                if (conf->rebalance_bw_bytes > allowed)
+                        wait = (conf->rebalance_bw_bytes - allowed) * 1000000
+                                / conf->rebalance_bw_limit;
+        }
+        UNLOCK (&conf->rebalance_lock);
+
+        return wait;
+}
+
+
+static void
+dht_copy_block_done (call_frame_t *frame, xlator_t *this, int32_t op_ret,
+                     int32_t op_errno)
+{
+        dht_conf_t            *conf   = NULL;
+        struct dht_copy_block *block  = NULL;
+        struct dht_copy_pipe  *pipe   = NULL;
+        struct synctask       *task   = NULL;
+        struct timeval         now    = {0,};
+        uint64_t               msec   = 0;
+
+        conf  = this->private;
+        block = frame->local;
+        pipe  = block->pipe;
+
+        gettimeofday (&now, NULL);
+        msec = ((now.tv_sec - block->start.tv_sec) * 1000000
+                + now.tv_usec - block->start.tv_usec) / 1000;
+
+        LOCK (&pipe->lock);
+        {
+                pipe->inflight--;
+                if ((op_ret == -1) && !pipe->op_errno)
+                        pipe->op_errno = op_errno;
+
+                /* a brick slower than the threshold gets fewer blocks at
+                   once, then pauses; a fast one gets them back slowly */
+                if (conf->rebalance_latency_max) {
+                        if (msec > conf->rebalance_latency_max) {
+                                if (pipe->depth > 1)
+                                        pipe->depth /= 2;
+                                else
+                                        pipe->pause_usec = msec * 1000;
+                        } else if ((msec <= conf->rebalance_latency_max / 2)
+                                   && (pipe->depth < conf->rebalance_depth)) {
+                                pipe->depth++;
+                        }
+                }
+
+                /* once woken, the task may return and pipe be gone */
+                if (pipe->waiting) {
+                        pipe->waiting = _gf_false;
+                        task = pipe->task;
+                }
+        }
+        UNLOCK (&pipe->lock);
+
+        STACK_DESTROY (frame->root);
+
+        if (task)
+                synctask_wake (task);
+}
+
+
+static int
+dht_copy_writev_cbk (call_frame_t *frame, void *cookie, xlator_t *this,
+                     int32_t op_ret, int32_t op_errno, struct iatt *prebuf,
+                     struct iatt *postbuf)
+{
+        dht_copy_block_done (frame, this, op_ret, op_errno);
+
+        return 0;
+}
+
+
+static int
+dht_copy_readv_cbk (call_frame_t *frame, void *cookie, xlator_t *this,
+                    int32_t op_ret, int32_t op_errno, struct iovec *vector,
+                    int32_t count, struct iatt *stbuf, struct iobref *iobref)
+{
+        struct dht_copy_block *block  = NULL;
+        struct dht_copy_pipe  *pipe   = NULL;
+
+        block = frame->local;
+        pipe  = block->pipe;
+
+        if ((op_ret == -1) || (op_ret < block->size)) {
+                /* the file got shorter: nothing to copy beyond this */
+                LOCK (&pipe->lock);
+                {
+                        if (pipe->end > block->offset + op_ret)
+                                pipe->end = block->offset + op_ret;
+                }
+                UNLOCK (&pipe->lock);
+        }
+
+        if (op_ret <= 0) {
+                dht_copy_block_done (frame, this, op_ret, op_errno);
+                return 0;
+        }
+
+        STACK_WIND (frame, dht_copy_writev_cbk, pipe->to,
+                    pipe->to->fops->writev, pipe->dst, vector, count,
+                    block->offset, iobref);
+
+        return 0;
+}
+
+
+/* waits, holding pipe->lock, for a block to complete */
+static void
+__dht_copy_pipe_wait (struct dht_copy_pipe *pipe)
+{
+        pipe->waiting = _gf_true;
+        synctask_yawn (pipe->task);
+        UNLOCK (&pipe->lock);
+
+        synctask_yield (pipe->task);
+
+        LOCK (&pipe->lock);
+}
+
+
+static inline int
+__dht_rebalance_pipe_range (xlator_t *from, xlator_t *to, fd_t *src,
+                            fd_t *dst, off_t offset, uint64_t end)
+{
+        xlator_t              *this     = NULL;
+        dht_conf_t            *conf     = NULL;
+        call_frame_t          *frame    = NULL;
+        struct dht_copy_block *block    = NULL;
+        struct dht_copy_pipe   pipe     = {0,};
+        uint64_t               wait     = 0;
+        uint64_t               pause    = 0;
+        int                    op_errno = 0;
+
+        this = THIS;
+        conf = this->private;
+
+        if (!synctask_get ())
+                return __dht_rebalance_copy_range (from, to, src, dst, offset,
+                                                   end, 0);
+
+        pipe.from  = from;
+        pipe.to    = to;
+        pipe.src   = src;
+        pipe.dst   = dst;
+        pipe.next  = offset;
+        pipe.end   = end;
+        pipe.depth = conf->rebalance_depth;
+        pipe.task  = synctask_get ();
+        LOCK_INIT (&pipe.lock);
+
+        LOCK (&pipe.lock);
+        for (;;) {
+                while ((pipe.inflight >= pipe.depth)
+                       || ((pipe.inflight > 0)
+                           && (pipe.op_errno || (pipe.next >= pipe.end))))
+                        __dht_copy_pipe_wait (&pipe);
+
+                if (pipe.op_errno || (pipe.next >= pipe.end))
+                        break;
+
+                block = GF_CALLOC (1, sizeof (*block),
+                                   gf_dht_mt_copy_block_t);
+                frame = block ? copy_frame (pipe.task->frame) : NULL;
+                if (!frame) {
+                        if (block)
+                                GF_FREE (block);
+                        pipe.op_errno = ENOMEM;
+                        continue;
+                }
+
+                block->pipe   = &pipe;
+                block->offset = pipe.next;
+                block->size   = (((pipe.end - pipe.next) >
+                                  DHT_REBALANCE_BLKSIZE) ?
+                                 DHT_REBALANCE_BLKSIZE :
+                                 (pipe.end - pipe.next));
+                frame->local  = block;
+
+                pipe.next += block->size;
+                pipe.inflight++;
+
+                pause += pipe.pause_usec;
+                pipe.pause_usec = 0;
+                UNLOCK (&pipe.lock);
+                {
+                        /* the timer ticks every second: the pauses for a
+                           slow brick add up till they are worth a tick,
+                           so that a few msec of latency cost a few msec
+                           per block on average, not a tick each */
+                        wait = dht_rebalance_throttle (conf, block->size);
+                        if (pause + wait >= DHT_REBALANCE_SLEEP_MIN) {
+                                dht_rebalance_sleep (this, pause + wait);
+                                pause = 0;
+                        }
+
+                        gettimeofday (&block->start, NULL);
+                        STACK_WIND (frame, dht_copy_readv_cbk, from,
+                                    from->fops->readv, src, block->size,
+                                    block->offset);
+                }
+                LOCK (&pipe.lock);
+        }
+        op_errno = pipe.op_errno;
+        UNLOCK (&pipe.lock);
+
+        LOCK_DESTROY (&pipe.lock);
+
+        if (op_errno) {
+                errno = op_errno;
+                return -1;
+        }
+
+        return 0;
+}
+
+
+/* copies a sparse file extent by extent, asking the source where its data
+   is; the destination is freshly created, so what is not written stays a
+   hole. Falls back to reading (and zero scanning) the rest of the file when
+   the source can not answer. */
+static inline int
+__dht_rebalance_migrate_extents (xlator_t *from, xlator_t *to, fd_t *src,
+                                 fd_t *dst, uint64_t ia_size)
+{
+        int            ret    = 0;
+        off_t          offset = 0;
+        off_t          data   = 0;
+        off_t          hole   = 0;
+
+        ret = syncop_ftruncate (to, dst, ia_size);
+        if (ret)
+                goto out;
+
+        while (offset < ia_size) {
+                ret = syncop_seek (from, src, offset, GF_SEEK_DATA, &data);
+                if (ret && (errno == ENXIO)) {
+                        /* only a hole left */
+                        ret = 0;
+                        break;
+                }
+                if (ret)
+                        goto fallback;
+
+                ret = syncop_seek (from, src, data, GF_SEEK_HOLE, &hole);
+                if (ret)
+                        goto fallback;
+
+                if (hole > ia_size)
+                        hole = ia_size;
+
+                ret = __dht_rebalance_pipe_range (from, to, src, dst, data,
+                                                  hole);
+                if (ret)
+                        goto out;
+
+                offset = hole;
+        }
+out:
+        return ret;
+
+fallback:
+        gf_log (THIS->name, GF_LOG_DEBUG, "seek on %s failed (%s), "
+                "reading from offset %"PRId64, from->name, strerror (errno),
+                offset);
+        return __dht_rebalance_copy_range (from, to, src, dst, offset,
+                                           ia_size, 1);
+}
+
+static inline int
+__dht_rebalance_migrate_data (xlator_t *from, xlator_t *to, fd_t *src, fd_t *dst,
+                              uint64_t ia_size, int hole_exists)
+{
+        if (hole_exists)
+                return __dht_rebalance_migrate_extents (from, to, src, dst,
+                                                        ia_size);
+
+        return __dht_rebalance_pipe_range (from, to, src, dst, 0, ia_size);
+}
+
 
 static inline int
 __dht_rebalance_open_src_file (xlator_t *from, xlator_t *to, loc_t *loc,
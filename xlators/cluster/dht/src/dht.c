@@ -145,6 +145,12 @@ dht_priv_dump (xlator_t *this)
                 gf_proc_dump_write("du_stats.log", "%lu", conf->du_stats->log);
         }
         gf_proc_dump_write("last_stat_fetch", "%s", ctime(&conf->last_stat_fetch.tv_sec));
+        gf_proc_dump_write("lookup_bloom", "%d", conf->lookup_bloom);
+        gf_proc_dump_write("bloom_fetches", "%"PRIu64, conf->bloom_fetches);
+        gf_proc_dump_write("bloom_lookups_avoided", "%"PRIu64,
+                           conf->bloom_lookups_avoided);
+        gf_proc_dump_write("bloom_subvols_skipped", "%"PRIu64,
+                           conf->bloom_subvols_skipped);
 
         UNLOCK(&conf->subvolume_lock);
 
@@ -216,6 +222,8 @@ fini (xlator_t *this)
                 if (conf->subvolume_status)
                         GF_FREE (conf->subvolume_status);
 
+                dht_bloom_fini (this, conf);
+
                 GF_FREE (conf);
         }
 out:
@@ -327,6 +335,20 @@ reconfigure (xlator_t *this, dict_t *options)
                           percent, out);
         GF_OPTION_RECONF ("directory-layout-spread", conf->dir_spread_cnt,
                           options, uint32, out);
+        GF_OPTION_RECONF ("readdirp-parallel", conf->readdirp_parallel,
+                          options, int32, out);
+        GF_OPTION_RECONF ("readdir-size", conf->readdir_size, options, size,
+                          out);
+        GF_OPTION_RECONF ("rebalance-pipeline-depth", conf->rebalance_depth,
+                          options, int32, out);
+        GF_OPTION_RECONF ("rebalance-bandwidth-limit",
+                          conf->rebalance_bw_limit, options, size, out);
+        GF_OPTION_RECONF ("rebalance-latency-threshold",
+                          conf->rebalance_latency_max, options, uint32, out);
+        GF_OPTION_RECONF ("lookup-bloom", conf->lookup_bloom, options, bool,
+                          out);
+        GF_OPTION_RECONF ("lookup-bloom-timeout", conf->lookup_bloom_timeout,
+                          options, uint32, out);
 
         if (dict_get_str (options, "decommissioned-bricks", &temp_str) == 0) {
                 ret = dht_parse_decommissioned_bricks (this, conf, temp_str);
@@ -380,6 +402,11 @@ init (xlator_t *this)
 
         GF_OPTION_INIT ("use-readdirp", conf->use_readdirp, bool, err);
 
+        GF_OPTION_INIT ("readdirp-parallel", conf->readdirp_parallel, int32,
+                        err);
+
+        GF_OPTION_INIT ("readdir-size", conf->readdir_size, size, err);
+
 	GF_OPTION_INIT ("min-free-disk", conf->min_free_disk, percent_or_size,
 			err);
 
@@ -393,6 +420,20 @@ init (xlator_t *this)
         GF_OPTION_INIT ("assert-no-child-down", conf->assert_no_child_down,
                         bool, err);
 
+        GF_OPTION_INIT ("rebalance-pipeline-depth", conf->rebalance_depth,
+                        int32, err);
+
+        GF_OPTION_INIT ("rebalance-bandwidth-limit", conf->rebalance_bw_limit,
+                        size, err);
+
+        GF_OPTION_INIT ("rebalance-latency-threshold",
+                        conf->rebalance_latency_max, uint32, err);
+
+        GF_OPTION_INIT ("lookup-bloom", conf->lookup_bloom, bool, err);
+
+        GF_OPTION_INIT ("lookup-bloom-timeout", conf->lookup_bloom_timeout,
+                        uint32, err);
+
         ret = dht_init_subvolumes (this, conf);
         if (ret == -1) {
                 goto err;
@@ -409,8 +450,14 @@ init (xlator_t *this)
                 goto err;
         }
 
+        ret = dht_bloom_init (this, conf);
+        if (ret == -1) {
+                goto err;
+        }
+
         LOCK_INIT (&conf->subvolume_lock);
         LOCK_INIT (&conf->layout_lock);
+        LOCK_INIT (&conf->rebalance_lock);
 
         conf->gen = 1;
 
@@ -445,6 +492,8 @@ err:
                 if (conf->du_stats)
                         GF_FREE (conf->du_stats);
 
+                dht_bloom_fini (this, conf);
+
                 GF_FREE (conf);
         }
 
@@ -474,6 +523,8 @@ struct xlator_fops fops = {
 
         /* Inode read operations */
         .stat        = dht_stat,
+        .bulkstat    = dht_bulkstat,
+        .compound    = dht_compound,
         .fstat       = dht_fstat,
         .access      = dht_access,
         .readlink    = dht_readlink,
@@ -491,6 +542,10 @@ struct xlator_fops fops = {
         .fsetxattr   = dht_fsetxattr,
         .truncate    = dht_truncate,
         .ftruncate   = dht_ftruncate,
+        .fallocate   = dht_fallocate,
+        .discard     = dht_discard,
+        .zerofill    = dht_zerofill,
+        .seek        = dht_seek,
         .writev      = dht_writev,
         .xattrop     = dht_xattrop,
         .fxattrop    = dht_fxattrop,
@@ -506,7 +561,7 @@ struct xlator_dumpops dumpops = {
 
 struct xlator_cbks cbks = {
 //      .release    = dht_release,
-//      .releasedir = dht_releasedir,
+        .releasedir = dht_releasedir,
         .forget     = dht_forget
 };
 
@@ -548,5 +603,63 @@ struct volume_options options[] = {
         { .key  = {"decommissioned-bricks"},
           .type = GF_OPTION_TYPE_ANY,
         },
+        { .key  = {"readdirp-parallel"},
+          .type = GF_OPTION_TYPE_INT,
+          .min  = 1,
+          .max  = DHT_READDIRP_PARALLEL_MAX,
+          .default_value = "1",
+          .description = "Number of subvolumes a readdirp is sent to at "
+                         "once. Entries are still returned in the order of "
+                         "the subvolumes, those of a subvolume after the "
+                         "ones of the previous are all returned."
+        },
+        { .key  = {"readdir-size"},
+          .type = GF_OPTION_TYPE_SIZET,
+          .default_value = "0",
+          .description = "Bytes of entries a readdirp gathers, from as many "
+                         "subvolumes as needed, before replying; at most "
+                         "the size asked for. 0 replies with the entries of "
+                         "the first subvolumes having some."
+        },
+        { .key  = {"rebalance-pipeline-depth"},
+          .type = GF_OPTION_TYPE_INT,
+          .min  = 1,
+          .max  = DHT_REBALANCE_DEPTH_MAX,
+          .default_value = "4",
+          .description = "Number of blocks of a migrating file being read "
+                         "or written at once."
+        },
+        { .key  = {"rebalance-bandwidth-limit"},
+          .type = GF_OPTION_TYPE_SIZET,
+          .default_value = "0",
+          .description = "Bytes per second that data migration copies at "
+                         "most, over all the files it migrates at once. 0 "
+                         "does not limit it."
+        },
+        { .key  = {"rebalance-latency-threshold"},
+          .type = GF_OPTION_TYPE_INT,
+          .min  = 0,
+          .max  = 60000,
+          .default_value = "0",
+          .description = "Milliseconds a block of a migrating file may take "
+                         "to be read and written; slower blocks make "
+                         "migration keep fewer in flight, then pause, to "
+                         "leave the bricks to the clients. 0 disables it."
+        },
+        { .key  = {"lookup-bloom"},
+          .type = GF_OPTION_TYPE_BOOL,
+          .default_value = "off",
+          .description = "Look a name missing on its hashed subvolume up "
+                         "only on the subvolumes whose filter of the names "
+                         "in the directory may have it, instead of on all."
+        },
+        { .key  = {"lookup-bloom-timeout"},
+          .type = GF_OPTION_TYPE_INT,
+          .min  = 1,
+          .max  = 3600,
+          .default_value = "60",
+          .description = "Seconds the name filters of a directory are used "
+                         "for before they are fetched again."
+        },
         { .key  = {NULL} },
 };
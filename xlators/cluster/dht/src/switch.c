@@ -924,6 +924,9 @@ init (xlator_t *this)
                 goto err;
         }
 
+        conf->rebalance_depth = DHT_REBALANCE_DEPTH_DEFAULT;
+        LOCK_INIT (&conf->rebalance_lock);
+
         /* Create 'syncop' environment */
 	conf->env = syncenv_new (0);
         if (!conf->env) {
@@ -968,9 +971,14 @@ struct xlator_fops fops = {
         .mknod       = switch_mknod,
 
         .stat        = dht_stat,
+        .bulkstat    = dht_bulkstat,
         .fstat       = dht_fstat,
         .truncate    = dht_truncate,
         .ftruncate   = dht_ftruncate,
+        .fallocate   = dht_fallocate,
+        .discard     = dht_discard,
+        .zerofill    = dht_zerofill,
+        .seek        = dht_seek,
         .access      = dht_access,
         .readlink    = dht_readlink,
         .setxattr    = dht_setxattr,
@@ -1004,6 +1012,7 @@ struct xlator_fops fops = {
 
 
 struct xlator_cbks cbks = {
+        .releasedir = dht_releasedir,
         .forget     = dht_forget
 };
 
@@ -3257,6 +3257,16 @@ out:
         return 0;
 }
 
+/* the size of a striped file is only known after asking every stripe,
+   which defeats the purpose of a batched stat */
+int32_t
+stripe_bulkstat (call_frame_t *frame, xlator_t *this, loc_t *locs,
+                 int32_t count)
+{
+        STACK_UNWIND_STRICT (bulkstat, frame, -1, ENOTSUP, NULL, NULL);
+        return 0;
+}
+
 int32_t
 stripe_fstat (call_frame_t *frame,
               xlator_t *this,
@@ -3899,6 +3909,292 @@ err:
 }
 
 
+/* fallocate, discard and zerofill act on a range of the file, which is
+ * split at the stripe boundaries like a write: each stripe-sized chunk goes
+ * to the child holding it, so no child allocates or zeroes the blocks of
+ * another. A discard is the exception: the blocks of the other children are
+ * holes in a child's file already, so each child gets the range from its
+ * first to its last block in one call. Returns the number of replies still
+ * awaited, 0 on the last one.
+ */
+static int32_t
+stripe_fallocate_reply (call_frame_t *frame, void *cookie, xlator_t *this,
+                        int32_t op_ret, int32_t op_errno, struct iatt *prebuf,
+                        struct iatt *postbuf)
+{
+        int32_t         callcnt = 0;
+        stripe_local_t *local = NULL;
+        call_frame_t   *prev = NULL;
+
+        prev  = cookie;
+        local = frame->local;
+
+        LOCK (&frame->lock);
+        {
+                callcnt = --local->call_count;
+
+                if (op_ret == -1) {
+                        gf_log (this->name, GF_LOG_DEBUG,
+                                "%s returned error %s",
+                                prev->this->name, strerror (op_errno));
+                        local->op_errno = op_errno;
+                        local->failed = 1;
+                }
+
+                if (op_ret == 0) {
+                        if (local->op_ret == -1) {
+                                local->op_ret   = 0;
+                                local->pre_buf  = *prebuf;
+                                local->post_buf = *postbuf;
+                        }
+
+                        if (local->prebuf_size < prebuf->ia_size)
+                                local->prebuf_size = prebuf->ia_size;
+
+                        if (local->postbuf_size < postbuf->ia_size)
+                                local->postbuf_size = postbuf->ia_size;
+                }
+        }
+        UNLOCK (&frame->lock);
+
+        if (!callcnt) {
+                if (local->failed)
+                        local->op_ret = -1;
+
+                if (local->op_ret != -1) {
+                        local->pre_buf.ia_size  = local->prebuf_size;
+                        local->post_buf.ia_size = local->postbuf_size;
+                }
+        }
+
+        return callcnt;
+}
+
+
+int32_t
+stripe_fallocate_cbk (call_frame_t *frame, void *cookie, xlator_t *this,
+                      int32_t op_ret, int32_t op_errno, struct iatt *prebuf,
+                      struct iatt *postbuf)
+{
+        stripe_local_t *local = NULL;
+
+        local = frame->local;
+
+        if (!stripe_fallocate_reply (frame, cookie, this, op_ret, op_errno,
+                                     prebuf, postbuf))
+                STRIPE_STACK_UNWIND (fallocate, frame, local->op_ret,
+                                     local->op_errno, &local->pre_buf,
+                                     &local->post_buf);
+        return 0;
+}
+
+
+int32_t
+stripe_discard_cbk (call_frame_t *frame, void *cookie, xlator_t *this,
+                    int32_t op_ret, int32_t op_errno, struct iatt *prebuf,
+                    struct iatt *postbuf)
+{
+        stripe_local_t *local = NULL;
+
+        local = frame->local;
+
+        if (!stripe_fallocate_reply (frame, cookie, this, op_ret, op_errno,
+                                     prebuf, postbuf))
+                STRIPE_STACK_UNWIND (discard, frame, local->op_ret,
+                                     local->op_errno, &local->pre_buf,
+                                     &local->post_buf);
+        return 0;
+}
+
+
+int32_t
+stripe_zerofill_cbk (call_frame_t *frame, void *cookie, xlator_t *this,
+                     int32_t op_ret, int32_t op_errno, struct iatt *prebuf,
+                     struct iatt *postbuf)
+{
+        stripe_local_t *local = NULL;
+
+        local = frame->local;
+
+        if (!stripe_fallocate_reply (frame, cookie, this, op_ret, op_errno,
+                                     prebuf, postbuf))
+                STRIPE_STACK_UNWIND (zerofill, frame, local->op_ret,
+                                     local->op_errno, &local->pre_buf,
+                                     &local->post_buf);
+        return 0;
+}
+
+
+/* winds one chunk per stripe block of [offset, offset + len), or one per
+   child for a discard; returns -errno without winding anything on
+   failure */
+static int32_t
+stripe_fallocate_wind (call_frame_t *frame, xlator_t *this,
+                       glusterfs_fop_t fop, fd_t *fd, int32_t mode,
+                       off_t offset, size_t len)
+{
+        stripe_local_t   *local = NULL;
+        stripe_fd_ctx_t  *fctx = NULL;
+        xlator_t         *subvol = NULL;
+        uint64_t          tmp_fctx = 0;
+        uint64_t          stripe_size = 0;
+        off_t             frame_offset = offset;
+        off_t             end = offset + len;
+        size_t            frame_size = 0;
+        uint64_t          block = 0;
+        uint64_t          last_block = 0;
+        uint64_t          child_last = 0;
+        int32_t           count = 0;
+        int32_t           idx = 0;
+        int32_t           i = 0;
+
+        VALIDATE_OR_GOTO (fd, err);
+        VALIDATE_OR_GOTO (fd->inode, err);
+
+        fd_ctx_get (fd, this, &tmp_fctx);
+        if (!tmp_fctx)
+                return -EBADFD;
+
+        fctx = (stripe_fd_ctx_t *)(long)tmp_fctx;
+        stripe_size = fctx->stripe_size;
+
+        if (!stripe_size) {
+                gf_log (this->name, GF_LOG_DEBUG,
+                        "Wrong stripe size for the file");
+                goto err;
+        }
+
+        local = GF_CALLOC (1, sizeof (stripe_local_t),
+                           gf_stripe_mt_stripe_local_t);
+        if (!local)
+                return -ENOMEM;
+
+        local->op_ret = -1;
+
+        if ((fop == GF_FOP_DISCARD) && len) {
+                block      = offset / stripe_size;
+                last_block = (end - 1) / stripe_size;
+                count      = min (last_block - block + 1, fctx->stripe_count);
+
+                local->call_count = count;
+                frame->local = local;
+
+                /* the i-th block of the range starts the one range of its
+                   child, which ends with the last block of that child */
+                for (i = 0; i < count; i++, block++) {
+                        idx = block % fctx->stripe_count;
+                        subvol = fctx->xl_array[idx];
+                        child_last = last_block - ((last_block - block)
+                                                   % fctx->stripe_count);
+                        frame_offset = max (offset, block * stripe_size);
+                        frame_size = min (end, (child_last + 1) * stripe_size)
+                                - frame_offset;
+
+                        STACK_WIND (frame, stripe_discard_cbk, subvol,
+                                    subvol->fops->discard, fd,
+                                    frame_offset, frame_size);
+                }
+
+                return 0;
+        }
+
+        /* a zero length still gets its EINVAL from a child */
+        local->call_count = len ? ((roof (end, stripe_size)
+                                    - floor (offset, stripe_size))
+                                   / stripe_size) : 1;
+        frame->local = local;
+
+        /* local may be gone once the last chunk is wound */
+        do {
+                idx = (frame_offset / stripe_size) % fctx->stripe_count;
+                subvol = fctx->xl_array[idx];
+                frame_size = min (roof (frame_offset + 1, stripe_size),
+                                  end) - frame_offset;
+
+                switch (fop) {
+                case GF_FOP_FALLOCATE:
+                        STACK_WIND (frame, stripe_fallocate_cbk, subvol,
+                                    subvol->fops->fallocate, fd, mode,
+                                    frame_offset, frame_size);
+                        break;
+                case GF_FOP_DISCARD:
+                        STACK_WIND (frame, stripe_discard_cbk, subvol,
+                                    subvol->fops->discard, fd,
+                                    frame_offset, frame_size);
+                        break;
+                default:
+                        STACK_WIND (frame, stripe_zerofill_cbk, subvol,
+                                    subvol->fops->zerofill, fd,
+                                    frame_offset, frame_size);
+                        break;
+                }
+
+                frame_offset += frame_size;
+        } while (frame_offset < end);
+
+        return 0;
+err:
+        return -EINVAL;
+}
+
+
+int32_t
+stripe_fallocate (call_frame_t *frame, xlator_t *this, fd_t *fd,
+                  int32_t mode, off_t offset, size_t len)
+{
+        int32_t ret = 0;
+
+        ret = stripe_fallocate_wind (frame, this, GF_FOP_FALLOCATE, fd, mode,
+                                     offset, len);
+        if (ret < 0)
+                STRIPE_STACK_UNWIND (fallocate, frame, -1, -ret, NULL, NULL);
+
+        return 0;
+}
+
+
+int32_t
+stripe_discard (call_frame_t *frame, xlator_t *this, fd_t *fd,
+                off_t offset, size_t len)
+{
+        int32_t ret = 0;
+
+        ret = stripe_fallocate_wind (frame, this, GF_FOP_DISCARD, fd, 0,
+                                     offset, len);
+        if (ret < 0)
+                STRIPE_STACK_UNWIND (discard, frame, -1, -ret, NULL, NULL);
+
+        return 0;
+}
+
+
+int32_t
+stripe_zerofill (call_frame_t *frame, xlator_t *this, fd_t *fd,
+                 off_t offset, size_t len)
+{
+        int32_t ret = 0;
+
+        ret = stripe_fallocate_wind (frame, this, GF_FOP_ZEROFILL, fd, 0,
+                                     offset, len);
+        if (ret < 0)
+                STRIPE_STACK_UNWIND (zerofill, frame, -1, -ret, NULL, NULL);
+
+        return 0;
+}
+
+
+/* the subvolume files hold every block at its offset in the whole file, so
+   one subvolume's holes are mostly other subvolumes' data and no single
+   child can answer; callers fall back to reading the range */
+int32_t
+stripe_seek (call_frame_t *frame, xlator_t *this, fd_t *fd,
+             off_t offset, gf_seek_what_t what)
+{
+        STACK_UNWIND_STRICT (seek, frame, -1, EOPNOTSUPP, 0);
+        return 0;
+}
+
+
 int32_t
 stripe_release (xlator_t *this, fd_t *fd)
 {
@@ -4859,6 +5155,7 @@ out:
 
 struct xlator_fops fops = {
         .stat        = stripe_stat,
+        .bulkstat    = stripe_bulkstat,
         .unlink      = stripe_unlink,
         .rename      = stripe_rename,
         .link        = stripe_link,
@@ -4871,6 +5168,10 @@ struct xlator_fops fops = {
         .flush       = stripe_flush,
         .fsync       = stripe_fsync,
         .ftruncate   = stripe_ftruncate,
+        .fallocate   = stripe_fallocate,
+        .discard     = stripe_discard,
+        .zerofill    = stripe_zerofill,
+        .seek        = stripe_seek,
         .fstat       = stripe_fstat,
         .mkdir       = stripe_mkdir,
         .rmdir       = stripe_rmdir,
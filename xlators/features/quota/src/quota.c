@@ -1973,6 +1973,26 @@ err:
 }
 
 
+/* the space reserved or zeroed is not accounted against the limits yet,
+   so these would let a directory grow past its limit */
+int32_t
+quota_fallocate (call_frame_t *frame, xlator_t *this, fd_t *fd, int32_t mode,
+                 off_t offset, size_t len)
+{
+        QUOTA_STACK_UNWIND (fallocate, frame, -1, EOPNOTSUPP, NULL, NULL);
+        return 0;
+}
+
+
+int32_t
+quota_zerofill (call_frame_t *frame, xlator_t *this, fd_t *fd, off_t offset,
+                size_t len)
+{
+        QUOTA_STACK_UNWIND (zerofill, frame, -1, EOPNOTSUPP, NULL, NULL);
+        return 0;
+}
+
+
 int32_t
 quota_send_dir_limit_to_cli (call_frame_t *frame, xlator_t *this,
                              inode_t *inode, const char *name)
@@ -2937,6 +2957,8 @@ struct xlator_fops fops = {
         .mkdir     = quota_mkdir,
         .truncate  = quota_truncate,
         .ftruncate = quota_ftruncate,
+        .fallocate = quota_fallocate,
+        .zerofill  = quota_zerofill,
         .unlink    = quota_unlink,
         .symlink   = quota_symlink,
         .link      = quota_link,
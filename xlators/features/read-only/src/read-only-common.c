@@ -113,6 +113,30 @@ ro_ftruncate (call_frame_t *frame, xlator_t *this, fd_t *fd, off_t offset)
 	return 0;
 }
 
+int32_t
+ro_fallocate (call_frame_t *frame, xlator_t *this, fd_t *fd, int32_t mode,
+              off_t offset, size_t len)
+{
+        STACK_UNWIND_STRICT (fallocate, frame, -1, EROFS, NULL, NULL);
+        return 0;
+}
+
+int32_t
+ro_discard (call_frame_t *frame, xlator_t *this, fd_t *fd, off_t offset,
+            size_t len)
+{
+        STACK_UNWIND_STRICT (discard, frame, -1, EROFS, NULL, NULL);
+        return 0;
+}
+
+int32_t
+ro_zerofill (call_frame_t *frame, xlator_t *this, fd_t *fd, off_t offset,
+             size_t len)
+{
+        STACK_UNWIND_STRICT (zerofill, frame, -1, EROFS, NULL, NULL);
+        return 0;
+}
+
 int
 ro_mknod (call_frame_t *frame, xlator_t *this, loc_t *loc, mode_t mode,
           dev_t rdev, dict_t *params)
@@ -67,6 +67,9 @@ struct xlator_fops fops = {
         .removexattr = ro_removexattr,
         .fsyncdir    = ro_fsyncdir,
         .ftruncate   = ro_ftruncate,
+        .fallocate   = ro_fallocate,
+        .discard     = ro_discard,
+        .zerofill    = ro_zerofill,
         .create      = ro_create,
         .setattr     = ro_setattr,
         .fsetattr    = ro_fsetattr,
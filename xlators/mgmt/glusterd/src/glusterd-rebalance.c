@@ -40,12 +40,242 @@
 #include "glusterd-op-sm.h"
 #include "glusterd-utils.h"
 #include "glusterd-store.h"
+#include "glusterd-volgen.h"
 #include "run.h"
 
 #include "syscall.h"
 #include "cli1-xdr.h"
 #include "xdr-generic.h"
 
+#define GLUSTERD_DEFRAG_MIGRATORS_DEFAULT 4
+#define GLUSTERD_DEFRAG_MIGRATORS_MAX     64
+
+struct glusterd_defrag_file {
+        struct list_head list;
+        uint64_t         size;
+        char             path[0];
+};
+
+/* asks distribute to migrate a file; -1 when the rebalance has failed */
+static int
+glusterd_defrag_migrate_file (glusterd_volinfo_t *volinfo, const char *path,
+                              uint64_t size)
+{
+        glusterd_defrag_info_t *defrag           = NULL;
+        char                    force_string[64] = {0,};
+        int                     ret              = -1;
+
+        defrag = volinfo->defrag;
+
+        if ((defrag->cmd == GF_DEFRAG_CMD_START_MIGRATE_DATA_FORCE) ||
+            (defrag->cmd == GF_DEFRAG_CMD_START_FORCE)) {
+                strcpy (force_string, "force");
+        } else {
+                strcpy (force_string, "not-force");
+        }
+
+        ret = sys_lsetxattr (path, "distribute.migrate-data",
+                             force_string, strlen (force_string), 0);
+
+        /* if errno is not ENOSPC or ENOTCONN, we can still continue
+           with rebalance process */
+        if ((ret == -1) && ((errno != ENOSPC) ||
+                            (errno != ENOTCONN)))
+                return 0;
+
+        if ((ret == -1) && (errno == ENOTCONN)) {
+                /* Most probably mount point went missing (mostly due
+                   to a brick down), say rebalance failure to user,
+                   let him restart it if everything is fine */
+                volinfo->defrag_status = GF_DEFRAG_STATUS_FAILED;
+                return -1;
+        }
+
+        if ((ret == -1) && (errno == ENOSPC)) {
+                /* rebalance process itself failed, may be
+                   remote brick went down, or write failed due to
+                   disk full etc etc.. */
+                volinfo->defrag_status = GF_DEFRAG_STATUS_FAILED;
+                return -1;
+        }
+
+        LOCK (&defrag->lock);
+        {
+                defrag->total_files += 1;
+                defrag->total_data += size;
+        }
+        UNLOCK (&defrag->lock);
+
+        return 0;
+}
+
+static void *
+glusterd_defrag_migrator (void *data)
+{
+        glusterd_volinfo_t          *volinfo = data;
+        glusterd_defrag_info_t      *defrag  = NULL;
+        struct glusterd_defrag_file *file    = NULL;
+
+        THIS = volinfo->xl;
+        defrag = volinfo->defrag;
+
+        for (;;) {
+                pthread_mutex_lock (&defrag->queue_lock);
+                {
+                        while (list_empty (&defrag->queue) &&
+                               !defrag->crawl_done)
+                                pthread_cond_wait (&defrag->queue_cond,
+                                                   &defrag->queue_lock);
+
+                        if (!list_empty (&defrag->queue)) {
+                                file = list_entry (defrag->queue.next,
+                                                   struct glusterd_defrag_file,
+                                                   list);
+                                list_del_init (&file->list);
+                                defrag->queued--;
+                                /* the crawl may wait for room */
+                                pthread_cond_broadcast (&defrag->queue_cond);
+                        }
+                }
+                pthread_mutex_unlock (&defrag->queue_lock);
+
+                if (!file)
+                        break;
+
+                /* what is left once stopped or failed is dropped */
+                if (volinfo->defrag_status ==
+                    GF_DEFRAG_STATUS_MIGRATE_DATA_STARTED)
+                        glusterd_defrag_migrate_file (volinfo, file->path,
+                                                      file->size);
+
+                GF_FREE (file);
+                file = NULL;
+        }
+
+        return NULL;
+}
+
+/* hands a file to the migrators, waiting while they have enough queued;
+   migrates it here if there are none */
+static int
+glusterd_defrag_queue_file (glusterd_volinfo_t *volinfo, const char *path,
+                            uint64_t size)
+{
+        glusterd_defrag_info_t      *defrag = NULL;
+        struct glusterd_defrag_file *file   = NULL;
+        struct timespec              wait   = {0,};
+
+        defrag = volinfo->defrag;
+
+        if (!defrag->migrators)
+                return glusterd_defrag_migrate_file (volinfo, path, size);
+
+        file = GF_CALLOC (1, sizeof (*file) + strlen (path) + 1,
+                          gf_gld_mt_defrag_file_t);
+        if (!file)
+                return glusterd_defrag_migrate_file (volinfo, path, size);
+
+        INIT_LIST_HEAD (&file->list);
+        file->size = size;
+        strcpy (file->path, path);
+
+        pthread_mutex_lock (&defrag->queue_lock);
+        {
+                while ((defrag->queued >= 2 * defrag->migrators) &&
+                       (volinfo->defrag_status ==
+                        GF_DEFRAG_STATUS_MIGRATE_DATA_STARTED)) {
+                        /* a stop does not signal, look again in a while */
+                        wait.tv_sec = time (NULL) + 1;
+                        pthread_cond_timedwait (&defrag->queue_cond,
+                                                &defrag->queue_lock, &wait);
+                }
+
+                list_add_tail (&file->list, &defrag->queue);
+                defrag->queued++;
+                pthread_cond_broadcast (&defrag->queue_cond);
+        }
+        pthread_mutex_unlock (&defrag->queue_lock);
+
+        return 0;
+}
+
+static void
+glusterd_defrag_migrators_start (glusterd_volinfo_t *volinfo)
+{
+        glusterd_defrag_info_t *defrag    = NULL;
+        char                   *value     = NULL;
+        int                     migrators = GLUSTERD_DEFRAG_MIGRATORS_DEFAULT;
+        int                     i         = 0;
+        int                     ret       = -1;
+
+        defrag = volinfo->defrag;
+
+        pthread_mutex_init (&defrag->queue_lock, NULL);
+        pthread_cond_init (&defrag->queue_cond, NULL);
+        INIT_LIST_HEAD (&defrag->queue);
+        defrag->queued     = 0;
+        defrag->crawl_done = _gf_false;
+        defrag->migrators  = 0;
+
+        ret = glusterd_volinfo_get (volinfo, "cluster.rebalance-parallel-files",
+                                    &value);
+        if (!ret && value) {
+                ret = gf_string2int (value, &migrators);
+                if (ret || (migrators < 1) ||
+                    (migrators > GLUSTERD_DEFRAG_MIGRATORS_MAX)) {
+                        gf_log ("rebalance", GF_LOG_WARNING,
+                                "invalid rebalance-parallel-files %s, "
+                                "migrating %d files at once", value,
+                                GLUSTERD_DEFRAG_MIGRATORS_DEFAULT);
+                        migrators = GLUSTERD_DEFRAG_MIGRATORS_DEFAULT;
+                }
+        }
+
+        defrag->migrator_th = GF_CALLOC (migrators, sizeof (pthread_t),
+                                         gf_gld_mt_defrag_info);
+        if (!defrag->migrator_th)
+                return;
+
+        for (i = 0; i < migrators; i++) {
+                ret = pthread_create (&defrag->migrator_th[i], NULL,
+                                      glusterd_defrag_migrator, volinfo);
+                if (ret)
+                        break;
+                defrag->migrators++;
+        }
+
+        gf_log ("rebalance", GF_LOG_INFO, "migrating %d files at once on %s",
+                defrag->migrators, volinfo->volname);
+}
+
+/* waits for the migrators to be done with what the crawl queued */
+static void
+glusterd_defrag_migrators_stop (glusterd_volinfo_t *volinfo)
+{
+        glusterd_defrag_info_t *defrag = NULL;
+        int                     i      = 0;
+
+        defrag = volinfo->defrag;
+
+        pthread_mutex_lock (&defrag->queue_lock);
+        {
+                defrag->crawl_done = _gf_true;
+                pthread_cond_broadcast (&defrag->queue_cond);
+        }
+        pthread_mutex_unlock (&defrag->queue_lock);
+
+        for (i = 0; i < defrag->migrators; i++)
+                pthread_join (defrag->migrator_th[i], NULL);
+
+        defrag->migrators = 0;
+        if (defrag->migrator_th)
+                GF_FREE (defrag->migrator_th);
+        defrag->migrator_th = NULL;
+
+        pthread_cond_destroy (&defrag->queue_cond);
+        pthread_mutex_destroy (&defrag->queue_lock);
+}
+
 /* return values - 0: success, +ve: stopped, -ve: failure */
 int
 gf_glusterd_rebalance_move_data (glusterd_volinfo_t *volinfo, const char *dir)
@@ -57,7 +287,6 @@ gf_glusterd_rebalance_move_data (glusterd_volinfo_t *volinfo, const char *dir)
         struct stat             stbuf                  = {0,};
         char                    full_path[PATH_MAX]    = {0,};
         char                    linkinfo[PATH_MAX]     = {0,};
-        char                    force_string[64]       = {0,};
 
         if (!volinfo->defrag)
                 goto out;
@@ -68,13 +297,6 @@ gf_glusterd_rebalance_move_data (glusterd_volinfo_t *volinfo, const char *dir)
         if (!fd)
                 goto out;
 
-        if ((defrag->cmd == GF_DEFRAG_CMD_START_MIGRATE_DATA_FORCE) ||
-            (defrag->cmd == GF_DEFRAG_CMD_START_FORCE)) {
-                strcpy (force_string, "force");
-        } else {
-                strcpy (force_string, "not-force");
-        }
-
         while ((entry = readdir (fd))) {
                 if (!entry)
                         break;
@@ -101,7 +323,12 @@ gf_glusterd_rebalance_move_data (glusterd_volinfo_t *volinfo, const char *dir)
                 if (S_ISDIR (stbuf.st_mode))
                         continue;
 
-                defrag->num_files_lookedup += 1;
+                LOCK (&defrag->lock);
+                {
+                        defrag->num_files_lookedup += 1;
+                        defrag->lookedup_data += stbuf.st_size;
+                }
+                UNLOCK (&defrag->lock);
 
                 /* TODO: bring in feature to support hardlink rebalance */
                 if (stbuf.st_nlink > 1)
@@ -117,37 +344,10 @@ gf_glusterd_rebalance_move_data (glusterd_volinfo_t *volinfo, const char *dir)
                 if (ret <= 0)
                         continue;
 
-                ret = sys_lsetxattr (full_path, "distribute.migrate-data",
-                                     force_string, strlen (force_string), 0);
-
-                /* if errno is not ENOSPC or ENOTCONN, we can still continue
-                   with rebalance process */
-                if ((ret == -1) && ((errno != ENOSPC) ||
-                                    (errno != ENOTCONN)))
-                        continue;
-
-                if ((ret == -1) && (errno == ENOTCONN)) {
-                        /* Most probably mount point went missing (mostly due
-                           to a brick down), say rebalance failure to user,
-                           let him restart it if everything is fine */
-                        volinfo->defrag_status = GF_DEFRAG_STATUS_FAILED;
-                        break;
-                }
-
-                if ((ret == -1) && (errno == ENOSPC)) {
-                        /* rebalance process itself failed, may be
-                           remote brick went down, or write failed due to
-                           disk full etc etc.. */
-                        volinfo->defrag_status = GF_DEFRAG_STATUS_FAILED;
+                ret = glusterd_defrag_queue_file (volinfo, full_path,
+                                                  stbuf.st_size);
+                if (ret)
                         break;
-                }
-
-                LOCK (&defrag->lock);
-                {
-                        defrag->total_files += 1;
-                        defrag->total_data += stbuf.st_size;
-                }
-                UNLOCK (&defrag->lock);
         }
         closedir (fd);
 
@@ -263,12 +463,16 @@ glusterd_defrag_start (void *data)
         glusterd_defrag_info_t *defrag  = NULL;
         int                     ret     = -1;
         struct stat             stbuf   = {0,};
+        struct statvfs          vfsbuf  = {0,};
+        struct timeval          end     = {0,};
 
         THIS = volinfo->xl;
         defrag = volinfo->defrag;
         if (!defrag)
                 goto out;
 
+        gettimeofday (&defrag->start, NULL);
+
         sleep (1);
         ret = lstat (defrag->mount, &stbuf);
         if ((ret == -1) && (errno == ENOTCONN)) {
@@ -312,8 +516,15 @@ glusterd_defrag_start (void *data)
 
                 volinfo->defrag_status = GF_DEFRAG_STATUS_MIGRATE_DATA_STARTED;
 
+                /* what the crawl has to look at, for the estimate */
+                if (!statvfs (defrag->mount, &vfsbuf))
+                        defrag->used_data = (uint64_t) vfsbuf.f_frsize *
+                                (vfsbuf.f_blocks - vfsbuf.f_bfree);
+
                 /* Step 2: Iterate over directories to move data */
+                glusterd_defrag_migrators_start (volinfo);
                 ret = gf_glusterd_rebalance_move_data (volinfo, defrag->mount);
+                glusterd_defrag_migrators_stop (volinfo);
                 if (ret < 0)
                         volinfo->defrag_status = GF_DEFRAG_STATUS_FAILED;
                 /* in both 'stopped' or 'failure' cases goto out */
@@ -336,6 +547,9 @@ glusterd_defrag_start (void *data)
 out:
         volinfo->defrag = NULL;
         if (defrag) {
+                gettimeofday (&end, NULL);
+                volinfo->rebalance_time = end.tv_sec - defrag->start.tv_sec;
+
                 gf_log ("rebalance", GF_LOG_INFO, "rebalance on %s complete",
                         defrag->mount);
 
@@ -414,10 +628,15 @@ int
 glusterd_defrag_status_get (glusterd_volinfo_t *volinfo,
                             dict_t *dict)
 {
-        int      ret    = 0;
-        uint64_t files  = 0;
-        uint64_t size   = 0;
-        uint64_t lookup = 0;
+        int            ret     = 0;
+        uint64_t       files   = 0;
+        uint64_t       size    = 0;
+        uint64_t       lookup  = 0;
+        uint64_t       looked  = 0;
+        uint64_t       used    = 0;
+        uint64_t       elapsed = 0;
+        uint64_t       eta     = 0;
+        struct timeval now     = {0,};
 
         if (!volinfo || !dict)
                 goto out;
@@ -432,12 +651,25 @@ glusterd_defrag_status_get (glusterd_volinfo_t *volinfo,
                         files  = volinfo->defrag->total_files;
                         size   = volinfo->defrag->total_data;
                         lookup = volinfo->defrag->num_files_lookedup;
+                        looked = volinfo->defrag->lookedup_data;
+                        used   = volinfo->defrag->used_data;
                 }
                 UNLOCK (&volinfo->defrag->lock);
+
+                gettimeofday (&now, NULL);
+                elapsed = now.tv_sec - volinfo->defrag->start.tv_sec;
+
+                /* the crawl goes on at the pace it went so far, over what
+                   the volume had in use when the migration started */
+                if ((volinfo->defrag_status ==
+                     GF_DEFRAG_STATUS_MIGRATE_DATA_STARTED) &&
+                    looked && (used > looked))
+                        eta = (double) elapsed * (used - looked) / looked;
         } else {
-                files  = volinfo->rebalance_files;
-                size   = volinfo->rebalance_data;
-                lookup = volinfo->lookedup_files;
+                files   = volinfo->rebalance_files;
+                size    = volinfo->rebalance_data;
+                lookup  = volinfo->lookedup_files;
+                elapsed = volinfo->rebalance_time;
         }
 
         ret = dict_set_uint64 (dict, "files", files);
@@ -455,6 +687,16 @@ glusterd_defrag_status_get (glusterd_volinfo_t *volinfo,
                 gf_log (THIS->name, GF_LOG_WARNING,
                         "failed to set lookedup file count");
 
+        ret = dict_set_uint64 (dict, "elapsed", elapsed);
+        if (ret)
+                gf_log (THIS->name, GF_LOG_WARNING,
+                        "failed to set elapsed time");
+
+        ret = dict_set_uint64 (dict, "eta", eta);
+        if (ret)
+                gf_log (THIS->name, GF_LOG_WARNING,
+                        "failed to set estimated time left");
+
         ret = dict_set_int32 (dict, "status", volinfo->defrag_status);
         if (ret)
                 gf_log (THIS->name, GF_LOG_WARNING,
@@ -1091,6 +1091,24 @@ glusterd_volume_rebalance_use_rsp_dict (dict_t *rsp_dict)
                 }
         }
 
+        ret = dict_get_uint64 (rsp_dict, "elapsed", &value);
+        if (!ret) {
+                ret = dict_set_uint64 (ctx_dict, "elapsed", value);
+                if (ret) {
+                        gf_log (THIS->name, GF_LOG_DEBUG,
+                                "failed to set elapsed time");
+                }
+        }
+
+        ret = dict_get_uint64 (rsp_dict, "eta", &value);
+        if (!ret) {
+                ret = dict_set_uint64 (ctx_dict, "eta", value);
+                if (ret) {
+                        gf_log (THIS->name, GF_LOG_DEBUG,
+                                "failed to set estimated time left");
+                }
+        }
+
         ret = dict_get_int32 (rsp_dict, "status", &value32);
         if (!ret) {
                 ret = dict_set_int32 (ctx_dict, "status", value32);
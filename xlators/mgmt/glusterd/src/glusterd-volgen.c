@@ -112,6 +112,14 @@ static struct volopt_map_entry glusterd_volopt_map[] = {
         {"cluster.lookup-unhashed",              "cluster/distribute", NULL, NULL, NO_DOC, 0    },
         {"cluster.min-free-disk",                "cluster/distribute", NULL, NULL, NO_DOC, 0    },
 	{"cluster.min-free-inodes",              "cluster/distribute", NULL, NULL, NO_DOC, 0    },
+        {"cluster.readdirp-parallel",            "cluster/distribute", "readdirp-parallel", NULL, DOC, 0},
+        {"cluster.readdir-size",                 "cluster/distribute", "readdir-size", NULL, DOC, 0},
+        {"cluster.lookup-bloom",                 "cluster/distribute", "lookup-bloom", NULL, DOC, 0},
+        {"cluster.lookup-bloom-timeout",         "cluster/distribute", "lookup-bloom-timeout", NULL, DOC, 0},
+        {"cluster.rebalance-parallel-files",     "cluster/distribute", "!rebalance-parallel-files", NULL, NO_DOC, 0},
+        {"cluster.rebalance-pipeline-depth",     "cluster/distribute", "rebalance-pipeline-depth", NULL, DOC, 0},
+        {"cluster.rebalance-bandwidth-limit",    "cluster/distribute", "rebalance-bandwidth-limit", NULL, DOC, 0},
+        {"cluster.rebalance-latency-threshold",  "cluster/distribute", "rebalance-latency-threshold", NULL, DOC, 0},
 
         {"cluster.entry-change-log",             "cluster/replicate",  NULL, NULL, NO_DOC, 0     },
         {"cluster.read-subvolume",               "cluster/replicate",  NULL, NULL, NO_DOC, 0    },
@@ -143,16 +151,37 @@ static struct volopt_map_entry glusterd_volopt_map[] = {
         {"performance.cache-min-file-size",      "performance/io-cache",      "min-file-size", NULL, DOC, 0},
         {"performance.cache-refresh-timeout",    "performance/io-cache",      "cache-timeout", NULL, DOC, 0},
         {"performance.cache-priority",           "performance/io-cache",      "priority", NULL, DOC, 0},
+        {"performance.cache-replacement-policy", "performance/io-cache",      "replacement-policy", NULL, DOC, 0},
         {"performance.cache-size",               "performance/io-cache",   NULL, NULL, NO_DOC, 0 },
         {"performance.cache-size",               "performance/quick-read", NULL, NULL, NO_DOC, 0 },
+        {"performance.cache-background-revalidate", "performance/io-cache",   "background-revalidate", NULL, DOC, 0},
+        {"performance.cache-background-revalidate", "performance/quick-read", "background-revalidate", NULL, NO_DOC, 0},
+        {"performance.quick-read-prefetch-directory", "performance/quick-read", "prefetch-directory", NULL, DOC, 0},
+        {"performance.disk-cache-dir",           "performance/disk-cache",    "cache-dir", NULL, NO_DOC, 0},
+        {"performance.disk-cache-size",          "performance/disk-cache",    "cache-size", NULL, NO_DOC, 0},
+        {"performance.disk-cache-page-size",     "performance/disk-cache",    "page-size", NULL, NO_DOC, 0},
         {"performance.flush-behind",             "performance/write-behind",      "flush-behind", NULL, DOC, 0},
 
+        {"storage.readdirp-threads",             "storage/posix",             "readdirp-threads", NULL, DOC, 0},
+        {"storage.io-engine",                    "storage/posix",             "io-engine", NULL, DOC, 0},
+        {"storage.io-depth",                     "storage/posix",             "io-depth", NULL, DOC, 0},
+        {"storage.dir-handle-cache-size",        "storage/posix",             "dir-handle-cache-size", NULL, DOC, 0},
+        {"storage.batch-fsync-delay-usec",       "storage/posix",             "batch-fsync-delay-usec", NULL, DOC, 0},
+        {"storage.batch-fsync-mode",             "storage/posix",             "batch-fsync-mode", NULL, DOC, 0},
+
         {"performance.io-thread-count",          "performance/io-threads",    "thread-count", DOC, 0},
+        {"performance.io-thread-inode-affinity", "performance/io-threads",    "inode-affinity", NULL, DOC, 0},
+        {"performance.negative-lookup-timeout",  "performance/stat-prefetch", "negative-timeout", NULL, DOC, 0},
+        {"performance.md-cache-timeout",         "performance/md-cache",      "timeout", NULL, DOC, 0},
+        {"performance.md-cache-max-inodes",      "performance/md-cache",      "max-inodes", NULL, DOC, 0},
+        {"performance.md-cache-xattrs",          "performance/md-cache",      "cache-xattrs", NULL, DOC, 0},
 
         {"performance.disk-usage-limit",         "performance/quota",   NULL, NULL, NO_DOC, 0    },
         {"performance.min-free-disk-limit",      "performance/quota",   NULL, NULL, NO_DOC, 0    },
 
         {"performance.write-behind-window-size", "performance/write-behind",  "cache-size", NULL, DOC},
+        {"performance.write-behind-total-size",  "performance/write-behind",  "total-cache-size", NULL, DOC, 0},
+        {"performance.write-behind-flush-age",   "performance/write-behind",  "flush-age", NULL, DOC, 0},
 
         {"network.frame-timeout",                "protocol/client",    NULL, NULL, NO_DOC, 0     },
         {"network.ping-timeout",                 "protocol/client",    NULL, NULL, NO_DOC, 0     },
@@ -163,11 +192,19 @@ static struct volopt_map_entry glusterd_volopt_map[] = {
 
         {"transport.keepalive",                   "protocol/server",           "transport.socket.keepalive", NULL, NO_DOC, 0},
         {"server.allow-insecure",                 "protocol/server",          "rpc-auth-allow-insecure", NULL, NO_DOC, 0},
-
+        {"server.fair-queue",                     "protocol/server",          "rpc.fair-queue", NULL, NO_DOC, 0},
+        {"server.fair-queue-inflight",            "protocol/server",          "rpc.fair-queue-inflight", NULL, NO_DOC, 0},
+        {"server.fair-queue-quantum",             "protocol/server",          "rpc.fair-queue-quantum", NULL, NO_DOC, 0},
+        {"server.client-weight",                  "protocol/server",          "rpc.client-weight", NULL, NO_DOC, 0},
+        {"server.client-iops-limit",              "protocol/server",          "rpc.client-iops-limit", NULL, NO_DOC, 0},
+        {"server.client-bw-limit",                "protocol/server",          "rpc.client-bw-limit", NULL, NO_DOC, 0},
+
+        {"performance.disk-cache",               "performance/disk-cache",    "!perf", "off", NO_DOC, 0},
         {"performance.write-behind",             "performance/write-behind",  "!perf", "on", NO_DOC, 0},
         {"performance.read-ahead",               "performance/read-ahead",    "!perf", "on", NO_DOC, 0},
         {"performance.io-cache",                 "performance/io-cache",      "!perf", "on", NO_DOC, 0},
         {"performance.quick-read",               "performance/quick-read",    "!perf", "on", NO_DOC, 0},
+        {"performance.md-cache",                 "performance/md-cache",      "!perf", "off", NO_DOC, 0},
         {VKEY_PERF_STAT_PREFETCH,                "performance/stat-prefetch", "!perf", "on", NO_DOC, 0},
         {"performance.client-io-threads",        "performance/io-threads",    "!perf", "off", NO_DOC, 0},
         {VKEY_MARKER_XTIME,                      "features/marker",           "xtime", "off", NO_DOC, OPT_FLAG_FORCE},
@@ -167,6 +167,20 @@ struct glusterd_defrag_info_ {
         struct gf_defrag_brickinfo_ *bricks; /* volinfo->brick_count */
 
         defrag_cbk_fn_t              cbk_fn;
+
+        /* files to migrate, from the crawl to the migrator threads */
+        pthread_mutex_t              queue_lock;
+        pthread_cond_t               queue_cond;
+        struct list_head             queue;
+        int                          queued;
+        gf_boolean_t                 crawl_done;
+        int                          migrators;
+        pthread_t                   *migrator_th;
+
+        /* for the rate and the estimate of the time left */
+        struct timeval               start;
+        uint64_t                     lookedup_data;
+        uint64_t                     used_data;
 };
 
 
@@ -207,6 +221,7 @@ struct glusterd_volinfo_ {
         uint64_t                rebalance_files;
         uint64_t                rebalance_data;
         uint64_t                lookedup_files;
+        uint64_t                rebalance_time;
         glusterd_defrag_info_t  *defrag;
 
         /* Replace brick status */
@@ -0,0 +1,961 @@
+/*
+  Copyright (c) 2011 Gluster, Inc. <http://www.gluster.com>
+  This file is part of GlusterFS.
+
+  GlusterFS is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published
+  by the Free Software Foundation; either version 3 of the License,
+  or (at your option) any later version.
+
+  GlusterFS is distributed in the hope that it will be useful, but
+  WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see
+  <http://www.gnu.org/licenses/>.
+*/
+
+/*
+ * the cache directory of disk-cache: in memory index of the cached pages,
+ * the worker thread writing to the cache, and the on-disk index.
+ */
+
+#ifndef _CONFIG_H
+#define _CONFIG_H
+#include "config.h"
+#endif
+
+#include <fcntl.h>
+#include <dirent.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+#include <sys/file.h>
+
+#include "disk-cache.h"
+#include "hashfn.h"
+#include "checksum.h"
+
+
+static inline uint32_t
+dc_gfid_hash (uuid_t gfid)
+{
+        return SuperFastHash ((const char *)gfid, 16);
+}
+
+
+static inline struct list_head *
+dc_file_bucket (dc_private_t *priv, uuid_t gfid)
+{
+        return &priv->files[dc_gfid_hash (gfid) % DC_FILE_BUCKETS];
+}
+
+
+static inline struct list_head *
+dc_page_bucket (dc_private_t *priv, uuid_t gfid, uint64_t index)
+{
+        uint32_t hash = 0;
+
+        hash = dc_gfid_hash (gfid) ^ (uint32_t)(index * 2654435761UL);
+
+        return &priv->pages[hash % DC_PAGE_BUCKETS];
+}
+
+
+void
+dc_data_path (dc_private_t *priv, uuid_t gfid, char *path, size_t len)
+{
+        char gfid_str[64] = {0, };
+
+        uuid_unparse (gfid, gfid_str);
+        snprintf (path, len, "%s/data/%02x/%s", priv->path, gfid[0],
+                  gfid_str);
+}
+
+
+dc_file_t *
+__dc_file_get (dc_private_t *priv, uuid_t gfid)
+{
+        dc_file_t *file = NULL;
+
+        list_for_each_entry (file, dc_file_bucket (priv, gfid), hash) {
+                if (uuid_compare (file->gfid, gfid) == 0)
+                        return file;
+        }
+
+        return NULL;
+}
+
+
+dc_file_t *
+__dc_file_new (dc_private_t *priv, uuid_t gfid)
+{
+        dc_file_t *file = NULL;
+
+        file = GF_CALLOC (1, sizeof (*file), gf_dc_mt_dc_file_t);
+        if (!file)
+                return NULL;
+
+        uuid_copy (file->gfid, gfid);
+        INIT_LIST_HEAD (&file->pages);
+        list_add (&file->hash, dc_file_bucket (priv, gfid));
+        priv->file_count++;
+
+        return file;
+}
+
+
+dc_page_t *
+__dc_page_get (dc_private_t *priv, uuid_t gfid, uint64_t index)
+{
+        dc_page_t *page = NULL;
+
+        list_for_each_entry (page, dc_page_bucket (priv, gfid, index), hash) {
+                if ((page->index == index)
+                    && (uuid_compare (page->file->gfid, gfid) == 0))
+                        return page;
+        }
+
+        return NULL;
+}
+
+
+dc_page_t *
+__dc_page_new (dc_private_t *priv, dc_file_t *file, uint64_t index)
+{
+        dc_page_t *page = NULL;
+
+        page = GF_CALLOC (1, sizeof (*page), gf_dc_mt_dc_page_t);
+        if (!page)
+                return NULL;
+
+        page->file = file;
+        page->index = index;
+        page->gen = ++priv->gen;
+        page->state = DC_PAGE_PENDING;
+        INIT_LIST_HEAD (&page->lru);
+        list_add (&page->hash, dc_page_bucket (priv, file->gfid, index));
+        list_add_tail (&page->file_list, &file->pages);
+
+        file->page_count++;
+        priv->page_count++;
+
+        return page;
+}
+
+
+void
+__dc_page_free (dc_private_t *priv, dc_page_t *page)
+{
+        list_del (&page->hash);
+        list_del (&page->lru);
+        list_del (&page->file_list);
+
+        page->file->page_count--;
+        priv->page_count--;
+
+        GF_FREE (page);
+}
+
+
+static void
+__dc_file_free (dc_private_t *priv, dc_file_t *file)
+{
+        dc_page_t *page = NULL;
+        dc_page_t *tmp  = NULL;
+
+        list_for_each_entry_safe (page, tmp, &file->pages, file_list) {
+                __dc_page_free (priv, page);
+        }
+
+        list_del (&file->hash);
+        priv->file_count--;
+
+        GF_FREE (file);
+}
+
+
+void
+dc_record_fill (dc_record_t *record, dc_record_type_t type, dc_file_t *file,
+                uint64_t index)
+{
+        memset (record, 0, sizeof (*record));
+
+        record->magic      = DC_RECORD_MAGIC;
+        record->type       = type;
+        memcpy (record->gfid, file->gfid, 16);
+        record->index      = index;
+        record->file_size  = file->size;
+        record->mtime      = file->mtime;
+        record->mtime_nsec = file->mtime_nsec;
+}
+
+
+static dc_job_t *
+dc_job_new (dc_job_type_t type)
+{
+        dc_job_t *job = NULL;
+
+        job = GF_CALLOC (1, sizeof (*job), gf_dc_mt_dc_job_t);
+        if (!job)
+                return NULL;
+
+        INIT_LIST_HEAD (&job->list);
+        job->type = type;
+
+        return job;
+}
+
+
+static void
+dc_job_free (dc_job_t *job)
+{
+        if (job->data)
+                GF_FREE (job->data);
+
+        GF_FREE (job);
+}
+
+
+int
+__dc_job_queue (dc_private_t *priv, dc_job_t *job)
+{
+        list_add_tail (&job->list, &priv->jobs);
+        priv->job_count++;
+        pthread_cond_signal (&priv->cond);
+
+        return 0;
+}
+
+
+/*
+ * __dc_file_drop - forget all the cached pages of a file, and remove its
+ *                  data file.
+ */
+void
+__dc_file_drop (dc_private_t *priv, dc_file_t *file)
+{
+        dc_job_t *job = NULL;
+
+        job = dc_job_new (DC_JOB_DROP_FILE);
+        if (job) {
+                dc_record_fill (&job->record, DC_REC_DROP_FILE, file, 0);
+                __dc_job_queue (priv, job);
+        } else {
+                gf_log (THIS->name, GF_LOG_WARNING,
+                        "cannot queue the removal of %s from the cache",
+                        uuid_utoa (file->gfid));
+        }
+
+        __dc_file_free (priv, file);
+}
+
+
+void
+__dc_page_evict (dc_private_t *priv, dc_page_t *page)
+{
+        dc_job_t *job = NULL;
+
+        priv->evictions++;
+
+        if (page->file->page_count == 1) {
+                __dc_file_drop (priv, page->file);
+                return;
+        }
+
+        job = dc_job_new (DC_JOB_EVICT);
+        if (job) {
+                dc_record_fill (&job->record, DC_REC_DROP_PAGE, page->file,
+                                page->index);
+                __dc_job_queue (priv, job);
+        }
+
+        __dc_page_free (priv, page);
+}
+
+
+/*
+ * __dc_prune - evict least recently used pages until @needed more pages
+ *              fit in cache-size.
+ */
+void
+__dc_prune (dc_private_t *priv, uint64_t needed)
+{
+        dc_page_t *page      = NULL;
+        uint64_t   max_pages = 0;
+
+        max_pages = priv->cache_size / priv->page_size;
+
+        while ((priv->page_count + needed > max_pages)
+               && !list_empty (&priv->lru)) {
+                page = list_entry (priv->lru.next, dc_page_t, lru);
+                __dc_page_evict (priv, page);
+        }
+}
+
+
+static int
+dc_index_write_header (int fd, uint64_t page_size)
+{
+        dc_index_header_t header = {0, };
+
+        header.magic = DC_INDEX_MAGIC;
+        header.version = DC_INDEX_VERSION;
+        header.page_size = page_size;
+        header.checksum = gf_rsync_weak_checksum ((char *)&header,
+                                                  offsetof (dc_index_header_t,
+                                                            checksum));
+
+        if (write (fd, &header, sizeof (header)) != sizeof (header))
+                return -1;
+
+        return 0;
+}
+
+
+static int
+dc_index_append (xlator_t *this, dc_record_t *record)
+{
+        dc_private_t *priv = NULL;
+        ssize_t       ret  = -1;
+
+        priv = this->private;
+
+        record->checksum = gf_rsync_weak_checksum ((char *)record,
+                                                   offsetof (dc_record_t,
+                                                             checksum));
+
+        ret = write (priv->index_fd, record, sizeof (*record));
+        if (ret != sizeof (*record)) {
+                gf_log (this->name, GF_LOG_WARNING,
+                        "cannot append to the cache index: %s",
+                        (ret < 0) ? strerror (errno) : "short write");
+                return -1;
+        }
+
+        priv->index_records++;
+        return 0;
+}
+
+
+/*
+ * dc_index_compact - rewrite the index with a record per cached page, in
+ *                    lru order. called by the worker, which is the only
+ *                    writer of the index.
+ */
+static void
+dc_index_compact (xlator_t *this)
+{
+        dc_private_t *priv                = NULL;
+        dc_page_t    *page                = NULL;
+        dc_record_t  *records             = NULL;
+        uint64_t      count               = 0;
+        uint64_t      i                   = 0;
+        int           fd                  = -1;
+        int           new_fd              = -1;
+        char          path[PATH_MAX]      = {0, };
+        char          tmp_path[PATH_MAX]  = {0, };
+
+        priv = this->private;
+
+        snprintf (path, sizeof (path), "%s/index", priv->path);
+        snprintf (tmp_path, sizeof (tmp_path), "%s/index.tmp", priv->path);
+
+        pthread_mutex_lock (&priv->lock);
+        {
+                records = GF_CALLOC (priv->page_count + 1, sizeof (*records),
+                                     gf_dc_mt_dc_record_t);
+                if (records) {
+                        list_for_each_entry (page, &priv->lru, lru) {
+                                dc_record_fill (&records[count], DC_REC_PAGE,
+                                                page->file, page->index);
+                                records[count].size = page->size;
+                                records[count].data_checksum = page->checksum;
+                                count++;
+                        }
+                }
+        }
+        pthread_mutex_unlock (&priv->lock);
+
+        if (!records)
+                return;
+
+        fd = open (tmp_path, O_CREAT|O_TRUNC|O_WRONLY, 0600);
+        if (fd < 0)
+                goto out;
+
+        if (dc_index_write_header (fd, priv->page_size) != 0)
+                goto out;
+
+        for (i = 0; i < count; i++) {
+                records[i].checksum =
+                        gf_rsync_weak_checksum ((char *)&records[i],
+                                                offsetof (dc_record_t,
+                                                          checksum));
+        }
+
+        if (write (fd, records, count * sizeof (*records))
+            != (ssize_t)(count * sizeof (*records)))
+                goto out;
+
+        if (fsync (fd) != 0)
+                goto out;
+
+        if (rename (tmp_path, path) != 0)
+                goto out;
+
+        new_fd = open (path, O_WRONLY|O_APPEND);
+        if (new_fd < 0)
+                goto out;
+
+        close (priv->index_fd);
+        priv->index_fd = new_fd;
+        priv->index_records = count;
+
+        gf_log (this->name, GF_LOG_DEBUG, "index compacted to %"PRIu64
+                " records", count);
+out:
+        if (new_fd < 0)
+                gf_log (this->name, GF_LOG_WARNING,
+                        "cannot compact the cache index: %s",
+                        strerror (errno));
+        if (fd >= 0)
+                close (fd);
+        GF_FREE (records);
+}
+
+
+static int
+dc_data_write (dc_private_t *priv, dc_job_t *job)
+{
+        char    path[PATH_MAX] = {0, };
+        int     fd             = -1;
+        ssize_t ret            = -1;
+
+        dc_data_path (priv, job->record.gfid, path, sizeof (path));
+
+        fd = open (path, O_CREAT|O_WRONLY, 0600);
+        if (fd < 0)
+                return -1;
+
+        ret = pwrite (fd, job->data, job->record.size,
+                      DC_PAGE_OFFSET (priv, job->record.index));
+        close (fd);
+
+        return (ret == job->record.size) ? 0 : -1;
+}
+
+
+static void
+dc_data_punch (dc_private_t *priv, dc_job_t *job)
+{
+#ifdef FALLOC_FL_PUNCH_HOLE
+        char path[PATH_MAX] = {0, };
+        int  fd             = -1;
+
+        dc_data_path (priv, job->record.gfid, path, sizeof (path));
+
+        fd = open (path, O_WRONLY);
+        if (fd < 0)
+                return;
+
+        fallocate (fd, FALLOC_FL_PUNCH_HOLE|FALLOC_FL_KEEP_SIZE,
+                   DC_PAGE_OFFSET (priv, job->record.index),
+                   priv->page_size);
+        close (fd);
+#endif
+}
+
+
+static void
+dc_job_run (xlator_t *this, dc_job_t *job)
+{
+        dc_private_t *priv           = NULL;
+        dc_page_t    *page           = NULL;
+        char          path[PATH_MAX] = {0, };
+        int           ret            = -1;
+
+        priv = this->private;
+
+        switch (job->type) {
+        case DC_JOB_WRITE:
+                job->record.data_checksum =
+                        gf_rsync_weak_checksum (job->data, job->record.size);
+
+                ret = dc_data_write (priv, job);
+                if (ret == 0)
+                        ret = dc_index_append (this, &job->record);
+                else
+                        gf_log (this->name, GF_LOG_DEBUG,
+                                "cannot write page %"PRIu64" of %s: %s",
+                                job->record.index,
+                                uuid_utoa (job->record.gfid),
+                                strerror (errno));
+
+                pthread_mutex_lock (&priv->lock);
+                {
+                        page = __dc_page_get (priv, job->record.gfid,
+                                              job->record.index);
+                        if (!page || (page->gen != job->gen))
+                                goto unlock;
+
+                        if (ret != 0) {
+                                __dc_page_free (priv, page);
+                                goto unlock;
+                        }
+
+                        page->checksum = job->record.data_checksum;
+                        page->state = DC_PAGE_READY;
+                        list_add_tail (&page->lru, &priv->lru);
+                }
+        unlock:
+                pthread_mutex_unlock (&priv->lock);
+                break;
+
+        case DC_JOB_EVICT:
+                dc_data_punch (priv, job);
+                dc_index_append (this, &job->record);
+                break;
+
+        case DC_JOB_DROP_FILE:
+                dc_data_path (priv, job->record.gfid, path, sizeof (path));
+                if ((unlink (path) != 0) && (errno != ENOENT))
+                        gf_log (this->name, GF_LOG_DEBUG,
+                                "cannot remove %s: %s", path,
+                                strerror (errno));
+                dc_index_append (this, &job->record);
+                break;
+        }
+}
+
+
+static void *
+dc_worker (void *data)
+{
+        xlator_t     *this    = NULL;
+        dc_private_t *priv    = NULL;
+        dc_job_t     *job     = NULL;
+        char          compact = 0;
+
+        this = data;
+        priv = this->private;
+        THIS = this;
+
+        for (;;) {
+                pthread_mutex_lock (&priv->lock);
+                {
+                        while (list_empty (&priv->jobs) && !priv->fini)
+                                pthread_cond_wait (&priv->cond, &priv->lock);
+
+                        job = NULL;
+                        if (!list_empty (&priv->jobs)) {
+                                job = list_entry (priv->jobs.next, dc_job_t,
+                                                  list);
+                                list_del_init (&job->list);
+                                priv->job_count--;
+                        }
+
+                        compact = (priv->index_records
+                                   > 2 * priv->page_count + DC_INDEX_SLACK);
+                }
+                pthread_mutex_unlock (&priv->lock);
+
+                if (!job)
+                        break;
+
+                dc_job_run (this, job);
+                dc_job_free (job);
+
+                if (compact)
+                        dc_index_compact (this);
+        }
+
+        return NULL;
+}
+
+
+static int
+dc_record_valid (dc_record_t *record)
+{
+        if (record->magic != DC_RECORD_MAGIC)
+                return 0;
+
+        if (record->checksum
+            != gf_rsync_weak_checksum ((char *)record,
+                                       offsetof (dc_record_t, checksum)))
+                return 0;
+
+        return ((record->type >= DC_REC_PAGE)
+                && (record->type <= DC_REC_DROP_FILE));
+}
+
+
+static void
+__dc_record_replay (dc_private_t *priv, dc_record_t *record)
+{
+        dc_file_t *file = NULL;
+        dc_page_t *page = NULL;
+
+        file = __dc_file_get (priv, record->gfid);
+
+        switch (record->type) {
+        case DC_REC_PAGE:
+                if (file && ((file->size != record->file_size)
+                             || (file->mtime != record->mtime)
+                             || (file->mtime_nsec != record->mtime_nsec))) {
+                        __dc_file_free (priv, file);
+                        file = NULL;
+                }
+
+                if (!file) {
+                        file = __dc_file_new (priv, record->gfid);
+                        if (!file)
+                                return;
+                        file->size = record->file_size;
+                        file->mtime = record->mtime;
+                        file->mtime_nsec = record->mtime_nsec;
+                }
+
+                page = __dc_page_get (priv, record->gfid, record->index);
+                if (!page)
+                        page = __dc_page_new (priv, file, record->index);
+                if (!page)
+                        return;
+
+                page->size = record->size;
+                page->checksum = record->data_checksum;
+                page->state = DC_PAGE_READY;
+                list_del (&page->lru);
+                list_add_tail (&page->lru, &priv->lru);
+                break;
+
+        case DC_REC_DROP_PAGE:
+                if (!file)
+                        return;
+                page = __dc_page_get (priv, record->gfid, record->index);
+                if (page)
+                        __dc_page_free (priv, page);
+                if (!file->page_count)
+                        __dc_file_free (priv, file);
+                break;
+
+        case DC_REC_DROP_FILE:
+                if (file)
+                        __dc_file_free (priv, file);
+                break;
+        }
+}
+
+
+/*
+ * dc_data_sweep - remove the data files which have no cached page, all of
+ *                 them if @all is set.
+ */
+static void
+dc_data_sweep (xlator_t *this, int all)
+{
+        dc_private_t  *priv           = NULL;
+        DIR           *dir            = NULL;
+        struct dirent *entry          = NULL;
+        uuid_t         gfid           = {0, };
+        char           path[PATH_MAX] = {0, };
+        int            i              = 0;
+        int            keep           = 0;
+
+        priv = this->private;
+
+        for (i = 0; i < 256; i++) {
+                snprintf (path, sizeof (path), "%s/data/%02x", priv->path, i);
+
+                dir = opendir (path);
+                if (!dir)
+                        continue;
+
+                while ((entry = readdir (dir)) != NULL) {
+                        if (entry->d_name[0] == '.')
+                                continue;
+
+                        keep = 0;
+                        if (!all && (uuid_parse (entry->d_name, gfid) == 0)) {
+                                pthread_mutex_lock (&priv->lock);
+                                {
+                                        keep = (__dc_file_get (priv, gfid)
+                                                != NULL);
+                                }
+                                pthread_mutex_unlock (&priv->lock);
+                        }
+
+                        if (keep)
+                                continue;
+
+                        snprintf (path, sizeof (path), "%s/data/%02x/%s",
+                                  priv->path, i, entry->d_name);
+                        unlink (path);
+                }
+
+                closedir (dir);
+        }
+}
+
+
+static int
+dc_index_load (xlator_t *this)
+{
+        dc_private_t      *priv           = NULL;
+        dc_index_header_t  header         = {0, };
+        dc_record_t        record         = {0, };
+        char               path[PATH_MAX] = {0, };
+        off_t              offset         = 0;
+        uint64_t           count          = 0;
+        ssize_t            ret            = -1;
+        int                fd             = -1;
+
+        priv = this->private;
+
+        snprintf (path, sizeof (path), "%s/index", priv->path);
+
+        fd = open (path, O_RDWR|O_APPEND);
+        if (fd < 0)
+                goto fresh;
+
+        ret = read (fd, &header, sizeof (header));
+        if ((ret != sizeof (header))
+            || (header.magic != DC_INDEX_MAGIC)
+            || (header.version != DC_INDEX_VERSION)
+            || (header.checksum
+                != gf_rsync_weak_checksum ((char *)&header,
+                                           offsetof (dc_index_header_t,
+                                                     checksum)))) {
+                gf_log (this->name, GF_LOG_WARNING,
+                        "%s is not a valid cache index, discarding the cache",
+                        path);
+                goto discard;
+        }
+
+        if (header.page_size != priv->page_size) {
+                gf_log (this->name, GF_LOG_INFO,
+                        "page-size changed from %"PRIu64", discarding the "
+                        "cache", header.page_size);
+                goto discard;
+        }
+
+        offset = sizeof (header);
+
+        pthread_mutex_lock (&priv->lock);
+        {
+                while ((ret = read (fd, &record, sizeof (record)))
+                       == sizeof (record)) {
+                        if (!dc_record_valid (&record))
+                                break;
+
+                        __dc_record_replay (priv, &record);
+                        offset += sizeof (record);
+                        count++;
+                }
+        }
+        pthread_mutex_unlock (&priv->lock);
+
+        if (ret != 0) {
+                /* torn or garbled tail, left by a crash */
+                gf_log (this->name, GF_LOG_INFO,
+                        "cache index truncated after %"PRIu64" records",
+                        count);
+                if (ftruncate (fd, offset) != 0)
+                        goto discard;
+        }
+
+        priv->index_fd = fd;
+        priv->index_records = count;
+
+        gf_log (this->name, GF_LOG_INFO, "%"PRIu64" pages of %"PRIu64
+                " files found in the cache", priv->page_count,
+                priv->file_count);
+
+        dc_data_sweep (this, 0);
+        return 0;
+
+discard:
+        close (fd);
+        fd = -1;
+
+        pthread_mutex_lock (&priv->lock);
+        {
+                while (!list_empty (&priv->lru))
+                        __dc_file_free (priv, list_entry (priv->lru.next,
+                                                          dc_page_t,
+                                                          lru)->file);
+        }
+        pthread_mutex_unlock (&priv->lock);
+
+        dc_data_sweep (this, 1);
+fresh:
+        fd = open (path, O_CREAT|O_TRUNC|O_RDWR|O_APPEND, 0600);
+        if (fd < 0) {
+                gf_log (this->name, GF_LOG_ERROR,
+                        "cannot create %s: %s", path, strerror (errno));
+                return -1;
+        }
+
+        if (dc_index_write_header (fd, priv->page_size) != 0) {
+                gf_log (this->name, GF_LOG_ERROR,
+                        "cannot write %s: %s", path, strerror (errno));
+                close (fd);
+                return -1;
+        }
+
+        priv->index_fd = fd;
+        priv->index_records = 0;
+
+        return 0;
+}
+
+
+static int
+dc_mkdir (xlator_t *this, const char *path)
+{
+        if ((mkdir (path, 0700) != 0) && (errno != EEXIST)) {
+                gf_log (this->name, GF_LOG_ERROR,
+                        "cannot create %s: %s", path, strerror (errno));
+                return -1;
+        }
+
+        return 0;
+}
+
+
+static void
+dc_store_free (dc_private_t *priv)
+{
+        dc_file_t *file = NULL;
+        int        i    = 0;
+
+        if (priv->index_fd >= 0)
+                close (priv->index_fd);
+
+        /* releases the lock */
+        if (priv->lock_fd >= 0)
+                close (priv->lock_fd);
+
+        if (priv->files) {
+                for (i = 0; i < DC_FILE_BUCKETS; i++) {
+                        while (!list_empty (&priv->files[i])) {
+                                file = list_entry (priv->files[i].next,
+                                                   dc_file_t, hash);
+                                __dc_file_free (priv, file);
+                        }
+                }
+        }
+
+        GF_FREE (priv->files);
+        GF_FREE (priv->pages);
+        pthread_cond_destroy (&priv->cond);
+        pthread_mutex_destroy (&priv->lock);
+}
+
+
+int
+dc_store_init (xlator_t *this)
+{
+        dc_private_t *priv           = NULL;
+        char          path[PATH_MAX] = {0, };
+        int           i              = 0;
+        int           ret            = -1;
+
+        priv = this->private;
+        priv->index_fd = -1;
+        priv->lock_fd = -1;
+
+        priv->files = GF_CALLOC (DC_FILE_BUCKETS, sizeof (struct list_head),
+                                 gf_dc_mt_list_head);
+        priv->pages = GF_CALLOC (DC_PAGE_BUCKETS, sizeof (struct list_head),
+                                 gf_dc_mt_list_head);
+        if (!priv->files || !priv->pages)
+                goto out;
+
+        for (i = 0; i < DC_FILE_BUCKETS; i++)
+                INIT_LIST_HEAD (&priv->files[i]);
+        for (i = 0; i < DC_PAGE_BUCKETS; i++)
+                INIT_LIST_HEAD (&priv->pages[i]);
+
+        INIT_LIST_HEAD (&priv->lru);
+        INIT_LIST_HEAD (&priv->jobs);
+        pthread_mutex_init (&priv->lock, NULL);
+        pthread_cond_init (&priv->cond, NULL);
+
+        if (dc_mkdir (this, priv->path) != 0)
+                goto out;
+
+        /* a client and an nfs server on the same host get the same
+           translator names: only one of them may use the directory */
+        snprintf (path, sizeof (path), "%s/lock", priv->path);
+        priv->lock_fd = open (path, O_RDWR|O_CREAT, 0600);
+        if (priv->lock_fd < 0) {
+                gf_log (this->name, GF_LOG_ERROR, "cannot open %s: %s",
+                        path, strerror (errno));
+                goto out;
+        }
+
+        if (flock (priv->lock_fd, LOCK_EX|LOCK_NB) != 0) {
+                gf_log (this->name, GF_LOG_ERROR,
+                        "%s is in use by another process, configure a "
+                        "different cache-dir", priv->path);
+                goto out;
+        }
+
+        snprintf (path, sizeof (path), "%s/data", priv->path);
+        if (dc_mkdir (this, path) != 0)
+                goto out;
+
+        for (i = 0; i < 256; i++) {
+                snprintf (path, sizeof (path), "%s/data/%02x", priv->path, i);
+                if (dc_mkdir (this, path) != 0)
+                        goto out;
+        }
+
+        if (dc_index_load (this) != 0)
+                goto out;
+
+        pthread_mutex_lock (&priv->lock);
+        {
+                /* cache-size may have been reduced since last run */
+                __dc_prune (priv, 0);
+        }
+        pthread_mutex_unlock (&priv->lock);
+
+        ret = pthread_create (&priv->worker, NULL, dc_worker, this);
+        if (ret != 0) {
+                gf_log (this->name, GF_LOG_ERROR,
+                        "cannot start the cache writer: %s", strerror (ret));
+                ret = -1;
+                goto out;
+        }
+
+        ret = 0;
+out:
+        if (ret != 0)
+                dc_store_free (priv);
+
+        return ret;
+}
+
+
+/* waits for the queued writes, so that a clean shutdown loses nothing */
+void
+dc_store_fini (xlator_t *this)
+{
+        dc_private_t *priv = NULL;
+
+        priv = this->private;
+
+        pthread_mutex_lock (&priv->lock);
+        {
+                priv->fini = 1;
+                pthread_cond_signal (&priv->cond);
+        }
+        pthread_mutex_unlock (&priv->lock);
+
+        pthread_join (priv->worker, NULL);
+
+        dc_store_free (priv);
+}
@@ -0,0 +1,1042 @@
+/*
+  Copyright (c) 2011 Gluster, Inc. <http://www.gluster.com>
+  This file is part of GlusterFS.
+
+  GlusterFS is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published
+  by the Free Software Foundation; either version 3 of the License,
+  or (at your option) any later version.
+
+  GlusterFS is distributed in the hope that it will be useful, but
+  WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see
+  <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef _CONFIG_H
+#define _CONFIG_H
+#include "config.h"
+#endif
+
+#include <fcntl.h>
+
+#include "disk-cache.h"
+#include "checksum.h"
+#include "statedump.h"
+
+#define DC_STACK_UNWIND(op, frame, params ...) do {             \
+                dc_local_t *__local = frame->local;             \
+                frame->local = NULL;                            \
+                STACK_UNWIND_STRICT (op, frame, params);        \
+                dc_local_free (__local);                        \
+        } while (0)
+
+
+static void
+dc_local_free (dc_local_t *local)
+{
+        if (!local)
+                return;
+
+        if (local->fd)
+                fd_unref (local->fd);
+
+        GF_FREE (local);
+}
+
+
+static inline int
+dc_version_matches (dc_file_t *file, struct iatt *stbuf)
+{
+        return ((file->size == stbuf->ia_size)
+                && (file->mtime == stbuf->ia_mtime)
+                && (file->mtime_nsec == stbuf->ia_mtime_nsec));
+}
+
+
+/*
+ * dc_file_check - compare the cached version of a file with attributes
+ *                 just received, dropping its pages if it changed.
+ */
+static void
+dc_file_check (xlator_t *this, inode_t *inode, struct iatt *stbuf)
+{
+        dc_private_t *priv = NULL;
+        dc_file_t    *file = NULL;
+
+        priv = this->private;
+
+        if (!inode || !stbuf || !IA_ISREG (stbuf->ia_type))
+                return;
+
+        pthread_mutex_lock (&priv->lock);
+        {
+                file = __dc_file_get (priv, inode->gfid);
+                if (!file)
+                        goto unlock;
+
+                if (!dc_version_matches (file, stbuf)) {
+                        priv->invalidations++;
+                        __dc_file_drop (priv, file);
+                        goto unlock;
+                }
+
+                file->stbuf = *stbuf;
+                gettimeofday (&file->validated, NULL);
+        }
+unlock:
+        pthread_mutex_unlock (&priv->lock);
+}
+
+
+static void
+dc_file_forget (xlator_t *this, inode_t *inode)
+{
+        dc_private_t *priv = NULL;
+        dc_file_t    *file = NULL;
+
+        priv = this->private;
+
+        if (!inode)
+                return;
+
+        pthread_mutex_lock (&priv->lock);
+        {
+                file = __dc_file_get (priv, inode->gfid);
+                if (file) {
+                        priv->invalidations++;
+                        __dc_file_drop (priv, file);
+                }
+        }
+        pthread_mutex_unlock (&priv->lock);
+}
+
+
+/*
+ * dc_fill - queue for writing the pages entirely contained in data just
+ *           read at @offset, @offset being page aligned.
+ */
+static void
+dc_fill (xlator_t *this, inode_t *inode, struct iatt *stbuf,
+         struct iovec *vector, int32_t count, off_t offset, size_t len)
+{
+        dc_private_t *priv      = NULL;
+        dc_file_t    *file      = NULL;
+        dc_page_t    *page      = NULL;
+        dc_job_t     *job       = NULL;
+        struct iovec *subvec    = NULL;
+        int32_t       subcount  = 0;
+        uint64_t      index     = 0;
+        uint64_t      last      = 0;
+        off_t         page_off  = 0;
+        size_t        page_len  = 0;
+
+        priv = this->private;
+
+        if (!IA_ISREG (stbuf->ia_type) || (len == 0)
+            || ((uint64_t)offset >= stbuf->ia_size))
+                return;
+
+        if (priv->max_file_size && (stbuf->ia_size > priv->max_file_size))
+                return;
+
+        subvec = GF_CALLOC (count, sizeof (*subvec), gf_dc_mt_iovec);
+        if (!subvec)
+                return;
+
+        index = offset / priv->page_size;
+        last = (offset + len - 1) / priv->page_size;
+
+        pthread_mutex_lock (&priv->lock);
+        {
+                /* make room first: pruning may drop the file below */
+                __dc_prune (priv, last - index + 1);
+
+                file = __dc_file_get (priv, inode->gfid);
+                if (file && !dc_version_matches (file, stbuf)) {
+                        priv->invalidations++;
+                        __dc_file_drop (priv, file);
+                        file = NULL;
+                }
+
+                if (!file) {
+                        file = __dc_file_new (priv, inode->gfid);
+                        if (!file)
+                                goto unlock;
+                        file->size = stbuf->ia_size;
+                        file->mtime = stbuf->ia_mtime;
+                        file->mtime_nsec = stbuf->ia_mtime_nsec;
+                }
+
+                file->stbuf = *stbuf;
+                gettimeofday (&file->validated, NULL);
+
+                for (; index <= last; index++) {
+                        page_off = DC_PAGE_OFFSET (priv, index);
+                        if ((uint64_t)page_off >= stbuf->ia_size)
+                                break;
+
+                        page_len = min (priv->page_size,
+                                        stbuf->ia_size - page_off);
+                        if (page_off + page_len > offset + len)
+                                break;
+
+                        if (__dc_page_get (priv, inode->gfid, index))
+                                continue;
+
+                        if (priv->job_count >= DC_MAX_JOBS) {
+                                priv->dropped_fills++;
+                                break;
+                        }
+
+                        job = GF_CALLOC (1, sizeof (*job), gf_dc_mt_dc_job_t);
+                        if (!job)
+                                break;
+
+                        job->data = GF_MALLOC (page_len, gf_dc_mt_char);
+                        if (!job->data) {
+                                GF_FREE (job);
+                                break;
+                        }
+
+                        page = __dc_page_new (priv, file, index);
+                        if (!page) {
+                                GF_FREE (job->data);
+                                GF_FREE (job);
+                                break;
+                        }
+                        page->size = page_len;
+
+                        subcount = iov_subset (vector, count,
+                                               page_off - offset,
+                                               page_off - offset + page_len,
+                                               subvec);
+                        iov_unload (job->data, subvec, subcount);
+
+                        job->type = DC_JOB_WRITE;
+                        job->gen = page->gen;
+                        dc_record_fill (&job->record, DC_REC_PAGE, file,
+                                        index);
+                        job->record.size = page_len;
+
+                        __dc_job_queue (priv, job);
+                        priv->fills++;
+                }
+        }
+unlock:
+        pthread_mutex_unlock (&priv->lock);
+
+        GF_FREE (subvec);
+}
+
+
+struct dc_read_page {
+        uint64_t  index;
+        uint64_t  gen;
+        uint32_t  size;
+        uint32_t  checksum;
+};
+
+/*
+ * dc_read_cached - serve a read from the cache if all the pages it covers
+ *                  are there. returns 0 if the read was unwound.
+ */
+static int
+dc_read_cached (call_frame_t *frame, xlator_t *this, fd_t *fd, size_t size,
+                off_t offset)
+{
+        dc_private_t          *priv           = NULL;
+        dc_file_t             *file           = NULL;
+        dc_page_t             *page           = NULL;
+        struct dc_read_page   *pages          = NULL;
+        struct iobuf          *iobuf          = NULL;
+        struct iobref         *iobref         = NULL;
+        struct iatt            stbuf          = {0, };
+        struct iovec           vector         = {0, };
+        char                   path[PATH_MAX] = {0, };
+        uint64_t               first          = 0;
+        uint64_t               i              = 0;
+        uint64_t               n              = 0;
+        off_t                  end            = 0;
+        int                    data_fd        = -1;
+        int                    bad            = -1;
+        int                    ret            = -1;
+
+        priv = this->private;
+
+        pthread_mutex_lock (&priv->lock);
+        {
+                file = __dc_file_get (priv, fd->inode->gfid);
+                if (!file || !file->validated.tv_sec)
+                        goto unlock;
+
+                stbuf = file->stbuf;
+
+                if ((uint64_t)offset >= file->size) {
+                        /* end of file, nothing to read */
+                        priv->hits++;
+                        ret = 1;
+                        goto unlock;
+                }
+
+                end = min (offset + size, file->size);
+                first = offset / priv->page_size;
+                n = (end - 1) / priv->page_size - first + 1;
+
+                pages = GF_CALLOC (n, sizeof (*pages), gf_dc_mt_char);
+                if (!pages)
+                        goto unlock;
+
+                for (i = 0; i < n; i++) {
+                        page = __dc_page_get (priv, fd->inode->gfid,
+                                              first + i);
+                        if (!page || (page->state != DC_PAGE_READY))
+                                goto unlock;
+
+                        pages[i].index = page->index;
+                        pages[i].gen = page->gen;
+                        pages[i].size = page->size;
+                        pages[i].checksum = page->checksum;
+                }
+
+                for (i = 0; i < n; i++) {
+                        page = __dc_page_get (priv, fd->inode->gfid,
+                                              first + i);
+                        list_move_tail (&page->lru, &priv->lru);
+                }
+
+                priv->hits++;
+                ret = 0;
+        }
+unlock:
+        if (ret < 0)
+                priv->misses++;
+        pthread_mutex_unlock (&priv->lock);
+
+        if (ret == 1) {
+                DC_STACK_UNWIND (readv, frame, 0, 0, NULL, 0, &stbuf, NULL);
+                ret = 0;
+                goto out;
+        }
+
+        if (ret < 0)
+                goto out;
+
+        ret = -1;
+
+        iobuf = iobuf_get2 (this->ctx->iobuf_pool, n * priv->page_size);
+        iobref = iobref_new ();
+        if (!iobuf || !iobref)
+                goto bad;
+
+        dc_data_path (priv, fd->inode->gfid, path, sizeof (path));
+        data_fd = open (path, O_RDONLY);
+        if (data_fd < 0)
+                goto bad;
+
+        for (i = 0; i < n; i++) {
+                bad = i;
+                if (pread (data_fd, iobuf->ptr + i * priv->page_size,
+                           pages[i].size,
+                           DC_PAGE_OFFSET (priv, pages[i].index))
+                    != pages[i].size)
+                        goto bad;
+
+                if (gf_rsync_weak_checksum (iobuf->ptr + i * priv->page_size,
+                                            pages[i].size)
+                    != pages[i].checksum)
+                        goto bad;
+        }
+
+        iobref_add (iobref, iobuf);
+
+        vector.iov_base = iobuf->ptr + (offset - first * priv->page_size);
+        vector.iov_len = end - offset;
+
+        DC_STACK_UNWIND (readv, frame, vector.iov_len, 0, &vector, 1,
+                         &stbuf, iobref);
+        ret = 0;
+        goto out;
+
+bad:
+        /* lost in a crash, or evicted while we were reading it */
+        pthread_mutex_lock (&priv->lock);
+        {
+                priv->hits--;
+                priv->misses++;
+
+                if (bad >= 0) {
+                        page = __dc_page_get (priv, fd->inode->gfid,
+                                              pages[bad].index);
+                        if (page && (page->gen == pages[bad].gen)
+                            && (page->state == DC_PAGE_READY)) {
+                                priv->bad_pages++;
+                                __dc_page_evict (priv, page);
+                        }
+                }
+        }
+        pthread_mutex_unlock (&priv->lock);
+out:
+        if (data_fd >= 0)
+                close (data_fd);
+        if (iobuf)
+                iobuf_unref (iobuf);
+        if (iobref)
+                iobref_unref (iobref);
+        if (pages)
+                GF_FREE (pages);
+
+        return ret;
+}
+
+
+int32_t
+dc_readv_cbk (call_frame_t *frame, void *cookie, xlator_t *this,
+              int32_t op_ret, int32_t op_errno, struct iovec *vector,
+              int32_t count, struct iatt *stbuf, struct iobref *iobref)
+{
+        dc_local_t   *local    = NULL;
+        struct iovec *newvec   = NULL;
+        int32_t       newcount = 0;
+        off_t         avail    = 0;
+        off_t         end      = 0;
+
+        local = frame->local;
+
+        if (op_ret < 0)
+                goto unwind;
+
+        dc_fill (this, local->fd->inode, stbuf, vector, count,
+                 local->aligned_offset, op_ret);
+
+        avail = local->aligned_offset + op_ret;
+        if (local->offset >= avail) {
+                op_ret = 0;
+                count = 0;
+                goto unwind;
+        }
+
+        end = min (local->offset + local->size, avail);
+
+        newcount = iov_subset (vector, count,
+                               local->offset - local->aligned_offset,
+                               end - local->aligned_offset, NULL);
+        newvec = GF_CALLOC (newcount, sizeof (*newvec), gf_dc_mt_iovec);
+        if (!newvec) {
+                op_ret = -1;
+                op_errno = ENOMEM;
+                goto unwind;
+        }
+
+        count = iov_subset (vector, count,
+                            local->offset - local->aligned_offset,
+                            end - local->aligned_offset, newvec);
+        vector = newvec;
+        op_ret = end - local->offset;
+
+unwind:
+        DC_STACK_UNWIND (readv, frame, op_ret, op_errno, vector, count, stbuf,
+                         iobref);
+
+        if (newvec)
+                GF_FREE (newvec);
+
+        return 0;
+}
+
+
+static void
+dc_readv_resume (call_frame_t *frame, xlator_t *this)
+{
+        dc_private_t *priv  = NULL;
+        dc_local_t   *local = NULL;
+        off_t         end   = 0;
+
+        priv = this->private;
+        local = frame->local;
+
+        if (dc_read_cached (frame, this, local->fd, local->size,
+                            local->offset) == 0)
+                /* already unwound */
+                return;
+
+        /* read whole pages, for them to be cached */
+        end = local->offset + local->size;
+        local->aligned_offset = local->offset
+                - (local->offset % priv->page_size);
+        local->aligned_size = end - local->aligned_offset;
+        if (end % priv->page_size)
+                local->aligned_size += priv->page_size
+                        - (end % priv->page_size);
+
+        STACK_WIND (frame, dc_readv_cbk, FIRST_CHILD (this),
+                    FIRST_CHILD (this)->fops->readv, local->fd,
+                    local->aligned_size, local->aligned_offset);
+}
+
+
+int32_t
+dc_readv_fstat_cbk (call_frame_t *frame, void *cookie, xlator_t *this,
+                    int32_t op_ret, int32_t op_errno, struct iatt *buf)
+{
+        dc_local_t *local = NULL;
+
+        local = frame->local;
+
+        if (op_ret == 0)
+                dc_file_check (this, local->fd->inode, buf);
+        else
+                dc_file_forget (this, local->fd->inode);
+
+        dc_readv_resume (frame, this);
+        return 0;
+}
+
+
+int32_t
+dc_readv (call_frame_t *frame, xlator_t *this, fd_t *fd, size_t size,
+          off_t offset)
+{
+        dc_private_t   *priv        = NULL;
+        dc_local_t     *local       = NULL;
+        dc_file_t      *file        = NULL;
+        struct timeval  now         = {0, };
+        char            revalidate  = 0;
+
+        priv = this->private;
+
+        if ((fd_ctx_get (fd, this, NULL) == 0) || (size == 0))
+                goto wind;
+
+        local = GF_CALLOC (1, sizeof (*local), gf_dc_mt_dc_local_t);
+        if (!local)
+                goto wind;
+
+        local->fd = fd_ref (fd);
+        local->offset = offset;
+        local->size = size;
+        frame->local = local;
+
+        gettimeofday (&now, NULL);
+
+        pthread_mutex_lock (&priv->lock);
+        {
+                file = __dc_file_get (priv, fd->inode->gfid);
+                revalidate = (file
+                              && (!file->validated.tv_sec
+                                  || ((now.tv_sec - file->validated.tv_sec)
+                                      >= priv->cache_timeout)));
+        }
+        pthread_mutex_unlock (&priv->lock);
+
+        if (revalidate) {
+                STACK_WIND (frame, dc_readv_fstat_cbk, FIRST_CHILD (this),
+                            FIRST_CHILD (this)->fops->fstat, fd);
+                return 0;
+        }
+
+        dc_readv_resume (frame, this);
+        return 0;
+
+wind:
+        STACK_WIND (frame, default_readv_cbk, FIRST_CHILD (this),
+                    FIRST_CHILD (this)->fops->readv, fd, size, offset);
+        return 0;
+}
+
+
+int32_t
+dc_lookup_cbk (call_frame_t *frame, void *cookie, xlator_t *this,
+               int32_t op_ret, int32_t op_errno, inode_t *inode,
+               struct iatt *buf, dict_t *xattr, struct iatt *postparent)
+{
+        if (op_ret == 0)
+                dc_file_check (this, inode, buf);
+
+        STACK_UNWIND_STRICT (lookup, frame, op_ret, op_errno, inode, buf,
+                             xattr, postparent);
+        return 0;
+}
+
+
+int32_t
+dc_lookup (call_frame_t *frame, xlator_t *this, loc_t *loc,
+           dict_t *xattr_req)
+{
+        STACK_WIND (frame, dc_lookup_cbk, FIRST_CHILD (this),
+                    FIRST_CHILD (this)->fops->lookup, loc, xattr_req);
+        return 0;
+}
+
+
+int32_t
+dc_open (call_frame_t *frame, xlator_t *this, loc_t *loc, int32_t flags,
+         fd_t *fd, int32_t wbflags)
+{
+        /* O_DIRECT readers want data from the bricks */
+        if (flags & O_DIRECT)
+                fd_ctx_set (fd, this, 1);
+
+        STACK_WIND (frame, default_open_cbk, FIRST_CHILD (this),
+                    FIRST_CHILD (this)->fops->open, loc, flags, fd, wbflags);
+        return 0;
+}
+
+
+/* the modifying fops below pass the inode as cookie, their caller holds a
+   reference on it until they unwind */
+static void
+dc_modify_done (xlator_t *this, inode_t *inode, int32_t op_ret,
+                struct iatt *postbuf)
+{
+        if (op_ret >= 0)
+                dc_file_check (this, inode, postbuf);
+        else
+                dc_file_forget (this, inode);
+}
+
+
+int32_t
+dc_writev_cbk (call_frame_t *frame, void *cookie, xlator_t *this,
+               int32_t op_ret, int32_t op_errno, struct iatt *prebuf,
+               struct iatt *postbuf)
+{
+        dc_modify_done (this, cookie, op_ret, postbuf);
+
+        STACK_UNWIND_STRICT (writev, frame, op_ret, op_errno, prebuf,
+                             postbuf);
+        return 0;
+}
+
+
+int32_t
+dc_truncate_cbk (call_frame_t *frame, void *cookie, xlator_t *this,
+                 int32_t op_ret, int32_t op_errno, struct iatt *prebuf,
+                 struct iatt *postbuf)
+{
+        dc_modify_done (this, cookie, op_ret, postbuf);
+
+        STACK_UNWIND_STRICT (truncate, frame, op_ret, op_errno, prebuf,
+                             postbuf);
+        return 0;
+}
+
+
+int32_t
+dc_ftruncate_cbk (call_frame_t *frame, void *cookie, xlator_t *this,
+                  int32_t op_ret, int32_t op_errno, struct iatt *prebuf,
+                  struct iatt *postbuf)
+{
+        dc_modify_done (this, cookie, op_ret, postbuf);
+
+        STACK_UNWIND_STRICT (ftruncate, frame, op_ret, op_errno, prebuf,
+                             postbuf);
+        return 0;
+}
+
+
+int32_t
+dc_fallocate_cbk (call_frame_t *frame, void *cookie, xlator_t *this,
+                  int32_t op_ret, int32_t op_errno, struct iatt *prebuf,
+                  struct iatt *postbuf)
+{
+        dc_modify_done (this, cookie, op_ret, postbuf);
+
+        /* discard and zerofill unwind through here as well */
+        STACK_UNWIND_STRICT (fallocate, frame, op_ret, op_errno, prebuf,
+                             postbuf);
+        return 0;
+}
+
+
+int32_t
+dc_setattr_cbk (call_frame_t *frame, void *cookie, xlator_t *this,
+                int32_t op_ret, int32_t op_errno, struct iatt *statpre,
+                struct iatt *statpost)
+{
+        dc_modify_done (this, cookie, op_ret, statpost);
+
+        STACK_UNWIND_STRICT (setattr, frame, op_ret, op_errno, statpre,
+                             statpost);
+        return 0;
+}
+
+
+int32_t
+dc_fsetattr_cbk (call_frame_t *frame, void *cookie, xlator_t *this,
+                 int32_t op_ret, int32_t op_errno, struct iatt *statpre,
+                 struct iatt *statpost)
+{
+        dc_modify_done (this, cookie, op_ret, statpost);
+
+        STACK_UNWIND_STRICT (fsetattr, frame, op_ret, op_errno, statpre,
+                             statpost);
+        return 0;
+}
+
+
+int32_t
+dc_writev (call_frame_t *frame, xlator_t *this, fd_t *fd,
+           struct iovec *vector, int32_t count, off_t offset,
+           struct iobref *iobref)
+{
+        STACK_WIND_COOKIE (frame, dc_writev_cbk, fd->inode,
+                           FIRST_CHILD (this),
+                           FIRST_CHILD (this)->fops->writev, fd, vector,
+                           count, offset, iobref);
+        return 0;
+}
+
+
+int32_t
+dc_truncate (call_frame_t *frame, xlator_t *this, loc_t *loc, off_t offset)
+{
+        STACK_WIND_COOKIE (frame, dc_truncate_cbk, loc->inode,
+                           FIRST_CHILD (this),
+                           FIRST_CHILD (this)->fops->truncate, loc, offset);
+        return 0;
+}
+
+
+int32_t
+dc_ftruncate (call_frame_t *frame, xlator_t *this, fd_t *fd, off_t offset)
+{
+        STACK_WIND_COOKIE (frame, dc_ftruncate_cbk, fd->inode,
+                           FIRST_CHILD (this),
+                           FIRST_CHILD (this)->fops->ftruncate, fd, offset);
+        return 0;
+}
+
+
+int32_t
+dc_fallocate (call_frame_t *frame, xlator_t *this, fd_t *fd, int32_t mode,
+              off_t offset, size_t len)
+{
+        STACK_WIND_COOKIE (frame, dc_fallocate_cbk, fd->inode,
+                           FIRST_CHILD (this),
+                           FIRST_CHILD (this)->fops->fallocate, fd, mode,
+                           offset, len);
+        return 0;
+}
+
+
+int32_t
+dc_discard (call_frame_t *frame, xlator_t *this, fd_t *fd, off_t offset,
+            size_t len)
+{
+        STACK_WIND_COOKIE (frame, dc_fallocate_cbk, fd->inode,
+                           FIRST_CHILD (this),
+                           FIRST_CHILD (this)->fops->discard, fd, offset,
+                           len);
+        return 0;
+}
+
+
+int32_t
+dc_zerofill (call_frame_t *frame, xlator_t *this, fd_t *fd, off_t offset,
+             size_t len)
+{
+        STACK_WIND_COOKIE (frame, dc_fallocate_cbk, fd->inode,
+                           FIRST_CHILD (this),
+                           FIRST_CHILD (this)->fops->zerofill, fd, offset,
+                           len);
+        return 0;
+}
+
+
+int32_t
+dc_setattr (call_frame_t *frame, xlator_t *this, loc_t *loc,
+            struct iatt *stbuf, int32_t valid)
+{
+        STACK_WIND_COOKIE (frame, dc_setattr_cbk, loc->inode,
+                           FIRST_CHILD (this),
+                           FIRST_CHILD (this)->fops->setattr, loc, stbuf,
+                           valid);
+        return 0;
+}
+
+
+int32_t
+dc_fsetattr (call_frame_t *frame, xlator_t *this, fd_t *fd,
+             struct iatt *stbuf, int32_t valid)
+{
+        STACK_WIND_COOKIE (frame, dc_fsetattr_cbk, fd->inode,
+                           FIRST_CHILD (this),
+                           FIRST_CHILD (this)->fops->fsetattr, fd, stbuf,
+                           valid);
+        return 0;
+}
+
+
+int32_t
+dc_unlink_cbk (call_frame_t *frame, void *cookie, xlator_t *this,
+               int32_t op_ret, int32_t op_errno, struct iatt *preparent,
+               struct iatt *postparent)
+{
+        /* other links may remain, but they are seldom read afterwards */
+        if (op_ret == 0)
+                dc_file_forget (this, cookie);
+
+        STACK_UNWIND_STRICT (unlink, frame, op_ret, op_errno, preparent,
+                             postparent);
+        return 0;
+}
+
+
+int32_t
+dc_unlink (call_frame_t *frame, xlator_t *this, loc_t *loc)
+{
+        STACK_WIND_COOKIE (frame, dc_unlink_cbk, loc->inode,
+                           FIRST_CHILD (this),
+                           FIRST_CHILD (this)->fops->unlink, loc);
+        return 0;
+}
+
+
+int
+dc_priv_dump (xlator_t *this)
+{
+        dc_private_t *priv = NULL;
+
+        if (!this || !this->private)
+                goto out;
+
+        priv = this->private;
+
+        gf_proc_dump_add_section ("xlator.performance.disk-cache.priv");
+
+        pthread_mutex_lock (&priv->lock);
+        {
+                gf_proc_dump_write ("path", "%s", priv->path);
+                gf_proc_dump_write ("page_size", "%"PRIu64, priv->page_size);
+                gf_proc_dump_write ("cache_size", "%"PRIu64,
+                                    priv->cache_size);
+                gf_proc_dump_write ("cache_used", "%"PRIu64,
+                                    priv->page_count * priv->page_size);
+                gf_proc_dump_write ("cache_timeout", "%d",
+                                    priv->cache_timeout);
+                gf_proc_dump_write ("files", "%"PRIu64, priv->file_count);
+                gf_proc_dump_write ("pages", "%"PRIu64, priv->page_count);
+                gf_proc_dump_write ("queued_writes", "%u", priv->job_count);
+                gf_proc_dump_write ("index_records", "%"PRIu64,
+                                    priv->index_records);
+                gf_proc_dump_write ("hits", "%"PRIu64, priv->hits);
+                gf_proc_dump_write ("misses", "%"PRIu64, priv->misses);
+                gf_proc_dump_write ("fills", "%"PRIu64, priv->fills);
+                gf_proc_dump_write ("dropped_fills", "%"PRIu64,
+                                    priv->dropped_fills);
+                gf_proc_dump_write ("evictions", "%"PRIu64,
+                                    priv->evictions);
+                gf_proc_dump_write ("invalidations", "%"PRIu64,
+                                    priv->invalidations);
+                gf_proc_dump_write ("bad_pages", "%"PRIu64,
+                                    priv->bad_pages);
+        }
+        pthread_mutex_unlock (&priv->lock);
+out:
+        return 0;
+}
+
+
+int32_t
+mem_acct_init (xlator_t *this)
+{
+        int ret = -1;
+
+        if (!this)
+                return ret;
+
+        ret = xlator_mem_acct_init (this, gf_dc_mt_end + 1);
+        if (ret != 0) {
+                gf_log (this->name, GF_LOG_ERROR, "Memory accounting init "
+                        "failed");
+                return ret;
+        }
+
+        return ret;
+}
+
+
+int
+reconfigure (xlator_t *this, dict_t *options)
+{
+        dc_private_t *priv       = NULL;
+        uint64_t      cache_size = 0;
+        int           ret        = -1;
+
+        priv = this->private;
+
+        pthread_mutex_lock (&priv->lock);
+        {
+                GF_OPTION_RECONF ("cache-timeout", priv->cache_timeout,
+                                  options, int32, unlock);
+
+                GF_OPTION_RECONF ("max-file-size", priv->max_file_size,
+                                  options, size, unlock);
+
+                GF_OPTION_RECONF ("cache-size", cache_size, options, size,
+                                  unlock);
+                priv->cache_size = cache_size;
+                __dc_prune (priv, 0);
+
+                ret = 0;
+        }
+unlock:
+        pthread_mutex_unlock (&priv->lock);
+
+        return ret;
+}
+
+
+int32_t
+init (xlator_t *this)
+{
+        dc_private_t *priv      = NULL;
+        char         *cache_dir = NULL;
+        int32_t       ret       = -1;
+
+        if (!this->children || this->children->next) {
+                gf_log (this->name, GF_LOG_ERROR,
+                        "FATAL: disk-cache not configured with exactly "
+                        "one child");
+                goto out;
+        }
+
+        if (!this->parents) {
+                gf_log (this->name, GF_LOG_WARNING,
+                        "dangling volume. check volfile ");
+        }
+
+        priv = GF_CALLOC (1, sizeof (*priv), gf_dc_mt_dc_private_t);
+        if (!priv)
+                goto out;
+
+        GF_OPTION_INIT ("cache-dir", cache_dir, path, out);
+        GF_OPTION_INIT ("cache-size", priv->cache_size, size, out);
+        GF_OPTION_INIT ("page-size", priv->page_size, size, out);
+        GF_OPTION_INIT ("cache-timeout", priv->cache_timeout, int32, out);
+        GF_OPTION_INIT ("max-file-size", priv->max_file_size, size, out);
+
+        if (priv->page_size & (priv->page_size - 1)) {
+                gf_log (this->name, GF_LOG_ERROR,
+                        "page-size (%"PRIu64") is not a power of 2",
+                        priv->page_size);
+                goto out;
+        }
+
+        if (priv->cache_size < priv->page_size) {
+                gf_log (this->name, GF_LOG_ERROR,
+                        "cache-size is smaller than page-size");
+                goto out;
+        }
+
+        ret = gf_asprintf (&priv->path, "%s/%s", cache_dir, this->name);
+        if (ret < 0) {
+                ret = -1;
+                goto out;
+        }
+
+        this->private = priv;
+
+        ret = dc_store_init (this);
+        if (ret != 0) {
+                this->private = NULL;
+                goto out;
+        }
+
+        gf_log (this->name, GF_LOG_INFO, "caching in %s, %"PRIu64" bytes",
+                priv->path, priv->cache_size);
+        ret = 0;
+out:
+        if ((ret != 0) && priv) {
+                GF_FREE (priv->path);
+                GF_FREE (priv);
+        }
+
+        return ret;
+}
+
+
+void
+fini (xlator_t *this)
+{
+        dc_private_t *priv = NULL;
+
+        priv = this->private;
+        if (!priv)
+                return;
+
+        dc_store_fini (this);
+
+        GF_FREE (priv->path);
+        GF_FREE (priv);
+        this->private = NULL;
+}
+
+
+struct xlator_fops fops = {
+        .lookup      = dc_lookup,
+        .open        = dc_open,
+        .readv       = dc_readv,
+        .writev      = dc_writev,
+        .truncate    = dc_truncate,
+        .ftruncate   = dc_ftruncate,
+        .fallocate   = dc_fallocate,
+        .discard     = dc_discard,
+        .zerofill    = dc_zerofill,
+        .setattr     = dc_setattr,
+        .fsetattr    = dc_fsetattr,
+        .unlink      = dc_unlink,
+};
+
+struct xlator_cbks cbks = {
+};
+
+struct xlator_dumpops dumpops = {
+        .priv        = dc_priv_dump,
+};
+
+struct volume_options options[] = {
+        { .key  = {"cache-dir"},
+          .type = GF_OPTION_TYPE_PATH,
+          .default_value = "/var/cache/glusterfs",
+          .description = "Directory of the cache, on a local disk. The "
+          "cache of the translator is kept in a sub-directory named "
+          "after it."
+        },
+        { .key  = {"cache-size"},
+          .type = GF_OPTION_TYPE_SIZET,
+          .min  = 16 * GF_UNIT_MB,
+          .max  = 4 * GF_UNIT_TB,
+          .default_value = "1GB",
+          .description = "Space used by the cache on the local disk."
+        },
+        { .key  = {"page-size"},
+          .type = GF_OPTION_TYPE_SIZET,
+          .min  = 4 * GF_UNIT_KB,
+          .max  = 1 * GF_UNIT_MB,
+          .default_value = "128KB",
+          .description = "Unit of data cached. Changing it discards the "
+          "cache."
+        },
+        { .key  = {"cache-timeout"},
+          .type = GF_OPTION_TYPE_INT,
+          .min  = 0,
+          .max  = 60,
+          .default_value = "1",
+          .description = "Cached data is revalidated with the size and "
+          "mtime of the file when it was checked longer than this many "
+          "seconds ago."
+        },
+        { .key  = {"max-file-size"},
+          .type = GF_OPTION_TYPE_SIZET,
+          .default_value = "0",
+          .description = "Files larger than this are not cached, 0 means "
+          "no limit."
+        },
+        { .key = {NULL} },
+};
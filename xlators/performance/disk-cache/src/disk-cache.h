@@ -0,0 +1,237 @@
+/*
+  Copyright (c) 2011 Gluster, Inc. <http://www.gluster.com>
+  This file is part of GlusterFS.
+
+  GlusterFS is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published
+  by the Free Software Foundation; either version 3 of the License,
+  or (at your option) any later version.
+
+  GlusterFS is distributed in the hope that it will be useful, but
+  WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see
+  <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef __DISK_CACHE_H
+#define __DISK_CACHE_H
+
+#ifndef _CONFIG_H
+#define _CONFIG_H
+#include "config.h"
+#endif
+
+#include "glusterfs.h"
+#include "logging.h"
+#include "dict.h"
+#include "xlator.h"
+#include "list.h"
+#include "common-utils.h"
+#include "iobuf.h"
+#include "defaults.h"
+#include <stddef.h>
+#include <pthread.h>
+#include <sys/time.h>
+#include "disk-cache-mem-types.h"
+
+/*
+ * performance/disk-cache keeps file data on a local disk, below io-cache
+ * and quick-read, so that it survives restarts of the client.
+ *
+ * Under <cache-dir>/<translator name>:
+ *
+ *   data/<xx>/<gfid>  sparse file holding the cached pages of a file at
+ *                     their offset in the file, <xx> being the first byte
+ *                     of the gfid.
+ *   index             header followed by an append-only log of dc_record_t,
+ *                     replayed on startup. every record carries a checksum
+ *                     so that a torn tail left by a crash is detected and
+ *                     cut off, and page records carry the checksum of the
+ *                     page data, which is checked on every read: data and
+ *                     index are never synced against each other.
+ *
+ * A page is only used while the size and mtime of the file match those it
+ * was read with. Those are checked against the attributes of every lookup,
+ * read and modifying fop seen, and at least every cache-timeout seconds
+ * before reading from the cache.
+ *
+ * All the writes to the cache directory are done by a worker thread, in
+ * the order they were queued.
+ */
+
+#define DC_PAGE_SIZE          (128 * GF_UNIT_KB)
+#define DC_FILE_BUCKETS       4096
+#define DC_PAGE_BUCKETS       65536
+#define DC_MAX_JOBS           1024   /* pages waiting to be written */
+#define DC_INDEX_SLACK        4096   /* stale records before compacting */
+
+#define DC_INDEX_MAGIC        0x47464443  /* "GFDC" */
+#define DC_INDEX_VERSION      1
+#define DC_RECORD_MAGIC       0x44435231
+
+/* on-disk structures, the cache being local they are in host byte order */
+typedef struct {
+        uint32_t  magic;
+        uint32_t  version;
+        uint64_t  page_size;
+        uint32_t  pad;
+        uint32_t  checksum;
+} dc_index_header_t;
+
+typedef enum {
+        DC_REC_PAGE = 1,
+        DC_REC_DROP_PAGE,
+        DC_REC_DROP_FILE,
+} dc_record_type_t;
+
+typedef struct {
+        uint32_t       magic;
+        uint32_t       type;
+        unsigned char  gfid[16];
+        uint64_t       index;          /* page number */
+        uint64_t       file_size;      /* version of the file, with mtime */
+        int64_t        mtime;
+        uint32_t       mtime_nsec;
+        uint32_t       size;           /* bytes of data in the page */
+        uint32_t       data_checksum;
+        uint32_t       checksum;       /* of the record up to this field */
+} dc_record_t;
+
+struct dc_file {
+        struct list_head  hash;
+        struct list_head  pages;
+        uuid_t            gfid;
+        uint64_t          size;
+        int64_t           mtime;
+        uint32_t          mtime_nsec;
+        struct iatt       stbuf;       /* last seen, valid if validated set */
+        struct timeval    validated;   /* last check of size and mtime */
+        uint64_t          page_count;
+};
+typedef struct dc_file dc_file_t;
+
+typedef enum {
+        DC_PAGE_PENDING,               /* queued for writing */
+        DC_PAGE_READY,
+} dc_page_state_t;
+
+struct dc_page {
+        struct list_head  hash;
+        struct list_head  lru;         /* ready pages only */
+        struct list_head  file_list;
+        dc_file_t        *file;
+        uint64_t          index;
+        uint64_t          gen;         /* matches the job writing it */
+        uint32_t          size;
+        uint32_t          checksum;
+        dc_page_state_t   state;
+};
+typedef struct dc_page dc_page_t;
+
+typedef enum {
+        DC_JOB_WRITE,
+        DC_JOB_EVICT,
+        DC_JOB_DROP_FILE,
+} dc_job_type_t;
+
+struct dc_job {
+        struct list_head  list;
+        dc_job_type_t     type;
+        dc_record_t       record;
+        uint64_t          gen;
+        char             *data;        /* DC_JOB_WRITE */
+};
+typedef struct dc_job dc_job_t;
+
+struct dc_local {
+        fd_t             *fd;
+        off_t             offset;
+        size_t            size;
+        off_t             aligned_offset;
+        size_t            aligned_size;
+};
+typedef struct dc_local dc_local_t;
+
+struct dc_private {
+        char             *path;        /* <cache-dir>/<translator name> */
+        uint64_t          page_size;
+        uint64_t          cache_size;
+        uint64_t          max_file_size;
+        int32_t           cache_timeout;
+
+        pthread_mutex_t   lock;
+        struct list_head *files;
+        struct list_head *pages;
+        struct list_head  lru;
+        uint64_t          page_count;  /* pending ones included */
+        uint64_t          file_count;
+        uint64_t          gen;
+
+        pthread_t         worker;
+        pthread_cond_t    cond;
+        struct list_head  jobs;
+        uint32_t          job_count;
+        char              fini;
+
+        int               index_fd;    /* worker only, once started */
+        int               lock_fd;     /* keeps other processes out */
+        uint64_t          index_records;
+
+        uint64_t          hits;
+        uint64_t          misses;
+        uint64_t          fills;
+        uint64_t          evictions;
+        uint64_t          invalidations;
+        uint64_t          bad_pages;
+        uint64_t          dropped_fills;
+};
+typedef struct dc_private dc_private_t;
+
+#define DC_PAGE_OFFSET(priv, index) ((off_t)((index) * (priv)->page_size))
+
+/* dc-store.c */
+int
+dc_store_init (xlator_t *this);
+
+void
+dc_store_fini (xlator_t *this);
+
+void
+dc_data_path (dc_private_t *priv, uuid_t gfid, char *path, size_t len);
+
+dc_file_t *
+__dc_file_get (dc_private_t *priv, uuid_t gfid);
+
+dc_file_t *
+__dc_file_new (dc_private_t *priv, uuid_t gfid);
+
+dc_page_t *
+__dc_page_get (dc_private_t *priv, uuid_t gfid, uint64_t index);
+
+dc_page_t *
+__dc_page_new (dc_private_t *priv, dc_file_t *file, uint64_t index);
+
+void
+__dc_page_free (dc_private_t *priv, dc_page_t *page);
+
+void
+__dc_file_drop (dc_private_t *priv, dc_file_t *file);
+
+void
+__dc_page_evict (dc_private_t *priv, dc_page_t *page);
+
+void
+__dc_prune (dc_private_t *priv, uint64_t needed);
+
+int
+__dc_job_queue (dc_private_t *priv, dc_job_t *job);
+
+void
+dc_record_fill (dc_record_t *record, dc_record_type_t type, dc_file_t *file,
+                uint64_t index);
+
+#endif /* __DISK_CACHE_H */
@@ -29,6 +29,7 @@
 #include "io-cache.h"
 #include "ioc-mem-types.h"
 #include "statedump.h"
+#include "bulkstat.h"
 #include <assert.h>
 #include <sys/time.h>
 
@@ -154,6 +155,157 @@ ioc_inode_flush (ioc_inode_t *ioc_inode)
         return;
 }
 
+/*
+ * __ioc_inode_write - bring the cached pages of the given inode in line with
+ *                     a successful write. pages fully covered by the write
+ *                     take its data (when @update is set), pages it only
+ *                     partly overlaps are destroyed.
+ *
+ * @ioc_inode:
+ * @vector, @count, @offset, @size: the data written
+ * @update: write through covered pages instead of destroying them
+ * @stale: set if an overlapping page could not be destroyed
+ *
+ * returns the change in cache_used. assumes lock is held
+ */
+int64_t
+__ioc_inode_write (ioc_inode_t *ioc_inode, struct iovec *vector,
+                   int32_t count, off_t offset, size_t size, char update,
+                   char *stale)
+{
+        ioc_table_t *table       = NULL;
+        ioc_page_t  *page        = NULL, *next = NULL;
+        off_t        page_offset = 0;
+        int64_t      size_delta  = 0;
+        int64_t      delta       = 0;
+        int64_t      ret         = 0;
+
+        table = ioc_inode->table;
+
+        /* a write past the cached end of file leaves the short page holding
+         * the old end of file behind; readers would get a short read out of
+         * it instead of the hole or data now following it.
+         */
+        list_for_each_entry_safe (page, next, &ioc_inode->cache.page_lru,
+                                  page_lru) {
+                if (!page->vector || (page->size >= table->page_size)
+                    || (page->offset + page->size >= offset + size)
+                    || (page->offset >= floor (offset, table->page_size)))
+                        continue;
+
+                ret = __ioc_page_destroy (page);
+                if (ret == -1)
+                        *stale = 1;
+                else
+                        size_delta -= ret;
+        }
+
+        for (page_offset = floor (offset, table->page_size);
+             page_offset < (offset + size);
+             page_offset += table->page_size) {
+                page = rbthash_get (ioc_inode->cache.page_table, &page_offset,
+                                    sizeof (page_offset));
+
+                /* pages still being faulted in are checked against the
+                 * mtime of their reply, see ioc_fault_cbk
+                 */
+                if (!page || !page->vector)
+                        continue;
+
+                if (update && (offset <= page->offset)
+                    && ((offset + size) >= (page->offset + page->size))) {
+                        ret = __ioc_page_write (page, vector, count, offset,
+                                                size, &delta);
+                        if (ret == 0) {
+                                size_delta += delta;
+                                continue;
+                        }
+                }
+
+                ret = __ioc_page_destroy (page);
+                if (ret == -1)
+                        *stale = 1;
+                else
+                        size_delta -= ret;
+        }
+
+        return size_delta;
+}
+
+/*
+ * ioc_inode_write - update the cache of the given inode after a write of
+ *                   @size bytes at @offset has succeeded
+ *
+ * the cache stays valid across the write only if the file was not changed
+ * behind our back before it (prebuf matches the cached mtime); the mtime
+ * after the write is then recorded so that the next ioc_cache_validate
+ * keeps the pages. replies without attributes (write-behind unwinding
+ * early) can not be checked: the pages are written through all the same
+ * and the next mtime from the server is taken as the one of the write,
+ * see __ioc_cache_own_write.
+ */
+void
+ioc_inode_write (ioc_inode_t *ioc_inode, struct iovec *vector, int32_t count,
+                 off_t offset, size_t size, struct iatt *prebuf,
+                 struct iatt *postbuf)
+{
+        ioc_table_t *table      = NULL;
+        int64_t      size_delta = 0;
+        char         have_attrs = 0;
+        char         stale      = 0;
+
+        table = ioc_inode->table;
+
+        have_attrs = (prebuf && postbuf && postbuf->ia_mtime);
+
+        ioc_inode_lock (ioc_inode);
+        {
+                if (have_attrs
+                    && ((prebuf->ia_mtime != ioc_inode->cache.mtime)
+                        || (prebuf->ia_mtime_nsec
+                            != ioc_inode->cache.mtime_nsec))) {
+                        size_delta = -__ioc_inode_flush (ioc_inode);
+                        if (!ioc_empty (&ioc_inode->cache))
+                                stale = 1;
+                } else {
+                        size_delta = __ioc_inode_write (ioc_inode, vector,
+                                                        count, offset, size,
+                                                        1, &stale);
+                }
+
+                if (!have_attrs && !stale)
+                        ioc_inode->cache.own_write = 1;
+
+                if (have_attrs) {
+                        ioc_inode->ia_size = postbuf->ia_size;
+
+                        /* pages which could not be dropped are left for
+                         * the next validate to catch
+                         */
+                        if (!stale) {
+                                ioc_inode->cache.mtime = postbuf->ia_mtime;
+                                ioc_inode->cache.mtime_nsec
+                                        = postbuf->ia_mtime_nsec;
+                        }
+                }
+        }
+        ioc_inode_unlock (ioc_inode);
+
+        if (size_delta) {
+                ioc_table_lock (table);
+                {
+                        table->cache_used += size_delta;
+                }
+                ioc_table_unlock (table);
+        }
+
+        if ((size_delta > 0) && ioc_need_prune (table)) {
+                ioc_prune (table);
+        }
+
+        return;
+}
+
 int32_t
 ioc_setattr_cbk (call_frame_t *frame, void *cookie, xlator_t *this,
                  int32_t op_ret, int32_t op_errno,
@@ -239,6 +391,8 @@ ioc_lookup_cbk (call_frame_t *frame, void *cookie, xlator_t *this,
                         ioc_inode->cache.mtime_nsec = stbuf->ia_mtime_nsec;
                 }
 
+                __ioc_cache_own_write (ioc_inode, stbuf);
+
                 ioc_inode->ia_size = stbuf->ia_size;
         }
         ioc_inode_unlock (ioc_inode);
@@ -350,6 +504,14 @@ ioc_cache_validate_cbk (call_frame_t *frame, void *cookie, xlator_t *this,
         ioc_inode = local->inode;
         local_stbuf = stbuf;
 
+        if (op_ret >= 0) {
+                ioc_inode_lock (ioc_inode);
+                {
+                        __ioc_cache_own_write (ioc_inode, stbuf);
+                }
+                ioc_inode_unlock (ioc_inode);
+        }
+
         if ((op_ret == -1) ||
             ((op_ret >= 0) && !ioc_cache_still_valid(ioc_inode, stbuf))) {
                 gf_log (ioc_inode->table->xl->name, GF_LOG_DEBUG,
@@ -996,6 +1158,8 @@ ioc_dispatch_requests (call_frame_t *frame, ioc_inode_t *ioc_inode, fd_t *fd,
 
                         if (trav->ready) {
                                 /* page found in cache */
+                                __ioc_page_hit (trav);
+
                                 if (!might_need_validate && !ioc_inode->waitq) {
                                         /* fresh enough */
                                         gf_log (frame->this->name, GF_LOG_TRACE,
@@ -1198,6 +1362,7 @@ ioc_readv (call_frame_t *frame, xlator_t *this, fd_t *fd,
         {
                 list_move_tail (&ioc_inode->inode_lru,
                                 &ioc_inode->table->inode_lru[weight]);
+                ioc_inode->accessed = 1;
         }
         ioc_table_unlock (ioc_inode->table);
 
@@ -1230,8 +1395,21 @@ ioc_writev_cbk (call_frame_t *frame, void *cookie, xlator_t *this,
         local = frame->local;
         inode_ctx_get (local->fd->inode, this, &ioc_inode);
 
-        if (ioc_inode)
-                ioc_inode_flush ((ioc_inode_t *)(long)ioc_inode);
+        if (ioc_inode) {
+                if (op_ret >= 0)
+                        ioc_inode_write ((ioc_inode_t *)(long)ioc_inode,
+                                         local->vector, local->count,
+                                         local->offset, op_ret, prebuf,
+                                         postbuf);
+                else
+                        ioc_inode_flush ((ioc_inode_t *)(long)ioc_inode);
+        }
+
+        if (local->iobref)
+                iobref_unref (local->iobref);
+
+        if (local->vector)
+                GF_FREE (local->vector);
 
         STACK_UNWIND_STRICT (writev, frame, op_ret, op_errno, prebuf, postbuf);
         return 0;
@@ -1268,9 +1446,20 @@ ioc_writev (call_frame_t *frame, xlator_t *this, fd_t *fd,
         local->fd = fd;
         frame->local = local;
 
+        /* cached pages are brought up to date in ioc_writev_cbk, keep the
+         * data around till then
+         */
         inode_ctx_get (fd->inode, this, &ioc_inode);
-        if (ioc_inode)
-                ioc_inode_flush ((ioc_inode_t *)(long)ioc_inode);
+        if (ioc_inode) {
+                local->offset = offset;
+                local->count = count;
+                local->vector = iov_dup (vector, count);
+                if (local->vector == NULL) {
+                        ioc_inode_flush ((ioc_inode_t *)(long)ioc_inode);
+                } else if (iobref) {
+                        local->iobref = iobref_ref (iobref);
+                }
+        }
 
         STACK_WIND (frame, ioc_writev_cbk, FIRST_CHILD(this),
                     FIRST_CHILD(this)->fops->writev, fd, vector, count, offset,
@@ -1373,6 +1562,73 @@ ioc_ftruncate (call_frame_t *frame, xlator_t *this, fd_t *fd, off_t offset)
         return 0;
 }
 
+/*
+ * ioc_fallocate_cbk - common callback of fallocate, discard and zerofill,
+ * which unwind with the same arguments
+ */
+int32_t
+ioc_fallocate_cbk (call_frame_t *frame, void *cookie, xlator_t *this,
+                   int32_t op_ret, int32_t op_errno, struct iatt *prebuf,
+                   struct iatt *postbuf)
+{
+        STACK_UNWIND_STRICT (fallocate, frame, op_ret, op_errno, prebuf,
+                             postbuf);
+        return 0;
+}
+
+
+static void
+ioc_fd_inode_flush (xlator_t *this, fd_t *fd)
+{
+        uint64_t ioc_inode = 0;
+
+        inode_ctx_get (fd->inode, this, &ioc_inode);
+
+        if (ioc_inode)
+                ioc_inode_flush ((ioc_inode_t *)(long)ioc_inode);
+}
+
+
+/*
+ * ioc_fallocate - the cached pages of the file are dropped like for a
+ * truncate, the range they cover may read back differently afterwards
+ */
+int32_t
+ioc_fallocate (call_frame_t *frame, xlator_t *this, fd_t *fd, int32_t mode,
+               off_t offset, size_t len)
+{
+        ioc_fd_inode_flush (this, fd);
+
+        STACK_WIND (frame, ioc_fallocate_cbk, FIRST_CHILD(this),
+                    FIRST_CHILD(this)->fops->fallocate, fd, mode, offset,
+                    len);
+        return 0;
+}
+
+
+int32_t
+ioc_discard (call_frame_t *frame, xlator_t *this, fd_t *fd, off_t offset,
+             size_t len)
+{
+        ioc_fd_inode_flush (this, fd);
+
+        STACK_WIND (frame, ioc_fallocate_cbk, FIRST_CHILD(this),
+                    FIRST_CHILD(this)->fops->discard, fd, offset, len);
+        return 0;
+}
+
+
+int32_t
+ioc_zerofill (call_frame_t *frame, xlator_t *this, fd_t *fd, off_t offset,
+              size_t len)
+{
+        ioc_fd_inode_flush (this, fd);
+
+        STACK_WIND (frame, ioc_fallocate_cbk, FIRST_CHILD(this),
+                    FIRST_CHILD(this)->fops->zerofill, fd, offset, len);
+        return 0;
+}
+
 int32_t
 ioc_lk_cbk (call_frame_t *frame, void *cookie, xlator_t *this, int32_t op_ret,
             int32_t op_errno, struct gf_flock *lock)
@@ -1565,6 +1821,265 @@ out:
         return ret;
 }
 
+/*
+ * background revalidation: every half cache-timeout, the inodes read since
+ * the previous round whose cache is about to time out are revalidated with
+ * bulkstats of up to GF_BULKSTAT_MAX_COUNT inodes, one after the other till
+ * the table has been walked, so that readers do not have to wait for a stat
+ * when the timeout expires. inodes whose mtime changed are left alone, the
+ * next read revalidates them the usual way.
+ */
+static int32_t
+ioc_revalidate_interval (ioc_table_t *table)
+{
+        return (table->cache_timeout > 2) ? (table->cache_timeout / 2) : 1;
+}
+
+static void
+ioc_revalidate_timer (void *data);
+
+static void
+ioc_revalidate_batch (xlator_t *this);
+
+/* assumes table is locked */
+static void
+__ioc_revalidate_arm (ioc_table_t *table)
+{
+        struct timeval delay = {0, };
+
+        if (!table->bg_revalidate || table->revalidate_timer)
+                return;
+
+        delay.tv_sec = ioc_revalidate_interval (table);
+        table->revalidate_timer = gf_timer_call_after (table->xl->ctx, delay,
+                                                       ioc_revalidate_timer,
+                                                       table->xl);
+        if (!table->revalidate_timer)
+                gf_log (table->xl->name, GF_LOG_WARNING,
+                        "cannot schedule background revalidation");
+}
+
+static int32_t
+ioc_revalidate_cbk (call_frame_t *frame, void *cookie, xlator_t *this,
+                    int32_t op_ret, int32_t op_errno, struct iatt *bufs,
+                    int32_t *op_errnos)
+{
+        ioc_table_t *table     = NULL;
+        ioc_inode_t *ioc_inode = NULL;
+        loc_t       *locs      = NULL;
+        uint64_t     tmp       = 0;
+        uint64_t     valid     = 0;
+        uint64_t     stale     = 0;
+        int32_t      i         = 0;
+        char         more      = 0;
+
+        table = this->private;
+        locs = cookie;
+
+        if (op_ret < 0) {
+                gf_log (this->name, GF_LOG_DEBUG,
+                        "background revalidation failed (%s)",
+                        strerror (op_errno));
+                goto out;
+        }
+
+        for (i = 0; i < op_ret; i++) {
+                if (op_errnos[i] != 0)
+                        continue;
+
+                tmp = 0;
+                inode_ctx_get (locs[i].inode, this, &tmp);
+                ioc_inode = (ioc_inode_t *)(long)tmp;
+                if (!ioc_inode)
+                        continue;
+
+                ioc_inode_lock (ioc_inode);
+                {
+                        __ioc_cache_own_write (ioc_inode, &bufs[i]);
+
+                        if (!ioc_inode->waitq
+                            && ioc_cache_still_valid (ioc_inode, &bufs[i])) {
+                                gettimeofday (&ioc_inode->cache.tv, NULL);
+                                valid++;
+                        } else {
+                                stale++;
+                        }
+                }
+                ioc_inode_unlock (ioc_inode);
+        }
+
+out:
+        ioc_table_lock (table);
+        {
+                table->revalidating = 0;
+                table->revalidated += valid;
+                table->revalidate_stale += stale;
+
+                more = table->revalidate_more;
+                table->revalidate_more = 0;
+        }
+        ioc_table_unlock (table);
+
+        bulkstat_locs_wipe (locs, GF_BULKSTAT_MAX_COUNT);
+        STACK_DESTROY (frame->root);
+
+        /* a failed batch waits for the timer, as would the next ones */
+        if (more && (op_ret >= 0))
+                ioc_revalidate_batch (this);
+
+        return 0;
+}
+
+static void
+ioc_revalidate_timer (void *data)
+{
+        xlator_t    *this  = NULL;
+        ioc_table_t *table = NULL;
+
+        this = data;
+        table = this->private;
+
+        ioc_table_lock (table);
+        {
+                if (table->revalidate_timer) {
+                        gf_timer_call_cancel (this->ctx,
+                                              table->revalidate_timer);
+                        table->revalidate_timer = NULL;
+                }
+
+                __ioc_revalidate_arm (table);
+        }
+        ioc_table_unlock (table);
+
+        ioc_revalidate_batch (this);
+}
+
+/* revalidates the next GF_BULKSTAT_MAX_COUNT inodes due, the ones taken
+   are marked as not accessed so that the next batch goes on past them */
+static void
+ioc_revalidate_batch (xlator_t *this)
+{
+        ioc_table_t   *table     = NULL;
+        ioc_inode_t   *ioc_inode = NULL;
+        inode_table_t *itable    = NULL;
+        inode_t       *inode     = NULL;
+        call_frame_t  *frame     = NULL;
+        loc_t         *locs      = NULL;
+        uuid_t        *gfids     = NULL;
+        struct timeval now       = {0, };
+        int32_t        interval  = 0;
+        int32_t        count     = 0;
+        int32_t        filled    = 0;
+        int32_t        i         = 0;
+        char           skip      = 0;
+
+        table = this->private;
+
+        gfids = GF_CALLOC (GF_BULKSTAT_MAX_COUNT, sizeof (*gfids),
+                           gf_common_mt_bulkstat_t);
+        locs = GF_CALLOC (GF_BULKSTAT_MAX_COUNT, sizeof (*locs),
+                          gf_common_mt_bulkstat_t);
+
+        gettimeofday (&now, NULL);
+
+        ioc_table_lock (table);
+        {
+                if (!gfids || !locs || table->revalidating
+                    || !table->bg_revalidate)
+                        goto unlock;
+
+                interval = ioc_revalidate_interval (table);
+
+                list_for_each_entry (ioc_inode, &table->inodes, inode_list) {
+                        if (!ioc_inode->accessed)
+                                continue;
+
+                        ioc_inode_lock (ioc_inode);
+                        {
+                                skip = (ioc_inode->waitq != NULL)
+                                        || list_empty (&ioc_inode->cache.page_lru)
+                                        || (time_elapsed (&now,
+                                                          &ioc_inode->cache.tv)
+                                            + interval < table->cache_timeout);
+                        }
+                        ioc_inode_unlock (ioc_inode);
+
+                        if (skip)
+                                continue;
+
+                        if (count == GF_BULKSTAT_MAX_COUNT) {
+                                table->revalidate_more = 1;
+                                break;
+                        }
+
+                        /* the inode itself is only referenced out of the
+                           table lock, through inode_find(): ioc_forget()
+                           may be waiting for this lock on a retired inode */
+                        ioc_inode->accessed = 0;
+                        itable = ioc_inode->inode->table;
+                        uuid_copy (gfids[count++], ioc_inode->inode->gfid);
+                }
+
+                if (count)
+                        table->revalidating = 1;
+        }
+unlock:
+        ioc_table_unlock (table);
+
+        for (i = 0; i < count; i++) {
+                inode = inode_find (itable, gfids[i]);
+                if (!inode)
+                        continue;
+
+                if (bulkstat_loc_fill (&locs[filled], inode) == 0)
+                        filled++;
+
+                inode_unref (inode);
+        }
+
+        if (count && filled)
+                frame = create_frame (this, this->ctx->pool);
+
+        if (!frame) {
+                if (count) {
+                        ioc_table_lock (table);
+                        {
+                                table->revalidating = 0;
+                                table->revalidate_more = 0;
+                        }
+                        ioc_table_unlock (table);
+                }
+                bulkstat_locs_wipe (locs, GF_BULKSTAT_MAX_COUNT);
+                goto out;
+        }
+
+        STACK_WIND_COOKIE (frame, ioc_revalidate_cbk, locs, FIRST_CHILD (this),
+                           FIRST_CHILD (this)->fops->bulkstat, locs, filled);
+out:
+        if (gfids)
+                GF_FREE (gfids);
+}
+
+/* assumes table is locked */
+static void
+__ioc_revalidate_stop (ioc_table_t *table)
+{
+        if (table->revalidate_timer) {
+                gf_timer_call_cancel (table->xl->ctx,
+                                      table->revalidate_timer);
+                table->revalidate_timer = NULL;
+        }
+}
+
+static int32_t
+ioc_policy_from_str (char *policy)
+{
+        if (policy && !strcasecmp (policy, "2q"))
+                return IOC_POLICY_2Q;
+
+        return IOC_POLICY_LRU;
+}
+
 int
 reconfigure (xlator_t *this, dict_t *options)
 {
@@ -1572,6 +2087,8 @@ reconfigure (xlator_t *this, dict_t *options)
         ioc_table_t *table             = NULL;
         int          ret               = -1;
         uint64_t      cache_size_new    = 0;
+        char        *policy            = NULL;
+
         if (!this || !this->private)
                 goto out;
 
@@ -1624,6 +2141,17 @@ reconfigure (xlator_t *this, dict_t *options)
                 }
                 table->cache_size = cache_size_new;
 
+                GF_OPTION_RECONF ("replacement-policy", policy, options, str,
+                                  unlock);
+                table->policy = ioc_policy_from_str (policy);
+
+                GF_OPTION_RECONF ("background-revalidate",
+                                  table->bg_revalidate, options, bool, unlock);
+                if (table->bg_revalidate)
+                        __ioc_revalidate_arm (table);
+                else
+                        __ioc_revalidate_stop (table);
+
                 ret = 0;
         }
 unlock:
@@ -1647,6 +2175,7 @@ init (xlator_t *this)
         int32_t          ret               = -1;
         glusterfs_ctx_t *ctx               = NULL;
         data_t          *data              = 0;
+        char            *policy            = NULL;
 
         xl_options = this->options;
 
@@ -1679,6 +2208,12 @@ init (xlator_t *this)
 
         GF_OPTION_INIT ("max-file-size", table->max_file_size, size, out);
 
+        GF_OPTION_INIT ("replacement-policy", policy, str, out);
+        table->policy = ioc_policy_from_str (policy);
+
+        GF_OPTION_INIT ("background-revalidate", table->bg_revalidate, bool,
+                        out);
+
         if  (!check_cache_size_ok (this, table->cache_size)) {
                 ret = -1;
                 goto out;
@@ -1722,8 +2257,30 @@ init (xlator_t *this)
         for (index = 0; index < (table->max_pri); index++)
                 INIT_LIST_HEAD (&table->inode_lru[index]);
 
+        for (index = 0; index < IOC_QUEUE_MAX; index++)
+                INIT_LIST_HEAD (&table->queues[index]);
+
+        INIT_LIST_HEAD (&table->ghosts);
+        table->ghost_hash = GF_CALLOC (IOC_GHOST_BUCKET_COUNT,
+                                       sizeof (struct list_head),
+                                       gf_ioc_mt_list_head);
+        if (table->ghost_hash == NULL) {
+                goto out;
+        }
+
+        for (index = 0; index < IOC_GHOST_BUCKET_COUNT; index++)
+                INIT_LIST_HEAD (&table->ghost_hash[index]);
+
         pthread_mutex_init (&table->table_lock, NULL);
+        pthread_mutex_init (&table->queue_lock, NULL);
         this->private = table;
+
+        ioc_table_lock (table);
+        {
+                __ioc_revalidate_arm (table);
+        }
+        ioc_table_unlock (table);
+
         ret = 0;
 
         ctx = this->ctx;
@@ -1733,6 +2290,7 @@ out:
         if (ret == -1) {
                 if (table != NULL) {
                         GF_FREE (table->inode_lru);
+                        GF_FREE (table->ghost_hash);
                         GF_FREE (table);
                 }
         }
@@ -1852,6 +2410,56 @@ out:
         return;
 }
 
+void
+ioc_queues_dump (ioc_table_t *table)
+{
+        static const char *names[IOC_QUEUE_MAX] = {
+                [IOC_QUEUE_IN]     = "in",
+                [IOC_QUEUE_MAIN]   = "main",
+                [IOC_QUEUE_PINNED] = "pinned",
+        };
+        char               key[GF_DUMP_MAX_BUF_LEN] = {0, };
+        uint64_t           lookups                  = 0;
+        int32_t            i                        = 0;
+
+        ioc_queue_lock (table);
+        {
+                lookups = table->misses;
+                for (i = IOC_QUEUE_IN; i < IOC_QUEUE_MAX; i++)
+                        lookups += table->hits[i];
+
+                gf_proc_dump_write ("replacement-policy", "%s",
+                                    (table->policy == IOC_POLICY_2Q) ?
+                                    "2q" : "lru");
+
+                for (i = IOC_QUEUE_IN; i < IOC_QUEUE_MAX; i++) {
+                        snprintf (key, sizeof (key), "queue.%s.pages",
+                                  names[i]);
+                        gf_proc_dump_write (key, "%"PRIu64,
+                                            table->queue_count[i]);
+
+                        snprintf (key, sizeof (key), "queue.%s.hits",
+                                  names[i]);
+                        gf_proc_dump_write (key, "%"PRIu64, table->hits[i]);
+
+                        snprintf (key, sizeof (key), "queue.%s.hit-ratio",
+                                  names[i]);
+                        gf_proc_dump_write (key, "%.2f%%", lookups ?
+                                            (100.0 * table->hits[i] / lookups)
+                                            : 0.0);
+                }
+
+                gf_proc_dump_write ("ghosts", "%"PRIu64, table->ghost_count);
+                gf_proc_dump_write ("ghost-hits", "%"PRIu64,
+                                    table->ghost_hits);
+                gf_proc_dump_write ("misses", "%"PRIu64, table->misses);
+                gf_proc_dump_write ("hit-ratio", "%.2f%%", lookups ?
+                                    (100.0 * (lookups - table->misses)
+                                     / lookups) : 0.0);
+        }
+        ioc_queue_unlock (table);
+}
+
 int
 ioc_priv_dump (xlator_t *this)
 {
@@ -1876,6 +2484,13 @@ ioc_priv_dump (xlator_t *this)
                 gf_proc_dump_write ("cache_timeout", "%u", priv->cache_timeout);
                 gf_proc_dump_write ("min-file-size", "%u", priv->min_file_size);
                 gf_proc_dump_write ("max-file-size", "%u", priv->max_file_size);
+                gf_proc_dump_write ("background-revalidate", "%s",
+                                    priv->bg_revalidate ? "on" : "off");
+                gf_proc_dump_write ("background-revalidated", "%"PRIu64,
+                                    priv->revalidated);
+                gf_proc_dump_write ("background-revalidate-stale", "%"PRIu64,
+                                    priv->revalidate_stale);
+                ioc_queues_dump (priv);
 
                 list_for_each_entry (ioc_inode, &priv->inodes, inode_list) {
                         ioc_inode_dump (ioc_inode, key_prefix);
@@ -1902,11 +2517,21 @@ fini (xlator_t *this)
         if (table == NULL)
                 return;
 
+        ioc_table_lock (table);
+        {
+                table->bg_revalidate = _gf_false;
+                __ioc_revalidate_stop (table);
+        }
+        ioc_table_unlock (table);
+
         if (table->mem_pool != NULL) {
                 mem_pool_destroy (table->mem_pool);
                 table->mem_pool = NULL;
         }
 
+        ioc_ghosts_destroy (table);
+
+        pthread_mutex_destroy (&table->queue_lock);
         pthread_mutex_destroy (&table->table_lock);
         GF_FREE (table);
 
@@ -1921,6 +2546,9 @@ struct xlator_fops fops = {
         .writev      = ioc_writev,
         .truncate    = ioc_truncate,
         .ftruncate   = ioc_ftruncate,
+        .fallocate   = ioc_fallocate,
+        .discard     = ioc_discard,
+        .zerofill    = ioc_zerofill,
         .lookup      = ioc_lookup,
         .lk          = ioc_lk,
         .setattr     = ioc_setattr,
@@ -1974,5 +2602,22 @@ struct volume_options options[] = {
           .description = "Maximum file size which would be cached by the "
           "io-cache translator."
         },
+        { .key  = {"replacement-policy"},
+          .type = GF_OPTION_TYPE_STR,
+          .value = {"lru", "2q"},
+          .default_value = "lru",
+          .description = "Policy used to eject pages when the cache is "
+          "full. 'lru' ejects whole files by least recent use and "
+          "priority, '2q' ejects single pages and keeps pages read "
+          "more than once safe from large sequential reads; pages of "
+          "files with a raised priority are ejected last."
+        },
+        { .key  = {"background-revalidate"},
+          .type = GF_OPTION_TYPE_BOOL,
+          .default_value = "off",
+          .description = "Revalidate the recently read files in the "
+          "background, in batches of one bulkstat call, before their "
+          "cache-timeout expires. Needs servers supporting bulkstat."
+        },
         { .key = {NULL} },
 };
@@ -36,12 +36,38 @@
 #include "call-stub.h"
 #include "rbthash.h"
 #include "hashfn.h"
+#include "timer.h"
 #include <sys/time.h>
 #include <fnmatch.h>
 
 #define IOC_PAGE_SIZE    (1024 * 128)   /* 128KB */
 #define IOC_CACHE_SIZE   (32 * 1024 * 1024)
 #define IOC_PAGE_TABLE_BUCKET_COUNT 1
+#define IOC_GHOST_BUCKET_COUNT      1024
+
+/* replacement policies, see ioc_prune */
+#define IOC_POLICY_LRU   0
+#define IOC_POLICY_2Q    1
+
+/*
+ * every page lives on one of these table wide queues, whatever the policy
+ * in use, so that the policy can be switched at runtime and the hit
+ * counters are always there to look at.
+ *
+ * IOC_QUEUE_IN:     pages referenced once so far, evicted in fifo order
+ * IOC_QUEUE_MAIN:   pages referenced again after having been evicted from
+ *                   IOC_QUEUE_IN (found in the ghost list), kept in lru
+ *                   order
+ * IOC_QUEUE_PINNED: pages of files with a priority above the lowest one,
+ *                   evicted only when nothing else is left
+ */
+enum ioc_queue {
+        IOC_QUEUE_NONE = 0,
+        IOC_QUEUE_IN,
+        IOC_QUEUE_MAIN,
+        IOC_QUEUE_PINNED,
+        IOC_QUEUE_MAX
+};
 
 struct ioc_table;
 struct ioc_local;
@@ -107,6 +133,9 @@ struct ioc_local {
         fd_t             *fd;
         int32_t          need_xattr;
         dict_t           *xattr_req;
+        struct iovec     *vector;        /* data of a write in progress */
+        int32_t          count;
+        struct iobref    *iobref;
 };
 
 /*
@@ -115,6 +144,8 @@ struct ioc_local {
  */
 struct ioc_page {
         struct list_head    page_lru;
+        struct list_head    page_queue; /* list in table->queues[queue] */
+        int32_t             queue;
         struct ioc_inode    *inode;   /* inode this page belongs to */
         struct ioc_priority *priority;
         char                dirty;
@@ -140,6 +171,10 @@ struct ioc_cache {
         struct timeval    tv;          /*
                                         * time-stamp at last re-validate
                                         */
+        char              own_write;   /*
+                                        * written through without the
+                                        * attributes of the write
+                                        */
 };
 
 struct ioc_inode {
@@ -157,9 +192,28 @@ struct ioc_inode {
                                              * weight of the inode, increases
                                              * on each read
                                              */
+        char                   accessed;    /*
+                                             * read since last background
+                                             * revalidation, under table lock
+                                             */
         inode_t               *inode;
 };
 
+/*
+ * ioc_ghost - remembers a page recently evicted from IOC_QUEUE_IN. only
+ *             the identity of the page is kept, not its data.
+ *
+ * @inode is used as a key only and never dereferenced; if the ioc_inode is
+ * freed and its address reused, the worst outcome is a page starting out
+ * in IOC_QUEUE_MAIN.
+ */
+struct ioc_ghost {
+        struct list_head  list;   /* fifo of all ghosts */
+        struct list_head  hash;   /* hash bucket chain */
+        void             *inode;
+        off_t             offset;
+};
+
 struct ioc_table {
         uint64_t         page_size;
         uint64_t         cache_size;
@@ -177,6 +231,22 @@ struct ioc_table {
         int32_t          cache_timeout;
         int32_t          max_pri;
         struct mem_pool  *mem_pool;
+        int32_t          policy;
+        pthread_mutex_t  queue_lock;  /* queues, ghosts and their stats */
+        struct list_head queues[IOC_QUEUE_MAX];
+        uint64_t         queue_count[IOC_QUEUE_MAX];
+        uint64_t         hits[IOC_QUEUE_MAX];
+        struct list_head ghosts;
+        struct list_head *ghost_hash;
+        uint64_t         ghost_count;
+        uint64_t         ghost_hits;
+        uint64_t         misses;
+        gf_boolean_t     bg_revalidate;
+        gf_timer_t      *revalidate_timer;
+        char             revalidating;  /* a bulkstat is in flight */
+        char             revalidate_more; /* and more inodes are due */
+        uint64_t         revalidated;   /* found valid in background */
+        uint64_t         revalidate_stale;
 };
 
 typedef struct ioc_table ioc_table_t;
@@ -185,6 +255,7 @@ typedef struct ioc_page ioc_page_t;
 typedef struct ioc_inode ioc_inode_t;
 typedef struct ioc_waitq ioc_waitq_t;
 typedef struct ioc_fill ioc_fill_t;
+typedef struct ioc_ghost ioc_ghost_t;
 
 void *
 str_to_ptr (char *string);
@@ -214,6 +285,9 @@ __ioc_wait_on_page (ioc_page_t *page, call_frame_t *frame, off_t offset,
 ioc_waitq_t *
 __ioc_page_wakeup (ioc_page_t *page);
 
+void
+__ioc_page_hit (ioc_page_t *page);
+
 void
 ioc_page_flush (ioc_page_t *page);
 
@@ -262,6 +336,18 @@ ioc_frame_fill (ioc_page_t *page, call_frame_t *frame, off_t offset,
         } while (0)
 
 
+#define ioc_queue_lock(table)                                   \
+        do {                                                    \
+                pthread_mutex_lock (&table->queue_lock);        \
+        } while (0)
+
+
+#define ioc_queue_unlock(table)                                 \
+        do {                                                    \
+                pthread_mutex_unlock (&table->queue_lock);      \
+        } while (0)
+
+
 #define ioc_local_lock(local)                                           \
         do {                                                            \
                 gf_log (local->inode->table->xl->name, GF_LOG_TRACE,    \
@@ -321,6 +407,18 @@ __ioc_page_destroy (ioc_page_t *page);
 int64_t
 __ioc_inode_flush (ioc_inode_t *ioc_inode);
 
+int32_t
+__ioc_page_write (ioc_page_t *page, struct iovec *vector, int32_t count,
+                  off_t offset, size_t size, int64_t *size_delta);
+
+void
+ioc_inode_write (ioc_inode_t *ioc_inode, struct iovec *vector, int32_t count,
+                 off_t offset, size_t size, struct iatt *prebuf,
+                 struct iatt *postbuf);
+
+char
+ioc_empty (struct ioc_cache *cache);
+
 void
 ioc_inode_flush (ioc_inode_t *ioc_inode);
 
@@ -331,9 +429,15 @@ ioc_inode_wakeup (call_frame_t *frame, ioc_inode_t *ioc_inode,
 int8_t
 ioc_cache_still_valid (ioc_inode_t *ioc_inode, struct iatt *stbuf);
 
+void
+__ioc_cache_own_write (ioc_inode_t *ioc_inode, struct iatt *stbuf);
+
 int32_t
 ioc_prune (ioc_table_t *table);
 
+void
+ioc_ghosts_destroy (ioc_table_t *table);
+
 int32_t
 ioc_need_prune (ioc_table_t *table);
 
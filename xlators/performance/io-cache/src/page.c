@@ -92,6 +92,196 @@ out:
 }
 
 
+static inline struct list_head *
+ioc_ghost_bucket (ioc_table_t *table, void *inode, off_t offset)
+{
+        uint64_t hash = 0;
+
+        hash = ((unsigned long) inode >> 4) ^ (offset / table->page_size);
+
+        return &table->ghost_hash[hash % IOC_GHOST_BUCKET_COUNT];
+}
+
+
+/*
+ * __ioc_ghost_remove - look the page up in the ghost list and forget it.
+ *
+ * returns 1 if the page was a ghost. assumes queue_lock is held
+ */
+static int32_t
+__ioc_ghost_remove (ioc_table_t *table, void *inode, off_t offset)
+{
+        struct list_head *bucket = NULL;
+        ioc_ghost_t      *ghost  = NULL;
+
+        if (table->ghost_hash == NULL)
+                return 0;
+
+        bucket = ioc_ghost_bucket (table, inode, offset);
+
+        list_for_each_entry (ghost, bucket, hash) {
+                if ((ghost->inode == inode) && (ghost->offset == offset)) {
+                        list_del (&ghost->hash);
+                        list_del (&ghost->list);
+                        table->ghost_count--;
+                        GF_FREE (ghost);
+                        return 1;
+                }
+        }
+
+        return 0;
+}
+
+
+/*
+ * __ioc_ghost_add - remember a page evicted from IOC_QUEUE_IN. the ghost
+ *                   list holds as many entries as half the pages fitting
+ *                   in the cache, the oldest ghost making room for a new
+ *                   one.
+ *
+ * assumes queue_lock is held
+ */
+static void
+__ioc_ghost_add (ioc_table_t *table, void *inode, off_t offset)
+{
+        ioc_ghost_t *ghost      = NULL;
+        uint64_t     max_ghosts = 0;
+
+        if (table->ghost_hash == NULL)
+                return;
+
+        max_ghosts = (table->cache_size / table->page_size) / 2;
+        if (max_ghosts == 0)
+                return;
+
+        if (table->ghost_count >= max_ghosts) {
+                ghost = list_entry (table->ghosts.next, ioc_ghost_t, list);
+                list_del (&ghost->hash);
+                list_del (&ghost->list);
+                table->ghost_count--;
+        } else {
+                ghost = GF_CALLOC (1, sizeof (*ghost), gf_ioc_mt_ioc_ghost_t);
+                if (ghost == NULL)
+                        return;
+        }
+
+        ghost->inode = inode;
+        ghost->offset = offset;
+
+        list_add_tail (&ghost->list, &table->ghosts);
+        list_add (&ghost->hash, ioc_ghost_bucket (table, inode, offset));
+        table->ghost_count++;
+}
+
+
+void
+ioc_ghosts_destroy (ioc_table_t *table)
+{
+        ioc_ghost_t *ghost = NULL, *tmp = NULL;
+
+        ioc_queue_lock (table);
+        {
+                list_for_each_entry_safe (ghost, tmp, &table->ghosts, list) {
+                        list_del (&ghost->list);
+                        GF_FREE (ghost);
+                }
+
+                table->ghost_count = 0;
+                GF_FREE (table->ghost_hash);
+                table->ghost_hash = NULL;
+        }
+        ioc_queue_unlock (table);
+}
+
+
+/*
+ * __ioc_page_enqueue - put a newly created page on its queue: pinned if the
+ *                      file has a raised priority, main if it was evicted
+ *                      from the in queue recently, the in queue otherwise.
+ *
+ * assumes ioc_inode is locked
+ */
+static void
+__ioc_page_enqueue (ioc_page_t *page)
+{
+        ioc_table_t *table = NULL;
+        int32_t      queue = IOC_QUEUE_IN;
+
+        table = page->inode->table;
+
+        ioc_queue_lock (table);
+        {
+                table->misses++;
+
+                if (page->inode->weight > 1) {
+                        queue = IOC_QUEUE_PINNED;
+                        __ioc_ghost_remove (table, page->inode, page->offset);
+                } else if (__ioc_ghost_remove (table, page->inode,
+                                               page->offset)) {
+                        table->ghost_hits++;
+                        queue = IOC_QUEUE_MAIN;
+                }
+
+                page->queue = queue;
+                list_add_tail (&page->page_queue, &table->queues[queue]);
+                table->queue_count[queue]++;
+        }
+        ioc_queue_unlock (table);
+}
+
+
+static void
+__ioc_page_dequeue (ioc_page_t *page)
+{
+        ioc_table_t *table = NULL;
+
+        if (page->queue == IOC_QUEUE_NONE)
+                return;
+
+        table = page->inode->table;
+
+        ioc_queue_lock (table);
+        {
+                list_del_init (&page->page_queue);
+                table->queue_count[page->queue]--;
+                page->queue = IOC_QUEUE_NONE;
+        }
+        ioc_queue_unlock (table);
+}
+
+
+/*
+ * __ioc_page_hit - account a read served from a cached page. pages in the
+ *                  in queue stay where they are, so that a burst of reads
+ *                  of the same page does not promote it.
+ *
+ * assumes ioc_inode is locked
+ */
+void
+__ioc_page_hit (ioc_page_t *page)
+{
+        ioc_table_t *table = NULL;
+
+        GF_VALIDATE_OR_GOTO ("io-cache", page, out);
+
+        table = page->inode->table;
+
+        ioc_queue_lock (table);
+        {
+                table->hits[page->queue]++;
+
+                if ((page->queue == IOC_QUEUE_MAIN)
+                    || (page->queue == IOC_QUEUE_PINNED))
+                        list_move_tail (&page->page_queue,
+                                        &table->queues[page->queue]);
+        }
+        ioc_queue_unlock (table);
+
+out:
+        return;
+}
+
+
 /*
  * __ioc_page_destroy -
  *
@@ -115,6 +305,7 @@ __ioc_page_destroy (ioc_page_t *page)
                 rbthash_remove (page->inode->cache.page_table, &page->offset,
                                 sizeof (page->offset));
                 list_del (&page->page_lru);
+                __ioc_page_dequeue (page);
 
                 gf_log (page->inode->table->xl->name, GF_LOG_TRACE,
                         "destroying page = %p, offset = %"PRId64" "
@@ -159,6 +350,111 @@ out:
         return ret;
 }
 
+
+/*
+ * __ioc_page_write - replace the contents of a cached page with the part of
+ *                    a write covering it. the page may already be shared
+ *                    with replies in flight, so the data goes into a fresh
+ *                    iobuf instead of being copied over the old one.
+ *
+ * @page: page fully covered by the write
+ * @vector, @count, @offset, @size: the data written
+ * @size_delta: change in the memory accounted to the page
+ *
+ * assumes ioc_inode is locked
+ */
+int32_t
+__ioc_page_write (ioc_page_t *page, struct iovec *vector, int32_t count,
+                  off_t offset, size_t size, int64_t *size_delta)
+{
+        ioc_table_t   *table  = NULL;
+        struct iobuf  *iobuf  = NULL;
+        struct iobref *iobref = NULL;
+        struct iovec  *newvec = NULL;
+        size_t         length = 0;
+        size_t         skip   = 0;
+        size_t         copied = 0;
+        size_t         len    = 0;
+        int32_t        i      = 0;
+        int32_t        ret    = -1;
+
+        GF_VALIDATE_OR_GOTO ("io-cache", page, out);
+
+        table = page->inode->table;
+
+        /* a short page at the end of file grows with the write */
+        length = min (offset + size - page->offset, table->page_size);
+        skip = page->offset - offset;
+
+        iobuf = iobuf_get2 (table->xl->ctx->iobuf_pool, length);
+        if (iobuf == NULL) {
+                goto out;
+        }
+
+        iobref = iobref_new ();
+        if (iobref == NULL) {
+                goto out;
+        }
+
+        newvec = GF_CALLOC (1, sizeof (*newvec), gf_common_mt_iovec);
+        if (newvec == NULL) {
+                goto out;
+        }
+
+        iobref_add (iobref, iobuf);
+
+        for (i = 0; (i < count) && (copied < length); i++) {
+                if (skip >= vector[i].iov_len) {
+                        skip -= vector[i].iov_len;
+                        continue;
+                }
+
+                len = min (vector[i].iov_len - skip, length - copied);
+                memcpy (iobuf->ptr + copied, vector[i].iov_base + skip, len);
+
+                copied += len;
+                skip = 0;
+        }
+
+        newvec->iov_base = iobuf->ptr;
+        newvec->iov_len = length;
+
+        *size_delta = iobref_size (iobref);
+        if (page->vector) {
+                *size_delta -= iobref_size (page->iobref);
+                iobref_unref (page->iobref);
+                GF_FREE (page->vector);
+        }
+
+        page->vector = newvec;
+        page->count = 1;
+        page->iobref = iobref;
+        page->size = length;
+
+        gf_log (table->xl->name, GF_LOG_TRACE,
+                "wrote through page = %p, offset = %"PRId64" "
+                "&& size = %"GF_PRI_SIZET, page, page->offset, page->size);
+
+        iobref = NULL;
+        newvec = NULL;
+        ret = 0;
+
+out:
+        if (iobuf) {
+                iobuf_unref (iobuf);
+        }
+
+        if (iobref) {
+                iobref_unref (iobref);
+        }
+
+        if (newvec) {
+                GF_FREE (newvec);
+        }
+
+        return ret;
+}
+
 int32_t
 __ioc_inode_prune (ioc_inode_t *curr, uint64_t *size_pruned,
                    uint64_t size_to_prune, uint32_t index)
@@ -196,6 +492,116 @@ __ioc_inode_prune (ioc_inode_t *curr, uint64_t *size_pruned,
 out:
         return 0;
 }
+
+/*
+ * __ioc_queue_victim - first page of the queue that can be evicted right
+ *                      now. pages being faulted in or with frames waiting
+ *                      on them are skipped, and so are pages whose inode is
+ *                      busy: inode locks are taken before queue_lock
+ *                      everywhere else.
+ *
+ * returns the page with its inode locked. assumes queue_lock is held
+ */
+static ioc_page_t *
+__ioc_queue_victim (ioc_table_t *table, int32_t queue)
+{
+        ioc_page_t *page = NULL;
+
+        list_for_each_entry (page, &table->queues[queue], page_queue) {
+                if (!page->vector || page->waitq)
+                        continue;
+
+                if (pthread_mutex_trylock (&page->inode->inode_lock) != 0)
+                        continue;
+
+                if (!page->waitq)
+                        return page;
+
+                pthread_mutex_unlock (&page->inode->inode_lock);
+        }
+
+        return NULL;
+}
+
+
+/*
+ * ioc_prune_2q - 2Q replacement across all cached pages. pages read once
+ *                (a backup or any other big sequential read) pass through
+ *                the in queue and leave only a ghost behind; a page has to
+ *                be read again while its ghost is around to make it to the
+ *                main queue, which the in queue never evicts from unless it
+ *                has shrunk below a quarter of the cache. pinned pages go
+ *                last.
+ *
+ * @table: ioc_table_t of this translator
+ */
+static int32_t
+ioc_prune_2q (ioc_table_t *table)
+{
+        ioc_page_t  *page          = NULL;
+        ioc_inode_t *ioc_inode     = NULL;
+        uint64_t     size_to_prune = 0;
+        uint64_t     size_pruned   = 0;
+        uint64_t     in_max        = 0;
+        int64_t      ret           = 0;
+
+        ioc_table_lock (table);
+        {
+                size_to_prune = table->cache_used - table->cache_size;
+                in_max = (table->cache_size / table->page_size) / 4;
+
+                while (size_pruned < size_to_prune) {
+                        page = NULL;
+
+                        ioc_queue_lock (table);
+                        {
+                                if (table->queue_count[IOC_QUEUE_IN] > in_max)
+                                        page = __ioc_queue_victim (table,
+                                                                   IOC_QUEUE_IN);
+                                if (!page)
+                                        page = __ioc_queue_victim (table,
+                                                                   IOC_QUEUE_MAIN);
+                                if (!page)
+                                        page = __ioc_queue_victim (table,
+                                                                   IOC_QUEUE_IN);
+                                if (!page)
+                                        page = __ioc_queue_victim (table,
+                                                                   IOC_QUEUE_PINNED);
+
+                                if (page && (page->queue == IOC_QUEUE_IN))
+                                        __ioc_ghost_add (table, page->inode,
+                                                         page->offset);
+                        }
+                        ioc_queue_unlock (table);
+
+                        if (page == NULL)
+                                break;
+
+                        /* the inode was locked by __ioc_queue_victim */
+                        ioc_inode = page->inode;
+                        {
+                                ret = __ioc_page_destroy (page);
+                                if (ret != -1) {
+                                        table->cache_used -= ret;
+                                        size_pruned += ret;
+                                }
+
+                                if (ioc_empty (&ioc_inode->cache)) {
+                                        list_del_init (&ioc_inode->inode_lru);
+                                }
+                        }
+                        ioc_inode_unlock (ioc_inode);
+
+                        if (ret <= 0)
+                                break;
+                }
+        }
+        ioc_table_unlock (table);
+
+        return 0;
+}
+
+
 /*
  * ioc_prune - prune the cache. we have a limit to the number of pages we
  *             can have in-memory.
@@ -213,6 +619,11 @@ ioc_prune (ioc_table_t *table)
 
         GF_VALIDATE_OR_GOTO ("io-cache", table, out);
 
+        if (table->policy == IOC_POLICY_2Q) {
+                ioc_prune_2q (table);
+                goto out;
+        }
+
         ioc_table_lock (table);
         {
                 size_to_prune = table->cache_used - table->cache_size;
@@ -288,6 +699,9 @@ __ioc_page_create (ioc_inode_t *ioc_inode, off_t offset)
 
         list_add_tail (&newpage->page_lru, &ioc_inode->cache.page_lru);
 
+        INIT_LIST_HEAD (&newpage->page_queue);
+        __ioc_page_enqueue (newpage);
+
         page = newpage;
 
         gf_log ("io-cache", GF_LOG_TRACE,
@@ -355,6 +769,35 @@ out:
 }
 
 
+/*
+ * __ioc_cache_own_write - take in the mtime changed by our own writes
+ *
+ * writes which came back without attributes (write-behind unwinding early)
+ * went through the cached pages, but their mtime is not known till the
+ * next reply from the server. the first changed mtime seen after them is
+ * taken as theirs instead of flushing the pages. a change from another
+ * client in the same window goes unnoticed, as it does for the data held
+ * by write-behind; a write of ours landing after that mtime was taken
+ * flushes the pages at the following check, as before.
+ *
+ * assumes ioc_inode is locked
+ */
+void
+__ioc_cache_own_write (ioc_inode_t *ioc_inode, struct iatt *stbuf)
+{
+        if (!ioc_inode->cache.own_write || !stbuf || !stbuf->ia_mtime)
+                return;
+
+        if ((stbuf->ia_mtime == ioc_inode->cache.mtime)
+            && (stbuf->ia_mtime_nsec == ioc_inode->cache.mtime_nsec))
+                return;
+
+        ioc_inode->cache.mtime = stbuf->ia_mtime;
+        ioc_inode->cache.mtime_nsec = stbuf->ia_mtime_nsec;
+        ioc_inode->cache.own_write = 0;
+}
+
+
 /*
  * ioc_cache_still_valid - see if cached pages ioc_inode are still valid
  * against given stbuf
@@ -445,6 +888,9 @@ ioc_fault_cbk (call_frame_t *frame, void *cookie, xlator_t *this,
 
         ioc_inode_lock (ioc_inode);
         {
+                if ((op_ret >= 0) && !zero_filled)
+                        __ioc_cache_own_write (ioc_inode, stbuf);
+
                 if (op_ret == -1 || !(zero_filled ||
                                       ioc_cache_still_valid(ioc_inode,
                                                             stbuf))) {
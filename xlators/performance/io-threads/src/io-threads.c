@@ -32,25 +32,58 @@
 #include <sys/time.h>
 #include <time.h>
 #include "locking.h"
+#include "statedump.h"
+#include "hashfn.h"
 
 void *iot_worker (void *arg);
 int iot_workers_scale (iot_conf_t *conf);
 int __iot_workers_scale (iot_conf_t *conf);
 struct volume_options options[];
 
+#define IOT_PICK_SCAN   8       /* queues looked at to place a request */
+
+
+static inline uint64_t
+iot_usecs_since (struct timeval *then, struct timeval *now)
+{
+        if (timercmp (now, then, <))
+                return 0;
+
+        return ((now->tv_sec - then->tv_sec) * 1000000ULL)
+                + now->tv_usec - then->tv_usec;
+}
+
+
+/* takes a request of the highest priority allowed to run more of, off the
+   queue of worker */
 call_stub_t *
-__iot_dequeue (iot_conf_t *conf, int *pri)
+__iot_dequeue (iot_worker_t *worker, int *pri)
 {
+        iot_conf_t   *conf = NULL;
         call_stub_t  *stub = NULL;
+        int           allowed = 0;
         int           i = 0;
 
+        conf = worker->conf;
+
         *pri = -1;
         for (i = 0; i < IOT_PRI_MAX; i++) {
-                if (list_empty (&conf->reqs[i]) ||
-                   (conf->ac_iot_count[i] >= conf->ac_iot_limit[i]))
+                if (list_empty (&worker->reqs[i]))
                         continue;
-                stub = list_entry (conf->reqs[i].next, call_stub_t, list);
-                conf->ac_iot_count[i]++;
+
+                LOCK (&conf->ac_lock);
+                {
+                        allowed = (conf->ac_iot_count[i]
+                                   < conf->ac_iot_limit[i]);
+                        if (allowed)
+                                conf->ac_iot_count[i]++;
+                }
+                UNLOCK (&conf->ac_lock);
+
+                if (!allowed)
+                        continue;
+
+                stub = list_entry (worker->reqs[i].next, call_stub_t, list);
                 *pri = i;
                 break;
         }
@@ -58,7 +91,7 @@ __iot_dequeue (iot_conf_t *conf, int *pri)
         if (!stub)
                 return NULL;
 
-        conf->queue_size--;
+        worker->queue_size--;
         list_del_init (&stub->list);
 
         return stub;
@@ -66,106 +99,429 @@ __iot_dequeue (iot_conf_t *conf, int *pri)
 
 
 void
-__iot_enqueue (iot_conf_t *conf, call_stub_t *stub, int pri)
+__iot_enqueue (iot_worker_t *worker, call_stub_t *stub, int pri)
 {
         if (pri < 0 || pri >= IOT_PRI_MAX)
                 pri = IOT_PRI_MAX-1;
 
-        list_add_tail (&stub->list, &conf->reqs[pri]);
+        list_add_tail (&stub->list, &worker->reqs[pri]);
 
-        conf->queue_size++;
+        worker->queue_size++;
+        worker->seq++;
 
         return;
 }
 
 
+/* looks for work in the queues of the other workers */
+static call_stub_t *
+iot_steal (iot_conf_t *conf, iot_worker_t *self, int *pri)
+{
+        iot_worker_t *victim = NULL;
+        call_stub_t  *stub = NULL;
+        int32_t       count = 0;
+        int32_t       i = 0;
+
+        count = conf->slot_count;
+
+        for (i = 1; i < count; i++) {
+                victim = &conf->workers[(self->index + i) % count];
+
+                /* unlocked peek, a miss is caught up by the next round */
+                if (!victim->queue_size)
+                        continue;
+
+                /* with inode-affinity, only relieve workers that are
+                   overloaded, or sleeping on requests over their limit */
+                if (conf->affinity && !victim->sleeping
+                    && (victim->queue_size <= conf->affinity_overflow))
+                        continue;
+
+                pthread_mutex_lock (&victim->mutex);
+                {
+                        stub = __iot_dequeue (victim, pri);
+                }
+                pthread_mutex_unlock (&victim->mutex);
+
+                if (stub) {
+                        LOCK (&conf->ac_lock);
+                        {
+                                conf->stolen++;
+                        }
+                        UNLOCK (&conf->ac_lock);
+                        break;
+                }
+        }
+
+        return stub;
+}
+
+
+static void
+iot_account_wait (iot_conf_t *conf, int pri, call_stub_t *stub,
+                  struct timeval *now)
+{
+        uint64_t wait = 0;
+        int      bucket = 0;
+
+        wait = iot_usecs_since (&stub->queued, now);
+        if (wait)
+                bucket = min (log_base2 (wait) + 1, IOT_WAIT_BUCKETS - 1);
+
+        LOCK (&conf->ac_lock);
+        {
+                conf->wait[pri].count++;
+                conf->wait[pri].total += wait;
+                conf->wait[pri].buckets[bucket]++;
+                conf->interval_wait += wait;
+        }
+        UNLOCK (&conf->ac_lock);
+}
+
+
+static void
+iot_account_done (iot_conf_t *conf, int pri, struct timeval *started)
+{
+        struct timeval now = {0, };
+
+        gettimeofday (&now, NULL);
+
+        LOCK (&conf->ac_lock);
+        {
+                conf->ac_iot_count[pri]--;
+                conf->interval_svc += iot_usecs_since (started, &now);
+                conf->interval_count++;
+        }
+        UNLOCK (&conf->ac_lock);
+}
+
+
+/* returns 1 if the worker may go, its slot being given up */
+static int
+iot_worker_exit (iot_worker_t *worker)
+{
+        iot_conf_t *conf = NULL;
+        int         bye = 0;
+
+        conf = worker->conf;
+
+        pthread_mutex_lock (&conf->mutex);
+        {
+                if (conf->curr_count <= IOT_MIN_THREADS)
+                        goto unlock;
+
+                pthread_mutex_lock (&worker->mutex);
+                {
+                        if (worker->queue_size == 0) {
+                                worker->running = 0;
+                                bye = 1;
+                        }
+                }
+                pthread_mutex_unlock (&worker->mutex);
+
+                if (bye) {
+                        conf->curr_count--;
+                        gf_log (conf->this->name, GF_LOG_DEBUG,
+                                "timeout, terminated. conf->curr_count=%d",
+                                conf->curr_count);
+                }
+        }
+unlock:
+        pthread_mutex_unlock (&conf->mutex);
+
+        return bye;
+}
+
+
 void *
 iot_worker (void *data)
 {
+        iot_worker_t     *worker = NULL;
         iot_conf_t       *conf = NULL;
         xlator_t         *this = NULL;
         call_stub_t      *stub = NULL;
         struct timespec   sleep_till = {0, };
+        struct timeval    started = {0, };
         int               ret = 0;
         int               pri = -1;
-        char              timeout = 0;
-        char              bye = 0;
+        uint32_t          seq = 0;
+        char              pending = 0;
 
-        conf = data;
+        worker = data;
+        conf = worker->conf;
         this = conf->this;
         THIS = this;
 
         for (;;) {
-                sleep_till.tv_sec = time (NULL) + conf->idle_time;
+                if (pri != -1) {
+                        iot_account_done (conf, pri, &started);
+                        pri = -1;
+                }
 
-                pthread_mutex_lock (&conf->mutex);
+                pthread_mutex_lock (&worker->mutex);
                 {
-                        if (pri != -1) {
-                                conf->ac_iot_count[pri]--;
-                                pri = -1;
-                        }
-                        while (conf->queue_size == 0) {
-                                conf->sleep_count++;
+                        stub = __iot_dequeue (worker, &pri);
+                        seq = worker->seq;
+                }
+                pthread_mutex_unlock (&worker->mutex);
 
-                                ret = pthread_cond_timedwait (&conf->cond,
-                                                              &conf->mutex,
-                                                              &sleep_till);
-                                conf->sleep_count--;
+                if (!stub)
+                        stub = iot_steal (conf, worker, &pri);
 
-                                if (ret == ETIMEDOUT) {
-                                        timeout = 1;
-                                        break;
-                                }
-                        }
+                if (stub) {
+                        gettimeofday (&started, NULL);
+                        iot_account_wait (conf, pri, stub, &started);
 
-                        if (timeout) {
-                                if (conf->curr_count > IOT_MIN_THREADS) {
-                                        conf->curr_count--;
-                                        bye = 1;
-                                        gf_log (conf->this->name, GF_LOG_DEBUG,
-                                                "timeout, terminated. conf->curr_count=%d",
-                                                conf->curr_count);
-                                } else {
-                                        timeout = 0;
-                                }
+                        call_resume (stub);
+                        continue;
+                }
+
+                ret = 0;
+                pthread_mutex_lock (&worker->mutex);
+                {
+                        /* queued to while we were stealing */
+                        if (worker->seq != seq) {
+                                pthread_mutex_unlock (&worker->mutex);
+                                continue;
                         }
 
-                        stub = __iot_dequeue (conf, &pri);
-                }
-                pthread_mutex_unlock (&conf->mutex);
+                        /* requests over their priority limit are left in
+                           the queue, and are taken by the worker freeing
+                           the limit. wake up now and then anyway. */
+                        pending = (worker->queue_size != 0);
+                        sleep_till.tv_sec = time (NULL)
+                                + (pending ? 1 : conf->idle_time);
 
-                if (stub) /* guard against spurious wakeups */
-                        call_resume (stub);
+                        worker->sleeping = 1;
+                        ret = pthread_cond_timedwait (&worker->cond,
+                                                      &worker->mutex,
+                                                      &sleep_till);
+                        worker->sleeping = 0;
 
-                if (bye)
+                        pending = (worker->queue_size != 0);
+                }
+                pthread_mutex_unlock (&worker->mutex);
+
+                if ((ret == ETIMEDOUT) && !pending
+                    && iot_worker_exit (worker))
                         break;
         }
 
-        if (pri != -1) {
-                pthread_mutex_lock (&conf->mutex);
+        return NULL;
+}
+
+
+/* a sleeping worker if one is found among a few, else the least loaded of
+   them. unlocked peeks, do_iot_schedule checks the choice under lock. */
+static iot_worker_t *
+iot_pick_worker (iot_conf_t *conf)
+{
+        iot_worker_t *worker = NULL;
+        iot_worker_t *best = NULL;
+        int32_t       count = 0;
+        int32_t       start = 0;
+        int32_t       seen = 0;
+        int32_t       i = 0;
+
+        count = conf->slot_count;
+        start = conf->next_worker++ % count;
+
+        for (i = 0; (i < count) && (seen < IOT_PICK_SCAN); i++) {
+                worker = &conf->workers[(start + i) % count];
+                if (!worker->running)
+                        continue;
+
+                if (worker->sleeping && !worker->queue_size)
+                        return worker;
+
+                if (!best || (worker->queue_size < best->queue_size))
+                        best = worker;
+                seen++;
+        }
+
+        return best;
+}
+
+
+/* the inode an fd or inode scoped fop works on */
+static inode_t *
+iot_stub_inode (call_stub_t *stub)
+{
+        fd_t    *fd = NULL;
+        loc_t   *loc = NULL;
+
+        switch (stub->fop) {
+        case GF_FOP_READ:
+                fd = stub->args.readv.fd;
+                break;
+        case GF_FOP_WRITE:
+                fd = stub->args.writev.fd;
+                break;
+        case GF_FOP_FLUSH:
+                fd = stub->args.flush.fd;
+                break;
+        case GF_FOP_FSYNC:
+                fd = stub->args.fsync.fd;
+                break;
+        case GF_FOP_FSTAT:
+                fd = stub->args.fstat.fd;
+                break;
+        case GF_FOP_FTRUNCATE:
+                fd = stub->args.ftruncate.fd;
+                break;
+        case GF_FOP_FALLOCATE:
+                fd = stub->args.fallocate.fd;
+                break;
+        case GF_FOP_DISCARD:
+                fd = stub->args.discard.fd;
+                break;
+        case GF_FOP_ZEROFILL:
+                fd = stub->args.zerofill.fd;
+                break;
+        case GF_FOP_SEEK:
+                fd = stub->args.seek.fd;
+                break;
+        case GF_FOP_FSETATTR:
+                fd = stub->args.fsetattr.fd;
+                break;
+        case GF_FOP_FXATTROP:
+                fd = stub->args.fxattrop.fd;
+                break;
+        case GF_FOP_FINODELK:
+                fd = stub->args.finodelk.fd;
+                break;
+        case GF_FOP_FGETXATTR:
+                fd = stub->args.fgetxattr.fd;
+                break;
+        case GF_FOP_FSETXATTR:
+                fd = stub->args.fsetxattr.fd;
+                break;
+        case GF_FOP_LK:
+                fd = stub->args.lk.fd;
+                break;
+        case GF_FOP_RCHECKSUM:
+                fd = stub->args.rchecksum.fd;
+                break;
+        case GF_FOP_STAT:
+                loc = &stub->args.stat.loc;
+                break;
+        case GF_FOP_TRUNCATE:
+                loc = &stub->args.truncate.loc;
+                break;
+        case GF_FOP_SETATTR:
+                loc = &stub->args.setattr.loc;
+                break;
+        case GF_FOP_XATTROP:
+                loc = &stub->args.xattrop.loc;
+                break;
+        case GF_FOP_INODELK:
+                loc = &stub->args.inodelk.loc;
+                break;
+        case GF_FOP_GETXATTR:
+                loc = &stub->args.getxattr.loc;
+                break;
+        case GF_FOP_SETXATTR:
+                loc = &stub->args.setxattr.loc;
+                break;
+        case GF_FOP_REMOVEXATTR:
+                loc = &stub->args.removexattr.loc;
+                break;
+        case GF_FOP_OPEN:
+                loc = &stub->args.open.loc;
+                break;
+        default:
+                break;
+        }
+
+        if (fd)
+                return fd->inode;
+
+        if (loc)
+                return loc->inode;
+
+        return NULL;
+}
+
+
+/*
+ * iot_pick_home - with inode-affinity, requests on an inode go to the
+ * worker its gfid hashes to, so that they do not contend with each other
+ * in the backend and find its data in the caches of the same CPU. They
+ * overflow to the other workers when that one has too much queued and
+ * some other is sleeping. The mapping changes when threads are added
+ * to or removed from the slots it is taken over.
+ */
+static iot_worker_t *
+iot_pick_home (iot_conf_t *conf, call_stub_t *stub)
+{
+        iot_worker_t *worker = NULL;
+        iot_worker_t *other = NULL;
+        inode_t      *inode = NULL;
+        uint32_t      hash = 0;
+
+        inode = iot_stub_inode (stub);
+        if (!inode || uuid_is_null (inode->gfid))
+                return NULL;
+
+        hash = SuperFastHash ((char *)inode->gfid, sizeof (inode->gfid));
+        worker = &conf->workers[hash % conf->slot_count];
+        if (!worker->running)
+                return NULL;
+
+        if (worker->queue_size <= conf->affinity_overflow)
+                return worker;
+
+        other = iot_pick_worker (conf);
+        if (other && other->sleeping) {
+                LOCK (&conf->ac_lock);
                 {
-                        conf->ac_iot_count[pri]--;
+                        conf->affinity_overflows++;
                 }
-                pthread_mutex_unlock (&conf->mutex);
+                UNLOCK (&conf->ac_lock);
+                return other;
         }
-        return NULL;
+
+        return worker;
 }
 
 
 int
 do_iot_schedule (iot_conf_t *conf, call_stub_t *stub, int pri)
 {
-        int   ret = 0;
+        iot_worker_t *worker = NULL;
+        int           ret = 0;
+        char          queued = 0;
+        char          idle = 0;
 
-        pthread_mutex_lock (&conf->mutex);
-        {
-                __iot_enqueue (conf, stub, pri);
+        gettimeofday (&stub->queued, NULL);
 
-                pthread_cond_signal (&conf->cond);
+        while (!queued) {
+                worker = NULL;
+                if (conf->affinity)
+                        worker = iot_pick_home (conf, stub);
+                if (!worker)
+                        worker = iot_pick_worker (conf);
+                if (!worker)
+                        continue;
 
-                ret = __iot_workers_scale (conf);
+                pthread_mutex_lock (&worker->mutex);
+                {
+                        if (worker->running) {
+                                __iot_enqueue (worker, stub, pri);
+                                idle = worker->sleeping;
+                                pthread_cond_signal (&worker->cond);
+                                queued = 1;
+                        }
+                }
+                pthread_mutex_unlock (&worker->mutex);
+        }
+
+        /* no need to look at scaling while there are idle threads, nor to
+           wait for another thread doing it */
+        if (!idle && (pthread_mutex_trylock (&conf->mutex) == 0)) {
+                __iot_workers_scale (conf);
+                pthread_mutex_unlock (&conf->mutex);
         }
-        pthread_mutex_unlock (&conf->mutex);
 
         return ret;
 }
@@ -240,6 +596,7 @@ iot_schedule (call_frame_t *frame, xlator_t *this, call_stub_t *stub)
         case GF_FOP_FGETXATTR:
         case GF_FOP_FSETXATTR:
         case GF_FOP_REMOVEXATTR:
+        case GF_FOP_SEEK:
                 pri = IOT_PRI_NORMAL;
                 break;
 
@@ -251,6 +608,10 @@ iot_schedule (call_frame_t *frame, xlator_t *this, call_stub_t *stub)
         case GF_FOP_FSYNCDIR:
         case GF_FOP_XATTROP:
         case GF_FOP_FXATTROP:
+        case GF_FOP_BULKSTAT:
+        case GF_FOP_FALLOCATE:
+        case GF_FOP_DISCARD:
+        case GF_FOP_ZEROFILL:
                 pri = IOT_PRI_LO;
                 break;
 
@@ -263,6 +624,7 @@ iot_schedule (call_frame_t *frame, xlator_t *this, call_stub_t *stub)
         case GF_FOP_RELEASE:
         case GF_FOP_RELEASEDIR:
         case GF_FOP_GETSPEC:
+        case GF_FOP_COMPOUND:
         case GF_FOP_MAXVALUE:
                 //fail compilation on missing fop
                 //new fop must choose priority.
@@ -1198,6 +1560,59 @@ out:
 }
 
 
+int
+iot_bulkstat_cbk (call_frame_t *frame, void *cookie, xlator_t *this,
+                  int32_t op_ret, int32_t op_errno, struct iatt *bufs,
+                  int32_t *op_errnos)
+{
+	STACK_UNWIND_STRICT (bulkstat, frame, op_ret, op_errno, bufs,
+                             op_errnos);
+	return 0;
+}
+
+
+int
+iot_bulkstat_wrapper (call_frame_t *frame, xlator_t *this, loc_t *locs,
+                      int32_t count)
+{
+	STACK_WIND (frame, iot_bulkstat_cbk,
+		    FIRST_CHILD(this),
+		    FIRST_CHILD(this)->fops->bulkstat,
+		    locs, count);
+	return 0;
+}
+
+
+int
+iot_bulkstat (call_frame_t *frame, xlator_t *this, loc_t *locs,
+              int32_t count)
+{
+	call_stub_t *stub = NULL;
+        int         ret = -1;
+
+        stub = fop_bulkstat_stub (frame, iot_bulkstat_wrapper, locs, count);
+	if (!stub) {
+		gf_log (this->name, GF_LOG_ERROR,
+                        "cannot create fop_bulkstat call stub"
+                        "(out of memory)");
+                ret = -1;
+                goto out;
+	}
+
+        ret = iot_schedule (frame, this, stub);
+
+out:
+        if (ret < 0) {
+		STACK_UNWIND_STRICT (bulkstat, frame, -1, -ret, NULL, NULL);
+
+                if (stub != NULL) {
+                        call_stub_destroy (stub);
+                }
+        }
+	return 0;
+}
+
+
 int
 iot_fstat_cbk (call_frame_t *frame, void *cookie, xlator_t *this,
                int32_t op_ret, int32_t op_errno, struct iatt *buf)
@@ -1351,6 +1766,214 @@ out:
 }
 
 
+int
+iot_fallocate_cbk (call_frame_t *frame, void *cookie, xlator_t *this,
+                   int32_t op_ret, int32_t op_errno, struct iatt *prebuf,
+                   struct iatt *postbuf)
+{
+	STACK_UNWIND_STRICT (fallocate, frame, op_ret, op_errno, prebuf,
+                             postbuf);
+	return 0;
+}
+
+
+int
+iot_fallocate_wrapper (call_frame_t *frame, xlator_t *this, fd_t *fd,
+                       int32_t mode, off_t offset, size_t len)
+{
+	STACK_WIND (frame, iot_fallocate_cbk,
+		    FIRST_CHILD(this),
+		    FIRST_CHILD(this)->fops->fallocate,
+		    fd, mode, offset, len);
+	return 0;
+}
+
+
+int
+iot_fallocate (call_frame_t *frame, xlator_t *this, fd_t *fd,
+               int32_t mode, off_t offset, size_t len)
+{
+	call_stub_t *stub = NULL;
+        int         ret = -1;
+
+	stub = fop_fallocate_stub (frame, iot_fallocate_wrapper, fd, mode,
+                                   offset, len);
+	if (!stub) {
+		gf_log (this->name, GF_LOG_ERROR,
+                        "cannot create fop_fallocate call stub"
+                        "(out of memory)");
+                ret = -ENOMEM;
+                goto out;
+	}
+
+        ret = iot_schedule (frame, this, stub);
+out:
+        if (ret < 0) {
+		STACK_UNWIND_STRICT (fallocate, frame, -1, -ret, NULL, NULL);
+
+                if (stub != NULL) {
+                        call_stub_destroy (stub);
+                }
+        }
+	return 0;
+}
+
+
+int
+iot_discard_cbk (call_frame_t *frame, void *cookie, xlator_t *this,
+                 int32_t op_ret, int32_t op_errno, struct iatt *prebuf,
+                 struct iatt *postbuf)
+{
+	STACK_UNWIND_STRICT (discard, frame, op_ret, op_errno, prebuf,
+                             postbuf);
+	return 0;
+}
+
+
+int
+iot_discard_wrapper (call_frame_t *frame, xlator_t *this, fd_t *fd,
+                     off_t offset, size_t len)
+{
+	STACK_WIND (frame, iot_discard_cbk,
+		    FIRST_CHILD(this),
+		    FIRST_CHILD(this)->fops->discard,
+		    fd, offset, len);
+	return 0;
+}
+
+
+int
+iot_discard (call_frame_t *frame, xlator_t *this, fd_t *fd,
+             off_t offset, size_t len)
+{
+	call_stub_t *stub = NULL;
+        int         ret = -1;
+
+	stub = fop_discard_stub (frame, iot_discard_wrapper, fd, offset,
+                                 len);
+	if (!stub) {
+		gf_log (this->name, GF_LOG_ERROR,
+                        "cannot create fop_discard call stub"
+                        "(out of memory)");
+                ret = -ENOMEM;
+                goto out;
+	}
+
+        ret = iot_schedule (frame, this, stub);
+out:
+        if (ret < 0) {
+		STACK_UNWIND_STRICT (discard, frame, -1, -ret, NULL, NULL);
+
+                if (stub != NULL) {
+                        call_stub_destroy (stub);
+                }
+        }
+	return 0;
+}
+
+
+int
+iot_zerofill_cbk (call_frame_t *frame, void *cookie, xlator_t *this,
+                  int32_t op_ret, int32_t op_errno, struct iatt *prebuf,
+                  struct iatt *postbuf)
+{
+	STACK_UNWIND_STRICT (zerofill, frame, op_ret, op_errno, prebuf,
+                             postbuf);
+	return 0;
+}
+
+
+int
+iot_zerofill_wrapper (call_frame_t *frame, xlator_t *this, fd_t *fd,
+                      off_t offset, size_t len)
+{
+	STACK_WIND (frame, iot_zerofill_cbk,
+		    FIRST_CHILD(this),
+		    FIRST_CHILD(this)->fops->zerofill,
+		    fd, offset, len);
+	return 0;
+}
+
+
+int
+iot_zerofill (call_frame_t *frame, xlator_t *this, fd_t *fd,
+              off_t offset, size_t len)
+{
+	call_stub_t *stub = NULL;
+        int         ret = -1;
+
+	stub = fop_zerofill_stub (frame, iot_zerofill_wrapper, fd, offset,
+                                  len);
+	if (!stub) {
+		gf_log (this->name, GF_LOG_ERROR,
+                        "cannot create fop_zerofill call stub"
+                        "(out of memory)");
+                ret = -ENOMEM;
+                goto out;
+	}
+
+        ret = iot_schedule (frame, this, stub);
+out:
+        if (ret < 0) {
+		STACK_UNWIND_STRICT (zerofill, frame, -1, -ret, NULL, NULL);
+
+                if (stub != NULL) {
+                        call_stub_destroy (stub);
+                }
+        }
+	return 0;
+}
+
+
+int
+iot_seek_cbk (call_frame_t *frame, void *cookie, xlator_t *this,
+              int32_t op_ret, int32_t op_errno, off_t offset)
+{
+	STACK_UNWIND_STRICT (seek, frame, op_ret, op_errno, offset);
+	return 0;
+}
+
+
+int
+iot_seek_wrapper (call_frame_t *frame, xlator_t *this, fd_t *fd,
+                  off_t offset, gf_seek_what_t what)
+{
+	STACK_WIND (frame, iot_seek_cbk,
+		    FIRST_CHILD(this),
+		    FIRST_CHILD(this)->fops->seek,
+		    fd, offset, what);
+	return 0;
+}
+
+
+int
+iot_seek (call_frame_t *frame, xlator_t *this, fd_t *fd,
+          off_t offset, gf_seek_what_t what)
+{
+	call_stub_t *stub = NULL;
+        int         ret = -1;
+
+	stub = fop_seek_stub (frame, iot_seek_wrapper, fd, offset, what);
+	if (!stub) {
+		gf_log (this->name, GF_LOG_ERROR,
+                        "cannot create fop_seek call stub"
+                        "(out of memory)");
+                ret = -ENOMEM;
+                goto out;
+	}
+
+        ret = iot_schedule (frame, this, stub);
+out:
+        if (ret < 0) {
+		STACK_UNWIND_STRICT (seek, frame, -1, -ret, 0);
+
+                if (stub != NULL) {
+                        call_stub_destroy (stub);
+                }
+        }
+	return 0;
+}
+
 
 int
 iot_unlink_cbk (call_frame_t *frame, void *cookie, xlator_t *this,
@@ -2261,16 +2884,86 @@ out:
 }
 
 
+/*
+ * __iot_autoscale - adjusts, once per IOT_SCALE_INTERVAL, the number of
+ * threads wanted beyond what the queue length asks for. Threads are added
+ * while requests wait in the queues for longer than the configured target,
+ * unless the time requests take to be served has grown to twice what it
+ * is when the backend is not loaded: more threads would then only queue
+ * in the disk. Threads in excess go away through idle-time.
+ */
+static void
+__iot_autoscale (iot_conf_t *conf)
+{
+        uint64_t  count = 0;
+        uint64_t  wait = 0;
+        uint64_t  svc = 0;
+        time_t    now = 0;
+        int32_t   step = 0;
+        char      saturated = 0;
+
+        now = time (NULL);
+        if (now - conf->scale_time < IOT_SCALE_INTERVAL)
+                return;
+        conf->scale_time = now;
+
+        LOCK (&conf->ac_lock);
+        {
+                count = conf->interval_count;
+                wait = conf->interval_wait;
+                svc = conf->interval_svc;
+                conf->interval_count = 0;
+                conf->interval_wait = 0;
+                conf->interval_svc = 0;
+        }
+        UNLOCK (&conf->ac_lock);
+
+        if (!count) {
+                conf->scale_count = 0;
+                return;
+        }
+
+        wait /= count;
+        svc /= count;
+
+        if (!conf->svc_baseline || (svc < conf->svc_baseline))
+                conf->svc_baseline = svc;
+        else
+                conf->svc_baseline = (conf->svc_baseline * 15 + svc) / 16;
+
+        saturated = (svc > 2 * conf->svc_baseline);
+
+        if ((wait > conf->wait_target) && !saturated) {
+                step = max (conf->curr_count / 4, 1);
+                conf->scale_count = min (conf->curr_count + step,
+                                         conf->autoscale_max);
+        } else if (saturated || (wait < conf->wait_target / 2)) {
+                conf->scale_count = max (conf->scale_count - 1, 0);
+        }
+
+        gf_log (conf->this->name, GF_LOG_DEBUG,
+                "queue wait %"PRIu64"us, service %"PRIu64"us (baseline "
+                "%"PRIu64"us), want %d threads", wait, svc,
+                conf->svc_baseline, conf->scale_count);
+}
+
+
 int
 __iot_workers_scale (iot_conf_t *conf)
 {
+        iot_worker_t *worker = NULL;
+        int       queue_size = 0;
         int       log2 = 0;
         int       scale = 0;
         int       diff = 0;
+        int       i = 0;
         pthread_t thread;
         int       ret = 0;
 
-        log2 = log_base2 (conf->queue_size);
+        for (i = 0; i < conf->slot_count; i++)
+                queue_size += conf->workers[i].queue_size;
+
+        log2 = log_base2 (queue_size);
 
         scale = log2;
 
@@ -2280,22 +2973,47 @@ __iot_workers_scale (iot_conf_t *conf)
         if (log2 > conf->max_count)
                 scale = conf->max_count;
 
+        if (conf->autoscale) {
+                __iot_autoscale (conf);
+                scale = max (scale, conf->scale_count);
+        }
+
         if (conf->curr_count < scale) {
                 diff = scale - conf->curr_count;
         }
 
-        while (diff) {
-                diff --;
+        for (i = 0; diff && (i < IOT_MAX_THREADS); i++) {
+                worker = &conf->workers[i];
+                if (worker->running)
+                        continue;
 
-                ret = pthread_create (&thread, &conf->w_attr, iot_worker, conf);
-                if (ret == 0) {
-                        conf->curr_count++;
-                        gf_log (conf->this->name, GF_LOG_DEBUG,
-                                "scaled threads to %d (queue_size=%d/%d)",
-                                conf->curr_count, conf->queue_size, scale);
-                } else {
+                pthread_mutex_lock (&worker->mutex);
+                {
+                        worker->running = 1;
+                }
+                pthread_mutex_unlock (&worker->mutex);
+
+                ret = pthread_create (&thread, &conf->w_attr, iot_worker,
+                                      worker);
+                if (ret != 0) {
+                        pthread_mutex_lock (&worker->mutex);
+                        {
+                                worker->running = 0;
+                        }
+                        pthread_mutex_unlock (&worker->mutex);
                         break;
                 }
+
+                pthread_detach (thread);
+
+                diff--;
+                conf->curr_count++;
+                if (conf->slot_count <= i)
+                        conf->slot_count = i + 1;
+
+                gf_log (conf->this->name, GF_LOG_DEBUG,
+                        "scaled threads to %d (queue_size=%d/%d)",
+                        conf->curr_count, queue_size, scale);
         }
 
         return diff;
@@ -2338,6 +3056,138 @@ set_stack_size (iot_conf_t *conf)
 }
 
 
+static const char *iot_pri_names[IOT_PRI_MAX] = {
+        [IOT_PRI_HI]     = "high",
+        [IOT_PRI_NORMAL] = "normal",
+        [IOT_PRI_LO]     = "low",
+        [IOT_PRI_LEAST]  = "least",
+};
+
+/* upper bound, in usecs, of the wait of permille of the requests */
+static uint64_t
+iot_wait_percentile (struct iot_wait_stats *stats, int permille)
+{
+        uint64_t seen = 0;
+        int      i = 0;
+
+        for (i = 0; i < IOT_WAIT_BUCKETS; i++) {
+                seen += stats->buckets[i];
+                if (seen * 1000 >= stats->count * permille)
+                        break;
+        }
+
+        return (i == 0) ? 0 : (1ULL << i);
+}
+
+
+int
+iot_priv_dump (xlator_t *this)
+{
+        iot_conf_t            *conf = NULL;
+        struct iot_wait_stats  wait[IOT_PRI_MAX];
+        int32_t                queued[IOT_PRI_MAX] = {0, };
+        int32_t                sleeping = 0;
+        uint64_t               stolen = 0;
+        uint64_t               overflows = 0;
+        char                   key[64] = {0, };
+        iot_worker_t          *worker = NULL;
+        call_stub_t           *stub = NULL;
+        int                    i = 0;
+        int                    pri = 0;
+
+        if (!this || !this->private)
+                goto out;
+
+        conf = this->private;
+
+        gf_proc_dump_add_section ("xlator.performance.io-threads.priv");
+
+        pthread_mutex_lock (&conf->mutex);
+        {
+                gf_proc_dump_write ("maximum_threads_count", "%d",
+                                    conf->max_count);
+                gf_proc_dump_write ("current_threads_count", "%d",
+                                    conf->curr_count);
+                gf_proc_dump_write ("autoscale", "%d", conf->autoscale);
+                gf_proc_dump_write ("autoscale_max", "%d",
+                                    conf->autoscale_max);
+                gf_proc_dump_write ("autoscale_wanted", "%d",
+                                    conf->scale_count);
+                gf_proc_dump_write ("service_baseline_usec", "%"PRIu64,
+                                    conf->svc_baseline);
+
+                for (i = 0; i < conf->slot_count; i++) {
+                        worker = &conf->workers[i];
+                        pthread_mutex_lock (&worker->mutex);
+                        {
+                                if (worker->running && worker->sleeping)
+                                        sleeping++;
+                                for (pri = 0; pri < IOT_PRI_MAX; pri++) {
+                                        list_for_each_entry (stub,
+                                                             &worker->reqs[pri],
+                                                             list)
+                                                queued[pri]++;
+                                }
+                        }
+                        pthread_mutex_unlock (&worker->mutex);
+                }
+        }
+        pthread_mutex_unlock (&conf->mutex);
+
+        LOCK (&conf->ac_lock);
+        {
+                memcpy (wait, conf->wait, sizeof (wait));
+                stolen = conf->stolen;
+                overflows = conf->affinity_overflows;
+        }
+        UNLOCK (&conf->ac_lock);
+
+        gf_proc_dump_write ("sleeping_threads_count", "%d", sleeping);
+        gf_proc_dump_write ("stolen_requests", "%"PRIu64, stolen);
+        gf_proc_dump_write ("inode_affinity", "%d", conf->affinity);
+        gf_proc_dump_write ("affinity_overflows", "%"PRIu64, overflows);
+
+        for (pri = 0; pri < IOT_PRI_MAX; pri++) {
+                snprintf (key, sizeof (key), "%s_queued", iot_pri_names[pri]);
+                gf_proc_dump_write (key, "%d", queued[pri]);
+
+                snprintf (key, sizeof (key), "%s_requests",
+                          iot_pri_names[pri]);
+                gf_proc_dump_write (key, "%"PRIu64, wait[pri].count);
+
+                if (!wait[pri].count)
+                        continue;
+
+                snprintf (key, sizeof (key), "%s_wait_avg_usec",
+                          iot_pri_names[pri]);
+                gf_proc_dump_write (key, "%"PRIu64,
+                                    wait[pri].total / wait[pri].count);
+
+                snprintf (key, sizeof (key), "%s_wait_p50_usec",
+                          iot_pri_names[pri]);
+                gf_proc_dump_write (key, "%"PRIu64,
+                                    iot_wait_percentile (&wait[pri], 500));
+
+                snprintf (key, sizeof (key), "%s_wait_p90_usec",
+                          iot_pri_names[pri]);
+                gf_proc_dump_write (key, "%"PRIu64,
+                                    iot_wait_percentile (&wait[pri], 900));
+
+                snprintf (key, sizeof (key), "%s_wait_p99_usec",
+                          iot_pri_names[pri]);
+                gf_proc_dump_write (key, "%"PRIu64,
+                                    iot_wait_percentile (&wait[pri], 990));
+
+                snprintf (key, sizeof (key), "%s_wait_p999_usec",
+                          iot_pri_names[pri]);
+                gf_proc_dump_write (key, "%"PRIu64,
+                                    iot_wait_percentile (&wait[pri], 999));
+        }
+out:
+        return 0;
+}
+
+
 int32_t
 mem_acct_init (xlator_t *this)
 {
@@ -2384,7 +3234,31 @@ reconfigure (xlator_t *this, dict_t *options)
                           conf->ac_iot_limit[IOT_PRI_LEAST], options, int32,
                           out);
 
-	ret = 0;
+        pthread_mutex_lock (&conf->mutex);
+        {
+                GF_OPTION_RECONF ("autoscaling", conf->autoscale, options,
+                                  bool, unlock);
+
+                GF_OPTION_RECONF ("autoscaling-max-threads",
+                                  conf->autoscale_max, options, int32, unlock);
+
+                GF_OPTION_RECONF ("autoscaling-queue-wait",
+                                  conf->wait_target, options, int32, unlock);
+
+                GF_OPTION_RECONF ("inode-affinity", conf->affinity, options,
+                                  bool, unlock);
+
+                GF_OPTION_RECONF ("inode-affinity-overflow",
+                                  conf->affinity_overflow, options, int32,
+                                  unlock);
+
+                if (!conf->autoscale)
+                        conf->scale_count = 0;
+
+                ret = 0;
+        }
+unlock:
+        pthread_mutex_unlock (&conf->mutex);
 out:
 	return ret;
 }
@@ -2394,8 +3268,10 @@ int
 init (xlator_t *this)
 {
         iot_conf_t      *conf = NULL;
+        iot_worker_t    *worker = NULL;
         int              ret = -1;
         int              i = 0;
+        int              pri = 0;
 
 	if (!this->children || this->children->next) {
 		gf_log ("io-threads", GF_LOG_ERROR,
@@ -2416,12 +3292,6 @@ init (xlator_t *this)
                 goto out;
         }
 
-        if ((ret = pthread_cond_init(&conf->cond, NULL)) != 0) {
-                gf_log (this->name, GF_LOG_ERROR,
-                        "pthread_cond_init failed (%d)", ret);
-                goto out;
-        }
-
         if ((ret = pthread_mutex_init(&conf->mutex, NULL)) != 0) {
                 gf_log (this->name, GF_LOG_ERROR,
                         "pthread_mutex_init failed (%d)", ret);
@@ -2446,10 +3316,41 @@ init (xlator_t *this)
 
         GF_OPTION_INIT ("idle-time", conf->idle_time, int32, out);
 
+        GF_OPTION_INIT ("autoscaling", conf->autoscale, bool, out);
+
+        GF_OPTION_INIT ("autoscaling-max-threads", conf->autoscale_max,
+                        int32, out);
+
+        GF_OPTION_INIT ("autoscaling-queue-wait", conf->wait_target, int32,
+                        out);
+
+        GF_OPTION_INIT ("inode-affinity", conf->affinity, bool, out);
+
+        GF_OPTION_INIT ("inode-affinity-overflow", conf->affinity_overflow,
+                        int32, out);
+
         conf->this = this;
+        LOCK_INIT (&conf->ac_lock);
 
-        for (i = 0; i < IOT_PRI_MAX; i++) {
-                INIT_LIST_HEAD (&conf->reqs[i]);
+        conf->workers = GF_CALLOC (IOT_MAX_THREADS, sizeof (*conf->workers),
+                                   gf_iot_mt_iot_worker_t);
+        if (conf->workers == NULL) {
+                gf_log (this->name, GF_LOG_ERROR,
+                        "out of memory");
+                ret = -1;
+                goto out;
+        }
+
+        for (i = 0; i < IOT_MAX_THREADS; i++) {
+                worker = &conf->workers[i];
+
+                pthread_mutex_init (&worker->mutex, NULL);
+                pthread_cond_init (&worker->cond, NULL);
+                for (pri = 0; pri < IOT_PRI_MAX; pri++) {
+                        INIT_LIST_HEAD (&worker->reqs[pri]);
+                }
+                worker->index = i;
+                worker->conf = conf;
         }
 
 	ret = iot_workers_scale (conf);
@@ -2457,6 +3358,7 @@ init (xlator_t *this)
         if (ret == -1) {
                 gf_log (this->name, GF_LOG_ERROR,
                         "cannot initialize worker threads, exiting init");
+                GF_FREE (conf->workers);
                 GF_FREE (conf);
                 goto out;
         }
@@ -2473,6 +3375,8 @@ fini (xlator_t *this)
 {
 	iot_conf_t *conf = this->private;
 
+        if (conf)
+                GF_FREE (conf->workers);
 	GF_FREE (conf);
 
 	this->private = NULL;
@@ -2489,9 +3393,14 @@ struct xlator_fops fops = {
 	.fsync       = iot_fsync,
 	.lk          = iot_lk,
 	.stat        = iot_stat,
+	.bulkstat    = iot_bulkstat,
 	.fstat       = iot_fstat,
 	.truncate    = iot_truncate,
 	.ftruncate   = iot_ftruncate,
+	.fallocate   = iot_fallocate,
+	.discard     = iot_discard,
+	.zerofill    = iot_zerofill,
+	.seek        = iot_seek,
 	.unlink      = iot_unlink,
         .lookup      = iot_lookup,
         .setattr     = iot_setattr,
@@ -2526,6 +3435,10 @@ struct xlator_fops fops = {
 struct xlator_cbks cbks = {
 };
 
+struct xlator_dumpops dumpops = {
+        .priv    = iot_priv_dump,
+};
+
 struct volume_options options[] = {
 	{ .key  = {"thread-count"},
 	  .type = GF_OPTION_TYPE_INT,
@@ -2577,6 +3490,43 @@ struct volume_options options[] = {
          .max   = 0x7fffffff,
          .default_value = "120",
         },
+        { .key  = {"autoscaling"},
+          .type = GF_OPTION_TYPE_BOOL,
+          .default_value = "on",
+          .description = "Add threads beyond thread-count when requests wait "
+                         "in the queues for longer than "
+                         "autoscaling-queue-wait, as long as the backend "
+                         "keeps serving them as fast as when idle"
+        },
+        { .key  = {"autoscaling-max-threads"},
+          .type = GF_OPTION_TYPE_INT,
+          .min  = IOT_MIN_THREADS,
+          .max  = IOT_MAX_THREADS,
+          .default_value = "64",
+          .description = "Maximum number of threads autoscaling may run"
+        },
+        { .key  = {"autoscaling-queue-wait"},
+          .type = GF_OPTION_TYPE_INT,
+          .min  = 1,
+          .max  = 10000000,
+          .default_value = "2000",
+          .description = "Average time in microseconds requests may wait in "
+                         "the queues before autoscaling adds threads"
+        },
+        { .key  = {"inode-affinity"},
+          .type = GF_OPTION_TYPE_BOOL,
+          .default_value = "off",
+          .description = "Queue the requests on a file to the same thread, "
+                         "picked from its gfid"
+        },
+        { .key  = {"inode-affinity-overflow"},
+          .type = GF_OPTION_TYPE_INT,
+          .min  = 0,
+          .max  = 65536,
+          .default_value = "8",
+          .description = "Requests queued to a thread beyond which those of "
+                         "its files go to idle threads"
+        },
 	{ .key  = {NULL},
         },
 };
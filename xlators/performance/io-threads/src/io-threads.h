@@ -47,7 +47,10 @@ struct iot_conf;
 
 #define IOT_MIN_THREADS         1
 #define IOT_DEFAULT_THREADS     16
-#define IOT_MAX_THREADS         64
+#define IOT_MAX_THREADS         256
+
+#define IOT_WAIT_BUCKETS        32      /* log2 of the wait in usecs */
+#define IOT_SCALE_INTERVAL      1       /* In secs */
 
 
 #define IOT_THREAD_STACK_SIZE   ((size_t)(1024*1024))
@@ -62,21 +65,69 @@ typedef enum {
 } iot_pri_t;
 
 
-struct iot_conf {
+/*
+ * Every worker thread owns a queue, in a slot of conf->workers. Requests
+ * are queued to a sleeping worker if there is one, else to the least
+ * loaded of a few, and workers out of work steal from the others. With
+ * inode-affinity, requests on an inode are queued to the worker its gfid
+ * hashes to instead. The only state shared by all of them, the per
+ * priority limits and the wait statistics, is under conf->ac_lock, held
+ * for a few instructions.
+ */
+struct iot_worker {
         pthread_mutex_t      mutex;
         pthread_cond_t       cond;
+        struct list_head     reqs[IOT_PRI_MAX];
+        int32_t              queue_size;
+        uint32_t             seq;         /* bumped at every enqueue */
+        char                 running;     /* a thread owns this slot */
+        char                 sleeping;
+        int32_t              index;
+        struct iot_conf     *conf;
+};
+
+typedef struct iot_worker iot_worker_t;
+
+struct iot_wait_stats {
+        uint64_t             count;
+        uint64_t             total;       /* in usecs */
+        uint64_t             buckets[IOT_WAIT_BUCKETS];
+};
+
+struct iot_conf {
+        /* thread management */
+        pthread_mutex_t      mutex;
 
         int32_t              max_count;   /* configured maximum */
         int32_t              curr_count;  /* actual number of threads running */
-        int32_t              sleep_count;
 
         int32_t              idle_time;   /* in seconds */
 
-        struct list_head     reqs[IOT_PRI_MAX];
+        iot_worker_t        *workers;     /* IOT_MAX_THREADS slots */
+        int32_t              slot_count;  /* slots ever used */
+        uint32_t             next_worker; /* unlocked, a hint */
 
+        /* autoscaling, under mutex */
+        gf_boolean_t         autoscale;
+        int32_t              autoscale_max;
+        int32_t              wait_target; /* in usecs */
+        int32_t              scale_count; /* threads the latencies ask for */
+        time_t               scale_time;
+        uint64_t             svc_baseline; /* in usecs */
+
+        gf_boolean_t         affinity;
+        int32_t              affinity_overflow;
+
+        gf_lock_t            ac_lock;
         int32_t              ac_iot_limit[IOT_PRI_MAX];
         int32_t              ac_iot_count[IOT_PRI_MAX];
-        int                  queue_size;
+        struct iot_wait_stats wait[IOT_PRI_MAX];
+        uint64_t             interval_wait;   /* since the last scaling */
+        uint64_t             interval_svc;
+        uint64_t             interval_count;
+        uint64_t             stolen;
+        uint64_t             affinity_overflows;
+
         pthread_attr_t       w_attr;
 
         xlator_t            *this;
@@ -0,0 +1,1939 @@
+/*
+  Copyright (c) 2011 Gluster, Inc. <http://www.gluster.com>
+  This file is part of GlusterFS.
+
+  GlusterFS is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published
+  by the Free Software Foundation; either version 3 of the License,
+  or (at your option) any later version.
+
+  GlusterFS is distributed in the hope that it will be useful, but
+  WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see
+  <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef _CONFIG_H
+#define _CONFIG_H
+#include "config.h"
+#endif
+
+#include <fcntl.h>
+
+#include "md-cache.h"
+#include "statedump.h"
+
+/*
+ * performance/md-cache keeps the iatt and a configurable set of xattrs of
+ * every inode it has seen in a reply of lookup, readdirp, stat or of a
+ * modifying fop, and answers stat, fstat, lookup (revalidate), getxattr and
+ * fgetxattr of those xattrs from the cache till the data is older than
+ * 'timeout' seconds. Modifying fops going through this translator update or
+ * drop the cached data. At most 'max-inodes' inodes hold cached data, older
+ * ones are dropped in LRU order.
+ */
+
+
+void
+mdc_local_wipe (mdc_local_t *local)
+{
+        if (local == NULL)
+                return;
+
+        loc_wipe (&local->loc);
+        loc_wipe (&local->loc2);
+
+        if (local->fd)
+                fd_unref (local->fd);
+
+        if (local->xattr_req)
+                dict_unref (local->xattr_req);
+
+        GF_FREE (local);
+}
+
+
+static mdc_local_t *
+mdc_local_get (call_frame_t *frame)
+{
+        mdc_local_t *local = NULL;
+
+        local = frame->local;
+        if (local)
+                goto out;
+
+        local = GF_CALLOC (1, sizeof (*local), gf_mdc_mt_mdc_local_t);
+        if (local == NULL)
+                goto out;
+
+        frame->local = local;
+out:
+        return local;
+}
+
+
+static inline int
+mdc_is_fresh (mdc_conf_t *conf, time_t then, time_t now)
+{
+        return ((then != 0) && ((now - then) < conf->timeout));
+}
+
+
+static md_cache_t *
+mdc_inode_get (xlator_t *this, inode_t *inode)
+{
+        uint64_t  value = 0;
+        int       ret   = -1;
+
+        if (inode == NULL)
+                return NULL;
+
+        ret = inode_ctx_get (inode, this, &value);
+        if (ret != 0)
+                return NULL;
+
+        return (md_cache_t *)(long)value;
+}
+
+
+static md_cache_t *
+mdc_inode_prep (xlator_t *this, inode_t *inode)
+{
+        md_cache_t *mdc   = NULL;
+        uint64_t    value = 0;
+        int         ret   = -1;
+
+        if (inode == NULL)
+                return NULL;
+
+        LOCK (&inode->lock);
+        {
+                ret = __inode_ctx_get (inode, this, &value);
+                if (ret == 0) {
+                        mdc = (md_cache_t *)(long)value;
+                        goto unlock;
+                }
+
+                mdc = GF_CALLOC (1, sizeof (*mdc), gf_mdc_mt_md_cache_t);
+                if (mdc == NULL)
+                        goto unlock;
+
+                LOCK_INIT (&mdc->lock);
+                INIT_LIST_HEAD (&mdc->lru);
+
+                ret = __inode_ctx_put (inode, this, (uint64_t)(long)mdc);
+                if (ret != 0) {
+                        LOCK_DESTROY (&mdc->lock);
+                        GF_FREE (mdc);
+                        mdc = NULL;
+                }
+        }
+unlock:
+        UNLOCK (&inode->lock);
+
+        return mdc;
+}
+
+
+/*
+ * moves @mdc to the tail of the lru list, evicting the data of the oldest
+ * inodes if more than max-inodes hold cached data.
+ */
+static void
+mdc_lru_touch (xlator_t *this, md_cache_t *mdc)
+{
+        mdc_conf_t *conf   = NULL;
+        md_cache_t *victim = NULL;
+        dict_t     *xattr  = NULL;
+
+        conf = this->private;
+
+        LOCK (&conf->lock);
+        {
+                if (mdc->in_lru) {
+                        list_move_tail (&mdc->lru, &conf->lru);
+                } else {
+                        list_add_tail (&mdc->lru, &conf->lru);
+                        mdc->in_lru = 1;
+                        conf->cached++;
+                }
+
+                while (conf->cached > conf->max_inodes) {
+                        victim = list_entry (conf->lru.next, md_cache_t, lru);
+                        list_del_init (&victim->lru);
+                        victim->in_lru = 0;
+                        conf->cached--;
+                        conf->stats.evictions++;
+
+                        LOCK (&victim->lock);
+                        {
+                                victim->md_time = 0;
+                                victim->xa_time = 0;
+                                xattr = victim->xattr;
+                                victim->xattr = NULL;
+                        }
+                        UNLOCK (&victim->lock);
+
+                        if (xattr) {
+                                dict_unref (xattr);
+                                xattr = NULL;
+                        }
+                }
+        }
+        UNLOCK (&conf->lock);
+}
+
+
+static void
+mdc_stats_inc (xlator_t *this, uint64_t *counter)
+{
+        mdc_conf_t *conf = NULL;
+
+        conf = this->private;
+
+        LOCK (&conf->lock);
+        {
+                (*counter)++;
+        }
+        UNLOCK (&conf->lock);
+}
+
+
+static int
+__mdc_key_is_cached (mdc_conf_t *conf, const char *key)
+{
+        int i = 0;
+
+        for (i = 0; i < conf->xattr_count; i++) {
+                if (strcmp (conf->xattr_keys[i], key) == 0)
+                        return 1;
+        }
+
+        return 0;
+}
+
+
+static int
+mdc_key_is_cached (xlator_t *this, const char *key)
+{
+        mdc_conf_t *conf   = NULL;
+        int         cached = 0;
+
+        conf = this->private;
+
+        if (!conf->cache_xattrs_on || (key == NULL))
+                return 0;
+
+        LOCK (&conf->lock);
+        {
+                cached = __mdc_key_is_cached (conf, key);
+        }
+        UNLOCK (&conf->lock);
+
+        return cached;
+}
+
+
+/*
+ * caches @iatt as the attributes of @inode. A NULL @iatt or one which is
+ * obviously not filled (write-behind unwinds writes with NULL/zeroed
+ * buffers) drops what is cached instead.
+ */
+static void
+mdc_inode_iatt_set (xlator_t *this, inode_t *inode, struct iatt *iatt)
+{
+        mdc_conf_t *conf  = NULL;
+        md_cache_t *mdc   = NULL;
+        int         valid = 0;
+
+        conf = this->private;
+
+        if (inode == NULL)
+                return;
+
+        valid = ((iatt != NULL) && !uuid_is_null (iatt->ia_gfid)
+                 && (uuid_is_null (inode->gfid)
+                     || (uuid_compare (inode->gfid, iatt->ia_gfid) == 0)));
+
+        if (valid) {
+                mdc = mdc_inode_prep (this, inode);
+        } else {
+                mdc = mdc_inode_get (this, inode);
+        }
+
+        if (mdc == NULL)
+                return;
+
+        LOCK (&mdc->lock);
+        {
+                if (valid) {
+                        mdc->md = *iatt;
+                        mdc->md_time = time (NULL);
+                } else {
+                        mdc->md_time = 0;
+                }
+        }
+        UNLOCK (&mdc->lock);
+
+        if (valid) {
+                mdc_lru_touch (this, mdc);
+        } else {
+                mdc_stats_inc (this, &conf->stats.invalidations);
+        }
+}
+
+
+static int
+mdc_inode_iatt_get (xlator_t *this, inode_t *inode, struct iatt *iatt)
+{
+        mdc_conf_t *conf = NULL;
+        md_cache_t *mdc  = NULL;
+        int         ret  = -1;
+
+        conf = this->private;
+
+        mdc = mdc_inode_get (this, inode);
+        if (mdc == NULL)
+                goto out;
+
+        LOCK (&mdc->lock);
+        {
+                if (mdc_is_fresh (conf, mdc->md_time, time (NULL))) {
+                        *iatt = mdc->md;
+                        ret = 0;
+                }
+        }
+        UNLOCK (&mdc->lock);
+
+out:
+        return ret;
+}
+
+
+static void
+mdc_inode_invalidate (xlator_t *this, inode_t *inode)
+{
+        mdc_conf_t *conf  = NULL;
+        md_cache_t *mdc   = NULL;
+        dict_t     *xattr = NULL;
+
+        conf = this->private;
+
+        mdc = mdc_inode_get (this, inode);
+        if (mdc == NULL)
+                return;
+
+        LOCK (&mdc->lock);
+        {
+                mdc->md_time = 0;
+                mdc->xa_time = 0;
+                xattr = mdc->xattr;
+                mdc->xattr = NULL;
+        }
+        UNLOCK (&mdc->lock);
+
+        if (xattr)
+                dict_unref (xattr);
+
+        mdc_stats_inc (this, &conf->stats.invalidations);
+}
+
+
+static void
+mdc_inode_xatt_invalidate (xlator_t *this, inode_t *inode)
+{
+        md_cache_t *mdc   = NULL;
+        dict_t     *xattr = NULL;
+
+        mdc = mdc_inode_get (this, inode);
+        if (mdc == NULL)
+                return;
+
+        LOCK (&mdc->lock);
+        {
+                mdc->xa_time = 0;
+                xattr = mdc->xattr;
+                mdc->xattr = NULL;
+        }
+        UNLOCK (&mdc->lock);
+
+        if (xattr)
+                dict_unref (xattr);
+}
+
+
+struct mdc_xattr_filler {
+        mdc_conf_t *conf;
+        dict_t     *dict;
+        int         ret;
+};
+
+
+static void
+mdc_xattr_filter (dict_t *rsp, char *key, data_t *value, void *data)
+{
+        struct mdc_xattr_filler *filler = data;
+
+        if (!__mdc_key_is_cached (filler->conf, key))
+                return;
+
+        if (dict_set (filler->dict, key, value) != 0)
+                filler->ret = -1;
+}
+
+
+/*
+ * caches the xattrs of @inode out of the reply @rsp of a lookup which asked
+ * for all the keys in cache-xattrs: keys not present in @rsp are remembered
+ * as not set on the file.
+ */
+static void
+mdc_inode_xatt_set (xlator_t *this, inode_t *inode, dict_t *rsp)
+{
+        mdc_conf_t              *conf   = NULL;
+        md_cache_t              *mdc    = NULL;
+        dict_t                  *old    = NULL;
+        uint64_t                 gen    = 0;
+        struct mdc_xattr_filler  filler = {0, };
+
+        conf = this->private;
+
+        if (!conf->cache_xattrs_on)
+                return;
+
+        mdc = mdc_inode_prep (this, inode);
+        if (mdc == NULL)
+                return;
+
+        filler.conf = conf;
+        filler.dict = dict_new ();
+        if (filler.dict == NULL)
+                return;
+
+        LOCK (&conf->lock);
+        {
+                if (rsp)
+                        dict_foreach (rsp, mdc_xattr_filter, &filler);
+                gen = conf->xattr_gen;
+        }
+        UNLOCK (&conf->lock);
+
+        if (filler.ret != 0) {
+                dict_unref (filler.dict);
+                mdc_inode_xatt_invalidate (this, inode);
+                return;
+        }
+
+        LOCK (&mdc->lock);
+        {
+                old = mdc->xattr;
+                mdc->xattr = filler.dict;
+                mdc->xa_time = time (NULL);
+                mdc->xa_gen = gen;
+        }
+        UNLOCK (&mdc->lock);
+
+        if (old)
+                dict_unref (old);
+
+        mdc_lru_touch (this, mdc);
+}
+
+
+/*
+ * returns a reference to the cached xattrs of @inode if they are fresh.
+ */
+static dict_t *
+mdc_inode_xatt_get (xlator_t *this, inode_t *inode)
+{
+        mdc_conf_t *conf  = NULL;
+        md_cache_t *mdc   = NULL;
+        dict_t     *xattr = NULL;
+
+        conf = this->private;
+
+        if (!conf->cache_xattrs_on)
+                goto out;
+
+        mdc = mdc_inode_get (this, inode);
+        if (mdc == NULL)
+                goto out;
+
+        LOCK (&mdc->lock);
+        {
+                if (mdc->xattr
+                    && mdc_is_fresh (conf, mdc->xa_time, time (NULL))
+                    && (mdc->xa_gen == conf->xattr_gen)) {
+                        xattr = dict_ref (mdc->xattr);
+                }
+        }
+        UNLOCK (&mdc->lock);
+
+out:
+        return xattr;
+}
+
+
+/*
+ * adds the keys of cache-xattrs to @xattr_req so that the reply of the lookup
+ * carries everything needed to fill the xattr cache.
+ */
+static int
+mdc_load_reqs (xlator_t *this, dict_t *xattr_req)
+{
+        mdc_conf_t *conf = NULL;
+        int         i    = 0;
+        int         ret  = 0;
+
+        conf = this->private;
+
+        if (!conf->cache_xattrs_on)
+                return 0;
+
+        LOCK (&conf->lock);
+        {
+                for (i = 0; i < conf->xattr_count; i++) {
+                        if (dict_get (xattr_req, conf->xattr_keys[i]))
+                                continue;
+
+                        ret = dict_set_int8 (xattr_req, conf->xattr_keys[i],
+                                             0);
+                        if (ret)
+                                break;
+                }
+        }
+        UNLOCK (&conf->lock);
+
+        return ret;
+}
+
+
+struct mdc_lookup_filler {
+        mdc_conf_t *conf;
+        dict_t     *cached;
+        dict_t     *rsp;
+        int         ok;
+};
+
+
+static void
+mdc_lookup_fill (dict_t *xattr_req, char *key, data_t *value, void *data)
+{
+        struct mdc_lookup_filler *filler = data;
+        data_t                   *cached = NULL;
+
+        if (!filler->ok)
+                return;
+
+        if (strcmp (key, "gfid-req") == 0)
+                return;
+
+        if ((filler->cached == NULL)
+            || !__mdc_key_is_cached (filler->conf, key)) {
+                filler->ok = 0;
+                return;
+        }
+
+        cached = dict_get (filler->cached, key);
+        if (cached == NULL)
+                return;
+
+        if (filler->rsp == NULL)
+                filler->rsp = dict_new ();
+
+        if ((filler->rsp == NULL) || dict_set (filler->rsp, key, cached))
+                filler->ok = 0;
+}
+
+
+int
+mdc_lookup_cbk (call_frame_t *frame, void *cookie, xlator_t *this,
+                int32_t op_ret, int32_t op_errno, inode_t *inode,
+                struct iatt *stbuf, dict_t *dict, struct iatt *postparent)
+{
+        mdc_local_t *local = NULL;
+
+        local = frame->local;
+        if (local == NULL)
+                goto out;
+
+        if (op_ret != 0) {
+                if ((op_errno == ENOENT) || (op_errno == ESTALE))
+                        mdc_inode_invalidate (this, local->loc.inode);
+                goto out;
+        }
+
+        if (local->loc.parent)
+                mdc_inode_iatt_set (this, local->loc.parent, postparent);
+
+        mdc_inode_iatt_set (this, local->loc.inode, stbuf);
+        mdc_inode_xatt_set (this, local->loc.inode, dict);
+
+out:
+        MDC_STACK_UNWIND (lookup, frame, op_ret, op_errno, inode, stbuf,
+                          dict, postparent);
+        return 0;
+}
+
+
+int
+mdc_lookup (call_frame_t *frame, xlator_t *this, loc_t *loc,
+            dict_t *xattr_req)
+{
+        mdc_conf_t               *conf       = NULL;
+        mdc_local_t              *local      = NULL;
+        struct iatt               stbuf      = {0, };
+        struct iatt               postparent = {0, };
+        struct mdc_lookup_filler  filler     = {0, };
+        int                       ret        = -1;
+
+        conf = this->private;
+
+        /* nameless lookups and lookups of fresh inodes always go down */
+        if (uuid_is_null (loc->inode->gfid))
+                goto uncached;
+
+        ret = mdc_inode_iatt_get (this, loc->inode, &stbuf);
+        if (ret != 0)
+                goto uncached;
+
+        filler.conf = conf;
+        filler.ok = 1;
+
+        if (xattr_req) {
+                filler.cached = mdc_inode_xatt_get (this, loc->inode);
+
+                LOCK (&conf->lock);
+                {
+                        dict_foreach (xattr_req, mdc_lookup_fill, &filler);
+                }
+                UNLOCK (&conf->lock);
+
+                if (filler.cached)
+                        dict_unref (filler.cached);
+        }
+
+        if (!filler.ok) {
+                if (filler.rsp)
+                        dict_unref (filler.rsp);
+                goto uncached;
+        }
+
+        if (loc->parent)
+                mdc_inode_iatt_get (this, loc->parent, &postparent);
+
+        mdc_stats_inc (this, &conf->stats.lookup_hit);
+
+        MDC_STACK_UNWIND (lookup, frame, 0, 0, loc->inode, &stbuf,
+                          filler.rsp, &postparent);
+
+        if (filler.rsp)
+                dict_unref (filler.rsp);
+
+        return 0;
+
+uncached:
+        mdc_stats_inc (this, &conf->stats.lookup_miss);
+
+        local = mdc_local_get (frame);
+        if (local == NULL)
+                goto err;
+
+        if (loc_copy (&local->loc, loc) != 0)
+                goto err;
+
+        if (conf->cache_xattrs_on) {
+                if (xattr_req == NULL) {
+                        xattr_req = local->xattr_req = dict_new ();
+                        if (xattr_req == NULL)
+                                goto err;
+                }
+
+                mdc_load_reqs (this, xattr_req);
+        }
+
+        STACK_WIND (frame, mdc_lookup_cbk, FIRST_CHILD (this),
+                    FIRST_CHILD (this)->fops->lookup, loc, xattr_req);
+        return 0;
+
+err:
+        MDC_STACK_UNWIND (lookup, frame, -1, ENOMEM, NULL, NULL, NULL, NULL);
+        return 0;
+}
+
+
+int
+mdc_stat_cbk (call_frame_t *frame, void *cookie, xlator_t *this,
+              int32_t op_ret, int32_t op_errno, struct iatt *buf)
+{
+        mdc_local_t *local = NULL;
+
+        local = frame->local;
+
+        if (local && (op_ret == 0))
+                mdc_inode_iatt_set (this, local->loc.inode, buf);
+        else if (local && ((op_errno == ENOENT) || (op_errno == ESTALE)))
+                mdc_inode_invalidate (this, local->loc.inode);
+
+        MDC_STACK_UNWIND (stat, frame, op_ret, op_errno, buf);
+        return 0;
+}
+
+
+int
+mdc_stat (call_frame_t *frame, xlator_t *this, loc_t *loc)
+{
+        mdc_conf_t  *conf  = NULL;
+        mdc_local_t *local = NULL;
+        struct iatt  stbuf = {0, };
+
+        conf = this->private;
+
+        if (mdc_inode_iatt_get (this, loc->inode, &stbuf) == 0) {
+                mdc_stats_inc (this, &conf->stats.stat_hit);
+                MDC_STACK_UNWIND (stat, frame, 0, 0, &stbuf);
+                return 0;
+        }
+
+        mdc_stats_inc (this, &conf->stats.stat_miss);
+
+        local = mdc_local_get (frame);
+        if ((local == NULL) || (loc_copy (&local->loc, loc) != 0)) {
+                MDC_STACK_UNWIND (stat, frame, -1, ENOMEM, NULL);
+                return 0;
+        }
+
+        STACK_WIND (frame, mdc_stat_cbk, FIRST_CHILD (this),
+                    FIRST_CHILD (this)->fops->stat, loc);
+        return 0;
+}
+
+
+int
+mdc_fstat_cbk (call_frame_t *frame, void *cookie, xlator_t *this,
+               int32_t op_ret, int32_t op_errno, struct iatt *buf)
+{
+        mdc_local_t *local = NULL;
+
+        local = frame->local;
+
+        if (local && (op_ret == 0))
+                mdc_inode_iatt_set (this, local->fd->inode, buf);
+
+        MDC_STACK_UNWIND (fstat, frame, op_ret, op_errno, buf);
+        return 0;
+}
+
+
+int
+mdc_fstat (call_frame_t *frame, xlator_t *this, fd_t *fd)
+{
+        mdc_conf_t  *conf  = NULL;
+        mdc_local_t *local = NULL;
+        struct iatt  stbuf = {0, };
+
+        conf = this->private;
+
+        if (mdc_inode_iatt_get (this, fd->inode, &stbuf) == 0) {
+                mdc_stats_inc (this, &conf->stats.stat_hit);
+                MDC_STACK_UNWIND (fstat, frame, 0, 0, &stbuf);
+                return 0;
+        }
+
+        mdc_stats_inc (this, &conf->stats.stat_miss);
+
+        local = mdc_local_get (frame);
+        if (local == NULL) {
+                MDC_STACK_UNWIND (fstat, frame, -1, ENOMEM, NULL);
+                return 0;
+        }
+
+        local->fd = fd_ref (fd);
+
+        STACK_WIND (frame, mdc_fstat_cbk, FIRST_CHILD (this),
+                    FIRST_CHILD (this)->fops->fstat, fd);
+        return 0;
+}
+
+
+/*
+ * answers a getxattr of a single cached key. Returns 0 if the reply was
+ * sent, -1 if the request has to go down.
+ */
+static int
+mdc_getxattr_cached (call_frame_t *frame, xlator_t *this, inode_t *inode,
+                     const char *name, int is_fgetxattr)
+{
+        mdc_conf_t *conf     = NULL;
+        dict_t     *cached   = NULL;
+        dict_t     *rsp      = NULL;
+        data_t     *data     = NULL;
+        int32_t     op_ret   = -1;
+        int32_t     op_errno = 0;
+
+        conf = this->private;
+
+        if (!mdc_key_is_cached (this, name))
+                return -1;
+
+        cached = mdc_inode_xatt_get (this, inode);
+        if (cached == NULL) {
+                mdc_stats_inc (this, &conf->stats.xattr_miss);
+                return -1;
+        }
+
+        data = dict_get (cached, (char *)name);
+        if (data == NULL) {
+                op_errno = ENODATA;
+        } else {
+                rsp = dict_new ();
+                if ((rsp == NULL) || dict_set (rsp, (char *)name, data)) {
+                        op_errno = ENOMEM;
+                } else {
+                        op_ret = data->len;
+                }
+        }
+
+        dict_unref (cached);
+
+        mdc_stats_inc (this, &conf->stats.xattr_hit);
+
+        if (is_fgetxattr) {
+                MDC_STACK_UNWIND (fgetxattr, frame, op_ret, op_errno, rsp);
+        } else {
+                MDC_STACK_UNWIND (getxattr, frame, op_ret, op_errno, rsp);
+        }
+
+        if (rsp)
+                dict_unref (rsp);
+
+        return 0;
+}
+
+
+int
+mdc_getxattr (call_frame_t *frame, xlator_t *this, loc_t *loc,
+              const char *name)
+{
+        if (name && (mdc_getxattr_cached (frame, this, loc->inode, name,
+                                          0) == 0))
+                return 0;
+
+        STACK_WIND (frame, default_getxattr_cbk, FIRST_CHILD (this),
+                    FIRST_CHILD (this)->fops->getxattr, loc, name);
+        return 0;
+}
+
+
+int
+mdc_fgetxattr (call_frame_t *frame, xlator_t *this, fd_t *fd,
+               const char *name)
+{
+        if (name && (mdc_getxattr_cached (frame, this, fd->inode, name,
+                                          1) == 0))
+                return 0;
+
+        STACK_WIND (frame, default_fgetxattr_cbk, FIRST_CHILD (this),
+                    FIRST_CHILD (this)->fops->fgetxattr, fd, name);
+        return 0;
+}
+
+
+/* xattr modifications change the ctime as well, drop both */
+int
+mdc_setxattr_cbk (call_frame_t *frame, void *cookie, xlator_t *this,
+                  int32_t op_ret, int32_t op_errno)
+{
+        mdc_local_t *local = NULL;
+
+        local = frame->local;
+        if (local)
+                mdc_inode_invalidate (this, local->loc.inode);
+
+        MDC_STACK_UNWIND (setxattr, frame, op_ret, op_errno);
+        return 0;
+}
+
+
+int
+mdc_setxattr (call_frame_t *frame, xlator_t *this, loc_t *loc, dict_t *dict,
+              int32_t flags)
+{
+        mdc_local_t *local = NULL;
+
+        local = mdc_local_get (frame);
+        if (local)
+                loc_copy (&local->loc, loc);
+
+        STACK_WIND (frame, mdc_setxattr_cbk, FIRST_CHILD (this),
+                    FIRST_CHILD (this)->fops->setxattr, loc, dict, flags);
+        return 0;
+}
+
+
+int
+mdc_fsetxattr_cbk (call_frame_t *frame, void *cookie, xlator_t *this,
+                   int32_t op_ret, int32_t op_errno)
+{
+        mdc_local_t *local = NULL;
+
+        local = frame->local;
+        if (local)
+                mdc_inode_invalidate (this, local->fd->inode);
+
+        MDC_STACK_UNWIND (fsetxattr, frame, op_ret, op_errno);
+        return 0;
+}
+
+
+int
+mdc_fsetxattr (call_frame_t *frame, xlator_t *this, fd_t *fd, dict_t *dict,
+               int32_t flags)
+{
+        mdc_local_t *local = NULL;
+
+        local = mdc_local_get (frame);
+        if (local)
+                local->fd = fd_ref (fd);
+
+        STACK_WIND (frame, mdc_fsetxattr_cbk, FIRST_CHILD (this),
+                    FIRST_CHILD (this)->fops->fsetxattr, fd, dict, flags);
+        return 0;
+}
+
+
+int
+mdc_removexattr_cbk (call_frame_t *frame, void *cookie, xlator_t *this,
+                     int32_t op_ret, int32_t op_errno)
+{
+        mdc_local_t *local = NULL;
+
+        local = frame->local;
+        if (local)
+                mdc_inode_invalidate (this, local->loc.inode);
+
+        MDC_STACK_UNWIND (removexattr, frame, op_ret, op_errno);
+        return 0;
+}
+
+
+int
+mdc_removexattr (call_frame_t *frame, xlator_t *this, loc_t *loc,
+                 const char *name)
+{
+        mdc_local_t *local = NULL;
+
+        local = mdc_local_get (frame);
+        if (local)
+                loc_copy (&local->loc, loc);
+
+        STACK_WIND (frame, mdc_removexattr_cbk, FIRST_CHILD (this),
+                    FIRST_CHILD (this)->fops->removexattr, loc, name);
+        return 0;
+}
+
+
+/*
+ * fops changing the attributes of a file: the post-op attributes replace the
+ * cached ones.
+ */
+int
+mdc_truncate_cbk (call_frame_t *frame, void *cookie, xlator_t *this,
+                  int32_t op_ret, int32_t op_errno, struct iatt *prebuf,
+                  struct iatt *postbuf)
+{
+        mdc_local_t *local = NULL;
+
+        local = frame->local;
+        if (local)
+                mdc_inode_iatt_set (this, local->loc.inode,
+                                    (op_ret == 0) ? postbuf : NULL);
+
+        MDC_STACK_UNWIND (truncate, frame, op_ret, op_errno, prebuf, postbuf);
+        return 0;
+}
+
+
+int
+mdc_truncate (call_frame_t *frame, xlator_t *this, loc_t *loc, off_t offset)
+{
+        mdc_local_t *local = NULL;
+
+        local = mdc_local_get (frame);
+        if (local)
+                loc_copy (&local->loc, loc);
+
+        STACK_WIND (frame, mdc_truncate_cbk, FIRST_CHILD (this),
+                    FIRST_CHILD (this)->fops->truncate, loc, offset);
+        return 0;
+}
+
+
+int
+mdc_ftruncate_cbk (call_frame_t *frame, void *cookie, xlator_t *this,
+                   int32_t op_ret, int32_t op_errno, struct iatt *prebuf,
+                   struct iatt *postbuf)
+{
+        mdc_local_t *local = NULL;
+
+        local = frame->local;
+        if (local)
+                mdc_inode_iatt_set (this, local->fd->inode,
+                                    (op_ret == 0) ? postbuf : NULL);
+
+        MDC_STACK_UNWIND (ftruncate, frame, op_ret, op_errno, prebuf,
+                          postbuf);
+        return 0;
+}
+
+
+int
+mdc_ftruncate (call_frame_t *frame, xlator_t *this, fd_t *fd, off_t offset)
+{
+        mdc_local_t *local = NULL;
+
+        local = mdc_local_get (frame);
+        if (local)
+                local->fd = fd_ref (fd);
+
+        STACK_WIND (frame, mdc_ftruncate_cbk, FIRST_CHILD (this),
+                    FIRST_CHILD (this)->fops->ftruncate, fd, offset);
+        return 0;
+}
+
+
+int
+mdc_fallocate_cbk (call_frame_t *frame, void *cookie, xlator_t *this,
+                   int32_t op_ret, int32_t op_errno, struct iatt *prebuf,
+                   struct iatt *postbuf)
+{
+        mdc_local_t *local = NULL;
+
+        local = frame->local;
+        if (local)
+                mdc_inode_iatt_set (this, local->fd->inode,
+                                    (op_ret == 0) ? postbuf : NULL);
+
+        /* shared by discard and zerofill, which unwind the same way */
+        MDC_STACK_UNWIND (fallocate, frame, op_ret, op_errno, prebuf,
+                          postbuf);
+        return 0;
+}
+
+
+int
+mdc_fallocate (call_frame_t *frame, xlator_t *this, fd_t *fd, int32_t mode,
+               off_t offset, size_t len)
+{
+        mdc_local_t *local = NULL;
+
+        local = mdc_local_get (frame);
+        if (local)
+                local->fd = fd_ref (fd);
+
+        STACK_WIND (frame, mdc_fallocate_cbk, FIRST_CHILD (this),
+                    FIRST_CHILD (this)->fops->fallocate, fd, mode, offset,
+                    len);
+        return 0;
+}
+
+
+int
+mdc_discard (call_frame_t *frame, xlator_t *this, fd_t *fd, off_t offset,
+             size_t len)
+{
+        mdc_local_t *local = NULL;
+
+        local = mdc_local_get (frame);
+        if (local)
+                local->fd = fd_ref (fd);
+
+        STACK_WIND (frame, mdc_fallocate_cbk, FIRST_CHILD (this),
+                    FIRST_CHILD (this)->fops->discard, fd, offset, len);
+        return 0;
+}
+
+
+int
+mdc_zerofill (call_frame_t *frame, xlator_t *this, fd_t *fd, off_t offset,
+              size_t len)
+{
+        mdc_local_t *local = NULL;
+
+        local = mdc_local_get (frame);
+        if (local)
+                local->fd = fd_ref (fd);
+
+        STACK_WIND (frame, mdc_fallocate_cbk, FIRST_CHILD (this),
+                    FIRST_CHILD (this)->fops->zerofill, fd, offset, len);
+        return 0;
+}
+
+
+int
+mdc_writev_cbk (call_frame_t *frame, void *cookie, xlator_t *this,
+                int32_t op_ret, int32_t op_errno, struct iatt *prebuf,
+                struct iatt *postbuf)
+{
+        mdc_local_t *local = NULL;
+
+        local = frame->local;
+        if (local)
+                mdc_inode_iatt_set (this, local->fd->inode,
+                                    (op_ret >= 0) ? postbuf : NULL);
+
+        MDC_STACK_UNWIND (writev, frame, op_ret, op_errno, prebuf, postbuf);
+        return 0;
+}
+
+
+int
+mdc_writev (call_frame_t *frame, xlator_t *this, fd_t *fd,
+            struct iovec *vector, int32_t count, off_t offset,
+            struct iobref *iobref)
+{
+        mdc_local_t *local = NULL;
+
+        local = mdc_local_get (frame);
+        if (local)
+                local->fd = fd_ref (fd);
+
+        STACK_WIND (frame, mdc_writev_cbk, FIRST_CHILD (this),
+                    FIRST_CHILD (this)->fops->writev, fd, vector, count,
+                    offset, iobref);
+        return 0;
+}
+
+
+int
+mdc_fsync_cbk (call_frame_t *frame, void *cookie, xlator_t *this,
+               int32_t op_ret, int32_t op_errno, struct iatt *prebuf,
+               struct iatt *postbuf)
+{
+        mdc_local_t *local = NULL;
+
+        local = frame->local;
+        if (local)
+                mdc_inode_iatt_set (this, local->fd->inode,
+                                    (op_ret == 0) ? postbuf : NULL);
+
+        MDC_STACK_UNWIND (fsync, frame, op_ret, op_errno, prebuf, postbuf);
+        return 0;
+}
+
+
+int
+mdc_fsync (call_frame_t *frame, xlator_t *this, fd_t *fd, int32_t datasync)
+{
+        mdc_local_t *local = NULL;
+
+        local = mdc_local_get (frame);
+        if (local)
+                local->fd = fd_ref (fd);
+
+        STACK_WIND (frame, mdc_fsync_cbk, FIRST_CHILD (this),
+                    FIRST_CHILD (this)->fops->fsync, fd, datasync);
+        return 0;
+}
+
+
+int
+mdc_setattr_cbk (call_frame_t *frame, void *cookie, xlator_t *this,
+                 int32_t op_ret, int32_t op_errno, struct iatt *prebuf,
+                 struct iatt *postbuf)
+{
+        mdc_local_t *local = NULL;
+
+        local = frame->local;
+        if (local)
+                mdc_inode_iatt_set (this, local->loc.inode,
+                                    (op_ret == 0) ? postbuf : NULL);
+
+        MDC_STACK_UNWIND (setattr, frame, op_ret, op_errno, prebuf, postbuf);
+        return 0;
+}
+
+
+int
+mdc_setattr (call_frame_t *frame, xlator_t *this, loc_t *loc,
+             struct iatt *stbuf, int32_t valid)
+{
+        mdc_local_t *local = NULL;
+
+        local = mdc_local_get (frame);
+        if (local)
+                loc_copy (&local->loc, loc);
+
+        STACK_WIND (frame, mdc_setattr_cbk, FIRST_CHILD (this),
+                    FIRST_CHILD (this)->fops->setattr, loc, stbuf, valid);
+        return 0;
+}
+
+
+int
+mdc_fsetattr_cbk (call_frame_t *frame, void *cookie, xlator_t *this,
+                  int32_t op_ret, int32_t op_errno, struct iatt *prebuf,
+                  struct iatt *postbuf)
+{
+        mdc_local_t *local = NULL;
+
+        local = frame->local;
+        if (local)
+                mdc_inode_iatt_set (this, local->fd->inode,
+                                    (op_ret == 0) ? postbuf : NULL);
+
+        MDC_STACK_UNWIND (fsetattr, frame, op_ret, op_errno, prebuf, postbuf);
+        return 0;
+}
+
+
+int
+mdc_fsetattr (call_frame_t *frame, xlator_t *this, fd_t *fd,
+              struct iatt *stbuf, int32_t valid)
+{
+        mdc_local_t *local = NULL;
+
+        local = mdc_local_get (frame);
+        if (local)
+                local->fd = fd_ref (fd);
+
+        STACK_WIND (frame, mdc_fsetattr_cbk, FIRST_CHILD (this),
+                    FIRST_CHILD (this)->fops->fsetattr, fd, stbuf, valid);
+        return 0;
+}
+
+
+int
+mdc_open_cbk (call_frame_t *frame, void *cookie, xlator_t *this,
+              int32_t op_ret, int32_t op_errno, fd_t *fd)
+{
+        mdc_local_t *local = NULL;
+
+        local = frame->local;
+        if (local)
+                mdc_inode_invalidate (this, local->loc.inode);
+
+        MDC_STACK_UNWIND (open, frame, op_ret, op_errno, fd);
+        return 0;
+}
+
+
+int
+mdc_open (call_frame_t *frame, xlator_t *this, loc_t *loc, int32_t flags,
+          fd_t *fd, int32_t wbflags)
+{
+        mdc_local_t *local = NULL;
+
+        /* only a truncating open changes the attributes */
+        if (flags & O_TRUNC) {
+                local = mdc_local_get (frame);
+                if (local)
+                        loc_copy (&local->loc, loc);
+        }
+
+        STACK_WIND (frame, mdc_open_cbk, FIRST_CHILD (this),
+                    FIRST_CHILD (this)->fops->open, loc, flags, fd, wbflags);
+        return 0;
+}
+
+
+/*
+ * entry creation: cache the new inode and the post-op parent.
+ */
+int
+mdc_create_cbk (call_frame_t *frame, void *cookie, xlator_t *this,
+                int32_t op_ret, int32_t op_errno, fd_t *fd, inode_t *inode,
+                struct iatt *buf, struct iatt *preparent,
+                struct iatt *postparent)
+{
+        mdc_local_t *local = NULL;
+
+        local = frame->local;
+        if (local && (op_ret == 0)) {
+                mdc_inode_iatt_set (this, local->loc.parent, postparent);
+                mdc_inode_iatt_set (this, inode, buf);
+        }
+
+        MDC_STACK_UNWIND (create, frame, op_ret, op_errno, fd, inode, buf,
+                          preparent, postparent);
+        return 0;
+}
+
+
+int
+mdc_create (call_frame_t *frame, xlator_t *this, loc_t *loc, int32_t flags,
+            mode_t mode, fd_t *fd, dict_t *params)
+{
+        mdc_local_t *local = NULL;
+
+        local = mdc_local_get (frame);
+        if (local)
+                loc_copy (&local->loc, loc);
+
+        STACK_WIND (frame, mdc_create_cbk, FIRST_CHILD (this),
+                    FIRST_CHILD (this)->fops->create, loc, flags, mode, fd,
+                    params);
+        return 0;
+}
+
+
+int
+mdc_mknod_cbk (call_frame_t *frame, void *cookie, xlator_t *this,
+               int32_t op_ret, int32_t op_errno, inode_t *inode,
+               struct iatt *buf, struct iatt *preparent,
+               struct iatt *postparent)
+{
+        mdc_local_t *local = NULL;
+
+        local = frame->local;
+        if (local && (op_ret == 0)) {
+                mdc_inode_iatt_set (this, local->loc.parent, postparent);
+                mdc_inode_iatt_set (this, inode, buf);
+        }
+
+        MDC_STACK_UNWIND (mknod, frame, op_ret, op_errno, inode, buf,
+                          preparent, postparent);
+        return 0;
+}
+
+
+int
+mdc_mknod (call_frame_t *frame, xlator_t *this, loc_t *loc, mode_t mode,
+           dev_t rdev, dict_t *params)
+{
+        mdc_local_t *local = NULL;
+
+        local = mdc_local_get (frame);
+        if (local)
+                loc_copy (&local->loc, loc);
+
+        STACK_WIND (frame, mdc_mknod_cbk, FIRST_CHILD (this),
+                    FIRST_CHILD (this)->fops->mknod, loc, mode, rdev, params);
+        return 0;
+}
+
+
+int
+mdc_mkdir_cbk (call_frame_t *frame, void *cookie, xlator_t *this,
+               int32_t op_ret, int32_t op_errno, inode_t *inode,
+               struct iatt *buf, struct iatt *preparent,
+               struct iatt *postparent)
+{
+        mdc_local_t *local = NULL;
+
+        local = frame->local;
+        if (local && (op_ret == 0)) {
+                mdc_inode_iatt_set (this, local->loc.parent, postparent);
+                mdc_inode_iatt_set (this, inode, buf);
+        }
+
+        MDC_STACK_UNWIND (mkdir, frame, op_ret, op_errno, inode, buf,
+                          preparent, postparent);
+        return 0;
+}
+
+
+int
+mdc_mkdir (call_frame_t *frame, xlator_t *this, loc_t *loc, mode_t mode,
+           dict_t *params)
+{
+        mdc_local_t *local = NULL;
+
+        local = mdc_local_get (frame);
+        if (local)
+                loc_copy (&local->loc, loc);
+
+        STACK_WIND (frame, mdc_mkdir_cbk, FIRST_CHILD (this),
+                    FIRST_CHILD (this)->fops->mkdir, loc, mode, params);
+        return 0;
+}
+
+
+int
+mdc_symlink_cbk (call_frame_t *frame, void *cookie, xlator_t *this,
+                 int32_t op_ret, int32_t op_errno, inode_t *inode,
+                 struct iatt *buf, struct iatt *preparent,
+                 struct iatt *postparent)
+{
+        mdc_local_t *local = NULL;
+
+        local = frame->local;
+        if (local && (op_ret == 0)) {
+                mdc_inode_iatt_set (this, local->loc.parent, postparent);
+                mdc_inode_iatt_set (this, inode, buf);
+        }
+
+        MDC_STACK_UNWIND (symlink, frame, op_ret, op_errno, inode, buf,
+                          preparent, postparent);
+        return 0;
+}
+
+
+int
+mdc_symlink (call_frame_t *frame, xlator_t *this, const char *linkpath,
+             loc_t *loc, dict_t *params)
+{
+        mdc_local_t *local = NULL;
+
+        local = mdc_local_get (frame);
+        if (local)
+                loc_copy (&local->loc, loc);
+
+        STACK_WIND (frame, mdc_symlink_cbk, FIRST_CHILD (this),
+                    FIRST_CHILD (this)->fops->symlink, linkpath, loc, params);
+        return 0;
+}
+
+
+int
+mdc_link_cbk (call_frame_t *frame, void *cookie, xlator_t *this,
+              int32_t op_ret, int32_t op_errno, inode_t *inode,
+              struct iatt *buf, struct iatt *preparent,
+              struct iatt *postparent)
+{
+        mdc_local_t *local = NULL;
+
+        local = frame->local;
+        if (local && (op_ret == 0)) {
+                mdc_inode_iatt_set (this, local->loc2.parent, postparent);
+                mdc_inode_iatt_set (this, local->loc.inode, buf);
+        } else if (local) {
+                mdc_inode_invalidate (this, local->loc.inode);
+        }
+
+        MDC_STACK_UNWIND (link, frame, op_ret, op_errno, inode, buf,
+                          preparent, postparent);
+        return 0;
+}
+
+
+int
+mdc_link (call_frame_t *frame, xlator_t *this, loc_t *oldloc, loc_t *newloc)
+{
+        mdc_local_t *local = NULL;
+
+        local = mdc_local_get (frame);
+        if (local) {
+                loc_copy (&local->loc, oldloc);
+                loc_copy (&local->loc2, newloc);
+        }
+
+        STACK_WIND (frame, mdc_link_cbk, FIRST_CHILD (this),
+                    FIRST_CHILD (this)->fops->link, oldloc, newloc);
+        return 0;
+}
+
+
+/*
+ * entry removal: the link count of the inode changes, it may even be gone.
+ */
+int
+mdc_unlink_cbk (call_frame_t *frame, void *cookie, xlator_t *this,
+                int32_t op_ret, int32_t op_errno, struct iatt *preparent,
+                struct iatt *postparent)
+{
+        mdc_local_t *local = NULL;
+
+        local = frame->local;
+        if (local) {
+                mdc_inode_invalidate (this, local->loc.inode);
+                mdc_inode_iatt_set (this, local->loc.parent,
+                                    (op_ret == 0) ? postparent : NULL);
+        }
+
+        MDC_STACK_UNWIND (unlink, frame, op_ret, op_errno, preparent,
+                          postparent);
+        return 0;
+}
+
+
+int
+mdc_unlink (call_frame_t *frame, xlator_t *this, loc_t *loc)
+{
+        mdc_local_t *local = NULL;
+
+        local = mdc_local_get (frame);
+        if (local)
+                loc_copy (&local->loc, loc);
+
+        STACK_WIND (frame, mdc_unlink_cbk, FIRST_CHILD (this),
+                    FIRST_CHILD (this)->fops->unlink, loc);
+        return 0;
+}
+
+
+int
+mdc_rmdir_cbk (call_frame_t *frame, void *cookie, xlator_t *this,
+               int32_t op_ret, int32_t op_errno, struct iatt *preparent,
+               struct iatt *postparent)
+{
+        mdc_local_t *local = NULL;
+
+        local = frame->local;
+        if (local) {
+                mdc_inode_invalidate (this, local->loc.inode);
+                mdc_inode_iatt_set (this, local->loc.parent,
+                                    (op_ret == 0) ? postparent : NULL);
+        }
+
+        MDC_STACK_UNWIND (rmdir, frame, op_ret, op_errno, preparent,
+                          postparent);
+        return 0;
+}
+
+
+int
+mdc_rmdir (call_frame_t *frame, xlator_t *this, loc_t *loc, int flags)
+{
+        mdc_local_t *local = NULL;
+
+        local = mdc_local_get (frame);
+        if (local)
+                loc_copy (&local->loc, loc);
+
+        STACK_WIND (frame, mdc_rmdir_cbk, FIRST_CHILD (this),
+                    FIRST_CHILD (this)->fops->rmdir, loc, flags);
+        return 0;
+}
+
+
+int
+mdc_rename_cbk (call_frame_t *frame, void *cookie, xlator_t *this,
+                int32_t op_ret, int32_t op_errno, struct iatt *buf,
+                struct iatt *preoldparent, struct iatt *postoldparent,
+                struct iatt *prenewparent, struct iatt *postnewparent)
+{
+        mdc_local_t *local = NULL;
+
+        local = frame->local;
+        if (local && (op_ret == 0)) {
+                mdc_inode_iatt_set (this, local->loc.inode, buf);
+                mdc_inode_invalidate (this, local->loc2.inode);
+                mdc_inode_iatt_set (this, local->loc.parent, postoldparent);
+                mdc_inode_iatt_set (this, local->loc2.parent, postnewparent);
+        } else if (local) {
+                mdc_inode_invalidate (this, local->loc.inode);
+                mdc_inode_invalidate (this, local->loc2.inode);
+        }
+
+        MDC_STACK_UNWIND (rename, frame, op_ret, op_errno, buf, preoldparent,
+                          postoldparent, prenewparent, postnewparent);
+        return 0;
+}
+
+
+int
+mdc_rename (call_frame_t *frame, xlator_t *this, loc_t *oldloc,
+            loc_t *newloc)
+{
+        mdc_local_t *local = NULL;
+
+        local = mdc_local_get (frame);
+        if (local) {
+                loc_copy (&local->loc, oldloc);
+                loc_copy (&local->loc2, newloc);
+        }
+
+        STACK_WIND (frame, mdc_rename_cbk, FIRST_CHILD (this),
+                    FIRST_CHILD (this)->fops->rename, oldloc, newloc);
+        return 0;
+}
+
+
+/*
+ * readdirp replies carry the attributes of every entry. Only inodes already
+ * known to the inode table are updated, the dirents do not come with inodes.
+ */
+int
+mdc_readdirp_cbk (call_frame_t *frame, void *cookie, xlator_t *this,
+                  int32_t op_ret, int32_t op_errno, gf_dirent_t *entries)
+{
+        mdc_local_t *local = NULL;
+        gf_dirent_t *entry = NULL;
+        inode_t     *inode = NULL;
+
+        local = frame->local;
+        if ((local == NULL) || (op_ret <= 0))
+                goto unwind;
+
+        list_for_each_entry (entry, &entries->list, list) {
+                if (uuid_is_null (entry->d_stat.ia_gfid))
+                        continue;
+
+                inode = inode_find (local->fd->inode->table,
+                                    entry->d_stat.ia_gfid);
+                if (inode == NULL)
+                        continue;
+
+                mdc_inode_iatt_set (this, inode, &entry->d_stat);
+                inode_unref (inode);
+        }
+
+unwind:
+        MDC_STACK_UNWIND (readdirp, frame, op_ret, op_errno, entries);
+        return 0;
+}
+
+
+int
+mdc_readdirp (call_frame_t *frame, xlator_t *this, fd_t *fd, size_t size,
+              off_t offset)
+{
+        mdc_local_t *local = NULL;
+
+        local = mdc_local_get (frame);
+        if (local)
+                local->fd = fd_ref (fd);
+
+        STACK_WIND (frame, mdc_readdirp_cbk, FIRST_CHILD (this),
+                    FIRST_CHILD (this)->fops->readdirp, fd, size, offset);
+        return 0;
+}
+
+
+int
+mdc_forget (xlator_t *this, inode_t *inode)
+{
+        mdc_conf_t *conf  = NULL;
+        md_cache_t *mdc   = NULL;
+        uint64_t    value = 0;
+
+        conf = this->private;
+
+        inode_ctx_del (inode, this, &value);
+        mdc = (md_cache_t *)(long)value;
+        if (mdc == NULL)
+                goto out;
+
+        LOCK (&conf->lock);
+        {
+                if (mdc->in_lru) {
+                        list_del_init (&mdc->lru);
+                        conf->cached--;
+                }
+        }
+        UNLOCK (&conf->lock);
+
+        if (mdc->xattr)
+                dict_unref (mdc->xattr);
+
+        LOCK_DESTROY (&mdc->lock);
+        GF_FREE (mdc);
+out:
+        return 0;
+}
+
+
+int
+mdc_priv_dump (xlator_t *this)
+{
+        mdc_conf_t *conf = NULL;
+
+        if (!this || !this->private)
+                goto out;
+
+        conf = this->private;
+
+        gf_proc_dump_add_section ("xlator.performance.md-cache.priv");
+
+        LOCK (&conf->lock);
+        {
+                gf_proc_dump_write ("timeout", "%d", conf->timeout);
+                gf_proc_dump_write ("cache_xattrs", "%s",
+                                    conf->cache_xattrs_on ?
+                                    conf->xattr_str : "off");
+                gf_proc_dump_write ("max_inodes", "%u", conf->max_inodes);
+                gf_proc_dump_write ("cached_inodes", "%u", conf->cached);
+                gf_proc_dump_write ("stat_hits", "%"PRIu64,
+                                    conf->stats.stat_hit);
+                gf_proc_dump_write ("stat_misses", "%"PRIu64,
+                                    conf->stats.stat_miss);
+                gf_proc_dump_write ("lookup_hits", "%"PRIu64,
+                                    conf->stats.lookup_hit);
+                gf_proc_dump_write ("lookup_misses", "%"PRIu64,
+                                    conf->stats.lookup_miss);
+                gf_proc_dump_write ("xattr_hits", "%"PRIu64,
+                                    conf->stats.xattr_hit);
+                gf_proc_dump_write ("xattr_misses", "%"PRIu64,
+                                    conf->stats.xattr_miss);
+                gf_proc_dump_write ("invalidations", "%"PRIu64,
+                                    conf->stats.invalidations);
+                gf_proc_dump_write ("evictions", "%"PRIu64,
+                                    conf->stats.evictions);
+        }
+        UNLOCK (&conf->lock);
+out:
+        return 0;
+}
+
+
+int
+mdc_inodectx_dump (xlator_t *this, inode_t *inode)
+{
+        mdc_conf_t *conf = NULL;
+        md_cache_t *mdc  = NULL;
+        time_t      now  = 0;
+
+        conf = this->private;
+
+        mdc = mdc_inode_get (this, inode);
+        if (mdc == NULL)
+                goto out;
+
+        gf_proc_dump_add_section ("xlator.performance.md-cache.inodectx");
+
+        now = time (NULL);
+
+        LOCK (&mdc->lock);
+        {
+                gf_proc_dump_write ("iatt", "%s",
+                                    mdc_is_fresh (conf, mdc->md_time, now) ?
+                                    "valid" : "invalid");
+                gf_proc_dump_write ("xattrs", "%s",
+                                    (mdc->xattr
+                                     && mdc_is_fresh (conf, mdc->xa_time,
+                                                      now)) ?
+                                    "valid" : "invalid");
+                if (mdc->xattr)
+                        gf_proc_dump_write ("xattr_count", "%d",
+                                            mdc->xattr->count);
+        }
+        UNLOCK (&mdc->lock);
+out:
+        return 0;
+}
+
+
+/*
+ * parses the comma separated list of xattr keys in @str. Called with
+ * conf->lock held or before the translator is active.
+ */
+static int
+__mdc_xattrs_parse (xlator_t *this, mdc_conf_t *conf, char *str)
+{
+        char *dup      = NULL;
+        char *key      = NULL;
+        char *saveptr  = NULL;
+        int   count    = 0;
+
+        dup = gf_strdup (str);
+        if (dup == NULL)
+                return -1;
+
+        for (key = strtok_r (dup, ", ", &saveptr); key;
+             key = strtok_r (NULL, ", ", &saveptr)) {
+                if (count == MDC_MAX_XATTRS) {
+                        gf_log (this->name, GF_LOG_WARNING,
+                                "only the first %d keys of cache-xattrs are "
+                                "cached", MDC_MAX_XATTRS);
+                        break;
+                }
+
+                conf->xattr_keys[count++] = key;
+        }
+
+        if (conf->xattr_str)
+                GF_FREE (conf->xattr_str);
+
+        conf->xattr_str = dup;
+        conf->xattr_count = count;
+        conf->xattr_gen++;
+
+        return 0;
+}
+
+
+int
+reconfigure (xlator_t *this, dict_t *options)
+{
+        mdc_conf_t   *conf       = NULL;
+        int32_t       timeout    = 0;
+        uint32_t      max_inodes = 0;
+        gf_boolean_t  xattrs_on  = _gf_false;
+        char         *xattrs     = NULL;
+        int           ret        = -1;
+
+        conf = this->private;
+
+        GF_OPTION_RECONF ("timeout", timeout, options, int32, out);
+        GF_OPTION_RECONF ("max-inodes", max_inodes, options, uint32, out);
+        GF_OPTION_RECONF ("cache-xattrs", xattrs_on, options, bool, out);
+        GF_OPTION_RECONF ("cache-xattr-keys", xattrs, options, str, out);
+
+        LOCK (&conf->lock);
+        {
+                conf->timeout = timeout;
+                conf->max_inodes = max_inodes;
+                conf->cache_xattrs_on = xattrs_on;
+
+                if (strcmp (xattrs, conf->xattr_str) != 0)
+                        ret = __mdc_xattrs_parse (this, conf, xattrs);
+                else
+                        ret = 0;
+        }
+        UNLOCK (&conf->lock);
+out:
+        return ret;
+}
+
+
+int32_t
+mem_acct_init (xlator_t *this)
+{
+        int ret = -1;
+
+        if (!this)
+                return ret;
+
+        ret = xlator_mem_acct_init (this, gf_mdc_mt_end + 1);
+        if (ret != 0)
+                gf_log (this->name, GF_LOG_ERROR, "Memory accounting init "
+                        "failed");
+
+        return ret;
+}
+
+
+int
+init (xlator_t *this)
+{
+        mdc_conf_t *conf   = NULL;
+        char       *xattrs = NULL;
+        int         ret    = -1;
+
+        if (!this->children || this->children->next) {
+                gf_log (this->name, GF_LOG_ERROR,
+                        "FATAL: md-cache not configured with exactly one "
+                        "child");
+                goto out;
+        }
+
+        if (!this->parents) {
+                gf_log (this->name, GF_LOG_WARNING,
+                        "dangling volume. check volfile ");
+        }
+
+        conf = GF_CALLOC (1, sizeof (*conf), gf_mdc_mt_mdc_conf_t);
+        if (conf == NULL)
+                goto out;
+
+        LOCK_INIT (&conf->lock);
+        INIT_LIST_HEAD (&conf->lru);
+
+        GF_OPTION_INIT ("timeout", conf->timeout, int32, out);
+        GF_OPTION_INIT ("max-inodes", conf->max_inodes, uint32, out);
+        GF_OPTION_INIT ("cache-xattrs", conf->cache_xattrs_on, bool, out);
+        GF_OPTION_INIT ("cache-xattr-keys", xattrs, str, out);
+
+        ret = __mdc_xattrs_parse (this, conf, xattrs);
+        if (ret)
+                goto out;
+
+        this->private = conf;
+        ret = 0;
+out:
+        if ((ret == -1) && conf) {
+                if (conf->xattr_str)
+                        GF_FREE (conf->xattr_str);
+                LOCK_DESTROY (&conf->lock);
+                GF_FREE (conf);
+        }
+
+        return ret;
+}
+
+
+void
+fini (xlator_t *this)
+{
+        mdc_conf_t *conf = NULL;
+
+        conf = this->private;
+        if (conf == NULL)
+                return;
+
+        this->private = NULL;
+
+        if (conf->xattr_str)
+                GF_FREE (conf->xattr_str);
+        LOCK_DESTROY (&conf->lock);
+        GF_FREE (conf);
+}
+
+
+struct xlator_fops fops = {
+        .lookup      = mdc_lookup,
+        .stat        = mdc_stat,
+        .fstat       = mdc_fstat,
+        .getxattr    = mdc_getxattr,
+        .fgetxattr   = mdc_fgetxattr,
+        .setxattr    = mdc_setxattr,
+        .fsetxattr   = mdc_fsetxattr,
+        .removexattr = mdc_removexattr,
+        .truncate    = mdc_truncate,
+        .ftruncate   = mdc_ftruncate,
+        .fallocate   = mdc_fallocate,
+        .discard     = mdc_discard,
+        .zerofill    = mdc_zerofill,
+        .writev      = mdc_writev,
+        .fsync       = mdc_fsync,
+        .setattr     = mdc_setattr,
+        .fsetattr    = mdc_fsetattr,
+        .open        = mdc_open,
+        .create      = mdc_create,
+        .mknod       = mdc_mknod,
+        .mkdir       = mdc_mkdir,
+        .symlink     = mdc_symlink,
+        .link        = mdc_link,
+        .unlink      = mdc_unlink,
+        .rmdir       = mdc_rmdir,
+        .rename      = mdc_rename,
+        .readdirp    = mdc_readdirp,
+};
+
+struct xlator_cbks cbks = {
+        .forget      = mdc_forget,
+};
+
+struct xlator_dumpops dumpops = {
+        .priv        = mdc_priv_dump,
+        .inodectx    = mdc_inodectx_dump,
+};
+
+struct volume_options options[] = {
+        { .key  = {"timeout"},
+          .type = GF_OPTION_TYPE_INT,
+          .min  = 0,
+          .max  = 60,
+          .default_value = "1",
+          .description = "Time in seconds for which cached attributes and "
+          "xattrs are used without asking the server. Changes made by "
+          "other clients are seen only after this time."
+        },
+        { .key  = {"max-inodes"},
+          .type = GF_OPTION_TYPE_INT,
+          .min  = 1,
+          .max  = 1048576,
+          .default_value = "65536",
+          .description = "Maximum number of inodes holding cached "
+          "metadata. The least recently updated ones are dropped first."
+        },
+        { .key  = {"cache-xattrs"},
+          .type = GF_OPTION_TYPE_BOOL,
+          .default_value = "on",
+          .description = "Cache the xattrs listed in cache-xattr-keys "
+          "along with the attributes."
+        },
+        { .key  = {"cache-xattr-keys"},
+          .type = GF_OPTION_TYPE_STR,
+          .default_value = "security.selinux,security.capability,"
+          "system.posix_acl_access,system.posix_acl_default",
+          .description = "Comma separated list of xattrs fetched with every "
+          "lookup and answered from the cache afterwards."
+        },
+        { .key  = {NULL} },
+};
@@ -0,0 +1,107 @@
+/*
+  Copyright (c) 2011 Gluster, Inc. <http://www.gluster.com>
+  This file is part of GlusterFS.
+
+  GlusterFS is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published
+  by the Free Software Foundation; either version 3 of the License,
+  or (at your option) any later version.
+
+  GlusterFS is distributed in the hope that it will be useful, but
+  WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see
+  <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef __MD_CACHE_H
+#define __MD_CACHE_H
+
+#ifndef _CONFIG_H
+#define _CONFIG_H
+#include "config.h"
+#endif
+
+#include "glusterfs.h"
+#include "logging.h"
+#include "dict.h"
+#include "xlator.h"
+#include "defaults.h"
+#include "list.h"
+#include "locking.h"
+#include "md-cache-mem-types.h"
+
+#define MDC_MAX_XATTRS 64
+
+/*
+ * per inode cache. The iatt and the xattrs are cached independently; a zero
+ * timestamp means the corresponding part is not valid.
+ */
+struct md_cache {
+        gf_lock_t         lock;
+        struct iatt       md;
+        time_t            md_time;
+        dict_t           *xattr;         /* only the keys in cache-xattrs.
+                                          * A key missing here is known not
+                                          * to be set on the file.
+                                          */
+        time_t            xa_time;
+        uint64_t          xa_gen;        /* conf->xattr_gen at xa_time */
+        struct list_head  lru;           /* protected by conf->lock */
+        char              in_lru;
+};
+typedef struct md_cache md_cache_t;
+
+struct mdc_local {
+        loc_t             loc;
+        loc_t             loc2;
+        fd_t             *fd;
+        dict_t           *xattr_req;     /* allocated by us for lookup */
+};
+typedef struct mdc_local mdc_local_t;
+
+struct mdc_stats {
+        uint64_t          stat_hit;
+        uint64_t          stat_miss;
+        uint64_t          xattr_hit;
+        uint64_t          xattr_miss;
+        uint64_t          lookup_hit;
+        uint64_t          lookup_miss;
+        uint64_t          invalidations;
+        uint64_t          evictions;
+};
+
+struct mdc_conf {
+        int32_t           timeout;
+        uint32_t          max_inodes;
+        gf_boolean_t      cache_xattrs_on;
+        gf_lock_t         lock;
+        /* keys of the cached xattrs, protected by lock */
+        char             *xattr_str;
+        char             *xattr_keys[MDC_MAX_XATTRS];
+        int               xattr_count;
+        uint64_t          xattr_gen;     /* bumped when the keys change */
+        /* inodes with valid cached data, least recently updated first */
+        struct list_head  lru;
+        uint32_t          cached;
+        struct mdc_stats  stats;
+};
+typedef struct mdc_conf mdc_conf_t;
+
+#define MDC_STACK_UNWIND(fop, frame, params ...) do {           \
+                mdc_local_t *__local = NULL;                    \
+                if (frame) {                                    \
+                        __local = frame->local;                 \
+                        frame->local = NULL;                    \
+                }                                               \
+                STACK_UNWIND_STRICT (fop, frame, params);       \
+                mdc_local_wipe (__local);                       \
+        } while (0)
+
+void
+mdc_local_wipe (mdc_local_t *local);
+
+#endif /* __MD_CACHE_H */
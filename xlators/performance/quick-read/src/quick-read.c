@@ -18,6 +18,7 @@
 */
 
 #include "quick-read.h"
+#include "bulkstat.h"
 #include "statedump.h"
 
 #define QR_DEFAULT_CACHE_SIZE 134217728
@@ -255,8 +256,8 @@ __qr_inode_free (qr_inode_t *qr_inode)
 {
         GF_VALIDATE_OR_GOTO ("quick-read", qr_inode, out);
 
-        if (qr_inode->xattr) {
-                dict_unref (qr_inode->xattr);
+        if (qr_inode->iobuf) {
+                iobuf_unref (qr_inode->iobuf);
         }
 
         list_del (&qr_inode->lru);
@@ -320,59 +321,48 @@ out:
 }
 
 
-int32_t
-qr_lookup_cbk (call_frame_t *frame, void *cookie, xlator_t *this,
-               int32_t op_ret, int32_t op_errno, inode_t *inode,
-               struct iatt *buf, dict_t *dict, struct iatt *postparent)
+/*
+ * Copies the content returned for GF_CONTENT_KEY into an iobuf of its own,
+ * once. From there on readv replies carry references to that iobuf, and a
+ * refresh of the cache replaces the iobuf instead of writing into it.
+ */
+static struct iobuf *
+qr_content_to_iobuf (xlator_t *this, data_t *content)
 {
-        data_t           *content  = NULL;
-        qr_inode_t       *qr_inode = NULL;
-        uint64_t          value    = 0;
-        int               ret      = -1;
-        qr_conf_t        *conf     = NULL;
-        qr_inode_table_t *table    = NULL;
-        qr_private_t     *priv     = NULL;
-        qr_local_t       *local    = NULL;
-
-        GF_ASSERT (frame);
+        struct iobuf *iobuf = NULL;
 
-        if ((op_ret == -1) || (dict == NULL)) {
+        iobuf = iobuf_get2 (this->ctx->iobuf_pool, content->len);
+        if (iobuf == NULL) {
                 goto out;
         }
 
-        if ((this == NULL) || (this->private == NULL)) {
-                gf_log (frame->this->name, GF_LOG_WARNING,
-                        (this == NULL) ? "xlator object (this) is NULL"
-                        : "quick-read configuration is not found");
-                op_ret = -1;
-                op_errno = EINVAL;
-                goto out;
-        }
+        memcpy (iobuf->ptr, content->data, content->len);
+out:
+        return iobuf;
+}
+
+
+/* caches @content as the whole content of @inode, with attributes @buf */
+static int32_t
+qr_content_update (xlator_t *this, inode_t *inode, const char *path,
+                   struct iatt *buf, data_t *content)
+{
+        qr_inode_t       *qr_inode = NULL;
+        qr_private_t     *priv     = NULL;
+        qr_conf_t        *conf     = NULL;
+        qr_inode_table_t *table    = NULL;
+        struct iobuf     *iobuf    = NULL;
+        uint64_t          value    = 0;
+        int32_t           op_errno = 0;
+        int               ret      = -1;
 
         priv = this->private;
         conf = &priv->conf;
         table = &priv->table;
 
-        local = frame->local;
-
-        if (buf->ia_size > conf->max_file_size) {
-                goto out;
-        }
-
-        if (IA_ISDIR (buf->ia_type)) {
-                goto out;
-        }
-
-        if (inode == NULL) {
-                op_ret = -1;
-                op_errno = EINVAL;
-                gf_log (this->name, GF_LOG_WARNING,
-                        "lookup returned a NULL inode");
-                goto out;
-        }
-
-        content = dict_get (dict, GF_CONTENT_KEY);
-        if (content == NULL) {
+        iobuf = qr_content_to_iobuf (this, content);
+        if (iobuf == NULL) {
+                op_errno = ENOMEM;
                 goto out;
         }
 
@@ -380,9 +370,9 @@ qr_lookup_cbk (call_frame_t *frame, void *cookie, xlator_t *this,
         {
                 ret = inode_ctx_get (inode, this, &value);
                 if (ret == -1) {
-                        qr_inode = __qr_inode_alloc (this, local->path, inode);
+                        qr_inode = __qr_inode_alloc (this, (char *)path,
+                                                     inode);
                         if (qr_inode == NULL) {
-                                op_ret = -1;
                                 op_errno = ENOMEM;
                                 goto unlock;
                         }
@@ -392,7 +382,6 @@ qr_lookup_cbk (call_frame_t *frame, void *cookie, xlator_t *this,
                         if (ret == -1) {
                                 __qr_inode_free (qr_inode);
                                 qr_inode = NULL;
-                                op_ret = -1;
                                 op_errno = EINVAL;
                                 gf_log (this->name, GF_LOG_WARNING,
                                         "cannot set quick-read context in "
@@ -403,7 +392,6 @@ qr_lookup_cbk (call_frame_t *frame, void *cookie, xlator_t *this,
                 } else {
                         qr_inode = (qr_inode_t *)(long)value;
                         if (qr_inode == NULL) {
-                                op_ret = -1;
                                 op_errno = EINVAL;
                                 gf_log (this->name, GF_LOG_WARNING,
                                         "cannot find quick-read context in "
@@ -413,13 +401,16 @@ qr_lookup_cbk (call_frame_t *frame, void *cookie, xlator_t *this,
                         }
                 }
 
-                if (qr_inode->xattr) {
-                        dict_unref (qr_inode->xattr);
-                        qr_inode->xattr = NULL;
+                if (qr_inode->iobuf) {
+                        iobuf_unref (qr_inode->iobuf);
+                        qr_inode->iobuf = NULL;
                         table->cache_used -= qr_inode->stbuf.ia_size;
                 }
 
-                qr_inode->xattr = dict_ref (dict);
+                qr_inode->iobuf = iobuf;
+                qr_inode->content_len = content->len;
+                iobuf = NULL;
+
                 qr_inode->stbuf = *buf;
                 table->cache_used += buf->ia_size;
 
@@ -431,6 +422,73 @@ qr_lookup_cbk (call_frame_t *frame, void *cookie, xlator_t *this,
 unlock:
         UNLOCK (&table->lock);
 
+out:
+        if (iobuf != NULL) {
+                iobuf_unref (iobuf);
+        }
+
+        return op_errno ? -op_errno : 0;
+}
+
+
+int32_t
+qr_lookup_cbk (call_frame_t *frame, void *cookie, xlator_t *this,
+               int32_t op_ret, int32_t op_errno, inode_t *inode,
+               struct iatt *buf, dict_t *dict, struct iatt *postparent)
+{
+        data_t           *content  = NULL;
+        int               ret      = -1;
+        qr_conf_t        *conf     = NULL;
+        qr_private_t     *priv     = NULL;
+        qr_local_t       *local    = NULL;
+
+        GF_ASSERT (frame);
+
+        if ((op_ret == -1) || (dict == NULL)) {
+                goto out;
+        }
+
+        if ((this == NULL) || (this->private == NULL)) {
+                gf_log (frame->this->name, GF_LOG_WARNING,
+                        (this == NULL) ? "xlator object (this) is NULL"
+                        : "quick-read configuration is not found");
+                op_ret = -1;
+                op_errno = EINVAL;
+                goto out;
+        }
+
+        priv = this->private;
+        conf = &priv->conf;
+
+        local = frame->local;
+
+        if (buf->ia_size > conf->max_file_size) {
+                goto out;
+        }
+
+        if (IA_ISDIR (buf->ia_type)) {
+                goto out;
+        }
+
+        if (inode == NULL) {
+                op_ret = -1;
+                op_errno = EINVAL;
+                gf_log (this->name, GF_LOG_WARNING,
+                        "lookup returned a NULL inode");
+                goto out;
+        }
+
+        content = dict_get (dict, GF_CONTENT_KEY);
+        if (content == NULL) {
+                goto out;
+        }
+
+        ret = qr_content_update (this, inode, local->path, buf, content);
+        if (ret < 0) {
+                op_ret = -1;
+                op_errno = -ret;
+        }
+
 out:
         /*
          * FIXME: content size in dict can be greater than the size application
@@ -487,8 +545,9 @@ qr_lookup (call_frame_t *frame, xlator_t *this, loc_t *loc, dict_t *xattr_req)
                 if (op_ret == 0) {
                         qr_inode = (qr_inode_t *)(long)value;
                         if (qr_inode != NULL) {
-                                if (qr_inode->xattr) {
+                                if (qr_inode->iobuf) {
                                         cached = 1;
+                                        qr_inode->accessed = 1;
                                 }
                         }
                 }
@@ -721,7 +780,7 @@ qr_open (call_frame_t *frame, xlator_t *this, loc_t *loc, int32_t flags,
                 if (ret == 0) {
                         qr_inode = (qr_inode_t *)(long) filep;
                         if (qr_inode) {
-                                if (qr_inode->xattr) {
+                                if (qr_inode->iobuf) {
                                         content_cached = 1;
                                 }
                         }
@@ -1093,22 +1152,17 @@ qr_readv (call_frame_t *frame, xlator_t *this, fd_t *fd, size_t size,
         qr_inode_t        *qr_inode       = NULL;
         int32_t            ret            = -1, op_ret = -1, op_errno = -1;
         uint64_t           value          = 0;
-        int                count          = -1, flags = 0, i = 0;
+        int                count          = -1, flags = 0;
         char               content_cached = 0, need_validation = 0;
         char               need_open      = 0, can_wind = 0, need_unwind = 0;
-        struct iobuf      *iobuf          = NULL;
         struct iobref     *iobref         = NULL;
         struct iatt        stbuf          = {0, };
-        data_t            *content        = NULL;
         qr_fd_ctx_t       *qr_fd_ctx      = NULL;
         call_stub_t       *stub           = NULL;
         loc_t              loc            = {0, };
         qr_conf_t         *conf           = NULL;
         struct iovec      *vector         = NULL;
         char              *path           = NULL;
-        off_t              start          = 0, end = 0;
-        size_t             len            = 0;
-        struct iobuf_pool *iobuf_pool     = NULL;
         qr_local_t        *local          = NULL;
         char               just_validated = 0;
         qr_private_t      *priv           = NULL;
@@ -1137,15 +1191,13 @@ qr_readv (call_frame_t *frame, xlator_t *this, fd_t *fd, size_t size,
                 }
         }
 
-        iobuf_pool = this->ctx->iobuf_pool;
-
         LOCK (&table->lock);
         {
                 ret = inode_ctx_get (fd->inode, this, &value);
                 if (ret == 0) {
                         qr_inode = (qr_inode_t *)(long)value;
                         if (qr_inode) {
-                                if (qr_inode->xattr){
+                                if (qr_inode->iobuf) {
                                         if (!just_validated
                                             && qr_need_validation (conf,
                                                                    qr_inode)) {
@@ -1153,43 +1205,27 @@ qr_readv (call_frame_t *frame, xlator_t *this, fd_t *fd, size_t size,
                                                 goto unlock;
                                         }
 
-                                        content = dict_get (qr_inode->xattr,
-                                                            GF_CONTENT_KEY);
-
                                         stbuf = qr_inode->stbuf;
                                         content_cached = 1;
+                                        qr_inode->accessed = 1;
                                         list_move_tail (&qr_inode->lru,
                                                         &table->lru[qr_inode->priority]);
 
-                                        if (offset > content->len) {
+                                        count = 0;
+                                        if (offset >= qr_inode->content_len) {
                                                 op_ret = 0;
-                                                end = content->len;
-                                        } else {
-                                                if ((offset + size)
-                                                    > content->len) {
-                                                        op_ret = content->len
-                                                                - offset;
-                                                        end = content->len;
-                                                } else {
-                                                        op_ret = size;
-                                                        end =  offset + size;
-                                                }
-                                        }
-
-                                        count = (op_ret
-                                                 / iobuf_pool->default_page_size);
-                                        if ((op_ret % iobuf_pool->default_page_size)
-                                            != 0) {
-                                                count++;
+                                                goto unlock;
                                         }
 
-                                        if (count == 0) {
-                                                op_ret = 0;
-                                                goto unlock;
+                                        op_ret = qr_inode->content_len - offset;
+                                        if (op_ret > size) {
+                                                op_ret = size;
                                         }
 
-                                        vector = GF_CALLOC (count,
-                                                            sizeof (*vector),
+                                        /* the reply refers to the cached
+                                           iobuf, which is never written
+                                           to once cached */
+                                        vector = GF_CALLOC (1, sizeof (*vector),
                                                             gf_qr_mt_iovec);
                                         if (vector == NULL) {
                                                 op_ret = -1;
@@ -1206,42 +1242,12 @@ qr_readv (call_frame_t *frame, xlator_t *this, fd_t *fd, size_t size,
                                                 goto unlock;
                                         }
 
-                                        for (i = 0; i < count; i++) {
-                                                iobuf = iobuf_get (iobuf_pool);
-                                                if (iobuf == NULL) {
-                                                        op_ret = -1;
-                                                        op_errno = ENOMEM;
-                                                        need_unwind = 1;
-                                                        goto unlock;
-                                                }
-
-                                                start = offset
-                                                        +
-                                                        (iobuf_pool->default_page_size
-                                                         * i);
-
-                                                if (start > end) {
-                                                        len = 0;
-                                                } else {
-                                                        len =
-                                                        (iobuf_pool->default_page_size
-                                                               > (end - start))
-                                                                ? (end - start)
-                                                                :
-                                                                iobuf_pool->default_page_size;
-
-                                                        memcpy (iobuf->ptr,
-                                                                content->data
-                                                                + start,
-                                                                len);
-                                                }
-
-                                                iobref_add (iobref, iobuf);
-                                                iobuf_unref (iobuf);
+                                        iobref_add (iobref, qr_inode->iobuf);
 
-                                                vector[i].iov_base = iobuf->ptr;
-                                                vector[i].iov_len = len;
-                                        }
+                                        vector[0].iov_base = qr_inode->iobuf->ptr
+                                                + offset;
+                                        vector[0].iov_len = op_ret;
+                                        count = 1;
                                 }
                         }
                 }
@@ -2987,18 +2993,61 @@ ret:
 
 
 int32_t
-qr_lk_cbk (call_frame_t *frame, void *cookie, xlator_t *this, int32_t op_ret,
-           int32_t op_errno, struct gf_flock *lock)
+qr_fallocate_cbk (call_frame_t *frame, void *cookie, xlator_t *this,
+                  int32_t op_ret, int32_t op_errno, struct iatt *prebuf,
+                  struct iatt *postbuf)
 {
         GF_ASSERT (frame);
-        QR_STACK_UNWIND (lk, frame, op_ret, op_errno, lock);
+        QR_STACK_UNWIND (fallocate, frame, op_ret, op_errno, prebuf, postbuf);
         return 0;
 }
 
 
 int32_t
-qr_lk_helper (call_frame_t *frame, xlator_t *this, fd_t *fd, int32_t cmd,
-              struct gf_flock *lock)
+qr_discard_cbk (call_frame_t *frame, void *cookie, xlator_t *this,
+                int32_t op_ret, int32_t op_errno, struct iatt *prebuf,
+                struct iatt *postbuf)
+{
+        GF_ASSERT (frame);
+        QR_STACK_UNWIND (discard, frame, op_ret, op_errno, prebuf, postbuf);
+        return 0;
+}
+
+
+int32_t
+qr_zerofill_cbk (call_frame_t *frame, void *cookie, xlator_t *this,
+                 int32_t op_ret, int32_t op_errno, struct iatt *prebuf,
+                 struct iatt *postbuf)
+{
+        GF_ASSERT (frame);
+        QR_STACK_UNWIND (zerofill, frame, op_ret, op_errno, prebuf, postbuf);
+        return 0;
+}
+
+
+static void
+qr_range_wind (call_frame_t *frame, xlator_t *this, glusterfs_fop_t fop,
+               fd_t *fd, int32_t mode, off_t offset, size_t len)
+{
+        if (fop == GF_FOP_FALLOCATE) {
+                STACK_WIND (frame, qr_fallocate_cbk, FIRST_CHILD (this),
+                            FIRST_CHILD (this)->fops->fallocate, fd, mode,
+                            offset, len);
+        } else if (fop == GF_FOP_DISCARD) {
+                STACK_WIND (frame, qr_discard_cbk, FIRST_CHILD (this),
+                            FIRST_CHILD (this)->fops->discard, fd, offset,
+                            len);
+        } else {
+                STACK_WIND (frame, qr_zerofill_cbk, FIRST_CHILD (this),
+                            FIRST_CHILD (this)->fops->zerofill, fd, offset,
+                            len);
+        }
+}
+
+
+static int32_t
+qr_range_helper (call_frame_t *frame, xlator_t *this, glusterfs_fop_t fop,
+                 fd_t *fd, int32_t mode, off_t offset, size_t len)
 {
         qr_local_t  *local    = NULL;
         qr_fd_ctx_t *fdctx    = NULL;
@@ -3022,49 +3071,106 @@ qr_lk_helper (call_frame_t *frame, xlator_t *this, fd_t *fd, int32_t cmd,
                 }
 
                 gf_log (this->name, GF_LOG_WARNING,
-                        "open failed on path (%s) (%s), unwinding lk call",
-                        fdctx ? fdctx->path : NULL, strerror (op_errno));
+                        "open failed on path (%s) (%s), unwinding %s call",
+                        fdctx ? fdctx->path : NULL, strerror (op_errno),
+                        gf_fop_list[fop]);
                 goto unwind;
         }
 
-        STACK_WIND (frame, qr_lk_cbk, FIRST_CHILD(this),
-                    FIRST_CHILD(this)->fops->lk, fd, cmd, lock);
-
+        qr_range_wind (frame, this, fop, fd, mode, offset, len);
         return 0;
 
 unwind:
-        QR_STACK_UNWIND (lk, frame, -1, op_errno, NULL);
+        /* the three fops unwind with the same arguments */
+        QR_STACK_UNWIND (fallocate, frame, -1, op_errno, NULL, NULL);
         return 0;
 }
 
 
 int32_t
-qr_lk (call_frame_t *frame, xlator_t *this, fd_t *fd, int32_t cmd,
-       struct gf_flock *lock)
+qr_fallocate_helper (call_frame_t *frame, xlator_t *this, fd_t *fd,
+                     int32_t mode, off_t offset, size_t len)
 {
-        int           flags      = 0;
-        uint64_t      value      = 0;
-        call_stub_t  *stub       = NULL;
-        char         *path       = NULL;
-        loc_t         loc        = {0, };
-        qr_fd_ctx_t  *qr_fd_ctx  = NULL;
-        int32_t       ret        = -1, op_ret = -1, op_errno = EINVAL;
-        char          need_open  = 0, can_wind = 0, need_unwind = 0;
-        call_frame_t *open_frame = NULL;
+        return qr_range_helper (frame, this, GF_FOP_FALLOCATE, fd, mode,
+                                offset, len);
+}
 
-        GF_ASSERT (frame);
-        if ((this == NULL) || (fd == NULL)) {
-                gf_log (frame->this->name, GF_LOG_WARNING,
-                        (this == NULL) ? "xlator object (this) is NULL"
-                        : "fd is NULL");
-                need_unwind = 1;
-                goto out;
-        }
+
+int32_t
+qr_discard_helper (call_frame_t *frame, xlator_t *this, fd_t *fd,
+                   off_t offset, size_t len)
+{
+        return qr_range_helper (frame, this, GF_FOP_DISCARD, fd, 0, offset,
+                                len);
+}
+
+
+int32_t
+qr_zerofill_helper (call_frame_t *frame, xlator_t *this, fd_t *fd,
+                    off_t offset, size_t len)
+{
+        return qr_range_helper (frame, this, GF_FOP_ZEROFILL, fd, 0, offset,
+                                len);
+}
+
+
+static call_stub_t *
+qr_range_stub (call_frame_t *frame, glusterfs_fop_t fop, fd_t *fd,
+               int32_t mode, off_t offset, size_t len)
+{
+        if (fop == GF_FOP_FALLOCATE)
+                return fop_fallocate_stub (frame, qr_fallocate_helper, fd,
+                                           mode, offset, len);
+        else if (fop == GF_FOP_DISCARD)
+                return fop_discard_stub (frame, qr_discard_helper, fd,
+                                         offset, len);
+        else
+                return fop_zerofill_stub (frame, qr_zerofill_helper, fd,
+                                          offset, len);
+}
+
+
+/* fallocate, discard and zerofill change the content of the range they
+   cover, so the cached content goes like it does for a write; an fd whose
+   open is still pending queues the fop behind it */
+static int32_t
+qr_range_fop (call_frame_t *frame, xlator_t *this, glusterfs_fop_t fop,
+              fd_t *fd, int32_t mode, off_t offset, size_t len)
+{
+        uint64_t          value      = 0;
+        int               flags      = 0;
+        call_stub_t      *stub       = NULL;
+        char             *path       = NULL;
+        loc_t             loc        = {0, };
+        qr_inode_t       *qr_inode   = NULL;
+        qr_fd_ctx_t      *qr_fd_ctx  = NULL;
+        int32_t           op_ret     = -1, op_errno = -1, ret = -1;
+        char              can_wind   = 0, need_unwind = 0, need_open = 0;
+        qr_private_t     *priv       = NULL;
+        qr_inode_table_t *table      = NULL;
+        call_frame_t     *open_frame = NULL;
+
+        priv = this->private;
+        table = &priv->table;
 
         ret = fd_ctx_get (fd, this, &value);
+
         if (ret == 0) {
-                qr_fd_ctx = (qr_fd_ctx_t *)(long)value;
+                qr_fd_ctx = (qr_fd_ctx_t *)(long) value;
+        }
+
+        LOCK (&table->lock);
+        {
+                ret = inode_ctx_get (fd->inode, this, &value);
+                if (ret == 0) {
+                        qr_inode = (qr_inode_t *)(long)value;
+                        if (qr_inode != NULL) {
+                                inode_ctx_del (fd->inode, this, NULL);
+                                __qr_inode_free (qr_inode);
+                        }
+                }
         }
+        UNLOCK (&table->lock);
 
         if (qr_fd_ctx) {
                 LOCK (&qr_fd_ctx->lock);
@@ -3092,8 +3198,8 @@ qr_lk (call_frame_t *frame, xlator_t *this, fd_t *fd, int32_t cmd,
                                         goto unlock;
                                 }
 
-                                stub = fop_lk_stub (frame, qr_lk_helper, fd,
-                                                    cmd, lock);
+                                stub = qr_range_stub (frame, fop, fd, mode,
+                                                      offset, len);
                                 if (stub == NULL) {
                                         op_ret = -1;
                                         op_errno = ENOMEM;
@@ -3112,12 +3218,11 @@ qr_lk (call_frame_t *frame, xlator_t *this, fd_t *fd, int32_t cmd,
                 can_wind = 1;
         }
 
-out:
         if (need_unwind) {
-                QR_STACK_UNWIND (lk, frame, op_ret, op_errno, NULL);
+                QR_STACK_UNWIND (fallocate, frame, op_ret, op_errno, NULL,
+                                 NULL);
         } else if (can_wind) {
-                STACK_WIND (frame, qr_lk_cbk, FIRST_CHILD(this),
-                            FIRST_CHILD(this)->fops->lk, fd, cmd, lock);
+                qr_range_wind (frame, this, fop, fd, mode, offset, len);
         } else if (need_open) {
                 op_ret = qr_loc_fill (&loc, fd->inode, path);
                 if (op_ret == -1) {
@@ -3145,16 +3250,551 @@ ret:
 
 
 int32_t
-qr_release (xlator_t *this, fd_t *fd)
+qr_fallocate (call_frame_t *frame, xlator_t *this, fd_t *fd, int32_t mode,
+              off_t offset, size_t len)
 {
-        qr_fd_ctx_t *qr_fd_ctx = NULL;
-        int32_t      ret       = 0;
-        uint64_t     value     = 0;
+        return qr_range_fop (frame, this, GF_FOP_FALLOCATE, fd, mode, offset,
+                             len);
+}
 
-        GF_VALIDATE_OR_GOTO ("quick-read", this, out);
-        GF_VALIDATE_OR_GOTO (this->name, fd, out);
 
-        ret = fd_ctx_del (fd, this, &value);
+int32_t
+qr_discard (call_frame_t *frame, xlator_t *this, fd_t *fd, off_t offset,
+            size_t len)
+{
+        return qr_range_fop (frame, this, GF_FOP_DISCARD, fd, 0, offset, len);
+}
+
+
+int32_t
+qr_zerofill (call_frame_t *frame, xlator_t *this, fd_t *fd, off_t offset,
+             size_t len)
+{
+        return qr_range_fop (frame, this, GF_FOP_ZEROFILL, fd, 0, offset, len);
+}
+
+
+int32_t
+qr_lk_cbk (call_frame_t *frame, void *cookie, xlator_t *this, int32_t op_ret,
+           int32_t op_errno, struct gf_flock *lock)
+{
+        GF_ASSERT (frame);
+        QR_STACK_UNWIND (lk, frame, op_ret, op_errno, lock);
+        return 0;
+}
+
+
+int32_t
+qr_lk_helper (call_frame_t *frame, xlator_t *this, fd_t *fd, int32_t cmd,
+              struct gf_flock *lock)
+{
+        qr_local_t  *local    = NULL;
+        qr_fd_ctx_t *fdctx    = NULL;
+        uint64_t     value    = 0;
+        int32_t      ret      = 0;
+        int32_t      op_errno = EINVAL;
+
+        GF_ASSERT (frame);
+
+        local = frame->local;
+        GF_VALIDATE_OR_GOTO (frame->this->name, local, unwind);
+        GF_VALIDATE_OR_GOTO (frame->this->name, this, unwind);
+        GF_VALIDATE_OR_GOTO (frame->this->name, fd, unwind);
+
+        if (local->op_ret < 0) {
+                op_errno = local->op_errno;
+
+                ret = fd_ctx_get (fd, this, &value);
+                if (ret == 0) {
+                        fdctx = (qr_fd_ctx_t *)(long) value;
+                }
+
+                gf_log (this->name, GF_LOG_WARNING,
+                        "open failed on path (%s) (%s), unwinding lk call",
+                        fdctx ? fdctx->path : NULL, strerror (op_errno));
+                goto unwind;
+        }
+
+        STACK_WIND (frame, qr_lk_cbk, FIRST_CHILD(this),
+                    FIRST_CHILD(this)->fops->lk, fd, cmd, lock);
+
+        return 0;
+
+unwind:
+        QR_STACK_UNWIND (lk, frame, -1, op_errno, NULL);
+        return 0;
+}
+
+
+int32_t
+qr_lk (call_frame_t *frame, xlator_t *this, fd_t *fd, int32_t cmd,
+       struct gf_flock *lock)
+{
+        int           flags      = 0;
+        uint64_t      value      = 0;
+        call_stub_t  *stub       = NULL;
+        char         *path       = NULL;
+        loc_t         loc        = {0, };
+        qr_fd_ctx_t  *qr_fd_ctx  = NULL;
+        int32_t       ret        = -1, op_ret = -1, op_errno = EINVAL;
+        char          need_open  = 0, can_wind = 0, need_unwind = 0;
+        call_frame_t *open_frame = NULL;
+
+        GF_ASSERT (frame);
+        if ((this == NULL) || (fd == NULL)) {
+                gf_log (frame->this->name, GF_LOG_WARNING,
+                        (this == NULL) ? "xlator object (this) is NULL"
+                        : "fd is NULL");
+                need_unwind = 1;
+                goto out;
+        }
+
+        ret = fd_ctx_get (fd, this, &value);
+        if (ret == 0) {
+                qr_fd_ctx = (qr_fd_ctx_t *)(long)value;
+        }
+
+        if (qr_fd_ctx) {
+                LOCK (&qr_fd_ctx->lock);
+                {
+                        path = qr_fd_ctx->path;
+                        flags = qr_fd_ctx->flags;
+
+                        if (!(qr_fd_ctx->opened
+                              || qr_fd_ctx->open_in_transit)) {
+                                need_open = 1;
+                                qr_fd_ctx->open_in_transit = 1;
+                        }
+
+                        if (qr_fd_ctx->opened) {
+                                can_wind = 1;
+                        } else {
+                                frame->local = GF_CALLOC (1,
+                                                          sizeof (qr_local_t),
+                                                          gf_qr_mt_qr_local_t);
+                                if (frame->local == NULL) {
+                                        op_ret = -1;
+                                        op_errno = ENOMEM;
+                                        need_unwind = 1;
+                                        qr_fd_ctx->open_in_transit = 0;
+                                        goto unlock;
+                                }
+
+                                stub = fop_lk_stub (frame, qr_lk_helper, fd,
+                                                    cmd, lock);
+                                if (stub == NULL) {
+                                        op_ret = -1;
+                                        op_errno = ENOMEM;
+                                        need_unwind = 1;
+                                        qr_fd_ctx->open_in_transit = 0;
+                                        goto unlock;
+                                }
+
+                                list_add_tail (&stub->list,
+                                               &qr_fd_ctx->waiting_ops);
+                        }
+                }
+        unlock:
+                UNLOCK (&qr_fd_ctx->lock);
+        } else {
+                can_wind = 1;
+        }
+
+out:
+        if (need_unwind) {
+                QR_STACK_UNWIND (lk, frame, op_ret, op_errno, NULL);
+        } else if (can_wind) {
+                STACK_WIND (frame, qr_lk_cbk, FIRST_CHILD(this),
+                            FIRST_CHILD(this)->fops->lk, fd, cmd, lock);
+        } else if (need_open) {
+                op_ret = qr_loc_fill (&loc, fd->inode, path);
+                if (op_ret == -1) {
+                        qr_resume_pending_ops (qr_fd_ctx, -1, errno);
+                        goto ret;
+                }
+
+                open_frame = create_frame (this, this->ctx->pool);
+                if (open_frame == NULL) {
+                        qr_resume_pending_ops (qr_fd_ctx, -1, ENOMEM);
+                        qr_loc_wipe (&loc);
+                        goto ret;
+                }
+
+                STACK_WIND (open_frame, qr_open_cbk, FIRST_CHILD(this),
+                            FIRST_CHILD(this)->fops->open, &loc, flags, fd,
+                            qr_fd_ctx->wbflags);
+
+                qr_loc_wipe (&loc);
+        }
+
+ret:
+        return 0;
+}
+
+
+/*
+ * Directory prefetch: once a readdirp returned the attributes of small
+ * regular files which are not cached yet, their content is fetched in the
+ * background with compounds of GF_COMPOUND_MAX_FOPS lookups each carrying
+ * GF_CONTENT_KEY, one RPC per subvolume holding some of the files. At most
+ * prefetch-max-batches compounds are in flight, the files of a readdirp
+ * which find no room are left to the regular lookups. New inodes are
+ * linked in the table without being looked up, and referenced by the last
+ * QR_PREFETCH_HELD prefetched files, so that the lookup of the kernel
+ * still finds them.
+ */
+static int32_t
+qr_prefetch_cbk (call_frame_t *frame, void *cookie, xlator_t *this,
+                 int32_t op_ret, int32_t op_errno, compound_args_t *args)
+{
+        compound_req_t   *req        = NULL;
+        compound_rsp_t   *rsp        = NULL;
+        compound_args_t  *rest       = NULL;
+        qr_private_t     *priv       = NULL;
+        inode_t          *link_inode = NULL;
+        inode_t          *held[GF_COMPOUND_MAX_FOPS] = {NULL, };
+        data_t           *content    = NULL;
+        uint64_t          prefetched = 0;
+        int               i          = 0;
+
+        priv = this->private;
+
+        for (i = 0; i < args->done; i++) {
+                req = &args->req[i];
+                rsp = &args->rsp[i];
+
+                if ((rsp->op_ret != 0) || (rsp->xattr == NULL)
+                    || !IA_ISREG (rsp->stat.ia_type)
+                    || (rsp->stat.ia_size > priv->conf.max_file_size))
+                        continue;
+
+                content = dict_get (rsp->xattr, GF_CONTENT_KEY);
+                if (content == NULL)
+                        continue;
+
+                link_inode = inode_link (req->loc.inode, req->loc.parent,
+                                         req->loc.name, &rsp->stat);
+                if (link_inode == NULL)
+                        continue;
+
+                if (qr_content_update (this, link_inode, req->loc.path,
+                                       &rsp->stat, content) == 0)
+                        held[prefetched++] = link_inode;
+                else
+                        inode_unref (link_inode);
+        }
+
+        /* a compound which went whole to a brick stopped at its first
+           failure (e.g. a file unlinked since the readdirp), the files
+           after it are asked for again in the same batch */
+        if ((args->done > 0) && (args->done < args->count)) {
+                rest = compound_args_new ();
+                for (i = args->done; rest && (i < args->count); i++) {
+                        req = &args->req[i];
+                        if (compound_lookup (rest, &req->loc,
+                                             req->xattr) < 0) {
+                                compound_args_destroy (rest);
+                                rest = NULL;
+                        }
+                }
+        }
+
+        /* the kernel has not looked the new inodes up, they are kept from
+           being retired until as many files were prefetched after them */
+        LOCK (&priv->table.lock);
+        {
+                priv->prefetched += prefetched;
+                if (rest == NULL)
+                        priv->prefetch_batches--;
+
+                for (i = 0; i < prefetched; i++) {
+                        link_inode = priv->prefetch_held[priv->held_next];
+                        priv->prefetch_held[priv->held_next] = held[i];
+                        held[i] = link_inode;
+                        priv->held_next = (priv->held_next + 1)
+                                % QR_PREFETCH_HELD;
+                }
+        }
+        UNLOCK (&priv->table.lock);
+
+        for (i = 0; i < prefetched; i++) {
+                if (held[i] != NULL)
+                        inode_unref (held[i]);
+        }
+
+        compound_args_destroy (args);
+
+        if (rest != NULL) {
+                STACK_WIND (frame, qr_prefetch_cbk, FIRST_CHILD (this),
+                            FIRST_CHILD (this)->fops->compound, rest);
+                return 0;
+        }
+
+        STACK_DESTROY (frame->root);
+
+        return 0;
+}
+
+
+/* winds @args in a batch already counted in prefetch_batches */
+static void
+qr_prefetch_wind (call_frame_t *frame, xlator_t *this, compound_args_t *args)
+{
+        call_frame_t *prefetch_frame = NULL;
+        qr_private_t *priv           = NULL;
+
+        priv = this->private;
+
+        /* with the credentials of the readdirp */
+        prefetch_frame = copy_frame (frame);
+        if (prefetch_frame == NULL) {
+                compound_args_destroy (args);
+
+                LOCK (&priv->table.lock);
+                {
+                        priv->prefetch_batches--;
+                }
+                UNLOCK (&priv->table.lock);
+                return;
+        }
+
+        STACK_WIND (prefetch_frame, qr_prefetch_cbk, FIRST_CHILD (this),
+                    FIRST_CHILD (this)->fops->compound, args);
+}
+
+
+/* true if @inode holds content still matching @stbuf, which revalidates it */
+static char
+qr_prefetch_cached (xlator_t *this, inode_t *inode, struct iatt *stbuf)
+{
+        qr_private_t *priv     = NULL;
+        qr_inode_t   *qr_inode = NULL;
+        uint64_t      value    = 0;
+        char          cached   = 0;
+
+        priv = this->private;
+
+        LOCK (&priv->table.lock);
+        {
+                if (inode_ctx_get (inode, this, &value) == 0)
+                        qr_inode = (qr_inode_t *)(long) value;
+
+                if ((qr_inode != NULL) && (qr_inode->iobuf != NULL)
+                    && (qr_inode->stbuf.ia_mtime == stbuf->ia_mtime)
+                    && (qr_inode->stbuf.ia_mtime_nsec
+                        == stbuf->ia_mtime_nsec)) {
+                        gettimeofday (&qr_inode->tv, NULL);
+                        cached = 1;
+                }
+        }
+        UNLOCK (&priv->table.lock);
+
+        return cached;
+}
+
+
+/* a new compound, for a batch which found room among the ones in flight */
+static compound_args_t *
+qr_prefetch_batch_new (qr_private_t *priv)
+{
+        compound_args_t *args = NULL;
+        char             room = 0;
+
+        LOCK (&priv->table.lock);
+        {
+                if (priv->prefetch_batches < priv->conf.prefetch_max_batches) {
+                        priv->prefetch_batches++;
+                        room = 1;
+                }
+        }
+        UNLOCK (&priv->table.lock);
+
+        if (!room)
+                return NULL;
+
+        args = compound_args_new ();
+        if (args == NULL) {
+                LOCK (&priv->table.lock);
+                {
+                        priv->prefetch_batches--;
+                }
+                UNLOCK (&priv->table.lock);
+        }
+
+        return args;
+}
+
+
+static void
+qr_prefetch (call_frame_t *frame, xlator_t *this, fd_t *fd,
+             gf_dirent_t *entries)
+{
+        qr_private_t    *priv      = NULL;
+        qr_conf_t       *conf      = NULL;
+        gf_dirent_t     *entry     = NULL;
+        compound_args_t *args      = NULL;
+        dict_t          *xattr_req = NULL;
+        inode_t         *inode     = NULL;
+        char            *path      = NULL;
+        loc_t            loc       = {0, };
+        uint64_t         budget    = 0;
+        uint64_t         sent      = 0;
+        int              ret       = -1;
+
+        priv = this->private;
+        conf = &priv->conf;
+
+        /* never prefetch more than the cache has room for */
+        LOCK (&priv->table.lock);
+        {
+                if (conf->cache_size > priv->table.cache_used)
+                        budget = conf->cache_size - priv->table.cache_used;
+        }
+        UNLOCK (&priv->table.lock);
+
+        if (budget == 0)
+                goto out;
+
+        xattr_req = dict_new ();
+        if (xattr_req == NULL)
+                goto out;
+
+        ret = dict_set (xattr_req, GF_CONTENT_KEY,
+                        data_from_uint64 (conf->max_file_size));
+        if (ret < 0)
+                goto out;
+
+        list_for_each_entry (entry, &entries->list, list) {
+                if (!IA_ISREG (entry->d_stat.ia_type)
+                    || (entry->d_stat.ia_size > conf->max_file_size)
+                    || (entry->d_stat.ia_size > budget)
+                    || uuid_is_null (entry->d_stat.ia_gfid))
+                        continue;
+
+                inode = inode_find (fd->inode->table, entry->d_stat.ia_gfid);
+                if (inode != NULL) {
+                        if (qr_prefetch_cached (this, inode,
+                                                &entry->d_stat)) {
+                                inode_unref (inode);
+                                continue;
+                        }
+                } else {
+                        inode = inode_new (fd->inode->table);
+                        if (inode == NULL)
+                                break;
+                }
+
+                ret = inode_path (fd->inode, entry->d_name, &path);
+                if (ret < 0) {
+                        inode_unref (inode);
+                        continue;
+                }
+
+                loc.path   = path;
+                loc.name   = strrchr (path, '/') + 1;
+                loc.inode  = inode;
+                loc.parent = inode_ref (fd->inode);
+
+                if (args == NULL)
+                        args = qr_prefetch_batch_new (priv);
+
+                if (args != NULL)
+                        ret = compound_lookup (args, &loc, xattr_req);
+
+                loc_wipe (&loc);
+                path = NULL;
+
+                if ((args == NULL) || (ret < 0))
+                        break;
+
+                budget -= entry->d_stat.ia_size;
+                sent++;
+
+                if (args->count == GF_COMPOUND_MAX_FOPS) {
+                        qr_prefetch_wind (frame, this, args);
+                        args = NULL;
+                }
+        }
+
+        if (args != NULL) {
+                if (args->count > 0) {
+                        qr_prefetch_wind (frame, this, args);
+                } else {
+                        compound_args_destroy (args);
+
+                        LOCK (&priv->table.lock);
+                        {
+                                priv->prefetch_batches--;
+                        }
+                        UNLOCK (&priv->table.lock);
+                }
+        }
+
+        LOCK (&priv->table.lock);
+        {
+                priv->prefetch_sent += sent;
+        }
+        UNLOCK (&priv->table.lock);
+
+out:
+        if (xattr_req != NULL)
+                dict_unref (xattr_req);
+}
+
+
+int32_t
+qr_readdirp_cbk (call_frame_t *frame, void *cookie, xlator_t *this,
+                 int32_t op_ret, int32_t op_errno, gf_dirent_t *entries)
+{
+        qr_local_t *local = NULL;
+
+        local = frame->local;
+
+        if ((op_ret > 0) && (local != NULL) && (local->fd != NULL)) {
+                qr_prefetch (frame, this, local->fd, entries);
+        }
+
+        QR_STACK_UNWIND (readdirp, frame, op_ret, op_errno, entries);
+        return 0;
+}
+
+
+int32_t
+qr_readdirp (call_frame_t *frame, xlator_t *this, fd_t *fd, size_t size,
+             off_t offset)
+{
+        qr_private_t *priv  = NULL;
+        qr_local_t   *local = NULL;
+
+        priv = this->private;
+
+        if (priv->conf.prefetch_dir && (priv->conf.max_file_size > 0)) {
+                /* prefetch is best effort, go without it on ENOMEM */
+                local = GF_CALLOC (1, sizeof (*local), gf_qr_mt_qr_local_t);
+                if (local != NULL) {
+                        local->fd = fd;
+                }
+
+                frame->local = local;
+        }
+
+        STACK_WIND (frame, qr_readdirp_cbk, FIRST_CHILD (this),
+                    FIRST_CHILD (this)->fops->readdirp, fd, size, offset);
+        return 0;
+}
+
+
+int32_t
+qr_release (xlator_t *this, fd_t *fd)
+{
+        qr_fd_ctx_t *qr_fd_ctx = NULL;
+        int32_t      ret       = 0;
+        uint64_t     value     = 0;
+
+        GF_VALIDATE_OR_GOTO ("quick-read", this, out);
+        GF_VALIDATE_OR_GOTO (this->name, fd, out);
+
+        ret = fd_ctx_del (fd, this, &value);
         if (ret == 0) {
                 qr_fd_ctx = (qr_fd_ctx_t *)(long) value;
                 if (qr_fd_ctx) {
@@ -3219,7 +3859,7 @@ qr_inodectx_dump (xlator_t *this, inode_t *inode)
                                 "inodectx");
         gf_proc_dump_add_section (key_prefix);
 
-        gf_proc_dump_write ("entire-file-cached", "%s", qr_inode->xattr ? "yes" : "no");
+        gf_proc_dump_write ("entire-file-cached", "%s", qr_inode->iobuf ? "yes" : "no");
 
         tm = localtime (&qr_inode->tv.tv_sec);
         strftime (buf, 256, "%Y-%m-%d %H:%M:%S", tm);
@@ -3329,6 +3969,19 @@ qr_priv_dump (xlator_t *this)
 
         gf_proc_dump_write ("max_file_size", "%d", conf->max_file_size);
         gf_proc_dump_write ("cache_timeout", "%d", conf->cache_timeout);
+        gf_proc_dump_write ("background_revalidate", "%s",
+                            conf->bg_revalidate ? "on" : "off");
+        gf_proc_dump_write ("background_revalidated", "%"PRIu64,
+                            priv->revalidated);
+        gf_proc_dump_write ("background_revalidate_stale", "%"PRIu64,
+                            priv->revalidate_stale);
+        gf_proc_dump_write ("prefetch_directory", "%s",
+                            conf->prefetch_dir ? "on" : "off");
+        gf_proc_dump_write ("prefetch_max_batches", "%d",
+                            conf->prefetch_max_batches);
+        gf_proc_dump_write ("prefetch_batches", "%d", priv->prefetch_batches);
+        gf_proc_dump_write ("prefetch_sent", "%"PRIu64, priv->prefetch_sent);
+        gf_proc_dump_write ("prefetched", "%"PRIu64, priv->prefetched);
 
         if (!table) {
                 gf_log (this->name, GF_LOG_WARNING, "table is NULL");
@@ -3405,6 +4058,260 @@ out:
         return ret;
 }
 
+/*
+ * background revalidation: every half cache-timeout, the files served from
+ * the cache since the previous round and about to time out are revalidated
+ * with bulkstats of up to GF_BULKSTAT_MAX_COUNT files, one after the other
+ * till the table has been walked, instead of one stat per file on the next
+ * read. files found modified are dropped from the cache.
+ */
+static int32_t
+qr_revalidate_interval (qr_conf_t *conf)
+{
+        return (conf->cache_timeout > 2) ? (conf->cache_timeout / 2) : 1;
+}
+
+
+static void
+qr_revalidate_timer (void *data);
+
+static void
+qr_revalidate_batch (xlator_t *this);
+
+/* To be called with priv->table.lock held */
+static void
+__qr_revalidate_arm (xlator_t *this)
+{
+        qr_private_t   *priv  = NULL;
+        struct timeval  delay = {0, };
+
+        priv = this->private;
+
+        if (!priv->conf.bg_revalidate || priv->revalidate_timer)
+                return;
+
+        delay.tv_sec = qr_revalidate_interval (&priv->conf);
+        priv->revalidate_timer = gf_timer_call_after (this->ctx, delay,
+                                                      qr_revalidate_timer,
+                                                      this);
+        if (!priv->revalidate_timer)
+                gf_log (this->name, GF_LOG_WARNING,
+                        "cannot schedule background revalidation");
+}
+
+
+/* To be called with priv->table.lock held */
+static void
+__qr_revalidate_stop (xlator_t *this)
+{
+        qr_private_t *priv = NULL;
+
+        priv = this->private;
+
+        if (priv->revalidate_timer) {
+                gf_timer_call_cancel (this->ctx, priv->revalidate_timer);
+                priv->revalidate_timer = NULL;
+        }
+}
+
+
+static int32_t
+qr_revalidate_cbk (call_frame_t *frame, void *cookie, xlator_t *this,
+                   int32_t op_ret, int32_t op_errno, struct iatt *bufs,
+                   int32_t *op_errnos)
+{
+        qr_private_t     *priv     = NULL;
+        qr_inode_table_t *table    = NULL;
+        qr_inode_t       *qr_inode = NULL;
+        loc_t            *locs     = NULL;
+        uint64_t          value    = 0;
+        int32_t           i        = 0;
+        char              more     = 0;
+
+        priv = this->private;
+        table = &priv->table;
+        locs = cookie;
+
+        if (op_ret < 0) {
+                gf_log (this->name, GF_LOG_DEBUG,
+                        "background revalidation failed (%s)",
+                        strerror (op_errno));
+        }
+
+        LOCK (&table->lock);
+        {
+                for (i = 0; i < op_ret; i++) {
+                        if (op_errnos[i] != 0)
+                                continue;
+
+                        value = 0;
+                        inode_ctx_get (locs[i].inode, this, &value);
+                        qr_inode = (qr_inode_t *)(long) value;
+                        if ((qr_inode == NULL) || (qr_inode->iobuf == NULL))
+                                continue;
+
+                        if ((qr_inode->stbuf.ia_mtime == bufs[i].ia_mtime)
+                            && (qr_inode->stbuf.ia_mtime_nsec
+                                == bufs[i].ia_mtime_nsec)) {
+                                gettimeofday (&qr_inode->tv, NULL);
+                                priv->revalidated++;
+                                continue;
+                        }
+
+                        table->cache_used -= qr_inode->stbuf.ia_size;
+                        inode_ctx_del (locs[i].inode, this, NULL);
+                        __qr_inode_free (qr_inode);
+                        priv->revalidate_stale++;
+                }
+
+                priv->revalidating = 0;
+
+                more = priv->revalidate_more;
+                priv->revalidate_more = 0;
+        }
+        UNLOCK (&table->lock);
+
+        bulkstat_locs_wipe (locs, GF_BULKSTAT_MAX_COUNT);
+        STACK_DESTROY (frame->root);
+
+        /* a failed batch waits for the timer, as would the next ones */
+        if (more && (op_ret >= 0))
+                qr_revalidate_batch (this);
+
+        return 0;
+}
+
+
+static void
+qr_revalidate_timer (void *data)
+{
+        xlator_t         *this  = NULL;
+        qr_private_t     *priv  = NULL;
+        qr_inode_table_t *table = NULL;
+
+        this = data;
+        priv = this->private;
+        table = &priv->table;
+
+        LOCK (&table->lock);
+        {
+                if (priv->revalidate_timer) {
+                        gf_timer_call_cancel (this->ctx,
+                                              priv->revalidate_timer);
+                        priv->revalidate_timer = NULL;
+                }
+
+                __qr_revalidate_arm (this);
+        }
+        UNLOCK (&table->lock);
+
+        qr_revalidate_batch (this);
+}
+
+
+/* revalidates the next GF_BULKSTAT_MAX_COUNT files due, the ones taken are
+   marked as not accessed so that the next batch goes on past them */
+static void
+qr_revalidate_batch (xlator_t *this)
+{
+        qr_private_t     *priv     = NULL;
+        qr_conf_t        *conf     = NULL;
+        qr_inode_table_t *table    = NULL;
+        qr_inode_t       *qr_inode = NULL;
+        inode_table_t    *itable   = NULL;
+        inode_t          *inode    = NULL;
+        call_frame_t     *frame    = NULL;
+        loc_t            *locs     = NULL;
+        uuid_t           *gfids    = NULL;
+        struct timeval    now      = {0, };
+        int32_t           interval = 0;
+        int32_t           count    = 0;
+        int32_t           filled   = 0;
+        int32_t           i        = 0;
+
+        priv = this->private;
+        conf = &priv->conf;
+        table = &priv->table;
+
+        gfids = GF_CALLOC (GF_BULKSTAT_MAX_COUNT, sizeof (*gfids),
+                           gf_common_mt_bulkstat_t);
+        locs = GF_CALLOC (GF_BULKSTAT_MAX_COUNT, sizeof (*locs),
+                          gf_common_mt_bulkstat_t);
+
+        gettimeofday (&now, NULL);
+
+        LOCK (&table->lock);
+        {
+                if (!gfids || !locs || priv->revalidating
+                    || !conf->bg_revalidate)
+                        goto unlock;
+
+                interval = qr_revalidate_interval (conf);
+
+                for (i = 0; (i < conf->max_pri)
+                             && !priv->revalidate_more; i++) {
+                        list_for_each_entry (qr_inode, &table->lru[i], lru) {
+                                if (!qr_inode->accessed || !qr_inode->iobuf
+                                    || (qr_time_elapsed (&now, &qr_inode->tv)
+                                        + interval < conf->cache_timeout))
+                                        continue;
+
+                                if (count == GF_BULKSTAT_MAX_COUNT) {
+                                        priv->revalidate_more = 1;
+                                        break;
+                                }
+
+                                /* only referenced out of the lock, through
+                                   inode_find(): qr_forget() may be waiting
+                                   for the lock on a retired inode */
+                                qr_inode->accessed = 0;
+                                itable = qr_inode->inode->table;
+                                uuid_copy (gfids[count++],
+                                           qr_inode->inode->gfid);
+                        }
+                }
+
+                if (count)
+                        priv->revalidating = 1;
+        }
+unlock:
+        UNLOCK (&table->lock);
+
+        for (i = 0; i < count; i++) {
+                inode = inode_find (itable, gfids[i]);
+                if (inode == NULL)
+                        continue;
+
+                if (bulkstat_loc_fill (&locs[filled], inode) == 0)
+                        filled++;
+
+                inode_unref (inode);
+        }
+
+        if (count && filled)
+                frame = create_frame (this, this->ctx->pool);
+
+        if (frame == NULL) {
+                if (count) {
+                        LOCK (&table->lock);
+                        {
+                                priv->revalidating = 0;
+                                priv->revalidate_more = 0;
+                        }
+                        UNLOCK (&table->lock);
+                }
+                bulkstat_locs_wipe (locs, GF_BULKSTAT_MAX_COUNT);
+                goto out;
+        }
+
+        STACK_WIND_COOKIE (frame, qr_revalidate_cbk, locs, FIRST_CHILD (this),
+                           FIRST_CHILD (this)->fops->bulkstat, locs, filled);
+out:
+        if (gfids != NULL)
+                GF_FREE (gfids);
+}
+
+
 int
 reconfigure (xlator_t *this, dict_t *options)
 {
@@ -3435,6 +4342,24 @@ reconfigure (xlator_t *this, dict_t *options)
         }
         conf->cache_size = cache_size_new;
 
+        GF_OPTION_RECONF ("background-revalidate", conf->bg_revalidate,
+                          options, bool, out);
+
+        GF_OPTION_RECONF ("prefetch-directory", conf->prefetch_dir, options,
+                          bool, out);
+
+        GF_OPTION_RECONF ("prefetch-max-batches", conf->prefetch_max_batches,
+                          options, int32, out);
+
+        LOCK (&priv->table.lock);
+        {
+                if (conf->bg_revalidate)
+                        __qr_revalidate_arm (this);
+                else
+                        __qr_revalidate_stop (this);
+        }
+        UNLOCK (&priv->table.lock);
+
         ret = 0;
 out:
         return ret;
@@ -3581,6 +4506,14 @@ init (xlator_t *this)
                 goto out;
         }
 
+        GF_OPTION_INIT ("background-revalidate", conf->bg_revalidate, bool,
+                        out);
+
+        GF_OPTION_INIT ("prefetch-directory", conf->prefetch_dir, bool, out);
+
+        GF_OPTION_INIT ("prefetch-max-batches", conf->prefetch_max_batches,
+                        int32, out);
+
         INIT_LIST_HEAD (&conf->priority_list);
         conf->max_pri = 1;
         if (dict_get (this->options, "priority")) {
@@ -3612,6 +4545,12 @@ init (xlator_t *this)
         ret = 0;
 
         this->private = priv;
+
+        LOCK (&priv->table.lock);
+        {
+                __qr_revalidate_arm (this);
+        }
+        UNLOCK (&priv->table.lock);
 out:
         if ((ret == -1) && priv) {
                 GF_FREE (priv);
@@ -3624,6 +4563,19 @@ out:
 void
 fini (xlator_t *this)
 {
+        qr_private_t *priv = NULL;
+
+        priv = this->private;
+        if (priv == NULL)
+                return;
+
+        LOCK (&priv->table.lock);
+        {
+                priv->conf.bg_revalidate = _gf_false;
+                __qr_revalidate_stop (this);
+        }
+        UNLOCK (&priv->table.lock);
+
         return;
 }
 
@@ -3640,8 +4592,12 @@ struct xlator_fops fops = {
         .finodelk    = qr_finodelk,
         .fsync       = qr_fsync,
         .ftruncate   = qr_ftruncate,
+        .fallocate   = qr_fallocate,
+        .discard     = qr_discard,
+        .zerofill    = qr_zerofill,
         .lk          = qr_lk,
         .fsetattr    = qr_fsetattr,
+        .readdirp    = qr_readdirp,
 };
 
 struct xlator_cbks cbks = {
@@ -3678,4 +4634,28 @@ struct volume_options options[] = {
           .max  = 1 * GF_UNIT_KB * 1000,
           .default_value = "64KB",
         },
+        { .key  = {"background-revalidate"},
+          .type = GF_OPTION_TYPE_BOOL,
+          .default_value = "off",
+          .description = "Revalidate the recently read files in the "
+          "background, in batches of one bulkstat call, before their "
+          "cache-timeout expires. Needs servers supporting bulkstat."
+        },
+        { .key  = {"prefetch-directory"},
+          .type = GF_OPTION_TYPE_BOOL,
+          .default_value = "off",
+          .description = "Fetch the content of the small files listed by a "
+          "readdirp in the background, with one compound call for every "
+          "few files."
+        },
+        { .key  = {"prefetch-max-batches"},
+          .type = GF_OPTION_TYPE_INT,
+          .min  = 1,
+          .max  = 64,
+          .default_value = "4",
+          .description = "Maximum number of prefetch-directory compound "
+          "calls in flight, the files of a readdirp beyond them are not "
+          "prefetched."
+        },
+        { .key  = {NULL} },
 };
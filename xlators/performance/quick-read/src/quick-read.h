@@ -35,6 +35,8 @@
 #include "common-utils.h"
 #include "call-stub.h"
 #include "defaults.h"
+#include "timer.h"
+#include "compound.h"
 #include <libgen.h>
 #include <sys/time.h>
 #include <sys/types.h>
@@ -43,6 +45,9 @@
 #include <fnmatch.h>
 #include "quick-read-mem-types.h"
 
+/* prefetched inodes kept referenced until the kernel looks them up */
+#define QR_PREFETCH_HELD 1024
+
 struct qr_fd_ctx {
         char              opened;
         char              disabled;
@@ -68,12 +73,14 @@ struct qr_local {
 typedef struct qr_local qr_local_t;
 
 struct qr_inode {
-        dict_t           *xattr;
+        struct iobuf     *iobuf;    /* file content, handed out by readv */
+        size_t            content_len;
         inode_t          *inode;
         int               priority;
         struct iatt       stbuf;
         struct timeval    tv;
         struct list_head  lru;
+        char              accessed; /* since last background revalidation */
 };
 typedef struct qr_inode qr_inode_t;
 
@@ -90,6 +97,9 @@ struct qr_conf {
         uint64_t         cache_size;
         int              max_pri;
         struct list_head priority_list;
+        gf_boolean_t     bg_revalidate;
+        gf_boolean_t     prefetch_dir;
+        int32_t          prefetch_max_batches;
 };
 typedef struct qr_conf qr_conf_t;
 
@@ -103,6 +113,16 @@ typedef struct qr_inode_table qr_inode_table_t;
 struct qr_private {
         qr_conf_t         conf;
         qr_inode_table_t  table;
+        gf_timer_t       *revalidate_timer;  /* under table.lock */
+        char              revalidating;      /* a bulkstat is in flight */
+        char              revalidate_more;   /* and more files are due */
+        uint64_t          revalidated;
+        uint64_t          revalidate_stale;
+        int32_t           prefetch_batches;  /* compounds in flight */
+        uint64_t          prefetch_sent;     /* files asked for by prefetch */
+        uint64_t          prefetched;        /* and cached from the reply */
+        inode_t          *prefetch_held[QR_PREFETCH_HELD];
+        int               held_next;         /* oldest of prefetch_held */
 };
 typedef struct qr_private qr_private_t;
 
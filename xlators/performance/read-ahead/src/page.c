@@ -29,22 +29,42 @@
 #include "read-ahead.h"
 #include <assert.h>
 
+static int
+ra_page_cmp (const void *a, const void *b, void *param)
+{
+        const ra_page_t *pa = a;
+        const ra_page_t *pb = b;
+
+        if (pa->offset < pb->offset)
+                return -1;
+
+        return (pa->offset > pb->offset);
+}
+
+
+/* Pages are kept in offset order on file->pages for walking ranges, and
+ * indexed by offset in file->page_index for lookups.
+ */
+int
+ra_page_index_init (ra_file_t *file)
+{
+        file->page_index = rb_create (ra_page_cmp, NULL, NULL);
+
+        return (file->page_index == NULL) ? -1 : 0;
+}
+
+
 ra_page_t *
 ra_page_get (ra_file_t *file, off_t offset)
 {
-        ra_page_t *page           = NULL;
-        off_t      rounded_offset = 0;
+        ra_page_t  *page = NULL;
+        ra_page_t   key  = {0, };
 
         GF_VALIDATE_OR_GOTO ("read-ahead", file, out);
 
-        page = file->pages.next;
-        rounded_offset = floor (offset, file->page_size);
+        key.offset = floor (offset, file->page_size);
 
-        while (page != &file->pages && page->offset < rounded_offset)
-                page = page->next;
-
-        if (page == &file->pages || page->offset != rounded_offset)
-                page = NULL;
+        page = rb_find (file->page_index, &key);
 
 out:
         return page;
@@ -54,34 +74,41 @@ out:
 ra_page_t *
 ra_page_create (ra_file_t *file, off_t offset)
 {
-        ra_page_t  *page           = NULL;
-        off_t       rounded_offset = 0;
-        ra_page_t  *newpage        = NULL;
+        ra_page_t            *page    = NULL;
+        ra_page_t            *next    = NULL;
+        ra_page_t            *newpage = NULL;
+        struct rb_traverser   trav;
 
         GF_VALIDATE_OR_GOTO ("read-ahead", file, out);
 
-        page           = file->pages.next;
-        rounded_offset = floor (offset, file->page_size);
-
-        while (page != &file->pages && page->offset < rounded_offset)
-                page = page->next;
+        page = ra_page_get (file, offset);
+        if (page)
+                goto out;
 
-        if (page == &file->pages || page->offset != rounded_offset) {
-                newpage = GF_CALLOC (1, sizeof (*newpage), gf_ra_mt_ra_page_t);
-                if (!newpage) {
-                        goto out;
-                }
+        newpage = GF_CALLOC (1, sizeof (*newpage), gf_ra_mt_ra_page_t);
+        if (!newpage) {
+                goto out;
+        }
 
-                newpage->offset = rounded_offset;
-                newpage->prev = page->prev;
-                newpage->next = page;
-                newpage->file = file;
-                page->prev->next = newpage;
-                page->prev = newpage;
+        newpage->offset = floor (offset, file->page_size);
+        newpage->file = file;
 
-                page = newpage;
+        if (rb_t_insert (&trav, file->page_index, newpage) != newpage) {
+                GF_FREE (newpage);
+                goto out;
         }
 
+        /* link in before the next page in offset order */
+        next = rb_t_next (&trav);
+        if (!next)
+                next = &file->pages;
+
+        newpage->prev = next->prev;
+        newpage->next = next;
+        next->prev->next = newpage;
+        next->prev = newpage;
+
+        page = newpage;
 out:
         return page;
 }
@@ -172,8 +199,10 @@ ra_fault_cbk (call_frame_t *frame, void *cookie, xlator_t *this,
 
         ra_file_lock (file);
         {
-                if (op_ret >= 0)
+                if (op_ret >= 0) {
                         file->stbuf = *stbuf;
+                        file->size = stbuf->ia_size;
+                }
 
                 if (op_ret < 0) {
                         page = ra_page_get (file, pending_offset);
@@ -187,6 +216,8 @@ ra_fault_cbk (call_frame_t *frame, void *cookie, xlator_t *this,
                         gf_log (this->name, GF_LOG_TRACE,
                                 "wasted copy: %"PRId64"[+%"PRId64"] file=%p",
                                 pending_offset, file->page_size, file);
+                        file->stats.prefetched += iov_length (vector, count);
+                        file->stats.wasted += iov_length (vector, count);
                         goto unlock;
                 }
 
@@ -207,6 +238,12 @@ ra_fault_cbk (call_frame_t *frame, void *cookie, xlator_t *this,
 
                 page->size = iov_length (vector, count);
 
+                if (page->dirty) {
+                        file->stats.prefetched += page->size;
+                        if (page->used)
+                                file->stats.used += page->size;
+                }
+
                 waitq = ra_page_wakeup (page);
         }
 unlock:
@@ -505,6 +542,13 @@ ra_page_purge (ra_page_t *page)
 {
         GF_VALIDATE_OR_GOTO ("read-ahead", page, out);
 
+        /* read ahead but never read, pages still in transit are counted
+           when (if) they arrive */
+        if (page->dirty && !page->used && page->ready)
+                page->file->stats.wasted += page->size;
+
+        rb_delete (page->file->page_index, page);
+
         page->prev->next = page->next;
         page->next->prev = page->prev;
 
@@ -583,6 +627,20 @@ ra_file_destroy (ra_file_t *file)
                 trav = file->pages.next;
         }
 
+        if (file->page_index)
+                rb_destroy (file->page_index, NULL);
+
+        ra_conf_lock (conf);
+        {
+                conf->stats.prefetched += file->stats.prefetched;
+                conf->stats.used       += file->stats.used;
+                conf->stats.wasted     += file->stats.wasted;
+                conf->stats.hits       += file->stats.hits;
+                conf->stats.late       += file->stats.late;
+                conf->stats.misses     += file->stats.misses;
+        }
+        ra_conf_unlock (conf);
+
         pthread_mutex_destroy (&file->file_lock);
         GF_FREE (file);
 
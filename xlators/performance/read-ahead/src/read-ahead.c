@@ -39,7 +39,7 @@
 #include <sys/time.h>
 
 static void
-read_ahead (call_frame_t *frame, ra_file_t *file);
+read_ahead (call_frame_t *frame, ra_file_t *file, ra_stream_t *stream);
 
 
 int
@@ -78,7 +78,6 @@ ra_open_cbk (call_frame_t *frame, void *cookie, xlator_t *this,
                 file->disabled = 1;
         }
 
-        file->offset = (unsigned long long) 0;
         file->conf = conf;
         file->pages.next = &file->pages;
         file->pages.prev = &file->pages;
@@ -99,8 +98,12 @@ ra_open_cbk (call_frame_t *frame, void *cookie, xlator_t *this,
         file->page_size = conf->page_size;
         pthread_mutex_init (&file->file_lock, NULL);
 
-        if (!file->disabled) {
-                file->page_count = 1;
+        ret = ra_page_index_init (file);
+        if (ret == -1) {
+                ra_file_destroy (file);
+                op_ret = -1;
+                op_errno = ENOMEM;
+                goto unwind;
         }
 
         ret = fd_ctx_set (fd, this, (uint64_t)(long)file);
@@ -153,8 +156,6 @@ ra_create_cbk (call_frame_t *frame, void *cookie, xlator_t *this,
         if ((fd->flags & O_DIRECT) || ((fd->flags & O_ACCMODE) == O_WRONLY))
                 file->disabled = 1;
 
-        file->offset = (unsigned long long) 0;
-        //file->size = fd->inode->buf.ia_size;
         file->conf = conf;
         file->pages.next = &file->pages;
         file->pages.prev = &file->pages;
@@ -175,6 +176,14 @@ ra_create_cbk (call_frame_t *frame, void *cookie, xlator_t *this,
         file->page_size = conf->page_size;
         pthread_mutex_init (&file->file_lock, NULL);
 
+        ret = ra_page_index_init (file);
+        if (ret == -1) {
+                ra_file_destroy (file);
+                op_ret = -1;
+                op_errno = ENOMEM;
+                goto unwind;
+        }
+
         ret = fd_ctx_set (fd, this, (uint64_t)(long)file);
         if (ret == -1) {
                 gf_log (this->name, GF_LOG_WARNING,
@@ -253,6 +262,160 @@ flush_region (call_frame_t *frame, ra_file_t *file, off_t offset, off_t size)
 }
 
 
+/* purge the pages @stream brought in over [from, to), except those being
+   waited on. returns 1 if any of them was read ahead but never read.
+*/
+static int
+__ra_stream_flush (ra_file_t *file, ra_stream_t *stream, off_t from,
+                   off_t to)
+{
+        ra_page_t *page    = NULL;
+        off_t      trav    = 0;
+        int        skipped = 0;
+
+        for (trav = floor (from, file->page_size); trav < to;
+             trav += file->page_size) {
+                page = ra_page_get (file, trav);
+                if (!page || (page->stream != stream) || page->waitq)
+                        continue;
+
+                if (page->dirty && !page->used)
+                        skipped = 1;
+
+                ra_page_purge (page);
+        }
+
+        return skipped;
+}
+
+
+/* end of the region read ahead for @stream */
+static off_t
+__ra_stream_end (ra_file_t *file, ra_stream_t *stream)
+{
+        if (stream->stride)
+                return stream->last + (stream->page_count * stream->stride)
+                        + stream->size;
+
+        return stream->offset + (stream->page_count * file->page_size);
+}
+
+
+static void
+__ra_streams_reset (ra_file_t *file)
+{
+        int i = 0;
+
+        for (i = 0; i < RA_STREAM_COUNT_MAX; i++) {
+                file->streams[i].expected = 0;
+                file->streams[i].page_count = 0;
+        }
+}
+
+
+/* Find the stream a read at @offset continues: either the next
+   sequential read of a stream, or the next read after a stride seen
+   twice. A read continuing no stream starts a new one in place of the
+   least recently used, unless it comes shortly after a stream of a single
+   read, in which case the gap is remembered as a possible stride.
+*/
+static ra_stream_t *
+__ra_stream_get (ra_file_t *file, off_t offset, size_t size)
+{
+        ra_conf_t   *conf   = NULL;
+        ra_stream_t *stream = NULL;
+        ra_stream_t *victim = NULL;
+        ra_stream_t *near   = NULL;
+        off_t        delta  = 0;
+        int          i      = 0;
+
+        conf = file->conf;
+        file->tick++;
+
+        for (i = 0; i < conf->stream_count; i++) {
+                stream = &file->streams[i];
+
+                if (!stream->in_use) {
+                        if (!victim || victim->in_use)
+                                victim = stream;
+                        continue;
+                }
+
+                if (offset == stream->offset) {
+                        stream->stride = 0;
+                        goto found;
+                }
+
+                if (stream->stride_seen
+                    && (offset == stream->last + stream->stride_seen)) {
+                        stream->stride = stream->stride_seen;
+                        goto found;
+                }
+
+                if (!victim || (victim->in_use
+                                && (stream->tick < victim->tick)))
+                        victim = stream;
+
+                delta = offset - stream->last;
+                if (!stream->expected && !stream->stride && (delta > 0)
+                    && (delta <= RA_STRIDE_MAX)
+                    && (!near || (delta < offset - near->last)))
+                        near = stream;
+        }
+
+        if (near) {
+                gf_log ("read-ahead", GF_LOG_TRACE,
+                        "possible stride of %"PRId64" at offset=%"PRId64,
+                        offset - near->last, offset);
+
+                __ra_stream_flush (file, near, near->last, near->offset);
+
+                near->stride_seen = offset - near->last;
+                stream = near;
+                goto update;
+        }
+
+        gf_log ("read-ahead", GF_LOG_TRACE,
+                "new stream at offset=%"PRId64, offset);
+
+        stream = victim;
+        if (stream->in_use)
+                __ra_stream_flush (file, stream, stream->last,
+                                   __ra_stream_end (file, stream));
+
+        memset (stream, 0, sizeof (*stream));
+        stream->in_use = 1;
+        goto update;
+
+found:
+        /* done with the pages behind the reader, any read ahead page
+           skipped over means the window went past what is being read */
+        if ((offset > stream->last)
+            && __ra_stream_flush (file, stream, stream->last,
+                                  floor (offset, file->page_size))
+            && (stream->page_count > 1))
+                stream->page_count /= 2;
+
+        stream->expected += size;
+        if (!stream->page_count) {
+                if (stream->stride)
+                        stream->page_count = 1;
+                else
+                        stream->page_count = min ((stream->expected
+                                                   / file->page_size),
+                                                  file->page_count);
+        }
+
+update:
+        stream->last   = offset;
+        stream->size   = size;
+        stream->offset = offset + size;
+        stream->tick   = file->tick;
+
+        return stream;
+}
+
+
 int
 ra_release (xlator_t *this, fd_t *fd)
 {
@@ -273,51 +436,19 @@ out:
 }
 
 
-void
-read_ahead (call_frame_t *frame, ra_file_t *file)
+static void
+ra_prefetch (call_frame_t *frame, ra_file_t *file, ra_stream_t *stream,
+             off_t start, off_t end)
 {
-        off_t      ra_offset   = 0;
-        size_t     ra_size     = 0;
         off_t      trav_offset = 0;
         ra_page_t *trav        = NULL;
-        off_t      cap         = 0;
         char       fault       = 0;
 
-        GF_VALIDATE_OR_GOTO ("read-ahead", frame, out);
-        GF_VALIDATE_OR_GOTO (frame->this->name, file, out);
-
-        if (!file->page_count) {
-                goto out;
-        }
-
-        ra_size   = file->page_size * file->page_count;
-        ra_offset = floor (file->offset, file->page_size);
-        cap       = file->size ? file->size : file->offset + ra_size;
+        if (file->size && (end > file->size))
+                end = file->size;
 
-        while (ra_offset < min (file->offset + ra_size, cap)) {
-
-                ra_file_lock (file);
-                {
-                        trav = ra_page_get (file, ra_offset);
-                }
-                ra_file_unlock (file);
-
-                if (!trav)
-                        break;
-
-                ra_offset += file->page_size;
-        }
-
-        if (trav) {
-                /* comfortable enough */
-                goto out;
-        }
-
-        trav_offset = ra_offset;
-
-        cap  = file->size ? file->size : ra_offset + ra_size;
-
-        while (trav_offset < min(ra_offset + ra_size, cap)) {
+        for (trav_offset = floor (start, file->page_size); trav_offset < end;
+             trav_offset += file->page_size) {
                 fault = 0;
                 ra_file_lock (file);
                 {
@@ -325,8 +456,10 @@ read_ahead (call_frame_t *frame, ra_file_t *file)
                         if (!trav) {
                                 fault = 1;
                                 trav = ra_page_create (file, trav_offset);
-                                if (trav)
+                                if (trav) {
                                         trav->dirty = 1;
+                                        trav->stream = stream;
+                                }
                         }
                 }
                 ra_file_unlock (file);
@@ -341,9 +474,48 @@ read_ahead (call_frame_t *frame, ra_file_t *file)
                                 "RA at offset=%"PRId64, trav_offset);
                         ra_page_fault (file, frame, trav_offset);
                 }
-                trav_offset += file->page_size;
+        }
+}
+
+
+void
+read_ahead (call_frame_t *frame, ra_file_t *file, ra_stream_t *stream)
+{
+        uint32_t   page_count = 0;
+        off_t      next       = 0;
+        off_t      last       = 0;
+        off_t      stride     = 0;
+        size_t     size       = 0;
+        uint32_t   i          = 0;
+
+        GF_VALIDATE_OR_GOTO ("read-ahead", frame, out);
+        GF_VALIDATE_OR_GOTO (frame->this->name, file, out);
+
+        ra_file_lock (file);
+        {
+                page_count = stream->page_count;
+                next       = stream->offset;
+                last       = stream->last;
+                stride     = stream->stride;
+                size       = stream->size;
+        }
+        ra_file_unlock (file);
+
+        if (!page_count) {
+                goto out;
         }
 
+        if (!stride) {
+                ra_prefetch (frame, file, stream, next,
+                             next + (page_count * file->page_size));
+                goto out;
+        }
+
+        /* the next @page_count reads of a strided reader */
+        for (i = 1; i <= page_count; i++)
+                ra_prefetch (frame, file, stream, last + (i * stride),
+                             last + (i * stride) + size);
+
 out:
         return;
 }
@@ -361,7 +533,7 @@ ra_need_atime_cbk (call_frame_t *frame, void *cookie, xlator_t *this,
 
 
 static void
-dispatch_requests (call_frame_t *frame, ra_file_t *file)
+dispatch_requests (call_frame_t *frame, ra_file_t *file, ra_stream_t *stream)
 {
         ra_local_t   *local             = NULL;
         ra_conf_t    *conf              = NULL;
@@ -372,6 +544,7 @@ dispatch_requests (call_frame_t *frame, ra_file_t *file)
         call_frame_t *ra_frame          = NULL;
         char          need_atime_update = 1;
         char          fault             = 0;
+        char          late              = 0;
 
         GF_VALIDATE_OR_GOTO ("read-ahead", frame, out);
         GF_VALIDATE_OR_GOTO (frame->this->name, file, out);
@@ -402,6 +575,21 @@ dispatch_requests (call_frame_t *frame, ra_file_t *file)
                                 goto unlock;
                         }
 
+                        if (fault) {
+                                trav->stream = stream;
+                                file->stats.misses++;
+                        } else if (trav->dirty && !trav->used) {
+                                if (trav->ready) {
+                                        file->stats.hits++;
+                                        file->stats.used += trav->size;
+                                } else {
+                                        /* reader caught up with read-ahead */
+                                        file->stats.late++;
+                                        late = 1;
+                                }
+                        }
+                        trav->used = 1;
+
                         if (trav->ready) {
                                 gf_log (frame->this->name, GF_LOG_TRACE,
                                         "HIT at offset=%"PRId64".",
@@ -432,6 +620,15 @@ dispatch_requests (call_frame_t *frame, ra_file_t *file)
                 trav_offset += file->page_size;
         }
 
+        if (late) {
+                ra_file_lock (file);
+                {
+                        stream->page_count = min (stream->page_count * 2,
+                                                  file->page_count);
+                }
+                ra_file_unlock (file);
+        }
+
         if (need_atime_update && conf->force_atime_update) {
                 /* TODO: use untimens() since readv() can confuse underlying
                    io-cache and others */
@@ -471,17 +668,14 @@ ra_readv (call_frame_t *frame, xlator_t *this, fd_t *fd, size_t size,
 {
         ra_file_t   *file            = NULL;
         ra_local_t  *local           = NULL;
-        ra_conf_t   *conf            = NULL;
+        ra_stream_t *stream          = NULL;
         int          op_errno        = EINVAL;
-        char         expected_offset = 1;
         uint64_t     tmp_file        = 0;
 
         GF_ASSERT (frame);
         GF_VALIDATE_OR_GOTO (frame->this->name, this, unwind);
         GF_VALIDATE_OR_GOTO (frame->this->name, fd, unwind);
 
-        conf = this->private;
-
         gf_log (this->name, GF_LOG_TRACE,
                 "NEW REQ at offset=%"PRId64" for size=%"GF_PRI_SIZET"",
                 offset, size);
@@ -497,29 +691,6 @@ ra_readv (call_frame_t *frame, xlator_t *this, fd_t *fd, size_t size,
                 goto unwind;
         }
 
-        if (file->offset != offset) {
-                gf_log (this->name, GF_LOG_TRACE,
-                        "unexpected offset (%"PRId64" != %"PRId64") resetting",
-                        file->offset, offset);
-
-                expected_offset = file->expected = file->page_count = 0;
-        } else {
-                gf_log (this->name, GF_LOG_TRACE,
-                        "expected offset (%"PRId64") when page_count=%d",
-                        offset, file->page_count);
-
-                if (file->expected < (conf->page_size * conf->page_count)) {
-                        file->expected += size;
-                        file->page_count = min ((file->expected
-                                                 / file->page_size),
-                                                conf->page_count);
-                }
-        }
-
-        if (!expected_offset) {
-                flush_region (frame, file, 0, file->pages.prev->offset + 1);
-        }
-
         if (file->disabled) {
                 STACK_WIND (frame, ra_readv_disabled_cbk,
                             FIRST_CHILD (frame->this),
@@ -546,16 +717,18 @@ ra_readv (call_frame_t *frame, xlator_t *this, fd_t *fd, size_t size,
 
         frame->local = local;
 
-        dispatch_requests (frame, file);
+        ra_file_lock (file);
+        {
+                stream = __ra_stream_get (file, offset, size);
+        }
+        ra_file_unlock (file);
 
-        flush_region (frame, file, 0, floor (offset, file->page_size));
+        dispatch_requests (frame, file, stream);
 
-        read_ahead (frame, file);
+        read_ahead (frame, file, stream);
 
         ra_frame_return (frame);
 
-        file->offset = offset + size;
-
         return 0;
 
 unwind:
@@ -711,7 +884,11 @@ ra_writev (call_frame_t *frame, xlator_t *this, fd_t *fd, struct iovec *vector,
         flush_region (frame, file, 0, file->pages.prev->offset+1);
 
         /* reset the read-ahead counters too */
-        file->expected = file->page_count = 0;
+        ra_file_lock (file);
+        {
+                __ra_streams_reset (file);
+        }
+        ra_file_unlock (file);
 
         frame->local = fd;
 
@@ -823,12 +1000,26 @@ out:
         return;
 }
 
+static void
+ra_stats_dump (ra_stats_t *stats)
+{
+        gf_proc_dump_write ("prefetched-bytes", "%"PRIu64, stats->prefetched);
+        gf_proc_dump_write ("prefetched-used-bytes", "%"PRIu64, stats->used);
+        gf_proc_dump_write ("prefetched-unused-bytes", "%"PRIu64,
+                            stats->wasted);
+        gf_proc_dump_write ("hits", "%"PRIu64, stats->hits);
+        gf_proc_dump_write ("late-hits", "%"PRIu64, stats->late);
+        gf_proc_dump_write ("misses", "%"PRIu64, stats->misses);
+}
+
+
 int32_t
 ra_fdctx_dump (xlator_t *this, fd_t *fd)
 {
 	ra_file_t    *file     = NULL;
         ra_page_t    *page     = NULL;
-        int32_t       ret      = 0, i = 0;
+        ra_stream_t  *stream   = NULL;
+        int32_t       ret      = 0, i = 0, j = 0;
         uint64_t      tmp_file = 0;
         char         *path     = NULL;
         char          key[GF_DUMP_MAX_BUF_LEN]        = {0, };
@@ -867,8 +1058,18 @@ ra_fdctx_dump (xlator_t *this, fd_t *fd)
 
         gf_proc_dump_write ("page-count", "%u", file->page_count);
 
-        gf_proc_dump_write ("next-expected-offset-for-sequential-reads",
-                            "%"PRId64, file->offset);
+        for (j = 0; j < RA_STREAM_COUNT_MAX; j++) {
+                stream = &file->streams[j];
+                if (!stream->in_use)
+                        continue;
+
+                sprintf (key, "stream[%d]", j);
+                gf_proc_dump_write (key, "next-offset=%"PRId64", stride="
+                                    "%"PRId64", window=%u", stream->offset,
+                                    stream->stride, stream->page_count);
+        }
+
+        ra_stats_dump (&file->stats);
 
         for (page = file->pages.next; page != &file->pages;
              page = page->next) {
@@ -921,6 +1122,110 @@ unwind:
 }
 
 
+int
+ra_fallocate_cbk (call_frame_t *frame, void *cookie, xlator_t *this,
+                  int32_t op_ret, int32_t op_errno, struct iatt *prebuf,
+                  struct iatt *postbuf)
+{
+        GF_ASSERT (frame);
+
+        /* fallocate, discard and zerofill unwind with the same arguments */
+        STACK_UNWIND_STRICT (fallocate, frame, op_ret, op_errno, prebuf,
+                             postbuf);
+        return 0;
+}
+
+
+static void
+ra_inode_flush (call_frame_t *frame, xlator_t *this, inode_t *inode)
+{
+        ra_file_t *file    = NULL;
+        fd_t      *iter_fd = NULL;
+        uint64_t  tmp_file = 0;
+
+        LOCK (&inode->lock);
+        {
+                list_for_each_entry (iter_fd, &inode->fd_list, inode_list) {
+                        tmp_file = 0;
+                        fd_ctx_get (iter_fd, this, &tmp_file);
+                        file = (ra_file_t *)(long)tmp_file;
+                        if (!file)
+                                continue;
+                        flush_region (frame, file, 0,
+                                      file->pages.prev->offset + 1);
+                }
+        }
+        UNLOCK (&inode->lock);
+}
+
+
+int
+ra_fallocate (call_frame_t *frame, xlator_t *this, fd_t *fd, int32_t mode,
+              off_t offset, size_t len)
+{
+        int32_t op_errno = EINVAL;
+
+        GF_ASSERT (frame);
+        GF_VALIDATE_OR_GOTO (frame->this->name, this, unwind);
+        GF_VALIDATE_OR_GOTO (frame->this->name, fd, unwind);
+
+        ra_inode_flush (frame, this, fd->inode);
+
+        STACK_WIND (frame, ra_fallocate_cbk, FIRST_CHILD (this),
+                    FIRST_CHILD (this)->fops->fallocate, fd, mode, offset,
+                    len);
+        return 0;
+
+unwind:
+        STACK_UNWIND_STRICT (fallocate, frame, -1, op_errno, NULL, NULL);
+        return 0;
+}
+
+
+int
+ra_discard (call_frame_t *frame, xlator_t *this, fd_t *fd, off_t offset,
+            size_t len)
+{
+        int32_t op_errno = EINVAL;
+
+        GF_ASSERT (frame);
+        GF_VALIDATE_OR_GOTO (frame->this->name, this, unwind);
+        GF_VALIDATE_OR_GOTO (frame->this->name, fd, unwind);
+
+        ra_inode_flush (frame, this, fd->inode);
+
+        STACK_WIND (frame, ra_fallocate_cbk, FIRST_CHILD (this),
+                    FIRST_CHILD (this)->fops->discard, fd, offset, len);
+        return 0;
+
+unwind:
+        STACK_UNWIND_STRICT (discard, frame, -1, op_errno, NULL, NULL);
+        return 0;
+}
+
+
+int
+ra_zerofill (call_frame_t *frame, xlator_t *this, fd_t *fd, off_t offset,
+             size_t len)
+{
+        int32_t op_errno = EINVAL;
+
+        GF_ASSERT (frame);
+        GF_VALIDATE_OR_GOTO (frame->this->name, this, unwind);
+        GF_VALIDATE_OR_GOTO (frame->this->name, fd, unwind);
+
+        ra_inode_flush (frame, this, fd->inode);
+
+        STACK_WIND (frame, ra_fallocate_cbk, FIRST_CHILD (this),
+                    FIRST_CHILD (this)->fops->zerofill, fd, offset, len);
+        return 0;
+
+unwind:
+        STACK_UNWIND_STRICT (zerofill, frame, -1, op_errno, NULL, NULL);
+        return 0;
+}
+
+
 int
 ra_ftruncate (call_frame_t *frame, xlator_t *this, fd_t *fd, off_t offset)
 {
@@ -963,6 +1268,8 @@ int
 ra_priv_dump (xlator_t *this)
 {
         ra_conf_t       *conf                           = NULL;
+        ra_file_t       *file                           = NULL;
+        ra_stats_t       total                          = {0, };
         int             ret                             = -1;
         char            key_prefix[GF_DUMP_MAX_BUF_LEN] = {0, };
 
@@ -991,6 +1298,21 @@ ra_priv_dump (xlator_t *this)
         gf_proc_dump_write ("page_size", "%d", conf->page_size);
         gf_proc_dump_write ("page_count", "%d", conf->page_count);
         gf_proc_dump_write ("force_atime_update", "%d", conf->force_atime_update);
+        gf_proc_dump_write ("stream_count", "%u", conf->stream_count);
+
+        /* closed files, and the ones still open */
+        total = conf->stats;
+        for (file = conf->files.next; file != &conf->files;
+             file = file->next) {
+                total.prefetched += file->stats.prefetched;
+                total.used       += file->stats.used;
+                total.wasted     += file->stats.wasted;
+                total.hits       += file->stats.hits;
+                total.late       += file->stats.late;
+                total.misses     += file->stats.misses;
+        }
+
+        ra_stats_dump (&total);
 
         pthread_mutex_unlock (&conf->conf_lock);
 
@@ -1070,6 +1392,20 @@ init (xlator_t *this)
                         "Using conf->page_count = %u", conf->page_count);
         }
 
+        conf->stream_count = 4;
+        if (dict_get (options, "stream-count")) {
+                if (gf_string2uint_base10 (data_to_str (dict_get (options,
+                                                                  "stream-count")),
+                                           &conf->stream_count) != 0
+                    || !conf->stream_count
+                    || conf->stream_count > RA_STREAM_COUNT_MAX) {
+                        gf_log (this->name, GF_LOG_ERROR,
+                                "invalid value of \"option stream-count\", "
+                                "should be 1 to %d", RA_STREAM_COUNT_MAX);
+                        goto out;
+                }
+        }
+
         if (dict_get (options, "force-atime-update")) {
                 char *force_atime_update_str = NULL;
 
@@ -1139,6 +1475,9 @@ struct xlator_fops fops = {
         .fsync       = ra_fsync,
         .truncate    = ra_truncate,
         .ftruncate   = ra_ftruncate,
+        .fallocate   = ra_fallocate,
+        .discard     = ra_discard,
+        .zerofill    = ra_zerofill,
         .fstat       = ra_fstat,
 };
 
@@ -1160,5 +1499,12 @@ struct volume_options options[] = {
           .min  = 1,
           .max  = 16
         },
+        { .key  = {"stream-count"},
+          .type = GF_OPTION_TYPE_INT,
+          .min  = 1,
+          .max  = RA_STREAM_COUNT_MAX,
+          .description = "Number of readers (sequential or strided) tracked "
+                         "per open file, each with its own read-ahead window."
+        },
         { .key = {NULL} },
 };
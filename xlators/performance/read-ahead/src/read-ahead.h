@@ -32,12 +32,19 @@
 #include "xlator.h"
 #include "common-utils.h"
 #include "read-ahead-mem-types.h"
+#include "rb.h"
 
 struct ra_conf;
 struct ra_local;
 struct ra_page;
 struct ra_file;
 struct ra_waitq;
+struct ra_stream;
+
+#define RA_STREAM_COUNT_MAX     16
+
+/* largest gap between two reads taken for a stride */
+#define RA_STRIDE_MAX           (16 * GF_UNIT_MB)
 
 
 struct ra_waitq {
@@ -76,7 +83,9 @@ struct ra_page {
         struct ra_page   *next;
         struct ra_page   *prev;
         struct ra_file   *file;
-        char              dirty;
+        struct ra_stream *stream;       /* stream which brought it in */
+        char              dirty;        /* brought in by read-ahead */
+        char              used;         /* read from at least once */
         char              ready;
         struct iovec     *vector;
         int32_t           count;
@@ -87,30 +96,60 @@ struct ra_page {
 };
 
 
+/* A reader of the file, either sequential or with a constant stride
+ * between the start of consecutive reads.
+ */
+struct ra_stream {
+        char               in_use;
+        off_t              offset;      /* next sequential read */
+        off_t              last;        /* offset of the last read */
+        size_t             size;        /* size of the last read */
+        off_t              stride;      /* confirmed stride, 0 if sequential */
+        off_t              stride_seen; /* candidate stride */
+        size_t             expected;    /* bytes read in order so far */
+        uint32_t           page_count;  /* current window */
+        uint64_t           tick;        /* for replacing the least recent */
+};
+
+
+struct ra_stats {
+        uint64_t           prefetched;  /* bytes read ahead */
+        uint64_t           used;        /* of those, bytes read by the app */
+        uint64_t           wasted;      /* of those, bytes thrown away */
+        uint64_t           hits;
+        uint64_t           late;        /* waited for a read-ahead page */
+        uint64_t           misses;
+};
+
+
 struct ra_file {
         struct ra_file    *next;
         struct ra_file    *prev;
         struct ra_conf    *conf;
         fd_t              *fd;
         int                disabled;
-        size_t             expected;
         struct ra_page     pages;
-        off_t              offset;
+        struct rb_table   *page_index;
+        struct ra_stream   streams[RA_STREAM_COUNT_MAX];
+        uint64_t           tick;
         size_t             size;
         int32_t            refcount;
         pthread_mutex_t    file_lock;
         struct iatt        stbuf;
         uint64_t           page_size;
         uint32_t           page_count;
+        struct ra_stats    stats;
 };
 
 
 struct ra_conf {
         uint64_t          page_size;
         uint32_t          page_count;
+        uint32_t          stream_count;
         void             *cache_block;
         struct ra_file    files;
         gf_boolean_t      force_atime_update;
+        struct ra_stats   stats;        /* of the files already closed */
         pthread_mutex_t   conf_lock;
 };
 
@@ -121,6 +160,11 @@ typedef struct ra_page ra_page_t;
 typedef struct ra_file ra_file_t;
 typedef struct ra_waitq ra_waitq_t;
 typedef struct ra_fill ra_fill_t;
+typedef struct ra_stream ra_stream_t;
+typedef struct ra_stats ra_stats_t;
+
+int
+ra_page_index_init (ra_file_t *file);
 
 ra_page_t *
 ra_page_get (ra_file_t *file,
@@ -33,7 +33,8 @@ typedef enum {
 void
 sp_inode_ctx_free (xlator_t *this, sp_inode_ctx_t *ctx)
 {
-        call_stub_t *stub = NULL, *tmp = NULL;
+        call_stub_t    *stub = NULL, *tmp = NULL;
+        sp_neg_entry_t *neg  = NULL, *neg_tmp = NULL;
 
         GF_VALIDATE_OR_GOTO ("stat-prefetch", this, out);
         GF_VALIDATE_OR_GOTO (this->name, ctx, out);
@@ -55,6 +56,13 @@ sp_inode_ctx_free (xlator_t *this, sp_inode_ctx_t *ctx)
                                 call_stub_destroy (stub);
                         }
                 }
+
+                list_for_each_entry_safe (neg, neg_tmp, &ctx->neg_entries,
+                                          list) {
+                        list_del_init (&neg->list);
+                        GF_FREE (neg);
+                }
+                ctx->neg_count = 0;
         }
         UNLOCK (&ctx->lock);
 
@@ -78,6 +86,7 @@ sp_inode_ctx_init ()
 
         LOCK_INIT (&inode_ctx->lock);
         INIT_LIST_HEAD (&inode_ctx->waiting_ops);
+        INIT_LIST_HEAD (&inode_ctx->neg_entries);
 
 out:
         return inode_ctx;
@@ -205,6 +214,220 @@ out:
 }
 
 
+static sp_neg_entry_t *
+__sp_neg_entry_find (sp_inode_ctx_t *ctx, const char *name, time_t now)
+{
+        sp_neg_entry_t *neg = NULL, *tmp = NULL, *found = NULL;
+
+        list_for_each_entry_safe (neg, tmp, &ctx->neg_entries, list) {
+                if (neg->expires <= now) {
+                        list_del_init (&neg->list);
+                        GF_FREE (neg);
+                        ctx->neg_count--;
+                        continue;
+                }
+
+                if ((found == NULL) && (strcmp (neg->name, name) == 0)) {
+                        found = neg;
+                }
+        }
+
+        return found;
+}
+
+
+/*
+ * returns 1 if @name is known not to exist in @parent, 0 otherwise. Expired
+ * entries met on the way are dropped.
+ */
+int32_t
+sp_neg_entry_check (xlator_t *this, inode_t *parent, const char *name)
+{
+        sp_private_t   *priv      = NULL;
+        sp_inode_ctx_t *inode_ctx = NULL;
+        uint64_t        value     = 0;
+        int32_t         ret       = 0, found = 0;
+
+        priv = this->private;
+        if ((priv == NULL) || (priv->negative_timeout <= 0)) {
+                goto out;
+        }
+
+        ret = inode_ctx_get (parent, this, &value);
+        if (ret == 0) {
+                inode_ctx = (sp_inode_ctx_t *)(long)value;
+        }
+
+        if (inode_ctx != NULL) {
+                LOCK (&inode_ctx->lock);
+                {
+                        if (__sp_neg_entry_find (inode_ctx, name,
+                                                 time (NULL)) != NULL) {
+                                found = 1;
+                        }
+                }
+                UNLOCK (&inode_ctx->lock);
+        }
+
+        LOCK (&priv->lock);
+        {
+                if (found) {
+                        priv->negative_hits++;
+                } else {
+                        priv->negative_miss++;
+                }
+        }
+        UNLOCK (&priv->lock);
+
+out:
+        return found;
+}
+
+
+uint64_t
+sp_neg_entry_gen (xlator_t *this, inode_t *parent)
+{
+        sp_inode_ctx_t *inode_ctx = NULL;
+        uint64_t        value     = 0, gen = 0;
+        int32_t         ret       = 0;
+
+        ret = inode_ctx_get (parent, this, &value);
+        if (ret == 0) {
+                inode_ctx = (sp_inode_ctx_t *)(long)value;
+        }
+
+        if (inode_ctx != NULL) {
+                LOCK (&inode_ctx->lock);
+                {
+                        gen = inode_ctx->neg_gen;
+                }
+                UNLOCK (&inode_ctx->lock);
+        }
+
+        return gen;
+}
+
+
+/*
+ * remembers that lookup of @name in @parent failed with ENOENT. @gen is the
+ * generation sampled when the lookup was wound; if an entry got created in
+ * @parent since then, the reply may be stale and is not cached.
+ */
+void
+sp_neg_entry_add (xlator_t *this, inode_t *parent, const char *name,
+                  uint64_t gen)
+{
+        sp_private_t   *priv      = NULL;
+        sp_inode_ctx_t *inode_ctx = NULL;
+        sp_neg_entry_t *neg       = NULL, *new = NULL;
+        time_t          now       = 0;
+
+        priv = this->private;
+        if ((priv == NULL) || (priv->negative_timeout <= 0)) {
+                goto out;
+        }
+
+        inode_ctx = sp_check_and_create_inode_ctx (this, parent,
+                                                   SP_DONT_CARE);
+        if (inode_ctx == NULL) {
+                goto out;
+        }
+
+        new = GF_CALLOC (1, sizeof (*new) + strlen (name) + 1,
+                         gf_sp_mt_sp_neg_entry_t);
+        if (new == NULL) {
+                goto out;
+        }
+
+        strcpy (new->name, name);
+        INIT_LIST_HEAD (&new->list);
+
+        now = time (NULL);
+
+        LOCK (&inode_ctx->lock);
+        {
+                if (inode_ctx->neg_gen != gen) {
+                        goto unlock;
+                }
+
+                neg = __sp_neg_entry_find (inode_ctx, name, now);
+                if (neg != NULL) {
+                        neg->expires = now + priv->negative_timeout;
+                        list_move (&neg->list, &inode_ctx->neg_entries);
+                        goto unlock;
+                }
+
+                if (inode_ctx->neg_count >= priv->negative_max) {
+                        neg = list_entry (inode_ctx->neg_entries.prev,
+                                          sp_neg_entry_t, list);
+                        list_del_init (&neg->list);
+                        GF_FREE (neg);
+                        inode_ctx->neg_count--;
+                }
+
+                new->expires = now + priv->negative_timeout;
+                list_add (&new->list, &inode_ctx->neg_entries);
+                inode_ctx->neg_count++;
+                new = NULL;
+        }
+unlock:
+        UNLOCK (&inode_ctx->lock);
+
+        if (new != NULL) {
+                GF_FREE (new);
+        }
+
+out:
+        return;
+}
+
+
+/*
+ * called whenever an entry @name is about to appear in @parent. With @name
+ * being NULL, all the negative entries of @parent are dropped.
+ */
+void
+sp_neg_entry_remove (xlator_t *this, inode_t *parent, const char *name)
+{
+        sp_private_t   *priv      = NULL;
+        sp_inode_ctx_t *inode_ctx = NULL;
+        sp_neg_entry_t *neg       = NULL, *tmp = NULL;
+
+        priv = this->private;
+        if ((priv == NULL) || (priv->negative_timeout <= 0)
+            || (parent == NULL)) {
+                goto out;
+        }
+
+        /* the context has to exist for the generation bump to be seen by
+         * lookups already in flight
+         */
+        inode_ctx = sp_check_and_create_inode_ctx (this, parent,
+                                                   SP_DONT_CARE);
+        if (inode_ctx == NULL) {
+                goto out;
+        }
+
+        LOCK (&inode_ctx->lock);
+        {
+                inode_ctx->neg_gen++;
+
+                list_for_each_entry_safe (neg, tmp, &inode_ctx->neg_entries,
+                                          list) {
+                        if ((name == NULL) || (strcmp (neg->name, name) == 0)) {
+                                list_del_init (&neg->list);
+                                GF_FREE (neg);
+                                inode_ctx->neg_count--;
+                        }
+                }
+        }
+        UNLOCK (&inode_ctx->lock);
+
+out:
+        return;
+}
+
+
 sp_cache_t *
 sp_cache_ref (sp_cache_t *cache)
 {
@@ -385,6 +608,7 @@ sp_local_free (sp_local_t *local)
 {
         if (local) {
                 loc_wipe (&local->loc);
+                loc_wipe (&local->loc2);
                 GF_FREE (local);
         }
 }
@@ -897,6 +1121,12 @@ sp_lookup_cbk (call_frame_t *frame, void *cookie, xlator_t *this,
                                                       (char *)local->loc.name);
         }
 
+        if ((op_ret == -1) && (op_errno == ENOENT) && local->is_lookup
+            && local->loc.parent && local->loc.name) {
+                sp_neg_entry_add (this, local->loc.parent, local->loc.name,
+                                  local->neg_gen);
+        }
+
         if (local->is_lookup)
                 need_unwind = 1;
 
@@ -1139,6 +1369,17 @@ sp_lookup (call_frame_t *frame, xlator_t *this, loc_t *loc, dict_t *xattr_req)
                 goto wind;
         }
 
+        /* non-existence of an entry does not depend on what is asked for in
+         * xattr_req, hence negative entries are looked up before that check.
+         * Revalidates of inodes we already know about are always wound.
+         */
+        if (uuid_is_null (loc->inode->gfid)
+            && sp_neg_entry_check (this, loc->parent, loc->name)) {
+                op_ret = -1;
+                op_errno = ENOENT;
+                goto unwind;
+        }
+
         if (xattr_req != NULL) {
                 dict_foreach (xattr_req, sp_is_empty, &xattr_req_empty);
         }
@@ -1224,6 +1465,9 @@ wind:
                 }
 
                 local->is_lookup = 1;
+                if (loc->parent != NULL) {
+                        local->neg_gen = sp_neg_entry_gen (this, loc->parent);
+                }
 
                 LOCK (&inode_ctx->lock);
                 {
@@ -1436,7 +1680,16 @@ sp_rename_cbk (call_frame_t *frame, void *cookie, xlator_t *this,
                struct iatt *preoldparent, struct iatt *postoldparent,
                struct iatt *prenewparent, struct iatt *postnewparent)
 {
+        sp_local_t *local = NULL;
+
         GF_ASSERT (frame);
+
+        local = frame->local;
+        if (local != NULL) {
+                sp_neg_entry_remove (this, local->loc2.parent,
+                                     local->loc2.name);
+        }
+
         SP_STACK_UNWIND (rename, frame, op_ret, op_errno, buf, preoldparent,
                          postoldparent, prenewparent, postnewparent);
         return 0;
@@ -1618,6 +1871,15 @@ sp_create_cbk (call_frame_t *frame, void *cookie, xlator_t *this,
 
         GF_ASSERT (frame);
 
+        local = frame->local;
+
+        /* a negative lookup which raced this call is not to be cached,
+         * whether the entry got created by it or was already there
+         */
+        if (local != NULL) {
+                sp_neg_entry_remove (this, local->loc.parent, local->loc.name);
+        }
+
         if (op_ret == -1) {
                 goto out;
         }
@@ -1630,7 +1892,6 @@ sp_create_cbk (call_frame_t *frame, void *cookie, xlator_t *this,
                 goto out;
         }
 
-        local = frame->local;
         if (local == NULL) {
                 gf_log (this->name, GF_LOG_WARNING, "local is NULL");
                 op_ret = -1;
@@ -1710,6 +1971,8 @@ sp_create (call_frame_t *frame, xlator_t *this, loc_t *loc, int32_t flags,
                 goto out;
         }
 
+        sp_neg_entry_remove (this, loc->parent, loc->name);
+
         local = GF_CALLOC (1, sizeof (*local), gf_sp_mt_sp_local_t);
         GF_VALIDATE_OR_GOTO_WITH_ERROR (this->name, local, out, op_errno,
                                         ENOMEM);
@@ -1860,11 +2123,17 @@ sp_new_entry_cbk (call_frame_t *frame, void *cookie, xlator_t *this,
 
         GF_ASSERT (frame);
 
+        local = frame->local;
+
+        /* see sp_create_cbk */
+        if (local != NULL) {
+                sp_neg_entry_remove (this, local->loc.parent, local->loc.name);
+        }
+
         if (op_ret == -1) {
                 goto out;
         }
 
-        local = frame->local;
         if (local == NULL) {
                 gf_log (frame->this->name, GF_LOG_WARNING, "local is NULL");
                 op_ret = -1;
@@ -1935,6 +2204,8 @@ sp_mkdir (call_frame_t *frame, xlator_t *this, loc_t *loc, mode_t mode,
                 goto out;
         }
 
+        sp_neg_entry_remove (this, loc->parent, loc->name);
+
         local = GF_CALLOC (1, sizeof (*local), gf_sp_mt_sp_local_t);
         GF_VALIDATE_OR_GOTO_WITH_ERROR (this->name, local, out, op_errno,
                                         ENOMEM);
@@ -2001,6 +2272,8 @@ sp_mknod (call_frame_t *frame, xlator_t *this, loc_t *loc, mode_t mode,
                 goto out;
         }
 
+        sp_neg_entry_remove (this, loc->parent, loc->name);
+
         local = GF_CALLOC (1, sizeof (*local), gf_sp_mt_sp_local_t);
         GF_VALIDATE_OR_GOTO_WITH_ERROR (this->name, local, out, op_errno,
                                         ENOMEM);
@@ -2070,6 +2343,8 @@ sp_symlink (call_frame_t *frame, xlator_t *this, const char *linkpath,
                 goto out;
         }
 
+        sp_neg_entry_remove (this, loc->parent, loc->name);
+
         local = GF_CALLOC (1, sizeof (*local), gf_sp_mt_sp_local_t);
         GF_VALIDATE_OR_GOTO_WITH_ERROR (this->name, local, out, op_errno,
                                         ENOMEM);
@@ -2109,13 +2384,59 @@ out:
 }
 
 
+/*
+ * the local of a link or rename is set up before the call is queued or wound,
+ * so that its callback knows which entry appeared (@newloc). A lookup-behind
+ * of @oldloc finds it in place and uses its loc.
+ */
+int32_t
+sp_local_new_entry (call_frame_t *frame, xlator_t *this, loc_t *oldloc,
+                    loc_t *newloc)
+{
+        sp_local_t *local = NULL;
+        int32_t     ret   = -1;
+
+        local = GF_CALLOC (1, sizeof (*local), gf_sp_mt_sp_local_t);
+        if (local == NULL) {
+                goto out;
+        }
+
+        frame->local = local;
+
+        ret = loc_copy (&local->loc, oldloc);
+        if (ret == -1) {
+                gf_log (this->name, GF_LOG_WARNING, "loc_copy failed (%s)",
+                        strerror (errno));
+                goto out;
+        }
+
+        ret = loc_copy (&local->loc2, newloc);
+        if (ret == -1) {
+                gf_log (this->name, GF_LOG_WARNING, "loc_copy failed (%s)",
+                        strerror (errno));
+        }
+
+out:
+        return ret;
+}
+
+
 int32_t
 sp_link_cbk (call_frame_t *frame, void *cookie, xlator_t *this,
              int32_t op_ret, int32_t op_errno, inode_t *inode,
              struct iatt *buf, struct iatt *preparent,
              struct iatt *postparent)
 {
+        sp_local_t *local = NULL;
+
         GF_ASSERT (frame);
+
+        local = frame->local;
+        if (local != NULL) {
+                sp_neg_entry_remove (this, local->loc2.parent,
+                                     local->loc2.name);
+        }
+
         SP_STACK_UNWIND (link, frame, op_ret, op_errno, inode, buf, preparent,
                          postparent);
         return 0;
@@ -2202,6 +2523,14 @@ sp_link (call_frame_t *frame, xlator_t *this, loc_t *oldloc, loc_t *newloc)
         sp_remove_caches_from_all_fds_opened (this, oldloc->parent,
                                               (char *)oldloc->name);
 
+        sp_neg_entry_remove (this, newloc->parent, newloc->name);
+
+        ret = sp_local_new_entry (frame, this, oldloc, newloc);
+        if (ret == -1) {
+                op_errno = ENOMEM;
+                goto out;
+        }
+
         stub = fop_link_stub (frame, sp_link_helper, oldloc, newloc);
         if (stub == NULL) {
                 op_errno = ENOMEM;
@@ -2317,6 +2646,119 @@ out:
 }
 
 
+int32_t
+sp_fallocate_cbk (call_frame_t *frame, void *cookie, xlator_t *this,
+                  int32_t op_ret, int32_t op_errno, struct iatt *prebuf,
+                  struct iatt *postbuf)
+{
+        GF_ASSERT (frame);
+
+        /* discard and zerofill unwind with the same arguments */
+        SP_STACK_UNWIND (fallocate, frame, op_ret, op_errno, prebuf, postbuf);
+        return 0;
+}
+
+
+/* fallocate, discard and zerofill may change the size and the blocks of the
+   file, so its cached stat goes from the directories it was looked up in */
+static int32_t
+sp_fd_remove_caches (xlator_t *this, fd_t *fd)
+{
+        sp_fd_ctx_t *fd_ctx = NULL;
+        uint64_t     value  = 0;
+        int32_t      ret    = 0;
+
+        ret = fd_ctx_get (fd, this, &value);
+        if (ret == -1) {
+                gf_log (this->name, GF_LOG_WARNING, "stat-prefetch context not "
+                        "set in fd (%p) opened on inode (gfid:%s)", fd,
+                        uuid_utoa (fd->inode->gfid));
+                return -1;
+        }
+
+        fd_ctx = (void *)(long)value;
+
+        sp_remove_caches_from_all_fds_opened (this, fd_ctx->parent_inode,
+                                              fd_ctx->name);
+        return 0;
+}
+
+
+int32_t
+sp_fallocate (call_frame_t *frame, xlator_t *this, fd_t *fd, int32_t mode,
+              off_t offset, size_t len)
+{
+        int32_t ret = 0, op_errno = EINVAL;
+
+        GF_ASSERT (frame);
+        GF_VALIDATE_OR_GOTO (frame->this ? frame->this->name : "stat-prefetch",
+                             this, unwind);
+        GF_VALIDATE_OR_GOTO (this->name, fd, unwind);
+
+        ret = sp_fd_remove_caches (this, fd);
+        if (ret == -1)
+                goto unwind;
+
+        STACK_WIND (frame, sp_fallocate_cbk, FIRST_CHILD(this),
+                    FIRST_CHILD(this)->fops->fallocate, fd, mode, offset, len);
+        return 0;
+
+unwind:
+        SP_STACK_UNWIND (fallocate, frame, -1, op_errno, NULL, NULL);
+        return 0;
+}
+
+
+int32_t
+sp_discard (call_frame_t *frame, xlator_t *this, fd_t *fd, off_t offset,
+            size_t len)
+{
+        int32_t ret = 0, op_errno = EINVAL;
+
+        GF_ASSERT (frame);
+        GF_VALIDATE_OR_GOTO (frame->this ? frame->this->name : "stat-prefetch",
+                             this, unwind);
+        GF_VALIDATE_OR_GOTO (this->name, fd, unwind);
+
+        ret = sp_fd_remove_caches (this, fd);
+        if (ret == -1)
+                goto unwind;
+
+        STACK_WIND (frame, sp_fallocate_cbk, FIRST_CHILD(this),
+                    FIRST_CHILD(this)->fops->discard, fd, offset, len);
+        return 0;
+
+unwind:
+        SP_STACK_UNWIND (discard, frame, -1, op_errno, NULL, NULL);
+        return 0;
+}
+
+
+int32_t
+sp_zerofill (call_frame_t *frame, xlator_t *this, fd_t *fd, off_t offset,
+             size_t len)
+{
+        int32_t ret = 0, op_errno = EINVAL;
+
+        GF_ASSERT (frame);
+        GF_VALIDATE_OR_GOTO (frame->this ? frame->this->name : "stat-prefetch",
+                             this, unwind);
+        GF_VALIDATE_OR_GOTO (this->name, fd, unwind);
+
+        ret = sp_fd_remove_caches (this, fd);
+        if (ret == -1)
+                goto unwind;
+
+        STACK_WIND (frame, sp_fallocate_cbk, FIRST_CHILD(this),
+                    FIRST_CHILD(this)->fops->zerofill, fd, offset, len);
+        return 0;
+
+unwind:
+        SP_STACK_UNWIND (zerofill, frame, -1, op_errno, NULL, NULL);
+        return 0;
+}
+
+
 int32_t
 sp_ftruncate (call_frame_t *frame, xlator_t *this, fd_t *fd, off_t offset)
 {
@@ -3045,6 +3487,8 @@ sp_rename (call_frame_t *frame, xlator_t *this, loc_t *oldloc,loc_t *newloc)
         sp_remove_caches_from_all_fds_opened (this, newloc->parent,
                                               (char *)newloc->name);
 
+        sp_neg_entry_remove (this, newloc->parent, newloc->name);
+
         ret = sp_cache_remove_parent_entry (frame, this, oldloc->parent->table,
                                             (char *)oldloc->path);
         if (ret == -1) {
@@ -3068,6 +3512,12 @@ sp_rename (call_frame_t *frame, xlator_t *this, loc_t *oldloc,loc_t *newloc)
                                                       NULL);
         }
 
+        ret = sp_local_new_entry (frame, this, oldloc, newloc);
+        if (ret == -1) {
+                op_errno = ENOMEM;
+                goto out;
+        }
+
         stub = fop_rename_stub (frame, sp_rename_helper, oldloc, newloc);
         if (stub == NULL) {
                 op_errno = ENOMEM;
@@ -3914,8 +4364,8 @@ out:
 int32_t
 sp_forget (xlator_t *this, inode_t *inode)
 {
-        struct iatt *buf   = NULL;
-        uint64_t     value = 0;
+        sp_inode_ctx_t *inode_ctx = NULL;
+        uint64_t        value     = 0;
 
         GF_VALIDATE_OR_GOTO ("stat-prefetch", this, out);
         GF_VALIDATE_OR_GOTO (this->name, inode, out);
@@ -3923,8 +4373,8 @@ sp_forget (xlator_t *this, inode_t *inode)
         inode_ctx_del (inode, this, &value);
 
         if (value) {
-                buf = (void *)(long)value;
-                GF_FREE (buf);
+                inode_ctx = (void *)(long)value;
+                sp_inode_ctx_free (this, inode_ctx);
         }
 
 out:
@@ -4097,6 +4547,9 @@ sp_inodectx_dump (xlator_t *this, inode_t *inode)
 
                 gf_proc_dump_write ("op_errno", "%d", inode_ctx->op_errno);
 
+                gf_proc_dump_write ("negative_entries", "%u",
+                                    inode_ctx->neg_count);
+
                 list_for_each_entry (stub, &inode_ctx->waiting_ops, list) {
                         gf_proc_dump_build_key (key, "",
                                                 "waiting-ops[%d].frame", i);
@@ -4139,6 +4592,20 @@ sp_priv_dump (xlator_t *this)
         gf_proc_dump_write (key, "%lu", GF_SP_CACHE_ENTRIES_EXPECTED);
         gf_proc_dump_build_key (key, key_prefix, "num_entries_cached");
         gf_proc_dump_write (key, "%lu",(unsigned long)total_entries);
+
+        LOCK (&priv->lock);
+        {
+                gf_proc_dump_build_key (key, key_prefix, "negative_timeout");
+                gf_proc_dump_write (key, "%d", priv->negative_timeout);
+                gf_proc_dump_build_key (key, key_prefix,
+                                        "negative_entries_per_dir");
+                gf_proc_dump_write (key, "%u", priv->negative_max);
+                gf_proc_dump_build_key (key, key_prefix, "negative_hits");
+                gf_proc_dump_write (key, "%"PRIu64, priv->negative_hits);
+                gf_proc_dump_build_key (key, key_prefix, "negative_miss");
+                gf_proc_dump_write (key, "%"PRIu64, priv->negative_miss);
+        }
+        UNLOCK (&priv->lock);
         ret = 0;
 
 out:
@@ -4183,10 +4650,55 @@ init (xlator_t *this)
         }
 
         priv = GF_CALLOC (1, sizeof(sp_private_t), gf_sp_mt_sp_private_t);
+        if (priv == NULL) {
+                goto out;
+        }
+
         LOCK_INIT (&priv->lock);
 
+        GF_OPTION_INIT ("negative-timeout", priv->negative_timeout, int32,
+                        out);
+        GF_OPTION_INIT ("negative-entries-per-dir", priv->negative_max,
+                        uint32, out);
+
         this->private = priv;
 
+        ret = 0;
+out:
+        if ((ret == -1) && (priv != NULL)) {
+                LOCK_DESTROY (&priv->lock);
+                GF_FREE (priv);
+        }
+
+        return ret;
+}
+
+
+int
+reconfigure (xlator_t *this, dict_t *options)
+{
+        sp_private_t *priv             = NULL;
+        int32_t       negative_timeout = 0;
+        uint32_t      negative_max     = 0;
+        int           ret              = -1;
+
+        GF_VALIDATE_OR_GOTO ("stat-prefetch", this, out);
+        GF_VALIDATE_OR_GOTO (this->name, this->private, out);
+
+        priv = this->private;
+
+        GF_OPTION_RECONF ("negative-timeout", negative_timeout, options, int32,
+                          out);
+        GF_OPTION_RECONF ("negative-entries-per-dir", negative_max, options,
+                          uint32, out);
+
+        LOCK (&priv->lock);
+        {
+                priv->negative_timeout = negative_timeout;
+                priv->negative_max = negative_max;
+        }
+        UNLOCK (&priv->lock);
+
         ret = 0;
 out:
         return ret;
@@ -4227,6 +4739,9 @@ struct xlator_fops fops = {
         .link        = sp_link,
         .truncate    = sp_truncate,
         .ftruncate   = sp_ftruncate,
+        .fallocate   = sp_fallocate,
+        .discard     = sp_discard,
+        .zerofill    = sp_zerofill,
         .readlink    = sp_readlink,
         .unlink      = sp_unlink,
         .rmdir       = sp_rmdir,
@@ -4257,3 +4772,26 @@ struct xlator_dumpops dumpops = {
         .inodectx = sp_inodectx_dump,
         .fdctx = sp_fdctx_dump
 };
+
+struct volume_options options[] = {
+        { .key  = {"negative-timeout"},
+          .type = GF_OPTION_TYPE_INT,
+          .min  = 0,
+          .max  = 3600,
+          .default_value = "0",
+          .description = "Time in seconds for which a failed (ENOENT) lookup "
+          "is remembered in the parent directory and answered without "
+          "going to the server. Entries created through this client "
+          "invalidate it immediately; those created by other clients only "
+          "show up after the timeout. 0 disables negative caching."
+        },
+        { .key  = {"negative-entries-per-dir"},
+          .type = GF_OPTION_TYPE_INT,
+          .min  = 1,
+          .max  = 65536,
+          .default_value = "128",
+          .description = "Maximum number of negative entries remembered per "
+          "directory. The oldest one is dropped to make room."
+        },
+        { .key  = {NULL} },
+};
@@ -62,12 +62,29 @@ struct sp_fd_ctx {
 typedef struct sp_fd_ctx sp_fd_ctx_t;
 
 struct sp_local {
-        loc_t  loc;
-        fd_t  *fd;
-        char   is_lookup;
+        loc_t    loc;
+        loc_t    loc2;                  /* new entry of a link or rename */
+        fd_t    *fd;
+        char     is_lookup;
+        uint64_t neg_gen;               /*
+                                         * generation of the parent's negative
+                                         * entries when the lookup was wound
+                                         */
 };
 typedef struct sp_local sp_local_t;
 
+/*
+ * name in a directory which the lower layers reported as non-existent. Kept in
+ * the inode context of the parent directory till it expires or till an entry
+ * with that name is created through this client.
+ */
+struct sp_neg_entry {
+        struct list_head list;
+        time_t           expires;
+        char             name[0];
+};
+typedef struct sp_neg_entry sp_neg_entry_t;
+
 struct sp_inode_ctx {
         char             looked_up;
         char             lookup_in_progress;
@@ -77,6 +94,9 @@ struct sp_inode_ctx {
         struct iatt      stbuf;
         gf_lock_t        lock;
         struct list_head waiting_ops;
+        struct list_head neg_entries;   /* most recently added first */
+        uint32_t         neg_count;
+        uint64_t         neg_gen;       /* bumped on every invalidation */
 };
 typedef struct sp_inode_ctx sp_inode_ctx_t;
 
@@ -84,6 +104,10 @@ struct sp_private {
         struct mem_pool  *mem_pool;
         uint32_t         entries;
         gf_lock_t        lock;
+        int32_t          negative_timeout;
+        uint32_t         negative_max;  /* per directory */
+        uint64_t         negative_hits;
+        uint64_t         negative_miss;
 };
 typedef struct sp_private sp_private_t;
 
@@ -35,6 +35,7 @@
 #include "common-utils.h"
 #include "call-stub.h"
 #include "statedump.h"
+#include "timer.h"
 #include "write-behind-mem-types.h"
 
 #define MAX_VECTOR_COUNT  8
@@ -58,6 +59,15 @@ typedef struct wb_file {
         int32_t      op_errno;
         list_head_t  request;
         list_head_t  passive_requests;
+        list_head_t  all;          /* conf->files */
+        list_head_t  waiting;      /* conf->waiters, while writes of this
+                                    * file are blocked on the translator
+                                    * wide window */
+        list_head_t  aged;         /* while wb_flush_dirty winds the
+                                    * writes of this file, under
+                                    * conf->lock */
+        struct timeval dirty_since; /* arrival of the oldest write not yet
+                                     * wound, protected by conf->lock */
         fd_t        *fd;
         gf_lock_t    lock;
         xlator_t    *this;
@@ -102,6 +112,19 @@ struct wb_conf {
         gf_boolean_t enable_O_SYNC;
         gf_boolean_t flush_behind;
         gf_boolean_t enable_trickling_writes;
+
+        /* the members below are protected by lock. lock nests inside
+         * file->lock, never the other way round. */
+        gf_lock_t    lock;
+        uint64_t     total_window_size;
+        uint64_t     total_window_current;
+        int32_t      flush_age;
+        gf_timer_t  *flush_timer;
+        list_head_t  files;
+        list_head_t  waiters;
+        uint64_t     blocked_writes;
+        uint64_t     aged_flushes;
+        uint64_t     collapsed_writes;
 };
 
 typedef struct wb_local {
@@ -225,10 +248,13 @@ wb_enqueue (wb_file_t *file, call_stub_t *stub)
         wb_local_t   *local   = NULL;
         struct iovec *vector  = NULL;
         int32_t       count   = 0;
+        wb_conf_t    *conf    = NULL;
 
         GF_VALIDATE_OR_GOTO ("write-behind", file, out);
         GF_VALIDATE_OR_GOTO (file->this->name, stub, out);
 
+        conf = file->this->private;
+
         request = GF_CALLOC (1, sizeof (*request), gf_wb_mt_wb_request_t);
         if (request == NULL) {
                 goto out;
@@ -273,6 +299,15 @@ wb_enqueue (wb_file_t *file, call_stub_t *stub)
                         __wb_request_ref (request);
 
                         file->aggregate_current += request->write_size;
+
+                        LOCK (&conf->lock);
+                        {
+                                if (!timerisset (&file->dirty_since)) {
+                                        gettimeofday (&file->dirty_since,
+                                                      NULL);
+                                }
+                        }
+                        UNLOCK (&conf->lock);
                 } else {
                         list_for_each_entry (tmp, &file->request, list) {
                                 if (tmp->stub && tmp->stub->fop
@@ -310,6 +345,9 @@ wb_file_create (xlator_t *this, fd_t *fd, int32_t flags)
 
         INIT_LIST_HEAD (&file->request);
         INIT_LIST_HEAD (&file->passive_requests);
+        INIT_LIST_HEAD (&file->all);
+        INIT_LIST_HEAD (&file->waiting);
+        INIT_LIST_HEAD (&file->aged);
 
         /*
           fd_ref() not required, file should never decide the existence of
@@ -324,6 +362,12 @@ wb_file_create (xlator_t *this, fd_t *fd, int32_t flags)
 
         LOCK_INIT (&file->lock);
 
+        LOCK (&conf->lock);
+        {
+                list_add_tail (&file->all, &conf->files);
+        }
+        UNLOCK (&conf->lock);
+
         fd_ctx_set (fd, this, (uint64_t)(long)file);
 
 out:
@@ -331,18 +375,35 @@ out:
 }
 
 
+/* the refcount of a file is protected by conf->lock, so that files can be
+ * picked from conf->files and conf->waiters */
+static wb_file_t *
+__wb_file_ref (wb_file_t *file)
+{
+        file->refcount++;
+        return file;
+}
+
+
 void
 wb_file_destroy (wb_file_t *file)
 {
-        int32_t refcount = 0;
+        int32_t    refcount = 0;
+        wb_conf_t *conf     = NULL;
 
         GF_VALIDATE_OR_GOTO ("write-behind", file, out);
 
-        LOCK (&file->lock);
+        conf = file->this->private;
+
+        LOCK (&conf->lock);
         {
                 refcount = --file->refcount;
+                if (!refcount) {
+                        list_del_init (&file->all);
+                        list_del_init (&file->waiting);
+                }
         }
-        UNLOCK (&file->lock);
+        UNLOCK (&conf->lock);
 
         if (!refcount){
                 LOCK_DESTROY (&file->lock);
@@ -354,6 +415,57 @@ out:
 }
 
 
+/*
+ * wb_wake_waiters - let the files blocked on the translator wide window
+ * retry, in the order they started waiting. A file stays at the head of
+ * conf->waiters as long as it cannot get window, which keeps the files
+ * behind it waiting too.
+ */
+static void
+wb_wake_waiters (call_frame_t *frame, xlator_t *this)
+{
+        wb_conf_t *conf = NULL;
+        wb_file_t *file = NULL;
+        wb_file_t *last = NULL;
+        int32_t    ret  = 0;
+
+        conf = this->private;
+
+        while (1) {
+                file = NULL;
+
+                LOCK (&conf->lock);
+                {
+                        if (!list_empty (&conf->waiters)
+                            && (conf->total_window_current
+                                < conf->total_window_size)) {
+                                file = list_entry (conf->waiters.next,
+                                                   wb_file_t, waiting);
+                                if (file == last) {
+                                        file = NULL;
+                                } else {
+                                        __wb_file_ref (file);
+                                }
+                        }
+                }
+                UNLOCK (&conf->lock);
+
+                if (file == NULL) {
+                        break;
+                }
+
+                ret = wb_process_queue (frame, file);
+                if (ret == -1) {
+                        gf_log (this->name, GF_LOG_WARNING,
+                                "request queue processing failed");
+                }
+
+                wb_file_destroy (file);
+                last = file;
+        }
+}
+
+
 int32_t
 wb_sync_cbk (call_frame_t *frame, void *cookie, xlator_t *this, int32_t op_ret,
              int32_t op_errno, struct iatt *prebuf, struct iatt *postbuf)
@@ -365,10 +477,13 @@ wb_sync_cbk (call_frame_t *frame, void *cookie, xlator_t *this, int32_t op_ret,
         wb_local_t   *per_request_local = NULL;
         int32_t       ret               = -1;
         fd_t         *fd                = NULL;
+        wb_conf_t    *conf              = NULL;
+        size_t        released          = 0;
 
         GF_ASSERT (frame);
         GF_ASSERT (this);
 
+        conf = this->private;
         local = frame->local;
         winds = &local->winds;
 
@@ -389,11 +504,20 @@ wb_sync_cbk (call_frame_t *frame, void *cookie, xlator_t *this, int32_t op_ret,
 
                         if (request->flags.write_request.write_behind) {
                                 file->window_current -= request->write_size;
+                                released += request->write_size;
                         }
 
                         __wb_request_unref (request);
                 }
 
+                if (released) {
+                        LOCK (&conf->lock);
+                        {
+                                conf->total_window_current -= released;
+                        }
+                        UNLOCK (&conf->lock);
+                }
+
                 if (op_ret == -1) {
                         file->op_ret = op_ret;
                         file->op_errno = op_errno;
@@ -417,6 +541,10 @@ wb_sync_cbk (call_frame_t *frame, void *cookie, xlator_t *this, int32_t op_ret,
                         "request queue processing failed");
         }
 
+        if (released) {
+                wb_wake_waiters (frame, this);
+        }
+
         /* safe place to do fd_unref */
         fd_unref (fd);
 
@@ -443,6 +571,7 @@ wb_sync (call_frame_t *frame, wb_file_t *file, list_head_t *winds)
         wb_conf_t      *conf          = NULL;
         fd_t           *fd            = NULL;
         int32_t         op_errno      = -1;
+        size_t          released      = 0;
 
         GF_VALIDATE_OR_GOTO_WITH_ERROR ((file ? file->this->name
                                          : "write-behind"), frame,
@@ -575,11 +704,28 @@ out:
                  */
                 list_for_each_entry_safe (request, dummy, &local->winds,
                                           winds) {
+                        if (request->flags.write_request.write_behind) {
+                                released += request->write_size;
+                        }
+
                         wb_request_unref (request);
                 }
 
                 GF_FREE (local);
                 local = NULL;
+
+                /* nor would the window they hold be leaked */
+                LOCK (&file->lock);
+                {
+                        file->window_current -= released;
+                }
+                UNLOCK (&file->lock);
+
+                LOCK (&conf->lock);
+                {
+                        conf->total_window_current -= released;
+                }
+                UNLOCK (&conf->lock);
         }
 
         if (iobref != NULL) {
@@ -893,6 +1039,129 @@ unwind:
 }
 
 
+int32_t
+wb_seek_cbk (call_frame_t *frame, void *cookie, xlator_t *this, int32_t op_ret,
+             int32_t op_errno, off_t offset)
+{
+        wb_local_t   *local   = NULL;
+        wb_request_t *request = NULL;
+        wb_file_t    *file    = NULL;
+        int32_t       ret     = -1;
+
+        GF_ASSERT (frame);
+
+        local = frame->local;
+        file = local->file;
+
+        request = local->request;
+        if ((file != NULL) && (request != NULL)) {
+                wb_request_unref (request);
+                ret = wb_process_queue (frame, file);
+                if (ret == -1) {
+                        if (errno == ENOMEM) {
+                                op_ret = -1;
+                                op_errno = ENOMEM;
+                        }
+
+                        gf_log (this->name, GF_LOG_WARNING,
+                                "request queue processing failed");
+                }
+        }
+
+        STACK_UNWIND_STRICT (seek, frame, op_ret, op_errno, offset);
+
+        return 0;
+}
+
+
+int32_t
+wb_seek_helper (call_frame_t *frame, xlator_t *this, fd_t *fd, off_t offset,
+                gf_seek_what_t what)
+{
+        GF_ASSERT (frame);
+        GF_ASSERT (this);
+
+        STACK_WIND (frame, wb_seek_cbk, FIRST_CHILD(this),
+                    FIRST_CHILD(this)->fops->seek, fd, offset, what);
+        return 0;
+}
+
+
+/* the extents seek reports must include the writes still held here, so it
+   waits behind them like fstat */
+int32_t
+wb_seek (call_frame_t *frame, xlator_t *this, fd_t *fd, off_t offset,
+         gf_seek_what_t what)
+{
+        wb_file_t    *file     = NULL;
+        wb_local_t   *local    = NULL;
+        uint64_t      tmp_file = 0;
+        call_stub_t  *stub     = NULL;
+        wb_request_t *request  = NULL;
+        int32_t       ret      = -1;
+        int           op_errno = EINVAL;
+
+        GF_ASSERT (frame);
+        GF_VALIDATE_OR_GOTO (frame->this->name, this, unwind);
+        GF_VALIDATE_OR_GOTO (frame->this->name, fd, unwind);
+
+        if (fd_ctx_get (fd, this, &tmp_file)) {
+                gf_log (this->name, GF_LOG_WARNING,
+                        "write behind file pointer is"
+                        " not stored in context of fd(%p), returning EBADFD",
+                        fd);
+                op_errno = EBADFD;
+                goto unwind;
+        }
+
+        file = (wb_file_t *)(long)tmp_file;
+        local = GF_CALLOC (1, sizeof (*local),
+                           gf_wb_mt_wb_local_t);
+        if (local == NULL) {
+                op_errno = ENOMEM;
+                goto unwind;
+        }
+
+        local->file = file;
+
+        frame->local = local;
+
+        if (file) {
+                stub = fop_seek_stub (frame, wb_seek_helper, fd, offset, what);
+                if (stub == NULL) {
+                        op_errno = ENOMEM;
+                        goto unwind;
+                }
+
+                request = wb_enqueue (file, stub);
+                if (request == NULL) {
+                        op_errno = ENOMEM;
+                        goto unwind;
+                }
+
+                ret = wb_process_queue (frame, file);
+                if (ret == -1) {
+                        gf_log (this->name, GF_LOG_WARNING,
+                                "request queue processing failed");
+                }
+        } else {
+                STACK_WIND (frame, wb_seek_cbk, FIRST_CHILD(this),
+                            FIRST_CHILD(this)->fops->seek, fd, offset, what);
+        }
+
+        return 0;
+
+unwind:
+        STACK_UNWIND_STRICT (seek, frame, -1, op_errno, 0);
+
+        if (stub) {
+                call_stub_destroy (stub);
+        }
+
+        return 0;
+}
+
+
 int32_t
 wb_truncate_cbk (call_frame_t *frame, void *cookie, xlator_t *this,
                  int32_t op_ret, int32_t op_errno, struct iatt *prebuf,
@@ -960,51 +1229,425 @@ wb_truncate_cbk (call_frame_t *frame, void *cookie, xlator_t *this,
 
 
 static int32_t
-wb_truncate_helper (call_frame_t *frame, xlator_t *this, loc_t *loc,
-                    off_t offset)
+wb_truncate_helper (call_frame_t *frame, xlator_t *this, loc_t *loc,
+                    off_t offset)
+{
+        GF_ASSERT (frame);
+        GF_ASSERT (this);
+
+        STACK_WIND (frame, wb_truncate_cbk, FIRST_CHILD(this),
+                    FIRST_CHILD(this)->fops->truncate, loc, offset);
+
+        return 0;
+}
+
+
+int32_t
+wb_truncate (call_frame_t *frame, xlator_t *this, loc_t *loc, off_t offset)
+{
+        wb_file_t    *file     = NULL;
+        fd_t         *iter_fd  = NULL;
+        wb_local_t   *local    = NULL;
+        uint64_t      tmp_file = 0;
+        call_stub_t  *stub     = NULL;
+        wb_request_t *request  = NULL;
+        int32_t       ret      = -1, op_errno = EINVAL;
+
+        GF_ASSERT (frame);
+        GF_VALIDATE_OR_GOTO (frame->this->name, this, unwind);
+        GF_VALIDATE_OR_GOTO (frame->this->name, loc, unwind);
+
+        if (loc->inode) {
+                /*
+                  FIXME: fd_lookup extends life of fd till the execution of
+                  truncate_cbk
+                */
+                iter_fd = fd_lookup (loc->inode, frame->root->pid);
+                if (iter_fd) {
+                        if (!fd_ctx_get (iter_fd, this, &tmp_file)){
+                                file = (wb_file_t *)(long)tmp_file;
+                        } else {
+                                fd_unref (iter_fd);
+                        }
+                }
+        }
+
+        local = GF_CALLOC (1, sizeof (*local),
+                           gf_wb_mt_wb_local_t);
+        if (local == NULL) {
+                op_errno = ENOMEM;
+                goto unwind;
+        }
+
+        local->file = file;
+
+        frame->local = local;
+        if (file) {
+                stub = fop_truncate_stub (frame, wb_truncate_helper, loc,
+                                          offset);
+                if (stub == NULL) {
+                        op_errno = ENOMEM;
+                        goto unwind;
+                }
+
+                request = wb_enqueue (file, stub);
+                if (request == NULL) {
+                        op_errno = ENOMEM;
+                        goto unwind;
+                }
+
+                ret = wb_process_queue (frame, file);
+                if (ret == -1) {
+                        gf_log (this->name, GF_LOG_WARNING,
+                                "request queue processing failed");
+                }
+        } else {
+                STACK_WIND (frame, wb_truncate_cbk, FIRST_CHILD(this),
+                            FIRST_CHILD(this)->fops->truncate, loc, offset);
+        }
+
+        return 0;
+
+unwind:
+        STACK_UNWIND_STRICT (truncate, frame, -1, op_errno, NULL, NULL);
+
+        if (stub) {
+                call_stub_destroy (stub);
+        }
+
+        return 0;
+}
+
+
+int32_t
+wb_ftruncate_cbk (call_frame_t *frame, void *cookie, xlator_t *this,
+                  int32_t op_ret, int32_t op_errno, struct iatt *prebuf,
+                  struct iatt *postbuf)
+{
+        wb_local_t   *local   = NULL;
+        wb_request_t *request = NULL;
+        wb_file_t    *file    = NULL;
+        int32_t       ret     = -1;
+
+        GF_ASSERT (frame);
+
+        local = frame->local;
+        file = local->file;
+        request = local->request;
+
+        if ((request != NULL) && (file != NULL)) {
+                wb_request_unref (request);
+                ret = wb_process_queue (frame, file);
+                if (ret == -1) {
+                        if (errno == ENOMEM) {
+                                op_ret = -1;
+                                op_errno = ENOMEM;
+                        }
+
+                        gf_log (this->name, GF_LOG_WARNING,
+                                "request queue processing failed");
+                }
+        }
+
+        STACK_UNWIND_STRICT (ftruncate, frame, op_ret, op_errno, prebuf,
+                             postbuf);
+
+        return 0;
+}
+
+
+static int32_t
+wb_ftruncate_helper (call_frame_t *frame, xlator_t *this, fd_t *fd,
+                     off_t offset)
+{
+        GF_ASSERT (frame);
+        GF_ASSERT (this);
+
+        STACK_WIND (frame, wb_ftruncate_cbk, FIRST_CHILD(this),
+                    FIRST_CHILD(this)->fops->ftruncate, fd, offset);
+        return 0;
+}
+
+
+int32_t
+wb_ftruncate (call_frame_t *frame, xlator_t *this, fd_t *fd, off_t offset)
+{
+        wb_file_t    *file     = NULL;
+        wb_local_t   *local    = NULL;
+        uint64_t      tmp_file = 0;
+        call_stub_t  *stub     = NULL;
+        wb_request_t *request  = NULL;
+        int32_t       ret      = -1;
+        int           op_errno = EINVAL;
+
+        GF_ASSERT (frame);
+        GF_VALIDATE_OR_GOTO (frame->this->name, this, unwind);
+        GF_VALIDATE_OR_GOTO (frame->this->name, fd, unwind);
+
+        if ((!IA_ISDIR (fd->inode->ia_type))
+            && fd_ctx_get (fd, this, &tmp_file)) {
+                gf_log (this->name, GF_LOG_WARNING,
+                        "write behind file pointer is"
+                        " not stored in context of fd(%p), returning EBADFD",
+                        fd);
+                op_errno = EBADFD;
+                goto unwind;
+        }
+
+        file = (wb_file_t *)(long)tmp_file;
+
+        local = GF_CALLOC (1, sizeof (*local), gf_wb_mt_wb_local_t);
+        if (local == NULL) {
+                op_errno = ENOMEM;
+                goto unwind;
+        }
+
+        local->file = file;
+
+        frame->local = local;
+
+        if (file) {
+                stub = fop_ftruncate_stub (frame, wb_ftruncate_helper, fd,
+                                           offset);
+                if (stub == NULL) {
+                        op_errno = ENOMEM;
+                        goto unwind;
+                }
+
+                request = wb_enqueue (file, stub);
+                if (request == NULL) {
+                        op_errno = ENOMEM;
+                        goto unwind;
+                }
+
+                ret = wb_process_queue (frame, file);
+                if (ret == -1) {
+                        gf_log (this->name, GF_LOG_WARNING,
+                                "request queue processing failed");
+                }
+        } else {
+                STACK_WIND (frame, wb_ftruncate_cbk, FIRST_CHILD(this),
+                            FIRST_CHILD(this)->fops->ftruncate, fd, offset);
+        }
+
+        return 0;
+
+unwind:
+        STACK_UNWIND_STRICT (ftruncate, frame, -1, op_errno, NULL, NULL);
+
+        if (stub) {
+                call_stub_destroy (stub);
+        }
+
+        return 0;
+}
+
+
+int32_t
+wb_fallocate_cbk (call_frame_t *frame, void *cookie, xlator_t *this,
+                  int32_t op_ret, int32_t op_errno, struct iatt *prebuf,
+                  struct iatt *postbuf)
+{
+        wb_local_t   *local   = NULL;
+        wb_request_t *request = NULL;
+        wb_file_t    *file    = NULL;
+        int32_t       ret     = -1;
+
+        GF_ASSERT (frame);
+
+        local = frame->local;
+        file = local->file;
+        request = local->request;
+
+        if ((request != NULL) && (file != NULL)) {
+                wb_request_unref (request);
+                ret = wb_process_queue (frame, file);
+                if (ret == -1) {
+                        if (errno == ENOMEM) {
+                                op_ret = -1;
+                                op_errno = ENOMEM;
+                        }
+
+                        gf_log (this->name, GF_LOG_WARNING,
+                                "request queue processing failed");
+                }
+        }
+
+        STACK_UNWIND_STRICT (fallocate, frame, op_ret, op_errno, prebuf,
+                             postbuf);
+
+        return 0;
+}
+
+
+static int32_t
+wb_fallocate_helper (call_frame_t *frame, xlator_t *this, fd_t *fd,
+                     int32_t mode, off_t offset, size_t len)
+{
+        GF_ASSERT (frame);
+        GF_ASSERT (this);
+
+        STACK_WIND (frame, wb_fallocate_cbk, FIRST_CHILD(this),
+                    FIRST_CHILD(this)->fops->fallocate, fd, mode, offset, len);
+        return 0;
+}
+
+
+int32_t
+wb_fallocate (call_frame_t *frame, xlator_t *this, fd_t *fd,
+              int32_t mode, off_t offset, size_t len)
+{
+        wb_file_t    *file     = NULL;
+        wb_local_t   *local    = NULL;
+        uint64_t      tmp_file = 0;
+        call_stub_t  *stub     = NULL;
+        wb_request_t *request  = NULL;
+        int32_t       ret      = -1;
+        int           op_errno = EINVAL;
+
+        GF_ASSERT (frame);
+        GF_VALIDATE_OR_GOTO (frame->this->name, this, unwind);
+        GF_VALIDATE_OR_GOTO (frame->this->name, fd, unwind);
+
+        if ((!IA_ISDIR (fd->inode->ia_type))
+            && fd_ctx_get (fd, this, &tmp_file)) {
+                gf_log (this->name, GF_LOG_WARNING,
+                        "write behind file pointer is"
+                        " not stored in context of fd(%p), returning EBADFD",
+                        fd);
+                op_errno = EBADFD;
+                goto unwind;
+        }
+
+        file = (wb_file_t *)(long)tmp_file;
+
+        local = GF_CALLOC (1, sizeof (*local), gf_wb_mt_wb_local_t);
+        if (local == NULL) {
+                op_errno = ENOMEM;
+                goto unwind;
+        }
+
+        local->file = file;
+
+        frame->local = local;
+
+        if (file) {
+                stub = fop_fallocate_stub (frame, wb_fallocate_helper, fd,
+                                           mode, offset, len);
+                if (stub == NULL) {
+                        op_errno = ENOMEM;
+                        goto unwind;
+                }
+
+                request = wb_enqueue (file, stub);
+                if (request == NULL) {
+                        op_errno = ENOMEM;
+                        goto unwind;
+                }
+
+                ret = wb_process_queue (frame, file);
+                if (ret == -1) {
+                        gf_log (this->name, GF_LOG_WARNING,
+                                "request queue processing failed");
+                }
+        } else {
+                STACK_WIND (frame, wb_fallocate_cbk, FIRST_CHILD(this),
+                            FIRST_CHILD(this)->fops->fallocate, fd, mode,
+                            offset, len);
+        }
+
+        return 0;
+
+unwind:
+        STACK_UNWIND_STRICT (fallocate, frame, -1, op_errno, NULL, NULL);
+
+        if (stub) {
+                call_stub_destroy (stub);
+        }
+
+        return 0;
+}
+
+
+int32_t
+wb_discard_cbk (call_frame_t *frame, void *cookie, xlator_t *this,
+                int32_t op_ret, int32_t op_errno, struct iatt *prebuf,
+                struct iatt *postbuf)
+{
+        wb_local_t   *local   = NULL;
+        wb_request_t *request = NULL;
+        wb_file_t    *file    = NULL;
+        int32_t       ret     = -1;
+
+        GF_ASSERT (frame);
+
+        local = frame->local;
+        file = local->file;
+        request = local->request;
+
+        if ((request != NULL) && (file != NULL)) {
+                wb_request_unref (request);
+                ret = wb_process_queue (frame, file);
+                if (ret == -1) {
+                        if (errno == ENOMEM) {
+                                op_ret = -1;
+                                op_errno = ENOMEM;
+                        }
+
+                        gf_log (this->name, GF_LOG_WARNING,
+                                "request queue processing failed");
+                }
+        }
+
+        STACK_UNWIND_STRICT (discard, frame, op_ret, op_errno, prebuf,
+                             postbuf);
+
+        return 0;
+}
+
+
+static int32_t
+wb_discard_helper (call_frame_t *frame, xlator_t *this, fd_t *fd,
+                   off_t offset, size_t len)
 {
         GF_ASSERT (frame);
         GF_ASSERT (this);
 
-        STACK_WIND (frame, wb_truncate_cbk, FIRST_CHILD(this),
-                    FIRST_CHILD(this)->fops->truncate, loc, offset);
-
+        STACK_WIND (frame, wb_discard_cbk, FIRST_CHILD(this),
+                    FIRST_CHILD(this)->fops->discard, fd, offset, len);
         return 0;
 }
 
 
 int32_t
-wb_truncate (call_frame_t *frame, xlator_t *this, loc_t *loc, off_t offset)
+wb_discard (call_frame_t *frame, xlator_t *this, fd_t *fd,
+            off_t offset, size_t len)
 {
         wb_file_t    *file     = NULL;
-        fd_t         *iter_fd  = NULL;
         wb_local_t   *local    = NULL;
         uint64_t      tmp_file = 0;
         call_stub_t  *stub     = NULL;
         wb_request_t *request  = NULL;
-        int32_t       ret      = -1, op_errno = EINVAL;
+        int32_t       ret      = -1;
+        int           op_errno = EINVAL;
 
         GF_ASSERT (frame);
         GF_VALIDATE_OR_GOTO (frame->this->name, this, unwind);
-        GF_VALIDATE_OR_GOTO (frame->this->name, loc, unwind);
+        GF_VALIDATE_OR_GOTO (frame->this->name, fd, unwind);
 
-        if (loc->inode) {
-                /*
-                  FIXME: fd_lookup extends life of fd till the execution of
-                  truncate_cbk
-                */
-                iter_fd = fd_lookup (loc->inode, frame->root->pid);
-                if (iter_fd) {
-                        if (!fd_ctx_get (iter_fd, this, &tmp_file)){
-                                file = (wb_file_t *)(long)tmp_file;
-                        } else {
-                                fd_unref (iter_fd);
-                        }
-                }
+        if ((!IA_ISDIR (fd->inode->ia_type))
+            && fd_ctx_get (fd, this, &tmp_file)) {
+                gf_log (this->name, GF_LOG_WARNING,
+                        "write behind file pointer is"
+                        " not stored in context of fd(%p), returning EBADFD",
+                        fd);
+                op_errno = EBADFD;
+                goto unwind;
         }
 
-        local = GF_CALLOC (1, sizeof (*local),
-                           gf_wb_mt_wb_local_t);
+        file = (wb_file_t *)(long)tmp_file;
+
+        local = GF_CALLOC (1, sizeof (*local), gf_wb_mt_wb_local_t);
         if (local == NULL) {
                 op_errno = ENOMEM;
                 goto unwind;
@@ -1013,9 +1656,10 @@ wb_truncate (call_frame_t *frame, xlator_t *this, loc_t *loc, off_t offset)
         local->file = file;
 
         frame->local = local;
+
         if (file) {
-                stub = fop_truncate_stub (frame, wb_truncate_helper, loc,
-                                          offset);
+                stub = fop_discard_stub (frame, wb_discard_helper, fd,
+                                         offset, len);
                 if (stub == NULL) {
                         op_errno = ENOMEM;
                         goto unwind;
@@ -1033,14 +1677,14 @@ wb_truncate (call_frame_t *frame, xlator_t *this, loc_t *loc, off_t offset)
                                 "request queue processing failed");
                 }
         } else {
-                STACK_WIND (frame, wb_truncate_cbk, FIRST_CHILD(this),
-                            FIRST_CHILD(this)->fops->truncate, loc, offset);
+                STACK_WIND (frame, wb_discard_cbk, FIRST_CHILD(this),
+                            FIRST_CHILD(this)->fops->discard, fd, offset, len);
         }
 
         return 0;
 
 unwind:
-        STACK_UNWIND_STRICT (truncate, frame, -1, op_errno, NULL, NULL);
+        STACK_UNWIND_STRICT (discard, frame, -1, op_errno, NULL, NULL);
 
         if (stub) {
                 call_stub_destroy (stub);
@@ -1051,9 +1695,9 @@ unwind:
 
 
 int32_t
-wb_ftruncate_cbk (call_frame_t *frame, void *cookie, xlator_t *this,
-                  int32_t op_ret, int32_t op_errno, struct iatt *prebuf,
-                  struct iatt *postbuf)
+wb_zerofill_cbk (call_frame_t *frame, void *cookie, xlator_t *this,
+                 int32_t op_ret, int32_t op_errno, struct iatt *prebuf,
+                 struct iatt *postbuf)
 {
         wb_local_t   *local   = NULL;
         wb_request_t *request = NULL;
@@ -1080,7 +1724,7 @@ wb_ftruncate_cbk (call_frame_t *frame, void *cookie, xlator_t *this,
                 }
         }
 
-        STACK_UNWIND_STRICT (ftruncate, frame, op_ret, op_errno, prebuf,
+        STACK_UNWIND_STRICT (zerofill, frame, op_ret, op_errno, prebuf,
                              postbuf);
 
         return 0;
@@ -1088,20 +1732,21 @@ wb_ftruncate_cbk (call_frame_t *frame, void *cookie, xlator_t *this,
 
 
 static int32_t
-wb_ftruncate_helper (call_frame_t *frame, xlator_t *this, fd_t *fd,
-                     off_t offset)
+wb_zerofill_helper (call_frame_t *frame, xlator_t *this, fd_t *fd,
+                    off_t offset, size_t len)
 {
         GF_ASSERT (frame);
         GF_ASSERT (this);
 
-        STACK_WIND (frame, wb_ftruncate_cbk, FIRST_CHILD(this),
-                    FIRST_CHILD(this)->fops->ftruncate, fd, offset);
+        STACK_WIND (frame, wb_zerofill_cbk, FIRST_CHILD(this),
+                    FIRST_CHILD(this)->fops->zerofill, fd, offset, len);
         return 0;
 }
 
 
 int32_t
-wb_ftruncate (call_frame_t *frame, xlator_t *this, fd_t *fd, off_t offset)
+wb_zerofill (call_frame_t *frame, xlator_t *this, fd_t *fd,
+             off_t offset, size_t len)
 {
         wb_file_t    *file     = NULL;
         wb_local_t   *local    = NULL;
@@ -1138,8 +1783,8 @@ wb_ftruncate (call_frame_t *frame, xlator_t *this, fd_t *fd, off_t offset)
         frame->local = local;
 
         if (file) {
-                stub = fop_ftruncate_stub (frame, wb_ftruncate_helper, fd,
-                                           offset);
+                stub = fop_zerofill_stub (frame, wb_zerofill_helper, fd,
+                                          offset, len);
                 if (stub == NULL) {
                         op_errno = ENOMEM;
                         goto unwind;
@@ -1157,14 +1802,14 @@ wb_ftruncate (call_frame_t *frame, xlator_t *this, fd_t *fd, off_t offset)
                                 "request queue processing failed");
                 }
         } else {
-                STACK_WIND (frame, wb_ftruncate_cbk, FIRST_CHILD(this),
-                            FIRST_CHILD(this)->fops->ftruncate, fd, offset);
+                STACK_WIND (frame, wb_zerofill_cbk, FIRST_CHILD(this),
+                            FIRST_CHILD(this)->fops->zerofill, fd, offset, len);
         }
 
         return 0;
 
 unwind:
-        STACK_UNWIND_STRICT (ftruncate, frame, -1, op_errno, NULL, NULL);
+        STACK_UNWIND_STRICT (zerofill, frame, -1, op_errno, NULL, NULL);
 
         if (stub) {
                 call_stub_destroy (stub);
@@ -1497,12 +2142,14 @@ unwind:
 
 
 /* Mark all the contiguous write requests for winding starting from head of
- * request list. Stops marking at the first non-write request found. If
- * file is opened with O_APPEND, make sure all the writes marked for winding
- * will fit into a single write call to server.
+ * request list. Stops marking at the first non-write request found, and
+ * with behind_only at the first write not acknowledged yet. If file is
+ * opened with O_APPEND, make sure all the writes marked for winding will fit
+ * into a single write call to server.
  */
 size_t
-__wb_mark_wind_all (wb_file_t *file, list_head_t *list, list_head_t *winds)
+__wb_mark_wind_all (wb_file_t *file, list_head_t *list, list_head_t *winds,
+                    char behind_only)
 {
         wb_request_t *request         = NULL;
         size_t        size            = 0;
@@ -1524,6 +2171,11 @@ __wb_mark_wind_all (wb_file_t *file, list_head_t *list, list_head_t *winds)
                         break;
                 }
 
+                if (behind_only
+                    && !request->flags.write_request.write_behind) {
+                        break;
+                }
+
                 if (!request->flags.write_request.stack_wound) {
                         if (first_request) {
                                 first_request = 0;
@@ -1553,6 +2205,14 @@ __wb_mark_wind_all (wb_file_t *file, list_head_t *list, list_head_t *winds)
                 }
         }
 
+        if (file->aggregate_current == 0) {
+                LOCK (&conf->lock);
+                {
+                        timerclear (&file->dirty_since);
+                }
+                UNLOCK (&conf->lock);
+        }
+
 out:
         return size;
 }
@@ -1627,7 +2287,10 @@ __wb_mark_winds (list_head_t *list, list_head_t *winds, size_t aggregate_conf,
         char          non_contiguous_writes  = 0;
         wb_request_t *request                = NULL;
         wb_file_t    *file                   = NULL;
+        wb_conf_t    *conf                   = NULL;
         char          wind_all               = 0;
+        char          window_exhausted       = 0;
+        char          blocked                = 0;
         int32_t       ret                    = 0;
 
         GF_VALIDATE_OR_GOTO ("write-behind", list, out);
@@ -1639,6 +2302,18 @@ __wb_mark_winds (list_head_t *list, list_head_t *winds, size_t aggregate_conf,
 
         request = list_entry (list->next, typeof (*request), list);
         file = request->file;
+        conf = file->this->private;
+
+        /* do not sit on window other writers are waiting for. Writes
+         * which are waiting themselves are neither acknowledged nor wound
+         * till wb_wake_waiters finds them window.
+         */
+        LOCK (&conf->lock);
+        {
+                window_exhausted = !list_empty (&conf->waiters);
+                blocked = !list_empty (&file->waiting);
+        }
+        UNLOCK (&conf->lock);
 
         ret = __wb_can_wind (list, &other_fop_in_queue,
                              &non_contiguous_writes, &incomplete_writes,
@@ -1652,9 +2327,10 @@ __wb_mark_winds (list_head_t *list, list_head_t *winds, size_t aggregate_conf,
         if (!incomplete_writes && ((enable_trickling_writes)
                                    || (wind_all) || (non_contiguous_writes)
                                    || (other_fop_in_queue)
+                                   || (window_exhausted)
                                    || (file->aggregate_current
                                        >= aggregate_conf))) {
-                size = __wb_mark_wind_all (file, list, winds);
+                size = __wb_mark_wind_all (file, list, winds, blocked);
         }
 
 out:
@@ -1662,12 +2338,35 @@ out:
 }
 
 
+/*
+ * __wb_window_available - whether a write of file may be acknowledged
+ * against the translator wide window. Files blocked earlier are served
+ * first. Called with conf->lock held.
+ */
+static int
+__wb_window_available (wb_conf_t *conf, wb_file_t *file)
+{
+        if (conf->total_window_current >= conf->total_window_size) {
+                return 0;
+        }
+
+        if (!list_empty (&conf->waiters)
+            && (conf->waiters.next != &file->waiting)) {
+                return 0;
+        }
+
+        return 1;
+}
+
+
 size_t
-__wb_mark_unwind_till (list_head_t *list, list_head_t *unwinds, size_t size)
+__wb_mark_unwind_till (list_head_t *list, list_head_t *unwinds, size_t size,
+                       char *blocked)
 {
         size_t        written_behind = 0;
         wb_request_t *request        = NULL;
         wb_file_t    *file           = NULL;
+        wb_conf_t    *conf           = NULL;
 
         if (list_empty (list)) {
                 goto out;
@@ -1675,6 +2374,7 @@ __wb_mark_unwind_till (list_head_t *list, list_head_t *unwinds, size_t size)
 
         request = list_entry (list->next, typeof (*request), list);
         file = request->file;
+        conf = file->this->private;
 
         list_for_each_entry (request, list, list)
         {
@@ -1685,14 +2385,22 @@ __wb_mark_unwind_till (list_head_t *list, list_head_t *unwinds, size_t size)
 
                 if (written_behind <= size) {
                         if (!request->flags.write_request.write_behind) {
-                                written_behind += request->write_size;
-                                request->flags.write_request.write_behind = 1;
-                                list_add_tail (&request->unwinds, unwinds);
-
                                 if (!request->flags.write_request.got_reply) {
+                                        if (!__wb_window_available (conf,
+                                                                    file)) {
+                                                *blocked = 1;
+                                                break;
+                                        }
+
                                         file->window_current
                                                 += request->write_size;
+                                        conf->total_window_current
+                                                += request->write_size;
                                 }
+
+                                written_behind += request->write_size;
+                                request->flags.write_request.write_behind = 1;
+                                list_add_tail (&request->unwinds, unwinds);
                         }
                 } else {
                         break;
@@ -1704,30 +2412,43 @@ out:
 }
 
 
-void
-__wb_mark_unwinds (list_head_t *list, list_head_t *unwinds)
+/* returns 1 if the writes of file just started waiting for window */
+int
+__wb_mark_unwinds (wb_file_t *file, list_head_t *list, list_head_t *unwinds)
 {
-        wb_request_t *request = NULL;
-        wb_file_t    *file    = NULL;
+        wb_conf_t *conf    = NULL;
+        char       blocked = 0;
+        int        waiting = 0;
 
-        GF_VALIDATE_OR_GOTO ("write-behind", list, out);
-        GF_VALIDATE_OR_GOTO ("write-behind", unwinds, out);
+        GF_VALIDATE_OR_GOTO ("write-behind", file, out);
+        GF_VALIDATE_OR_GOTO (file->this->name, list, out);
+        GF_VALIDATE_OR_GOTO (file->this->name, unwinds, out);
 
-        if (list_empty (list)) {
-                goto out;
-        }
+        conf = file->this->private;
 
-        request = list_entry (list->next, typeof (*request), list);
-        file = request->file;
+        LOCK (&conf->lock);
+        {
+                if (file->window_current <= file->window_conf) {
+                        __wb_mark_unwind_till (list, unwinds,
+                                               file->window_conf
+                                               - file->window_current,
+                                               &blocked);
+                }
 
-        if (file->window_current <= file->window_conf) {
-                __wb_mark_unwind_till (list, unwinds,
-                                       file->window_conf
-                                       - file->window_current);
+                /* writers blocked on their own window are woken up by
+                 * their own replies, not by other files */
+                if (!blocked) {
+                        list_del_init (&file->waiting);
+                } else if (list_empty (&file->waiting)) {
+                        list_add_tail (&file->waiting, &conf->waiters);
+                        conf->blocked_writes++;
+                        waiting = 1;
+                }
         }
+        UNLOCK (&conf->lock);
 
 out:
-        return;
+        return waiting;
 }
 
 
@@ -1886,16 +2607,31 @@ out:
 }
 
 
+/*
+ * __wb_copy_into_holder - merge request into holder, request starting
+ * within or right at the end of holder. Data written by request replaces
+ * what holder had in the overlapping range, and the window held by that
+ * range is given back.
+ */
 inline int
-__wb_copy_into_holder (wb_request_t *holder, wb_request_t *request)
+__wb_copy_into_holder (wb_request_t *holder, wb_request_t *request,
+                       size_t capacity)
 {
-        char          *ptr    = NULL;
-        struct iobuf  *iobuf  = NULL;
-        struct iobref *iobref = NULL;
-        int            ret    = -1;
+        char          *ptr      = NULL;
+        struct iobuf  *iobuf    = NULL;
+        struct iobref *iobref   = NULL;
+        wb_file_t     *file     = NULL;
+        wb_conf_t     *conf     = NULL;
+        off_t          delta    = 0;
+        size_t         new_size = 0;
+        size_t         overlap  = 0;
+        int            ret      = -1;
+
+        file = request->file;
+        conf = file->this->private;
 
         if (holder->flags.write_request.virgin) {
-                iobuf = iobuf_get (request->file->this->ctx->iobuf_pool);
+                iobuf = iobuf_get2 (file->this->ctx->iobuf_pool, capacity);
                 if (iobuf == NULL) {
                         goto out;
                 }
@@ -1910,7 +2646,7 @@ __wb_copy_into_holder (wb_request_t *holder, wb_request_t *request)
                 if (ret != 0) {
                         iobuf_unref (iobuf);
                         iobref_unref (iobref);
-                        gf_log (request->file->this->name, GF_LOG_WARNING,
+                        gf_log (file->this->name, GF_LOG_WARNING,
                                 "cannot add iobuf (%p) into iobref (%p)",
                                 iobuf, iobref);
                         goto out;
@@ -1919,6 +2655,9 @@ __wb_copy_into_holder (wb_request_t *holder, wb_request_t *request)
                 iov_unload (iobuf->ptr, holder->stub->args.writev.vector,
                             holder->stub->args.writev.count);
                 holder->stub->args.writev.vector[0].iov_base = iobuf->ptr;
+                holder->stub->args.writev.vector[0].iov_len
+                        = holder->write_size;
+                holder->stub->args.writev.count = 1;
 
                 iobref_unref (holder->stub->args.writev.iobref);
                 holder->stub->args.writev.iobref = iobref;
@@ -1928,16 +2667,30 @@ __wb_copy_into_holder (wb_request_t *holder, wb_request_t *request)
                 holder->flags.write_request.virgin = 0;
         }
 
-        ptr = holder->stub->args.writev.vector[0].iov_base + holder->write_size;
+        delta = request->stub->args.writev.off - holder->stub->args.writev.off;
+        ptr = holder->stub->args.writev.vector[0].iov_base + delta;
 
         iov_unload (ptr, request->stub->args.writev.vector,
                     request->stub->args.writev.count);
 
-        holder->stub->args.writev.vector[0].iov_len += request->write_size;
-        holder->write_size += request->write_size;
+        new_size = max (holder->write_size, delta + request->write_size);
+        overlap = holder->write_size + request->write_size - new_size;
+
+        holder->stub->args.writev.vector[0].iov_len = new_size;
+        holder->write_size = new_size;
+
+        file->window_current -= overlap;
+        file->aggregate_current -= overlap;
+
+        LOCK (&conf->lock);
+        {
+                conf->total_window_current -= overlap;
+                conf->collapsed_writes++;
+        }
+        UNLOCK (&conf->lock);
 
         request->flags.write_request.stack_wound = 1;
-        list_move_tail (&request->list, &request->file->passive_requests);
+        list_move_tail (&request->list, &file->passive_requests);
 
         ret = 0;
 out:
@@ -1945,14 +2698,19 @@ out:
 }
 
 
-/* this procedure assumes that write requests have only one vector to write */
+/*
+ * packs adjacent, or overlapping, write-behind requests into buffers of
+ * capacity bytes. Requests of files opened with O_APPEND are only packed
+ * when adjacent, their offsets do not say where the data goes.
+ */
 void
-__wb_collapse_write_bufs (list_head_t *requests, size_t page_size)
+__wb_collapse_write_bufs (list_head_t *requests, size_t capacity)
 {
-        off_t         offset_expected = 0;
-        size_t        space_left      = 0;
-        wb_request_t *request         = NULL, *tmp = NULL, *holder = NULL;
-        int           ret             = 0;
+        off_t         holder_off = 0;
+        off_t         holder_end = 0;
+        off_t         offset     = 0;
+        wb_request_t *request    = NULL, *tmp = NULL, *holder = NULL;
+        int           ret        = 0;
 
         GF_VALIDATE_OR_GOTO ("write-behind", requests, out);
 
@@ -1964,35 +2722,35 @@ __wb_collapse_write_bufs (list_head_t *requests, size_t page_size)
                         continue;
                 }
 
-                if (request->flags.write_request.write_behind) {
-                        if (holder == NULL) {
-                                holder = request;
-                                continue;
-                        }
-
-                        offset_expected = holder->stub->args.writev.off
-                                + holder->write_size;
+                if (!request->flags.write_request.write_behind) {
+                        break;
+                }
 
-                        if (request->stub->args.writev.off != offset_expected) {
-                                holder = request;
-                                continue;
-                        }
+                if (holder == NULL) {
+                        holder = request;
+                        continue;
+                }
 
-                        space_left = page_size - holder->write_size;
+                holder_off = holder->stub->args.writev.off;
+                holder_end = holder_off + holder->write_size;
+                offset = request->stub->args.writev.off;
 
-                        if (space_left >= request->write_size) {
-                                ret = __wb_copy_into_holder (holder, request);
-                                if (ret != 0) {
-                                        break;
-                                }
+                if ((holder->write_size > capacity)
+                    || (offset < holder_off) || (offset > holder_end)
+                    || ((request->file->flags & O_APPEND)
+                        && (offset != holder_end))
+                    || ((offset - holder_off + request->write_size)
+                        > capacity)) {
+                        holder = request;
+                        continue;
+                }
 
-                                __wb_request_unref (request);
-                        } else {
-                                holder = request;
-                        }
-                } else {
+                ret = __wb_copy_into_holder (holder, request, capacity);
+                if (ret != 0) {
                         break;
                 }
+
+                __wb_request_unref (request);
         }
 
 out:
@@ -2000,6 +2758,9 @@ out:
 }
 
 
+static void
+wb_flush_dirty (xlator_t *this, char all);
+
 int32_t
 wb_process_queue (call_frame_t *frame, wb_file_t *file)
 {
@@ -2008,6 +2769,7 @@ wb_process_queue (call_frame_t *frame, wb_file_t *file)
         wb_conf_t  *conf   = NULL;
         uint32_t    count  = 0;
         int32_t     ret    = -1;
+        int         waiting = 0;
 
         INIT_LIST_HEAD (&winds);
         INIT_LIST_HEAD (&unwinds);
@@ -2025,14 +2787,15 @@ wb_process_queue (call_frame_t *frame, wb_file_t *file)
         {
                 /*
                  * make sure requests are marked for unwinding and adjacent
-                 * contiguous write buffers (each of size less than that of
-                 * an iobuf) are packed properly so that iobufs are filled to
-                 * their maximum capacity, before calling __wb_mark_winds.
+                 * or overlapping write buffers are packed into iobufs of
+                 * aggregate-size, the most a single write is wound with,
+                 * before calling __wb_mark_winds.
                  */
-                __wb_mark_unwinds (&file->request, &unwinds);
+                waiting = __wb_mark_unwinds (file, &file->request,
+                                             &unwinds);
 
                 __wb_collapse_write_bufs (&file->request,
-                                          file->this->ctx->page_size);
+                                          conf->aggregate_size);
 
                 count = __wb_get_other_requests (&file->request,
                                                  &other_requests);
@@ -2047,11 +2810,181 @@ wb_process_queue (call_frame_t *frame, wb_file_t *file)
 
         ret = wb_do_ops (frame, file, &winds, &unwinds, &other_requests);
 
+        /* the window is held by writes acknowledged already, have them
+         * wound now rather than when their files get more writes */
+        if (waiting) {
+                wb_flush_dirty (file->this, 1);
+        }
+
 out:
         return ret;
 }
 
 
+static void
+wb_flush_timer (void *data);
+
+/* assumes conf is locked */
+static void
+__wb_flush_timer_arm (xlator_t *this)
+{
+        wb_conf_t      *conf  = NULL;
+        struct timeval  delay = {1, 0};
+
+        conf = this->private;
+
+        if (!conf->flush_age || conf->flush_timer) {
+                return;
+        }
+
+        conf->flush_timer = gf_timer_call_after (this->ctx, delay,
+                                                 wb_flush_timer, this);
+        if (conf->flush_timer == NULL) {
+                gf_log (this->name, GF_LOG_WARNING,
+                        "cannot schedule flushing of aged writes");
+        }
+}
+
+
+/* assumes conf is locked */
+static void
+__wb_flush_timer_stop (xlator_t *this)
+{
+        wb_conf_t *conf = NULL;
+
+        conf = this->private;
+
+        if (conf->flush_timer) {
+                gf_timer_call_cancel (this->ctx, conf->flush_timer);
+                conf->flush_timer = NULL;
+        }
+}
+
+
+/*
+ * wb_flush_dirty - winds the writes of files holding data written behind
+ * for flush-age seconds or more, so that small writes reach the server
+ * even if nothing else comes to push them. With all, of every file holding
+ * some, so that the window writers wait for is given back.
+ */
+static void
+wb_flush_dirty (xlator_t *this, char all)
+{
+        wb_conf_t      *conf    = NULL;
+        wb_file_t      *file    = NULL, *tmp = NULL;
+        wb_request_t   *request = NULL;
+        call_frame_t   *frame   = NULL;
+        struct timeval  now     = {0, };
+        list_head_t     aged    = {0, };
+        int32_t         ret     = 0;
+        char            waiters = 0;
+        char            old     = 0;
+
+        conf = this->private;
+
+        INIT_LIST_HEAD (&aged);
+        gettimeofday (&now, NULL);
+
+        LOCK (&conf->lock);
+        {
+                list_for_each_entry (file, &conf->files, all) {
+                        /* a file already being flushed is left alone */
+                        if (!timerisset (&file->dirty_since)
+                            || !list_empty (&file->aged)) {
+                                continue;
+                        }
+
+                        old = conf->flush_age
+                                && ((now.tv_sec - file->dirty_since.tv_sec)
+                                    >= conf->flush_age);
+                        if (!old && !all) {
+                                continue;
+                        }
+
+                        __wb_file_ref (file);
+                        list_add_tail (&file->aged, &aged);
+                        if (old) {
+                                conf->aged_flushes++;
+                        }
+                }
+
+                waiters = !list_empty (&conf->waiters);
+        }
+        UNLOCK (&conf->lock);
+
+        if (list_empty (&aged) && !waiters) {
+                return;
+        }
+
+        frame = create_frame (this, this->ctx->pool);
+
+        list_for_each_entry_safe (file, tmp, &aged, aged) {
+                if (frame != NULL) {
+                        LOCK (&file->lock);
+                        {
+                                list_for_each_entry (request, &file->request,
+                                                     list) {
+                                        if ((request->stub == NULL)
+                                            || (request->stub->fop
+                                                != GF_FOP_WRITE)) {
+                                                continue;
+                                        }
+
+                                        request->flags.write_request.flush_all
+                                                = 1;
+                                }
+                        }
+                        UNLOCK (&file->lock);
+
+                        ret = wb_process_queue (frame, file);
+                        if (ret == -1) {
+                                gf_log (this->name, GF_LOG_WARNING,
+                                        "request queue processing failed");
+                        }
+                }
+
+                LOCK (&conf->lock);
+                {
+                        list_del_init (&file->aged);
+                }
+                UNLOCK (&conf->lock);
+
+                wb_file_destroy (file);
+        }
+
+        if (frame != NULL) {
+                /* in case a waiter was left behind by a file which got
+                 * window without any being released */
+                wb_wake_waiters (frame, this);
+                STACK_DESTROY (frame->root);
+        }
+}
+
+
+static void
+wb_flush_timer (void *data)
+{
+        xlator_t  *this = NULL;
+        wb_conf_t *conf = NULL;
+
+        this = data;
+        conf = this->private;
+
+        LOCK (&conf->lock);
+        {
+                if (conf->flush_timer) {
+                        gf_timer_call_cancel (this->ctx, conf->flush_timer);
+                        conf->flush_timer = NULL;
+                }
+
+                __wb_flush_timer_arm (this);
+        }
+        UNLOCK (&conf->lock);
+
+        wb_flush_dirty (this, 0);
+}
+
+
 int32_t
 wb_writev_cbk (call_frame_t *frame, void *cookie, xlator_t *this,
                int32_t op_ret, int32_t op_errno, struct iatt *prebuf,
@@ -2699,6 +3632,22 @@ wb_priv_dump (xlator_t *this)
         gf_proc_dump_write ("enable_trickling_writes", "%d",
                             conf->enable_trickling_writes);
 
+        LOCK (&conf->lock);
+        {
+                gf_proc_dump_write ("total_window_size", "%"PRIu64,
+                                    conf->total_window_size);
+                gf_proc_dump_write ("total_window_current", "%"PRIu64,
+                                    conf->total_window_current);
+                gf_proc_dump_write ("flush_age", "%d", conf->flush_age);
+                gf_proc_dump_write ("blocked_writes", "%"PRIu64,
+                                    conf->blocked_writes);
+                gf_proc_dump_write ("aged_flushes", "%"PRIu64,
+                                    conf->aged_flushes);
+                gf_proc_dump_write ("collapsed_writes", "%"PRIu64,
+                                    conf->collapsed_writes);
+        }
+        UNLOCK (&conf->lock);
+
         ret = 0;
 out:
         return ret;
@@ -2864,7 +3813,24 @@ reconfigure (xlator_t *this, dict_t *options)
         GF_OPTION_RECONF ("flush-behind", conf->flush_behind, options, bool,
                           out);
 
-        ret = 0;
+        LOCK (&conf->lock);
+        {
+                GF_OPTION_RECONF ("total-cache-size", conf->total_window_size,
+                                  options, size, unlock);
+
+                GF_OPTION_RECONF ("flush-age", conf->flush_age, options,
+                                  int32, unlock);
+
+                if (conf->flush_age) {
+                        __wb_flush_timer_arm (this);
+                } else {
+                        __wb_flush_timer_stop (this);
+                }
+
+                ret = 0;
+        }
+unlock:
+        UNLOCK (&conf->lock);
 out:
         return ret;
 }
@@ -2927,7 +3893,23 @@ init (xlator_t *this)
         GF_OPTION_INIT ("enable-trickling-writes", conf->enable_trickling_writes,
                         bool, out);
 
+        GF_OPTION_INIT ("total-cache-size", conf->total_window_size, size,
+                        out);
+
+        GF_OPTION_INIT ("flush-age", conf->flush_age, int32, out);
+
+        LOCK_INIT (&conf->lock);
+        INIT_LIST_HEAD (&conf->files);
+        INIT_LIST_HEAD (&conf->waiters);
+
         this->private = conf;
+
+        LOCK (&conf->lock);
+        {
+                __wb_flush_timer_arm (this);
+        }
+        UNLOCK (&conf->lock);
+
         ret = 0;
 
 out:
@@ -2951,7 +3933,14 @@ fini (xlator_t *this)
                 goto out;
         }
 
+        LOCK (&conf->lock);
+        {
+                __wb_flush_timer_stop (this);
+        }
+        UNLOCK (&conf->lock);
+
         this->private = NULL;
+        LOCK_DESTROY (&conf->lock);
         GF_FREE (conf);
 
 out:
@@ -2970,6 +3959,10 @@ struct xlator_fops fops = {
         .fstat       = wb_fstat,
         .truncate    = wb_truncate,
         .ftruncate   = wb_ftruncate,
+        .fallocate   = wb_fallocate,
+        .discard     = wb_discard,
+        .zerofill    = wb_zerofill,
+        .seek        = wb_seek,
         .setattr     = wb_setattr,
 };
 
@@ -3000,6 +3993,24 @@ struct volume_options options[] = {
           .description = "Size of the per-file write-behind buffer. "
 
         },
+        { .key  = {"total-cache-size", "total-window-size"},
+          .type = GF_OPTION_TYPE_SIZET,
+          .min  = 512 * GF_UNIT_KB,
+          .max  = 16 * GF_UNIT_GB,
+          .default_value = "32MB",
+          .description = "Memory all the files together may hold written "
+                         "behind. Writers in excess wait, in order, for "
+                         "data of others to reach the server."
+        },
+        { .key  = {"flush-age"},
+          .type = GF_OPTION_TYPE_INT,
+          .min  = 0,
+          .max  = 3600,
+          .default_value = "1",
+          .description = "Data written behind for this many seconds is "
+                         "sent to the server without waiting for more "
+                         "writes to aggregate with. 0 disables it."
+        },
         { .key = {"disable-for-first-nbytes"},
           .type = GF_OPTION_TYPE_SIZET,
           .min = 0,
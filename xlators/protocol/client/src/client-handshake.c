@@ -427,8 +427,8 @@ client3_1_reopen_cbk (struct rpc_req *req, struct iovec *iov, int count,
 
         if (rsp.op_ret < 0) {
                 gf_log (frame->this->name, GF_LOG_WARNING,
-                        "reopen on %s failed (%s)",
-                        local->loc.path, strerror (rsp.op_errno));
+                        "reopen on %s failed (%s)", local->loc.path,
+                        strerror (gf_error_to_errno (rsp.op_errno)));
         } else {
                 gf_log (frame->this->name, GF_LOG_DEBUG,
                         "reopen on %s succeeded (remote-fd = %"PRId64")",
@@ -478,6 +478,10 @@ client3_1_reopen_cbk (struct rpc_req *req, struct iovec *iov, int count,
                 fd_count = decrement_reopen_fd_count (frame->this, conf);
         }
 out:
+        if (local && local->fdctx)
+                client_reopen_done (frame->this, local->fdctx,
+                                    (ret < 0) ?
+                                    gf_error_to_errno (rsp.op_errno) : 0);
 
         if (fdctx)
                 client_fdctx_destroy (frame->this, fdctx);
@@ -529,8 +533,8 @@ client3_1_reopendir_cbk (struct rpc_req *req, struct iovec *iov, int count,
 
         if (rsp.op_ret < 0) {
                 gf_log (frame->this->name, GF_LOG_WARNING,
-                        "reopendir on %s failed (%s)",
-                        local->loc.path, strerror (rsp.op_errno));
+                        "reopendir on %s failed (%s)", local->loc.path,
+                        strerror (gf_error_to_errno (rsp.op_errno)));
         } else {
                 gf_log (frame->this->name, GF_LOG_INFO,
                         "reopendir on %s succeeded (fd = %"PRId64")",
@@ -564,6 +568,11 @@ client3_1_reopendir_cbk (struct rpc_req *req, struct iovec *iov, int count,
         ret = 0;
 
 out:
+        if (local && local->fdctx)
+                client_reopen_done (frame->this, local->fdctx,
+                                    (ret < 0) ?
+                                    gf_error_to_errno (rsp.op_errno) : 0);
+
         if (fdctx)
                 client_fdctx_destroy (frame->this, fdctx);
 
@@ -654,6 +663,8 @@ out:
         if (path)
                 GF_FREE (path);
         if ((ret < 0) && this && conf) {
+                if (fdctx)
+                        client_reopen_done (this, fdctx, EINVAL);
                 decrement_reopen_fd_count (this, conf);
         }
 
@@ -737,6 +748,8 @@ out:
                 GF_FREE (path);
 
         if ((ret < 0) && this && conf) {
+                if (fdctx)
+                        client_reopen_done (this, fdctx, EINVAL);
                 decrement_reopen_fd_count (this, conf);
         }
 
@@ -745,57 +758,340 @@ out:
 }
 
 
+/*
+ * Reopening fds after a reconnect: the fds are queued most recently used
+ * first, and at most 'reopen-window' reopen requests are kept in flight.
+ * CHILD_UP is not held back until all of them are reopened; a fop on an
+ * fd still in the queue is parked on it (CLIENT_REOPEN_WAIT), the fd is
+ * moved to the head of the queue, and the fop is resumed as soon as the
+ * reopen of that fd completes.
+ */
+
+static int
+client_reopen_cmp (const void *a, const void *b)
+{
+        const clnt_fd_ctx_t *fa = *(clnt_fd_ctx_t * const *)a;
+        const clnt_fd_ctx_t *fb = *(clnt_fd_ctx_t * const *)b;
+
+        if (fa->last_active > fb->last_active)
+                return -1;
+        if (fa->last_active < fb->last_active)
+                return 1;
+        return 0;
+}
+
+
+double
+client_reopen_elapsed (struct timeval *start, struct timeval *end)
+{
+        return (end->tv_sec - start->tv_sec) +
+                ((end->tv_usec - start->tv_usec) / 1000000.0);
+}
+
+
+int
+client_fd_reopen_pending (xlator_t *this, fd_t *fd)
+{
+        clnt_conf_t    *conf    = NULL;
+        clnt_fd_ctx_t  *fdctx   = NULL;
+        int             pending = 0;
+
+        conf = this->private;
+
+        /* unlocked check, to keep the common case cheap */
+        if (!conf || !fd || (conf->reopen_done == conf->reopen_total))
+                return 0;
+
+        pthread_mutex_lock (&conf->lock);
+        {
+                fdctx = this_fd_get_ctx (fd, this);
+                if (fdctx && (fdctx->reopen_state != CLIENT_REOPEN_NONE))
+                        pending = 1;
+        }
+        pthread_mutex_unlock (&conf->lock);
+
+        return pending;
+}
+
+
+int
+client_fd_reopen_wait (xlator_t *this, fd_t *fd, call_stub_t *stub)
+{
+        clnt_conf_t    *conf  = NULL;
+        clnt_fd_ctx_t  *fdctx = NULL;
+        int             ret   = -1;
+
+        conf = this->private;
+
+        pthread_mutex_lock (&conf->lock);
+        {
+                fdctx = this_fd_get_ctx (fd, this);
+                if (!fdctx || (fdctx->reopen_state == CLIENT_REOPEN_NONE))
+                        goto unlock;
+
+                /* somebody needs this fd right now, reopen it next */
+                if (fdctx->reopen_state == CLIENT_REOPEN_QUEUED)
+                        list_move (&fdctx->sfd_pos, &conf->reopen_queue);
+
+                fdctx->last_active = ++conf->fd_activity;
+                list_add_tail (&stub->list, &fdctx->reopen_waitq);
+                ret = 0;
+        }
+unlock:
+        pthread_mutex_unlock (&conf->lock);
+
+        if (ret == 0)
+                gf_log (this->name, GF_LOG_TRACE,
+                        "%s on fd %p waits for its reopen",
+                        gf_fop_list[stub->fop], fd);
+
+        return ret;
+}
+
+
+static void
+client_reopen_resume (struct list_head *waiters)
+{
+        call_stub_t  *stub = NULL;
+        call_stub_t  *tmp  = NULL;
+
+        list_for_each_entry_safe (stub, tmp, waiters, list) {
+                list_del_init (&stub->list);
+                call_resume (stub);
+        }
+}
+
+
+/* called once per fd taken off the reopen queue, whatever the outcome */
+void
+client_reopen_done (xlator_t *this, clnt_fd_ctx_t *fdctx, int op_errno)
+{
+        clnt_conf_t       *conf    = NULL;
+        struct list_head   waiters;
+        uint64_t           done    = 0;
+        uint64_t           total   = 0;
+        char               discard = 0;
+
+        conf = this->private;
+        INIT_LIST_HEAD (&waiters);
+
+        pthread_mutex_lock (&conf->lock);
+        {
+                fdctx->reopen_state = CLIENT_REOPEN_NONE;
+                list_splice_init (&fdctx->reopen_waitq, &waiters);
+
+                conf->reopen_inflight--;
+                done  = ++conf->reopen_done;
+                total = conf->reopen_total;
+
+                if (op_errno) {
+                        conf->reopen_failed++;
+
+                        if (fdctx->released)
+                                discard = 1;
+                        else if (op_errno == ENOTCONN)
+                                /* try again on the next reconnect */
+                                list_add_tail (&fdctx->sfd_pos,
+                                               &conf->saved_fds);
+                }
+        }
+        pthread_mutex_unlock (&conf->lock);
+
+        if (discard) {
+                inode_unref (fdctx->inode);
+                GF_FREE (fdctx);
+        }
+
+        client_reopen_resume (&waiters);
+
+        if (((done % 1000) == 0) && (done < total))
+                gf_log (this->name, GF_LOG_INFO,
+                        "reopened %"PRIu64" of %"PRIu64" fds",
+                        done, total);
+
+        client_reopen_pump (this);
+}
+
+
+void
+client_reopen_pump (xlator_t *this)
+{
+        clnt_conf_t    *conf     = NULL;
+        clnt_fd_ctx_t  *fdctx    = NULL;
+        char            released = 0;
+
+        conf = this->private;
+
+        pthread_mutex_lock (&conf->lock);
+        {
+                /* the loop below already runs, in this or another thread */
+                if (conf->reopen_pumping) {
+                        pthread_mutex_unlock (&conf->lock);
+                        return;
+                }
+                conf->reopen_pumping = 1;
+        }
+        pthread_mutex_unlock (&conf->lock);
+
+        for (;;) {
+                pthread_mutex_lock (&conf->lock);
+                {
+                        fdctx = NULL;
+                        if ((conf->reopen_inflight < conf->reopen_window)
+                            && !list_empty (&conf->reopen_queue)) {
+                                fdctx = list_entry (conf->reopen_queue.next,
+                                                    clnt_fd_ctx_t, sfd_pos);
+                                list_del_init (&fdctx->sfd_pos);
+
+                                released = fdctx->released;
+                                if (released) {
+                                        fdctx->reopen_state =
+                                                CLIENT_REOPEN_NONE;
+                                        conf->reopen_done++;
+                                } else {
+                                        fdctx->reopen_state =
+                                                CLIENT_REOPEN_SENT;
+                                        conf->reopen_inflight++;
+                                }
+                        } else {
+                                conf->reopen_pumping = 0;
+                        }
+                }
+                pthread_mutex_unlock (&conf->lock);
+
+                if (!fdctx)
+                        break;
+
+                if (released) {
+                        /* closed while waiting, nothing to reopen */
+                        inode_unref (fdctx->inode);
+                        GF_FREE (fdctx);
+                        decrement_reopen_fd_count (this, conf);
+                        continue;
+                }
+
+                if (fdctx->is_dir)
+                        protocol_client_reopendir (this, fdctx);
+                else
+                        protocol_client_reopen (this, fdctx);
+        }
+}
+
+
+/* on disconnect: fds not sent for reopen yet wait for the next connect */
+void
+client_reopen_abort (xlator_t *this)
+{
+        clnt_conf_t       *conf  = NULL;
+        clnt_fd_ctx_t     *fdctx = NULL;
+        clnt_fd_ctx_t     *tmp   = NULL;
+        struct list_head   waiters;
+        int                count = 0;
+
+        conf = this->private;
+        INIT_LIST_HEAD (&waiters);
+
+        pthread_mutex_lock (&conf->lock);
+        {
+                list_for_each_entry_safe (fdctx, tmp, &conf->reopen_queue,
+                                          sfd_pos) {
+                        fdctx->reopen_state = CLIENT_REOPEN_NONE;
+                        list_splice_init (&fdctx->reopen_waitq, &waiters);
+                        list_move_tail (&fdctx->sfd_pos, &conf->saved_fds);
+                        count++;
+                }
+
+                conf->reopen_done   += count;
+                conf->reopen_failed += count;
+        }
+        pthread_mutex_unlock (&conf->lock);
+
+        if (!count)
+                return;
+
+        gf_log (this->name, GF_LOG_INFO,
+                "disconnected with %d fds still to be reopened", count);
+
+        client_reopen_resume (&waiters);
+
+        while (count--)
+                decrement_reopen_fd_count (this, conf);
+}
+
+
 int
 client_post_handshake (call_frame_t *frame, xlator_t *this)
 {
         clnt_conf_t            *conf = NULL;
         clnt_fd_ctx_t          *tmp = NULL;
         clnt_fd_ctx_t          *fdctx = NULL;
-        struct list_head        reopen_head;
-
-        int count = 0;
+        clnt_fd_ctx_t         **fdctxs = NULL;
+        int                     count = 0;
+        int                     i = 0;
 
         if (!this || !this->private)
                 goto out;
 
         conf = this->private;
-        INIT_LIST_HEAD (&reopen_head);
 
         pthread_mutex_lock (&conf->lock);
         {
+                list_for_each_entry (fdctx, &conf->saved_fds, sfd_pos) {
+                        if (fdctx->remote_fd == -1)
+                                count++;
+                }
+
+                if (count)
+                        fdctxs = GF_CALLOC (count, sizeof (*fdctxs),
+                                            gf_client_mt_reopen_fdctxs_t);
+
                 list_for_each_entry_safe (fdctx, tmp, &conf->saved_fds,
                                           sfd_pos) {
                         if (fdctx->remote_fd != -1)
                                 continue;
 
-                        list_del_init (&fdctx->sfd_pos);
-                        list_add_tail (&fdctx->sfd_pos, &reopen_head);
-                        count++;
+                        fdctx->reopen_state = CLIENT_REOPEN_QUEUED;
+                        if (fdctxs)
+                                fdctxs[i++] = fdctx;
+                        list_move_tail (&fdctx->sfd_pos,
+                                        &conf->reopen_queue);
+                }
+
+                if (fdctxs) {
+                        /* most recently used first */
+                        qsort (fdctxs, count, sizeof (*fdctxs),
+                               client_reopen_cmp);
+                        for (i = 0; i < count; i++)
+                                list_move_tail (&fdctxs[i]->sfd_pos,
+                                                &conf->reopen_queue);
                 }
+
+                conf->reopen_total  = count;
+                conf->reopen_done   = 0;
+                conf->reopen_failed = 0;
+                gettimeofday (&conf->reopen_start, NULL);
+                timerclear (&conf->reopen_end);
         }
         pthread_mutex_unlock (&conf->lock);
 
-        /* Delay notifying CHILD_UP to parents
-           until all locks are recovered */
+        if (fdctxs)
+                GF_FREE (fdctxs);
+
         if (count > 0) {
                 gf_log (this->name, GF_LOG_INFO,
-                        "%d fds open - Delaying child_up until they are re-opened",
-                        count);
+                        "%d fds open - reopening them, %d at a time",
+                        count, conf->reopen_window);
                 client_save_number_fds (conf, count);
-
-                list_for_each_entry_safe (fdctx, tmp, &reopen_head, sfd_pos) {
-                        list_del_init (&fdctx->sfd_pos);
-
-                        if (fdctx->is_dir)
-                                protocol_client_reopendir (this, fdctx);
-                        else
-                                protocol_client_reopen (this, fdctx);
-                }
         } else {
                 gf_log (this->name, GF_LOG_DEBUG,
                         "no open fds - notifying all parents child up");
-                client_notify_parents_child_up (this);
         }
+
+        /* fops on fds which are not reopened yet wait for them */
+        client_notify_parents_child_up (this);
+
+        if (count > 0)
+                client_reopen_pump (this);
 out:
         return 0;
 }
@@ -610,9 +610,19 @@ decrement_reopen_fd_count (xlator_t *this, clnt_conf_t *conf)
         UNLOCK (&conf->rec_lock);
 
         if (fd_count == 0) {
+                pthread_mutex_lock (&conf->lock);
+                {
+                        gettimeofday (&conf->reopen_end, NULL);
+                }
+                pthread_mutex_unlock (&conf->lock);
+
                 gf_log (this->name, GF_LOG_INFO,
-                        "last fd open'd/lock-self-heal'd - notifying CHILD-UP");
-                client_notify_parents_child_up (this);
+                        "last fd open'd/lock-self-heal'd - %"PRIu64" fds "
+                        "reopened, %"PRIu64" failed, in %.3f secs",
+                        conf->reopen_done - conf->reopen_failed,
+                        conf->reopen_failed,
+                        client_reopen_elapsed (&conf->reopen_start,
+                                               &conf->reopen_end));
         }
 
         return fd_count;
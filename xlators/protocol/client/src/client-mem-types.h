@@ -29,6 +29,9 @@ enum gf_client_mem_types_ {
         gf_client_mt_clnt_req_buf_t,
         gf_client_mt_clnt_fdctx_t,
         gf_client_mt_clnt_lock_t,
+        gf_client_mt_compound_ops_t,
+        gf_client_mt_bulkstat_entry_t,
+        gf_client_mt_reopen_fdctxs_t,
         gf_client_mt_end,
 };
 #endif /* __CLIENT_MEM_TYPES_H__ */
@@ -347,6 +347,8 @@ client_ftruncate (call_frame_t *frame, xlator_t *this, fd_t *fd, off_t offset)
         if (!conf || !conf->fops)
                 goto out;
 
+        CLIENT_REOPEN_WAIT (this, fd, ftruncate, fd, offset);
+
         args.fd     = fd;
         args.offset = offset;
 
@@ -368,6 +370,155 @@ out:
 
 
 
+int32_t
+client_fallocate (call_frame_t *frame, xlator_t *this, fd_t *fd,
+                  int32_t mode, off_t offset, size_t len)
+{
+        int          ret  = -1;
+        clnt_conf_t *conf = NULL;
+        rpc_clnt_procedure_t *proc = NULL;
+        clnt_args_t  args = {0,};
+
+        conf = this->private;
+        if (!conf || !conf->fops)
+                goto out;
+
+        CLIENT_REOPEN_WAIT (this, fd, fallocate, fd, mode, offset, len);
+
+        args.fd     = fd;
+        args.flags  = mode;
+        args.offset = offset;
+        args.size   = len;
+
+        proc = &conf->fops->proctable[GF_FOP_FALLOCATE];
+        if (!proc) {
+                gf_log (this->name, GF_LOG_ERROR,
+                        "rpc procedure not found for %s",
+                        gf_fop_list[GF_FOP_FALLOCATE]);
+                goto out;
+        }
+        if (proc->fn)
+                ret = proc->fn (frame, this, &args);
+out:
+        if (ret)
+                STACK_UNWIND_STRICT (fallocate, frame, -1, ENOTCONN, NULL, NULL);
+
+	return 0;
+}
+
+
+
+int32_t
+client_discard (call_frame_t *frame, xlator_t *this, fd_t *fd,
+                off_t offset, size_t len)
+{
+        int          ret  = -1;
+        clnt_conf_t *conf = NULL;
+        rpc_clnt_procedure_t *proc = NULL;
+        clnt_args_t  args = {0,};
+
+        conf = this->private;
+        if (!conf || !conf->fops)
+                goto out;
+
+        CLIENT_REOPEN_WAIT (this, fd, discard, fd, offset, len);
+
+        args.fd     = fd;
+        args.offset = offset;
+        args.size   = len;
+
+        proc = &conf->fops->proctable[GF_FOP_DISCARD];
+        if (!proc) {
+                gf_log (this->name, GF_LOG_ERROR,
+                        "rpc procedure not found for %s",
+                        gf_fop_list[GF_FOP_DISCARD]);
+                goto out;
+        }
+        if (proc->fn)
+                ret = proc->fn (frame, this, &args);
+out:
+        if (ret)
+                STACK_UNWIND_STRICT (discard, frame, -1, ENOTCONN, NULL, NULL);
+
+	return 0;
+}
+
+
+
+int32_t
+client_zerofill (call_frame_t *frame, xlator_t *this, fd_t *fd,
+                 off_t offset, size_t len)
+{
+        int          ret  = -1;
+        clnt_conf_t *conf = NULL;
+        rpc_clnt_procedure_t *proc = NULL;
+        clnt_args_t  args = {0,};
+
+        conf = this->private;
+        if (!conf || !conf->fops)
+                goto out;
+
+        CLIENT_REOPEN_WAIT (this, fd, zerofill, fd, offset, len);
+
+        args.fd     = fd;
+        args.offset = offset;
+        args.size   = len;
+
+        proc = &conf->fops->proctable[GF_FOP_ZEROFILL];
+        if (!proc) {
+                gf_log (this->name, GF_LOG_ERROR,
+                        "rpc procedure not found for %s",
+                        gf_fop_list[GF_FOP_ZEROFILL]);
+                goto out;
+        }
+        if (proc->fn)
+                ret = proc->fn (frame, this, &args);
+out:
+        if (ret)
+                STACK_UNWIND_STRICT (zerofill, frame, -1, ENOTCONN, NULL, NULL);
+
+	return 0;
+}
+
+
+
+int32_t
+client_seek (call_frame_t *frame, xlator_t *this, fd_t *fd,
+             off_t offset, gf_seek_what_t what)
+{
+        int          ret  = -1;
+        clnt_conf_t *conf = NULL;
+        rpc_clnt_procedure_t *proc = NULL;
+        clnt_args_t  args = {0,};
+
+        conf = this->private;
+        if (!conf || !conf->fops)
+                goto out;
+
+        CLIENT_REOPEN_WAIT (this, fd, seek, fd, offset, what);
+
+        args.fd     = fd;
+        args.offset = offset;
+        args.what   = what;
+
+        proc = &conf->fops->proctable[GF_FOP_SEEK];
+        if (!proc) {
+                gf_log (this->name, GF_LOG_ERROR,
+                        "rpc procedure not found for %s",
+                        gf_fop_list[GF_FOP_SEEK]);
+                goto out;
+        }
+        if (proc->fn)
+                ret = proc->fn (frame, this, &args);
+out:
+        if (ret)
+                STACK_UNWIND_STRICT (seek, frame, -1, ENOTCONN, 0);
+
+	return 0;
+}
+
+
+
 int32_t
 client_access (call_frame_t *frame, xlator_t *this, loc_t *loc, int32_t mask)
 {
@@ -764,6 +915,8 @@ client_readv (call_frame_t *frame, xlator_t *this, fd_t *fd, size_t size,
         if (!conf || !conf->fops)
                 goto out;
 
+        CLIENT_REOPEN_WAIT (this, fd, readv, fd, size, offset);
+
         args.fd     = fd;
         args.size   = size;
         args.offset = offset;
@@ -803,6 +956,9 @@ client_writev (call_frame_t *frame, xlator_t *this, fd_t *fd,
         if (!conf || !conf->fops)
                 goto out;
 
+        CLIENT_REOPEN_WAIT (this, fd, writev, fd, vector, count, off,
+                            iobref);
+
         args.fd     = fd;
         args.vector = vector;
         args.count  = count;
@@ -839,6 +995,8 @@ client_flush (call_frame_t *frame, xlator_t *this, fd_t *fd)
         if (!conf || !conf->fops)
                 goto out;
 
+        CLIENT_REOPEN_WAIT (this, fd, flush, fd);
+
         args.fd = fd;
 
         proc = &conf->fops->proctable[GF_FOP_FLUSH];
@@ -872,6 +1030,8 @@ client_fsync (call_frame_t *frame, xlator_t *this, fd_t *fd,
         if (!conf || !conf->fops)
                 goto out;
 
+        CLIENT_REOPEN_WAIT (this, fd, fsync, fd, flags);
+
         args.fd    = fd;
         args.flags = flags;
 
@@ -905,6 +1065,8 @@ client_fstat (call_frame_t *frame, xlator_t *this, fd_t *fd)
         if (!conf || !conf->fops)
                 goto out;
 
+        CLIENT_REOPEN_WAIT (this, fd, fstat, fd);
+
         args.fd = fd;
 
         proc = &conf->fops->proctable[GF_FOP_FSTAT];
@@ -970,6 +1132,8 @@ client_fsyncdir (call_frame_t *frame, xlator_t *this, fd_t *fd, int32_t flags)
         if (!conf || !conf->fops)
                 goto out;
 
+        CLIENT_REOPEN_WAIT (this, fd, fsyncdir, fd, flags);
+
         args.fd    = fd;
         args.flags = flags;
 
@@ -1228,6 +1392,8 @@ client_fsetxattr (call_frame_t *frame, xlator_t *this, fd_t *fd,
         if (!conf || !conf->fops)
                 goto out;
 
+        CLIENT_REOPEN_WAIT (this, fd, fsetxattr, fd, dict, flags);
+
         args.fd = fd;
         args.dict = dict;
         args.flags = flags;
@@ -1264,6 +1430,8 @@ client_fgetxattr (call_frame_t *frame, xlator_t *this, fd_t *fd,
         if (!conf || !conf->fops)
                 goto out;
 
+        CLIENT_REOPEN_WAIT (this, fd, fgetxattr, fd, name);
+
         args.fd = fd;
         args.name = name;
 
@@ -1367,6 +1535,8 @@ client_fxattrop (call_frame_t *frame, xlator_t *this, fd_t *fd,
         if (!conf || !conf->fops)
                 goto out;
 
+        CLIENT_REOPEN_WAIT (this, fd, fxattrop, fd, flags, dict);
+
         args.fd = fd;
         args.flags = flags;
         args.dict = dict;
@@ -1435,6 +1605,8 @@ client_lk (call_frame_t *frame, xlator_t *this, fd_t *fd, int32_t cmd,
         if (!conf || !conf->fops)
                 goto out;
 
+        CLIENT_REOPEN_WAIT (this, fd, lk, fd, cmd, lock);
+
         args.fd    = fd;
         args.cmd   = cmd;
         args.flock = lock;
@@ -1505,6 +1677,8 @@ client_finodelk (call_frame_t *frame, xlator_t *this, const char *volume,
         if (!conf || !conf->fops)
                 goto out;
 
+        CLIENT_REOPEN_WAIT (this, fd, finodelk, volume, fd, cmd, lock);
+
         args.fd     = fd;
         args.cmd    = cmd;
         args.flock  = lock;
@@ -1579,6 +1753,9 @@ client_fentrylk (call_frame_t *frame, xlator_t *this, const char *volume,
         if (!conf || !conf->fops)
                 goto out;
 
+        CLIENT_REOPEN_WAIT (this, fd, fentrylk, volume, fd, basename, cmd,
+                            type);
+
         args.fd           = fd;
         args.basename     = basename;
         args.type         = type;
@@ -1615,6 +1792,8 @@ client_rchecksum (call_frame_t *frame, xlator_t *this, fd_t *fd, off_t offset,
         if (!conf || !conf->fops)
                 goto out;
 
+        CLIENT_REOPEN_WAIT (this, fd, rchecksum, fd, offset, len);
+
         args.fd = fd;
         args.offset = offset;
         args.len = len;
@@ -1648,6 +1827,8 @@ client_readdir (call_frame_t *frame, xlator_t *this, fd_t *fd,
         if (!conf || !conf->fops)
                 goto out;
 
+        CLIENT_REOPEN_WAIT (this, fd, readdir, fd, size, off);
+
         args.fd = fd;
         args.size = size;
         args.offset = off;
@@ -1682,6 +1863,8 @@ client_readdirp (call_frame_t *frame, xlator_t *this, fd_t *fd,
         if (!conf || !conf->fops)
                 goto out;
 
+        CLIENT_REOPEN_WAIT (this, fd, readdirp, fd, size, off);
+
         args.fd = fd;
         args.size = size;
         args.offset = off;
@@ -1749,6 +1932,8 @@ client_fsetattr (call_frame_t *frame, xlator_t *this, fd_t *fd,
         if (!conf || !conf->fops)
                 goto out;
 
+        CLIENT_REOPEN_WAIT (this, fd, fsetattr, fd, stbuf, valid);
+
         args.fd = fd;
         args.stbuf = stbuf;
         args.valid = valid;
@@ -1806,6 +1991,72 @@ out:
 }
 
 
+int32_t
+client_compound (call_frame_t *frame, xlator_t *this, compound_args_t *cargs)
+{
+        int          ret  = -1;
+        clnt_conf_t *conf = NULL;
+        rpc_clnt_procedure_t *proc = NULL;
+        clnt_args_t  args = {0,};
+
+        conf = this->private;
+        if (!conf || !conf->fops)
+                goto out;
+
+        args.compound = cargs;
+
+        proc = &conf->fops->proctable[GF_FOP_COMPOUND];
+        if (!proc) {
+                gf_log (this->name, GF_LOG_ERROR,
+                        "rpc procedure not found for %s",
+                        gf_fop_list[GF_FOP_COMPOUND]);
+                goto out;
+        }
+        if (proc->fn)
+                ret = proc->fn (frame, this, &args);
+out:
+        if (ret) {
+                compound_args_fail (cargs, 0, ENOTCONN);
+                STACK_UNWIND_STRICT (compound, frame, -1, ENOTCONN, cargs);
+        }
+
+	return 0;
+}
+
+
+int32_t
+client_bulkstat (call_frame_t *frame, xlator_t *this, loc_t *locs,
+                 int32_t count)
+{
+        int          ret  = -1;
+        clnt_conf_t *conf = NULL;
+        rpc_clnt_procedure_t *proc = NULL;
+        clnt_args_t  args = {0,};
+
+        conf = this->private;
+        if (!conf || !conf->fops)
+                goto out;
+
+        args.loc   = locs;
+        args.count = count;
+
+        proc = &conf->fops->proctable[GF_FOP_BULKSTAT];
+        if (!proc) {
+                gf_log (this->name, GF_LOG_ERROR,
+                        "rpc procedure not found for %s",
+                        gf_fop_list[GF_FOP_BULKSTAT]);
+                goto out;
+        }
+        if (proc->fn)
+                ret = proc->fn (frame, this, &args);
+out:
+        if (ret)
+                STACK_UNWIND_STRICT (bulkstat, frame, -1, ENOTCONN, NULL, NULL);
+
+	return 0;
+}
+
+
  int
 client_mark_fd_bad (xlator_t *this)
 {
@@ -1877,6 +2128,7 @@ client_rpc_notify (struct rpc_clnt *rpc, void *mydata, rpc_clnt_event_t event,
         }
         case RPC_CLNT_DISCONNECT:
 
+                client_reopen_abort (this);
                 client_mark_fd_bad (this);
 
                 if (!conf->skip_notify) {
@@ -1969,6 +2221,8 @@ build_client_config (xlator_t *this, clnt_conf_t *conf)
         GF_OPTION_INIT ("ping-timeout", conf->opt.ping_timeout,
                         int32, out);
 
+        GF_OPTION_INIT ("reopen-window", conf->reopen_window, int32, out);
+
         GF_OPTION_INIT ("remote-subvolume", conf->opt.remote_subvolume,
                         path, out);
         if (!conf->opt.remote_subvolume)
@@ -2090,6 +2344,9 @@ reconfigure (xlator_t *this, dict_t *options)
         GF_OPTION_RECONF ("ping-timeout", conf->opt.ping_timeout,
                           options, int32, out);
 
+        GF_OPTION_RECONF ("reopen-window", conf->reopen_window,
+                          options, int32, out);
+
         subvol_ret = dict_get_str (this->options, "remote-host",
                                    &old_remote_host);
 
@@ -2150,6 +2407,7 @@ init (xlator_t *this)
 
         pthread_mutex_init (&conf->lock, NULL);
         INIT_LIST_HEAD (&conf->saved_fds);
+        INIT_LIST_HEAD (&conf->reopen_queue);
 
         LOCK_INIT (&conf->rec_lock);
 
@@ -2212,6 +2470,7 @@ client_priv_dump (xlator_t *this)
         int             i = 0;
         char            key[GF_DUMP_MAX_BUF_LEN];
         char            key_prefix[GF_DUMP_MAX_BUF_LEN];
+        struct timeval  now = {0, };
 
         if (!this)
                 return -1;
@@ -2240,6 +2499,30 @@ client_priv_dump (xlator_t *this)
                 gf_proc_dump_write(key, "%d", tmp->remote_fd);
         }
 
+        if (conf->reopen_total) {
+                gf_proc_dump_write ("reopen.total", "%"PRIu64,
+                                    conf->reopen_total);
+                gf_proc_dump_write ("reopen.done", "%"PRIu64,
+                                    conf->reopen_done);
+                gf_proc_dump_write ("reopen.failed", "%"PRIu64,
+                                    conf->reopen_failed);
+                gf_proc_dump_write ("reopen.inflight", "%d",
+                                    conf->reopen_inflight);
+                if (timerisset (&conf->reopen_end)) {
+                        gf_proc_dump_write ("reopen.duration", "%.3f secs",
+                                            client_reopen_elapsed (
+                                                    &conf->reopen_start,
+                                                    &conf->reopen_end));
+                } else {
+                        gettimeofday (&now, NULL);
+                        gf_proc_dump_write ("reopen.elapsed", "%.3f secs",
+                                            client_reopen_elapsed (
+                                                    &conf->reopen_start,
+                                                    &now));
+                }
+        }
+        gf_proc_dump_write ("reopen.window", "%d", conf->reopen_window);
+
         gf_proc_dump_write("connecting", "%d", conf->connecting);
         gf_proc_dump_write("last_sent", "%s", ctime(&conf->last_sent.tv_sec));
         gf_proc_dump_write("last_received", "%s", ctime(&conf->last_received.tv_sec));
@@ -2322,6 +2605,12 @@ struct xlator_fops fops = {
         .setattr     = client_setattr,
         .fsetattr    = client_fsetattr,
         .getspec     = client_getspec,
+        .compound    = client_compound,
+        .bulkstat    = client_bulkstat,
+        .fallocate   = client_fallocate,
+        .discard     = client_discard,
+        .zerofill    = client_zerofill,
+        .seek        = client_seek,
 };
 
 
@@ -2373,5 +2662,13 @@ struct volume_options options[] = {
         { .key   = {"client-bind-insecure"},
           .type  = GF_OPTION_TYPE_BOOL
         },
+        { .key   = {"reopen-window"},
+          .type  = GF_OPTION_TYPE_INT,
+          .min   = 1,
+          .max   = 65536,
+          .default_value = "64",
+          .description = "Maximum number of fd reopen requests kept in "
+                         "flight after a reconnect."
+        },
         { .key   = {NULL} },
 };
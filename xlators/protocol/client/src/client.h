@@ -29,6 +29,9 @@
 #include "client-mem-types.h"
 #include "protocol-common.h"
 #include "glusterfs3.h"
+#include "compound.h"
+#include "bulkstat.h"
+#include "call-stub.h"
 
 /* FIXME: Needs to be defined in a common file */
 #define CLIENT_CMD_CONNECT    "trusted.glusterfs.client-connect"
@@ -40,6 +43,9 @@
                 pthread_mutex_lock (&conf->lock);                       \
                 {                                                       \
                         fdctx = this_fd_get_ctx (args->fd, this);       \
+                        if (fdctx)                                      \
+                                fdctx->last_active =                    \
+                                        ++conf->fd_activity;            \
                 }                                                       \
                 pthread_mutex_unlock (&conf->lock);                     \
                                                                         \
@@ -60,6 +66,32 @@
                 }                                                       \
         } while (0);
 
+/* Park a fop on an fd which is waiting to be reopened after a reconnect.
+   It is resumed as soon as the reopen of that fd completes, see
+   client_reopen_done (). Used at the top of the fd based fops of client.c */
+#define CLIENT_REOPEN_WAIT(this, fd, fop, params...)                    \
+        do {                                                            \
+                call_stub_t *__stub = NULL;                             \
+                                                                        \
+                if (!client_fd_reopen_pending (this, fd))               \
+                        break;                                          \
+                                                                        \
+                __stub = fop_##fop##_stub (frame, client_##fop, params);\
+                if (!__stub)                                            \
+                        break;                                          \
+                                                                        \
+                if (client_fd_reopen_wait (this, fd, __stub) == 0)      \
+                        return 0;                                       \
+                                                                        \
+                call_stub_destroy (__stub);                             \
+        } while (0)
+
+typedef enum {
+        CLIENT_REOPEN_NONE = 0,
+        CLIENT_REOPEN_QUEUED,           /* waiting for a slot in the window */
+        CLIENT_REOPEN_SENT,             /* reopen request in flight */
+} client_reopen_state_t;
+
 struct clnt_options {
         char *remote_subvolume;
         int   ping_timeout;
@@ -83,6 +115,18 @@ typedef struct clnt_conf {
 
         uint64_t               reopen_fd_count; /* Count of fds reopened after a
                                                    connection is established */
+        struct list_head       reopen_queue;    /* fds to reopen, most recently
+                                                   used first */
+        int32_t                reopen_window;   /* max reopens in flight */
+        int32_t                reopen_inflight;
+        char                   reopen_pumping;
+        uint64_t               reopen_total;    /* fds to reopen in this round */
+        uint64_t               reopen_done;
+        uint64_t               reopen_failed;
+        struct timeval         reopen_start;
+        struct timeval         reopen_end;
+        uint64_t               fd_activity;     /* ticks on every fd fop, for
+                                                   ordering the reopens */
         gf_lock_t              rec_lock;
         int                    skip_notify;
 
@@ -111,6 +155,10 @@ typedef struct _client_fd_ctx {
 
         pthread_mutex_t   mutex;
         struct list_head  lock_list;     /* List of all granted locks on this fd */
+
+        client_reopen_state_t reopen_state;
+        uint64_t          last_active;   /* conf->fd_activity at last use */
+        struct list_head  reopen_waitq;  /* fops parked until reopened */
 } clnt_fd_ctx_t;
 
 typedef struct _client_posix_lock {
@@ -140,6 +188,7 @@ typedef struct client_local {
         int32_t              cmd;
         struct list_head     lock_list;
         pthread_mutex_t      mutex;
+        compound_args_t     *compound;
 } clnt_local_t;
 
 typedef struct client_args {
@@ -171,8 +220,10 @@ typedef struct client_args {
         entrylk_cmd         cmd_entrylk;
         entrylk_type        type;
         gf_xattrop_flags_t  optype;
+        gf_seek_what_t      what;
         int32_t             valid;
         int32_t             len;
+        compound_args_t    *compound;
 } clnt_args_t;
 
 typedef ssize_t (*gfs_serialize_t) (struct iovec outmsg, void *args);
@@ -193,6 +244,12 @@ int client_submit_request (xlator_t *this, void *req,
 
 int protocol_client_reopendir (xlator_t *this, clnt_fd_ctx_t *fdctx);
 int protocol_client_reopen (xlator_t *this, clnt_fd_ctx_t *fdctx);
+int client_fd_reopen_pending (xlator_t *this, fd_t *fd);
+int client_fd_reopen_wait (xlator_t *this, fd_t *fd, call_stub_t *stub);
+void client_reopen_done (xlator_t *this, clnt_fd_ctx_t *fdctx, int op_errno);
+void client_reopen_pump (xlator_t *this);
+void client_reopen_abort (xlator_t *this);
+double client_reopen_elapsed (struct timeval *start, struct timeval *end);
 
 int unserialize_rsp_dirent (struct gfs3_readdir_rsp *rsp, gf_dirent_t *entries);
 int unserialize_rsp_direntp (struct gfs3_readdirp_rsp *rsp, gf_dirent_t *entries);
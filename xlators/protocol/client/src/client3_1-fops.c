@@ -24,6 +24,7 @@
 
 #include "client.h"
 #include "glusterfs3-xdr.h"
+#include "glusterfs3-xdr-fast.h"
 #include "glusterfs3.h"
 #include "compat-errno.h"
 
@@ -354,6 +355,7 @@ client3_1_open_cbk (struct rpc_req *req, struct iovec *iov, int count,
 
                 INIT_LIST_HEAD (&fdctx->sfd_pos);
                 INIT_LIST_HEAD (&fdctx->lock_list);
+                INIT_LIST_HEAD (&fdctx->reopen_waitq);
 
                 this_fd_set_ctx (fd, frame->this, &local->loc, fdctx);
 
@@ -400,7 +402,7 @@ client3_1_stat_cbk (struct rpc_req *req, struct iovec *iov, int count,
                 rsp.op_errno = ENOTCONN;
                 goto out;
         }
-        ret = xdr_to_generic (*iov, &rsp, (xdrproc_t)xdr_gfs3_stat_rsp);
+        ret = xdr_to_generic (*iov, &rsp, (xdrproc_t)xdr_fast_gfs3_stat_rsp);
         if (ret < 0) {
                 gf_log (this->name, GF_LOG_ERROR, "XDR decoding failed");
                 rsp.op_ret   = -1;
@@ -1159,6 +1161,180 @@ out:
         return 0;
 }
 
+int
+client3_1_fallocate_cbk (struct rpc_req *req, struct iovec *iov, int count,
+                         void *myframe)
+{
+        gfs3_fallocate_rsp rsp = {0,};
+        call_frame_t   *frame = NULL;
+        struct iatt  prestat  = {0,};
+        struct iatt  poststat = {0,};
+        int ret = 0;
+        xlator_t         *this       = NULL;
+
+        this = THIS;
+
+        frame = myframe;
+
+        if (-1 == req->rpc_status) {
+                rsp.op_ret   = -1;
+                rsp.op_errno = ENOTCONN;
+                goto out;
+        }
+        ret = xdr_to_generic (*iov, &rsp, (xdrproc_t)xdr_gfs3_fallocate_rsp);
+        if (ret < 0) {
+                gf_log (this->name, GF_LOG_ERROR, "XDR decoding failed");
+                rsp.op_ret   = -1;
+                rsp.op_errno = EINVAL;
+                goto out;
+        }
+
+        if (-1 != rsp.op_ret) {
+                gf_stat_to_iatt (&rsp.statpre, &prestat);
+                gf_stat_to_iatt (&rsp.statpost, &poststat);
+        }
+
+out:
+        if (rsp.op_ret == -1) {
+                gf_log (this->name, GF_LOG_WARNING, "remote operation failed: %s",
+                        strerror (gf_error_to_errno (rsp.op_errno)));
+        }
+        STACK_UNWIND_STRICT (fallocate, frame, rsp.op_ret,
+                             gf_error_to_errno (rsp.op_errno), &prestat,
+                             &poststat);
+
+        return 0;
+}
+
+int
+client3_1_discard_cbk (struct rpc_req *req, struct iovec *iov, int count,
+                       void *myframe)
+{
+        gfs3_discard_rsp rsp = {0,};
+        call_frame_t   *frame = NULL;
+        struct iatt  prestat  = {0,};
+        struct iatt  poststat = {0,};
+        int ret = 0;
+        xlator_t         *this       = NULL;
+
+        this = THIS;
+
+        frame = myframe;
+
+        if (-1 == req->rpc_status) {
+                rsp.op_ret   = -1;
+                rsp.op_errno = ENOTCONN;
+                goto out;
+        }
+        ret = xdr_to_generic (*iov, &rsp, (xdrproc_t)xdr_gfs3_discard_rsp);
+        if (ret < 0) {
+                gf_log (this->name, GF_LOG_ERROR, "XDR decoding failed");
+                rsp.op_ret   = -1;
+                rsp.op_errno = EINVAL;
+                goto out;
+        }
+
+        if (-1 != rsp.op_ret) {
+                gf_stat_to_iatt (&rsp.statpre, &prestat);
+                gf_stat_to_iatt (&rsp.statpost, &poststat);
+        }
+
+out:
+        if (rsp.op_ret == -1) {
+                gf_log (this->name, GF_LOG_WARNING, "remote operation failed: %s",
+                        strerror (gf_error_to_errno (rsp.op_errno)));
+        }
+        STACK_UNWIND_STRICT (discard, frame, rsp.op_ret,
+                             gf_error_to_errno (rsp.op_errno), &prestat,
+                             &poststat);
+
+        return 0;
+}
+
+int
+client3_1_zerofill_cbk (struct rpc_req *req, struct iovec *iov, int count,
+                        void *myframe)
+{
+        gfs3_zerofill_rsp rsp = {0,};
+        call_frame_t   *frame = NULL;
+        struct iatt  prestat  = {0,};
+        struct iatt  poststat = {0,};
+        int ret = 0;
+        xlator_t         *this       = NULL;
+
+        this = THIS;
+
+        frame = myframe;
+
+        if (-1 == req->rpc_status) {
+                rsp.op_ret   = -1;
+                rsp.op_errno = ENOTCONN;
+                goto out;
+        }
+        ret = xdr_to_generic (*iov, &rsp, (xdrproc_t)xdr_gfs3_zerofill_rsp);
+        if (ret < 0) {
+                gf_log (this->name, GF_LOG_ERROR, "XDR decoding failed");
+                rsp.op_ret   = -1;
+                rsp.op_errno = EINVAL;
+                goto out;
+        }
+
+        if (-1 != rsp.op_ret) {
+                gf_stat_to_iatt (&rsp.statpre, &prestat);
+                gf_stat_to_iatt (&rsp.statpost, &poststat);
+        }
+
+out:
+        if (rsp.op_ret == -1) {
+                gf_log (this->name, GF_LOG_WARNING, "remote operation failed: %s",
+                        strerror (gf_error_to_errno (rsp.op_errno)));
+        }
+        STACK_UNWIND_STRICT (zerofill, frame, rsp.op_ret,
+                             gf_error_to_errno (rsp.op_errno), &prestat,
+                             &poststat);
+
+        return 0;
+}
+
+int
+client3_1_seek_cbk (struct rpc_req *req, struct iovec *iov, int count,
+                    void *myframe)
+{
+        gfs3_seek_rsp  rsp   = {0,};
+        call_frame_t  *frame = NULL;
+        int            ret   = 0;
+        xlator_t      *this  = NULL;
+
+        this = THIS;
+
+        frame = myframe;
+
+        if (-1 == req->rpc_status) {
+                rsp.op_ret   = -1;
+                rsp.op_errno = ENOTCONN;
+                goto out;
+        }
+        ret = xdr_to_generic (*iov, &rsp, (xdrproc_t)xdr_gfs3_seek_rsp);
+        if (ret < 0) {
+                gf_log (this->name, GF_LOG_ERROR, "XDR decoding failed");
+                rsp.op_ret   = -1;
+                rsp.op_errno = EINVAL;
+                goto out;
+        }
+
+out:
+        /* ENXIO only says there is no more data or hole past the offset */
+        if ((rsp.op_ret == -1) &&
+            (gf_error_to_errno (rsp.op_errno) != ENXIO)) {
+                gf_log (this->name, GF_LOG_WARNING, "remote operation failed: %s",
+                        strerror (gf_error_to_errno (rsp.op_errno)));
+        }
+        STACK_UNWIND_STRICT (seek, frame, rsp.op_ret,
+                             gf_error_to_errno (rsp.op_errno), rsp.offset);
+
+        return 0;
+}
+
 int
 client3_1_fstat_cbk (struct rpc_req *req, struct iovec *iov, int count,
                      void *myframe)
@@ -1178,7 +1354,7 @@ client3_1_fstat_cbk (struct rpc_req *req, struct iovec *iov, int count,
                 rsp.op_errno = ENOTCONN;
                 goto out;
         }
-        ret = xdr_to_generic (*iov, &rsp, (xdrproc_t)xdr_gfs3_fstat_rsp);
+        ret = xdr_to_generic (*iov, &rsp, (xdrproc_t)xdr_fast_gfs3_fstat_rsp);
         if (ret < 0) {
                 gf_log (this->name, GF_LOG_ERROR, "XDR decoding failed");
                 rsp.op_ret   = -1;
@@ -1717,6 +1893,7 @@ client3_1_create_cbk (struct rpc_req *req, struct iovec *iov, int count,
 
                 INIT_LIST_HEAD (&fdctx->sfd_pos);
                 INIT_LIST_HEAD (&fdctx->lock_list);
+                INIT_LIST_HEAD (&fdctx->reopen_waitq);
 
                 this_fd_set_ctx (fd, frame->this, &local->loc, fdctx);
 
@@ -1876,7 +2053,7 @@ client3_1_readdir_cbk (struct rpc_req *req, struct iovec *iov, int count,
                 goto out;
         }
 
-        ret = xdr_to_generic (*iov, &rsp, (xdrproc_t)xdr_gfs3_readdir_rsp);
+        ret = xdr_to_generic (*iov, &rsp, (xdrproc_t)xdr_fast_gfs3_readdir_rsp);
         if (ret < 0) {
                 gf_log (this->name, GF_LOG_ERROR, "XDR decoding failed");
                 rsp.op_ret   = -1;
@@ -1933,7 +2110,7 @@ client3_1_readdirp_cbk (struct rpc_req *req, struct iovec *iov, int count,
                 goto out;
         }
 
-        ret = xdr_to_generic (*iov, &rsp, (xdrproc_t)xdr_gfs3_readdirp_rsp);
+        ret = xdr_to_generic (*iov, &rsp, (xdrproc_t)xdr_fast_gfs3_readdirp_rsp);
         if (ret < 0) {
                 gf_log (this->name, GF_LOG_ERROR, "XDR decoding failed");
                 rsp.op_ret   = -1;
@@ -2133,6 +2310,7 @@ client3_1_opendir_cbk (struct rpc_req *req, struct iovec *iov, int count,
 
                 INIT_LIST_HEAD (&fdctx->sfd_pos);
                 INIT_LIST_HEAD (&fdctx->lock_list);
+                INIT_LIST_HEAD (&fdctx->reopen_waitq);
 
                 this_fd_set_ctx (fd, frame->this, &local->loc, fdctx);
 
@@ -2189,7 +2367,7 @@ client3_1_lookup_cbk (struct rpc_req *req, struct iovec *iov, int count,
                 goto out;
         }
 
-        ret = xdr_to_generic (*iov, &rsp, (xdrproc_t)xdr_gfs3_lookup_rsp);
+        ret = xdr_to_generic (*iov, &rsp, (xdrproc_t)xdr_fast_gfs3_lookup_rsp);
         if (ret < 0) {
                 gf_log (this->name, GF_LOG_ERROR, "XDR decoding failed");
                 rsp.op_ret   = -1;
@@ -2300,7 +2478,7 @@ client3_1_readv_cbk (struct rpc_req *req, struct iovec *iov, int count,
                 goto out;
         }
 
-        ret = xdr_to_generic (*iov, &rsp, (xdrproc_t)xdr_gfs3_read_rsp);
+        ret = xdr_to_generic (*iov, &rsp, (xdrproc_t)xdr_fast_gfs3_read_rsp);
         if (ret < 0) {
                 gf_log (this->name, GF_LOG_ERROR, "XDR decoding failed");
                 rsp.op_ret   = -1;
@@ -2332,6 +2510,392 @@ out:
         return 0;
 }
 
+static int
+client3_1_compound_fdctx_set (xlator_t *this, compound_req_t *creq,
+                              int64_t remote_fd)
+{
+        clnt_conf_t   *conf  = NULL;
+        clnt_fd_ctx_t *fdctx = NULL;
+
+        conf = this->private;
+
+        fdctx = GF_CALLOC (1, sizeof (*fdctx), gf_client_mt_clnt_fdctx_t);
+        if (!fdctx)
+                return -1;
+
+        fdctx->remote_fd = remote_fd;
+        fdctx->inode     = inode_ref (creq->fd->inode);
+        fdctx->flags     = creq->flags;
+        fdctx->wbflags   = creq->wbflags;
+
+        INIT_LIST_HEAD (&fdctx->sfd_pos);
+        INIT_LIST_HEAD (&fdctx->lock_list);
+        INIT_LIST_HEAD (&fdctx->reopen_waitq);
+
+        this_fd_set_ctx (creq->fd, this, &creq->loc, fdctx);
+
+        pthread_mutex_lock (&conf->lock);
+        {
+                list_add_tail (&fdctx->sfd_pos, &conf->saved_fds);
+        }
+        pthread_mutex_unlock (&conf->lock);
+
+        return 0;
+}
+
+
+static int
+client3_1_compound_lookup_rsp (call_frame_t *frame, compound_args_t *cargs,
+                               int i, gfs3_lookup_rsp *rsp)
+{
+        compound_req_t *creq       = NULL;
+        struct iatt     stbuf      = {0,};
+        struct iatt     postparent = {0,};
+        dict_t         *xattr      = NULL;
+        char           *buf        = NULL;
+        int             op_errno   = 0;
+        int             ret        = 0;
+
+        creq = &cargs->req[i];
+        op_errno = gf_error_to_errno (rsp->op_errno);
+
+        if (rsp->op_ret == -1)
+                goto out;
+
+        gf_stat_to_iatt (&rsp->stat, &stbuf);
+        gf_stat_to_iatt (&rsp->postparent, &postparent);
+
+        if (rsp->dict.dict_len > 0) {
+                xattr = dict_new ();
+                buf = memdup (rsp->dict.dict_val, rsp->dict.dict_len);
+                if (!xattr || !buf) {
+                        op_errno = ENOMEM;
+                        goto out;
+                }
+
+                ret = dict_unserialize (buf, rsp->dict.dict_len, &xattr);
+                if (ret < 0) {
+                        gf_log (frame->this->name, GF_LOG_WARNING,
+                                "%s: failed to unserialize dictionary",
+                                creq->loc.path);
+                        op_errno = EINVAL;
+                        goto out;
+                }
+
+                xattr->extra_free = buf;
+                buf = NULL;
+        }
+
+        if (creq->loc.inode && !uuid_is_null (creq->loc.inode->gfid)
+            && uuid_compare (stbuf.ia_gfid, creq->loc.inode->gfid)) {
+                gf_log (frame->this->name, GF_LOG_DEBUG,
+                        "gfid changed for %s", creq->loc.path);
+                op_errno = ESTALE;
+                goto out;
+        }
+
+        compound_rsp_set (cargs, i, 0, 0, creq->loc.inode, &stbuf, NULL,
+                          &postparent, xattr, NULL, 0, NULL);
+        op_errno = 0;
+out:
+        if (op_errno)
+                compound_rsp_set (cargs, i, -1, op_errno, NULL, NULL, NULL,
+                                  NULL, NULL, NULL, 0, NULL);
+        if (xattr)
+                dict_unref (xattr);
+        if (buf)
+                GF_FREE (buf);
+
+        return op_errno ? -1 : 0;
+}
+
+
+static int
+client3_1_compound_read_rsp (call_frame_t *frame, compound_args_t *cargs,
+                             int i, gfs3_compound_read_rsp *rsp)
+{
+        struct iobuf  *iobuf  = NULL;
+        struct iobref *iobref = NULL;
+        struct iovec   vector = {0,};
+        struct iatt    stat   = {0,};
+        int            ret    = -1;
+
+        if (rsp->rsp.op_ret == -1) {
+                compound_rsp_set (cargs, i, -1,
+                                  gf_error_to_errno (rsp->rsp.op_errno),
+                                  NULL, NULL, NULL, NULL, NULL, NULL, 0, NULL);
+                return -1;
+        }
+
+        gf_stat_to_iatt (&rsp->rsp.stat, &stat);
+
+        if (rsp->data.data_len) {
+                iobref = iobref_new ();
+                iobuf = iobuf_get2 (frame->this->ctx->iobuf_pool,
+                                    rsp->data.data_len);
+                if (!iobref || !iobuf)
+                        goto out;
+
+                iobref_add (iobref, iobuf);
+                memcpy (iobuf_ptr (iobuf), rsp->data.data_val,
+                        rsp->data.data_len);
+                vector.iov_base = iobuf_ptr (iobuf);
+                vector.iov_len  = rsp->data.data_len;
+        }
+
+        compound_rsp_set (cargs, i, rsp->rsp.op_ret, 0, NULL, &stat, NULL,
+                          NULL, NULL, &vector, 1, iobref);
+        ret = 0;
+out:
+        if (ret)
+                compound_rsp_set (cargs, i, -1, ENOMEM, NULL, NULL, NULL,
+                                  NULL, NULL, NULL, 0, NULL);
+        if (iobuf)
+                iobuf_unref (iobuf);
+        if (iobref)
+                iobref_unref (iobref);
+
+        return ret;
+}
+
+
+int
+client3_1_compound_cbk (struct rpc_req *req, struct iovec *iov, int count,
+                        void *myframe)
+{
+        call_frame_t         *frame    = NULL;
+        clnt_local_t         *local    = NULL;
+        compound_args_t      *cargs    = NULL;
+        compound_req_t       *creq     = NULL;
+        gfs3_compound_rsp     rsp      = {0,};
+        gfs3_compound_rsp_op *op       = NULL;
+        struct iatt           stat     = {0,};
+        struct iatt           prestat  = {0,};
+        struct iatt           postparent = {0,};
+        xlator_t             *this     = NULL;
+        int                   op_ret   = 0;
+        int                   op_errno = 0;
+        int                   ret      = 0;
+        int                   i        = 0;
+
+        this = THIS;
+
+        frame = myframe;
+        local = frame->local;
+        frame->local = NULL;
+        cargs = local->compound;
+
+        if (-1 == req->rpc_status) {
+                op_ret   = -1;
+                op_errno = ENOTCONN;
+                goto out;
+        }
+
+        ret = xdr_to_generic (*iov, &rsp, (xdrproc_t)xdr_gfs3_compound_rsp);
+        if (ret < 0) {
+                gf_log (this->name, GF_LOG_ERROR, "XDR decoding failed");
+                op_ret   = -1;
+                op_errno = EINVAL;
+                goto out;
+        }
+
+        if (rsp.ops.ops_len > (u_int)cargs->count) {
+                gf_log (this->name, GF_LOG_ERROR,
+                        "%d replies for a compound of %d fops",
+                        rsp.ops.ops_len, cargs->count);
+                op_ret   = -1;
+                op_errno = EINVAL;
+                goto out;
+        }
+
+        for (i = 0; i < rsp.ops.ops_len; i++) {
+                op   = &rsp.ops.ops_val[i];
+                creq = &cargs->req[i];
+
+                switch (op->fop) {
+                case GFS3_COMPOUND_LOOKUP:
+                        client3_1_compound_lookup_rsp (
+                                frame, cargs, i,
+                                &op->gfs3_compound_rsp_op_u.lookup_rsp);
+                        break;
+
+                case GFS3_COMPOUND_OPEN:
+                {
+                        gfs3_open_rsp *r = &op->gfs3_compound_rsp_op_u.open_rsp;
+
+                        if ((r->op_ret != -1)
+                            && client3_1_compound_fdctx_set (this, creq,
+                                                             r->fd)) {
+                                r->op_ret   = -1;
+                                r->op_errno = ENOMEM;
+                        }
+                        compound_rsp_set (cargs, i, r->op_ret,
+                                          gf_error_to_errno (r->op_errno),
+                                          NULL, NULL, NULL, NULL, NULL, NULL,
+                                          0, NULL);
+                        break;
+                }
+
+                case GFS3_COMPOUND_READ:
+                        client3_1_compound_read_rsp (
+                                frame, cargs, i,
+                                &op->gfs3_compound_rsp_op_u.read_rsp);
+                        break;
+
+                case GFS3_COMPOUND_CREATE:
+                {
+                        gfs3_create_rsp *r =
+                                &op->gfs3_compound_rsp_op_u.create_rsp;
+
+                        gf_stat_to_iatt (&r->stat, &stat);
+                        gf_stat_to_iatt (&r->preparent, &prestat);
+                        gf_stat_to_iatt (&r->postparent, &postparent);
+
+                        if ((r->op_ret != -1)
+                            && client3_1_compound_fdctx_set (this, creq,
+                                                             r->fd)) {
+                                r->op_ret   = -1;
+                                r->op_errno = ENOMEM;
+                        }
+                        compound_rsp_set (cargs, i, r->op_ret,
+                                          gf_error_to_errno (r->op_errno),
+                                          creq->loc.inode, &stat, &prestat,
+                                          &postparent, NULL, NULL, 0, NULL);
+                        break;
+                }
+
+                case GFS3_COMPOUND_WRITE:
+                {
+                        gfs3_write_rsp *r = &op->gfs3_compound_rsp_op_u.write_rsp;
+
+                        gf_stat_to_iatt (&r->prestat, &prestat);
+                        gf_stat_to_iatt (&r->poststat, &stat);
+
+                        compound_rsp_set (cargs, i, r->op_ret,
+                                          gf_error_to_errno (r->op_errno),
+                                          NULL, &stat, &prestat, NULL, NULL,
+                                          NULL, 0, NULL);
+                        break;
+                }
+
+                case GFS3_COMPOUND_FLUSH:
+                {
+                        gf_common_rsp *r = &op->gfs3_compound_rsp_op_u.flush_rsp;
+
+                        /* Delete all saved locks of the owner issuing flush */
+                        if (r->op_ret >= 0)
+                                delete_granted_locks_owner (creq->fd,
+                                                            frame->root->lk_owner);
+
+                        compound_rsp_set (cargs, i, r->op_ret,
+                                          gf_error_to_errno (r->op_errno),
+                                          NULL, NULL, NULL, NULL, NULL, NULL,
+                                          0, NULL);
+                        break;
+                }
+                }
+        }
+
+        cargs->done = rsp.ops.ops_len;
+        op_ret      = rsp.op_ret;
+        op_errno    = gf_error_to_errno (rsp.op_errno);
+
+out:
+        if (op_ret == -1) {
+                compound_args_fail (cargs, cargs->done, op_errno);
+                gf_log (this->name, GF_LOG_WARNING,
+                        "remote operation failed: %s",
+                        strerror (op_errno));
+        }
+        STACK_UNWIND_STRICT (compound, frame, op_ret, op_errno, cargs);
+
+        client_local_wipe (local);
+
+        /* decoded by libc, don't use GF_FREE */
+        xdr_free ((xdrproc_t)xdr_gfs3_compound_rsp, (char *)&rsp);
+
+        return 0;
+}
+
+int
+client3_1_bulkstat_cbk (struct rpc_req *req, struct iovec *iov, int count,
+                        void *myframe)
+{
+        call_frame_t            *frame     = NULL;
+        gfs3_bulkstat_rsp        rsp       = {0,};
+        gfs3_bulkstat_rsp_entry *entry     = NULL;
+        struct iatt             *bufs      = NULL;
+        int32_t                 *op_errnos = NULL;
+        xlator_t                *this      = NULL;
+        int                      op_ret    = 0;
+        int                      op_errno  = 0;
+        int                      ret       = 0;
+        u_int                    i         = 0;
+
+        this = THIS;
+
+        frame = myframe;
+
+        if (-1 == req->rpc_status) {
+                op_ret   = -1;
+                op_errno = ENOTCONN;
+                goto out;
+        }
+
+        ret = xdr_to_generic (*iov, &rsp, (xdrproc_t)xdr_gfs3_bulkstat_rsp);
+        if (ret < 0) {
+                gf_log (this->name, GF_LOG_ERROR, "XDR decoding failed");
+                op_ret   = -1;
+                op_errno = EINVAL;
+                goto out;
+        }
+
+        op_ret   = rsp.op_ret;
+        op_errno = gf_error_to_errno (rsp.op_errno);
+        if (op_ret == -1)
+                goto out;
+
+        bufs = GF_CALLOC (rsp.entries.entries_len + 1, sizeof (*bufs),
+                          gf_common_mt_bulkstat_t);
+        op_errnos = GF_CALLOC (rsp.entries.entries_len + 1,
+                               sizeof (*op_errnos), gf_common_mt_bulkstat_t);
+        if (!bufs || !op_errnos) {
+                op_ret   = -1;
+                op_errno = ENOMEM;
+                goto out;
+        }
+
+        for (i = 0; i < rsp.entries.entries_len; i++) {
+                entry = &rsp.entries.entries_val[i];
+
+                op_errnos[i] = gf_error_to_errno (entry->op_errno);
+                if (op_errnos[i] == 0)
+                        gf_stat_to_iatt (&entry->stat, &bufs[i]);
+        }
+
+        op_ret = rsp.entries.entries_len;
+
+out:
+        if (op_ret == -1) {
+                gf_log (this->name, GF_LOG_WARNING,
+                        "remote operation failed: %s",
+                        strerror (op_errno));
+        }
+        STACK_UNWIND_STRICT (bulkstat, frame, op_ret, op_errno, bufs,
+                             op_errnos);
+
+        if (bufs)
+                GF_FREE (bufs);
+
+        if (op_errnos)
+                GF_FREE (op_errnos);
+
+        /* decoded by libc, don't use GF_FREE */
+        xdr_free ((xdrproc_t)xdr_gfs3_bulkstat_rsp, (char *)&rsp);
+
+        return 0;
+}
+
 int
 client3_1_release_cbk (struct rpc_req *req, struct iovec *iov, int count,
                        void *myframe)
@@ -2607,7 +3171,7 @@ client3_1_lookup (call_frame_t *frame, xlator_t *this,
                                      GFS3_OP_LOOKUP, client3_1_lookup_cbk,
                                      NULL, rsphdr, count,
                                      NULL, 0, local->iobref,
-                                     (xdrproc_t)xdr_gfs3_lookup_req);
+                                     (xdrproc_t)xdr_fast_gfs3_lookup_req);
 
         if (ret) {
                 op_errno = ENOTCONN;
@@ -3575,7 +4139,7 @@ client3_1_readv (call_frame_t *frame, xlator_t *this,
                                      GFS3_OP_READ, client3_1_readv_cbk, NULL,
                                      NULL, 0, &rsp_vec, 1,
                                      local->iobref,
-                                     (xdrproc_t)xdr_gfs3_read_req);
+                                     (xdrproc_t)xdr_fast_gfs3_read_req);
         if (ret) {
                 op_errno = ENOTCONN;
                 goto unwind;
@@ -3615,71 +4179,240 @@ client3_1_writev (call_frame_t *frame, xlator_t *this, void *data)
 
         CLIENT_GET_FD_CTX(conf, args, fdctx, op_errno, unwind);
 
-        req.size   = args->size;
-        req.offset = args->offset;
+        req.size   = args->size;
+        req.offset = args->offset;
+        req.fd     = fdctx->remote_fd;
+
+        ret = client_submit_vec_request (this, &req, frame, conf->fops, GFS3_OP_WRITE,
+                                         client3_1_writev_cbk, args->vector,
+                                         args->count, args->iobref,
+                                         (xdrproc_t)xdr_fast_gfs3_write_req);
+        if (ret) {
+                /*
+                 * If the lower layers fail to submit a request, they'll also
+                 * do the unwind for us (see rpc_clnt_submit), so don't unwind
+                 * here in such cases.
+                 */
+                gf_log (this->name, GF_LOG_WARNING,
+                        "failed to send the fop: %s", strerror (op_errno));
+        }
+
+        return 0;
+
+unwind:
+        STACK_UNWIND_STRICT (writev, frame, -1, op_errno, NULL, NULL);
+        return 0;
+}
+
+
+int32_t
+client3_1_flush (call_frame_t *frame, xlator_t *this,
+                 void *data)
+{
+        clnt_args_t    *args     = NULL;
+        gfs3_flush_req  req      = {{0,},};
+        clnt_fd_ctx_t  *fdctx    = NULL;
+        clnt_conf_t    *conf     = NULL;
+        clnt_local_t *local    = NULL;
+        int             op_errno = ESTALE;
+        int             ret      = 0;
+
+        if (!frame || !this || !data)
+                goto unwind;
+
+        args = data;
+        conf = this->private;
+
+        CLIENT_GET_FD_CTX(conf, args, fdctx, op_errno, unwind);
+
+        conf = this->private;
+
+        local = GF_CALLOC (1, sizeof (*local), gf_client_mt_clnt_local_t);
+        if (!local) {
+                STACK_UNWIND (frame, -1, ENOMEM);
+                return 0;
+
+        }
+
+        local->fd = fd_ref (args->fd);
+        local->owner = frame->root->lk_owner;
+        frame->local = local;
+
+        req.fd = fdctx->remote_fd;
+
+        ret = client_submit_request (this, &req, frame, conf->fops,
+                                     GFS3_OP_FLUSH, client3_1_flush_cbk, NULL,
+                                     NULL, 0, NULL, 0,
+                                     NULL, (xdrproc_t)xdr_gfs3_flush_req);
+        if (ret) {
+                op_errno = ENOTCONN;
+                goto unwind;
+        }
+        return 0;
+unwind:
+        gf_log (this->name, GF_LOG_WARNING, "failed to send the fop: %s", strerror (op_errno));
+        STACK_UNWIND_STRICT (flush, frame, -1, op_errno);
+        return 0;
+}
+
+
+
+int32_t
+client3_1_fsync (call_frame_t *frame, xlator_t *this,
+                 void *data)
+{
+        clnt_args_t    *args     = NULL;
+        gfs3_fsync_req  req      = {{0,},};
+        clnt_fd_ctx_t  *fdctx    = NULL;
+        clnt_conf_t    *conf     = NULL;
+        int             op_errno = 0;
+        int           ret        = 0;
+
+        if (!frame || !this || !data)
+                goto unwind;
+
+        args = data;
+        conf = this->private;
+
+        CLIENT_GET_FD_CTX(conf, args, fdctx, op_errno, unwind);
+
+        req.fd   = fdctx->remote_fd;
+        req.data = args->flags;
+
+        ret = client_submit_request (this, &req, frame, conf->fops,
+                                     GFS3_OP_FSYNC, client3_1_fsync_cbk, NULL,
+                                     NULL, 0, NULL, 0,
+                                     NULL, (xdrproc_t)xdr_gfs3_fsync_req);
+        if (ret) {
+                op_errno = ENOTCONN;
+                goto unwind;
+        }
+        return 0;
+unwind:
+        gf_log (this->name, GF_LOG_WARNING, "failed to send the fop: %s", strerror (op_errno));
+        STACK_UNWIND_STRICT (fsync, frame, -1, op_errno, NULL, NULL);
+        return 0;
+}
+
+
+
+int32_t
+client3_1_fallocate (call_frame_t *frame, xlator_t *this,
+                     void *data)
+{
+        clnt_args_t        *args     = NULL;
+        clnt_fd_ctx_t      *fdctx    = NULL;
+        clnt_conf_t        *conf     = NULL;
+        gfs3_fallocate_req  req      = {{0,},};
+        int                 op_errno = EINVAL;
+        int                 ret      = 0;
+
+        if (!frame || !this || !data)
+                goto unwind;
+
+        args = data;
+
+        conf = this->private;
+
+        CLIENT_GET_FD_CTX(conf, args, fdctx, op_errno, unwind);
+
+        req.fd     = fdctx->remote_fd;
+        req.flags  = args->flags;
+        req.offset = args->offset;
+        req.size   = args->size;
+        memcpy (req.gfid, args->fd->inode->gfid, 16);
+
+        ret = client_submit_request (this, &req, frame, conf->fops,
+                                     GFS3_OP_FALLOCATE,
+                                     client3_1_fallocate_cbk, NULL,
+                                     NULL, 0, NULL, 0,
+                                     NULL, (xdrproc_t)xdr_gfs3_fallocate_req);
+        if (ret) {
+                op_errno = ENOTCONN;
+                goto unwind;
+        }
+        return 0;
+unwind:
+        gf_log (this->name, GF_LOG_WARNING, "failed to send the fop: %s", strerror (op_errno));
+        STACK_UNWIND_STRICT (fallocate, frame, -1, op_errno, NULL, NULL);
+        return 0;
+}
+
+
+
+int32_t
+client3_1_discard (call_frame_t *frame, xlator_t *this,
+                   void *data)
+{
+        clnt_args_t        *args     = NULL;
+        clnt_fd_ctx_t      *fdctx    = NULL;
+        clnt_conf_t        *conf     = NULL;
+        gfs3_discard_req    req      = {{0,},};
+        int                 op_errno = EINVAL;
+        int                 ret      = 0;
+
+        if (!frame || !this || !data)
+                goto unwind;
+
+        args = data;
+
+        conf = this->private;
+
+        CLIENT_GET_FD_CTX(conf, args, fdctx, op_errno, unwind);
+
         req.fd     = fdctx->remote_fd;
+        req.offset = args->offset;
+        req.size   = args->size;
+        memcpy (req.gfid, args->fd->inode->gfid, 16);
 
-        ret = client_submit_vec_request (this, &req, frame, conf->fops, GFS3_OP_WRITE,
-                                         client3_1_writev_cbk, args->vector,
-                                         args->count, args->iobref,
-                                         (xdrproc_t)xdr_gfs3_write_req);
+        ret = client_submit_request (this, &req, frame, conf->fops,
+                                     GFS3_OP_DISCARD,
+                                     client3_1_discard_cbk, NULL,
+                                     NULL, 0, NULL, 0,
+                                     NULL, (xdrproc_t)xdr_gfs3_discard_req);
         if (ret) {
-                /*
-                 * If the lower layers fail to submit a request, they'll also
-                 * do the unwind for us (see rpc_clnt_submit), so don't unwind
-                 * here in such cases.
-                 */
-                gf_log (this->name, GF_LOG_WARNING,
-                        "failed to send the fop: %s", strerror (op_errno));
+                op_errno = ENOTCONN;
+                goto unwind;
         }
-
         return 0;
-
 unwind:
-        STACK_UNWIND_STRICT (writev, frame, -1, op_errno, NULL, NULL);
+        gf_log (this->name, GF_LOG_WARNING, "failed to send the fop: %s", strerror (op_errno));
+        STACK_UNWIND_STRICT (discard, frame, -1, op_errno, NULL, NULL);
         return 0;
 }
 
 
+
 int32_t
-client3_1_flush (call_frame_t *frame, xlator_t *this,
-                 void *data)
+client3_1_zerofill (call_frame_t *frame, xlator_t *this,
+                    void *data)
 {
-        clnt_args_t    *args     = NULL;
-        gfs3_flush_req  req      = {{0,},};
-        clnt_fd_ctx_t  *fdctx    = NULL;
-        clnt_conf_t    *conf     = NULL;
-        clnt_local_t *local    = NULL;
-        int             op_errno = ESTALE;
-        int             ret      = 0;
+        clnt_args_t        *args     = NULL;
+        clnt_fd_ctx_t      *fdctx    = NULL;
+        clnt_conf_t        *conf     = NULL;
+        gfs3_zerofill_req   req      = {{0,},};
+        int                 op_errno = EINVAL;
+        int                 ret      = 0;
 
         if (!frame || !this || !data)
                 goto unwind;
 
         args = data;
-        conf = this->private;
-
-        CLIENT_GET_FD_CTX(conf, args, fdctx, op_errno, unwind);
 
         conf = this->private;
 
-        local = GF_CALLOC (1, sizeof (*local), gf_client_mt_clnt_local_t);
-        if (!local) {
-                STACK_UNWIND (frame, -1, ENOMEM);
-                return 0;
-
-        }
-
-        local->fd = fd_ref (args->fd);
-        local->owner = frame->root->lk_owner;
-        frame->local = local;
+        CLIENT_GET_FD_CTX(conf, args, fdctx, op_errno, unwind);
 
-        req.fd = fdctx->remote_fd;
+        req.fd     = fdctx->remote_fd;
+        req.offset = args->offset;
+        req.size   = args->size;
+        memcpy (req.gfid, args->fd->inode->gfid, 16);
 
         ret = client_submit_request (this, &req, frame, conf->fops,
-                                     GFS3_OP_FLUSH, client3_1_flush_cbk, NULL,
+                                     GFS3_OP_ZEROFILL,
+                                     client3_1_zerofill_cbk, NULL,
                                      NULL, 0, NULL, 0,
-                                     NULL, (xdrproc_t)xdr_gfs3_flush_req);
+                                     NULL, (xdrproc_t)xdr_gfs3_zerofill_req);
         if (ret) {
                 op_errno = ENOTCONN;
                 goto unwind;
@@ -3687,38 +4420,42 @@ client3_1_flush (call_frame_t *frame, xlator_t *this,
         return 0;
 unwind:
         gf_log (this->name, GF_LOG_WARNING, "failed to send the fop: %s", strerror (op_errno));
-        STACK_UNWIND_STRICT (flush, frame, -1, op_errno);
+        STACK_UNWIND_STRICT (zerofill, frame, -1, op_errno, NULL, NULL);
         return 0;
 }
 
 
 
 int32_t
-client3_1_fsync (call_frame_t *frame, xlator_t *this,
-                 void *data)
+client3_1_seek (call_frame_t *frame, xlator_t *this,
+                void *data)
 {
-        clnt_args_t    *args     = NULL;
-        gfs3_fsync_req  req      = {{0,},};
-        clnt_fd_ctx_t  *fdctx    = NULL;
-        clnt_conf_t    *conf     = NULL;
-        int             op_errno = 0;
-        int           ret        = 0;
+        clnt_args_t        *args     = NULL;
+        clnt_fd_ctx_t      *fdctx    = NULL;
+        clnt_conf_t        *conf     = NULL;
+        gfs3_seek_req       req      = {{0,},};
+        int                 op_errno = EINVAL;
+        int                 ret      = 0;
 
         if (!frame || !this || !data)
                 goto unwind;
 
         args = data;
+
         conf = this->private;
 
         CLIENT_GET_FD_CTX(conf, args, fdctx, op_errno, unwind);
 
-        req.fd   = fdctx->remote_fd;
-        req.data = args->flags;
+        req.fd     = fdctx->remote_fd;
+        req.offset = args->offset;
+        req.what   = args->what;
+        memcpy (req.gfid, args->fd->inode->gfid, 16);
 
         ret = client_submit_request (this, &req, frame, conf->fops,
-                                     GFS3_OP_FSYNC, client3_1_fsync_cbk, NULL,
+                                     GFS3_OP_SEEK,
+                                     client3_1_seek_cbk, NULL,
                                      NULL, 0, NULL, 0,
-                                     NULL, (xdrproc_t)xdr_gfs3_fsync_req);
+                                     NULL, (xdrproc_t)xdr_gfs3_seek_req);
         if (ret) {
                 op_errno = ENOTCONN;
                 goto unwind;
@@ -3726,7 +4463,7 @@ client3_1_fsync (call_frame_t *frame, xlator_t *this,
         return 0;
 unwind:
         gf_log (this->name, GF_LOG_WARNING, "failed to send the fop: %s", strerror (op_errno));
-        STACK_UNWIND_STRICT (fsync, frame, -1, op_errno, NULL, NULL);
+        STACK_UNWIND_STRICT (seek, frame, -1, op_errno, 0);
         return 0;
 }
 
@@ -5229,6 +5966,384 @@ unwind:
 
 
 
+static void
+client3_1_compound_req_free (gfs3_compound_req *req, char **flat)
+{
+        gfs3_compound_req_op *op = NULL;
+        int                   i  = 0;
+
+        if (!req->ops.ops_val)
+                return;
+
+        for (i = 0; i < req->ops.ops_len; i++) {
+                op = &req->ops.ops_val[i];
+
+                if ((op->fop == GFS3_COMPOUND_LOOKUP)
+                    && op->gfs3_compound_req_op_u.lookup_req.dict.dict_val)
+                        GF_FREE (op->gfs3_compound_req_op_u.lookup_req.dict.dict_val);
+                if ((op->fop == GFS3_COMPOUND_CREATE)
+                    && op->gfs3_compound_req_op_u.create_req.dict.dict_val)
+                        GF_FREE (op->gfs3_compound_req_op_u.create_req.dict.dict_val);
+                if (flat[i])
+                        GF_FREE (flat[i]);
+        }
+
+        GF_FREE (req->ops.ops_val);
+}
+
+
+/* Fills in the remote fd of a READ, WRITE or FLUSH sub-fop: either the fd
+   is open already, or it is the one the compound itself opens. */
+static int
+client3_1_compound_remote_fd (xlator_t *this, compound_args_t *cargs, int i,
+                              int64_t *remote_fd)
+{
+        clnt_conf_t   *conf  = NULL;
+        clnt_fd_ctx_t *fdctx = NULL;
+
+        conf = this->private;
+
+        pthread_mutex_lock (&conf->lock);
+        {
+                fdctx = this_fd_get_ctx (cargs->req[i].fd, this);
+        }
+        pthread_mutex_unlock (&conf->lock);
+
+        if (fdctx && (fdctx->remote_fd != -1)) {
+                *remote_fd = fdctx->remote_fd;
+                return 0;
+        }
+
+        if (compound_linked_fd (cargs, i) >= 0) {
+                *remote_fd = GF_COMPOUND_LINKED_FD;
+                return 0;
+        }
+
+        gf_log (this->name, GF_LOG_WARNING,
+                "(%s): failed to get fd ctx. EBADFD",
+                uuid_utoa (cargs->req[i].fd->inode->gfid));
+
+        return -1;
+}
+
+
+int32_t
+client3_1_compound (call_frame_t *frame, xlator_t *this,
+                    void *data)
+{
+        clnt_args_t          *args     = NULL;
+        clnt_conf_t          *conf     = NULL;
+        clnt_local_t         *local    = NULL;
+        compound_args_t      *cargs    = NULL;
+        compound_req_t       *creq     = NULL;
+        gfs3_compound_req     req      = {{0,},};
+        gfs3_compound_req_op *op       = NULL;
+        char                 *flat[GF_COMPOUND_MAX_FOPS] = {0,};
+        size_t                dict_len = 0;
+        int                   op_errno = ESTALE;
+        int                   ret      = 0;
+        int                   i        = 0;
+
+        if (!frame || !this || !data)
+                goto unwind;
+
+        args  = data;
+        conf  = this->private;
+        cargs = args->compound;
+
+        if (!cargs || (cargs->count <= 0)
+            || (cargs->count > GF_COMPOUND_MAX_FOPS)) {
+                op_errno = EINVAL;
+                goto unwind;
+        }
+
+        req.ops.ops_val = GF_CALLOC (cargs->count, sizeof (*op),
+                                     gf_client_mt_compound_ops_t);
+        if (!req.ops.ops_val) {
+                op_errno = ENOMEM;
+                goto unwind;
+        }
+        req.ops.ops_len = cargs->count;
+
+        for (i = 0; i < cargs->count; i++) {
+                creq = &cargs->req[i];
+                op   = &req.ops.ops_val[i];
+                dict_len = 0;
+                op_errno = EINVAL;
+
+                switch (creq->fop) {
+                case GF_FOP_LOOKUP:
+                {
+                        gfs3_lookup_req *r = &op->gfs3_compound_req_op_u.lookup_req;
+
+                        op->fop = GFS3_COMPOUND_LOOKUP;
+                        if (!creq->loc.inode)
+                                goto unwind;
+
+                        if (creq->loc.parent) {
+                                if (!uuid_is_null (creq->loc.parent->gfid))
+                                        memcpy (r->pargfid,
+                                                creq->loc.parent->gfid, 16);
+                                else
+                                        memcpy (r->pargfid,
+                                                creq->loc.pargfid, 16);
+                        } else {
+                                if (!uuid_is_null (creq->loc.inode->gfid))
+                                        memcpy (r->gfid,
+                                                creq->loc.inode->gfid, 16);
+                                else
+                                        memcpy (r->gfid, creq->loc.gfid, 16);
+                        }
+
+                        if (creq->xattr) {
+                                ret = dict_allocate_and_serialize (
+                                        creq->xattr, &r->dict.dict_val,
+                                        &dict_len);
+                                if (ret < 0) {
+                                        gf_log (this->name, GF_LOG_WARNING,
+                                                "failed to get serialized "
+                                                "length of dict");
+                                        goto unwind;
+                                }
+                        }
+                        r->dict.dict_len = dict_len;
+                        r->path  = (char *)creq->loc.path;
+                        r->bname = (char *)creq->loc.name;
+                        break;
+                }
+
+                case GF_FOP_OPEN:
+                {
+                        gfs3_open_req *r = &op->gfs3_compound_req_op_u.open_req;
+
+                        op->fop = GFS3_COMPOUND_OPEN;
+                        if (creq->loc.inode
+                            && !uuid_is_null (creq->loc.inode->gfid))
+                                memcpy (r->gfid, creq->loc.inode->gfid, 16);
+                        else
+                                memcpy (r->gfid, creq->loc.gfid, 16);
+
+                        /* a null gfid stands for the inode looked up or
+                           created just before */
+                        if (uuid_is_null (*((uuid_t *)r->gfid))
+                            && (compound_linked_inode (cargs, i) < 0))
+                                goto unwind;
+
+                        r->flags   = gf_flags_from_flags (creq->flags);
+                        r->wbflags = creq->wbflags;
+                        r->path    = (char *)creq->loc.path;
+                        break;
+                }
+
+                case GF_FOP_CREATE:
+                {
+                        gfs3_create_req *r = &op->gfs3_compound_req_op_u.create_req;
+
+                        op->fop = GFS3_COMPOUND_CREATE;
+                        if (!creq->loc.parent)
+                                goto unwind;
+
+                        if (!uuid_is_null (creq->loc.parent->gfid))
+                                memcpy (r->pargfid, creq->loc.parent->gfid, 16);
+                        else
+                                memcpy (r->pargfid, creq->loc.pargfid, 16);
+
+                        if (uuid_is_null (*((uuid_t *)r->pargfid)))
+                                goto unwind;
+
+                        if (creq->xattr) {
+                                ret = dict_allocate_and_serialize (
+                                        creq->xattr, &r->dict.dict_val,
+                                        &dict_len);
+                                if (ret < 0) {
+                                        gf_log (this->name, GF_LOG_WARNING,
+                                                "failed to get serialized "
+                                                "length of dict");
+                                        goto unwind;
+                                }
+                        }
+                        r->dict.dict_len = dict_len;
+                        r->path  = (char *)creq->loc.path;
+                        r->bname = (char *)creq->loc.name;
+                        r->mode  = creq->mode;
+                        r->flags = gf_flags_from_flags (creq->flags);
+                        break;
+                }
+
+                case GF_FOP_READ:
+                {
+                        gfs3_read_req *r = &op->gfs3_compound_req_op_u.read_req;
+
+                        op->fop = GFS3_COMPOUND_READ;
+                        op_errno = EBADFD;
+                        if (client3_1_compound_remote_fd (this, cargs, i,
+                                                          &r->fd))
+                                goto unwind;
+
+                        r->size   = creq->size;
+                        r->offset = creq->offset;
+                        break;
+                }
+
+                case GF_FOP_WRITE:
+                {
+                        gfs3_compound_write_req *r =
+                                &op->gfs3_compound_req_op_u.write_req;
+
+                        op->fop = GFS3_COMPOUND_WRITE;
+                        op_errno = EBADFD;
+                        if (client3_1_compound_remote_fd (this, cargs, i,
+                                                          &r->req.fd))
+                                goto unwind;
+
+                        r->req.size   = creq->size;
+                        r->req.offset = creq->offset;
+
+                        /* the payload travels inline, as one opaque */
+                        if (creq->count == 1) {
+                                r->data.data_val = creq->vector[0].iov_base;
+                        } else if (creq->size) {
+                                flat[i] = GF_MALLOC (creq->size,
+                                                     gf_client_mt_clnt_req_buf_t);
+                                if (!flat[i]) {
+                                        op_errno = ENOMEM;
+                                        goto unwind;
+                                }
+                                iov_unload (flat[i], creq->vector,
+                                            creq->count);
+                                r->data.data_val = flat[i];
+                        }
+                        r->data.data_len = creq->size;
+                        break;
+                }
+
+                case GF_FOP_FLUSH:
+                {
+                        gfs3_flush_req *r = &op->gfs3_compound_req_op_u.flush_req;
+
+                        op->fop = GFS3_COMPOUND_FLUSH;
+                        op_errno = EBADFD;
+                        if (client3_1_compound_remote_fd (this, cargs, i,
+                                                          &r->fd))
+                                goto unwind;
+                        break;
+                }
+
+                default:
+                        gf_log (this->name, GF_LOG_WARNING,
+                                "%s is not supported in a compound fop",
+                                gf_fop_list[creq->fop]);
+                        op_errno = ENOTSUP;
+                        goto unwind;
+                }
+        }
+
+        local = GF_CALLOC (1, sizeof (*local), gf_client_mt_clnt_local_t);
+        if (!local) {
+                op_errno = ENOMEM;
+                goto unwind;
+        }
+        local->compound = cargs;
+        frame->local = local;
+
+        ret = client_submit_request (this, &req, frame, conf->fops,
+                                     GFS3_OP_COMPOUND, client3_1_compound_cbk,
+                                     NULL, NULL, 0, NULL, 0, NULL,
+                                     (xdrproc_t)xdr_gfs3_compound_req);
+        if (ret) {
+                op_errno = ENOTCONN;
+                goto unwind;
+        }
+
+        client3_1_compound_req_free (&req, flat);
+        return 0;
+unwind:
+        gf_log (this->name, GF_LOG_WARNING, "failed to send the fop: %s",
+                strerror (op_errno));
+        if (frame)
+                frame->local = NULL;
+
+        if (cargs)
+                compound_args_fail (cargs, 0, op_errno);
+        STACK_UNWIND_STRICT (compound, frame, -1, op_errno, cargs);
+
+        client_local_wipe (local);
+        client3_1_compound_req_free (&req, flat);
+        return 0;
+}
+
+int32_t
+client3_1_bulkstat (call_frame_t *frame, xlator_t *this,
+                    void *data)
+{
+        clnt_conf_t         *conf     = NULL;
+        clnt_args_t         *args     = NULL;
+        gfs3_bulkstat_req    req      = {{0,},};
+        gfs3_bulkstat_entry *entry    = NULL;
+        loc_t               *loc      = NULL;
+        int                  ret      = 0;
+        int                  op_errno = ESTALE;
+        int32_t              i        = 0;
+
+        if (!frame || !this || !data)
+                goto unwind;
+
+        args = data;
+        if (!args->loc || (args->count <= 0)
+            || (args->count > GF_BULKSTAT_MAX_COUNT)) {
+                op_errno = EINVAL;
+                goto unwind;
+        }
+
+        req.entries.entries_val = GF_CALLOC (args->count, sizeof (*entry),
+                                             gf_client_mt_bulkstat_entry_t);
+        if (!req.entries.entries_val) {
+                op_errno = ENOMEM;
+                goto unwind;
+        }
+        req.entries.entries_len = args->count;
+
+        for (i = 0; i < args->count; i++) {
+                loc = &args->loc[i];
+                entry = &req.entries.entries_val[i];
+
+                if (loc->inode && !uuid_is_null (loc->inode->gfid))
+                        memcpy (entry->gfid, loc->inode->gfid, 16);
+                else
+                        memcpy (entry->gfid, loc->gfid, 16);
+
+                GF_ASSERT_AND_GOTO_WITH_ERROR (this->name,
+                                               !uuid_is_null (*((uuid_t*)entry->gfid)),
+                                               unwind, op_errno, EINVAL);
+                entry->path = (char *)(loc->path ? loc->path : "");
+        }
+
+        conf = this->private;
+
+        ret = client_submit_request (this, &req, frame, conf->fops,
+                                     GFS3_OP_BULKSTAT, client3_1_bulkstat_cbk,
+                                     NULL, NULL, 0, NULL, 0, NULL,
+                                     (xdrproc_t)xdr_gfs3_bulkstat_req);
+        if (ret) {
+                op_errno = ENOTCONN;
+                goto unwind;
+        }
+
+        GF_FREE (req.entries.entries_val);
+
+        return 0;
+unwind:
+        gf_log (this->name, GF_LOG_WARNING, "failed to send the fop %s",
+                strerror (op_errno));
+        STACK_UNWIND_STRICT (bulkstat, frame, -1, op_errno, NULL, NULL);
+
+        if (req.entries.entries_val)
+                GF_FREE (req.entries.entries_val);
+
+        return 0;
+}
+
+
 /* Table Specific to FOPS */
 
 
@@ -5277,6 +6392,12 @@ rpc_clnt_procedure_t clnt3_1_fop_actors[GF_FOP_MAXVALUE] = {
         [GF_FOP_RELEASE]     = { "RELEASE",     client3_1_release },
         [GF_FOP_RELEASEDIR]  = { "RELEASEDIR",  client3_1_releasedir },
         [GF_FOP_GETSPEC]     = { "GETSPEC",     client3_getspec },
+        [GF_FOP_COMPOUND]    = { "COMPOUND",    client3_1_compound },
+        [GF_FOP_BULKSTAT]    = { "BULKSTAT",    client3_1_bulkstat },
+        [GF_FOP_FALLOCATE]   = { "FALLOCATE",   client3_1_fallocate },
+        [GF_FOP_DISCARD]     = { "DISCARD",     client3_1_discard },
+        [GF_FOP_ZEROFILL]    = { "ZEROFILL",    client3_1_zerofill },
+        [GF_FOP_SEEK]        = { "SEEK",        client3_1_seek },
 };
 
 /* Used From RPC-CLNT library to log proper name of procedure based on number */
@@ -5324,6 +6445,12 @@ char *clnt3_1_fop_names[GFS3_OP_MAXVALUE] = {
         [GFS3_OP_READDIRP]    = "READDIRP",
         [GFS3_OP_RELEASE]     = "RELEASE",
         [GFS3_OP_RELEASEDIR]  = "RELEASEDIR",
+        [GFS3_OP_COMPOUND]    = "COMPOUND",
+        [GFS3_OP_BULKSTAT]    = "BULKSTAT",
+        [GFS3_OP_FALLOCATE]   = "FALLOCATE",
+        [GFS3_OP_DISCARD]     = "DISCARD",
+        [GFS3_OP_ZEROFILL]    = "ZEROFILL",
+        [GFS3_OP_SEEK]        = "SEEK",
 };
 
 rpc_clnt_prog_t clnt3_1_fop_prog = {
@@ -24,6 +24,7 @@
 
 #include "server.h"
 #include "server-helpers.h"
+#include "bulkstat.h"
 
 #include <fnmatch.h>
 
@@ -94,6 +95,36 @@ server_resolve_wipe (server_resolve_t *resolve)
 }
 
 
+void
+server_compound_free (server_compound_t *compound)
+{
+        gfs3_compound_rsp_op *op = NULL;
+        u_int                 i  = 0;
+
+        if (compound->rsp.ops.ops_val) {
+                for (i = 0; i < compound->args.ops.ops_len; i++) {
+                        op = &compound->rsp.ops.ops_val[i];
+
+                        if (op->fop == GFS3_COMPOUND_LOOKUP)
+                                GF_FREE (op->gfs3_compound_rsp_op_u.lookup_rsp.dict.dict_val);
+                        if (op->fop == GFS3_COMPOUND_READ)
+                                GF_FREE (op->gfs3_compound_rsp_op_u.read_rsp.data.data_val);
+                }
+                GF_FREE (compound->rsp.ops.ops_val);
+        }
+
+        /* memory allocated by libc, don't use GF_FREE */
+        xdr_free ((xdrproc_t)xdr_gfs3_compound_req, (char *)&compound->args);
+
+        if (compound->inode)
+                inode_unref (compound->inode);
+        if (compound->fd)
+                fd_unref (compound->fd);
+
+        GF_FREE (compound);
+}
+
+
 void
 free_state (server_state_t *state)
 {
@@ -143,6 +174,12 @@ free_state (server_state_t *state)
         server_resolve_wipe (&state->resolve);
         server_resolve_wipe (&state->resolve2);
 
+        if (state->compound)
+                server_compound_free (state->compound);
+
+        if (state->bulk_locs)
+                bulkstat_locs_wipe (state->bulk_locs, state->bulk_count);
+
         GF_FREE (state);
 }
 
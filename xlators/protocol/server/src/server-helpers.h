@@ -47,6 +47,10 @@ void free_state (server_state_t *state);
 
 void server_loc_wipe (loc_t *loc);
 
+void server_resolve_wipe (server_resolve_t *resolve);
+
+void server_compound_free (server_compound_t *compound);
+
 int32_t
 gf_add_locker (struct _lock_table *table, const char *volume,
                loc_t *loc,
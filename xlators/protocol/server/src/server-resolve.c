@@ -100,6 +100,26 @@ out:
 }
 
 
+/* inodes linked by gfid resolution carry no dentry, and inode_path ()
+   can not build a path for them */
+static int
+resolve_inode_named (inode_t *inode)
+{
+        inode_t  *parent = NULL;
+
+        if (inode == inode->table->root)
+                return 1;
+
+        parent = inode_parent (inode, 0, NULL);
+        if (!parent)
+                return 0;
+
+        inode_unref (parent);
+
+        return 1;
+}
+
+
 int
 resolve_loc_touchup (call_frame_t *frame)
 {
@@ -116,9 +136,12 @@ resolve_loc_touchup (call_frame_t *frame)
 
         if (!loc->path) {
                 if (loc->parent && resolve->bname) {
-                        ret = inode_path (loc->parent, resolve->bname, &path);
+                        if (resolve_inode_named (loc->parent))
+                                ret = inode_path (loc->parent, resolve->bname,
+                                                  &path);
                 } else if (loc->inode) {
-                        ret = inode_path (loc->inode, NULL, &path);
+                        if (resolve_inode_named (loc->inode))
+                                ret = inode_path (loc->inode, NULL, &path);
                 }
                 if (ret)
                         gf_log (frame->this->name, GF_LOG_TRACE,
@@ -272,6 +295,209 @@ resolve_path_deep (call_frame_t *frame)
 }
 
 
+/*
+  gfid based resolution: when the parent (for entry fops) or the inode
+  itself is not in the inode table, look it up directly and link it
+  without a dentry, instead of walking the path one component at a time.
+  Resolving an entry then costs at most two lookups whatever the depth of
+  the path. The backend has no index by gfid, so the lookup carries the
+  path sent by the client, and the gfid of the reply has to match the one
+  the client asked for. Only requests carrying neither a gfid nor a parent
+  gfid are resolved by path from the start. The others fall back to
+  resolve_path_deep () once the gfid lookup has failed or has found
+  another gfid.
+*/
+
+int
+resolve_gfid_cbk (call_frame_t *frame, void *cookie, xlator_t *this,
+                  int op_ret, int op_errno, inode_t *inode, struct iatt *buf,
+                  dict_t *xattr, struct iatt *postparent)
+{
+        server_state_t       *state = NULL;
+        server_resolve_t     *resolve = NULL;
+        inode_t              *link_inode = NULL;
+
+        state = CALL_STATE (frame);
+        resolve = state->resolve_now;
+
+        if (op_ret == -1) {
+                gf_log (this->name, ((op_errno == ENOENT) ? GF_LOG_DEBUG :
+                                     GF_LOG_WARNING),
+                        "%s: failed to resolve (%s)",
+                        resolve->deep_loc.path, strerror (op_errno));
+                goto out;
+        }
+
+        if (uuid_is_null (resolve->pargfid)
+            && uuid_compare (buf->ia_gfid, resolve->gfid)) {
+                gf_log (this->name, GF_LOG_DEBUG,
+                        "%s: gfid changed (%s), resolving by path",
+                        resolve->deep_loc.path, uuid_utoa (buf->ia_gfid));
+                loc_wipe (&resolve->deep_loc);
+                resolve_path_deep (frame);
+                return 0;
+        }
+
+        link_inode = inode_link (inode, resolve->deep_loc.parent,
+                                 resolve->deep_loc.name, buf);
+        if (link_inode) {
+                inode_lookup (link_inode);
+                inode_unref (link_inode);
+        }
+
+out:
+        loc_wipe (&resolve->deep_loc);
+
+        resolve_deep_continue (frame);
+        return 0;
+}
+
+
+int
+resolve_gfid_entry (call_frame_t *frame, inode_t *parent)
+{
+        server_state_t       *state = NULL;
+        server_resolve_t     *resolve = NULL;
+        int                   ret = 0;
+
+        state = CALL_STATE (frame);
+        resolve = state->resolve_now;
+
+        if (resolve->type == RESOLVE_DONTCARE) {
+                /* the fop itself looks the entry up */
+                resolve_deep_continue (frame);
+                return 0;
+        }
+
+        if (resolve_inode_named (parent))
+                ret = inode_path (parent, resolve->bname,
+                                  (char **)&resolve->deep_loc.path);
+        if (ret <= 0)
+                resolve->deep_loc.path = gf_strdup (resolve->path);
+
+        resolve->deep_loc.parent = inode_ref (parent);
+        resolve->deep_loc.inode  = inode_new (state->itable);
+        resolve->deep_loc.name   = resolve->bname;
+        uuid_copy (resolve->deep_loc.pargfid, parent->gfid);
+
+        STACK_WIND (frame, resolve_gfid_cbk,
+                    BOUND_XL (frame), BOUND_XL (frame)->fops->lookup,
+                    &resolve->deep_loc, NULL);
+        return 0;
+}
+
+
+int
+resolve_gfid_parent_cbk (call_frame_t *frame, void *cookie, xlator_t *this,
+                         int op_ret, int op_errno, inode_t *inode,
+                         struct iatt *buf, dict_t *xattr,
+                         struct iatt *postparent)
+{
+        server_state_t       *state = NULL;
+        server_resolve_t     *resolve = NULL;
+        inode_t              *link_inode = NULL;
+
+        state = CALL_STATE (frame);
+        resolve = state->resolve_now;
+
+        if ((op_ret == -1) || uuid_compare (buf->ia_gfid, resolve->pargfid)) {
+                gf_log (this->name, GF_LOG_DEBUG,
+                        "%s: parent not found by gfid (%s), resolving by path",
+                        resolve->path, (op_ret == -1) ? strerror (op_errno) :
+                        "gfid changed");
+                loc_wipe (&resolve->deep_loc);
+                resolve_path_deep (frame);
+                return 0;
+        }
+
+        link_inode = inode_link (inode, NULL, NULL, buf);
+
+        loc_wipe (&resolve->deep_loc);
+
+        if (!link_inode) {
+                resolve_deep_continue (frame);
+                return 0;
+        }
+
+        inode_lookup (link_inode);
+
+        resolve_gfid_entry (frame, link_inode);
+
+        inode_unref (link_inode);
+
+        return 0;
+}
+
+
+int
+resolve_gfid (call_frame_t *frame)
+{
+        server_state_t       *state = NULL;
+        server_resolve_t     *resolve = NULL;
+        inode_t              *parent = NULL;
+        char                 *path = NULL;
+        char                 *trav = NULL;
+
+        state = CALL_STATE (frame);
+        resolve = state->resolve_now;
+
+        if (!(frame->root->state && BOUND_XL (frame)) || !resolve->path) {
+                resolve_deep_continue (frame);
+                return 0;
+        }
+
+        if (uuid_is_null (resolve->pargfid)) {
+                /* inode fop: the inode itself, by gfid */
+                resolve->deep_loc.path  = gf_strdup (resolve->path);
+                resolve->deep_loc.inode = inode_new (state->itable);
+                uuid_copy (resolve->deep_loc.gfid, resolve->gfid);
+
+                STACK_WIND (frame, resolve_gfid_cbk,
+                            BOUND_XL (frame), BOUND_XL (frame)->fops->lookup,
+                            &resolve->deep_loc, NULL);
+                return 0;
+        }
+
+        if (!resolve->bname) {
+                resolve_path_deep (frame);
+                return 0;
+        }
+
+        parent = inode_find (state->itable, resolve->pargfid);
+        if (parent) {
+                /* only the entry is missing */
+                resolve_gfid_entry (frame, parent);
+                inode_unref (parent);
+                return 0;
+        }
+
+        path = gf_strdup (resolve->path);
+        if (path)
+                trav = strrchr (path, '/');
+        if (!trav || (trav == path)) {
+                /* the parent is root, which is never missing */
+                if (path)
+                        GF_FREE (path);
+                resolve_path_deep (frame);
+                return 0;
+        }
+        *trav = '\0';
+
+        gf_log (BOUND_XL (frame)->name, GF_LOG_DEBUG,
+                "RESOLVE %s() seeking gfid resolution of %s",
+                gf_fop_list[frame->root->op], resolve->path);
+
+        resolve->deep_loc.path  = path;
+        resolve->deep_loc.inode = inode_new (state->itable);
+        uuid_copy (resolve->deep_loc.gfid, resolve->pargfid);
+
+        STACK_WIND (frame, resolve_gfid_parent_cbk,
+                    BOUND_XL (frame), BOUND_XL (frame)->fops->lookup,
+                    &resolve->deep_loc, NULL);
+        return 0;
+}
+
+
 int
 resolve_path_simple (call_frame_t *frame)
 {
@@ -441,7 +667,7 @@ server_resolve_entry (call_frame_t *frame)
 
         if (ret > 0) {
                 loc_wipe (loc);
-                resolve_path_deep (frame);
+                resolve_gfid (frame);
                 return 0;
         }
 
@@ -500,7 +726,7 @@ server_resolve_inode (call_frame_t *frame)
 
         if (ret > 0) {
                 loc_wipe (loc);
-                resolve_path_deep (frame);
+                resolve_gfid (frame);
                 return 0;
         }
 
@@ -244,6 +244,9 @@ server_priv (xlator_t *this)
         gf_proc_dump_build_key(key, "server", "total-bytes-write");
         gf_proc_dump_write(key, "%"PRIu64, total_write);
 
+        if (conf->rpc)
+                rpcsvc_fairq_dump (conf->rpc);
+
         ret = 0;
 out:
         return ret;
@@ -581,6 +584,7 @@ reconfigure (xlator_t *this, dict_t *options)
         }
 
         (void) rpcsvc_set_allow_insecure (rpc_conf, options);
+        (void) rpcsvc_set_fairq (rpc_conf, options);
         list_for_each_entry (listeners, &(rpc_conf->listeners), list) {
                 if (listeners->trans != NULL) {
                         if (listeners->trans->reconfigure )
@@ -854,6 +858,30 @@ struct volume_options options[] = {
         { .key   = {"rpc-auth-allow-insecure"},
           .type  = GF_OPTION_TYPE_BOOL,
         },
+        { .key   = {"rpc.fair-queue"},
+          .type  = GF_OPTION_TYPE_BOOL,
+          .description = "Serve the requests of the clients in deficit "
+                         "round robin order instead of arrival order."
+        },
+        { .key   = {"rpc.fair-queue-inflight"},
+          .type  = GF_OPTION_TYPE_INT,
+          .min   = 1,
+          .max   = 65536,
+          .description = "Number of requests handed to the bricks at a "
+                         "time when fair queuing is on."
+        },
+        { .key   = {"rpc.fair-queue-quantum"},
+          .type  = GF_OPTION_TYPE_SIZET,
+          .description = "Bytes a client of weight 1 may send per round."
+        },
+        { .key   = {"rpc.client-weight",
+                    "rpc.client-iops-limit",
+                    "rpc.client-bw-limit"},
+          .type  = GF_OPTION_TYPE_STR,
+          .description = "Comma separated list of <address-pattern>:<value> "
+                         "giving the weight, IOPS or bytes per second limit "
+                         "of the matching clients."
+        },
         { .key           = {"statedump-path"},
           .type          = GF_OPTION_TYPE_PATH,
           .default_value = "/tmp"
@@ -133,6 +133,15 @@ typedef struct {
 
 typedef int (*server_resume_fn_t) (call_frame_t *frame, xlator_t *bound_xl);
 
+/* compound fop in progress, see server_compound () */
+typedef struct {
+        gfs3_compound_req  args;
+        gfs3_compound_rsp  rsp;
+        u_int              index;     /* sub-fop being executed */
+        inode_t           *inode;     /* last looked up or created */
+        fd_t              *fd;        /* last opened or created */
+} server_compound_t;
+
 int
 resolve_and_resume (call_frame_t *frame, server_resume_fn_t fn);
 
@@ -171,6 +180,7 @@ struct _server_state {
         size_t            nr_count;
         int               cmd;
         int               type;
+        gf_seek_what_t    what;
         char             *name;
         int               name_len;
 
@@ -180,6 +190,9 @@ struct _server_state {
         struct gf_flock      flock;
         const char       *volume;
         dir_entry_t      *entry;
+        server_compound_t *compound;
+        loc_t            *bulk_locs;
+        int32_t           bulk_count;
 };
 
 extern struct rpcsvc_program gluster_handshake_prog;
@@ -26,8 +26,11 @@
 #include "server.h"
 #include "server-helpers.h"
 #include "glusterfs3-xdr.h"
+#include "glusterfs3-xdr-fast.h"
 #include "glusterfs3.h"
 #include "compat-errno.h"
+#include "compound.h"
+#include "bulkstat.h"
 
 #include "md5.h"
 #include "xdr-nfs3.h"
@@ -170,7 +173,7 @@ out:
         }
 
         server_submit_reply (frame, req, &rsp, NULL, 0, NULL,
-                             (xdrproc_t)xdr_gfs3_lookup_rsp);
+                             (xdrproc_t)xdr_fast_gfs3_lookup_rsp);
 
         if (rsp.dict.dict_val)
                 GF_FREE (rsp.dict.dict_val);
@@ -597,7 +600,7 @@ unwind:
         rsp.op_errno  = gf_errno_to_error (op_errno);
 
         server_submit_reply (frame, req, &rsp, NULL, 0, NULL,
-                             (xdrproc_t)xdr_gfs3_readdir_rsp);
+                             (xdrproc_t)xdr_fast_gfs3_readdir_rsp);
 
         readdir_rsp_cleanup (&rsp);
 
@@ -1112,7 +1115,7 @@ server_fstat_cbk (call_frame_t *frame, void *cookie, xlator_t *this,
         }
 
         server_submit_reply (frame, req, &rsp, NULL, 0, NULL,
-                             (xdrproc_t)xdr_gfs3_fstat_rsp);
+                             (xdrproc_t)xdr_fast_gfs3_fstat_rsp);
 
         return 0;
 }
@@ -1150,6 +1153,136 @@ server_ftruncate_cbk (call_frame_t *frame, void *cookie, xlator_t *this,
         return 0;
 }
 
+int
+server_fallocate_cbk (call_frame_t *frame, void *cookie, xlator_t *this,
+                      int32_t op_ret, int32_t op_errno, struct iatt *statpre,
+                      struct iatt *statpost)
+{
+        gfs3_fallocate_rsp  rsp   = {0};
+        server_state_t     *state = NULL;
+        rpcsvc_request_t   *req   = NULL;
+
+        req           = frame->local;
+
+        rsp.op_ret    = op_ret;
+        rsp.op_errno  = gf_errno_to_error (op_errno);
+
+        state = CALL_STATE (frame);
+
+        if (op_ret == 0) {
+                gf_stat_from_iatt (&rsp.statpre, statpre);
+                gf_stat_from_iatt (&rsp.statpost, statpost);
+        } else {
+                gf_log (this->name, GF_LOG_INFO,
+                        "%"PRId64": FALLOCATE %"PRId64" (%s)==> %"PRId32" (%s)",
+                        frame->root->unique, state->resolve.fd_no,
+                        state->fd ? uuid_utoa (state->fd->inode->gfid) : "--",
+                        op_ret, strerror (op_errno));
+        }
+
+        server_submit_reply (frame, req, &rsp, NULL, 0, NULL,
+                             (xdrproc_t)xdr_gfs3_fallocate_rsp);
+
+        return 0;
+}
+
+int
+server_discard_cbk (call_frame_t *frame, void *cookie, xlator_t *this,
+                    int32_t op_ret, int32_t op_errno, struct iatt *statpre,
+                    struct iatt *statpost)
+{
+        gfs3_discard_rsp    rsp   = {0};
+        server_state_t     *state = NULL;
+        rpcsvc_request_t   *req   = NULL;
+
+        req           = frame->local;
+
+        rsp.op_ret    = op_ret;
+        rsp.op_errno  = gf_errno_to_error (op_errno);
+
+        state = CALL_STATE (frame);
+
+        if (op_ret == 0) {
+                gf_stat_from_iatt (&rsp.statpre, statpre);
+                gf_stat_from_iatt (&rsp.statpost, statpost);
+        } else {
+                gf_log (this->name, GF_LOG_INFO,
+                        "%"PRId64": DISCARD %"PRId64" (%s)==> %"PRId32" (%s)",
+                        frame->root->unique, state->resolve.fd_no,
+                        state->fd ? uuid_utoa (state->fd->inode->gfid) : "--",
+                        op_ret, strerror (op_errno));
+        }
+
+        server_submit_reply (frame, req, &rsp, NULL, 0, NULL,
+                             (xdrproc_t)xdr_gfs3_discard_rsp);
+
+        return 0;
+}
+
+int
+server_zerofill_cbk (call_frame_t *frame, void *cookie, xlator_t *this,
+                     int32_t op_ret, int32_t op_errno, struct iatt *statpre,
+                     struct iatt *statpost)
+{
+        gfs3_zerofill_rsp   rsp   = {0};
+        server_state_t     *state = NULL;
+        rpcsvc_request_t   *req   = NULL;
+
+        req           = frame->local;
+
+        rsp.op_ret    = op_ret;
+        rsp.op_errno  = gf_errno_to_error (op_errno);
+
+        state = CALL_STATE (frame);
+
+        if (op_ret == 0) {
+                gf_stat_from_iatt (&rsp.statpre, statpre);
+                gf_stat_from_iatt (&rsp.statpost, statpost);
+        } else {
+                gf_log (this->name, GF_LOG_INFO,
+                        "%"PRId64": ZEROFILL %"PRId64" (%s)==> %"PRId32" (%s)",
+                        frame->root->unique, state->resolve.fd_no,
+                        state->fd ? uuid_utoa (state->fd->inode->gfid) : "--",
+                        op_ret, strerror (op_errno));
+        }
+
+        server_submit_reply (frame, req, &rsp, NULL, 0, NULL,
+                             (xdrproc_t)xdr_gfs3_zerofill_rsp);
+
+        return 0;
+}
+
+int
+server_seek_cbk (call_frame_t *frame, void *cookie, xlator_t *this,
+                 int32_t op_ret, int32_t op_errno, off_t offset)
+{
+        gfs3_seek_rsp       rsp   = {0};
+        server_state_t     *state = NULL;
+        rpcsvc_request_t   *req   = NULL;
+
+        req           = frame->local;
+
+        rsp.op_ret    = op_ret;
+        rsp.op_errno  = gf_errno_to_error (op_errno);
+
+        state = CALL_STATE (frame);
+
+        if (op_ret == 0) {
+                rsp.offset = offset;
+        } else if (op_errno != ENXIO) {
+                gf_log (this->name, GF_LOG_INFO,
+                        "%"PRId64": SEEK %"PRId64" (%s)==> %"PRId32" (%s)",
+                        frame->root->unique, state->resolve.fd_no,
+                        state->fd ? uuid_utoa (state->fd->inode->gfid) : "--",
+                        op_ret, strerror (op_errno));
+        }
+
+        server_submit_reply (frame, req, &rsp, NULL, 0, NULL,
+                             (xdrproc_t)xdr_gfs3_seek_rsp);
+
+        return 0;
+}
+
 int
 server_flush_cbk (call_frame_t *frame, void *cookie, xlator_t *this,
                   int32_t op_ret, int32_t op_errno)
@@ -1239,7 +1372,7 @@ server_writev_cbk (call_frame_t *frame, void *cookie, xlator_t *this,
         }
 
         server_submit_reply (frame, req, &rsp, NULL, 0, NULL,
-                             (xdrproc_t)xdr_gfs3_write_rsp);
+                             (xdrproc_t)xdr_fast_gfs3_write_rsp);
 
         return 0;
 }
@@ -1273,7 +1406,7 @@ server_readv_cbk (call_frame_t *frame, void *cookie, xlator_t *this,
         }
 
         server_submit_reply (frame, req, &rsp, vector, count, iobref,
-                             (xdrproc_t)xdr_gfs3_read_rsp);
+                             (xdrproc_t)xdr_fast_gfs3_read_rsp);
 
         return 0;
 }
@@ -1492,7 +1625,7 @@ server_stat_cbk (call_frame_t *frame, void *cookie, xlator_t *this,
         }
 
         server_submit_reply (frame, req, &rsp, NULL, 0, NULL,
-                             (xdrproc_t)xdr_gfs3_stat_rsp);
+                             (xdrproc_t)xdr_fast_gfs3_stat_rsp);
 
         return 0;
 }
@@ -1748,163 +1881,592 @@ out:
         rsp.op_errno  = gf_errno_to_error (op_errno);
 
         server_submit_reply (frame, req, &rsp, NULL, 0, NULL,
-                             (xdrproc_t)xdr_gfs3_readdirp_rsp);
+                             (xdrproc_t)xdr_fast_gfs3_readdirp_rsp);
 
         readdirp_rsp_cleanup (&rsp);
 
         return 0;
 }
 
-/* Resume function section */
-
 int
-server_rchecksum_resume (call_frame_t *frame, xlator_t *bound_xl)
+server_bulkstat_cbk (call_frame_t *frame, void *cookie, xlator_t *this,
+                     int32_t op_ret, int32_t op_errno, struct iatt *bufs,
+                     int32_t *op_errnos)
 {
-        server_state_t *state    = NULL;
-        int             op_ret   = 0;
-        int             op_errno = EINVAL;
+        gfs3_bulkstat_rsp  rsp   = {0,};
+        server_state_t    *state = NULL;
+        rpcsvc_request_t  *req   = NULL;
+        int32_t            i     = 0;
 
+        req   = frame->local;
         state = CALL_STATE (frame);
 
-        if (state->resolve.op_ret != 0) {
-                op_ret   = state->resolve.op_ret;
-                op_errno = state->resolve.op_errno;
-                goto err;
+        if (op_ret < 0) {
+                gf_log (this->name, GF_LOG_INFO,
+                        "%"PRId64": BULKSTAT (%"PRId32" entries) ==> "
+                        "%"PRId32" (%s)", frame->root->unique,
+                        state->bulk_count, op_ret, strerror (op_errno));
+                goto out;
         }
 
-        STACK_WIND (frame, server_rchecksum_cbk, bound_xl,
-                    bound_xl->fops->rchecksum, state->fd,
-                    state->offset, state->size);
-
-        return 0;
-err:
-        server_rchecksum_cbk (frame, NULL, frame->this, op_ret, op_errno, 0, NULL);
-
-        return 0;
-
-}
+        if (op_ret > state->bulk_count)
+                op_ret = state->bulk_count;
 
-int
-server_lk_resume (call_frame_t *frame, xlator_t *bound_xl)
-{
-        server_state_t *state = NULL;
+        rsp.entries.entries_val = GF_CALLOC (op_ret ? op_ret : 1,
+                                             sizeof (gfs3_bulkstat_rsp_entry),
+                                             gf_server_mt_rsp_buf_t);
+        if (!rsp.entries.entries_val) {
+                op_ret   = -1;
+                op_errno = ENOMEM;
+                goto out;
+        }
+        rsp.entries.entries_len = op_ret;
 
-        state = CALL_STATE (frame);
+        for (i = 0; i < op_ret; i++) {
+                rsp.entries.entries_val[i].op_errno =
+                        gf_errno_to_error (op_errnos[i]);
+                if (op_errnos[i] == 0)
+                        gf_stat_from_iatt (&rsp.entries.entries_val[i].stat,
+                                           &bufs[i]);
+        }
 
-        if (state->resolve.op_ret != 0)
-                goto err;
+out:
+        rsp.op_ret    = op_ret;
+        rsp.op_errno  = gf_errno_to_error (op_errno);
 
-        STACK_WIND (frame, server_lk_cbk, bound_xl, bound_xl->fops->lk,
-                    state->fd, state->cmd, &state->flock);
+        server_submit_reply (frame, req, &rsp, NULL, 0, NULL,
+                             (xdrproc_t)xdr_gfs3_bulkstat_rsp);
 
-        return 0;
+        if (rsp.entries.entries_val)
+                GF_FREE (rsp.entries.entries_val);
 
-err:
-        server_lk_cbk (frame, NULL, frame->this, state->resolve.op_ret,
-                       state->resolve.op_errno, NULL);
         return 0;
 }
 
-int
-server_rename_resume (call_frame_t *frame, xlator_t *bound_xl)
+/* Compound fop: the sub-fops are executed one after the other, the reply
+   carries the outcome of those executed up to (and including) the first
+   one which failed. */
+
+static int
+server_compound_next (call_frame_t *frame);
+
+static int
+server_compound_reply (call_frame_t *frame)
 {
-        server_state_t *state = NULL;
-        int             op_ret = 0;
-        int             op_errno = 0;
+        server_state_t    *state    = NULL;
+        server_compound_t *compound = NULL;
+        rpcsvc_request_t  *req      = NULL;
 
-        state = CALL_STATE (frame);
+        state    = CALL_STATE (frame);
+        compound = state->compound;
+        req      = frame->local;
 
-        if (state->resolve.op_ret != 0) {
-                op_ret   = state->resolve.op_ret;
-                op_errno = state->resolve.op_errno;
-                goto err;
-        }
+        compound->rsp.ops.ops_len = compound->index;
 
-        if (state->resolve2.op_ret != 0) {
-                op_ret   = state->resolve2.op_ret;
-                op_errno = state->resolve2.op_errno;
-                goto err;
-        }
+        server_submit_reply (frame, req, &compound->rsp, NULL, 0, NULL,
+                             (xdrproc_t)xdr_gfs3_compound_rsp);
 
-        STACK_WIND (frame, server_rename_cbk,
-                    bound_xl, bound_xl->fops->rename,
-                    &state->loc, &state->loc2);
-        return 0;
-err:
-        server_rename_cbk (frame, NULL, frame->this, op_ret, op_errno,
-                           NULL, NULL, NULL, NULL, NULL);
         return 0;
 }
 
 
-int
-server_link_resume (call_frame_t *frame, xlator_t *bound_xl)
+static int
+server_compound_resume (call_frame_t *frame, int32_t op_ret, int32_t op_errno)
 {
-        server_state_t *state = NULL;
-        int             op_ret = 0;
-        int             op_errno = 0;
+        server_state_t    *state    = NULL;
+        server_compound_t *compound = NULL;
 
-        state = CALL_STATE (frame);
+        state    = CALL_STATE (frame);
+        compound = state->compound;
 
-        if (state->resolve.op_ret != 0) {
-                op_ret   = state->resolve.op_ret;
-                op_errno = state->resolve.op_errno;
-                goto err;
-        }
+        compound->index++;
 
-        if (state->resolve2.op_ret != 0) {
-                op_ret   = state->resolve2.op_ret;
-                op_errno = state->resolve2.op_errno;
-                goto err;
+        if (op_ret < 0) {
+                compound->rsp.op_ret   = -1;
+                compound->rsp.op_errno = gf_errno_to_error (op_errno);
+                return server_compound_reply (frame);
         }
 
-        state->loc2.inode = inode_ref (state->loc.inode);
+        return server_compound_next (frame);
+}
 
-        STACK_WIND (frame, server_link_cbk, bound_xl, bound_xl->fops->link,
-                    &state->loc, &state->loc2);
 
-        return 0;
-err:
-        server_link_cbk (frame, NULL, frame->this, op_ret, op_errno,
-                         NULL, NULL, NULL, NULL);
-        return 0;
+static void
+server_compound_link (server_compound_t *compound, inode_t *inode, fd_t *fd)
+{
+        if (inode) {
+                if (compound->inode)
+                        inode_unref (compound->inode);
+                compound->inode = inode_ref (inode);
+        }
+
+        if (fd) {
+                if (compound->fd)
+                        fd_unref (compound->fd);
+                compound->fd = fd_ref (fd);
+        }
 }
 
+
 int
-server_symlink_resume (call_frame_t *frame, xlator_t *bound_xl)
+server_compound_lookup_cbk (call_frame_t *frame, void *cookie, xlator_t *this,
+                            int32_t op_ret, int32_t op_errno,
+                            inode_t *inode, struct iatt *stbuf, dict_t *dict,
+                            struct iatt *postparent)
 {
-        server_state_t *state = NULL;
-
-        state = CALL_STATE (frame);
-
-        if (state->resolve.op_ret != 0)
-                goto err;
+        server_state_t    *state      = NULL;
+        server_compound_t *compound   = NULL;
+        gfs3_lookup_rsp   *rsp        = NULL;
+        inode_t           *root_inode = NULL;
+        inode_t           *link_inode = NULL;
+        loc_t              fresh_loc  = {0,};
+        int32_t            ret        = -1;
+        uuid_t             rootgfid   = {0,};
+
+        state    = CALL_STATE (frame);
+        compound = state->compound;
+        rsp      = &compound->rsp.ops.ops_val[compound->index].gfs3_compound_rsp_op_u.lookup_rsp;
 
-        state->loc.inode = inode_new (state->itable);
+        if (state->is_revalidate == 1 && op_ret == -1) {
+                state->is_revalidate = 2;
+                loc_copy (&fresh_loc, &state->loc);
+                inode_unref (fresh_loc.inode);
+                fresh_loc.inode = inode_new (state->itable);
 
-        STACK_WIND (frame, server_symlink_cbk,
-                    bound_xl, bound_xl->fops->symlink,
-                    state->name, &state->loc, state->params);
+                STACK_WIND (frame, server_compound_lookup_cbk,
+                            BOUND_XL (frame), BOUND_XL (frame)->fops->lookup,
+                            &fresh_loc, state->dict);
 
-        return 0;
-err:
-        server_symlink_cbk (frame, NULL, frame->this, state->resolve.op_ret,
-                            state->resolve.op_errno, NULL, NULL, NULL, NULL);
-        return 0;
-}
+                loc_wipe (&fresh_loc);
+                return 0;
+        }
 
+        if ((op_ret >= 0) && dict) {
+                rsp->dict.dict_len = dict_serialized_length (dict);
+                if (rsp->dict.dict_len < 0) {
+                        op_ret   = -1;
+                        op_errno = EINVAL;
+                        rsp->dict.dict_len = 0;
+                        goto out;
+                }
 
-int
-server_access_resume (call_frame_t *frame, xlator_t *bound_xl)
-{
-        server_state_t *state = NULL;
+                rsp->dict.dict_val = GF_CALLOC (1, rsp->dict.dict_len,
+                                                gf_server_mt_rsp_buf_t);
+                if (!rsp->dict.dict_val) {
+                        op_ret   = -1;
+                        op_errno = ENOMEM;
+                        rsp->dict.dict_len = 0;
+                        goto out;
+                }
 
-        state = CALL_STATE (frame);
+                ret = dict_serialize (dict, rsp->dict.dict_val);
+                if (ret < 0) {
+                        op_ret   = -1;
+                        op_errno = -ret;
+                        goto out;
+                }
+        }
 
-        if (state->resolve.op_ret != 0)
-                goto err;
+        gf_stat_from_iatt (&rsp->postparent, postparent);
 
-        STACK_WIND (frame, server_access_cbk,
+        if (op_ret == 0) {
+                root_inode = BOUND_XL(frame)->itable->root;
+                if (inode == root_inode) {
+                        /* we just looked up root ("/") */
+                        stbuf->ia_ino = 1;
+                        rootgfid[15]  = 1;
+                        uuid_copy (stbuf->ia_gfid, rootgfid);
+                        if (inode->ia_type == 0)
+                                inode->ia_type = stbuf->ia_type;
+                }
+
+                gf_stat_from_iatt (&rsp->stat, stbuf);
+
+                if (!__is_root_gfid (inode->gfid)) {
+                        link_inode = inode_link (inode, state->loc.parent,
+                                                 state->loc.name, stbuf);
+                        inode_lookup (link_inode);
+                        server_compound_link (compound, link_inode, NULL);
+                        inode_unref (link_inode);
+                } else {
+                        server_compound_link (compound, inode, NULL);
+                }
+        } else {
+                if (state->is_revalidate && op_errno == ENOENT) {
+                        if (!__is_root_gfid (state->loc.inode->gfid)) {
+                                inode_unlink (state->loc.inode,
+                                              state->loc.parent,
+                                              state->loc.name);
+                        }
+                }
+        }
+out:
+        rsp->op_ret   = op_ret;
+        rsp->op_errno = gf_errno_to_error (op_errno);
+
+        if ((op_ret == -1) && (op_errno != ENOENT)) {
+                gf_log (this->name, GF_LOG_INFO,
+                        "%"PRId64": COMPOUND LOOKUP %s (%s) ==> %"PRId32" (%s)",
+                        frame->root->unique, state->loc.path,
+                        state->loc.inode ? uuid_utoa (state->loc.inode->gfid) :
+                        "--", op_ret, strerror (op_errno));
+        }
+
+        return server_compound_resume (frame, op_ret, op_errno);
+}
+
+
+int
+server_compound_open_cbk (call_frame_t *frame, void *cookie, xlator_t *this,
+                          int32_t op_ret, int32_t op_errno, fd_t *fd)
+{
+        server_connection_t *conn     = NULL;
+        server_state_t      *state    = NULL;
+        server_compound_t   *compound = NULL;
+        gfs3_open_rsp       *rsp      = NULL;
+        uint64_t             fd_no    = 0;
+
+        conn     = SERVER_CONNECTION (frame);
+        state    = CALL_STATE (frame);
+        compound = state->compound;
+        rsp      = &compound->rsp.ops.ops_val[compound->index].gfs3_compound_rsp_op_u.open_rsp;
+
+        if (op_ret >= 0) {
+                fd_bind (fd);
+                fd_no = gf_fd_unused_get (conn->fdtable, fd);
+                fd_ref (fd);
+                server_compound_link (compound, NULL, fd);
+        } else {
+                gf_log (this->name, GF_LOG_INFO,
+                        "%"PRId64": COMPOUND OPEN %s (%s) ==> %"PRId32" (%s)",
+                        frame->root->unique, state->loc.path,
+                        state->loc.inode ? uuid_utoa (state->loc.inode->gfid) :
+                        "--", op_ret, strerror (op_errno));
+        }
+
+        rsp->fd       = fd_no;
+        rsp->op_ret   = op_ret;
+        rsp->op_errno = gf_errno_to_error (op_errno);
+
+        return server_compound_resume (frame, op_ret, op_errno);
+}
+
+
+int
+server_compound_create_cbk (call_frame_t *frame, void *cookie, xlator_t *this,
+                            int32_t op_ret, int32_t op_errno,
+                            fd_t *fd, inode_t *inode, struct iatt *stbuf,
+                            struct iatt *preparent, struct iatt *postparent)
+{
+        server_connection_t *conn       = NULL;
+        server_state_t      *state      = NULL;
+        server_compound_t   *compound   = NULL;
+        gfs3_create_rsp     *rsp        = NULL;
+        inode_t             *link_inode = NULL;
+        uint64_t             fd_no      = 0;
+
+        conn     = SERVER_CONNECTION (frame);
+        state    = CALL_STATE (frame);
+        compound = state->compound;
+        rsp      = &compound->rsp.ops.ops_val[compound->index].gfs3_compound_rsp_op_u.create_rsp;
+
+        if (op_ret >= 0) {
+                link_inode = inode_link (inode, state->loc.parent,
+                                         state->loc.name, stbuf);
+                if (!link_inode) {
+                        op_ret = -1;
+                        op_errno = ENOENT;
+                        goto out;
+                }
+
+                if (link_inode != inode) {
+                        /* same as server_create_cbk () */
+                        inode_unref (fd->inode);
+                        fd->inode = inode_ref (link_inode);
+                }
+
+                inode_lookup (link_inode);
+
+                fd_bind (fd);
+                fd_no = gf_fd_unused_get (conn->fdtable, fd);
+                fd_ref (fd);
+
+                server_compound_link (compound, link_inode, fd);
+                inode_unref (link_inode);
+
+                gf_stat_from_iatt (&rsp->stat, stbuf);
+                gf_stat_from_iatt (&rsp->preparent, preparent);
+                gf_stat_from_iatt (&rsp->postparent, postparent);
+        } else {
+                gf_log (this->name, GF_LOG_INFO,
+                        "%"PRId64": COMPOUND CREATE %s (%s) ==> %"PRId32" (%s)",
+                        frame->root->unique, state->loc.path,
+                        state->loc.inode ? uuid_utoa (state->loc.inode->gfid) :
+                        "--", op_ret, strerror (op_errno));
+        }
+out:
+        rsp->fd       = fd_no;
+        rsp->op_ret   = op_ret;
+        rsp->op_errno = gf_errno_to_error (op_errno);
+
+        return server_compound_resume (frame, op_ret, op_errno);
+}
+
+
+int
+server_compound_readv_cbk (call_frame_t *frame, void *cookie, xlator_t *this,
+                           int32_t op_ret, int32_t op_errno,
+                           struct iovec *vector, int32_t count,
+                           struct iatt *stbuf, struct iobref *iobref)
+{
+        server_state_t          *state    = NULL;
+        server_compound_t       *compound = NULL;
+        gfs3_compound_read_rsp  *rsp      = NULL;
+
+        state    = CALL_STATE (frame);
+        compound = state->compound;
+        rsp      = &compound->rsp.ops.ops_val[compound->index].gfs3_compound_rsp_op_u.read_rsp;
+
+        if (op_ret > 0) {
+                /* the data travels inline in the reply */
+                rsp->data.data_val = GF_MALLOC (op_ret, gf_server_mt_rsp_buf_t);
+                if (!rsp->data.data_val) {
+                        op_ret   = -1;
+                        op_errno = ENOMEM;
+                        goto out;
+                }
+                iov_unload (rsp->data.data_val, vector, count);
+                rsp->data.data_len = op_ret;
+        }
+
+        if (op_ret >= 0) {
+                gf_stat_from_iatt (&rsp->rsp.stat, stbuf);
+                rsp->rsp.size = op_ret;
+        }
+out:
+        if (op_ret < 0) {
+                gf_log (this->name, GF_LOG_INFO,
+                        "%"PRId64": COMPOUND READV (%s) ==> %"PRId32" (%s)",
+                        frame->root->unique,
+                        state->fd ? uuid_utoa (state->fd->inode->gfid) : "--",
+                        op_ret, strerror (op_errno));
+        }
+
+        rsp->rsp.op_ret   = op_ret;
+        rsp->rsp.op_errno = gf_errno_to_error (op_errno);
+
+        return server_compound_resume (frame, op_ret, op_errno);
+}
+
+
+int
+server_compound_writev_cbk (call_frame_t *frame, void *cookie, xlator_t *this,
+                            int32_t op_ret, int32_t op_errno,
+                            struct iatt *prebuf, struct iatt *postbuf)
+{
+        server_state_t    *state    = NULL;
+        server_compound_t *compound = NULL;
+        gfs3_write_rsp    *rsp      = NULL;
+
+        state    = CALL_STATE (frame);
+        compound = state->compound;
+        rsp      = &compound->rsp.ops.ops_val[compound->index].gfs3_compound_rsp_op_u.write_rsp;
+
+        if (op_ret >= 0) {
+                gf_stat_from_iatt (&rsp->prestat, prebuf);
+                gf_stat_from_iatt (&rsp->poststat, postbuf);
+        } else {
+                gf_log (this->name, GF_LOG_INFO,
+                        "%"PRId64": COMPOUND WRITEV (%s) ==> %"PRId32" (%s)",
+                        frame->root->unique,
+                        state->fd ? uuid_utoa (state->fd->inode->gfid) : "--",
+                        op_ret, strerror (op_errno));
+        }
+
+        rsp->op_ret   = op_ret;
+        rsp->op_errno = gf_errno_to_error (op_errno);
+
+        return server_compound_resume (frame, op_ret, op_errno);
+}
+
+
+int
+server_compound_flush_cbk (call_frame_t *frame, void *cookie, xlator_t *this,
+                           int32_t op_ret, int32_t op_errno)
+{
+        server_state_t    *state    = NULL;
+        server_compound_t *compound = NULL;
+        gf_common_rsp     *rsp      = NULL;
+
+        state    = CALL_STATE (frame);
+        compound = state->compound;
+        rsp      = &compound->rsp.ops.ops_val[compound->index].gfs3_compound_rsp_op_u.flush_rsp;
+
+        if (op_ret < 0) {
+                gf_log (this->name, GF_LOG_INFO,
+                        "%"PRId64": COMPOUND FLUSH (%s) ==> %"PRId32" (%s)",
+                        frame->root->unique,
+                        state->fd ? uuid_utoa (state->fd->inode->gfid) : "--",
+                        op_ret, strerror (op_errno));
+        }
+
+        rsp->op_ret   = op_ret;
+        rsp->op_errno = gf_errno_to_error (op_errno);
+
+        return server_compound_resume (frame, op_ret, op_errno);
+}
+
+
+/* Resume function section */
+
+int
+server_rchecksum_resume (call_frame_t *frame, xlator_t *bound_xl)
+{
+        server_state_t *state    = NULL;
+        int             op_ret   = 0;
+        int             op_errno = EINVAL;
+
+        state = CALL_STATE (frame);
+
+        if (state->resolve.op_ret != 0) {
+                op_ret   = state->resolve.op_ret;
+                op_errno = state->resolve.op_errno;
+                goto err;
+        }
+
+        STACK_WIND (frame, server_rchecksum_cbk, bound_xl,
+                    bound_xl->fops->rchecksum, state->fd,
+                    state->offset, state->size);
+
+        return 0;
+err:
+        server_rchecksum_cbk (frame, NULL, frame->this, op_ret, op_errno, 0, NULL);
+
+        return 0;
+
+}
+
+int
+server_lk_resume (call_frame_t *frame, xlator_t *bound_xl)
+{
+        server_state_t *state = NULL;
+
+        state = CALL_STATE (frame);
+
+        if (state->resolve.op_ret != 0)
+                goto err;
+
+        STACK_WIND (frame, server_lk_cbk, bound_xl, bound_xl->fops->lk,
+                    state->fd, state->cmd, &state->flock);
+
+        return 0;
+
+err:
+        server_lk_cbk (frame, NULL, frame->this, state->resolve.op_ret,
+                       state->resolve.op_errno, NULL);
+        return 0;
+}
+
+int
+server_rename_resume (call_frame_t *frame, xlator_t *bound_xl)
+{
+        server_state_t *state = NULL;
+        int             op_ret = 0;
+        int             op_errno = 0;
+
+        state = CALL_STATE (frame);
+
+        if (state->resolve.op_ret != 0) {
+                op_ret   = state->resolve.op_ret;
+                op_errno = state->resolve.op_errno;
+                goto err;
+        }
+
+        if (state->resolve2.op_ret != 0) {
+                op_ret   = state->resolve2.op_ret;
+                op_errno = state->resolve2.op_errno;
+                goto err;
+        }
+
+        STACK_WIND (frame, server_rename_cbk,
+                    bound_xl, bound_xl->fops->rename,
+                    &state->loc, &state->loc2);
+        return 0;
+err:
+        server_rename_cbk (frame, NULL, frame->this, op_ret, op_errno,
+                           NULL, NULL, NULL, NULL, NULL);
+        return 0;
+}
+
+
+int
+server_link_resume (call_frame_t *frame, xlator_t *bound_xl)
+{
+        server_state_t *state = NULL;
+        int             op_ret = 0;
+        int             op_errno = 0;
+
+        state = CALL_STATE (frame);
+
+        if (state->resolve.op_ret != 0) {
+                op_ret   = state->resolve.op_ret;
+                op_errno = state->resolve.op_errno;
+                goto err;
+        }
+
+        if (state->resolve2.op_ret != 0) {
+                op_ret   = state->resolve2.op_ret;
+                op_errno = state->resolve2.op_errno;
+                goto err;
+        }
+
+        state->loc2.inode = inode_ref (state->loc.inode);
+
+        STACK_WIND (frame, server_link_cbk, bound_xl, bound_xl->fops->link,
+                    &state->loc, &state->loc2);
+
+        return 0;
+err:
+        server_link_cbk (frame, NULL, frame->this, op_ret, op_errno,
+                         NULL, NULL, NULL, NULL);
+        return 0;
+}
+
+int
+server_symlink_resume (call_frame_t *frame, xlator_t *bound_xl)
+{
+        server_state_t *state = NULL;
+
+        state = CALL_STATE (frame);
+
+        if (state->resolve.op_ret != 0)
+                goto err;
+
+        state->loc.inode = inode_new (state->itable);
+
+        STACK_WIND (frame, server_symlink_cbk,
+                    bound_xl, bound_xl->fops->symlink,
+                    state->name, &state->loc, state->params);
+
+        return 0;
+err:
+        server_symlink_cbk (frame, NULL, frame->this, state->resolve.op_ret,
+                            state->resolve.op_errno, NULL, NULL, NULL, NULL);
+        return 0;
+}
+
+
+int
+server_access_resume (call_frame_t *frame, xlator_t *bound_xl)
+{
+        server_state_t *state = NULL;
+
+        state = CALL_STATE (frame);
+
+        if (state->resolve.op_ret != 0)
+                goto err;
+
+        STACK_WIND (frame, server_access_cbk,
                     bound_xl, bound_xl->fops->access,
                     &state->loc, state->mask);
         return 0;
@@ -2413,6 +2975,94 @@ err:
 }
 
 
+int
+server_fallocate_resume (call_frame_t *frame, xlator_t *bound_xl)
+{
+        server_state_t    *state = NULL;
+
+        state = CALL_STATE (frame);
+
+        if (state->resolve.op_ret != 0)
+                goto err;
+
+        STACK_WIND (frame, server_fallocate_cbk,
+                    bound_xl, bound_xl->fops->fallocate,
+                    state->fd, state->flags, state->offset, state->size);
+        return 0;
+err:
+        server_fallocate_cbk (frame, NULL, frame->this, state->resolve.op_ret,
+                              state->resolve.op_errno, NULL, NULL);
+
+        return 0;
+}
+
+
+int
+server_discard_resume (call_frame_t *frame, xlator_t *bound_xl)
+{
+        server_state_t    *state = NULL;
+
+        state = CALL_STATE (frame);
+
+        if (state->resolve.op_ret != 0)
+                goto err;
+
+        STACK_WIND (frame, server_discard_cbk,
+                    bound_xl, bound_xl->fops->discard,
+                    state->fd, state->offset, state->size);
+        return 0;
+err:
+        server_discard_cbk (frame, NULL, frame->this, state->resolve.op_ret,
+                            state->resolve.op_errno, NULL, NULL);
+
+        return 0;
+}
+
+
+int
+server_zerofill_resume (call_frame_t *frame, xlator_t *bound_xl)
+{
+        server_state_t    *state = NULL;
+
+        state = CALL_STATE (frame);
+
+        if (state->resolve.op_ret != 0)
+                goto err;
+
+        STACK_WIND (frame, server_zerofill_cbk,
+                    bound_xl, bound_xl->fops->zerofill,
+                    state->fd, state->offset, state->size);
+        return 0;
+err:
+        server_zerofill_cbk (frame, NULL, frame->this, state->resolve.op_ret,
+                             state->resolve.op_errno, NULL, NULL);
+
+        return 0;
+}
+
+
+int
+server_seek_resume (call_frame_t *frame, xlator_t *bound_xl)
+{
+        server_state_t    *state = NULL;
+
+        state = CALL_STATE (frame);
+
+        if (state->resolve.op_ret != 0)
+                goto err;
+
+        STACK_WIND (frame, server_seek_cbk,
+                    bound_xl, bound_xl->fops->seek,
+                    state->fd, state->offset, state->what);
+        return 0;
+err:
+        server_seek_cbk (frame, NULL, frame->this, state->resolve.op_ret,
+                         state->resolve.op_errno, 0);
+
+        return 0;
+}
+
+
 int
 server_flush_resume (call_frame_t *frame, xlator_t *bound_xl)
 {
@@ -2538,53 +3188,206 @@ err:
 
 
 int
-server_open_resume (call_frame_t *frame, xlator_t *bound_xl)
+server_open_resume (call_frame_t *frame, xlator_t *bound_xl)
+{
+        server_state_t  *state = NULL;
+
+        state = CALL_STATE (frame);
+
+        if (state->resolve.op_ret != 0)
+                goto err;
+
+        state->fd = fd_create (state->loc.inode, frame->root->pid);
+        state->fd->flags = state->flags;
+
+        STACK_WIND (frame, server_open_cbk,
+                    bound_xl, bound_xl->fops->open,
+                    &state->loc, state->flags, state->fd, 0);
+
+        return 0;
+err:
+        server_open_cbk (frame, NULL, frame->this, state->resolve.op_ret,
+                         state->resolve.op_errno, NULL);
+        return 0;
+}
+
+
+int
+server_readlink_resume (call_frame_t *frame, xlator_t *bound_xl)
+{
+        server_state_t *state = NULL;
+
+        state = CALL_STATE (frame);
+
+        if (state->resolve.op_ret != 0)
+                goto err;
+
+        STACK_WIND (frame, server_readlink_cbk,
+                    bound_xl, bound_xl->fops->readlink,
+                    &state->loc, state->size);
+        return 0;
+err:
+        server_readlink_cbk (frame, NULL, frame->this, state->resolve.op_ret,
+                             state->resolve.op_errno, NULL, NULL);
+        return 0;
+}
+
+
+int
+server_fsetattr_resume (call_frame_t *frame, xlator_t *bound_xl)
+{
+        server_state_t *state = NULL;
+
+        state = CALL_STATE (frame);
+
+        if (state->resolve.op_ret != 0)
+                goto err;
+
+        STACK_WIND (frame, server_fsetattr_cbk,
+                    bound_xl, bound_xl->fops->fsetattr,
+                    state->fd, &state->stbuf, state->valid);
+        return 0;
+err:
+        server_fsetattr_cbk (frame, NULL, frame->this, state->resolve.op_ret,
+                             state->resolve.op_errno, NULL, NULL);
+
+        return 0;
+}
+
+
+int
+server_setattr_resume (call_frame_t *frame, xlator_t *bound_xl)
+{
+        server_state_t *state = NULL;
+
+        state = CALL_STATE (frame);
+
+        if (state->resolve.op_ret != 0)
+                goto err;
+
+        STACK_WIND (frame, server_setattr_cbk,
+                    bound_xl, bound_xl->fops->setattr,
+                    &state->loc, &state->stbuf, state->valid);
+        return 0;
+err:
+        server_setattr_cbk (frame, NULL, frame->this, state->resolve.op_ret,
+                            state->resolve.op_errno, NULL, NULL);
+
+        return 0;
+}
+
+
+int
+server_stat_resume (call_frame_t *frame, xlator_t *bound_xl)
+{
+        server_state_t *state = NULL;
+
+        state = CALL_STATE (frame);
+
+        if (state->resolve.op_ret != 0)
+                goto err;
+
+        STACK_WIND (frame, server_stat_cbk,
+                    bound_xl, bound_xl->fops->stat, &state->loc);
+        return 0;
+err:
+        server_stat_cbk (frame, NULL, frame->this, state->resolve.op_ret,
+                         state->resolve.op_errno, NULL);
+        return 0;
+}
+
+int
+server_lookup_resume (call_frame_t *frame, xlator_t *bound_xl)
+{
+        server_state_t    *state = NULL;
+
+        state = CALL_STATE (frame);
+
+        if (state->resolve.op_ret != 0)
+                goto err;
+
+        if (!state->loc.inode)
+                state->loc.inode = inode_new (state->itable);
+        else
+                state->is_revalidate = 1;
+
+        STACK_WIND (frame, server_lookup_cbk,
+                    bound_xl, bound_xl->fops->lookup,
+                    &state->loc, state->dict);
+
+        return 0;
+err:
+        server_lookup_cbk (frame, NULL, frame->this, state->resolve.op_ret,
+                           state->resolve.op_errno, NULL, NULL, NULL, NULL);
+
+        return 0;
+}
+
+
+
+
+int
+server_compound_lookup_resume (call_frame_t *frame, xlator_t *bound_xl)
 {
-        server_state_t  *state = NULL;
+        server_state_t    *state = NULL;
 
         state = CALL_STATE (frame);
 
         if (state->resolve.op_ret != 0)
                 goto err;
 
-        state->fd = fd_create (state->loc.inode, frame->root->pid);
-        state->fd->flags = state->flags;
+        if (!state->loc.inode)
+                state->loc.inode = inode_new (state->itable);
+        else
+                state->is_revalidate = 1;
 
-        STACK_WIND (frame, server_open_cbk,
-                    bound_xl, bound_xl->fops->open,
-                    &state->loc, state->flags, state->fd, 0);
+        STACK_WIND (frame, server_compound_lookup_cbk,
+                    bound_xl, bound_xl->fops->lookup,
+                    &state->loc, state->dict);
 
         return 0;
 err:
-        server_open_cbk (frame, NULL, frame->this, state->resolve.op_ret,
-                         state->resolve.op_errno, NULL);
+        server_compound_lookup_cbk (frame, NULL, frame->this,
+                                    state->resolve.op_ret,
+                                    state->resolve.op_errno, NULL, NULL, NULL,
+                                    NULL);
         return 0;
 }
 
 
 int
-server_readlink_resume (call_frame_t *frame, xlator_t *bound_xl)
+server_compound_open_resume (call_frame_t *frame, xlator_t *bound_xl)
 {
-        server_state_t *state = NULL;
+        server_state_t  *state = NULL;
 
         state = CALL_STATE (frame);
 
         if (state->resolve.op_ret != 0)
                 goto err;
 
-        STACK_WIND (frame, server_readlink_cbk,
-                    bound_xl, bound_xl->fops->readlink,
-                    &state->loc, state->size);
+        state->fd = fd_create (state->loc.inode, frame->root->pid);
+        if (!state->fd) {
+                state->resolve.op_ret   = -1;
+                state->resolve.op_errno = ENOMEM;
+                goto err;
+        }
+        state->fd->flags = state->flags;
+
+        STACK_WIND (frame, server_compound_open_cbk,
+                    bound_xl, bound_xl->fops->open,
+                    &state->loc, state->flags, state->fd, state->wbflags);
+
         return 0;
 err:
-        server_readlink_cbk (frame, NULL, frame->this, state->resolve.op_ret,
-                             state->resolve.op_errno, NULL, NULL);
+        server_compound_open_cbk (frame, NULL, frame->this,
+                                  state->resolve.op_ret,
+                                  state->resolve.op_errno, NULL);
         return 0;
 }
 
 
 int
-server_fsetattr_resume (call_frame_t *frame, xlator_t *bound_xl)
+server_compound_create_resume (call_frame_t *frame, xlator_t *bound_xl)
 {
         server_state_t *state = NULL;
 
@@ -2593,61 +3396,81 @@ server_fsetattr_resume (call_frame_t *frame, xlator_t *bound_xl)
         if (state->resolve.op_ret != 0)
                 goto err;
 
-        STACK_WIND (frame, server_fsetattr_cbk,
-                    bound_xl, bound_xl->fops->fsetattr,
-                    state->fd, &state->stbuf, state->valid);
+        state->loc.inode = inode_new (state->itable);
+
+        state->fd = fd_create (state->loc.inode, frame->root->pid);
+        if (!state->fd) {
+                state->resolve.op_ret   = -1;
+                state->resolve.op_errno = ENOMEM;
+                goto err;
+        }
+        state->fd->flags = state->flags;
+
+        STACK_WIND (frame, server_compound_create_cbk,
+                    bound_xl, bound_xl->fops->create,
+                    &(state->loc), state->flags, state->mode,
+                    state->fd, state->params);
+
         return 0;
 err:
-        server_fsetattr_cbk (frame, NULL, frame->this, state->resolve.op_ret,
-                             state->resolve.op_errno, NULL, NULL);
-
+        server_compound_create_cbk (frame, NULL, frame->this,
+                                    state->resolve.op_ret,
+                                    state->resolve.op_errno, NULL, NULL, NULL,
+                                    NULL, NULL);
         return 0;
 }
 
 
 int
-server_setattr_resume (call_frame_t *frame, xlator_t *bound_xl)
+server_compound_readv_resume (call_frame_t *frame, xlator_t *bound_xl)
 {
-        server_state_t *state = NULL;
+        server_state_t    *state = NULL;
 
         state = CALL_STATE (frame);
 
         if (state->resolve.op_ret != 0)
                 goto err;
 
-        STACK_WIND (frame, server_setattr_cbk,
-                    bound_xl, bound_xl->fops->setattr,
-                    &state->loc, &state->stbuf, state->valid);
+        STACK_WIND (frame, server_compound_readv_cbk,
+                    bound_xl, bound_xl->fops->readv,
+                    state->fd, state->size, state->offset);
+
         return 0;
 err:
-        server_setattr_cbk (frame, NULL, frame->this, state->resolve.op_ret,
-                            state->resolve.op_errno, NULL, NULL);
-
+        server_compound_readv_cbk (frame, NULL, frame->this,
+                                   state->resolve.op_ret,
+                                   state->resolve.op_errno, NULL, 0, NULL,
+                                   NULL);
         return 0;
 }
 
 
 int
-server_stat_resume (call_frame_t *frame, xlator_t *bound_xl)
+server_compound_writev_resume (call_frame_t *frame, xlator_t *bound_xl)
 {
-        server_state_t *state = NULL;
+        server_state_t   *state = NULL;
 
         state = CALL_STATE (frame);
 
         if (state->resolve.op_ret != 0)
                 goto err;
 
-        STACK_WIND (frame, server_stat_cbk,
-                    bound_xl, bound_xl->fops->stat, &state->loc);
+        STACK_WIND (frame, server_compound_writev_cbk,
+                    bound_xl, bound_xl->fops->writev,
+                    state->fd, state->payload_vector, state->payload_count,
+                    state->offset, state->iobref);
+
         return 0;
 err:
-        server_stat_cbk (frame, NULL, frame->this, state->resolve.op_ret,
-                         state->resolve.op_errno, NULL);
+        server_compound_writev_cbk (frame, NULL, frame->this,
+                                    state->resolve.op_ret,
+                                    state->resolve.op_errno, NULL, NULL);
         return 0;
 }
 
+
 int
-server_lookup_resume (call_frame_t *frame, xlator_t *bound_xl)
+server_compound_flush_resume (call_frame_t *frame, xlator_t *bound_xl)
 {
         server_state_t    *state = NULL;
 
@@ -2656,26 +3479,18 @@ server_lookup_resume (call_frame_t *frame, xlator_t *bound_xl)
         if (state->resolve.op_ret != 0)
                 goto err;
 
-        if (!state->loc.inode)
-                state->loc.inode = inode_new (state->itable);
-        else
-                state->is_revalidate = 1;
-
-        STACK_WIND (frame, server_lookup_cbk,
-                    bound_xl, bound_xl->fops->lookup,
-                    &state->loc, state->dict);
-
+        STACK_WIND (frame, server_compound_flush_cbk,
+                    bound_xl, bound_xl->fops->flush, state->fd);
         return 0;
 err:
-        server_lookup_cbk (frame, NULL, frame->this, state->resolve.op_ret,
-                           state->resolve.op_errno, NULL, NULL, NULL, NULL);
-
+        server_compound_flush_cbk (frame, NULL, frame->this,
+                                   state->resolve.op_ret,
+                                   state->resolve.op_errno);
         return 0;
 }
 
 
 
-
 /* Fop section */
 
 int
@@ -3023,7 +3838,7 @@ server_readv (rpcsvc_request_t *req)
         if (!req)
                 goto out;
 
-        if (!xdr_to_generic (req->msg[0], &args, (xdrproc_t)xdr_gfs3_read_req)) {
+        if (!xdr_to_generic (req->msg[0], &args, (xdrproc_t)xdr_fast_gfs3_read_req)) {
                 //failed to decode msg;
                 req->rpc_err = GARBAGE_ARGS;
                 goto out;
@@ -3069,7 +3884,7 @@ server_writev (rpcsvc_request_t *req)
         if (!req)
                 return ret;
 
-        len = xdr_to_generic (req->msg[0], &args, (xdrproc_t)xdr_gfs3_write_req);
+        len = xdr_to_generic (req->msg[0], &args, (xdrproc_t)xdr_fast_gfs3_write_req);
         if (len == 0) {
                 //failed to decode msg;
                 req->rpc_err = GARBAGE_ARGS;
@@ -3212,7 +4027,182 @@ server_fsync (rpcsvc_request_t *req)
         if (!req)
                 return ret;
 
-        if (!xdr_to_generic (req->msg[0], &args, (xdrproc_t)xdr_gfs3_fsync_req)) {
+        if (!xdr_to_generic (req->msg[0], &args, (xdrproc_t)xdr_gfs3_fsync_req)) {
+                //failed to decode msg;
+                req->rpc_err = GARBAGE_ARGS;
+                goto out;
+        }
+
+        frame = get_frame_from_request (req);
+        if (!frame) {
+                // something wrong, mostly insufficient memory
+                req->rpc_err = GARBAGE_ARGS; /* TODO */
+                goto out;
+        }
+        frame->root->op = GF_FOP_FSYNC;
+
+        state = CALL_STATE (frame);
+        if (!state->conn->bound_xl) {
+                /* auth failure, request on subvolume without setvolume */
+                req->rpc_err = GARBAGE_ARGS;
+                goto out;
+        }
+
+        state->resolve.type  = RESOLVE_MUST;
+        state->resolve.fd_no = args.fd;
+        state->flags         = args.data;
+
+        ret = 0;
+        resolve_and_resume (frame, server_fsync_resume);
+out:
+        return ret;
+}
+
+
+
+int
+server_flush (rpcsvc_request_t *req)
+{
+        server_state_t *state = NULL;
+        call_frame_t   *frame = NULL;
+        gfs3_flush_req  args  = {{0,},};
+        int             ret   = -1;
+
+        if (!req)
+                return ret;
+
+        if (!xdr_to_generic (req->msg[0], &args, (xdrproc_t)xdr_gfs3_flush_req)) {
+                //failed to decode msg;
+                req->rpc_err = GARBAGE_ARGS;
+                goto out;
+        }
+
+        frame = get_frame_from_request (req);
+        if (!frame) {
+                // something wrong, mostly insufficient memory
+                req->rpc_err = GARBAGE_ARGS; /* TODO */
+                goto out;
+        }
+        frame->root->op = GF_FOP_FLUSH;
+
+        state = CALL_STATE (frame);
+        if (!state->conn->bound_xl) {
+                /* auth failure, request on subvolume without setvolume */
+                req->rpc_err = GARBAGE_ARGS;
+                goto out;
+        }
+
+        state->resolve.type  = RESOLVE_MUST;
+        state->resolve.fd_no = args.fd;
+
+        ret = 0;
+        resolve_and_resume (frame, server_flush_resume);
+out:
+        return ret;
+}
+
+
+
+int
+server_ftruncate (rpcsvc_request_t *req)
+{
+        server_state_t     *state = NULL;
+        call_frame_t       *frame = NULL;
+        gfs3_ftruncate_req  args  = {{0,},};
+        int                 ret   = -1;
+
+        if (!req)
+                return ret;
+
+        if (!xdr_to_generic (req->msg[0], &args, (xdrproc_t)xdr_gfs3_ftruncate_req)) {
+                //failed to decode msg;
+                req->rpc_err = GARBAGE_ARGS;
+                goto out;
+        }
+
+        frame = get_frame_from_request (req);
+        if (!frame) {
+                // something wrong, mostly insufficient memory
+                req->rpc_err = GARBAGE_ARGS; /* TODO */
+                goto out;
+        }
+        frame->root->op = GF_FOP_FTRUNCATE;
+
+        state = CALL_STATE (frame);
+        if (!state->conn->bound_xl) {
+                /* auth failure, request on subvolume without setvolume */
+                req->rpc_err = GARBAGE_ARGS;
+                goto out;
+        }
+
+        state->resolve.type   = RESOLVE_MUST;
+        state->resolve.fd_no  = args.fd;
+        state->offset         = args.offset;
+
+        ret = 0;
+        resolve_and_resume (frame, server_ftruncate_resume);
+out:
+        return ret;
+}
+
+
+int
+server_fallocate (rpcsvc_request_t *req)
+{
+        server_state_t     *state = NULL;
+        call_frame_t       *frame = NULL;
+        gfs3_fallocate_req  args  = {{0,},};
+        int                 ret   = -1;
+
+        if (!req)
+                return ret;
+
+        if (!xdr_to_generic (req->msg[0], &args, (xdrproc_t)xdr_gfs3_fallocate_req)) {
+                //failed to decode msg;
+                req->rpc_err = GARBAGE_ARGS;
+                goto out;
+        }
+
+        frame = get_frame_from_request (req);
+        if (!frame) {
+                // something wrong, mostly insufficient memory
+                req->rpc_err = GARBAGE_ARGS; /* TODO */
+                goto out;
+        }
+        frame->root->op = GF_FOP_FALLOCATE;
+
+        state = CALL_STATE (frame);
+        if (!state->conn->bound_xl) {
+                /* auth failure, request on subvolume without setvolume */
+                req->rpc_err = GARBAGE_ARGS;
+                goto out;
+        }
+
+        state->resolve.type   = RESOLVE_MUST;
+        state->resolve.fd_no  = args.fd;
+        state->flags          = args.flags;
+        state->offset         = args.offset;
+        state->size           = args.size;
+
+        ret = 0;
+        resolve_and_resume (frame, server_fallocate_resume);
+out:
+        return ret;
+}
+
+
+int
+server_discard (rpcsvc_request_t *req)
+{
+        server_state_t     *state = NULL;
+        call_frame_t       *frame = NULL;
+        gfs3_discard_req    args  = {{0,},};
+        int                 ret   = -1;
+
+        if (!req)
+                return ret;
+
+        if (!xdr_to_generic (req->msg[0], &args, (xdrproc_t)xdr_gfs3_discard_req)) {
                 //failed to decode msg;
                 req->rpc_err = GARBAGE_ARGS;
                 goto out;
@@ -3224,7 +4214,7 @@ server_fsync (rpcsvc_request_t *req)
                 req->rpc_err = GARBAGE_ARGS; /* TODO */
                 goto out;
         }
-        frame->root->op = GF_FOP_FSYNC;
+        frame->root->op = GF_FOP_DISCARD;
 
         state = CALL_STATE (frame);
         if (!state->conn->bound_xl) {
@@ -3233,30 +4223,30 @@ server_fsync (rpcsvc_request_t *req)
                 goto out;
         }
 
-        state->resolve.type  = RESOLVE_MUST;
-        state->resolve.fd_no = args.fd;
-        state->flags         = args.data;
+        state->resolve.type   = RESOLVE_MUST;
+        state->resolve.fd_no  = args.fd;
+        state->offset         = args.offset;
+        state->size           = args.size;
 
         ret = 0;
-        resolve_and_resume (frame, server_fsync_resume);
+        resolve_and_resume (frame, server_discard_resume);
 out:
         return ret;
 }
 
 
-
 int
-server_flush (rpcsvc_request_t *req)
+server_zerofill (rpcsvc_request_t *req)
 {
-        server_state_t *state = NULL;
-        call_frame_t   *frame = NULL;
-        gfs3_flush_req  args  = {{0,},};
-        int             ret   = -1;
+        server_state_t     *state = NULL;
+        call_frame_t       *frame = NULL;
+        gfs3_zerofill_req   args  = {{0,},};
+        int                 ret   = -1;
 
         if (!req)
                 return ret;
 
-        if (!xdr_to_generic (req->msg[0], &args, (xdrproc_t)xdr_gfs3_flush_req)) {
+        if (!xdr_to_generic (req->msg[0], &args, (xdrproc_t)xdr_gfs3_zerofill_req)) {
                 //failed to decode msg;
                 req->rpc_err = GARBAGE_ARGS;
                 goto out;
@@ -3268,7 +4258,7 @@ server_flush (rpcsvc_request_t *req)
                 req->rpc_err = GARBAGE_ARGS; /* TODO */
                 goto out;
         }
-        frame->root->op = GF_FOP_FLUSH;
+        frame->root->op = GF_FOP_ZEROFILL;
 
         state = CALL_STATE (frame);
         if (!state->conn->bound_xl) {
@@ -3277,29 +4267,30 @@ server_flush (rpcsvc_request_t *req)
                 goto out;
         }
 
-        state->resolve.type  = RESOLVE_MUST;
-        state->resolve.fd_no = args.fd;
+        state->resolve.type   = RESOLVE_MUST;
+        state->resolve.fd_no  = args.fd;
+        state->offset         = args.offset;
+        state->size           = args.size;
 
         ret = 0;
-        resolve_and_resume (frame, server_flush_resume);
+        resolve_and_resume (frame, server_zerofill_resume);
 out:
         return ret;
 }
 
 
-
 int
-server_ftruncate (rpcsvc_request_t *req)
+server_seek (rpcsvc_request_t *req)
 {
         server_state_t     *state = NULL;
         call_frame_t       *frame = NULL;
-        gfs3_ftruncate_req  args  = {{0,},};
+        gfs3_seek_req       args  = {{0,},};
         int                 ret   = -1;
 
         if (!req)
                 return ret;
 
-        if (!xdr_to_generic (req->msg[0], &args, (xdrproc_t)xdr_gfs3_ftruncate_req)) {
+        if (!xdr_to_generic (req->msg[0], &args, (xdrproc_t)xdr_gfs3_seek_req)) {
                 //failed to decode msg;
                 req->rpc_err = GARBAGE_ARGS;
                 goto out;
@@ -3311,7 +4302,7 @@ server_ftruncate (rpcsvc_request_t *req)
                 req->rpc_err = GARBAGE_ARGS; /* TODO */
                 goto out;
         }
-        frame->root->op = GF_FOP_FTRUNCATE;
+        frame->root->op = GF_FOP_SEEK;
 
         state = CALL_STATE (frame);
         if (!state->conn->bound_xl) {
@@ -3323,9 +4314,10 @@ server_ftruncate (rpcsvc_request_t *req)
         state->resolve.type   = RESOLVE_MUST;
         state->resolve.fd_no  = args.fd;
         state->offset         = args.offset;
+        state->what           = args.what;
 
         ret = 0;
-        resolve_and_resume (frame, server_ftruncate_resume);
+        resolve_and_resume (frame, server_seek_resume);
 out:
         return ret;
 }
@@ -5056,7 +6048,7 @@ server_lookup (rpcsvc_request_t *req)
         args.bname         = alloca (req->msg[0].iov_len);
         args.dict.dict_val = alloca (req->msg[0].iov_len);
 
-        if (!xdr_to_generic (req->msg[0], &args, (xdrproc_t)xdr_gfs3_lookup_req)) {
+        if (!xdr_to_generic (req->msg[0], &args, (xdrproc_t)xdr_fast_gfs3_lookup_req)) {
                 //failed to decode msg;
                 req->rpc_err = GARBAGE_ARGS;
                 goto err;
@@ -5180,6 +6172,531 @@ out:
 }
 
 
+/* forget whatever the previous sub-fop of a compound left in the state */
+static void
+server_compound_state_reset (server_state_t *state)
+{
+        server_loc_wipe (&state->loc);
+        server_loc_wipe (&state->loc2);
+        memset (&state->loc, 0, sizeof (state->loc));
+        memset (&state->loc2, 0, sizeof (state->loc2));
+
+        server_resolve_wipe (&state->resolve);
+        server_resolve_wipe (&state->resolve2);
+        memset (&state->resolve, 0, sizeof (state->resolve));
+        memset (&state->resolve2, 0, sizeof (state->resolve2));
+        state->resolve.fd_no  = -1;
+        state->resolve2.fd_no = -1;
+        state->resolve_now    = NULL;
+        state->loc_now        = NULL;
+
+        if (state->fd) {
+                fd_unref (state->fd);
+                state->fd = NULL;
+        }
+        if (state->dict) {
+                dict_unref (state->dict);
+                state->dict = NULL;
+        }
+        if (state->params) {
+                dict_unref (state->params);
+                state->params = NULL;
+        }
+        if (state->iobref) {
+                iobref_unref (state->iobref);
+                state->iobref = NULL;
+        }
+
+        state->is_revalidate = 0;
+        state->payload_count = 0;
+        state->size          = 0;
+        state->offset        = 0;
+        state->flags         = 0;
+        state->wbflags       = 0;
+}
+
+
+static dict_t *
+server_compound_dict (call_frame_t *frame, char *val, u_int len)
+{
+        dict_t *dict = NULL;
+        char   *buf  = NULL;
+        int     ret  = -1;
+
+        dict = dict_new ();
+        buf  = memdup (val, len);
+        if (!dict || !buf)
+                goto out;
+
+        ret = dict_unserialize (buf, len, &dict);
+        if (ret < 0) {
+                gf_log (frame->this->name, GF_LOG_ERROR,
+                        "%"PRId64": failed to unserialize req-buffer to "
+                        "dictionary", frame->root->unique);
+                goto out;
+        }
+
+        dict->extra_free = buf;
+        buf = NULL;
+out:
+        if (ret < 0) {
+                if (dict)
+                        dict_unref (dict);
+                dict = NULL;
+        }
+        if (buf)
+                GF_FREE (buf);
+
+        return dict;
+}
+
+
+/* fail the current sub-fop in the reply arm of its own type, -1 if there
+   is no such arm */
+static int
+server_compound_fail (server_compound_t *compound, int32_t op_errno)
+{
+        gfs3_compound_rsp_op *rsp   = NULL;
+        int32_t               error = 0;
+
+        rsp   = &compound->rsp.ops.ops_val[compound->index];
+        error = gf_errno_to_error (op_errno);
+
+        switch (rsp->fop) {
+        case GFS3_COMPOUND_LOOKUP:
+                rsp->gfs3_compound_rsp_op_u.lookup_rsp.op_ret   = -1;
+                rsp->gfs3_compound_rsp_op_u.lookup_rsp.op_errno = error;
+                break;
+        case GFS3_COMPOUND_OPEN:
+                rsp->gfs3_compound_rsp_op_u.open_rsp.op_ret   = -1;
+                rsp->gfs3_compound_rsp_op_u.open_rsp.op_errno = error;
+                break;
+        case GFS3_COMPOUND_READ:
+                rsp->gfs3_compound_rsp_op_u.read_rsp.rsp.op_ret   = -1;
+                rsp->gfs3_compound_rsp_op_u.read_rsp.rsp.op_errno = error;
+                break;
+        case GFS3_COMPOUND_CREATE:
+                rsp->gfs3_compound_rsp_op_u.create_rsp.op_ret   = -1;
+                rsp->gfs3_compound_rsp_op_u.create_rsp.op_errno = error;
+                break;
+        case GFS3_COMPOUND_WRITE:
+                rsp->gfs3_compound_rsp_op_u.write_rsp.op_ret   = -1;
+                rsp->gfs3_compound_rsp_op_u.write_rsp.op_errno = error;
+                break;
+        case GFS3_COMPOUND_FLUSH:
+                rsp->gfs3_compound_rsp_op_u.flush_rsp.op_ret   = -1;
+                rsp->gfs3_compound_rsp_op_u.flush_rsp.op_errno = error;
+                break;
+        default:
+                return -1;
+        }
+
+        return 0;
+}
+
+
+/* a linked fd or inode makes the resolver unnecessary */
+static int
+server_compound_resume_linked (call_frame_t *frame, server_resume_fn_t fn)
+{
+        server_state_t *state = NULL;
+
+        state = CALL_STATE (frame);
+        state->resume_fn = fn;
+
+        return fn (frame, BOUND_XL (frame));
+}
+
+
+static int
+server_compound_next (call_frame_t *frame)
+{
+        server_state_t       *state    = NULL;
+        server_compound_t    *compound = NULL;
+        gfs3_compound_req_op *op       = NULL;
+        struct iobuf         *iobuf    = NULL;
+        int                   op_errno = EINVAL;
+
+        state    = CALL_STATE (frame);
+        compound = state->compound;
+
+        if (compound->index == compound->args.ops.ops_len)
+                return server_compound_reply (frame);
+
+        server_compound_state_reset (state);
+
+        op = &compound->args.ops.ops_val[compound->index];
+        compound->rsp.ops.ops_val[compound->index].fop = op->fop;
+
+        switch (op->fop) {
+        case GFS3_COMPOUND_LOOKUP:
+        {
+                gfs3_lookup_req *args = &op->gfs3_compound_req_op_u.lookup_req;
+
+                frame->root->op = GF_FOP_LOOKUP;
+
+                state->resolve.type = RESOLVE_DONTCARE;
+                memcpy (state->resolve.gfid, args->gfid, 16);
+                memcpy (state->resolve.pargfid, args->pargfid, 16);
+                state->resolve.path = gf_strdup (args->path);
+                if (IS_NOT_ROOT (STRLEN_0 (args->path)))
+                        state->resolve.bname = gf_strdup (args->bname);
+
+                if (args->dict.dict_len) {
+                        state->dict = server_compound_dict (
+                                frame, args->dict.dict_val,
+                                args->dict.dict_len);
+                        if (!state->dict)
+                                goto err;
+                }
+
+                resolve_and_resume (frame, server_compound_lookup_resume);
+                break;
+        }
+
+        case GFS3_COMPOUND_OPEN:
+        {
+                gfs3_open_req *args = &op->gfs3_compound_req_op_u.open_req;
+
+                frame->root->op = GF_FOP_OPEN;
+
+                state->flags   = gf_flags_to_flags (args->flags);
+                state->wbflags = args->wbflags;
+
+                if (uuid_is_null (*((uuid_t *)args->gfid))) {
+                        if (!compound->inode)
+                                goto err;
+
+                        state->loc.inode = inode_ref (compound->inode);
+                        uuid_copy (state->loc.gfid, compound->inode->gfid);
+                        state->loc.path  = gf_strdup (args->path);
+                        server_compound_resume_linked (
+                                frame, server_compound_open_resume);
+                        break;
+                }
+
+                state->resolve.type = RESOLVE_MUST;
+                memcpy (state->resolve.gfid, args->gfid, 16);
+                state->resolve.path = gf_strdup (args->path);
+
+                resolve_and_resume (frame, server_compound_open_resume);
+                break;
+        }
+
+        case GFS3_COMPOUND_CREATE:
+        {
+                gfs3_create_req *args = &op->gfs3_compound_req_op_u.create_req;
+
+                frame->root->op = GF_FOP_CREATE;
+
+                if (args->dict.dict_len) {
+                        state->params = server_compound_dict (
+                                frame, args->dict.dict_val,
+                                args->dict.dict_len);
+                        if (!state->params)
+                                goto err;
+                }
+
+                state->resolve.path  = gf_strdup (args->path);
+                state->resolve.bname = gf_strdup (args->bname);
+                state->mode          = args->mode;
+                state->flags         = gf_flags_to_flags (args->flags);
+                memcpy (state->resolve.pargfid, args->pargfid, 16);
+
+                if (state->flags & O_EXCL)
+                        state->resolve.type = RESOLVE_NOT;
+                else
+                        state->resolve.type = RESOLVE_DONTCARE;
+
+                resolve_and_resume (frame, server_compound_create_resume);
+                break;
+        }
+
+        case GFS3_COMPOUND_READ:
+        {
+                gfs3_read_req *args = &op->gfs3_compound_req_op_u.read_req;
+
+                frame->root->op = GF_FOP_READ;
+
+                state->size   = args->size;
+                state->offset = args->offset;
+
+                if (args->fd == GF_COMPOUND_LINKED_FD) {
+                        op_errno = EBADF;
+                        if (!compound->fd)
+                                goto err;
+                        state->fd = fd_ref (compound->fd);
+                        server_compound_resume_linked (
+                                frame, server_compound_readv_resume);
+                        break;
+                }
+
+                state->resolve.type  = RESOLVE_MUST;
+                state->resolve.fd_no = args->fd;
+
+                resolve_and_resume (frame, server_compound_readv_resume);
+                break;
+        }
+
+        case GFS3_COMPOUND_WRITE:
+        {
+                gfs3_compound_write_req *args =
+                        &op->gfs3_compound_req_op_u.write_req;
+
+                frame->root->op = GF_FOP_WRITE;
+
+                /* the decoded payload goes away with the request, give the
+                   translators an iobuf they can hold on to */
+                op_errno = ENOMEM;
+                state->iobref = iobref_new ();
+                iobuf = iobuf_get2 (frame->this->ctx->iobuf_pool,
+                                    args->data.data_len);
+                if (!state->iobref || !iobuf)
+                        goto err;
+
+                iobref_add (state->iobref, iobuf);
+                memcpy (iobuf_ptr (iobuf), args->data.data_val,
+                        args->data.data_len);
+                state->payload_vector[0].iov_base = iobuf_ptr (iobuf);
+                state->payload_vector[0].iov_len  = args->data.data_len;
+                state->payload_count = 1;
+                state->size          = args->data.data_len;
+                state->offset        = args->req.offset;
+                iobuf_unref (iobuf);
+                iobuf = NULL;
+
+                if (args->req.fd == GF_COMPOUND_LINKED_FD) {
+                        op_errno = EBADF;
+                        if (!compound->fd)
+                                goto err;
+                        state->fd = fd_ref (compound->fd);
+                        server_compound_resume_linked (
+                                frame, server_compound_writev_resume);
+                        break;
+                }
+
+                state->resolve.type  = RESOLVE_MUST;
+                state->resolve.fd_no = args->req.fd;
+
+                resolve_and_resume (frame, server_compound_writev_resume);
+                break;
+        }
+
+        case GFS3_COMPOUND_FLUSH:
+        {
+                gfs3_flush_req *args = &op->gfs3_compound_req_op_u.flush_req;
+
+                frame->root->op = GF_FOP_FLUSH;
+
+                if (args->fd == GF_COMPOUND_LINKED_FD) {
+                        op_errno = EBADF;
+                        if (!compound->fd)
+                                goto err;
+                        state->fd = fd_ref (compound->fd);
+                        server_compound_resume_linked (
+                                frame, server_compound_flush_resume);
+                        break;
+                }
+
+                state->resolve.type  = RESOLVE_MUST;
+                state->resolve.fd_no = args->fd;
+
+                resolve_and_resume (frame, server_compound_flush_resume);
+                break;
+        }
+
+        default:
+                goto err;
+        }
+
+        return 0;
+err:
+        if (iobuf)
+                iobuf_unref (iobuf);
+
+        if (server_compound_fail (compound, op_errno)) {
+                /* unknown sub-fop, end the reply before it */
+                compound->rsp.op_ret   = -1;
+                compound->rsp.op_errno = gf_errno_to_error (op_errno);
+                return server_compound_reply (frame);
+        }
+
+        return server_compound_resume (frame, -1, op_errno);
+}
+
+
+int
+server_compound (rpcsvc_request_t *req)
+{
+        server_state_t    *state    = NULL;
+        call_frame_t      *frame    = NULL;
+        server_compound_t *compound = NULL;
+        int                ret      = -1;
+
+        if (!req)
+                return ret;
+
+        compound = GF_CALLOC (1, sizeof (*compound), gf_server_mt_compound_t);
+        if (!compound) {
+                req->rpc_err = GARBAGE_ARGS;
+                goto out;
+        }
+
+        if (xdr_to_generic (req->msg[0], &compound->args,
+                            (xdrproc_t)xdr_gfs3_compound_req) < 0) {
+                //failed to decode msg;
+                req->rpc_err = GARBAGE_ARGS;
+                goto out;
+        }
+
+        if (!compound->args.ops.ops_len
+            || (compound->args.ops.ops_len > GF_COMPOUND_MAX_FOPS)) {
+                req->rpc_err = GARBAGE_ARGS;
+                goto out;
+        }
+
+        compound->rsp.ops.ops_val = GF_CALLOC (compound->args.ops.ops_len,
+                                               sizeof (gfs3_compound_rsp_op),
+                                               gf_server_mt_rsp_buf_t);
+        if (!compound->rsp.ops.ops_val) {
+                req->rpc_err = GARBAGE_ARGS;
+                goto out;
+        }
+
+        frame = get_frame_from_request (req);
+        if (!frame) {
+                // something wrong, mostly insufficient memory
+                req->rpc_err = GARBAGE_ARGS; /* TODO */
+                goto out;
+        }
+
+        state = CALL_STATE (frame);
+        if (!state->conn->bound_xl) {
+                /* auth failure, request on subvolume without setvolume */
+                req->rpc_err = GARBAGE_ARGS;
+                goto out;
+        }
+
+        state->compound = compound;
+        compound = NULL;
+
+        ret = 0;
+        server_compound_next (frame);
+out:
+        if (compound)
+                server_compound_free (compound);
+
+        return ret;
+}
+
+
+int
+server_bulkstat (rpcsvc_request_t *req)
+{
+        server_state_t      *state    = NULL;
+        call_frame_t        *frame    = NULL;
+        gfs3_bulkstat_req    args     = {{0,},};
+        gfs3_bulkstat_entry *entry    = NULL;
+        inode_t             *inode    = NULL;
+        loc_t               *locs     = NULL;
+        u_int                i        = 0;
+        int                  filled   = 0;
+        int                  op_errno = 0;
+        int                  ret      = -1;
+
+        if (!req)
+                return ret;
+
+        if (xdr_to_generic (req->msg[0], &args,
+                            (xdrproc_t)xdr_gfs3_bulkstat_req) < 0) {
+                //failed to decode msg;
+                req->rpc_err = GARBAGE_ARGS;
+                goto out;
+        }
+
+        if (!args.entries.entries_len
+            || (args.entries.entries_len > GF_BULKSTAT_MAX_COUNT)) {
+                req->rpc_err = GARBAGE_ARGS;
+                goto out;
+        }
+
+        frame = get_frame_from_request (req);
+        if (!frame) {
+                // something wrong, mostly insufficient memory
+                req->rpc_err = GARBAGE_ARGS; /* TODO */
+                goto out;
+        }
+        frame->root->op = GF_FOP_BULKSTAT;
+
+        /* from here on, errors are replied to, which frees the frame */
+        ret = 0;
+
+        state = CALL_STATE (frame);
+        state->bulk_count = args.entries.entries_len;
+        if (!state->conn->bound_xl) {
+                /* auth failure, request on subvolume without setvolume */
+                op_errno = ENOTCONN;
+                goto err;
+        }
+
+        locs = GF_CALLOC (args.entries.entries_len, sizeof (*locs),
+                          gf_common_mt_bulkstat_t);
+        if (!locs) {
+                op_errno = ENOMEM;
+                goto err;
+        }
+        state->bulk_locs  = locs;
+
+        /* no resolution here: inodes known to the server get their path
+           from its table, the others are stated at the path the client
+           gave, which must not lead out of the export. the storage
+           translator checks that the gfid found there is the one asked */
+        for (i = 0; i < args.entries.entries_len; i++) {
+                entry = &args.entries.entries_val[i];
+
+                inode = NULL;
+                if (state->itable)
+                        inode = inode_find (state->itable,
+                                            (unsigned char *)entry->gfid);
+
+                if (inode) {
+                        filled = (bulkstat_loc_fill (&locs[i], inode) == 0);
+                        inode_unref (inode);
+                        if (filled)
+                                continue;
+                }
+
+                memcpy (locs[i].gfid, entry->gfid, 16);
+
+                /* the entry then fails with EINVAL in the storage
+                   translator, as one without a path */
+                if (!bulkstat_path_is_safe (entry->path))
+                        continue;
+
+                locs[i].path = gf_strdup (entry->path);
+                if (!locs[i].path) {
+                        op_errno = ENOMEM;
+                        goto err;
+                }
+                locs[i].name = strrchr (locs[i].path, '/') + 1;
+        }
+
+        STACK_WIND (frame, server_bulkstat_cbk, state->conn->bound_xl,
+                    state->conn->bound_xl->fops->bulkstat,
+                    state->bulk_locs, state->bulk_count);
+        goto out;
+
+err:
+        server_bulkstat_cbk (frame, NULL, frame->this, -1, op_errno,
+                             NULL, NULL);
+out:
+        /* memory allocated by libc, don't use GF_FREE */
+        xdr_free ((xdrproc_t)xdr_gfs3_bulkstat_req, (char *)&args);
+
+        return ret;
+}
+
+
 rpcsvc_actor_t glusterfs3_1_fop_actors[] = {
         [GFS3_OP_NULL]        = { "NULL",       GFS3_OP_NULL, server_null, NULL, NULL},
         [GFS3_OP_STAT]        = { "STAT",       GFS3_OP_STAT, server_stat, NULL, NULL },
@@ -5207,13 +6724,13 @@ rpcsvc_actor_t glusterfs3_1_fop_actors[] = {
         [GFS3_OP_CREATE]      = { "CREATE",     GFS3_OP_CREATE, server_create, NULL, NULL },
         [GFS3_OP_FTRUNCATE]   = { "FTRUNCATE",  GFS3_OP_FTRUNCATE, server_ftruncate, NULL, NULL },
         [GFS3_OP_FSTAT]       = { "FSTAT",      GFS3_OP_FSTAT, server_fstat, NULL, NULL },
-        [GFS3_OP_LK]          = { "LK",         GFS3_OP_LK, server_lk, NULL, NULL },
+        [GFS3_OP_LK]          = { "LK",         GFS3_OP_LK, server_lk, NULL, NULL, _gf_true },
         [GFS3_OP_LOOKUP]      = { "LOOKUP",     GFS3_OP_LOOKUP, server_lookup, NULL, NULL },
         [GFS3_OP_READDIR]     = { "READDIR",    GFS3_OP_READDIR, server_readdir, NULL, NULL },
-        [GFS3_OP_INODELK]     = { "INODELK",    GFS3_OP_INODELK, server_inodelk, NULL, NULL },
-        [GFS3_OP_FINODELK]    = { "FINODELK",   GFS3_OP_FINODELK, server_finodelk, NULL, NULL },
-        [GFS3_OP_ENTRYLK]     = { "ENTRYLK",    GFS3_OP_ENTRYLK, server_entrylk, NULL, NULL },
-        [GFS3_OP_FENTRYLK]    = { "FENTRYLK",   GFS3_OP_FENTRYLK, server_fentrylk, NULL, NULL },
+        [GFS3_OP_INODELK]     = { "INODELK",    GFS3_OP_INODELK, server_inodelk, NULL, NULL, _gf_true },
+        [GFS3_OP_FINODELK]    = { "FINODELK",   GFS3_OP_FINODELK, server_finodelk, NULL, NULL, _gf_true },
+        [GFS3_OP_ENTRYLK]     = { "ENTRYLK",    GFS3_OP_ENTRYLK, server_entrylk, NULL, NULL, _gf_true },
+        [GFS3_OP_FENTRYLK]    = { "FENTRYLK",   GFS3_OP_FENTRYLK, server_fentrylk, NULL, NULL, _gf_true },
         [GFS3_OP_XATTROP]     = { "XATTROP",    GFS3_OP_XATTROP, server_xattrop, NULL, NULL },
         [GFS3_OP_FXATTROP]    = { "FXATTROP",   GFS3_OP_FXATTROP, server_fxattrop, NULL, NULL },
         [GFS3_OP_FGETXATTR]   = { "FGETXATTR",  GFS3_OP_FGETXATTR, server_fgetxattr, NULL, NULL },
@@ -5224,6 +6741,12 @@ rpcsvc_actor_t glusterfs3_1_fop_actors[] = {
         [GFS3_OP_READDIRP]    = { "READDIRP",   GFS3_OP_READDIRP, server_readdirp, NULL, NULL },
         [GFS3_OP_RELEASE]     = { "RELEASE",    GFS3_OP_RELEASE, server_release, NULL, NULL },
         [GFS3_OP_RELEASEDIR]  = { "RELEASEDIR", GFS3_OP_RELEASEDIR, server_releasedir, NULL, NULL },
+        [GFS3_OP_COMPOUND]    = { "COMPOUND",   GFS3_OP_COMPOUND, server_compound, NULL, NULL },
+        [GFS3_OP_BULKSTAT]    = { "BULKSTAT",   GFS3_OP_BULKSTAT, server_bulkstat, NULL, NULL },
+        [GFS3_OP_FALLOCATE]   = { "FALLOCATE",  GFS3_OP_FALLOCATE, server_fallocate, NULL, NULL },
+        [GFS3_OP_DISCARD]     = { "DISCARD",    GFS3_OP_DISCARD, server_discard, NULL, NULL },
+        [GFS3_OP_ZEROFILL]    = { "ZEROFILL",   GFS3_OP_ZEROFILL, server_zerofill, NULL, NULL },
+        [GFS3_OP_SEEK]        = { "SEEK",       GFS3_OP_SEEK, server_seek, NULL, NULL },
 };
 
 
@@ -0,0 +1,978 @@
+/*
+  Copyright (c) 2011 Gluster, Inc. <http://www.gluster.com>
+  This file is part of GlusterFS.
+
+  GlusterFS is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published
+  by the Free Software Foundation; either version 3 of the License,
+  or (at your option) any later version.
+
+  GlusterFS is distributed in the hope that it will be useful, but
+  WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see
+  <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef _CONFIG_H
+#define _CONFIG_H
+#include "config.h"
+#endif
+
+#include <errno.h>
+#include <pthread.h>
+#include <sys/uio.h>
+
+#ifdef GF_LINUX_HOST_OS
+#include <time.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#ifdef HAVE_LINUX_IO_URING_H
+#include <linux/io_uring.h>
+#endif
+#ifdef HAVE_LINUX_AIO_ABI_H
+#include <linux/aio_abi.h>
+#endif
+#endif
+
+#include "glusterfs.h"
+#include "xlator.h"
+#include "logging.h"
+#include "iobuf.h"
+#include "locking.h"
+#include "posix.h"
+#include "posix-aio.h"
+
+#if defined(GF_LINUX_HOST_OS) && defined(HAVE_LINUX_IO_URING_H) && \
+        defined(__NR_io_uring_setup)
+#define POSIX_HAVE_URING 1
+#endif
+
+#if defined(GF_LINUX_HOST_OS) && defined(HAVE_LINUX_AIO_ABI_H) && \
+        defined(__NR_io_setup)
+#define POSIX_HAVE_LINUX_AIO 1
+#endif
+
+#define POSIX_AIO_EVENTS 64
+
+/* one fop in flight in the kernel */
+struct posix_aio_req {
+        call_frame_t     *frame;
+        xlator_t         *this;
+        fd_t             *fd;
+        int               _fd;
+        glusterfs_fop_t   fop;
+        off_t             offset;
+        struct iatt       preop;
+        int               flushwrites;
+        int               written;      /* the write an fsync is linked to */
+
+        /* readv: the buffer read into, as a one element vector */
+        struct iobuf     *iobuf;
+        struct iovec      vec;
+
+        /* writev: our copy of the caller's vector, and its iobref */
+        struct iovec     *vector;
+        int32_t           count;
+        struct iobref    *iobref;
+
+#ifdef POSIX_HAVE_LINUX_AIO
+        struct iocb       iocb;
+#endif
+};
+
+struct posix_aio {
+        posix_io_engine_t engine;
+        int               depth;
+        int               inflight;
+        gf_boolean_t      fini;
+        gf_lock_t         lock;
+        pthread_t         reaper;
+
+#ifdef POSIX_HAVE_URING
+        int               ring_fd;
+        void             *sq_ring;
+        size_t            sq_ring_len;
+        void             *cq_ring;
+        size_t            cq_ring_len;
+        struct io_uring_sqe *sqes;
+        size_t            sqes_len;
+        unsigned         *sq_head;
+        unsigned         *sq_tail;
+        unsigned         *sq_mask;
+        unsigned         *sq_entries;
+        unsigned         *sq_array;
+        unsigned         *cq_head;
+        unsigned         *cq_tail;
+        unsigned         *cq_mask;
+        struct io_uring_cqe *cqes;
+#endif
+
+#ifdef POSIX_HAVE_LINUX_AIO
+        aio_context_t     aio_ctx;
+#endif
+};
+
+
+static void
+posix_aio_req_destroy (struct posix_aio_req *req)
+{
+        if (req->fd)
+                fd_unref (req->fd);
+        if (req->iobuf)
+                iobuf_unref (req->iobuf);
+        if (req->iobref)
+                iobref_unref (req->iobref);
+        if (req->vector)
+                GF_FREE (req->vector);
+
+        GF_FREE (req);
+}
+
+
+static struct posix_aio_req *
+posix_aio_req_new (call_frame_t *frame, xlator_t *this, fd_t *fd, int _fd,
+                   glusterfs_fop_t fop, off_t offset)
+{
+        struct posix_aio_req *req = NULL;
+
+        req = GF_CALLOC (1, sizeof (*req), gf_posix_mt_aio_req_t);
+        if (!req)
+                return NULL;
+
+        req->frame  = frame;
+        req->this   = this;
+        req->fd     = fd_ref (fd);
+        req->_fd    = _fd;
+        req->fop    = fop;
+        req->offset = offset;
+
+        return req;
+}
+
+
+/*
+ * Called by the reaper thread once the kernel is done with @req; @res is
+ * what the system call would have returned, or -errno. Does the part of
+ * posix_readv/writev/fsync which follows the I/O, and unwinds. Nothing
+ * here may wait for the disk: the flush of an O_SYNC write is linked to
+ * it in the ring, it is never done by the reaper.
+ */
+static void
+posix_aio_complete (struct posix_aio_req *req, int res)
+{
+        xlator_t             *this     = NULL;
+        struct posix_private *priv     = NULL;
+        struct iobref        *iobref   = NULL;
+        struct iatt           postop   = {0,};
+        struct stat           stbuf    = {0,};
+        int32_t               op_ret   = -1;
+        int32_t               op_errno = 0;
+        int                   ret      = -1;
+
+        this = req->this;
+        priv = this->private;
+
+        if (res < 0) {
+                op_errno = -res;
+                gf_log (this->name, GF_LOG_ERROR,
+                        "%s failed on fd=%p: %s", gf_fop_list[req->fop],
+                        req->fd, strerror (op_errno));
+                goto out;
+        }
+
+        switch (req->fop) {
+        case GF_FOP_READ:
+                LOCK (&priv->lock);
+                {
+                        priv->read_value    += res;
+                }
+                UNLOCK (&priv->lock);
+                break;
+        case GF_FOP_WRITE:
+                LOCK (&priv->lock);
+                {
+                        priv->write_value    += res;
+                }
+                UNLOCK (&priv->lock);
+                break;
+        default:
+                break;
+        }
+
+        /* the gfid was read before the I/O, spare the reaper the xattr */
+        ret = fstat (req->_fd, &stbuf);
+        if (ret == -1) {
+                op_errno = errno;
+                gf_log (this->name, GF_LOG_ERROR,
+                        "post-operation fstat failed on fd=%p: %s",
+                        req->fd, strerror (op_errno));
+                goto out;
+        }
+
+        iatt_from_stat (&postop, &stbuf);
+        uuid_copy (postop.ia_gfid, req->preop.ia_gfid);
+        posix_fill_ino_from_gfid (this, &postop);
+
+        if (req->fop == GF_FOP_READ) {
+                req->vec.iov_len = res;
+
+                /* Hack to notify higher layers of EOF. */
+                if (postop.ia_size == 0)
+                        op_errno = ENOENT;
+                else if ((req->offset + res) == postop.ia_size)
+                        op_errno = ENOENT;
+                else if (req->offset > postop.ia_size)
+                        op_errno = ENOENT;
+        }
+
+        op_ret = (req->fop == GF_FOP_FSYNC) ? 0 : res;
+out:
+        switch (req->fop) {
+        case GF_FOP_READ:
+                if (op_ret >= 0) {
+                        iobref = iobref_new ();
+                        if (iobref)
+                                iobref_add (iobref, req->iobuf);
+                } else {
+                        req->vec.iov_len = 0;
+                }
+                STACK_UNWIND_STRICT (readv, req->frame, op_ret, op_errno,
+                                     &req->vec, 1, &postop, iobref);
+                if (iobref)
+                        iobref_unref (iobref);
+                break;
+        case GF_FOP_WRITE:
+                STACK_UNWIND_STRICT (writev, req->frame, op_ret, op_errno,
+                                     &req->preop, &postop);
+                break;
+        case GF_FOP_FSYNC:
+                STACK_UNWIND_STRICT (fsync, req->frame, op_ret, op_errno,
+                                     &req->preop, &postop);
+                break;
+        default:
+                break;
+        }
+
+        posix_aio_req_destroy (req);
+}
+
+
+static void
+posix_aio_done (struct posix_aio *aio)
+{
+        LOCK (&aio->lock);
+        {
+                aio->inflight--;
+        }
+        UNLOCK (&aio->lock);
+}
+
+
+#ifdef POSIX_HAVE_URING
+
+static int
+posix_uring_setup (unsigned entries, struct io_uring_params *p)
+{
+        return syscall (__NR_io_uring_setup, entries, p);
+}
+
+
+static int
+posix_uring_enter (int ring_fd, unsigned to_submit, unsigned min_complete,
+                   unsigned flags)
+{
+        return syscall (__NR_io_uring_enter, ring_fd, to_submit,
+                        min_complete, flags, NULL, 0);
+}
+
+
+static int
+posix_uring_init (xlator_t *this, struct posix_aio *aio)
+{
+        struct io_uring_params params = {0,};
+        int                    ring_fd = -1;
+
+        ring_fd = posix_uring_setup (aio->depth, &params);
+        if (ring_fd < 0) {
+                gf_log (this->name, GF_LOG_WARNING,
+                        "io_uring_setup failed: %s", strerror (errno));
+                return -1;
+        }
+        aio->ring_fd = ring_fd;
+
+        aio->sq_ring_len = params.sq_off.array +
+                params.sq_entries * sizeof (unsigned);
+        aio->sq_ring = mmap (NULL, aio->sq_ring_len, PROT_READ | PROT_WRITE,
+                             MAP_SHARED | MAP_POPULATE, ring_fd,
+                             IORING_OFF_SQ_RING);
+        if (aio->sq_ring == MAP_FAILED) {
+                aio->sq_ring = NULL;
+                goto err;
+        }
+
+        aio->cq_ring_len = params.cq_off.cqes +
+                params.cq_entries * sizeof (struct io_uring_cqe);
+        aio->cq_ring = mmap (NULL, aio->cq_ring_len, PROT_READ | PROT_WRITE,
+                             MAP_SHARED | MAP_POPULATE, ring_fd,
+                             IORING_OFF_CQ_RING);
+        if (aio->cq_ring == MAP_FAILED) {
+                aio->cq_ring = NULL;
+                goto err;
+        }
+
+        aio->sqes_len = params.sq_entries * sizeof (struct io_uring_sqe);
+        aio->sqes = mmap (NULL, aio->sqes_len, PROT_READ | PROT_WRITE,
+                          MAP_SHARED | MAP_POPULATE, ring_fd,
+                          IORING_OFF_SQES);
+        if (aio->sqes == MAP_FAILED) {
+                aio->sqes = NULL;
+                goto err;
+        }
+
+        aio->sq_head    = aio->sq_ring + params.sq_off.head;
+        aio->sq_tail    = aio->sq_ring + params.sq_off.tail;
+        aio->sq_mask    = aio->sq_ring + params.sq_off.ring_mask;
+        aio->sq_entries = aio->sq_ring + params.sq_off.ring_entries;
+        aio->sq_array   = aio->sq_ring + params.sq_off.array;
+
+        aio->cq_head    = aio->cq_ring + params.cq_off.head;
+        aio->cq_tail    = aio->cq_ring + params.cq_off.tail;
+        aio->cq_mask    = aio->cq_ring + params.cq_off.ring_mask;
+        aio->cqes       = aio->cq_ring + params.cq_off.cqes;
+
+        return 0;
+err:
+        gf_log (this->name, GF_LOG_WARNING,
+                "mapping the io_uring rings failed: %s", strerror (errno));
+        return -1;
+}
+
+
+static void
+posix_uring_fini (struct posix_aio *aio)
+{
+        if (aio->sqes)
+                munmap (aio->sqes, aio->sqes_len);
+        if (aio->cq_ring)
+                munmap (aio->cq_ring, aio->cq_ring_len);
+        if (aio->sq_ring)
+                munmap (aio->sq_ring, aio->sq_ring_len);
+        if (aio->ring_fd >= 0)
+                close (aio->ring_fd);
+}
+
+
+/*
+ * The write of an O_SYNC fd is followed in the ring by an fsync linked to
+ * it; the cqe of the write carries the request tagged with this bit, the
+ * request completes with the cqe of the fsync.
+ */
+#define POSIX_URING_LINKED 1UL
+
+static struct io_uring_sqe *
+__posix_uring_sqe (struct posix_aio *aio, unsigned tail)
+{
+        struct io_uring_sqe *sqe   = NULL;
+        unsigned             index = 0;
+
+        index = tail & *aio->sq_mask;
+        sqe = &aio->sqes[index];
+        memset (sqe, 0, sizeof (*sqe));
+        aio->sq_array[index] = index;
+
+        return sqe;
+}
+
+
+/* queue the sqes of @req and hand them to the kernel; called with
+   aio->lock held */
+static int
+__posix_uring_submit (struct posix_aio *aio, struct posix_aio_req *req)
+{
+        struct io_uring_sqe *sqe    = NULL;
+        unsigned             head   = 0;
+        unsigned             tail   = 0;
+        unsigned             nr_sqe = 1;
+        int                  ret    = -1;
+
+        if (req && (req->fop == GF_FOP_WRITE) && req->flushwrites)
+                nr_sqe = 2;
+
+        tail = *aio->sq_tail;
+        head = *aio->sq_head;
+        __sync_synchronize ();
+        if (tail - head + nr_sqe > *aio->sq_entries)
+                return -1;
+
+        sqe = __posix_uring_sqe (aio, tail);
+        sqe->user_data = (unsigned long) req;
+
+        if (!req) {
+                sqe->opcode = IORING_OP_NOP;
+        } else {
+                sqe->fd  = req->_fd;
+                sqe->off = req->offset;
+
+                switch (req->fop) {
+                case GF_FOP_READ:
+                        sqe->opcode = IORING_OP_READV;
+                        sqe->addr   = (unsigned long) &req->vec;
+                        sqe->len    = 1;
+                        break;
+                case GF_FOP_WRITE:
+                        sqe->opcode = IORING_OP_WRITEV;
+                        sqe->addr   = (unsigned long) req->vector;
+                        sqe->len    = req->count;
+                        if (nr_sqe == 1)
+                                break;
+
+                        /* the fsync starts once the write is done, and
+                           is cancelled if it fails */
+                        sqe->flags     |= IOSQE_IO_LINK;
+                        sqe->user_data |= POSIX_URING_LINKED;
+
+                        sqe = __posix_uring_sqe (aio, tail + 1);
+                        sqe->user_data = (unsigned long) req;
+                        sqe->fd        = req->_fd;
+                        sqe->opcode    = IORING_OP_FSYNC;
+                        break;
+                default:
+                        sqe->opcode = IORING_OP_FSYNC;
+                        sqe->off    = 0;
+                        if (req->offset)
+                                sqe->fsync_flags = IORING_FSYNC_DATASYNC;
+                        break;
+                }
+        }
+
+        __sync_synchronize ();
+        *aio->sq_tail = tail + nr_sqe;
+        __sync_synchronize ();
+
+        ret = posix_uring_enter (aio->ring_fd, nr_sqe, 0, 0);
+        if (ret != nr_sqe) {
+                /* not consumed by the kernel, take them back */
+                if (*aio->sq_head == tail) {
+                        *aio->sq_tail = tail;
+                        return -1;
+                }
+
+                /* a linked pair is consumed as a whole, or not at all */
+                gf_log (THIS->name, GF_LOG_WARNING,
+                        "io_uring_enter consumed %d of %u sqes", ret,
+                        nr_sqe);
+        }
+
+        return 0;
+}
+
+
+static void *
+posix_uring_reaper (void *data)
+{
+        xlator_t             *this = NULL;
+        struct posix_aio     *aio  = NULL;
+        struct posix_aio_req *req  = NULL;
+        struct io_uring_cqe  *cqe  = NULL;
+        unsigned              head = 0;
+        int                   res  = 0;
+        int                   ret  = 0;
+
+        this = data;
+        THIS = this;
+        aio = ((struct posix_private *)this->private)->aio;
+
+        for (;;) {
+                head = *aio->cq_head;
+                __sync_synchronize ();
+                if (head == *aio->cq_tail) {
+                        LOCK (&aio->lock);
+                        {
+                                ret = (aio->fini && !aio->inflight);
+                        }
+                        UNLOCK (&aio->lock);
+                        if (ret)
+                                break;
+
+                        ret = posix_uring_enter (aio->ring_fd, 0, 1,
+                                                 IORING_ENTER_GETEVENTS);
+                        if (ret < 0 && errno != EINTR) {
+                                gf_log (this->name, GF_LOG_ERROR,
+                                        "io_uring_enter failed: %s",
+                                        strerror (errno));
+                                sleep (1);
+                        }
+                        continue;
+                }
+
+                cqe = &aio->cqes[head & *aio->cq_mask];
+                req = (void *)(unsigned long) cqe->user_data;
+                res = cqe->res;
+
+                __sync_synchronize ();
+                *aio->cq_head = head + 1;
+
+                /* the NOP of posix_aio_fini () only wakes us up */
+                if (!req)
+                        continue;
+
+                /* the write of a linked pair, wait for its fsync */
+                if ((unsigned long) req & POSIX_URING_LINKED) {
+                        req = (void *)((unsigned long) req &
+                                       ~POSIX_URING_LINKED);
+                        req->written = res;
+                        continue;
+                }
+
+                /* like the synchronous path, a failed flush of a
+                   successful write is ignored */
+                if (req->fop == GF_FOP_WRITE && req->flushwrites)
+                        res = req->written;
+
+                posix_aio_done (aio);
+                posix_aio_complete (req, res);
+        }
+
+        return NULL;
+}
+
+#endif /* POSIX_HAVE_URING */
+
+
+#ifdef POSIX_HAVE_LINUX_AIO
+
+static int
+posix_linux_aio_init (xlator_t *this, struct posix_aio *aio)
+{
+        int ret = -1;
+
+        ret = syscall (__NR_io_setup, aio->depth, &aio->aio_ctx);
+        if (ret < 0) {
+                gf_log (this->name, GF_LOG_WARNING,
+                        "io_setup failed: %s", strerror (errno));
+                aio->aio_ctx = 0;
+                return -1;
+        }
+
+        return 0;
+}
+
+
+static void
+posix_linux_aio_fini (struct posix_aio *aio)
+{
+        if (aio->aio_ctx)
+                syscall (__NR_io_destroy, aio->aio_ctx);
+}
+
+
+static int
+__posix_linux_aio_submit (struct posix_aio *aio, struct posix_aio_req *req)
+{
+        struct iocb *iocbp = NULL;
+        int          ret   = -1;
+
+        iocbp = &req->iocb;
+        memset (iocbp, 0, sizeof (*iocbp));
+
+        iocbp->aio_data   = (unsigned long) req;
+        iocbp->aio_fildes = req->_fd;
+
+        switch (req->fop) {
+        case GF_FOP_READ:
+                iocbp->aio_lio_opcode = IOCB_CMD_PREADV;
+                iocbp->aio_buf        = (unsigned long) &req->vec;
+                iocbp->aio_nbytes     = 1;
+                iocbp->aio_offset     = req->offset;
+                break;
+        case GF_FOP_WRITE:
+                iocbp->aio_lio_opcode = IOCB_CMD_PWRITEV;
+                iocbp->aio_buf        = (unsigned long) req->vector;
+                iocbp->aio_nbytes     = req->count;
+                iocbp->aio_offset     = req->offset;
+                break;
+        default:
+                iocbp->aio_lio_opcode = (req->offset) ? IOCB_CMD_FDSYNC
+                                                      : IOCB_CMD_FSYNC;
+                break;
+        }
+
+        /* io_submit fails with EINVAL for fsync on filesystems which
+           cannot do it asynchronously, the caller then does it itself */
+        ret = syscall (__NR_io_submit, aio->aio_ctx, 1, &iocbp);
+        if (ret != 1)
+                return -1;
+
+        return 0;
+}
+
+
+static void *
+posix_linux_aio_reaper (void *data)
+{
+        xlator_t             *this    = NULL;
+        struct posix_aio     *aio     = NULL;
+        struct posix_aio_req *req     = NULL;
+        struct io_event       events[POSIX_AIO_EVENTS];
+        struct timespec       timeout = {0,};
+        int                   count   = 0;
+        int                   i       = 0;
+        int                   ret     = 0;
+
+        this = data;
+        THIS = this;
+        aio = ((struct posix_private *)this->private)->aio;
+
+        for (;;) {
+                LOCK (&aio->lock);
+                {
+                        ret = (aio->fini && !aio->inflight);
+                }
+                UNLOCK (&aio->lock);
+                if (ret)
+                        break;
+
+                /* wake up now and then to notice posix_aio_fini () */
+                timeout.tv_sec  = 1;
+                timeout.tv_nsec = 0;
+
+                count = syscall (__NR_io_getevents, aio->aio_ctx, 1,
+                                 POSIX_AIO_EVENTS, events, &timeout);
+                if (count < 0) {
+                        if (errno != EINTR) {
+                                gf_log (this->name, GF_LOG_ERROR,
+                                        "io_getevents failed: %s",
+                                        strerror (errno));
+                                sleep (1);
+                        }
+                        continue;
+                }
+
+                for (i = 0; i < count; i++) {
+                        req = (void *)(unsigned long) events[i].data;
+                        posix_aio_done (aio);
+                        posix_aio_complete (req, events[i].res);
+                }
+        }
+
+        return NULL;
+}
+
+#endif /* POSIX_HAVE_LINUX_AIO */
+
+
+static int
+posix_aio_submit (xlator_t *this, struct posix_aio_req *req)
+{
+        struct posix_private *priv = NULL;
+        struct posix_aio     *aio  = NULL;
+        int                   ret  = -1;
+
+        priv = this->private;
+        aio = priv->aio;
+
+        LOCK (&aio->lock);
+        {
+                if (aio->fini || aio->inflight >= aio->depth)
+                        goto unlock;
+
+                switch (aio->engine) {
+#ifdef POSIX_HAVE_URING
+                case POSIX_IO_ENGINE_URING:
+                        ret = __posix_uring_submit (aio, req);
+                        break;
+#endif
+#ifdef POSIX_HAVE_LINUX_AIO
+                case POSIX_IO_ENGINE_LINUX_AIO:
+                        ret = __posix_linux_aio_submit (aio, req);
+                        break;
+#endif
+                default:
+                        break;
+                }
+
+                if (ret == 0)
+                        aio->inflight++;
+        }
+unlock:
+        UNLOCK (&aio->lock);
+
+        return ret;
+}
+
+
+int
+posix_aio_readv (call_frame_t *frame, xlator_t *this, fd_t *fd, int _fd,
+                 size_t size, off_t offset)
+{
+        struct posix_private *priv = NULL;
+        struct posix_aio_req *req  = NULL;
+
+        priv = this->private;
+        if (!priv->aio)
+                return -1;
+
+        req = posix_aio_req_new (frame, this, fd, _fd, GF_FOP_READ, offset);
+        if (!req)
+                return -1;
+
+        req->iobuf = iobuf_get2 (this->ctx->iobuf_pool, size);
+        if (!req->iobuf)
+                goto err;
+
+        req->vec.iov_base = req->iobuf->ptr;
+        req->vec.iov_len  = size;
+
+        /* for the post-operation stat of posix_aio_complete () */
+        posix_fill_gfid_fd (this, _fd, &req->preop);
+
+        if (posix_aio_submit (this, req) < 0)
+                goto err;
+
+        return 0;
+err:
+        posix_aio_req_destroy (req);
+        return -1;
+}
+
+
+int
+posix_aio_writev (call_frame_t *frame, xlator_t *this, fd_t *fd, int _fd,
+                  struct iovec *vector, int32_t count, off_t offset,
+                  struct iobref *iobref, struct iatt *preop, int flushwrites)
+{
+        struct posix_private *priv = NULL;
+        struct posix_aio_req *req  = NULL;
+
+        priv = this->private;
+        if (!priv->aio)
+                return -1;
+
+        /* only io_uring can chain the flush to the write, the reaper
+           does no fsync; linux-aio leaves O_SYNC writes to the caller */
+        if (flushwrites && (priv->aio->engine != POSIX_IO_ENGINE_URING))
+                return -1;
+
+        req = posix_aio_req_new (frame, this, fd, _fd, GF_FOP_WRITE, offset);
+        if (!req)
+                return -1;
+
+        /* the caller's vector does not outlive the call */
+        req->vector = GF_CALLOC (count, sizeof (*vector),
+                                 gf_posix_mt_iovec_t);
+        if (!req->vector)
+                goto err;
+        memcpy (req->vector, vector, count * sizeof (*vector));
+        req->count = count;
+
+        if (iobref)
+                req->iobref = iobref_ref (iobref);
+
+        req->preop       = *preop;
+        req->flushwrites = flushwrites;
+
+        if (posix_aio_submit (this, req) < 0)
+                goto err;
+
+        return 0;
+err:
+        posix_aio_req_destroy (req);
+        return -1;
+}
+
+
+int
+posix_aio_fsync (call_frame_t *frame, xlator_t *this, fd_t *fd, int _fd,
+                 int32_t datasync, struct iatt *preop)
+{
+        struct posix_private *priv = NULL;
+        struct posix_aio_req *req  = NULL;
+
+        priv = this->private;
+        if (!priv->aio)
+                return -1;
+
+        /* an fsync has no offset, req->offset carries datasync */
+        req = posix_aio_req_new (frame, this, fd, _fd, GF_FOP_FSYNC,
+                                 (datasync != 0));
+        if (!req)
+                return -1;
+
+        req->preop = *preop;
+
+        if (posix_aio_submit (this, req) < 0)
+                goto err;
+
+        return 0;
+err:
+        posix_aio_req_destroy (req);
+        return -1;
+}
+
+
+const char *
+posix_aio_engine_name (xlator_t *this)
+{
+        struct posix_private *priv = NULL;
+
+        priv = this->private;
+        if (!priv->aio)
+                return "sync";
+
+        if (priv->aio->engine == POSIX_IO_ENGINE_URING)
+                return "io_uring";
+
+        return "linux-aio";
+}
+
+
+static int
+posix_aio_start (xlator_t *this, struct posix_aio *aio)
+{
+        void *(*reaper) (void *) = NULL;
+        int   ret = -1;
+
+        switch (aio->engine) {
+#ifdef POSIX_HAVE_URING
+        case POSIX_IO_ENGINE_URING:
+                ret = posix_uring_init (this, aio);
+                reaper = posix_uring_reaper;
+                break;
+#endif
+#ifdef POSIX_HAVE_LINUX_AIO
+        case POSIX_IO_ENGINE_LINUX_AIO:
+                ret = posix_linux_aio_init (this, aio);
+                reaper = posix_linux_aio_reaper;
+                break;
+#endif
+        default:
+                gf_log (this->name, GF_LOG_WARNING,
+                        "io-engine %s not supported by this build",
+                        (aio->engine == POSIX_IO_ENGINE_URING) ? "io_uring"
+                                                               : "linux-aio");
+                break;
+        }
+
+        if (ret != 0)
+                return -1;
+
+        ret = pthread_create (&aio->reaper, NULL, reaper, this);
+        if (ret != 0) {
+                gf_log (this->name, GF_LOG_ERROR,
+                        "failed to start the io completion thread: %s",
+                        strerror (ret));
+                return -1;
+        }
+
+        return 0;
+}
+
+
+static void
+posix_aio_release (struct posix_aio *aio)
+{
+        switch (aio->engine) {
+#ifdef POSIX_HAVE_URING
+        case POSIX_IO_ENGINE_URING:
+                posix_uring_fini (aio);
+                break;
+#endif
+#ifdef POSIX_HAVE_LINUX_AIO
+        case POSIX_IO_ENGINE_LINUX_AIO:
+                posix_linux_aio_fini (aio);
+                break;
+#endif
+        default:
+                break;
+        }
+
+        LOCK_DESTROY (&aio->lock);
+        GF_FREE (aio);
+}
+
+
+/*
+ * Starts @engine, falling back from io_uring to Linux AIO and from there
+ * to synchronous I/O (priv->aio left NULL) when the kernel refuses.
+ */
+int
+posix_aio_init (xlator_t *this, posix_io_engine_t engine, int depth)
+{
+        struct posix_private *priv = NULL;
+        struct posix_aio     *aio  = NULL;
+
+        priv = this->private;
+
+        while (engine != POSIX_IO_ENGINE_SYNC) {
+                aio = GF_CALLOC (1, sizeof (*aio), gf_posix_mt_aio_t);
+                if (!aio)
+                        return -1;
+
+                LOCK_INIT (&aio->lock);
+                aio->engine = engine;
+                aio->depth  = depth;
+#ifdef POSIX_HAVE_URING
+                aio->ring_fd = -1;
+#endif
+
+                /* the reaper looks the engine up in priv */
+                priv->aio = aio;
+                if (posix_aio_start (this, aio) == 0) {
+                        gf_log (this->name, GF_LOG_INFO,
+                                "using the %s io-engine, depth %d",
+                                posix_aio_engine_name (this), depth);
+                        return 0;
+                }
+
+                priv->aio = NULL;
+                posix_aio_release (aio);
+                aio = NULL;
+
+                if (engine == POSIX_IO_ENGINE_URING) {
+                        gf_log (this->name, GF_LOG_WARNING,
+                                "io_uring unavailable, trying linux-aio");
+                        engine = POSIX_IO_ENGINE_LINUX_AIO;
+                } else {
+                        gf_log (this->name, GF_LOG_WARNING,
+                                "linux-aio unavailable, using synchronous "
+                                "io");
+                        engine = POSIX_IO_ENGINE_SYNC;
+                }
+        }
+
+        return 0;
+}
+
+
+/* waits for the I/O in flight to unwind and stops the engine */
+void
+posix_aio_fini (xlator_t *this)
+{
+        struct posix_private *priv = NULL;
+        struct posix_aio     *aio  = NULL;
+
+        priv = this->private;
+        aio = priv->aio;
+        if (!aio)
+                return;
+
+        LOCK (&aio->lock);
+        {
+                aio->fini = _gf_true;
+#ifdef POSIX_HAVE_URING
+                /* wake the reaper from io_uring_enter */
+                if (aio->engine == POSIX_IO_ENGINE_URING)
+                        __posix_uring_submit (aio, NULL);
+#endif
+        }
+        UNLOCK (&aio->lock);
+
+        pthread_join (aio->reaper, NULL);
+
+        priv->aio = NULL;
+        posix_aio_release (aio);
+}
@@ -0,0 +1,75 @@
+/*
+  Copyright (c) 2011 Gluster, Inc. <http://www.gluster.com>
+  This file is part of GlusterFS.
+
+  GlusterFS is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published
+  by the Free Software Foundation; either version 3 of the License,
+  or (at your option) any later version.
+
+  GlusterFS is distributed in the hope that it will be useful, but
+  WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see
+  <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef _POSIX_AIO_H
+#define _POSIX_AIO_H
+
+#ifndef _CONFIG_H
+#define _CONFIG_H
+#include "config.h"
+#endif
+
+#include "xlator.h"
+
+/*
+ * The asynchronous I/O engine of storage/posix. readv, writev and fsync
+ * are submitted to the kernel, through io_uring or else Linux AIO, and the
+ * submitting thread returns at once. A completion thread unwinds each fop
+ * as the kernel completes it, so the I/Os in flight are bounded by the
+ * depth of the engine instead of the number of io-threads.
+ *
+ * The submit functions return -1 without unwinding when the engine cannot
+ * take the fop (not started, full, or an O_DIRECT write which needs its
+ * bounce buffer); the caller then does the I/O synchronously.
+ */
+
+#define POSIX_AIO_DEPTH_DEFAULT  256
+#define POSIX_AIO_DEPTH_MAX      4096
+
+typedef enum {
+        POSIX_IO_ENGINE_SYNC = 0,
+        POSIX_IO_ENGINE_URING,
+        POSIX_IO_ENGINE_LINUX_AIO,
+} posix_io_engine_t;
+
+struct posix_aio;
+
+int
+posix_aio_init (xlator_t *this, posix_io_engine_t engine, int depth);
+
+void
+posix_aio_fini (xlator_t *this);
+
+const char *
+posix_aio_engine_name (xlator_t *this);
+
+int
+posix_aio_readv (call_frame_t *frame, xlator_t *this, fd_t *fd, int _fd,
+                 size_t size, off_t offset);
+
+int
+posix_aio_writev (call_frame_t *frame, xlator_t *this, fd_t *fd, int _fd,
+                  struct iovec *vector, int32_t count, off_t offset,
+                  struct iobref *iobref, struct iatt *preop, int flushwrites);
+
+int
+posix_aio_fsync (call_frame_t *frame, xlator_t *this, fd_t *fd, int _fd,
+                 int32_t datasync, struct iatt *preop);
+
+#endif /* _POSIX_AIO_H */
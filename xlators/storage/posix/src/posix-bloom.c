@@ -0,0 +1,260 @@
+/*
+  Copyright (c) 2011 Gluster, Inc. <http://www.gluster.com>
+  This file is part of GlusterFS.
+
+  GlusterFS is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published
+  by the Free Software Foundation; either version 3 of the License,
+  or (at your option) any later version.
+
+  GlusterFS is distributed in the hope that it will be useful, but
+  WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see
+  <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef _CONFIG_H
+#define _CONFIG_H
+#include "config.h"
+#endif
+
+#include <errno.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+
+#include "glusterfs.h"
+#include "xlator.h"
+#include "logging.h"
+#include "common-utils.h"
+#include "bloom.h"
+#include "posix.h"
+
+/*
+ * Name filters: a getxattr of GF_BLOOM_XATTR_KEY on a directory returns a
+ * bloom filter of the names in it, for distribute to skip this brick when
+ * it looks a name up everywhere. A filter is built with a scan of the
+ * directory and kept under .glusterfs/bloom/<gfid> along with the ctime
+ * of the directory then, so that it is built again only once the
+ * directory changed, and not on each restart.
+ */
+
+#define POSIX_BLOOM_DIR    GF_HIDDEN_PATH "/bloom"
+#define POSIX_BLOOM_MAGIC  0x50424c4d
+
+/* a filter of a directory changed within this many seconds is not kept,
+   the ctime may not change again on an entry created in the same tick */
+#define POSIX_BLOOM_SETTLE 2
+
+struct posix_bloom_hdr {
+        uint32_t magic;
+        uint32_t size;
+        uint64_t ctime;
+        uint64_t ctime_nsec;
+};
+
+
+static void
+posix_bloom_path (xlator_t *this, uuid_t gfid, char *path, size_t len)
+{
+        char gfid_str[64] = {0,};
+
+        uuid_utoa_r (gfid, gfid_str);
+        snprintf (path, len, "%s/%s/%s", POSIX_BASE_PATH (this),
+                  POSIX_BLOOM_DIR, gfid_str);
+}
+
+
+static gf_bloom_t *
+posix_bloom_load (xlator_t *this, uuid_t gfid, struct stat *stbuf)
+{
+        struct posix_bloom_hdr  hdr         = {0,};
+        char                    path[PATH_MAX] = {0,};
+        gf_bloom_t             *bloom       = NULL;
+        char                   *buf         = NULL;
+        int                     fd          = -1;
+
+        posix_bloom_path (this, gfid, path, sizeof (path));
+
+        fd = open (path, O_RDONLY);
+        if (fd == -1)
+                return NULL;
+
+        if ((read (fd, &hdr, sizeof (hdr)) != sizeof (hdr)) ||
+            (hdr.magic != POSIX_BLOOM_MAGIC) ||
+            (hdr.ctime != stbuf->st_ctime) ||
+            (hdr.ctime_nsec != ST_CTIM_NSEC (stbuf)) ||
+            (hdr.size > sizeof (gf_bloom_t) + GF_BLOOM_MAX_BITS / 8))
+                goto out;
+
+        buf = GF_CALLOC (1, hdr.size, gf_posix_mt_char);
+        if (!buf)
+                goto out;
+
+        if (read (fd, buf, hdr.size) != hdr.size)
+                goto out;
+
+        bloom = gf_bloom_dup (buf, hdr.size);
+out:
+        GF_FREE (buf);
+        close (fd);
+
+        return bloom;
+}
+
+
+static void
+posix_bloom_store (xlator_t *this, uuid_t gfid, struct stat *stbuf,
+                   gf_bloom_t *bloom)
+{
+        struct posix_bloom_hdr  hdr               = {0,};
+        char                    path[PATH_MAX]    = {0,};
+        char                    tmp[PATH_MAX + 8] = {0,};
+        int                     fd                = -1;
+        int                     ret               = -1;
+
+        if (time (NULL) - stbuf->st_ctime < POSIX_BLOOM_SETTLE)
+                return;
+
+        /* getxattrs of the same directory may store its filter at once,
+           each writes a temporary file of its own and renames it over */
+        posix_bloom_path (this, gfid, path, sizeof (path));
+        snprintf (tmp, sizeof (tmp), "%s.XXXXXX", path);
+
+        fd = mkstemp (tmp);
+        if ((fd == -1) && (errno == ENOENT)) {
+                snprintf (path, sizeof (path), "%s/%s", POSIX_BASE_PATH (this),
+                          GF_HIDDEN_PATH);
+                mkdir (path, 0700);
+                snprintf (path, sizeof (path), "%s/%s", POSIX_BASE_PATH (this),
+                          POSIX_BLOOM_DIR);
+                mkdir (path, 0700);
+
+                posix_bloom_path (this, gfid, path, sizeof (path));
+                snprintf (tmp, sizeof (tmp), "%s.XXXXXX", path);
+                fd = mkstemp (tmp);
+        }
+        if (fd == -1) {
+                gf_log (this->name, GF_LOG_DEBUG, "could not keep the name "
+                        "filter in %s: %s", tmp, strerror (errno));
+                return;
+        }
+
+        hdr.magic      = POSIX_BLOOM_MAGIC;
+        hdr.size       = gf_bloom_size (bloom);
+        hdr.ctime      = stbuf->st_ctime;
+        hdr.ctime_nsec = ST_CTIM_NSEC (stbuf);
+
+        if ((write (fd, &hdr, sizeof (hdr)) == sizeof (hdr)) &&
+            (write (fd, bloom, hdr.size) == hdr.size))
+                ret = 0;
+
+        close (fd);
+
+        if (ret == 0)
+                ret = rename (tmp, path);
+        if (ret == -1)
+                unlink (tmp);
+}
+
+
+/* two passes over the directory: one to size the filter, one to fill it */
+static gf_bloom_t *
+posix_bloom_build (xlator_t *this, const char *real_path)
+{
+        gf_bloom_t    *bloom = NULL;
+        DIR           *dir   = NULL;
+        struct dirent *entry = NULL;
+        uint32_t       count = 0;
+
+        dir = opendir (real_path);
+        if (!dir) {
+                gf_log (this->name, GF_LOG_DEBUG, "opendir of %s failed: %s",
+                        real_path, strerror (errno));
+                return NULL;
+        }
+
+        while ((entry = readdir (dir)))
+                count++;
+
+        bloom = gf_bloom_new (count);
+        if (!bloom)
+                goto out;
+
+        rewinddir (dir);
+        while ((entry = readdir (dir))) {
+                if (!strcmp (entry->d_name, ".") ||
+                    !strcmp (entry->d_name, ".."))
+                        continue;
+                gf_bloom_add (bloom, entry->d_name);
+        }
+out:
+        closedir (dir);
+
+        return bloom;
+}
+
+
+/* sets the name filter of the directory in @dict; its size, or -1 */
+int
+posix_bloom_get (xlator_t *this, const char *real_path, inode_t *inode,
+                 dict_t *dict)
+{
+        struct stat  stbuf = {0,};
+        gf_bloom_t  *bloom = NULL;
+        gf_boolean_t kept  = _gf_false;
+        int          size  = 0;
+        int          ret   = -1;
+
+        ret = lstat (real_path, &stbuf);
+        if (ret == -1)
+                return -1;
+
+        if (!S_ISDIR (stbuf.st_mode)) {
+                errno = ENOTDIR;
+                return -1;
+        }
+
+        kept = !uuid_is_null (inode->gfid);
+
+        if (kept)
+                bloom = posix_bloom_load (this, inode->gfid, &stbuf);
+
+        if (!bloom) {
+                bloom = posix_bloom_build (this, real_path);
+                if (!bloom) {
+                        errno = ENOMEM;
+                        return -1;
+                }
+
+                if (kept)
+                        posix_bloom_store (this, inode->gfid, &stbuf, bloom);
+        }
+
+        size = gf_bloom_size (bloom);
+
+        ret = dict_set_bin (dict, GF_BLOOM_XATTR_KEY, bloom, size);
+        if (ret < 0) {
+                GF_FREE (bloom);
+                errno = ENOMEM;
+                return -1;
+        }
+
+        return size;
+}
+
+
+void
+posix_bloom_forget (xlator_t *this, uuid_t gfid)
+{
+        char path[PATH_MAX] = {0,};
+
+        if (uuid_is_null (gfid))
+                return;
+
+        posix_bloom_path (this, gfid, path, sizeof (path));
+        unlink (path);
+}
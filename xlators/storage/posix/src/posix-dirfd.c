@@ -0,0 +1,550 @@
+/*
+  Copyright (c) 2011 Gluster, Inc. <http://www.gluster.com>
+  This file is part of GlusterFS.
+
+  GlusterFS is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published
+  by the Free Software Foundation; either version 3 of the License,
+  or (at your option) any later version.
+
+  GlusterFS is distributed in the hope that it will be useful, but
+  WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see
+  <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef _CONFIG_H
+#define _CONFIG_H
+#include "config.h"
+#endif
+
+#include <errno.h>
+#include <fcntl.h>
+#include <libgen.h>
+#include <sys/stat.h>
+
+#include "glusterfs.h"
+#include "xlator.h"
+#include "logging.h"
+#include "locking.h"
+#include "syscall.h"
+#include "posix.h"
+
+/*
+ * The entry fops (lookup, create, mkdir, unlink...) name their target by
+ * path, and every lstat/open/unlink of that path makes the kernel walk it
+ * again from the export directory. Here the parent directories are kept
+ * open, found by gfid, so that the fops can work with fstat() on the
+ * parent and fstatat()/openat()/unlinkat() on the entry instead.
+ *
+ * At most dirfd_limit directories are held; the least recently used one
+ * not in use is closed to make room. A handle in use when its directory
+ * is removed is unhashed at once and closed on its last put.
+ *
+ * A call relative to a handle skips the search permission checks of the
+ * ancestors of the directory, which a walk of the path under the caller's
+ * fsuid makes. So handles serve only fops run as root, for whom those
+ * checks do not apply, or not under the caller's credentials at all
+ * (lookup). And a fop using a handle does all its steps through it: the
+ * calls with no *at() variant (xattrs, chown) are given the path of the
+ * entry under /proc/self/fd/<handle>, never the path from the export,
+ * which may lead elsewhere by now.
+ */
+
+static struct list_head *
+__posix_dirfd_bucket (struct posix_private *priv, uuid_t gfid)
+{
+        return &priv->dirfd_hash[(gfid[15] + (gfid[14] << 8))
+                                 % POSIX_DIRFD_HASH_SIZE];
+}
+
+
+static struct posix_dirfd *
+__posix_dirfd_find (struct posix_private *priv, uuid_t gfid)
+{
+        struct posix_dirfd *dirfd = NULL;
+
+        list_for_each_entry (dirfd, __posix_dirfd_bucket (priv, gfid), hash) {
+                if (!uuid_compare (dirfd->gfid, gfid))
+                        return dirfd;
+        }
+
+        return NULL;
+}
+
+
+/* a held handle of @gfid, counted as a hit */
+static struct posix_dirfd *
+posix_dirfd_lookup (struct posix_private *priv, uuid_t gfid)
+{
+        struct posix_dirfd *dirfd = NULL;
+
+        LOCK (&priv->dirfd_lock);
+        {
+                dirfd = __posix_dirfd_find (priv, gfid);
+                if (dirfd) {
+                        dirfd->ref++;
+                        list_move_tail (&dirfd->lru, &priv->dirfd_lru);
+                        priv->dirfd_hits++;
+                } else {
+                        priv->dirfd_misses++;
+                }
+        }
+        UNLOCK (&priv->dirfd_lock);
+
+        return dirfd;
+}
+
+
+static void
+__posix_dirfd_unhash (struct posix_private *priv, struct posix_dirfd *dirfd)
+{
+        list_del_init (&dirfd->hash);
+        list_del_init (&dirfd->lru);
+        dirfd->unhashed = _gf_true;
+        priv->dirfd_count--;
+}
+
+
+static void
+posix_dirfd_destroy (struct posix_dirfd *dirfd)
+{
+        close (dirfd->fd);
+        GF_FREE (dirfd);
+}
+
+
+/* makes room for one more handle; returns the one to close, if any */
+static struct posix_dirfd *
+__posix_dirfd_evict (struct posix_private *priv)
+{
+        struct posix_dirfd *dirfd = NULL;
+
+        list_for_each_entry (dirfd, &priv->dirfd_lru, lru) {
+                if (dirfd->ref)
+                        continue;
+
+                __posix_dirfd_unhash (priv, dirfd);
+                return dirfd;
+        }
+
+        return NULL;
+}
+
+
+int
+posix_dirfd_init (xlator_t *this)
+{
+        struct posix_private *priv = NULL;
+        int                   i    = 0;
+
+        priv = this->private;
+
+        LOCK_INIT (&priv->dirfd_lock);
+        INIT_LIST_HEAD (&priv->dirfd_lru);
+
+        if (!priv->dirfd_limit)
+                return 0;
+
+        if (access (POSIX_DIRFD_PROC_PATH, X_OK) == -1) {
+                gf_log (this->name, GF_LOG_WARNING, "%s not available (%s), "
+                        "directory handles disabled", POSIX_DIRFD_PROC_PATH,
+                        strerror (errno));
+                priv->dirfd_limit = 0;
+                return 0;
+        }
+
+        priv->dirfd_hash = GF_CALLOC (POSIX_DIRFD_HASH_SIZE,
+                                      sizeof (struct list_head),
+                                      gf_common_mt_list_head);
+        if (!priv->dirfd_hash) {
+                priv->dirfd_limit = 0;
+                return -1;
+        }
+
+        for (i = 0; i < POSIX_DIRFD_HASH_SIZE; i++)
+                INIT_LIST_HEAD (&priv->dirfd_hash[i]);
+
+        return 0;
+}
+
+
+void
+posix_dirfd_fini (xlator_t *this)
+{
+        struct posix_private *priv  = NULL;
+        struct posix_dirfd   *dirfd = NULL;
+        struct posix_dirfd   *tmp   = NULL;
+
+        priv = this->private;
+        if (!priv->dirfd_hash)
+                return;
+
+        list_for_each_entry_safe (dirfd, tmp, &priv->dirfd_lru, lru) {
+                list_del_init (&dirfd->hash);
+                list_del_init (&dirfd->lru);
+                posix_dirfd_destroy (dirfd);
+        }
+
+        GF_FREE (priv->dirfd_hash);
+        priv->dirfd_hash = NULL;
+        priv->dirfd_count = 0;
+        LOCK_DESTROY (&priv->dirfd_lock);
+}
+
+
+/* opens the directory of @gfid at @path and holds it, on a miss */
+static struct posix_dirfd *
+posix_dirfd_open (xlator_t *this, uuid_t gfid, const char *path)
+{
+        struct posix_private *priv    = NULL;
+        struct posix_dirfd   *dirfd   = NULL;
+        struct posix_dirfd   *evicted = NULL;
+        uuid_t                ondisk  = {0,};
+        int                   fd      = -1;
+
+        priv = this->private;
+
+        fd = open (path, O_RDONLY | O_DIRECTORY | O_NOFOLLOW);
+        if (fd == -1) {
+                gf_log (this->name, GF_LOG_DEBUG,
+                        "open of directory %s failed: %s", path,
+                        strerror (errno));
+                return NULL;
+        }
+
+        /* the export directory need not have its gfid set */
+        if (!__is_root_gfid (gfid)
+            && ((sys_fgetxattr (fd, GFID_XATTR_KEY, ondisk, 16) != 16)
+                || uuid_compare (ondisk, gfid))) {
+                gf_log (this->name, GF_LOG_DEBUG,
+                        "%s is not the directory of gfid %s", path,
+                        uuid_utoa (gfid));
+                close (fd);
+                return NULL;
+        }
+
+        LOCK (&priv->dirfd_lock);
+        {
+                /* another fop may have opened it meanwhile */
+                dirfd = __posix_dirfd_find (priv, gfid);
+                if (dirfd) {
+                        dirfd->ref++;
+                        list_move_tail (&dirfd->lru, &priv->dirfd_lru);
+                        goto unlock;
+                }
+
+                if (priv->dirfd_count >= priv->dirfd_limit)
+                        evicted = __posix_dirfd_evict (priv);
+
+                dirfd = GF_CALLOC (1, sizeof (*dirfd), gf_posix_mt_dirfd_t);
+                if (!dirfd)
+                        goto unlock;
+
+                uuid_copy (dirfd->gfid, gfid);
+                dirfd->fd  = fd;
+                dirfd->ref = 1;
+                fd = -1;
+                INIT_LIST_HEAD (&dirfd->hash);
+                INIT_LIST_HEAD (&dirfd->lru);
+
+                /* all held ones are in use: hand out an uncached handle */
+                if (priv->dirfd_count >= priv->dirfd_limit) {
+                        dirfd->unhashed = _gf_true;
+                        goto unlock;
+                }
+
+                list_add (&dirfd->hash, __posix_dirfd_bucket (priv, gfid));
+                list_add_tail (&dirfd->lru, &priv->dirfd_lru);
+                priv->dirfd_count++;
+        }
+unlock:
+        UNLOCK (&priv->dirfd_lock);
+
+        if (fd != -1)
+                close (fd);
+        if (evicted)
+                posix_dirfd_destroy (evicted);
+
+        return dirfd;
+}
+
+
+/* handles are for fops run as root, or with the brick's credentials
+   (NULL @frame) */
+static gf_boolean_t
+posix_dirfd_allowed (call_frame_t *frame)
+{
+        return (!frame || (frame->root->uid == 0));
+}
+
+
+/*
+ * Returns the open directory of gfid @gfid, opening @path on a miss. The
+ * directory found at @path must carry @gfid, so a path which no longer
+ * leads to that directory is not cached. NULL when the cache is disabled,
+ * the fop of @frame may not use it, or the directory cannot be opened;
+ * the caller then works by path.
+ */
+struct posix_dirfd *
+posix_dirfd_get (xlator_t *this, call_frame_t *frame, uuid_t gfid,
+                 const char *path)
+{
+        struct posix_private *priv  = NULL;
+        struct posix_dirfd   *dirfd = NULL;
+
+        priv = this->private;
+        if (!priv->dirfd_limit || uuid_is_null (gfid)
+            || !posix_dirfd_allowed (frame))
+                return NULL;
+
+        dirfd = posix_dirfd_lookup (priv, gfid);
+        if (dirfd)
+                return dirfd;
+
+        return posix_dirfd_open (this, gfid, path);
+}
+
+
+/*
+ * The handle of the parent of @loc, for the *at() calls on loc->name.
+ * NULL when the fop of @frame may not use one, the parent gfid is not
+ * known or loc->name is not the last component of loc->path.
+ */
+struct posix_dirfd *
+posix_parent_dirfd (xlator_t *this, call_frame_t *frame, loc_t *loc,
+                    const char *real_path)
+{
+#ifdef GF_LINUX_HOST_OS
+        struct posix_private *priv       = NULL;
+        unsigned char        *pargfid    = NULL;
+        char                 *pathdup    = NULL;
+        struct posix_dirfd   *dirfd      = NULL;
+        size_t                path_len   = 0;
+        size_t                name_len   = 0;
+
+        priv = this->private;
+        if (!priv->dirfd_limit || !loc->path || !loc->name || !*loc->name
+            || !posix_dirfd_allowed (frame))
+                return NULL;
+
+        path_len = strlen (loc->path);
+        name_len = strlen (loc->name);
+        if ((name_len >= path_len)
+            || strcmp (loc->path + path_len - name_len, loc->name)
+            || (loc->path[path_len - name_len - 1] != '/'))
+                return NULL;
+
+        pargfid = loc->pargfid;
+        if (uuid_is_null (pargfid) && loc->parent)
+                pargfid = loc->parent->gfid;
+        if (uuid_is_null (pargfid))
+                return NULL;
+
+        /* a hit does not need the path of the parent */
+        dirfd = posix_dirfd_lookup (priv, pargfid);
+        if (dirfd)
+                return dirfd;
+
+        pathdup = gf_strdup (real_path);
+        if (!pathdup)
+                return NULL;
+
+        dirfd = posix_dirfd_open (this, pargfid, dirname (pathdup));
+
+        GF_FREE (pathdup);
+
+        return dirfd;
+#else
+        return NULL;
+#endif
+}
+
+
+void
+posix_dirfd_put (xlator_t *this, struct posix_dirfd *dirfd)
+{
+        struct posix_private *priv    = NULL;
+        gf_boolean_t          destroy = _gf_false;
+
+        if (!dirfd)
+                return;
+
+        priv = this->private;
+
+        LOCK (&priv->dirfd_lock);
+        {
+                dirfd->ref--;
+                destroy = (dirfd->unhashed && !dirfd->ref);
+        }
+        UNLOCK (&priv->dirfd_lock);
+
+        if (destroy)
+                posix_dirfd_destroy (dirfd);
+}
+
+
+/* drops the handle of a directory which is removed or replaced */
+void
+posix_dirfd_forget (xlator_t *this, uuid_t gfid)
+{
+        struct posix_private *priv    = NULL;
+        struct posix_dirfd   *dirfd   = NULL;
+        gf_boolean_t          destroy = _gf_false;
+
+        priv = this->private;
+        if (!priv->dirfd_limit || uuid_is_null (gfid))
+                return;
+
+        LOCK (&priv->dirfd_lock);
+        {
+                dirfd = __posix_dirfd_find (priv, gfid);
+                if (dirfd) {
+                        __posix_dirfd_unhash (priv, dirfd);
+                        destroy = !dirfd->ref;
+                }
+        }
+        UNLOCK (&priv->dirfd_lock);
+
+        if (destroy)
+                posix_dirfd_destroy (dirfd);
+}
+
+
+/* the *at() variants of the calls of the entry fops, by path without a
+   parent handle */
+
+/* the path of loc->name through the parent handle, into @buf, for the
+   calls which have no *at() variant; @real_path without a handle */
+char *
+posix_entry_path (struct posix_dirfd *pdirfd, loc_t *loc, char *real_path,
+                  char *buf, size_t size)
+{
+        int len = 0;
+
+        if (!pdirfd)
+                return real_path;
+
+        len = snprintf (buf, size, "%s/%d/%s", POSIX_DIRFD_PROC_PATH,
+                        pdirfd->fd, loc->name);
+        if ((len < 0) || (len >= size))
+                return real_path;
+
+        return buf;
+}
+
+
+int
+posix_entry_stat (xlator_t *this, struct posix_dirfd *pdirfd, loc_t *loc,
+                  const char *real_path, struct iatt *buf)
+{
+#ifdef GF_LINUX_HOST_OS
+        char  entry_buf[PATH_MAX] = {0,};
+        char *entry_path          = NULL;
+
+        if (pdirfd) {
+                /* the gfid is read through the handle too */
+                entry_path = posix_entry_path (pdirfd, loc, (char *)real_path,
+                                               entry_buf, sizeof (entry_buf));
+                return posix_fstatat_with_gfid (this, pdirfd->fd, loc->name,
+                                                entry_path, buf);
+        }
+#endif
+        return posix_lstat_with_gfid (this, real_path, buf);
+}
+
+
+/* setgid_override(), with the parent's attributes from its handle */
+int
+posix_entry_setgid_override (xlator_t *this, struct posix_dirfd *pdirfd,
+                             char *real_path, gid_t *gid)
+{
+        struct iatt parent = {0,};
+
+        if (!pdirfd)
+                return setgid_override (this, real_path, gid);
+
+        if (posix_fstat_with_gfid (this, pdirfd->fd, &parent) == -1)
+                return -errno;
+
+        if (parent.ia_prot.sgid)
+                *gid = parent.ia_gid;
+
+        return 0;
+}
+
+
+int
+posix_parent_stat (xlator_t *this, struct posix_dirfd *pdirfd,
+                   const char *parentpath, struct iatt *buf)
+{
+        if (pdirfd)
+                return posix_fstat_with_gfid (this, pdirfd->fd, buf);
+
+        return posix_lstat_with_gfid (this, parentpath, buf);
+}
+
+
+int
+posix_entry_open (struct posix_dirfd *pdirfd, loc_t *loc,
+                  const char *real_path, int flags, mode_t mode)
+{
+#ifdef GF_LINUX_HOST_OS
+        if (pdirfd)
+                return openat (pdirfd->fd, loc->name, flags, mode);
+#endif
+        return open (real_path, flags, mode);
+}
+
+
+int
+posix_entry_mkdir (struct posix_dirfd *pdirfd, loc_t *loc,
+                   const char *real_path, mode_t mode)
+{
+#ifdef GF_LINUX_HOST_OS
+        if (pdirfd)
+                return mkdirat (pdirfd->fd, loc->name, mode);
+#endif
+        return mkdir (real_path, mode);
+}
+
+
+int
+posix_entry_unlink (struct posix_dirfd *pdirfd, loc_t *loc,
+                    const char *real_path)
+{
+#ifdef GF_LINUX_HOST_OS
+        if (pdirfd)
+                return unlinkat (pdirfd->fd, loc->name, 0);
+#endif
+        return sys_unlink (real_path);
+}
+
+
+/* xattr calls on a directory, through its handle when it has one */
+
+ssize_t
+posix_dirfd_getxattr (struct posix_dirfd *dirfd, const char *path,
+                      const char *key, void *value, size_t size)
+{
+        if (dirfd)
+                return sys_fgetxattr (dirfd->fd, key, value, size);
+
+        return sys_lgetxattr (path, key, value, size);
+}
+
+
+ssize_t
+posix_dirfd_listxattr (struct posix_dirfd *dirfd, const char *path,
+                       char *list, size_t size)
+{
+        if (dirfd)
+                return sys_flistxattr (dirfd->fd, list, size);
+
+        return sys_llistxattr (path, list, size);
+}
+
@@ -0,0 +1,333 @@
+/*
+  Copyright (c) 2011 Gluster, Inc. <http://www.gluster.com>
+  This file is part of GlusterFS.
+
+  GlusterFS is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published
+  by the Free Software Foundation; either version 3 of the License,
+  or (at your option) any later version.
+
+  GlusterFS is distributed in the hope that it will be useful, but
+  WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see
+  <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef _CONFIG_H
+#define _CONFIG_H
+#include "config.h"
+#endif
+
+#include <errno.h>
+#include <sys/time.h>
+
+#include "glusterfs.h"
+#include "xlator.h"
+#include "logging.h"
+#include "posix.h"
+
+/*
+ * Group commit: every fsync is a journal commit of the backend filesystem,
+ * and concurrent ones (NFS COMMITs, replicated databases) mostly wait for
+ * each other. With a batch-fsync-delay, fsyncs and the writes of O_SYNC
+ * fds are queued instead, and a single thread completes all those queued
+ * within the delay of the first: with one syncfs of the brick's
+ * filesystem, or with one fsync (fdatasync if all asked only for that) per
+ * file, in the order the files were first synced.
+ *
+ * syncfs reports no error of a file in particular, so it is followed by
+ * one fdatasync per file of the batch: with the data already on disk
+ * they cost little, and each fsync gets the error of its own file.
+ */
+
+static void
+posix_fsync_req_unwind (xlator_t *this, struct posix_fsync_req *req)
+{
+        struct iatt postop   = {0,};
+        int32_t     op_ret   = -1;
+        int32_t     op_errno = 0;
+
+        if (req->op_errno) {
+                op_errno = req->op_errno;
+                goto out;
+        }
+
+        op_ret = posix_fstat_with_gfid (this, req->_fd, &postop);
+        if (op_ret == -1) {
+                op_errno = errno;
+                gf_log (this->name, GF_LOG_ERROR,
+                        "post-operation fstat failed on fd=%p: %s",
+                        req->fd, strerror (op_errno));
+                goto out;
+        }
+
+        op_ret = (req->fop == GF_FOP_WRITE) ? req->op_ret : 0;
+out:
+        if (req->fop == GF_FOP_WRITE)
+                STACK_UNWIND_STRICT (writev, req->frame, op_ret, op_errno,
+                                     &req->preop, &postop);
+        else
+                STACK_UNWIND_STRICT (fsync, req->frame, op_ret, op_errno,
+                                     &req->preop, &postop);
+
+        fd_unref (req->fd);
+        GF_FREE (req);
+}
+
+
+/* one sync per file of the batch, in the order of their first request.
+   After a syncfs (synced), only an fdatasync to collect the errors. */
+static void
+posix_fsync_batch_files (xlator_t *this, struct list_head *batch,
+                         gf_boolean_t synced)
+{
+        struct posix_fsync_req *req      = NULL;
+        struct posix_fsync_req *same     = NULL;
+        struct list_head       *pos      = NULL;
+        int32_t                 datasync = 0;
+        int                     ret      = 0;
+        int                     op_errno = 0;
+
+        list_for_each_entry (req, batch, list) {
+                if (req->synced)
+                        continue;
+
+                /* a write of an O_SYNC fd needs its metadata too */
+                datasync = (req->fop == GF_FOP_FSYNC) && req->datasync;
+                for (pos = req->list.next; pos != batch; pos = pos->next) {
+                        same = list_entry (pos, struct posix_fsync_req, list);
+                        if (same->_fd != req->_fd)
+                                continue;
+                        if ((same->fop != GF_FOP_FSYNC) || !same->datasync)
+                                datasync = 0;
+                }
+                /* the syncfs has written the metadata */
+                if (synced)
+                        datasync = 1;
+
+#ifdef HAVE_FDATASYNC
+                if (datasync)
+                        ret = fdatasync (req->_fd);
+                else
+#endif
+                        ret = fsync (req->_fd);
+                op_errno = (ret == -1) ? errno : 0;
+                if (op_errno)
+                        gf_log (this->name, GF_LOG_ERROR,
+                                "%s on fd=%p failed: %s",
+                                datasync ? "fdatasync" : "fsync", req->fd,
+                                strerror (op_errno));
+
+                for (pos = &req->list; pos != batch; pos = pos->next) {
+                        same = list_entry (pos, struct posix_fsync_req, list);
+                        if (same->_fd != req->_fd)
+                                continue;
+                        same->synced = _gf_true;
+                        /* O_SYNC writes ignore the error, as when done
+                           one by one */
+                        if (same->fop == GF_FOP_FSYNC)
+                                same->op_errno = op_errno;
+                }
+        }
+}
+
+
+static void
+posix_fsync_batch (xlator_t *this, struct list_head *batch)
+{
+        struct posix_private   *priv  = NULL;
+        struct posix_fsync_req *req   = NULL;
+        struct posix_fsync_req *tmp   = NULL;
+        struct timeval          start = {0,};
+        struct timeval          end   = {0,};
+        uint64_t                usec  = 0;
+        int                     count = 0;
+        int                     ret   = -1;
+
+        priv = this->private;
+
+        list_for_each_entry (req, batch, list)
+                count++;
+
+        gettimeofday (&start, NULL);
+
+#ifdef HAVE_SYNCFS
+        if (priv->batch_fsync_mode == POSIX_BATCH_FSYNC_SYNCFS) {
+                req = list_entry (batch->next, struct posix_fsync_req, list);
+                ret = syncfs (req->_fd);
+                if (ret == -1)
+                        gf_log (this->name, GF_LOG_WARNING,
+                                "syncfs failed (%s), syncing the %d files "
+                                "one by one", strerror (errno), count);
+        }
+#endif
+        posix_fsync_batch_files (this, batch, (ret == 0));
+
+        gettimeofday (&end, NULL);
+        usec = (end.tv_sec - start.tv_sec) * 1000000
+                + end.tv_usec - start.tv_usec;
+
+        LOCK (&priv->lock);
+        {
+                priv->fsync_batches++;
+                priv->fsync_batched += count;
+                if (count > priv->fsync_batch_max)
+                        priv->fsync_batch_max = count;
+                priv->fsync_batch_usec += usec;
+                if (usec > priv->fsync_batch_usec_max)
+                        priv->fsync_batch_usec_max = usec;
+        }
+        UNLOCK (&priv->lock);
+
+        gf_log (this->name, GF_LOG_TRACE, "synced a batch of %d in %"PRIu64
+                " usec", count, usec);
+
+        list_for_each_entry_safe (req, tmp, batch, list) {
+                list_del_init (&req->list);
+                posix_fsync_req_unwind (this, req);
+        }
+}
+
+
+static void *
+posix_fsyncer (void *data)
+{
+        xlator_t             *this  = NULL;
+        struct posix_private *priv  = NULL;
+        gf_boolean_t          stop  = _gf_false;
+        struct list_head      batch;
+
+        this = data;
+        priv = this->private;
+        THIS = this;
+
+        for (;;) {
+                INIT_LIST_HEAD (&batch);
+
+                pthread_mutex_lock (&priv->fsync_lock);
+                {
+                        while (list_empty (&priv->fsyncs) && !priv->fsync_fini)
+                                pthread_cond_wait (&priv->fsync_cond,
+                                                   &priv->fsync_lock);
+                        stop = priv->fsync_fini;
+                }
+                pthread_mutex_unlock (&priv->fsync_lock);
+
+                /* let the fsyncs arriving meanwhile join this batch */
+                if (!stop)
+                        usleep (priv->batch_fsync_delay_usec);
+
+                pthread_mutex_lock (&priv->fsync_lock);
+                {
+                        list_splice_init (&priv->fsyncs, &batch);
+                }
+                pthread_mutex_unlock (&priv->fsync_lock);
+
+                if (list_empty (&batch))
+                        break;
+
+                posix_fsync_batch (this, &batch);
+        }
+
+        return NULL;
+}
+
+
+/* queues an fsync, or an O_SYNC write already written, for the next batch;
+   -1 when batching is off and the caller syncs by itself */
+int
+posix_fsync_enqueue (call_frame_t *frame, xlator_t *this, fd_t *fd, int _fd,
+                     glusterfs_fop_t fop, int32_t datasync, int32_t op_ret,
+                     struct iatt *preop)
+{
+        struct posix_private   *priv = NULL;
+        struct posix_fsync_req *req  = NULL;
+
+        priv = this->private;
+
+        if (!priv->fsyncer_running)
+                return -1;
+
+        req = GF_CALLOC (1, sizeof (*req), gf_posix_mt_fsync_req_t);
+        if (!req)
+                return -1;
+
+        req->frame    = frame;
+        req->fd       = fd_ref (fd);
+        req->_fd      = _fd;
+        req->fop      = fop;
+        req->datasync = datasync;
+        req->op_ret   = op_ret;
+        req->preop    = *preop;
+        INIT_LIST_HEAD (&req->list);
+
+        pthread_mutex_lock (&priv->fsync_lock);
+        {
+                list_add_tail (&req->list, &priv->fsyncs);
+                pthread_cond_signal (&priv->fsync_cond);
+        }
+        pthread_mutex_unlock (&priv->fsync_lock);
+
+        return 0;
+}
+
+
+int
+posix_fsync_init (xlator_t *this)
+{
+        struct posix_private *priv = NULL;
+        int                   ret  = 0;
+
+        priv = this->private;
+
+        pthread_mutex_init (&priv->fsync_lock, NULL);
+        pthread_cond_init (&priv->fsync_cond, NULL);
+        INIT_LIST_HEAD (&priv->fsyncs);
+
+        if (priv->batch_fsync_delay_usec == 0)
+                return 0;
+
+        ret = pthread_create (&priv->fsyncer, NULL, posix_fsyncer, this);
+        if (ret != 0) {
+                gf_log (this->name, GF_LOG_WARNING,
+                        "could not start the fsync thread (%s), syncing "
+                        "each fsync by itself", strerror (ret));
+                return -1;
+        }
+
+        priv->fsyncer_running = _gf_true;
+
+        gf_log (this->name, GF_LOG_INFO, "batching fsyncs over %u usec "
+                "with %s", priv->batch_fsync_delay_usec,
+                (priv->batch_fsync_mode == POSIX_BATCH_FSYNC_SYNCFS) ?
+                "syncfs" : "fsync");
+
+        return 0;
+}
+
+
+/* completes what is queued, then stops the thread */
+void
+posix_fsync_fini (xlator_t *this)
+{
+        struct posix_private *priv = NULL;
+
+        priv = this->private;
+
+        if (!priv->fsyncer_running)
+                return;
+
+        pthread_mutex_lock (&priv->fsync_lock);
+        {
+                priv->fsync_fini = _gf_true;
+                pthread_cond_broadcast (&priv->fsync_cond);
+        }
+        pthread_mutex_unlock (&priv->fsync_lock);
+
+        pthread_join (priv->fsyncer, NULL);
+        priv->fsyncer_running = _gf_false;
+}
@@ -37,6 +37,10 @@
 #include <alloca.h>
 #endif /* GF_BSD_HOST_OS */
 
+#ifdef GF_LINUX_HOST_OS
+#include <fcntl.h>
+#endif /* GF_LINUX_HOST_OS */
+
 #include "glusterfs.h"
 #include "md5.h"
 #include "checksum.h"
@@ -289,6 +293,41 @@ out:
 }
 
 
+#ifdef GF_LINUX_HOST_OS
+/*
+ * stats @name relative to the open directory @dirfd, which spares the
+ * kernel a walk of the whole path. There is no getxattr relative to a
+ * directory, and opening every entry for fgetxattr() costs more than the
+ * walk, so the gfid is still read through @path.
+ */
+int
+posix_fstatat_with_gfid (xlator_t *this, int dirfd, const char *name,
+                         const char *path, struct iatt *stbuf_p)
+{
+        int                    ret     = 0;
+        struct stat            lstatbuf = {0, };
+        struct iatt            stbuf = {0, };
+
+        ret = fstatat (dirfd, name, &lstatbuf, AT_SYMLINK_NOFOLLOW);
+        if (ret == -1)
+                goto out;
+
+        iatt_from_stat (&stbuf, &lstatbuf);
+
+        ret = posix_fill_gfid_path (this, path, &stbuf);
+        if (ret)
+                gf_log_callingfn (this->name, GF_LOG_DEBUG, "failed to get gfid");
+
+        posix_fill_ino_from_gfid (this, &stbuf);
+
+        if (stbuf_p)
+                *stbuf_p = stbuf;
+out:
+        return ret;
+}
+#endif /* GF_LINUX_HOST_OS */
+
+
 int
 posix_fstat_with_gfid (xlator_t *this, int fd, struct iatt *stbuf_p)
 {
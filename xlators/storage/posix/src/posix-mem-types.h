@@ -30,6 +30,13 @@ enum gf_posix_mem_types_ {
         gf_posix_mt_int32_t,
         gf_posix_mt_posix_dev_t,
         gf_posix_mt_trash_path,
+        gf_posix_mt_dirent_ptr_t,
+        gf_posix_mt_pthread_t,
+        gf_posix_mt_aio_t,
+        gf_posix_mt_aio_req_t,
+        gf_posix_mt_iovec_t,
+        gf_posix_mt_dirfd_t,
+        gf_posix_mt_fsync_req_t,
         gf_posix_mt_end
 };
 #endif
@@ -41,12 +41,17 @@
 #include <fcntl.h>
 #endif /* HAVE_LINKAT */
 
+#ifdef GF_LINUX_HOST_OS
+#include <sys/syscall.h>
+#endif /* GF_LINUX_HOST_OS */
+
 #include "glusterfs.h"
 #include "md5.h"
 #include "checksum.h"
 #include "dict.h"
 #include "logging.h"
 #include "posix.h"
+#include "posix-aio.h"
 #include "xlator.h"
 #include "defaults.h"
 #include "common-utils.h"
@@ -57,8 +62,10 @@
 #include "statedump.h"
 #include "locking.h"
 #include "timer.h"
+#include "bloom.h"
 #include "glusterfs3-xdr.h"
 #include "hashfn.h"
+#include "bulkstat.h"
 
 
 #undef HAVE_SET_FSID
@@ -109,6 +116,9 @@ posix_lookup (call_frame_t *frame, xlator_t *this,
         char *      pathdup            = NULL;
         char *      parentpath         = NULL;
         struct iatt postparent         = {0,};
+        struct posix_dirfd *pdirfd     = NULL;
+        char *      entry_path         = NULL;
+        char        entry_buf[PATH_MAX] = {0,};
 
         VALIDATE_OR_GOTO (frame, out);
         VALIDATE_OR_GOTO (this, out);
@@ -117,9 +127,16 @@ posix_lookup (call_frame_t *frame, xlator_t *this,
 
         MAKE_REAL_PATH (real_path, this, loc->path);
 
-        posix_gfid_set (this, real_path, xattr_req);
+        /* not under the caller's credentials, as the path calls */
+        if (loc->parent)
+                pdirfd = posix_parent_dirfd (this, NULL, loc, real_path);
+
+        entry_path = posix_entry_path (pdirfd, loc, real_path, entry_buf,
+                                       sizeof (entry_buf));
 
-        op_ret   = posix_lstat_with_gfid (this, real_path, &buf);
+        posix_gfid_set (this, entry_path, xattr_req);
+
+        op_ret   = posix_entry_stat (this, pdirfd, loc, real_path, &buf);
         op_errno = errno;
 
         if (op_ret == -1) {
@@ -134,18 +151,21 @@ posix_lookup (call_frame_t *frame, xlator_t *this,
         }
 
         if (xattr_req && (op_ret == 0)) {
-                xattr = posix_lookup_xattr_fill (this, real_path, loc,
+                xattr = posix_lookup_xattr_fill (this, entry_path, loc,
                                                  xattr_req, &buf);
         }
 
 parent:
         if (loc->parent) {
-                pathdup = gf_strdup (real_path);
-                GF_VALIDATE_OR_GOTO (this->name, pathdup, out);
+                if (!pdirfd) {
+                        pathdup = gf_strdup (real_path);
+                        GF_VALIDATE_OR_GOTO (this->name, pathdup, out);
 
-                parentpath = dirname (pathdup);
+                        parentpath = dirname (pathdup);
+                }
 
-                op_ret = posix_lstat_with_gfid (this, parentpath, &postparent);
+                op_ret = posix_parent_stat (this, pdirfd, parentpath,
+                                            &postparent);
                 if (op_ret == -1) {
                         op_errno = errno;
                         gf_log (this->name, GF_LOG_ERROR,
@@ -160,6 +180,8 @@ out:
         if (pathdup)
                 GF_FREE (pathdup);
 
+        posix_dirfd_put (this, pdirfd);
+
         if (xattr)
                 dict_ref (xattr);
 
@@ -181,6 +203,7 @@ posix_stat (call_frame_t *frame, xlator_t *this, loc_t *loc)
         int32_t               op_ret    = -1;
         int32_t               op_errno  = 0;
         struct posix_private *priv      = NULL;
+        struct posix_dirfd   *pdirfd    = NULL;
 
         DECLARE_OLD_FS_ID_VAR;
 
@@ -194,7 +217,9 @@ posix_stat (call_frame_t *frame, xlator_t *this, loc_t *loc)
         SET_FS_ID (frame->root->uid, frame->root->gid);
         MAKE_REAL_PATH (real_path, this, loc->path);
 
-        op_ret = posix_lstat_with_gfid (this, real_path, &buf);
+        pdirfd = posix_parent_dirfd (this, frame, loc, real_path);
+
+        op_ret = posix_entry_stat (this, pdirfd, loc, real_path, &buf);
         if (op_ret == -1) {
                 op_errno = errno;
                 gf_log (this->name, GF_LOG_ERROR,
@@ -206,12 +231,96 @@ posix_stat (call_frame_t *frame, xlator_t *this, loc_t *loc)
         op_ret = 0;
 
 out:
+        posix_dirfd_put (this, pdirfd);
+
         SET_TO_OLD_FS_ID();
         STACK_UNWIND_STRICT (stat, frame, op_ret, op_errno, &buf);
 
         return 0;
 }
 
+int32_t
+posix_bulkstat (call_frame_t *frame, xlator_t *this, loc_t *locs,
+                int32_t count)
+{
+        struct iatt          *bufs      = NULL;
+        int32_t              *op_errnos = NULL;
+        char                 *real_path = NULL;
+        int32_t               op_ret    = -1;
+        int32_t               op_errno  = 0;
+        int32_t               i         = 0;
+        int                   base_len  = 0;
+        struct posix_private *priv      = NULL;
+
+        DECLARE_OLD_FS_ID_VAR;
+
+        VALIDATE_OR_GOTO (frame, out);
+        VALIDATE_OR_GOTO (this, out);
+        VALIDATE_OR_GOTO (locs, out);
+
+        priv = this->private;
+        VALIDATE_OR_GOTO (priv, out);
+
+        if ((count <= 0) || (count > GF_BULKSTAT_MAX_COUNT)) {
+                op_errno = EINVAL;
+                goto out;
+        }
+
+        bufs = GF_CALLOC (count, sizeof (*bufs), gf_common_mt_bulkstat_t);
+        op_errnos = GF_CALLOC (count, sizeof (*op_errnos),
+                               gf_common_mt_bulkstat_t);
+        if (!bufs || !op_errnos) {
+                op_errno = ENOMEM;
+                goto out;
+        }
+
+        /* one buffer for all the entries, MAKE_REAL_PATH would alloca
+           a new one on every iteration */
+        base_len  = POSIX_BASE_PATH_LEN (this);
+        real_path = alloca (base_len + PATH_MAX + 1);
+        strcpy (real_path, POSIX_BASE_PATH (this));
+
+        SET_FS_ID (frame->root->uid, frame->root->gid);
+
+        for (i = 0; i < count; i++) {
+                if (!bulkstat_path_is_safe (locs[i].path)
+                    || (strlen (locs[i].path) > PATH_MAX)) {
+                        op_errnos[i] = EINVAL;
+                        continue;
+                }
+                strcpy (&real_path[base_len], locs[i].path);
+
+                if (posix_lstat_with_gfid (this, real_path, &bufs[i]) == -1) {
+                        op_errnos[i] = errno;
+                        gf_log (this->name, GF_LOG_DEBUG,
+                                "lstat on %s failed: %s", locs[i].path,
+                                strerror (op_errnos[i]));
+                        continue;
+                }
+
+                /* the path now leads to another file */
+                if (!uuid_is_null (locs[i].gfid)
+                    && uuid_compare (locs[i].gfid, bufs[i].ia_gfid)) {
+                        op_errnos[i] = ESTALE;
+                        memset (&bufs[i], 0, sizeof (bufs[i]));
+                }
+        }
+
+        SET_TO_OLD_FS_ID ();
+
+        op_ret = count;
+out:
+        STACK_UNWIND_STRICT (bulkstat, frame, op_ret, op_errno, bufs,
+                             op_errnos);
+
+        if (bufs)
+                GF_FREE (bufs);
+        if (op_errnos)
+                GF_FREE (op_errnos);
+
+        return 0;
+}
+
 static int
 posix_do_chmod (xlator_t *this, const char *path, struct iatt *stbuf)
 {
@@ -894,6 +1003,10 @@ posix_mkdir (call_frame_t *frame, xlator_t *this,
         char                 *parentpath = NULL;
         struct iatt           preparent = {0,};
         struct iatt           postparent = {0,};
+        struct posix_dirfd   *pdirfd    = NULL;
+        void                 *uuid_req  = NULL;
+        char                 *entry_path = NULL;
+        char                  entry_buf[PATH_MAX] = {0,};
 
         DECLARE_OLD_FS_ID_VAR;
 
@@ -908,12 +1021,21 @@ posix_mkdir (call_frame_t *frame, xlator_t *this,
 
         gid = frame->root->gid;
 
-        op_ret = posix_lstat_with_gfid (this, real_path, &stbuf);
+        /* a directory recreated with its old gfid (self-heal) must not be
+           served by the handle of the removed one */
+        if (params && !dict_get_ptr (params, "gfid-req", &uuid_req))
+                posix_dirfd_forget (this, uuid_req);
+
+        pdirfd = posix_parent_dirfd (this, frame, loc, real_path);
+        entry_path = posix_entry_path (pdirfd, loc, real_path, entry_buf,
+                                       sizeof (entry_buf));
+
+        op_ret = posix_entry_stat (this, pdirfd, loc, real_path, &stbuf);
         if ((op_ret == -1) && (errno == ENOENT)) {
                 was_present = 0;
         }
 
-        op_ret = setgid_override (this, real_path, &gid);
+        op_ret = posix_entry_setgid_override (this, pdirfd, real_path, &gid);
         if (op_ret < 0) {
                 op_errno = -op_ret;
                 op_ret = -1;
@@ -927,7 +1049,7 @@ posix_mkdir (call_frame_t *frame, xlator_t *this,
 
         parentpath = dirname (pathdup);
 
-        op_ret = posix_lstat_with_gfid (this, parentpath, &preparent);
+        op_ret = posix_parent_stat (this, pdirfd, parentpath, &preparent);
         if (op_ret == -1) {
                 op_errno = errno;
                 gf_log (this->name, GF_LOG_ERROR,
@@ -936,7 +1058,7 @@ posix_mkdir (call_frame_t *frame, xlator_t *this,
                 goto out;
         }
 
-        op_ret = mkdir (real_path, mode);
+        op_ret = posix_entry_mkdir (pdirfd, loc, real_path, mode);
         if (op_ret == -1) {
                 op_errno = errno;
                 gf_log (this->name, GF_LOG_ERROR,
@@ -945,14 +1067,14 @@ posix_mkdir (call_frame_t *frame, xlator_t *this,
                 goto out;
         }
 
-        op_ret = posix_gfid_set (this, real_path, params);
+        op_ret = posix_gfid_set (this, entry_path, params);
         if (op_ret) {
                 gf_log (this->name, GF_LOG_ERROR,
                         "setting gfid on %s failed", loc->path);
         }
 
 #ifndef HAVE_SET_FSID
-        op_ret = chown (real_path, frame->root->uid, gid);
+        op_ret = chown (entry_path, frame->root->uid, gid);
         if (op_ret == -1) {
                 op_errno = errno;
                 gf_log (this->name, GF_LOG_ERROR,
@@ -962,21 +1084,21 @@ posix_mkdir (call_frame_t *frame, xlator_t *this,
         }
 #endif
 
-        op_ret = posix_acl_xattr_set (this, real_path, params);
+        op_ret = posix_acl_xattr_set (this, entry_path, params);
         if (op_ret) {
                 gf_log (this->name, GF_LOG_ERROR,
                         "setting ACLs on %s failed (%s)", loc->path,
                         strerror (errno));
         }
 
-        op_ret = posix_entry_create_xattr_set (this, real_path, params);
+        op_ret = posix_entry_create_xattr_set (this, entry_path, params);
         if (op_ret) {
                 gf_log (this->name, GF_LOG_ERROR,
                         "setting xattrs on %s failed (%s)", loc->path,
                         strerror (errno));
         }
 
-        op_ret = posix_lstat_with_gfid (this, real_path, &stbuf);
+        op_ret = posix_entry_stat (this, pdirfd, loc, real_path, &stbuf);
         if (op_ret == -1) {
                 op_errno = errno;
                 gf_log (this->name, GF_LOG_ERROR,
@@ -985,7 +1107,7 @@ posix_mkdir (call_frame_t *frame, xlator_t *this,
                 goto out;
         }
 
-        op_ret = posix_lstat_with_gfid (this, parentpath, &postparent);
+        op_ret = posix_parent_stat (this, pdirfd, parentpath, &postparent);
         if (op_ret == -1) {
                 op_errno = errno;
                 gf_log (this->name, GF_LOG_ERROR,
@@ -1000,6 +1122,8 @@ out:
         if (pathdup)
                 GF_FREE (pathdup);
 
+        posix_dirfd_put (this, pdirfd);
+
         SET_TO_OLD_FS_ID ();
 
         STACK_UNWIND_STRICT (mkdir, frame, op_ret, op_errno,
@@ -1026,6 +1150,7 @@ posix_unlink (call_frame_t *frame, xlator_t *this,
         struct posix_private    *priv      = NULL;
         struct iatt            preparent = {0,};
         struct iatt            postparent = {0,};
+        struct posix_dirfd    *pdirfd    = NULL;
 
         DECLARE_OLD_FS_ID_VAR;
 
@@ -1042,7 +1167,9 @@ posix_unlink (call_frame_t *frame, xlator_t *this,
 
         parentpath = dirname (pathdup);
 
-        op_ret = posix_lstat_with_gfid (this, parentpath, &preparent);
+        pdirfd = posix_parent_dirfd (this, frame, loc, real_path);
+
+        op_ret = posix_parent_stat (this, pdirfd, parentpath, &preparent);
         if (op_ret == -1) {
                 op_errno = errno;
                 gf_log (this->name, GF_LOG_ERROR,
@@ -1054,7 +1181,8 @@ posix_unlink (call_frame_t *frame, xlator_t *this,
         priv = this->private;
         if (priv->background_unlink) {
                 if (IA_ISREG (loc->inode->ia_type)) {
-                        fd = open (real_path, O_RDONLY);
+                        fd = posix_entry_open (pdirfd, loc, real_path,
+                                               O_RDONLY, 0);
                         if (fd == -1) {
                                 op_ret = -1;
                                 op_errno = errno;
@@ -1066,7 +1194,7 @@ posix_unlink (call_frame_t *frame, xlator_t *this,
                 }
         }
 
-        op_ret = sys_unlink (real_path);
+        op_ret = posix_entry_unlink (pdirfd, loc, real_path);
         if (op_ret == -1) {
                 op_errno = errno;
                 gf_log (this->name, GF_LOG_ERROR,
@@ -1075,7 +1203,7 @@ posix_unlink (call_frame_t *frame, xlator_t *this,
                 goto out;
         }
 
-        op_ret = posix_lstat_with_gfid (this, parentpath, &postparent);
+        op_ret = posix_parent_stat (this, pdirfd, parentpath, &postparent);
         if (op_ret == -1) {
                 op_errno = errno;
                 gf_log (this->name, GF_LOG_ERROR,
@@ -1090,6 +1218,8 @@ out:
         if (pathdup)
                 GF_FREE (pathdup);
 
+        posix_dirfd_put (this, pdirfd);
+
         SET_TO_OLD_FS_ID ();
 
         STACK_UNWIND_STRICT (unlink, frame, op_ret, op_errno,
@@ -1174,6 +1304,11 @@ posix_rmdir (call_frame_t *frame, xlator_t *this,
                 goto out;
         }
 
+        if (loc->inode) {
+                posix_dirfd_forget (this, loc->inode->gfid);
+                posix_bloom_forget (this, loc->inode->gfid);
+        }
+
         op_ret = posix_lstat_with_gfid (this, parentpath, &postparent);
         if (op_ret == -1) {
                 op_errno = errno;
@@ -1434,6 +1569,12 @@ posix_rename (call_frame_t *frame, xlator_t *this,
                 goto out;
         }
 
+        /* the directory renamed over is gone */
+        if (was_present && IA_ISDIR (stbuf.ia_type)) {
+                posix_dirfd_forget (this, stbuf.ia_gfid);
+                posix_bloom_forget (this, stbuf.ia_gfid);
+        }
+
         op_ret = posix_lstat_with_gfid (this, real_newpath, &stbuf);
         if (op_ret == -1) {
                 op_errno = errno;
@@ -1671,6 +1812,9 @@ posix_create (call_frame_t *frame, xlator_t *this,
         char                  *parentpath = NULL;
         struct iatt            preparent = {0,};
         struct iatt            postparent = {0,};
+        struct posix_dirfd    *pdirfd    = NULL;
+        char                  *entry_path = NULL;
+        char                   entry_buf[PATH_MAX] = {0,};
 
         DECLARE_OLD_FS_ID_VAR;
 
@@ -1685,9 +1829,13 @@ posix_create (call_frame_t *frame, xlator_t *this,
 
         MAKE_REAL_PATH (real_path, this, loc->path);
 
+        pdirfd = posix_parent_dirfd (this, frame, loc, real_path);
+        entry_path = posix_entry_path (pdirfd, loc, real_path, entry_buf,
+                                       sizeof (entry_buf));
+
         gid = frame->root->gid;
 
-        op_ret = setgid_override (this, real_path, &gid);
+        op_ret = posix_entry_setgid_override (this, pdirfd, real_path, &gid);
         if (op_ret < 0) {
                 op_errno = -op_ret;
                 op_ret = -1;
@@ -1701,7 +1849,7 @@ posix_create (call_frame_t *frame, xlator_t *this,
 
         parentpath = dirname (pathdup);
 
-        op_ret = posix_lstat_with_gfid (this, parentpath, &preparent);
+        op_ret = posix_parent_stat (this, pdirfd, parentpath, &preparent);
         if (op_ret == -1) {
                 op_errno = errno;
                 gf_log (this->name, GF_LOG_ERROR,
@@ -1717,7 +1865,7 @@ posix_create (call_frame_t *frame, xlator_t *this,
                 _flags = flags | O_CREAT;
         }
 
-        op_ret = posix_lstat_with_gfid (this, real_path, &stbuf);
+        op_ret = posix_entry_stat (this, pdirfd, loc, real_path, &stbuf);
         if ((op_ret == -1) && (errno == ENOENT)) {
                 was_present = 0;
         }
@@ -1725,7 +1873,7 @@ posix_create (call_frame_t *frame, xlator_t *this,
         if (priv->o_direct)
                 _flags |= O_DIRECT;
 
-        _fd = open (real_path, _flags, mode);
+        _fd = posix_entry_open (pdirfd, loc, real_path, _flags, mode);
 
         if (_fd == -1) {
                 op_errno = errno;
@@ -1736,14 +1884,14 @@ posix_create (call_frame_t *frame, xlator_t *this,
                 goto out;
         }
 
-        op_ret = posix_gfid_set (this, real_path, params);
+        op_ret = posix_gfid_set (this, entry_path, params);
         if (op_ret) {
                 gf_log (this->name, GF_LOG_ERROR,
                         "setting gfid on %s failed", loc->path);
         }
 
 #ifndef HAVE_SET_FSID
-        op_ret = chown (real_path, frame->root->uid, gid);
+        op_ret = chown (entry_path, frame->root->uid, gid);
         if (op_ret == -1) {
                 op_errno = errno;
                 gf_log (this->name, GF_LOG_ERROR,
@@ -1752,14 +1900,14 @@ posix_create (call_frame_t *frame, xlator_t *this,
         }
 #endif
 
-        op_ret = posix_acl_xattr_set (this, real_path, params);
+        op_ret = posix_acl_xattr_set (this, entry_path, params);
         if (op_ret) {
                 gf_log (this->name, GF_LOG_ERROR,
                         "setting ACLs on %s failed (%s)", loc->path,
                         strerror (errno));
         }
 
-        op_ret = posix_entry_create_xattr_set (this, real_path, params);
+        op_ret = posix_entry_create_xattr_set (this, entry_path, params);
         if (op_ret) {
                 gf_log (this->name, GF_LOG_ERROR,
                         "setting xattrs on %s failed (%s)", loc->path,
@@ -1774,7 +1922,7 @@ posix_create (call_frame_t *frame, xlator_t *this,
                 goto out;
         }
 
-        op_ret = posix_lstat_with_gfid (this, parentpath, &postparent);
+        op_ret = posix_parent_stat (this, pdirfd, parentpath, &postparent);
         if (op_ret == -1) {
                 op_errno = errno;
                 gf_log (this->name, GF_LOG_ERROR,
@@ -1816,10 +1964,12 @@ out:
                 close (_fd);
 
                 if (!was_present) {
-                        unlink (real_path);
+                        posix_entry_unlink (pdirfd, loc, real_path);
                 }
         }
 
+        posix_dirfd_put (this, pdirfd);
+
         STACK_UNWIND_STRICT (create, frame, op_ret, op_errno,
                              fd, (loc)?loc->inode:NULL, &stbuf, &preparent,
                              &postparent);
@@ -1980,13 +2130,18 @@ posix_readv (call_frame_t *frame, xlator_t *this,
                 goto out;
         }
 
+        _fd = pfd->fd;
+
+        /* unwound by the completion thread of the io-engine */
+        if (posix_aio_readv (frame, this, fd, _fd, size, offset) == 0)
+                return 0;
+
         iobuf = iobuf_get2 (this->ctx->iobuf_pool, size);
         if (!iobuf) {
                 op_errno = ENOMEM;
                 goto out;
         }
 
-        _fd = pfd->fd;
         op_ret = pread (_fd, iobuf->ptr, size, offset);
         if (op_ret == -1) {
                 op_errno = errno;
@@ -2174,6 +2329,14 @@ posix_writev (call_frame_t *frame, xlator_t *this,
                 goto out;
         }
 
+        /* O_DIRECT writes need the aligned copy of __posix_writev, and the
+           flush of O_SYNC ones may be batched with other fsyncs */
+        if (!(pfd->flags & O_DIRECT)
+            && !(pfd->flushwrites && priv->fsyncer_running)
+            && (posix_aio_writev (frame, this, fd, _fd, vector, count, offset,
+                                  iobref, &preop, pfd->flushwrites) == 0))
+                return 0;
+
         op_ret = __posix_writev (_fd, vector, count, offset,
                                  (pfd->flags & O_DIRECT));
         if (op_ret < 0) {
@@ -2196,6 +2359,11 @@ posix_writev (call_frame_t *frame, xlator_t *this,
                  */
 
                 if (pfd->flushwrites) {
+                        if (posix_fsync_enqueue (frame, this, fd, _fd,
+                                                 GF_FOP_WRITE, 0, op_ret,
+                                                 &preop) == 0)
+                                return 0;
+
                         /* NOTE: ignore the error, if one occurs at this
                          * point */
                         fsync (_fd);
@@ -2390,6 +2558,14 @@ posix_fsync (call_frame_t *frame, xlator_t *this,
                 goto out;
         }
 
+        if ((posix_fsync_enqueue (frame, this, fd, _fd, GF_FOP_FSYNC,
+                                  datasync, 0, &preop) == 0)
+            || (posix_aio_fsync (frame, this, fd, _fd, datasync,
+                                 &preop) == 0)) {
+                SET_TO_OLD_FS_ID ();
+                return 0;
+        }
+
         if (datasync) {
                 ;
 #ifdef HAVE_FDATASYNC
@@ -2441,6 +2617,7 @@ posix_setxattr (call_frame_t *frame, xlator_t *this,
         char *        real_path               = NULL;
         data_pair_t * trav                    = NULL;
         int           ret                     = -1;
+        struct posix_dirfd *dfd               = NULL;
 
         DECLARE_OLD_FS_ID_VAR;
         SET_FS_ID (frame->root->uid, frame->root->gid);
@@ -2452,12 +2629,21 @@ posix_setxattr (call_frame_t *frame, xlator_t *this,
 
         MAKE_REAL_PATH (real_path, this, loc->path);
 
+        /* the xattrs of directories (dht layouts, afr changelogs) go
+           through the held directory */
+        if (loc->inode && IA_ISDIR (loc->inode->ia_type))
+                dfd = posix_dirfd_get (this, frame, loc->inode->gfid,
+                                       real_path);
+
         dict_del (dict, GFID_XATTR_KEY);
 
         trav = dict->members_list;
 
         while (trav) {
-                ret = posix_handle_pair (this, real_path, trav, flags);
+                if (dfd && !ZR_FILE_CONTENT_REQUEST (trav->key))
+                        ret = posix_fhandle_pair (this, dfd->fd, trav, flags);
+                else
+                        ret = posix_handle_pair (this, real_path, trav, flags);
                 if (ret < 0) {
                         op_errno = -ret;
                         goto out;
@@ -2468,6 +2654,8 @@ posix_setxattr (call_frame_t *frame, xlator_t *this,
         op_ret = 0;
 
 out:
+        posix_dirfd_put (this, dfd);
+
         SET_TO_OLD_FS_ID ();
 
         STACK_UNWIND_STRICT (setxattr, frame, op_ret, op_errno);
@@ -2498,6 +2686,7 @@ posix_getxattr (call_frame_t *frame, xlator_t *this,
         dict_t * dict           = NULL;
         char *   file_contents  = NULL;
         int      ret            = -1;
+        struct posix_dirfd *dfd = NULL;
 
         DECLARE_OLD_FS_ID_VAR;
 
@@ -2510,6 +2699,10 @@ posix_getxattr (call_frame_t *frame, xlator_t *this,
 
         priv = this->private;
 
+        if (loc->inode && IA_ISDIR (loc->inode->ia_type))
+                dfd = posix_dirfd_get (this, frame, loc->inode->gfid,
+                                       real_path);
+
         if (loc->inode && IA_ISDIR(loc->inode->ia_type) && name &&
             ZR_FILE_CONTENT_REQUEST(name)) {
                 ret = posix_get_file_contents (this, real_path, name,
@@ -2560,16 +2753,28 @@ posix_getxattr (call_frame_t *frame, xlator_t *this,
                 goto done;
         }
 
+        if (loc->inode && IA_ISDIR (loc->inode->ia_type) && name &&
+            (strcmp (name, GF_BLOOM_XATTR_KEY) == 0)) {
+                op_ret = posix_bloom_get (this, real_path, loc->inode, dict);
+                if (op_ret == -1) {
+                        op_errno = errno;
+                        goto out;
+                }
+                size = op_ret;
+                goto done;
+        }
+
         if (name) {
                 strcpy (key, name);
 
-                size = sys_lgetxattr (real_path, key, NULL, 0);
+                size = posix_dirfd_getxattr (dfd, real_path, key, NULL, 0);
                 value = GF_CALLOC (size + 1, sizeof(char), gf_posix_mt_char);
                 if (!value) {
                         op_ret = -1;
                         goto out;
                 }
-                op_ret = sys_lgetxattr (real_path, key, value, op_ret);
+                op_ret = posix_dirfd_getxattr (dfd, real_path, key, value,
+                                               op_ret);
                 if (op_ret == -1) {
                         op_errno = errno;
                         goto out;
@@ -2583,7 +2788,7 @@ posix_getxattr (call_frame_t *frame, xlator_t *this,
                 goto done;
         }
 
-        size = sys_llistxattr (real_path, NULL, 0);
+        size = posix_dirfd_listxattr (dfd, real_path, NULL, 0);
         if (size == -1) {
                 op_errno = errno;
                 if ((errno == ENOTSUP) || (errno == ENOSYS)) {
@@ -2609,7 +2814,7 @@ posix_getxattr (call_frame_t *frame, xlator_t *this,
                 goto out;
         }
 
-        size = sys_llistxattr (real_path, list, size);
+        size = posix_dirfd_listxattr (dfd, real_path, list, size);
 
         remaining_size = size;
         list_offset = 0;
@@ -2618,7 +2823,7 @@ posix_getxattr (call_frame_t *frame, xlator_t *this,
                         break;
 
                 strcpy (key, list + list_offset);
-                op_ret = sys_lgetxattr (real_path, key, NULL, 0);
+                op_ret = posix_dirfd_getxattr (dfd, real_path, key, NULL, 0);
                 if (op_ret == -1)
                         break;
 
@@ -2629,7 +2834,8 @@ posix_getxattr (call_frame_t *frame, xlator_t *this,
                         goto out;
                 }
 
-                op_ret = sys_lgetxattr (real_path, key, value, op_ret);
+                op_ret = posix_dirfd_getxattr (dfd, real_path, key, value,
+                                               op_ret);
                 if (op_ret == -1) {
                         op_errno = errno;
                         break;
@@ -2655,6 +2861,8 @@ done:
         }
 
 out:
+        posix_dirfd_put (this, dfd);
+
         SET_TO_OLD_FS_ID ();
 
         STACK_UNWIND_STRICT (getxattr, frame, op_ret, op_errno, dict);
@@ -3295,6 +3503,245 @@ out:
 }
 
 
+/* zerofill without FALLOC_FL_ZERO_RANGE, by writing out zeroes */
+static int
+posix_write_zeroes (int _fd, off_t offset, size_t len)
+{
+        int             align     = 4096;
+        size_t          chunk     = 0;
+        char           *alloc_buf = NULL;
+        char           *buf       = NULL;
+        ssize_t         retval    = 0;
+        int             ret       = -1;
+
+        chunk = min (len, POSIX_ZEROFILL_CHUNK);
+
+        alloc_buf = GF_CALLOC (1, chunk + align, gf_posix_mt_char);
+        if (!alloc_buf)
+                goto out;
+
+        /* page aligned, in case the fd is O_DIRECT */
+        buf = ALIGN_BUF (alloc_buf, align);
+
+        while (len > 0) {
+                retval = pwrite (_fd, buf, min (len, chunk), offset);
+                if (retval == -1)
+                        goto out;
+
+                offset += retval;
+                len    -= retval;
+        }
+
+        ret = 0;
+out:
+        if (alloc_buf)
+                GF_FREE (alloc_buf);
+
+        return ret;
+}
+
+
+/* fallocate, discard and zerofill, which differ only in the mode given
+   to fallocate(2) */
+static int32_t
+posix_do_fallocate (call_frame_t *frame, xlator_t *this, fd_t *fd,
+                    int32_t mode, off_t offset, size_t len,
+                    struct iatt *preop, struct iatt *postop)
+{
+        int32_t               op_ret   = -1;
+        int32_t               op_errno = EINVAL;
+        int                   _fd      = -1;
+        struct posix_fd      *pfd      = NULL;
+        int                   ret      = -1;
+        uint64_t              tmp_pfd  = 0;
+        struct posix_private *priv     = NULL;
+
+        DECLARE_OLD_FS_ID_VAR;
+        SET_FS_ID (frame->root->uid, frame->root->gid);
+
+        VALIDATE_OR_GOTO (frame, out);
+        VALIDATE_OR_GOTO (this, out);
+        VALIDATE_OR_GOTO (fd, out);
+
+        priv = this->private;
+        VALIDATE_OR_GOTO (priv, out);
+
+        ret = fd_ctx_get (fd, this, &tmp_pfd);
+        if (ret < 0) {
+                gf_log (this->name, GF_LOG_WARNING,
+                        "pfd is NULL, fd=%p", fd);
+                op_errno = -ret;
+                goto out;
+        }
+        pfd = (struct posix_fd *)(long)tmp_pfd;
+
+        _fd = pfd->fd;
+
+        op_ret = posix_fstat_with_gfid (this, _fd, preop);
+        if (op_ret == -1) {
+                op_errno = errno;
+                gf_log (this->name, GF_LOG_ERROR,
+                        "pre-operation fstat failed on fd=%p: %s", fd,
+                        strerror (op_errno));
+                goto out;
+        }
+
+#ifdef HAVE_FALLOCATE
+        op_ret = fallocate (_fd, mode, offset, len);
+#else
+        op_ret = -1;
+        errno  = ENOSYS;
+#endif
+        if ((op_ret == -1) && (mode & FALLOC_FL_ZERO_RANGE)
+            && ((errno == EOPNOTSUPP) || (errno == ENOSYS)))
+                op_ret = posix_write_zeroes (_fd, offset, len);
+
+        if (op_ret == -1) {
+                op_errno = errno;
+                gf_log (this->name, GF_LOG_ERROR,
+                        "fallocate (mode %"PRId32") failed on fd=%p "
+                        "(%"PRId64", %"GF_PRI_SIZET"): %s", mode, fd,
+                        offset, len, strerror (op_errno));
+                goto out;
+        }
+
+        op_ret = posix_fstat_with_gfid (this, _fd, postop);
+        if (op_ret == -1) {
+                op_errno = errno;
+                gf_log (this->name, GF_LOG_ERROR,
+                        "post-operation fstat failed on fd=%p: %s",
+                        fd, strerror (errno));
+                goto out;
+        }
+
+        op_ret = 0;
+
+out:
+        SET_TO_OLD_FS_ID ();
+
+        return (op_ret == 0) ? 0 : -op_errno;
+}
+
+
+/* not posix_fallocate, which is libc's */
+int32_t
+posix_glfallocate (call_frame_t *frame, xlator_t *this, fd_t *fd,
+                   int32_t mode, off_t offset, size_t len)
+{
+        int32_t     ret    = 0;
+        struct iatt preop  = {0,};
+        struct iatt postop = {0,};
+
+        /* holes and zeroes have fops of their own */
+        if (mode & ~FALLOC_FL_KEEP_SIZE) {
+                STACK_UNWIND_STRICT (fallocate, frame, -1, EOPNOTSUPP,
+                                     NULL, NULL);
+                return 0;
+        }
+
+        ret = posix_do_fallocate (frame, this, fd, mode, offset, len,
+                                  &preop, &postop);
+        if (ret < 0)
+                STACK_UNWIND_STRICT (fallocate, frame, -1, -ret, NULL, NULL);
+        else
+                STACK_UNWIND_STRICT (fallocate, frame, 0, 0, &preop, &postop);
+
+        return 0;
+}
+
+
+int32_t
+posix_discard (call_frame_t *frame, xlator_t *this, fd_t *fd,
+               off_t offset, size_t len)
+{
+        int32_t     ret    = 0;
+        struct iatt preop  = {0,};
+        struct iatt postop = {0,};
+
+        ret = posix_do_fallocate (frame, this, fd,
+                                  FALLOC_FL_PUNCH_HOLE | FALLOC_FL_KEEP_SIZE,
+                                  offset, len, &preop, &postop);
+        if (ret < 0)
+                STACK_UNWIND_STRICT (discard, frame, -1, -ret, NULL, NULL);
+        else
+                STACK_UNWIND_STRICT (discard, frame, 0, 0, &preop, &postop);
+
+        return 0;
+}
+
+
+int32_t
+posix_zerofill (call_frame_t *frame, xlator_t *this, fd_t *fd,
+                off_t offset, size_t len)
+{
+        int32_t     ret    = 0;
+        struct iatt preop  = {0,};
+        struct iatt postop = {0,};
+
+        ret = posix_do_fallocate (frame, this, fd, FALLOC_FL_ZERO_RANGE,
+                                  offset, len, &preop, &postop);
+        if (ret < 0)
+                STACK_UNWIND_STRICT (zerofill, frame, -1, -ret, NULL, NULL);
+        else
+                STACK_UNWIND_STRICT (zerofill, frame, 0, 0, &preop, &postop);
+
+        return 0;
+}
+
+
+int32_t
+posix_seek (call_frame_t *frame, xlator_t *this, fd_t *fd,
+            off_t offset, gf_seek_what_t what)
+{
+        int                   _fd      = -1;
+        int32_t               op_ret   = -1;
+        int32_t               op_errno = 0;
+        off_t                 ret_off  = -1;
+        struct posix_fd      *pfd      = NULL;
+        uint64_t              tmp_pfd  = 0;
+        int                   ret      = -1;
+
+        VALIDATE_OR_GOTO (frame, out);
+        VALIDATE_OR_GOTO (this, out);
+        VALIDATE_OR_GOTO (fd, out);
+
+        ret = fd_ctx_get (fd, this, &tmp_pfd);
+        if (ret < 0) {
+                gf_log (this->name, GF_LOG_WARNING,
+                        "pfd is NULL, fd=%p", fd);
+                op_errno = EBADFD;
+                goto out;
+        }
+        pfd = (struct posix_fd *)(long)tmp_pfd;
+
+        _fd = pfd->fd;
+
+#if defined(SEEK_DATA) && defined(SEEK_HOLE)
+        /* lseek moves the offset of the descriptor, but every other fop
+           of posix gives its offset explicitly */
+        ret_off = lseek (_fd, offset,
+                         (what == GF_SEEK_DATA) ? SEEK_DATA : SEEK_HOLE);
+        if (ret_off == -1) {
+                op_errno = errno;
+                /* ENXIO: no data or hole past offset */
+                if (op_errno != ENXIO)
+                        gf_log (this->name, GF_LOG_ERROR,
+                                "seek failed on fd=%p: %s", fd,
+                                strerror (op_errno));
+                goto out;
+        }
+
+        op_ret = 0;
+#else
+        op_errno = ENOSYS;
+#endif
+
+out:
+        STACK_UNWIND_STRICT (seek, frame, op_ret, op_errno, ret_off);
+        return 0;
+}
+
+
 int32_t
 posix_fstat (call_frame_t *frame, xlator_t *this,
              fd_t *fd)
@@ -3419,19 +3866,395 @@ posix_fentrylk (call_frame_t *frame, xlator_t *this,
 }
 
 
+/* entries of the export root which are not shown to clients */
+static gf_boolean_t
+posix_dirent_hidden (const char *real_path, const char *base_path,
+                     const char *name)
+{
+        char        hidden_path[PATH_MAX] = {0, };
+        struct stat statbuf               = {0, };
+        int         ret                   = 0;
+
+        if (strcmp (real_path, base_path))
+                return _gf_false;
+
+        if (!strcmp (name, GF_REPLICATE_TRASH_DIR))
+                return _gf_true;
+
+#ifdef __NetBSD__
+       /*
+        * NetBSD with UFS1 backend uses backing files for
+        * extended attributes. They can be found in a
+        * .attribute file located at the root of the filesystem
+        * We hide it to glusterfs clients, since chaos will occur
+        * when the cluster/dht xlator decides to distribute
+        * exended attribute backing file accross storage servers.
+        */
+        if (!strcmp (name, ".attribute"))
+                return _gf_true;
+#endif /* __NetBSD__ */
+
+        if (!strncmp (GF_HIDDEN_PATH, name, strlen (GF_HIDDEN_PATH))) {
+                snprintf (hidden_path, PATH_MAX, "%s/%s", real_path, name);
+                ret = lstat (hidden_path, &statbuf);
+                if (!ret && S_ISDIR (statbuf.st_mode))
+                        return _gf_true;
+        }
+
+        return _gf_false;
+}
+
+
+#ifdef GF_LINUX_HOST_OS
+struct posix_dirent64 {
+        uint64_t        d_ino;
+        int64_t         d_off;
+        unsigned short  d_reclen;
+        unsigned char   d_type;
+        char            d_name[];
+};
+
+#define POSIX_GETDENTS_BUF_SIZE  (128 * 1024)
+#define POSIX_GETDENTS_MIN_SIZE  (sizeof (struct posix_dirent64) + NAME_MAX + 1)
+
+/*
+ * Lists the directory with getdents64() into an iobuf of up to 128KB,
+ * which returns hundreds of entries per call where readdir(3) goes by
+ * 32KB. A kernel entry takes less room than the same entry in the reply,
+ * so a buffer of @size bytes holds at least as many entries as the reply
+ * can take: small readdirs do not read ahead entries only to drop them.
+ * Every call seeks to @off first, so the offset the next call starts from
+ * is the d_off of the last entry returned, as with telldir().
+ */
+int
+__posix_fill_getdents (xlator_t *this, int dirfd, off_t off, size_t size,
+                       gf_dirent_t *entries, const char *real_path,
+                       const char *base_path)
+{
+        struct iobuf          *iobuf      = NULL;
+        struct posix_dirent64 *entry      = NULL;
+        gf_dirent_t           *this_entry = NULL;
+        size_t                 buf_size   = 0;
+        size_t                 filled     = 0;
+        int32_t                this_size  = -1;
+        long                   nread      = 0;
+        long                   pos        = 0;
+        int                    count      = 0;
+        int                    full       = 0;
+        int                    op_errno   = 0;
+
+        buf_size = min (size, POSIX_GETDENTS_BUF_SIZE);
+        if (buf_size < POSIX_GETDENTS_MIN_SIZE)
+                buf_size = POSIX_GETDENTS_MIN_SIZE;
+
+        iobuf = iobuf_get2 (this->ctx->iobuf_pool, buf_size);
+        if (!iobuf) {
+                op_errno = ENOMEM;
+                goto out;
+        }
+
+        if (lseek (dirfd, off, SEEK_SET) == -1) {
+                op_errno = errno;
+                gf_log (this->name, GF_LOG_ERROR,
+                        "lseek failed on dir=%s: %s",
+                        real_path, strerror (op_errno));
+                goto out;
+        }
+
+        while (!full) {
+                nread = syscall (SYS_getdents64, dirfd, iobuf->ptr,
+                                 buf_size);
+                if (nread == -1) {
+                        op_errno = errno;
+                        gf_log (this->name, GF_LOG_WARNING,
+                                "getdents64 failed on dir=%s: %s",
+                                real_path, strerror (op_errno));
+                        goto out;
+                }
+
+                if (nread == 0) {
+                        /* Indicate EOF */
+                        op_errno = ENOENT;
+                        break;
+                }
+
+                for (pos = 0; pos < nread; pos += entry->d_reclen) {
+                        entry = (struct posix_dirent64 *)(iobuf->ptr + pos);
+
+                        if (posix_dirent_hidden (real_path, base_path,
+                                                 entry->d_name))
+                                continue;
+
+                        this_size = max (sizeof (gf_dirent_t),
+                                         sizeof (gfs3_dirplist))
+                                + strlen (entry->d_name) + 1;
+
+                        if (this_size + filled > size) {
+                                full = 1;
+                                break;
+                        }
+
+                        this_entry = gf_dirent_for_name (entry->d_name);
+                        if (!this_entry) {
+                                op_errno = errno;
+                                gf_log (this->name, GF_LOG_ERROR,
+                                        "could not create gf_dirent for entry "
+                                        "%s: (%s)", entry->d_name,
+                                        strerror (op_errno));
+                                goto out;
+                        }
+                        this_entry->d_off = entry->d_off;
+                        this_entry->d_ino = entry->d_ino;
+
+                        list_add_tail (&this_entry->list, &entries->list);
+
+                        filled += this_size;
+                        count ++;
+                }
+        }
+
+out:
+        if (iobuf)
+                iobuf_unref (iobuf);
+
+        errno = op_errno;
+        return count;
+}
+#endif /* GF_LINUX_HOST_OS */
+
+
+static void
+posix_readdirp_stat_range (struct posix_stat_batch *batch, int start, int end)
+{
+        gf_dirent_t *entry                 = NULL;
+        struct iatt  stbuf                 = {0, };
+        char         entry_path[PATH_MAX]  = {0, };
+        int          i                     = 0;
+
+        for (i = start; i < end; i++) {
+                entry = batch->entries[i];
+
+                snprintf (entry_path, PATH_MAX, "%s/%s", batch->dir_path,
+                          entry->d_name);
+
+                memset (&stbuf, 0, sizeof (stbuf));
+#ifdef GF_LINUX_HOST_OS
+                posix_fstatat_with_gfid (batch->this, batch->dirfd,
+                                         entry->d_name, entry_path, &stbuf);
+#else
+                posix_lstat_with_gfid (batch->this, entry_path, &stbuf);
+#endif
+                if (stbuf.ia_ino)
+                        entry->d_ino = stbuf.ia_ino;
+                entry->d_stat = stbuf;
+        }
+}
+
+
+/* To be called with priv->readdirp_lock held, and batch->next < count */
+static int
+__posix_stat_batch_take (struct posix_stat_batch *batch, int *end)
+{
+        int start = 0;
+
+        start = batch->next;
+        *end = min (start + POSIX_READDIRP_CHUNK, batch->count);
+        batch->next = *end;
+
+        if (batch->next == batch->count)
+                list_del_init (&batch->list);
+
+        return start;
+}
+
+
+static void *
+posix_readdirp_worker (void *data)
+{
+        xlator_t                *this  = NULL;
+        struct posix_private    *priv  = NULL;
+        struct posix_stat_batch *batch = NULL;
+        int                      start = 0;
+        int                      end   = 0;
+
+        this = data;
+        priv = this->private;
+        THIS = this;
+
+        pthread_mutex_lock (&priv->readdirp_lock);
+        for (;;) {
+                while (list_empty (&priv->readdirp_batches)
+                       && !priv->readdirp_fini)
+                        pthread_cond_wait (&priv->readdirp_cond,
+                                           &priv->readdirp_lock);
+
+                if (priv->readdirp_fini)
+                        break;
+
+                batch = list_entry (priv->readdirp_batches.next,
+                                    struct posix_stat_batch, list);
+                start = __posix_stat_batch_take (batch, &end);
+
+                pthread_mutex_unlock (&priv->readdirp_lock);
+                {
+                        posix_readdirp_stat_range (batch, start, end);
+                }
+                pthread_mutex_lock (&priv->readdirp_lock);
+
+                batch->done += end - start;
+                if (batch->done == batch->count)
+                        pthread_cond_signal (&batch->cond);
+        }
+        pthread_mutex_unlock (&priv->readdirp_lock);
+
+        return NULL;
+}
+
+
+/*
+ * Fills the attributes of the @count entries listed in @entries. Past
+ * one chunk, and when readdirp-threads is set, the chunks are shared with
+ * the readdirp threads, the caller taking its part, so that the stats of
+ * a reply wait on the disk in parallel.
+ */
+static void
+posix_readdirp_fill (xlator_t *this, int dirfd, const char *real_path,
+                     gf_dirent_t *entries, int count)
+{
+        struct posix_private    *priv  = NULL;
+        struct posix_stat_batch  batch = {0, };
+        gf_dirent_t             *entry = NULL;
+        int                      start = 0;
+        int                      end   = 0;
+        int                      i     = 0;
+
+        priv = this->private;
+
+        batch.this     = this;
+        batch.dirfd    = dirfd;
+        batch.dir_path = real_path;
+        batch.count    = count;
+        INIT_LIST_HEAD (&batch.list);
+
+        batch.entries = GF_CALLOC (count, sizeof (*batch.entries),
+                                   gf_posix_mt_dirent_ptr_t);
+        if (!batch.entries)
+                goto out;
+
+        list_for_each_entry (entry, &entries->list, list) {
+                batch.entries[i++] = entry;
+        }
+
+        if ((priv->readdirp_threads == 0) || (count <= POSIX_READDIRP_CHUNK)) {
+                posix_readdirp_stat_range (&batch, 0, count);
+                goto out;
+        }
+
+        pthread_cond_init (&batch.cond, NULL);
+
+        pthread_mutex_lock (&priv->readdirp_lock);
+        {
+                list_add_tail (&batch.list, &priv->readdirp_batches);
+                pthread_cond_broadcast (&priv->readdirp_cond);
+
+                while (batch.next < batch.count) {
+                        start = __posix_stat_batch_take (&batch, &end);
+
+                        pthread_mutex_unlock (&priv->readdirp_lock);
+                        {
+                                posix_readdirp_stat_range (&batch, start, end);
+                        }
+                        pthread_mutex_lock (&priv->readdirp_lock);
+
+                        batch.done += end - start;
+                }
+
+                while (batch.done < batch.count)
+                        pthread_cond_wait (&batch.cond, &priv->readdirp_lock);
+        }
+        pthread_mutex_unlock (&priv->readdirp_lock);
+
+        pthread_cond_destroy (&batch.cond);
+out:
+        if (batch.entries)
+                GF_FREE (batch.entries);
+}
+
+
+void
+posix_readdirp_threads_start (xlator_t *this)
+{
+        struct posix_private *priv = NULL;
+        int                   i    = 0;
+        int                   ret  = 0;
+
+        priv = this->private;
+
+        pthread_mutex_init (&priv->readdirp_lock, NULL);
+        pthread_cond_init (&priv->readdirp_cond, NULL);
+        INIT_LIST_HEAD (&priv->readdirp_batches);
+
+        if (priv->readdirp_threads == 0)
+                return;
+
+        priv->readdirp_workers = GF_CALLOC (priv->readdirp_threads,
+                                            sizeof (pthread_t),
+                                            gf_posix_mt_pthread_t);
+        if (!priv->readdirp_workers) {
+                priv->readdirp_threads = 0;
+                return;
+        }
+
+        for (i = 0; i < priv->readdirp_threads; i++) {
+                ret = pthread_create (&priv->readdirp_workers[i], NULL,
+                                      posix_readdirp_worker, this);
+                if (ret != 0) {
+                        gf_log (this->name, GF_LOG_WARNING,
+                                "could not start readdirp thread: %s",
+                                strerror (ret));
+                        break;
+                }
+        }
+
+        priv->readdirp_threads = i;
+}
+
+
+void
+posix_readdirp_threads_stop (xlator_t *this)
+{
+        struct posix_private *priv = NULL;
+        int                   i    = 0;
+
+        priv = this->private;
+
+        pthread_mutex_lock (&priv->readdirp_lock);
+        {
+                priv->readdirp_fini = _gf_true;
+                pthread_cond_broadcast (&priv->readdirp_cond);
+        }
+        pthread_mutex_unlock (&priv->readdirp_lock);
+
+        for (i = 0; i < priv->readdirp_threads; i++)
+                pthread_join (priv->readdirp_workers[i], NULL);
+
+        if (priv->readdirp_workers)
+                GF_FREE (priv->readdirp_workers);
+        priv->readdirp_workers = NULL;
+        priv->readdirp_threads = 0;
+}
+
+
 int
 __posix_fill_readdir (DIR *dir, off_t off, size_t size, gf_dirent_t *entries,
                       const char *real_path, const char *base_path)
 {
         off_t     in_case = -1;
         size_t    filled = 0;
-        int           ret = 0;
         int             count = 0;
         struct dirent  *entry          = NULL;
         int32_t               this_size      = -1;
         gf_dirent_t          *this_entry     = NULL;
-        char                  hidden_path[PATH_MAX] = {0, };
-        struct stat           statbuf        = {0, };
 
         if (!off) {
                 rewinddir (dir);
@@ -3462,34 +4285,9 @@ __posix_fill_readdir (DIR *dir, off_t off, size_t size, gf_dirent_t *entries,
                         break;
                 }
 
-                if ((!strcmp (real_path, base_path))
-                    && (!strcmp (entry->d_name, GF_REPLICATE_TRASH_DIR)))
+                if (posix_dirent_hidden (real_path, base_path, entry->d_name))
                         continue;
 
-#ifdef __NetBSD__
-	       /*
-		* NetBSD with UFS1 backend uses backing files for
-		* extended attributes. They can be found in a
-		* .attribute file located at the root of the filesystem
-		* We hide it to glusterfs clients, since chaos will occur
-		* when the cluster/dht xlator decides to distribute
-		* exended attribute backing file accross storage servers.
-		*/
-		if ((!strcmp(real_path, base_path))
-		    && (!strcmp(entry->d_name, ".attribute")))
-			continue;
-#endif /* __NetBSD__ */
-
-                if ((!strcmp (real_path, base_path))
-                    && (!strncmp (GF_HIDDEN_PATH, entry->d_name,
-                                  strlen (GF_HIDDEN_PATH)))) {
-                        snprintf (hidden_path, PATH_MAX, "%s/%s", real_path,
-                                  entry->d_name);
-                        ret = lstat (hidden_path, &statbuf);
-                        if (!ret && S_ISDIR (statbuf.st_mode))
-                                continue;
-                }
-
                 this_size = max (sizeof (gf_dirent_t),
                                  sizeof (gfs3_dirplist))
                         + strlen (entry->d_name) + 1;
@@ -3537,12 +4335,7 @@ posix_do_readdir (call_frame_t *frame, xlator_t *this,
         int32_t               op_errno       = 0;
         gf_dirent_t           entries;
         char                 *real_path      = NULL;
-        int                   real_path_len  = -1;
-        char                 *entry_path     = NULL;
-        int                   entry_path_len = -1;
-        struct iatt           stbuf          = {0, };
         char                  base_path[PATH_MAX] = {0,};
-        gf_dirent_t          *tmp_entry      = NULL;
 
 
         VALIDATE_OR_GOTO (frame, out);
@@ -3568,22 +4361,10 @@ posix_do_readdir (call_frame_t *frame, xlator_t *this,
         }
 
         real_path     = pfd->path;
-        real_path_len = strlen (real_path);
-
-        entry_path_len = real_path_len + NAME_MAX;
-        entry_path     = alloca (entry_path_len);
 
         strncpy(base_path, POSIX_BASE_PATH(this), sizeof(base_path));
         base_path[strlen(base_path)] = '/';
 
-        if (!entry_path) {
-                op_errno = errno;
-                goto out;
-        }
-
-        strncpy (entry_path, real_path, entry_path_len);
-        entry_path[real_path_len] = '/';
-
         dir = pfd->dir;
 
         if (!dir) {
@@ -3596,24 +4377,23 @@ posix_do_readdir (call_frame_t *frame, xlator_t *this,
 
         LOCK (&fd->lock);
         {
+#ifdef GF_LINUX_HOST_OS
+                count = __posix_fill_getdents (this, pfd->fd, off, size,
+                                               &entries, real_path,
+                                               base_path);
+#else
                 count = __posix_fill_readdir (dir, off, size, &entries,
                                               real_path, base_path);
-
+#endif
         }
         UNLOCK (&fd->lock);
 
         /* pick ENOENT to indicate EOF */
         op_errno = errno;
 
-        if (whichop == GF_FOP_READDIRP) {
-                list_for_each_entry (tmp_entry, &entries.list, list) {
-                        strcpy (entry_path + real_path_len + 1,
-                                tmp_entry->d_name);
-                        posix_lstat_with_gfid (this, entry_path, &stbuf);
-                        if (stbuf.ia_ino)
-                                tmp_entry->d_ino = stbuf.ia_ino;
-                        tmp_entry->d_stat = stbuf;
-                }
+        if ((whichop == GF_FOP_READDIRP) && count) {
+                posix_readdirp_fill (this, pfd->fd, real_path, &entries,
+                                     count);
         }
 
         op_ret = count;
@@ -3667,6 +4447,22 @@ posix_priv (xlator_t *this)
         gf_proc_dump_write("max_read","%d", priv->read_value);
         gf_proc_dump_write("max_write","%d", priv->write_value);
         gf_proc_dump_write("nr_files","%ld", priv->nr_files);
+        gf_proc_dump_write("readdirp_threads","%d", priv->readdirp_threads);
+        gf_proc_dump_write("io_engine","%s", posix_aio_engine_name (this));
+        gf_proc_dump_write("dir_handles","%d", priv->dirfd_count);
+        gf_proc_dump_write("dir_handle_limit","%d", priv->dirfd_limit);
+        gf_proc_dump_write("dir_handle_hits","%"PRIu64, priv->dirfd_hits);
+        gf_proc_dump_write("dir_handle_misses","%"PRIu64,
+                           priv->dirfd_misses);
+        gf_proc_dump_write("batch_fsync_delay_usec","%u",
+                           priv->batch_fsync_delay_usec);
+        gf_proc_dump_write("fsync_batches","%"PRIu64, priv->fsync_batches);
+        gf_proc_dump_write("fsync_batched","%"PRIu64, priv->fsync_batched);
+        gf_proc_dump_write("fsync_batch_max","%d", priv->fsync_batch_max);
+        gf_proc_dump_write("fsync_batch_usec","%"PRIu64,
+                           priv->fsync_batch_usec);
+        gf_proc_dump_write("fsync_batch_usec_max","%"PRIu64,
+                           priv->fsync_batch_usec_max);
 
         return 0;
 }
@@ -3801,6 +4597,9 @@ init (xlator_t *this)
         int                    ret           = 0;
         int                    op_ret        = -1;
         int32_t                janitor_sleep = 0;
+        posix_io_engine_t      io_engine     = POSIX_IO_ENGINE_SYNC;
+        int32_t                io_depth      = POSIX_AIO_DEPTH_DEFAULT;
+        int32_t                fsync_delay   = 0;
         uuid_t                 old_uuid      = {0,};
         uuid_t                 dict_uuid     = {0,};
         uuid_t                 gfid          = {0,};
@@ -4041,6 +4840,91 @@ init (xlator_t *this)
                                 "for every open)");
         }
 
+        dict_ret = dict_get_int32 (this->options, "readdirp-threads",
+                                   &_private->readdirp_threads);
+        if (dict_ret == 0) {
+                if ((_private->readdirp_threads < 0)
+                    || (_private->readdirp_threads > POSIX_READDIRP_THREADS_MAX)) {
+                        ret = -1;
+                        gf_log (this->name, GF_LOG_ERROR,
+                                "'readdirp-threads' takes 0 to %d",
+                                POSIX_READDIRP_THREADS_MAX);
+                        goto out;
+                }
+                gf_log (this->name, GF_LOG_DEBUG,
+                        "readdirp stats entries with %d threads",
+                        _private->readdirp_threads);
+        }
+
+        tmp_data = dict_get (this->options, "io-engine");
+        if (tmp_data) {
+                if (!strcmp (tmp_data->data, "io_uring")) {
+                        io_engine = POSIX_IO_ENGINE_URING;
+                } else if (!strcmp (tmp_data->data, "linux-aio")) {
+                        io_engine = POSIX_IO_ENGINE_LINUX_AIO;
+                } else if (strcmp (tmp_data->data, "sync")) {
+                        ret = -1;
+                        gf_log (this->name, GF_LOG_ERROR,
+                                "'io-engine' takes sync, io_uring or "
+                                "linux-aio");
+                        goto out;
+                }
+        }
+
+        dict_ret = dict_get_int32 (this->options, "io-depth", &io_depth);
+        if (dict_ret == 0) {
+                if ((io_depth < 1) || (io_depth > POSIX_AIO_DEPTH_MAX)) {
+                        ret = -1;
+                        gf_log (this->name, GF_LOG_ERROR,
+                                "'io-depth' takes 1 to %d",
+                                POSIX_AIO_DEPTH_MAX);
+                        goto out;
+                }
+        }
+
+        _private->dirfd_limit = POSIX_DIRFD_LIMIT_DEFAULT;
+        dict_ret = dict_get_int32 (this->options, "dir-handle-cache-size",
+                                   &_private->dirfd_limit);
+        if ((dict_ret == 0) && (_private->dirfd_limit < 0)) {
+                ret = -1;
+                gf_log (this->name, GF_LOG_ERROR,
+                        "'dir-handle-cache-size' takes 0 (disabled) or more");
+                goto out;
+        }
+
+        dict_ret = dict_get_int32 (this->options, "batch-fsync-delay-usec",
+                                   &fsync_delay);
+        if (dict_ret == 0) {
+                if ((fsync_delay < 0)
+                    || (fsync_delay > POSIX_BATCH_FSYNC_DELAY_MAX)) {
+                        ret = -1;
+                        gf_log (this->name, GF_LOG_ERROR,
+                                "'batch-fsync-delay-usec' takes 0 "
+                                "(disabled) to %d",
+                                POSIX_BATCH_FSYNC_DELAY_MAX);
+                        goto out;
+                }
+                _private->batch_fsync_delay_usec = fsync_delay;
+        }
+
+        tmp_data = dict_get (this->options, "batch-fsync-mode");
+        if (tmp_data) {
+                if (!strcmp (tmp_data->data, "syncfs")) {
+#ifdef HAVE_SYNCFS
+                        _private->batch_fsync_mode = POSIX_BATCH_FSYNC_SYNCFS;
+#else
+                        gf_log (this->name, GF_LOG_WARNING,
+                                "syncfs is not available, batches are "
+                                "synced file by file");
+#endif
+                } else if (strcmp (tmp_data->data, "fsync")) {
+                        ret = -1;
+                        gf_log (this->name, GF_LOG_ERROR,
+                                "'batch-fsync-mode' takes syncfs or fsync");
+                        goto out;
+                }
+        }
+
         _private->janitor_sleep_duration = 600;
 
         dict_ret = dict_get_int32 (this->options, "janitor-sleep-duration",
@@ -4089,13 +4973,33 @@ init (xlator_t *this)
                 }
         }
 #endif
+        {
+                struct rlimit lim;
+
+                /* leave most descriptors to the files opened by clients */
+                if ((getrlimit (RLIMIT_NOFILE, &lim) == 0)
+                    && (_private->dirfd_limit > lim.rlim_cur / 4)) {
+                        _private->dirfd_limit = lim.rlim_cur / 4;
+                        gf_log (this->name, GF_LOG_INFO,
+                                "holding at most %d directories open",
+                                _private->dirfd_limit);
+                }
+        }
         this->private = (void *)_private;
 
         pthread_mutex_init (&_private->janitor_lock, NULL);
         pthread_cond_init (&_private->janitor_cond, NULL);
         INIT_LIST_HEAD (&_private->janitor_fds);
 
+        posix_dirfd_init (this);
+
         posix_spawn_janitor_thread (this);
+
+        posix_readdirp_threads_start (this);
+
+        posix_aio_init (this, io_engine, io_depth);
+
+        posix_fsync_init (this);
 out:
         return ret;
 }
@@ -4106,6 +5010,10 @@ fini (xlator_t *this)
         struct posix_private *priv = this->private;
         if (!priv)
                 return;
+        posix_fsync_fini (this);
+        posix_readdirp_threads_stop (this);
+        posix_aio_fini (this);
+        posix_dirfd_fini (this);
         this->private = NULL;
         /*unlock brick dir*/
         if (priv->mount_lock)
@@ -4122,6 +5030,7 @@ struct xlator_dumpops dumpops = {
 struct xlator_fops fops = {
         .lookup      = posix_lookup,
         .stat        = posix_stat,
+        .bulkstat    = posix_bulkstat,
         .opendir     = posix_opendir,
         .readdir     = posix_readdir,
         .readdirp    = posix_readdirp,
@@ -4149,6 +5058,10 @@ struct xlator_fops fops = {
         .fsyncdir    = posix_fsyncdir,
         .access      = posix_access,
         .ftruncate   = posix_ftruncate,
+        .fallocate   = posix_glfallocate,
+        .discard     = posix_discard,
+        .zerofill    = posix_zerofill,
+        .seek        = posix_seek,
         .fstat       = posix_fstat,
         .lk          = posix_lk,
         .inodelk     = posix_inodelk,
@@ -4185,5 +5098,53 @@ struct volume_options options[] = {
           .type = GF_OPTION_TYPE_INT },
         { .key  = {"volume-id"},
           .type = GF_OPTION_TYPE_ANY },
+        { .key  = {"readdirp-threads"},
+          .type = GF_OPTION_TYPE_INT,
+          .min  = 0,
+          .max  = POSIX_READDIRP_THREADS_MAX,
+          .description = "Number of threads sharing the stat of the entries "
+          "of a readdirp reply with the thread serving it. 0 stats them "
+          "in that thread only."
+        },
+        { .key  = {"io-engine"},
+          .type = GF_OPTION_TYPE_STR,
+          .value = { "sync", "io_uring", "linux-aio" },
+          .description = "How readv, writev and fsync reach the disk. sync "
+          "does them in the calling thread; io_uring and linux-aio submit "
+          "them to the kernel and unwind them from a completion thread, "
+          "falling back to linux-aio and sync when unavailable."
+        },
+        { .key  = {"io-depth"},
+          .type = GF_OPTION_TYPE_INT,
+          .min  = 1,
+          .max  = POSIX_AIO_DEPTH_MAX,
+          .description = "Maximum number of I/Os in flight in the io-engine; "
+          "beyond it fops are done synchronously."
+        },
+        { .key  = {"dir-handle-cache-size"},
+          .type = GF_OPTION_TYPE_INT,
+          .min  = 0,
+          .max  = 1048576,
+          .description = "Number of directories held open so that lookup, "
+          "stat, create, mkdir, unlink and the xattr fops on directories "
+          "work relative to them instead of walking the whole path. 0 "
+          "disables it. At most a quarter of the file descriptor limit."
+        },
+        { .key  = {"batch-fsync-delay-usec"},
+          .type = GF_OPTION_TYPE_INT,
+          .min  = 0,
+          .max  = POSIX_BATCH_FSYNC_DELAY_MAX,
+          .description = "Time an fsync, or a write of an O_SYNC file, waits "
+          "for others to be synced along with it. 0, the default, syncs "
+          "each one at once."
+        },
+        { .key  = {"batch-fsync-mode"},
+          .type = GF_OPTION_TYPE_STR,
+          .value = { "fsync", "syncfs" },
+          .description = "How a batch of fsyncs is synced: fsync does one "
+          "fsync (or fdatasync) per file in the batch, syncfs one syncfs "
+          "of the filesystem of the export directory, then one fdatasync "
+          "per file to get the errors of each file."
+        },
         { .key  = {NULL} }
 };
@@ -116,8 +116,97 @@ struct posix_private {
         char *          trash_path;
 /* lock for brick dir */
         DIR     *mount_lock;
+
+/* threads helping readdirp with the stat of the entries of a directory */
+        int32_t           readdirp_threads;
+        pthread_t        *readdirp_workers;
+        pthread_mutex_t   readdirp_lock;
+        pthread_cond_t    readdirp_cond;
+        struct list_head  readdirp_batches;
+        gf_boolean_t      readdirp_fini;
+
+/* asynchronous engine for readv/writev/fsync, NULL when io-engine is sync */
+        struct posix_aio *aio;
+
+/* open directories by gfid, for the entry fops on their children */
+        gf_lock_t           dirfd_lock;
+        int32_t             dirfd_limit;     /* 0 disables the cache */
+        int32_t             dirfd_count;
+        struct list_head   *dirfd_hash;
+        struct list_head    dirfd_lru;
+        uint64_t            dirfd_hits;
+        uint64_t            dirfd_misses;
+
+/* group commit of fsync and O_SYNC writes, 0 usec of delay disables it */
+        uint32_t            batch_fsync_delay_usec;
+        int                 batch_fsync_mode;
+        pthread_t           fsyncer;
+        gf_boolean_t        fsyncer_running;
+        pthread_mutex_t     fsync_lock;
+        pthread_cond_t      fsync_cond;
+        struct list_head    fsyncs;
+        gf_boolean_t        fsync_fini;
+        uint64_t            fsync_batches;
+        uint64_t            fsync_batched;     /* fops completed in batches */
+        int32_t             fsync_batch_max;
+        uint64_t            fsync_batch_usec;  /* total time spent syncing */
+        uint64_t            fsync_batch_usec_max;
+};
+
+/* a directory held open for the *at() calls on its entries */
+struct posix_dirfd {
+        uuid_t             gfid;
+        int                fd;
+        int                ref;
+        gf_boolean_t       unhashed; /* closed on the last put */
+        struct list_head   hash;
+        struct list_head   lru;
+};
+
+/* the entries of one readdirp reply, shared between the caller and the
+   readdirp threads POSIX_READDIRP_CHUNK at a time */
+struct posix_stat_batch {
+        xlator_t          *this;
+        int                dirfd;
+        const char        *dir_path;
+        gf_dirent_t      **entries;
+        int                count;
+        int                next;     /* first entry not taken yet */
+        int                done;
+        pthread_cond_t     cond;     /* signalled when done == count */
+        struct list_head   list;
+};
+
+/* an fsync, or an O_SYNC write, waiting for the next batch */
+struct posix_fsync_req {
+        call_frame_t      *frame;
+        fd_t              *fd;
+        int                _fd;
+        glusterfs_fop_t    fop;
+        int32_t            datasync;
+        int32_t            op_ret;   /* writev: the bytes written */
+        int32_t            op_errno;
+        gf_boolean_t       synced;
+        struct iatt        preop;
+        struct list_head   list;
 };
 
+enum {
+        POSIX_BATCH_FSYNC_FSYNC = 0, /* one fsync/fdatasync per file */
+        POSIX_BATCH_FSYNC_SYNCFS,    /* one syncfs for the whole batch */
+};
+
+#define POSIX_BATCH_FSYNC_DELAY_MAX (1000 * 1000)
+
+#define POSIX_READDIRP_CHUNK        32
+#define POSIX_READDIRP_THREADS_MAX  16
+
+#define POSIX_DIRFD_HASH_SIZE       1031
+#define POSIX_DIRFD_LIMIT_DEFAULT   1024
+#define POSIX_DIRFD_PROC_PATH       "/proc/self/fd"
+
+#define POSIX_ZEROFILL_CHUNK        (128 * GF_UNIT_KB)
+
 #define POSIX_BASE_PATH(this) (((struct posix_private *)this->private)->base_path)
 
 #define POSIX_BASE_PATH_LEN(this) (((struct posix_private *)this->private)->base_path_length)
@@ -133,7 +222,13 @@ struct posix_private {
 int setgid_override (xlator_t *this, char *real_path, gid_t *gid);
 int posix_gfid_set (xlator_t *this, const char *path, dict_t *xattr_req);
 int posix_fstat_with_gfid (xlator_t *this, int fd, struct iatt *stbuf_p);
+int posix_fill_gfid_fd (xlator_t *this, int fd, struct iatt *iatt);
+void posix_fill_ino_from_gfid (xlator_t *this, struct iatt *buf);
 int posix_lstat_with_gfid (xlator_t *this, const char *path, struct iatt *buf);
+#ifdef GF_LINUX_HOST_OS
+int posix_fstatat_with_gfid (xlator_t *this, int dirfd, const char *name,
+                             const char *path, struct iatt *stbuf_p);
+#endif
 dict_t *posix_lookup_xattr_fill (xlator_t *this, const char *path,
                                  loc_t *loc, dict_t *xattr, struct iatt *buf);
 int posix_handle_pair (xlator_t *this, const char *real_path,
@@ -149,5 +244,45 @@ int posix_gfid_heal (xlator_t *this, const char *path, dict_t *xattr_req);
 int posix_entry_create_xattr_set (xlator_t *this, const char *path,
                                   dict_t *dict);
 
+/* directory handle cache, posix-dirfd.c */
+int posix_dirfd_init (xlator_t *this);
+void posix_dirfd_fini (xlator_t *this);
+struct posix_dirfd *posix_dirfd_get (xlator_t *this, call_frame_t *frame,
+                                     uuid_t gfid, const char *path);
+struct posix_dirfd *posix_parent_dirfd (xlator_t *this, call_frame_t *frame,
+                                        loc_t *loc, const char *real_path);
+void posix_dirfd_put (xlator_t *this, struct posix_dirfd *dirfd);
+void posix_dirfd_forget (xlator_t *this, uuid_t gfid);
+char *posix_entry_path (struct posix_dirfd *pdirfd, loc_t *loc,
+                        char *real_path, char *buf, size_t size);
+int posix_entry_setgid_override (xlator_t *this, struct posix_dirfd *pdirfd,
+                                 char *real_path, gid_t *gid);
+int posix_entry_stat (xlator_t *this, struct posix_dirfd *pdirfd,
+                      loc_t *loc, const char *real_path, struct iatt *buf);
+int posix_parent_stat (xlator_t *this, struct posix_dirfd *pdirfd,
+                       const char *parentpath, struct iatt *buf);
+int posix_entry_open (struct posix_dirfd *pdirfd, loc_t *loc,
+                      const char *real_path, int flags, mode_t mode);
+int posix_entry_mkdir (struct posix_dirfd *pdirfd, loc_t *loc,
+                       const char *real_path, mode_t mode);
+int posix_entry_unlink (struct posix_dirfd *pdirfd, loc_t *loc,
+                        const char *real_path);
+ssize_t posix_dirfd_getxattr (struct posix_dirfd *dirfd, const char *path,
+                              const char *key, void *value, size_t size);
+ssize_t posix_dirfd_listxattr (struct posix_dirfd *dirfd, const char *path,
+                               char *list, size_t size);
+
+/* group commit of fsync, posix-fsync.c */
+int posix_fsync_init (xlator_t *this);
+void posix_fsync_fini (xlator_t *this);
+int posix_fsync_enqueue (call_frame_t *frame, xlator_t *this, fd_t *fd,
+                         int _fd, glusterfs_fop_t fop, int32_t datasync,
+                         int32_t op_ret, struct iatt *preop);
+
+/* name filters of directories, posix-bloom.c */
+int posix_bloom_get (xlator_t *this, const char *real_path, inode_t *inode,
+                     dict_t *dict);
+void posix_bloom_forget (xlator_t *this, uuid_t gfid);
+
 
 #endif /* _POSIX_H */